@@ -222,46 +222,39 @@ void Set_Slopes(struct NaturalCubicSpline_1D & Spline){
 //-----and Evaluate the 1D Vertical Splines------//
 //-----------------------------------------------//
 int Find_Segment(double x, double* x_vals, int length, int & prev){
-    int index = length + 1;
-    bool done = false;
+    // Points outside of the nodes are clamped to the first or last segment (the cubic there is extrapolated).
+    // Otherwise check the previous index and its neighbours, then the index implied by evenly spaced nodes
+    // (exact in O(1) for a uniform grid), and finally bisect for non-uniform grids.
+    int k_max = length - 2;
     
-    if(x > x_vals[length-1] || x < x_vals[0]){
-        cout << "Cannot interpolate outside of given bounds.  x = " << x << " is invalid." << '\n';
-    } else {
-        
-        // Check previous index and bounding segments
-        if(x >= x_vals[prev] && x <= x_vals[prev+1]){
-            done = true;
-        }
-
-        if(!done && prev+2 <= length-1){
-            if(x >= x_vals[prev+1] && x <= x_vals[prev+2]){
-                done = true;
-                prev = prev + 1;
-            }
-        }
-        if(!done && prev-1 >= 0){
-            if(x >= x_vals[prev-1] && x <= x_vals[prev]){
-                done = true;
-                prev = prev - 1;
-            }
-        }
+    if(x <= x_vals[0]){             prev = 0;       return prev;}
+    if(x >= x_vals[length-1]){      prev = k_max;   return prev;}
     
-        if(!done){
-            for(int i = 0; i < length; i++){
-                if(x >= x_vals[i] && x <= x_vals[i+1]){
-                    index = i;
-                    break;
-                }
-                if (x >= x_vals[length - 2 - i] && x < x_vals[length - 1 - i]){
-                    index = (length - 2) - i;
-                    break;
-                }
-            }
-            prev = index;
-        }
-        return prev;
+    // Check previous index and bounding segments
+    if(prev >= 0 && prev <= k_max){
+        if(x >= x_vals[prev]){
+            if(x <= x_vals[prev+1]){                                return prev;}
+            if(prev+1 <= k_max && x <= x_vals[prev+2]){ prev++;     return prev;}
+        } else if(prev-1 >= 0 && x >= x_vals[prev-1]){  prev--;     return prev;}
+    }
+    
+    // Uniform grid estimate
+    int k = int((x - x_vals[0])/(x_vals[length-1] - x_vals[0]) * (length - 1));
+    k = min(max(k, 0), k_max);
+    if(x >= x_vals[k] && x <= x_vals[k+1]){ prev = k;   return prev;}
+    
+    // Bisection keeping x_vals[lo] <= x < x_vals[hi], starting from the side of the estimate containing x
+    int lo = 0, hi = length - 1;
+    if(x < x_vals[k])   hi = k;
+    else                lo = k + 1;
+    
+    while(hi - lo > 1){
+        int mid = (lo + hi)/2;
+        if(x >= x_vals[mid])    lo = mid;
+        else                    hi = mid;
     }
+    prev = lo;
+    return prev;
 }
 
 double Eval_Spline_f(double x, struct NaturalCubicSpline_1D & Spline){
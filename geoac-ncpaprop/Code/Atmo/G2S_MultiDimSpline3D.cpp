@@ -55,25 +55,10 @@ double* x_vals;     // x_i elements (x_cnt length)
 double* y_vals;     // y_j elements (y_cnt length)
 double* z_vals;     // z_k elements (z_cnt length)
 
-double*** T_vals;           // Temperature at (x_i, y_j, z_k) (x_cnt x y_cnt x z_cnt)
-double*** T_slopes;         // Slopes for vertical splines of temperature at each x[], y[] node
-double*** T_slopes_dx;      // Slopes for d/dx of vertical splines of temperature at each x[], y[] node
-double*** T_slopes_dy;      // Slopes for d/dy of vertical splines of temperature at each x[], y[] node
-
-double*** u_vals;           // E-W winds at (x_i, y_j, z_k) (x_cnt x y_cnt x z_cnt)
-double*** u_slopes;         // Slopes for vertical splines of temperature at each x[], y[] node
-double*** u_slopes_dx;      // Slopes for d/dx of vertical splines of temperature at each x[], y[] node
-double*** u_slopes_dy;      // Slopes for d/dy of vertical splines of temperature at each x[], y[] node
-
-double*** v_vals;           // N-S winds at (x_i, y_j, z_k) (x_cnt x y_cnt x z_cnt)
-double*** v_slopes;         // Slopes for vertical splines of temperature at each x[], y[] node
-double*** v_slopes_dx;      // Slopes for d/dx of vertical splines of temperature at each x[], y[] node
-double*** v_slopes_dy;      // Slopes for d/dy of vertical splines of temperature at each x[], y[] node
-
-double*** rho_vals;         // Density at (x_i, y_j, z_k) (x_cnt x y_cnt x z_cnt)
-double*** rho_slopes;         // Slopes for vertical splines of temperature at each x[], y[] node
-double*** rho_slopes_dx;      // Slopes for d/dx of vertical splines of temperature at each x[], y[] node
-double*** rho_slopes_dy;      // Slopes for d/dy of vertical splines of temperature at each x[], y[] node
+double* T_vals;     // Temperature at (x_i, y_j, z_k), flattened as T_vals[(i*y_cnt + j)*z_cnt + k]
+double* u_vals;     // E-W winds at (x_i, y_j, z_k), flattened as above
+double* v_vals;     // N-S winds at (x_i, y_j, z_k), flattened as above
+double* rho_vals;   // Density at (x_i, y_j, z_k), flattened as above
 
 
 //----------------------------------------//
@@ -142,17 +127,8 @@ void SetUp_G2S_Arrays(char* file_prefix, char* locx_file, char* locy_file){
     y_vals = new double [y_cnt];
     z_vals = new double [z_cnt];
     
-    T_vals = new double** [x_cnt];   rho_vals = new double** [x_cnt];
-    u_vals = new double** [x_cnt];   v_vals = new double** [x_cnt];
-    
-    for(int nx = 0; nx < x_cnt; nx++){
-        T_vals[nx] = new double* [y_cnt];    rho_vals[nx] = new double* [y_cnt];
-        u_vals[nx] = new double* [y_cnt];    v_vals[nx] = new double* [y_cnt];
-        for(int ny = 0; ny < y_cnt; ny++){
-            T_vals[nx][ny] = new double [z_cnt];    rho_vals[nx][ny] = new double [z_cnt];
-            u_vals[nx][ny] = new double [z_cnt];    v_vals[nx][ny] = new double [z_cnt];
-        }
-    }
+    T_vals = new double [x_cnt*y_cnt*z_cnt];    rho_vals = new double [x_cnt*y_cnt*z_cnt];
+    u_vals = new double [x_cnt*y_cnt*z_cnt];    v_vals = new double [x_cnt*y_cnt*z_cnt];
 }
 
 void Load_G2S_Multi(char* file_prefix, char* locx_file, char* locy_file, char* option){
@@ -175,31 +151,33 @@ void Load_G2S_Multi(char* file_prefix, char* locx_file, char* locy_file, char* o
             
         if (strncmp(option, "zTuvdp",6) == 0){
             for (int nz = 0; nz < z_cnt; nz++){
+                int n = (nx*y_cnt + ny)*z_cnt + nz;
                 file_in >> z_vals[nz];           // Extract z_i value
-                file_in >> T_vals[nx][ny][nz];   // Extract T(z_i)
-                file_in >> u_vals[nx][ny][nz];   // Extract u(z_i)
-                file_in >> v_vals[nx][ny][nz];   // Extract v(z_i)
-                file_in >> rho_vals[nx][ny][nz]; // Extract rho(z_i)
+                file_in >> T_vals[n];   // Extract T(z_i)
+                file_in >> u_vals[n];   // Extract u(z_i)
+                file_in >> v_vals[n];   // Extract v(z_i)
+                file_in >> rho_vals[n]; // Extract rho(z_i)
                 file_in >> temp;                 // Extract p(z_i) but don't store it
                 
                 // Convert winds m/s -> km/s and scale near the ground to guarantee u(z_g), v(z_g) = 0 (currently set at z_g = 0)
-                u_vals[nx][ny][nz] *= (2.0 / (1.0 + exp(-(z_vals[nz] - z_grnd)/0.05)) - 1.0) / 1000.0;
-                v_vals[nx][ny][nz] *= (2.0 / (1.0 + exp(-(z_vals[nz] - z_grnd)/0.05)) - 1.0) / 1000.0;
+                u_vals[n] *= (2.0 / (1.0 + exp(-(z_vals[nz] - z_grnd)/0.05)) - 1.0) / 1000.0;
+                v_vals[n] *= (2.0 / (1.0 + exp(-(z_vals[nz] - z_grnd)/0.05)) - 1.0) / 1000.0;
             }
         } else if (strncmp(option, "zuvqTdp",6) == 0){
             for (int nz = 0; nz < z_cnt; nz++){
+                int n = (nx*y_cnt + ny)*z_cnt + nz;
                 file_in >> z_vals[nz];           // Extract z_i value
-                file_in >> u_vals[nx][ny][nz];   // Extract u(z_i)
-                file_in >> v_vals[nx][ny][nz];   // Extract v(z_i)
+                file_in >> u_vals[n];   // Extract u(z_i)
+                file_in >> v_vals[n];   // Extract v(z_i)
                 file_in >> temp;                 // Extract w(z_i) but don't store it
-                file_in >> T_vals[nx][ny][nz];   // Extract T(z_i)
-                file_in >> rho_vals[nx][ny][nz]; // Extract rho(z_i)
+                file_in >> T_vals[n];   // Extract T(z_i)
+                file_in >> rho_vals[n]; // Extract rho(z_i)
                 file_in >> temp;                 // Extract p(z_i) but don't store it
                     
                      
                 // Convert winds m/s -> km/s and scale near the ground to guarantee u(z_g), v(z_g) = 0 (currently set at z_g = 0)
-                u_vals[nx][ny][nz] *= (2.0 / (1.0 + exp(-(z_vals[nz] - z_grnd)/0.05)) - 1.0) / 1000.0;
-                v_vals[nx][ny][nz] *= (2.0 / (1.0 + exp(-(z_vals[nz] - z_grnd)/0.05)) - 1.0) / 1000.0;
+                u_vals[n] *= (2.0 / (1.0 + exp(-(z_vals[nz] - z_grnd)/0.05)) - 1.0) / 1000.0;
+                v_vals[n] *= (2.0 / (1.0 + exp(-(z_vals[nz] - z_grnd)/0.05)) - 1.0) / 1000.0;
             }
         } else {
             cout << "Unrecognized profile option: " << option << ".  Valid options are: zTuvdp and zuvwTdp" << '\n';
@@ -210,20 +188,12 @@ void Load_G2S_Multi(char* file_prefix, char* locx_file, char* locy_file, char* o
 
 void Clear_G2S_Arrays(){
     // Clear the arrays
-    delete x_vals;
-    delete y_vals;
-    delete z_vals;
+    delete [] x_vals;
+    delete [] y_vals;
+    delete [] z_vals;
     
-    for(int nx = 0; nx < x_cnt; nx++){
-        for(int ny = 0; ny < y_cnt; ny++){
-            delete T_vals[nx][ny];  delete rho_vals[nx][ny];
-            delete u_vals[nx][ny];  delete v_vals[nx][ny];
-        }
-        delete T_vals[nx];  delete rho_vals[nx];
-        delete u_vals[nx];  delete v_vals[nx];
-    }
-    delete T_vals;    delete rho_vals;
-    delete u_vals;    delete v_vals;
+    delete [] T_vals;    delete [] rho_vals;
+    delete [] u_vals;    delete [] v_vals;
 }
 
 //-------------------------------------//
@@ -253,69 +223,34 @@ double BiCubic_ConversionMatrix [16][16] = {
 //------------Functions to Build and------------//
 //-------Clear the Input and Slope Arrays-------//
 //----------------------------------------------//
-
-
 void BuildInputArrays(struct MultiDimSpline_3D & Spline){
     Spline.x_vals = new double [Spline.length_x];
     Spline.y_vals = new double [Spline.length_y];
     Spline.z_vals = new double [Spline.length_z];
     
-    Spline.f_vals = new double** [Spline.length_x];
-    
-    for(int i = 0; i < Spline.length_x; i++){
-        Spline.f_vals[i] = new double* [Spline.length_y];
-        for(int j = 0; j < Spline.length_y; j++){
-            Spline.f_vals[i][j] = new double [Spline.length_z];
-        }
-    }
+    Spline.f_vals = new double [Spline.length_x * Spline.length_y * Spline.length_z];
 }
+
 void BuildSlopesArrays(struct MultiDimSpline_3D & Spline){
-    Spline.f_slopes = new double** [Spline.length_x];
-    Spline.dfdx_slopes = new double** [Spline.length_x];
-    Spline.dfdy_slopes = new double** [Spline.length_x];
-    
-    for(int i = 0; i < Spline.length_x; i++){
-        Spline.f_slopes[i] = new double* [Spline.length_y];
-        Spline.dfdx_slopes[i] = new double* [Spline.length_y];
-        Spline.dfdy_slopes[i] = new double* [Spline.length_y];
-        for(int j = 0; j < Spline.length_y; j++){
-            Spline.f_slopes[i][j] = new double [Spline.length_z];
-            Spline.dfdx_slopes[i][j] = new double [Spline.length_z];
-            Spline.dfdy_slopes[i][j] = new double [Spline.length_z];
-        }
-    }
+    Spline.f_coeffs = new double [Spline.length_x * Spline.length_y * (Spline.length_z - 1) * 4];
 }
 
 void ClearInputArrays(struct MultiDimSpline_3D & Spline){
-    delete Spline.x_vals;
-    delete Spline.y_vals;
-    delete Spline.z_vals;
-    
-    for(int i = 0; i < Spline.length_x; i++){
-        for(int j = 0; j < Spline.length_y; j++){
-            delete Spline.f_vals[i][j];
-        }
-        delete Spline.f_vals[i];
-    }
-    delete Spline.f_vals;
+    delete [] Spline.x_vals;
+    delete [] Spline.y_vals;
+    delete [] Spline.z_vals;
     
+    delete [] Spline.f_vals;
 }
 
 void ClearSlopesArrays(struct MultiDimSpline_3D & Spline){
-    for(int i = 0; i < Spline.length_x; i++){
-        for(int j = 0; j < Spline.length_y; j++){
-            delete Spline.f_slopes[i][j];
-            delete Spline.dfdx_slopes[i][j];
-            delete Spline.dfdy_slopes[i][j];
-        }
-        delete Spline.f_slopes[i];
-        delete Spline.dfdx_slopes[i];
-        delete Spline.dfdy_slopes[i];
-    }
-    delete Spline.f_slopes;
-    delete Spline.dfdx_slopes;
-    delete Spline.dfdy_slopes;
-    
+    delete [] Spline.f_coeffs;
+}
+
+void Reset_Cursor(struct MultiDimSpline_3D_Cursor & cursor){
+    cursor.accel[0] = 0;
+    cursor.accel[1] = 0;
+    cursor.accel[2] = 0;
 }
 
 
@@ -325,641 +260,126 @@ void ClearSlopesArrays(struct MultiDimSpline_3D & Spline){
 //--------------------------------------//
 void Set_Slopes_Multi(struct MultiDimSpline_3D & Spline){
     double ai, bi, ci, di;
+    int nz = Spline.length_z;
     
-    double new_c[Spline.length_z-1];
-    double new_d[Spline.length_z];
+    double* new_c = new double [nz - 1];
+    double* new_d = new double [nz];
+    double* slopes = new double [nz];
     
-    // Set f_slopes
     for(int mx = 0; mx < Spline.length_x; mx++){
         for(int my = 0; my < Spline.length_y; my++){
+            double* f = Spline.f_vals + (mx*Spline.length_y + my)*nz;
             
+            // Solve the tridiagonal system for the natural cubic spline slopes of f(x[mx], y[my], z)
             bi = 2.0 / (Spline.z_vals[1] - Spline.z_vals[0]);
             ci = 1.0 / (Spline.z_vals[1] - Spline.z_vals[0]);
-            di = 3.0 * (Spline.f_vals[mx][my][1] - Spline.f_vals[mx][my][0]) / pow(Spline.z_vals[1] - Spline.z_vals[0], 2);
+            di = 3.0 * (f[1] - f[0]) / pow(Spline.z_vals[1] - Spline.z_vals[0], 2);
             
             new_c[0] = ci/bi;
             new_d[0] = di/bi;
             
-            for(int i = 1; i < Spline.length_z - 1; i++) {
+            for(int i = 1; i < nz - 1; i++) {
                 ai = 1.0/(Spline.z_vals[i] - Spline.z_vals[i-1]);
                 bi = 2.0 * (1.0/(Spline.z_vals[i] - Spline.z_vals[i-1]) + 1.0/(Spline.z_vals[i+1] - Spline.z_vals[i]));
                 ci = 1.0/(Spline.z_vals[i+1] - Spline.z_vals[i]);
-                di = 3.0 * ((Spline.f_vals[mx][my][i] - Spline.f_vals[mx][my][i-1]) / pow(Spline.z_vals[i] - Spline.z_vals[i-1], 2)
-                            + (Spline.f_vals[mx][my][i+1] - Spline.f_vals[mx][my][i]) / pow(Spline.z_vals[i+1] - Spline.z_vals[i], 2) );
+                di = 3.0 * ((f[i] - f[i-1]) / pow(Spline.z_vals[i] - Spline.z_vals[i-1], 2)
+                            + (f[i+1] - f[i]) / pow(Spline.z_vals[i+1] - Spline.z_vals[i], 2) );
                 
                 new_c[i] = ci/(bi - new_c[i-1]*ai);
                 new_d[i] = (di - new_d[i-1]*ai)/(bi - new_c[i-1]*ai);
             }
             
-            ai = 1.0/(Spline.z_vals[Spline.length_z-1] - Spline.z_vals[Spline.length_z-2]);
-            bi = 2.0/(Spline.z_vals[Spline.length_z-1] - Spline.z_vals[Spline.length_z-2]);
-            di = 3.0 * (Spline.f_vals[mx][my][Spline.length_z-1] - Spline.f_vals[mx][my][Spline.length_z-2])
-            / pow(Spline.z_vals[Spline.length_z-1] - Spline.z_vals[Spline.length_z-2], 2);
-            
-            new_d[Spline.length_z-1] = (di - new_d[Spline.length_z - 2]*ai)/(bi - new_c[Spline.length_z - 2]*ai);
-            
-            Spline.f_slopes[mx][my][Spline.length_z - 1] = new_d[Spline.length_z - 1];
-            for(int i = Spline.length_z - 2; i >= 0; i--) Spline.f_slopes[mx][my][i] = new_d[i] - new_c[i] * Spline.f_slopes[mx][my][i+1];
-        }}
-    
-    // Set df/dx and df/dy values to use for setting dfdx_slopes and dfdy_slopes
-    double dfdx [Spline.length_x][Spline.length_y][Spline.length_z];
-    double dfdy [Spline.length_x][Spline.length_y][Spline.length_z];
-    
-    for(int mx = 0; mx < Spline.length_x; mx++){
-        for(int my = 0; my < Spline.length_y; my++){
-            for(int mz = 0; mz < Spline.length_z; mz++){
-                int mx_up = min(mx + 1, Spline.length_x - 1);   int mx_dn = max(mx - 1, 0);
-                int my_up = min(my + 1, Spline.length_y - 1);   int my_dn = max(my - 1, 0);
-                
-                dfdx[mx][my][mz] = (Spline.f_vals[mx_up][my][mz] - Spline.f_vals[mx_dn][my][mz])/(Spline.x_vals[mx_up] - Spline.x_vals[mx_dn]);
-                dfdy[mx][my][mz] = (Spline.f_vals[mx][my_up][mz] - Spline.f_vals[mx][my_dn][mz])/(Spline.y_vals[my_up] - Spline.y_vals[my_dn]);
-            }}}
-    
-    
-    // Set dfdx_slopes
-    for(int mx = 0; mx < Spline.length_x; mx++){
-        for(int my = 0; my < Spline.length_y; my++){
+            ai = 1.0/(Spline.z_vals[nz-1] - Spline.z_vals[nz-2]);
+            bi = 2.0/(Spline.z_vals[nz-1] - Spline.z_vals[nz-2]);
+            di = 3.0 * (f[nz-1] - f[nz-2]) / pow(Spline.z_vals[nz-1] - Spline.z_vals[nz-2], 2);
             
-            bi = 2.0 / (Spline.z_vals[1] - Spline.z_vals[0]);
-            ci = 1.0 / (Spline.z_vals[1] - Spline.z_vals[0]);
-            di = 3.0 * (dfdx[mx][my][1] - dfdx[mx][my][0]) / pow(Spline.z_vals[1] - Spline.z_vals[0], 2);
+            new_d[nz-1] = (di - new_d[nz - 2]*ai)/(bi - new_c[nz - 2]*ai);
             
-            new_c[0] = ci/bi;
-            new_d[0] = di/bi;
+            slopes[nz - 1] = new_d[nz - 1];
+            for(int i = nz - 2; i >= 0; i--) slopes[i] = new_d[i] - new_c[i] * slopes[i+1];
             
-            for(int i = 1; i < Spline.length_z - 1; i++) {
-                ai = 1.0/(Spline.z_vals[i] - Spline.z_vals[i-1]);
-                bi = 2.0 * (1.0/(Spline.z_vals[i] - Spline.z_vals[i-1]) + 1.0/(Spline.z_vals[i+1] - Spline.z_vals[i]));
-                ci = 1.0/(Spline.z_vals[i+1] - Spline.z_vals[i]);
-                di = 3.0 * ((dfdx[mx][my][i] - dfdx[mx][my][i-1]) / pow(Spline.z_vals[i] - Spline.z_vals[i-1], 2)
-                            + (dfdx[mx][my][i+1] - dfdx[mx][my][i]) / pow(Spline.z_vals[i+1] - Spline.z_vals[i], 2) );
+            // Convert the Hermite form, f = (1 - X) f_k + X f_k+1 + X (1 - X) (A (1 - X) + B X), into polynomial coefficients in X
+            for(int k = 0; k < nz - 1; k++){
+                double dz = Spline.z_vals[k+1] - Spline.z_vals[k];
+                double A =  slopes[k] * dz - (f[k+1] - f[k]);
+                double B = -slopes[k+1] * dz + (f[k+1] - f[k]);
                 
-                new_c[i] = ci/(bi - new_c[i-1]*ai);
-                new_d[i] = (di - new_d[i-1]*ai)/(bi - new_c[i-1]*ai);
+                double* coeffs = Spline.f_coeffs + Coeff_Index(Spline, mx, my, k);
+                coeffs[0] = f[k];
+                coeffs[1] = f[k+1] - f[k] + A;
+                coeffs[2] = B - 2.0 * A;
+                coeffs[3] = A - B;
             }
-            
-            ai = 1.0/(Spline.z_vals[Spline.length_z-1] - Spline.z_vals[Spline.length_z-2]);
-            bi = 2.0/(Spline.z_vals[Spline.length_z-1] - Spline.z_vals[Spline.length_z-2]);
-            di = 3.0 * (dfdx[mx][my][Spline.length_z-1] - dfdx[mx][my][Spline.length_z-2])
-            / pow(Spline.z_vals[Spline.length_z-1] - Spline.z_vals[Spline.length_z-2], 2);
-            
-            new_d[Spline.length_z-1] = (di - new_d[Spline.length_z - 2]*ai)/(bi - new_c[Spline.length_z - 2]*ai);
-            
-            Spline.dfdx_slopes[mx][my][Spline.length_z - 1] = new_d[Spline.length_z - 1];
-            for(int i = Spline.length_z - 2; i >= 0; i--) Spline.dfdx_slopes[mx][my][i] = new_d[i] - new_c[i] * Spline.dfdx_slopes[mx][my][i+1];
         }}
     
-    // Set dfdy_slopes
-    for(int mx = 0; mx < Spline.length_x; mx++){
-        for(int my = 0; my < Spline.length_y; my++){
-            
-            bi = 2.0 / (Spline.z_vals[1] - Spline.z_vals[0]);
-            ci = 1.0 / (Spline.z_vals[1] - Spline.z_vals[0]);
-            di = 3.0 * (dfdy[mx][my][1] - dfdy[mx][my][0]) / pow(Spline.z_vals[1] - Spline.z_vals[0], 2);
-            
-            new_c[0] = ci/bi;
-            new_d[0] = di/bi;
-            
-            for(int i = 1; i < Spline.length_z - 1; i++) {
-                ai = 1.0/(Spline.z_vals[i] - Spline.z_vals[i-1]);
-                bi = 2.0 * (1.0/(Spline.z_vals[i] - Spline.z_vals[i-1]) + 1.0/(Spline.z_vals[i+1] - Spline.z_vals[i]));
-                ci = 1.0/(Spline.z_vals[i+1] - Spline.z_vals[i]);
-                di = 3.0 * ((dfdy[mx][my][i] - dfdy[mx][my][i-1]) / pow(Spline.z_vals[i] - Spline.z_vals[i-1], 2)
-                            + (dfdy[mx][my][i+1] - dfdy[mx][my][i]) / pow(Spline.z_vals[i+1] - Spline.z_vals[i], 2) );
-                
-                new_c[i] = ci/(bi - new_c[i-1]*ai);
-                new_d[i] = (di - new_d[i-1]*ai)/(bi - new_c[i-1]*ai);
-            }
-            
-            ai = 1.0/(Spline.z_vals[Spline.length_z-1] - Spline.z_vals[Spline.length_z-2]);
-            bi = 2.0/(Spline.z_vals[Spline.length_z-1] - Spline.z_vals[Spline.length_z-2]);
-            di = 3.0 * (dfdy[mx][my][Spline.length_z-1] - dfdy[mx][my][Spline.length_z-2])
-            / pow(Spline.z_vals[Spline.length_z-1] - Spline.z_vals[Spline.length_z-2], 2);
-            
-            new_d[Spline.length_z-1] = (di - new_d[Spline.length_z - 2]*ai)/(bi - new_c[Spline.length_z - 2]*ai);
-            
-            Spline.dfdy_slopes[mx][my][Spline.length_z - 1] = new_d[Spline.length_z - 1];
-            for(int i = Spline.length_z - 2; i >= 0; i--) Spline.dfdy_slopes[mx][my][i] = new_d[i] - new_c[i] * Spline.dfdy_slopes[mx][my][i+1];
-        }}
+    delete [] new_c;
+    delete [] new_d;
+    delete [] slopes;
 }
 
 
 //-----------------------------------------------//
-//------Functions to Find the Segment Index------//
-//-----and Evaluate the 1D Vertical Splines------//
+//------Function to Find the Segment Index-------//
 //-----------------------------------------------//
 int Find_Segment(double x, double* x_vals, int length, int & prev){
-    int index = length + 1;
-    bool done = false;
-    
-    if(x > x_vals[length-1] || x < x_vals[0]){
-        cout << "Cannot interpolate outside of given bounds.  x = " << x << " is invalid." << '\n';
-    } else {
-        
-        // Check previous index and bounding segments
-        if(x >= x_vals[prev] && x <= x_vals[prev+1]){
-            done = true;
-        }
-        
-        if(!done && prev+2 <= length-1){
-            if(x >= x_vals[prev+1] && x <= x_vals[prev+2]){
-                done = true;
-                prev = prev + 1;
-            }
-        }
-        if(!done && prev-1 >= 0){
-            if(x >= x_vals[prev-1] && x <= x_vals[prev]){
-                done = true;
-                prev = prev - 1;
-            }
-        }
-        
-        if(!done){
-            for(int i = 0; i < length; i++){
-                if(x >= x_vals[i] && x <= x_vals[i+1]){
-                    index = i;
-                    break;
-                }
-                if (x >= x_vals[length - 2 - i] && x < x_vals[length - 1 - i]){
-                    index = (length - 2) - i;
-                    break;
-                }
-            }
-            prev = index;
-        }
-        return prev;
+    // Points outside of the nodes are clamped to the first or last segment (the cubic there is extrapolated).
+    // Otherwise check the previous index and its neighbours, then the index implied by evenly spaced nodes
+    // (exact in O(1) for a uniform grid), and finally bisect for non-uniform grids.
+    int k_max = length - 2;
+    
+    if(x <= x_vals[0]){             prev = 0;       return prev;}
+    if(x >= x_vals[length-1]){      prev = k_max;   return prev;}
+    
+    // Check previous index and bounding segments
+    if(prev >= 0 && prev <= k_max){
+        if(x >= x_vals[prev]){
+            if(x <= x_vals[prev+1]){                                return prev;}
+            if(prev+1 <= k_max && x <= x_vals[prev+2]){ prev++;     return prev;}
+        } else if(prev-1 >= 0 && x >= x_vals[prev-1]){  prev--;     return prev;}
     }
-}
-
-
-double Eval_Vert_Spline_f(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    double X = (z - Spline.z_vals[kz])/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
-    double A = Spline.f_slopes[kx][ky][kz] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) - (Spline.f_vals[kx][ky][kz+1] - Spline.f_vals[kx][ky][kz]);
-    double B = -Spline.f_slopes[kx][ky][kz+1] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) + (Spline.f_vals[kx][ky][kz+1] - Spline.f_vals[kx][ky][kz]);
-    
-    return (1.0 - X) * Spline.f_vals[kx][ky][kz] + X * Spline.f_vals[kx][ky][kz+1] + X * (1.0 - X) * (A * (1.0 - X ) + B * X);
-}
-
-double Eval_Vert_Spline_dfdx(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    int kx_up = min(kx + 1, Spline.length_x - 1);
-    int kx_dn = max(kx - 1, 0);
-    
-    double dfdx_kz = (Spline.f_vals[kx_up][ky][kz] - Spline.f_vals[kx_dn][ky][kz])/(Spline.x_vals[kx_up] - Spline.x_vals[kx_dn]);           // df/dx at kz
-    double dfdx_kzp1 = (Spline.f_vals[kx_up][ky][kz+1] - Spline.f_vals[kx_dn][ky][kz+1])/(Spline.x_vals[kx_up] - Spline.x_vals[kx_dn]);     // df/dx at kz + 1
-    
-    double X = (z - Spline.z_vals[kz])/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
-    double A = Spline.dfdx_slopes[kx][ky][kz] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) - (dfdx_kzp1 - dfdx_kz);
-    double B = -Spline.dfdx_slopes[kx][ky][kz+1] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) + (dfdx_kzp1 - dfdx_kz);
-    
-    return (1.0 - X) * dfdx_kz + X * dfdx_kzp1 + X * (1.0 - X) * (A * (1.0 - X ) + B * X);
-}
-
-double Eval_Vert_Spline_dfdy(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    int ky_up = min(ky + 1, Spline.length_y - 1);
-    int ky_dn = max(ky - 1, 0);
-    
-    double dfdy_kz = (Spline.f_vals[kx][ky_up][kz] - Spline.f_vals[kx][ky_dn][kz])/(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]);       // df/dy at kz
-    double dfdy_kzp1 = (Spline.f_vals[kx][ky_up][kz+1] - Spline.f_vals[kx][ky_dn][kz+1])/(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]); // df/dy at kz + 1
-    
-    double X = (z - Spline.z_vals[kz])/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
-    double A = Spline.dfdy_slopes[kx][ky][kz] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) - (dfdy_kzp1 - dfdy_kz);
-    double B = -Spline.dfdy_slopes[kx][ky][kz+1] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) + (dfdy_kzp1 - dfdy_kz);
-    
-    return (1.0 - X) * dfdy_kz + X * dfdy_kzp1 + X * (1.0 - X) * (A * (1.0 - X ) + B * X);
-}
-
-double Eval_Vert_Spline_dfdz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    double X = (z - Spline.z_vals[kz])/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
-    double A = Spline.f_slopes[kx][ky][kz] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) - (Spline.f_vals[kx][ky][kz+1] - Spline.f_vals[kx][ky][kz]);
-    double B = -Spline.f_slopes[kx][ky][kz+1] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) + (Spline.f_vals[kx][ky][kz+1] - Spline.f_vals[kx][ky][kz]);
     
-    return (Spline.f_vals[kx][ky][kz+1] - Spline.f_vals[kx][ky][kz])/(Spline.z_vals[kz+1] - Spline.z_vals[kz])
-    + (1.0 - 2.0 * X) * (A * (1.0 - X) + B * X)/(Spline.z_vals[kz+1] - Spline.z_vals[kz])
-    + X * (1.0 - X) * (B - A)/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
-}
-
-double Eval_Vert_Spline_ddfdxdz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    int kx_up = min(kx + 1, Spline.length_x - 1);
-    int kx_dn = max(kx - 1, 0);
-    
-    double dfdx_kz = (Spline.f_vals[kx_up][ky][kz] - Spline.f_vals[kx_dn][ky][kz])/(Spline.x_vals[kx_up] - Spline.x_vals[kx_dn]);           // df/dx at kz
-    double dfdx_kzp1 = (Spline.f_vals[kx_up][ky][kz+1] - Spline.f_vals[kx_dn][ky][kz+1])/(Spline.x_vals[kx_up] - Spline.x_vals[kx_dn]);     // df/dx at kz + 1
-    
-    double X = (z - Spline.z_vals[kz])/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
-    double A = Spline.dfdx_slopes[kx][ky][kz] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) - (dfdx_kzp1 - dfdx_kz);
-    double B = -Spline.dfdx_slopes[kx][ky][kz+1] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) + (dfdx_kzp1 - dfdx_kz);
+    // Uniform grid estimate
+    int k = int((x - x_vals[0])/(x_vals[length-1] - x_vals[0]) * (length - 1));
+    k = min(max(k, 0), k_max);
+    if(x >= x_vals[k] && x <= x_vals[k+1]){ prev = k;   return prev;}
     
-    return (dfdx_kzp1 - dfdx_kz)/(Spline.z_vals[kz+1] - Spline.z_vals[kz])
-    + (1.0 - 2.0 * X) * (A * (1.0 - X) + B * X)/(Spline.z_vals[kz+1] - Spline.z_vals[kz])
-    + X * (1.0 - X) * (B - A)/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
-    
-}
-
-double Eval_Vert_Spline_ddfdydz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    int ky_up = min(ky + 1, Spline.length_y - 1);
-    int ky_dn = max(ky - 1, 0);
-    
-    double dfdy_kz = (Spline.f_vals[kx][ky_up][kz] - Spline.f_vals[kx][ky_dn][kz])/(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]);       // df/dy at kz
-    double dfdy_kzp1 = (Spline.f_vals[kx][ky_up][kz+1] - Spline.f_vals[kx][ky_dn][kz+1])/(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]); // df/dy at kz + 1
-    
-    double X = (z - Spline.z_vals[kz])/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
-    double A = Spline.dfdy_slopes[kx][ky][kz] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) - (dfdy_kzp1 - dfdy_kz);
-    double B = -Spline.dfdy_slopes[kx][ky][kz+1] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) + (dfdy_kzp1 - dfdy_kz);
-    
-    return (dfdy_kzp1 - dfdy_kz)/(Spline.z_vals[kz+1] - Spline.z_vals[kz])
-    + (1.0 - 2.0 * X) * (A * (1.0 - X) + B * X)/(Spline.z_vals[kz+1] - Spline.z_vals[kz])
-    + X * (1.0 - X) * (B - A)/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
+    // Bisection keeping x_vals[lo] <= x < x_vals[hi], starting from the side of the estimate containing x
+    int lo = 0, hi = length - 1;
+    if(x < x_vals[k])   hi = k;
+    else                lo = k + 1;
     
+    while(hi - lo > 1){
+        int mid = (lo + hi)/2;
+        if(x >= x_vals[mid])    lo = mid;
+        else                    hi = mid;
+    }
+    prev = lo;
+    return prev;
 }
 
-double Eval_Vert_Spline_ddfdzdz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    double X = (z - Spline.z_vals[kz])/(Spline.z_vals[kz+1] - Spline.z_vals[kz]);
-    double A = Spline.f_slopes[kx][ky][kz] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) - (Spline.f_vals[kx][ky][kz+1] - Spline.f_vals[kx][ky][kz]);
-    double B = -Spline.f_slopes[kx][ky][kz+1] * (Spline.z_vals[kz+1] - Spline.z_vals[kz]) + (Spline.f_vals[kx][ky][kz+1] - Spline.f_vals[kx][ky][kz]);
-    
-    return 2.0 * (B - 2.0 * A + (A - B) * 3.0 * X)/pow(Spline.z_vals[kz+1] - Spline.z_vals[kz],2);
-}
 
 //----------------------------------------------------//
-//-----------Evauation of the 2D Spline and-----------//
+//-----------Evauation of the 3D Spline and-----------//
 //-------its First and Second Order Derivatives-------//
 //----------------------------------------------------//
-double BiCubic_Deriv_dfdx(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d/dx of f to obtain df/dx
-    int kx_up = kx + 1;
-    int kx_dn = kx - 1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-    return (Eval_Vert_Spline_f(z, Spline, kx_up, ky, kz) - Eval_Vert_Spline_f(z, Spline, kx_dn, ky, kz))
-                /(Spline.x_vals[kx_up] - Spline.x_vals[kx_dn]);
-}
-
-double BiCubic_Deriv_dfdy(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d/dy of f to obtain df/dy
-    int ky_up = ky + 1;
-    int ky_dn = ky - 1;
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_f(z, Spline, kx, ky_up, kz) - Eval_Vert_Spline_f(z, Spline, kx, ky_dn, kz))
-                /(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]);
-    
-}
-
-double BiCubic_Deriv_ddfdxdx(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d/dx of df/dx to obtain d^2f/dx^2
-    int kx_up = kx + 1;
-    int kx_dn = kx - 1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-    return (Eval_Vert_Spline_dfdx(z, Spline, kx_up, ky, kz) - Eval_Vert_Spline_dfdx(z, Spline, kx_dn, ky, kz))
-                /(Spline.x_vals[kx_up] - Spline.x_vals[kx_dn]);
-}
-
-double BiCubic_Deriv_ddfdydy(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d/dy of df/dy to obtain d^2f/dy^2
-    int ky_up = ky + 1;
-    int ky_dn = ky - 1;
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_dfdy(z, Spline, kx, ky_up, kz) - Eval_Vert_Spline_dfdy(z, Spline, kx, ky_dn, kz))
-                /(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]);
-    
-}
-
-double BiCubic_Deriv_ddfdxdy(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d^2/dxdy of f to obtain d^2f/dxdy
-    int kx_up = kx+1;    int kx_dn = kx-1;
-    int ky_up = ky+1;    int ky_dn = ky-1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_f(z, Spline, kx_up, ky_up, kz)
-            - Eval_Vert_Spline_f(z, Spline, kx_up, ky_dn, kz)
-                - Eval_Vert_Spline_f(z, Spline, kx_dn, ky_up, kz)
-                    + Eval_Vert_Spline_f(z, Spline, kx_dn, ky_dn, kz))
-                        /((Spline.x_vals[kx_up] - Spline.x_vals[kx_dn])*(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]));
-    
-}
-
-double BiCubic_Deriv_dddfdxdxdy(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d^2/dxdy of df/dx to obtain d^3f/dx^2dy
-    int kx_up = kx+1;    int kx_dn = kx-1;
-    int ky_up = ky+1;    int ky_dn = ky-1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_dfdx(z, Spline, kx_up, ky_up, kz)
-            - Eval_Vert_Spline_dfdx(z, Spline, kx_up, ky_dn, kz)
-                - Eval_Vert_Spline_dfdx(z, Spline, kx_dn, ky_up, kz)
-                    + Eval_Vert_Spline_dfdx(z, Spline, kx_dn, ky_dn, kz))
-                        /((Spline.x_vals[kx_up] - Spline.x_vals[kx_dn])*(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]));
-}
-
-double BiCubic_Deriv_dddfdxdxdz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d/dx of d^2f/dxdz to obtain d^3f/dx^2dz
-    int kx_up = kx+1;    int kx_dn = kx-1;
-    int ky_up = ky+1;    int ky_dn = ky-1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-    return (Eval_Vert_Spline_ddfdxdz(z, Spline, kx_up, ky, kz) - Eval_Vert_Spline_ddfdxdz(z, Spline, kx_dn, ky, kz))
-                /(Spline.x_vals[kx_up] - Spline.x_vals[kx_dn]);
-}
-double BiCubic_Deriv_dddfdxdydy(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d^2/dxdy of df/dy to obtain d^3f/dxdy^2
-    int kx_up = kx+1;    int kx_dn = kx-1;
-    int ky_up = ky+1;    int ky_dn = ky-1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_dfdy(z, Spline, kx_up, ky_up, kz)
-            - Eval_Vert_Spline_dfdy(z, Spline, kx_up, ky_dn, kz)
-                - Eval_Vert_Spline_dfdy(z, Spline, kx_dn, ky_up, kz)
-                    + Eval_Vert_Spline_dfdy(z, Spline, kx_dn, ky_dn, kz))
-                        /((Spline.x_vals[kx_up] - Spline.x_vals[kx_dn])*(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]));
-}
-
-double BiCubic_Deriv_dddfdxdydz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d^2/dxdy of df/dz to obtain d^3f/dxdydz
-    int kx_up = kx+1;    int kx_dn = kx-1;
-    int ky_up = ky+1;    int ky_dn = ky-1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_dfdz(z, Spline, kx_up, ky_up, kz)
-            - Eval_Vert_Spline_dfdz(z, Spline, kx_up, ky_dn, kz)
-                - Eval_Vert_Spline_dfdz(z, Spline, kx_dn, ky_up, kz)
-                    + Eval_Vert_Spline_dfdz(z, Spline, kx_dn, ky_dn, kz))
-                        /((Spline.x_vals[kx_up] - Spline.x_vals[kx_dn])*(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]));
+static inline double Diff_x(double g[4][4], int a, int b, double* rdx){
+    // Discrete d/dx of g at corner (kx + a, ky + b) of the 4x4 block of nodes about the current cell
+    return (g[a+2][b+1] - g[a][b+1])*rdx[a];
 }
 
-
-double BiCubic_Deriv_dddfdxdzdz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d/dx of d^2f/dz^2 to obtain d^3f/dxdz^2
-    int kx_up = kx + 1;
-    int kx_dn = kx - 1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-    return (Eval_Vert_Spline_ddfdzdz(z, Spline, kx_up, ky, kz) - Eval_Vert_Spline_ddfdzdz(z, Spline, kx_dn, ky, kz))
-                /(Spline.x_vals[kx_up] - Spline.x_vals[kx_dn]);
+static inline double Diff_y(double g[4][4], int a, int b, double* rdy){
+    // Discrete d/dy of g at corner (kx + a, ky + b)
+    return (g[a+1][b+2] - g[a+1][b])*rdy[b];
 }
 
-double BiCubic_Deriv_dddfdydydz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d/dy of d^2f/dydz to obtain d^3f/dy^2dz
-    int ky_up = ky + 1;
-    int ky_dn = ky - 1;
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_ddfdydz(z, Spline, kx, ky_up, kz) - Eval_Vert_Spline_ddfdydz(z, Spline, kx, ky_dn, kz))
-                /(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]);
-    
-}
-
-double BiCubic_Deriv_dddfdydzdz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d/dy of d^2f/dz^2 to obtain d^3f/dydz^2
-    int ky_up = ky + 1;
-    int ky_dn = ky - 1;
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_ddfdzdz(z, Spline, kx, ky_up, kz) - Eval_Vert_Spline_ddfdzdz(z, Spline, kx, ky_dn, kz))
-                /(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]);
-    
-}
-
-double BiCubic_Deriv_ddddfdxdxdydz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d^2/dxdy of d^2f/dxdz to obtain d^4f/dx^2dydz
-    
-    int kx_up = kx+1;    int kx_dn = kx-1;
-    int ky_up = ky+1;    int ky_dn = ky-1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_ddfdxdz(z, Spline, kx_up, ky_up, kz)
-            - Eval_Vert_Spline_ddfdxdz(z, Spline, kx_up, ky_dn, kz)
-                - Eval_Vert_Spline_ddfdxdz(z, Spline, kx_dn, ky_up, kz)
-                    + Eval_Vert_Spline_ddfdxdz(z, Spline, kx_dn, ky_dn, kz))
-                        /((Spline.x_vals[kx_up] - Spline.x_vals[kx_dn])*(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]));
-}
-
-
-double BiCubic_Deriv_ddddfdxdydydz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d^2/dxdy of d^2f/dydz to obtain d^4f/dxdy^2dz
-    
-    int kx_up = kx+1;    int kx_dn = kx-1;
-    int ky_up = ky+1;    int ky_dn = ky-1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_ddfdydz(z, Spline, kx_up, ky_up, kz)
-            - Eval_Vert_Spline_ddfdydz(z, Spline, kx_up, ky_dn, kz)
-                - Eval_Vert_Spline_ddfdydz(z, Spline, kx_dn, ky_up, kz)
-                    + Eval_Vert_Spline_ddfdydz(z, Spline, kx_dn, ky_dn, kz))
-                        /((Spline.x_vals[kx_up] - Spline.x_vals[kx_dn])*(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]));
-}
-
-
-
-
-double BiCubic_Deriv_ddddfdxdydzdz(double z, struct MultiDimSpline_3D Spline, int kx, int ky, int kz){
-    // Calculate discrete d^2/dxdy of d^2f/dz^2 to obtain d^4f/dxdydz^2
-    
-    int kx_up = kx+1;    int kx_dn = kx-1;
-    int ky_up = ky+1;    int ky_dn = ky-1;
-    
-	if(kx_up > Spline.length_x - 1) kx_up = kx;           // Use backward x derivative if kx+1 is not defined
-    if(kx_dn < 0)                   kx_dn = kx;           // Use forward x derivative if kx-1 is not defined
-    
-	if(ky_up > Spline.length_y - 1) ky_up = ky;           // Use backward y derivative if ky+1 is not defined
-    if(ky_dn < 0)                   ky_dn = ky;           // Use forward y derivative if ky-1 is not defined
-    
-    return (Eval_Vert_Spline_ddfdzdz(z, Spline, kx_up, ky_up, kz)
-            - Eval_Vert_Spline_ddfdzdz(z, Spline, kx_up, ky_dn, kz)
-                - Eval_Vert_Spline_ddfdzdz(z, Spline, kx_dn, ky_up, kz)
-                    + Eval_Vert_Spline_ddfdzdz(z, Spline, kx_dn, ky_dn, kz))
-                        /((Spline.x_vals[kx_up] - Spline.x_vals[kx_dn])*(Spline.y_vals[ky_up] - Spline.y_vals[ky_dn]));
-}
-
-//----------------------------------------------------//
-//-----------Evauation of the 2D Spline and-----------//
-//-------its First and Second Order Derivatives-------//
-//----------------------------------------------------//
-double Eval_Spline_f(double x, double y, double z, struct MultiDimSpline_3D & Spline){
-    double A_vec[16];
-	double X_vec[16];
-    double BicCoeff[4][4];
-    
-    // Locate kx, ky, kz such that (x[kx] <= x' <= x[kx+1]), (y[ky] <= y' <= y[ky+1]), and (z[kz] <= z' <= z[kz+1])
-    int kx = Find_Segment(x, Spline.x_vals, Spline.length_x, Spline.accel[0]);
-    int ky = Find_Segment(y, Spline.y_vals, Spline.length_y, Spline.accel[1]);
-    int kz = Find_Segment(z, Spline.z_vals, Spline.length_z, Spline.accel[2]);
-    
-    double dx_scalar = Spline.x_vals[kx+1] - Spline.x_vals[kx]; // Set dr scaling to produce unit square relations
-    double dy_scalar = Spline.y_vals[ky+1] - Spline.y_vals[ky]; // Set dz scaling to produce unit square relations
-    
-    X_vec[0] = Eval_Vert_Spline_f(z, Spline, kx, ky, kz);
-    X_vec[1] = Eval_Vert_Spline_f(z, Spline, kx+1, ky, kz);
-    X_vec[2] = Eval_Vert_Spline_f(z, Spline, kx, ky+1, kz);
-    X_vec[3] = Eval_Vert_Spline_f(z, Spline, kx+1, ky+1, kz);
-    
-    X_vec[4] = BiCubic_Deriv_dfdx(z, Spline, kx, ky,kz)*dx_scalar;
-    X_vec[5] = BiCubic_Deriv_dfdx(z, Spline, kx+1, ky,kz)*dx_scalar;
-    X_vec[6] = BiCubic_Deriv_dfdx(z, Spline, kx, ky+1,kz)*dx_scalar;
-    X_vec[7] = BiCubic_Deriv_dfdx(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-    
-    X_vec[8] =  BiCubic_Deriv_dfdy(z, Spline, kx, ky,kz)*dx_scalar;
-    X_vec[9] =  BiCubic_Deriv_dfdy(z, Spline, kx+1, ky,kz)*dx_scalar;
-    X_vec[10] = BiCubic_Deriv_dfdy(z, Spline, kx, ky+1,kz)*dx_scalar;
-    X_vec[11] = BiCubic_Deriv_dfdy(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-    
-    X_vec[12]   = BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-    X_vec[13]   = BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-    X_vec[14]	= BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-    X_vec[15]   = BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-    
-    // Set the coefficients by matrix multiplication
-    for(int j = 0; j < 16; j++){
-        A_vec[j] = 0;
-        for(int k = 0; k < 16; k++){
-            A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-        }
-    }
-    
-    // Copy the a_vec elements into the coefficients array
-    for(int k1=0; k1 < 4; k1++){
-    for(int k2=0; k2 < 4; k2++){
-        BicCoeff[k1][k2] = A_vec[k2*4 + k1];
-    }}
-    
-    double x_scaled = (x - Spline.x_vals[kx])/(Spline.x_vals[kx+1] - Spline.x_vals[kx]);
-	double y_scaled = (y - Spline.y_vals[ky])/(Spline.y_vals[ky+1] - Spline.y_vals[ky]);
-    
-	double result = 0;
-	for(int k1 = 0; k1 < 4; k1++){
-    for(int k2 = 0; k2 < 4; k2++){
-        result+=1.0*BicCoeff[k1][k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-    }}
-	
-    return result;
+static inline double Diff_xy(double g[4][4], int a, int b, double* rdx, double* rdy){
+    // Discrete d^2/dxdy of g at corner (kx + a, ky + b)
+    return (g[a+2][b+2] - g[a+2][b] - g[a][b+2] + g[a][b])*rdx[a]*rdy[b];
 }
 
-double Eval_Spline_df(double x, double y, double z, int index, struct MultiDimSpline_3D & Spline){
+static void BiCubic_Patch(double* X_vec, double x_scaled, double y_scaled, double & val, double & dval_dx, double & dval_dy){
+    // Set A[j] by matrix multiplication, the bicubic is then Sum{k1,k2 = 0...3} a[k1 + 4*k2] x^k1 y^k2
     double A_vec[16];
-	double X_vec[16];
-    double BicCoeff[4][4];
-    
-    // Locate kx, ky, kz such that (x[kx] <= x' <= x[kx+1]), (y[ky] <= y' <= y[ky+1]), and (z[kz] <= z' <= z[kz+1])
-    int kx = Find_Segment(x, Spline.x_vals, Spline.length_x, Spline.accel[0]);
-    int ky = Find_Segment(y, Spline.y_vals, Spline.length_y, Spline.accel[1]);
-    int kz = Find_Segment(z, Spline.z_vals, Spline.length_z, Spline.accel[2]);
-    
-    double dx_scalar = Spline.x_vals[kx+1] - Spline.x_vals[kx]; // Set dx scaling to produce unit square relations
-    double dy_scalar = Spline.y_vals[ky+1] - Spline.y_vals[ky]; // Set dy scaling to produce unit square relations
-    
-    if(index==0){
-        X_vec[0] = BiCubic_Deriv_dfdx(z, Spline, kx, ky, kz);
-        X_vec[1] = BiCubic_Deriv_dfdx(z, Spline, kx+1, ky, kz);
-        X_vec[2] = BiCubic_Deriv_dfdx(z, Spline, kx, ky+1, kz);
-        X_vec[3] = BiCubic_Deriv_dfdx(z, Spline, kx+1, ky+1, kz);
-        
-        X_vec[4] = BiCubic_Deriv_ddfdxdx(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_ddfdxdx(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_ddfdxdx(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_ddfdxdx(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[8] =  BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[12]   = BiCubic_Deriv_dddfdxdxdy(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdxdy(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdxdy(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdxdy(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-        
-    } else if(index==1){
-        X_vec[0] = BiCubic_Deriv_dfdy(z, Spline, kx, ky, kz);
-        X_vec[1] = BiCubic_Deriv_dfdy(z, Spline, kx+1, ky, kz);
-        X_vec[2] = BiCubic_Deriv_dfdy(z, Spline, kx, ky+1, kz);
-        X_vec[3] = BiCubic_Deriv_dfdy(z, Spline, kx+1, ky+1, kz);
-        
-        X_vec[4] = BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[8] =  BiCubic_Deriv_ddfdydy(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  BiCubic_Deriv_ddfdydy(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = BiCubic_Deriv_ddfdydy(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = BiCubic_Deriv_ddfdydy(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[12]   = BiCubic_Deriv_dddfdxdydy(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdydy(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdydy(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdydy(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-        
-    } else if(index==2){
-        X_vec[0] = Eval_Vert_Spline_dfdz(z, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_dfdz(z, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_dfdz(z, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_dfdz(z, Spline, kx+1, ky+1, kz);
-        
-        X_vec[4] = Eval_Vert_Spline_ddfdxdz(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = Eval_Vert_Spline_ddfdxdz(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = Eval_Vert_Spline_ddfdxdz(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = Eval_Vert_Spline_ddfdxdz(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[8] =  Eval_Vert_Spline_ddfdydz(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  Eval_Vert_Spline_ddfdydz(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = Eval_Vert_Spline_ddfdydz(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = Eval_Vert_Spline_ddfdydz(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[12]   = BiCubic_Deriv_dddfdxdydz(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdydz(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdydz(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdydz(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-    }
-    
-    // Set the coefficients by matrix multiplication
     for(int j = 0; j < 16; j++){
         A_vec[j] = 0;
         for(int k = 0; k < 16; k++){
@@ -967,649 +387,155 @@ double Eval_Spline_df(double x, double y, double z, int index, struct MultiDimSp
         }
     }
     
-    // Copy the a_vec elements into the coefficients array
-    for(int k1=0; k1 < 4; k1++){
-    for(int k2=0; k2 < 4; k2++){
-        BicCoeff[k1][k2] = A_vec[k2*4 + k1];
-    }}
-    
-    double x_scaled = (x - Spline.x_vals[kx])/(Spline.x_vals[kx+1] - Spline.x_vals[kx]);
-	double y_scaled = (y - Spline.y_vals[ky])/(Spline.y_vals[ky+1] - Spline.y_vals[ky]);
-    
-	double result = 0;
-    for(int k1 = 0; k1 < 4; k1++){
+    // Evaluate the bicubic and its derivatives with respect to the scaled x and y
+    double px[4], dpx[4];
     for(int k2 = 0; k2 < 4; k2++){
-        result+=1.0*BicCoeff[k1][k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-    }}
-    
-    return result;
-}
-
-
-double Eval_Spline_ddf(double x, double y, double z, int index1, int index2, struct MultiDimSpline_3D & Spline){
-    double A_vec[16];
-	double X_vec[16];
-    double BicCoeff[4][4];
-    
-    // Locate kx, ky, kz such that (x[kx] <= x' <= x[kx+1]), (y[ky] <= y' <= y[ky+1]), and (z[kz] <= z' <= z[kz+1])
-    int kx = Find_Segment(x, Spline.x_vals, Spline.length_x, Spline.accel[0]);
-    int ky = Find_Segment(y, Spline.y_vals, Spline.length_y, Spline.accel[1]);
-    int kz = Find_Segment(z, Spline.z_vals, Spline.length_z, Spline.accel[2]);
-    
-    double dx_scalar = Spline.x_vals[kx+1] - Spline.x_vals[kx]; // Set dr scaling to produce unit square relations
-    double dy_scalar = Spline.y_vals[ky+1] - Spline.y_vals[ky]; // Set dz scaling to produce unit square relations
-    
-    if(index1==0 && index2==0){
-        // To calculate d^2 f/ dx^2, bicubic spline df/dx and take an x derivative (below)
-        X_vec[0] = Eval_Vert_Spline_dfdx(z, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_dfdx(z, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_dfdx(z, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_dfdx(z, Spline, kx+1, ky+1, kz);
-        
-        X_vec[4] = BiCubic_Deriv_ddfdxdx(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_ddfdxdx(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_ddfdxdx(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_ddfdxdx(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[8] =  BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[12]   = BiCubic_Deriv_dddfdxdxdy(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdxdy(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdxdy(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdxdy(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-        
-    } else if(index1==1 && index2==1){
-        // To calculate d^2 f/ dy^2, bicubic spline df/dy and take a y derivative (below)
-        X_vec[0] = Eval_Vert_Spline_dfdy(z, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_dfdy(z, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_dfdy(z, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_dfdy(z, Spline, kx+1, ky+1, kz);
-        
-        X_vec[4] = BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[8] =  BiCubic_Deriv_ddfdydy(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  BiCubic_Deriv_ddfdydy(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = BiCubic_Deriv_ddfdydy(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = BiCubic_Deriv_ddfdydy(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[12]   = BiCubic_Deriv_dddfdxdydy(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdydy(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdydy(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdydy(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-        
-    } else if(index1==2 && index2==2){
-        // To calculate d^2 f/ dz^2, bicubic spline the second z derivative of f
-        X_vec[0] = Eval_Vert_Spline_ddfdzdz(z, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_ddfdzdz(z, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_ddfdzdz(z, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_ddfdzdz(z, Spline, kx+1, ky+1, kz);
-        
-        X_vec[4] = BiCubic_Deriv_dddfdxdzdz(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_dddfdxdzdz(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_dddfdxdzdz(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_dddfdxdzdz(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[8] =  BiCubic_Deriv_dddfdydzdz(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  BiCubic_Deriv_dddfdydzdz(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = BiCubic_Deriv_dddfdydzdz(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = BiCubic_Deriv_dddfdydzdz(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[12]   = BiCubic_Deriv_ddddfdxdydzdz(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_ddddfdxdydzdz(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_ddddfdxdydzdz(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_ddddfdxdydzdz(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-        
-    } else if((index1==0 && index2==1) || (index1==1 && index2==0)){
-        // To calculate d^2 f/ dxdy, bicubic spline df/dx and take a y derivative (below)
-        X_vec[0] = Eval_Vert_Spline_dfdx(z, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_dfdx(z, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_dfdx(z, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_dfdx(z, Spline, kx+1, ky+1, kz);
-        
-        X_vec[4] = BiCubic_Deriv_ddfdxdx(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_ddfdxdx(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_ddfdxdx(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_ddfdxdx(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[8] =  BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = BiCubic_Deriv_ddfdxdy(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = BiCubic_Deriv_ddfdxdy(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[12]   = BiCubic_Deriv_dddfdxdxdy(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdxdy(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdxdy(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdxdy(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-        
-    } else if((index1==0 && index2==2) || (index1==2 && index2==0)){
-        // To calcualte d^2 f/dxdz, bicubic spline the z derivative of df/dx
-        X_vec[0] = Eval_Vert_Spline_ddfdxdz(z, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_ddfdxdz(z, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_ddfdxdz(z, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_ddfdxdz(z, Spline, kx+1, ky+1, kz);
-        
-        X_vec[4] = BiCubic_Deriv_dddfdxdxdz(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_dddfdxdxdz(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_dddfdxdxdz(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_dddfdxdxdz(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[8] =  BiCubic_Deriv_dddfdxdydz(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  BiCubic_Deriv_dddfdxdydz(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = BiCubic_Deriv_dddfdxdydz(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = BiCubic_Deriv_dddfdxdydz(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[12]   = BiCubic_Deriv_ddddfdxdxdydz(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_ddddfdxdxdydz(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_ddddfdxdxdydz(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_ddddfdxdxdydz(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-        
-    } else if((index1==1 && index2==2) || (index1==2 && index2==1)){
-        // To calculate d^2 f/dydz, bicubic spline the z derivative of df/dy
-        X_vec[0] = Eval_Vert_Spline_ddfdydz(z, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_ddfdydz(z, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_ddfdydz(z, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_ddfdydz(z, Spline, kx+1, ky+1, kz);
-        
-        X_vec[4] = BiCubic_Deriv_dddfdxdydz(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_dddfdxdydz(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_dddfdxdydz(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_dddfdxdydz(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[8] =  BiCubic_Deriv_dddfdydydz(z, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  BiCubic_Deriv_dddfdydydz(z, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = BiCubic_Deriv_dddfdydydz(z, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = BiCubic_Deriv_dddfdydydz(z, Spline, kx+1, ky+1,kz)*dx_scalar;
-        
-        X_vec[12]   = BiCubic_Deriv_ddddfdxdydydz(z, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_ddddfdxdydydz(z, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_ddddfdxdydydz(z, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_ddddfdxdydydz(z, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-    }
-    
-    // Set the coefficients by matrix multiplication
-    for(int j = 0; j < 16; j++){
-        A_vec[j] = 0;
-        for(int k = 0; k < 16; k++){
-            A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-        }
+        px[k2] =  A_vec[4*k2] + x_scaled*(A_vec[1 + 4*k2] + x_scaled*(A_vec[2 + 4*k2] + x_scaled*A_vec[3 + 4*k2]));
+        dpx[k2] = A_vec[1 + 4*k2] + x_scaled*(2.0*A_vec[2 + 4*k2] + x_scaled*3.0*A_vec[3 + 4*k2]);
     }
-    
-    // Copy the a_vec elements into the coefficients array
-    for(int k1=0; k1 < 4; k1++){
-    for(int k2=0; k2 < 4; k2++){
-        BicCoeff[k1][k2] = A_vec[k2*4 + k1];
-    }}
-    
-    double x_scaled = (x - Spline.x_vals[kx])/(Spline.x_vals[kx+1] - Spline.x_vals[kx]);
-	double y_scaled = (y - Spline.y_vals[ky])/(Spline.y_vals[ky+1] - Spline.y_vals[ky]);
-    
-	double result = 0;
-    if(index1==0 && index2==0){
-        // d^2 f / dx^2 requires taking an x derivative df/dx
-        for(int k1 = 1; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            result+=1.0*k1*BicCoeff[k1][k2]*pow(x_scaled,k1-1)*pow(y_scaled,k2)/(Spline.x_vals[kx+1] - Spline.x_vals[kx]);
-        }}
-    } else if((index1==1 && index2==1) || (index1==0 && index2==1) || (index1==1 && index2==0)){
-        // d^2 f / dy^2 and d^2 f / dxdy require taking a y derivative of df/dy and df/dx respectively
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 1; k2 < 4; k2++){
-            result+=1.0*k2*BicCoeff[k1][k2]*pow(x_scaled,k1)*pow(y_scaled,k2-1)/(Spline.y_vals[ky+1] - Spline.y_vals[ky]);
-        }}
-    } else {
-        // All other results are obtained immediately without differentiating the bicubic spline
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            result+=1.0*BicCoeff[k1][k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
-    }
-	
-    return result;
-}
-
-void Eval_Spline_AllOrder1(double x, double y, double z, struct MultiDimSpline_3D & Spline, double & f, double & dfdx, double & dfdy, double & dfdz){
-    double A_vec[16];
-	double X_vec[16];
-    
-    // Locate kx, ky, kz such that (x[kx] <= x' <= x[kx+1]), (y[ky] <= y' <= y[ky+1]), and (z[kz] <= z' <= z[kz+1])
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
-    
-    int kx = Find_Segment(x_eval, Spline.x_vals, Spline.length_x, Spline.accel[0]);
-    int ky = Find_Segment(y_eval, Spline.y_vals, Spline.length_y, Spline.accel[1]);
-    int kz = Find_Segment(z_eval, Spline.z_vals, Spline.length_z, Spline.accel[2]);
-    
-    // Compute the dx and dy scaling so that the grid square can be treated as a unit grid then the scaled versions of x and y within the unit grid
-    double dx_scalar = Spline.x_vals[kx+1] - Spline.x_vals[kx];
-    double dy_scalar = Spline.y_vals[ky+1] - Spline.y_vals[ky];
-    
-    double x_scaled = (x_eval - Spline.x_vals[kx])/(Spline.x_vals[kx+1] - Spline.x_vals[kx]);
-	double y_scaled = (y_eval - Spline.y_vals[ky])/(Spline.y_vals[ky+1] - Spline.y_vals[ky]);
-    
-    // Precompute finite difference df/dx, df/dy, and d^2f/dxdy which are used multiple times
-    double Finite_dfdx_00 = BiCubic_Deriv_dfdx(z_eval, Spline, kx, ky, kz);
-    double Finite_dfdx_10 = BiCubic_Deriv_dfdx(z_eval, Spline, kx+1, ky, kz);
-    double Finite_dfdx_01 = BiCubic_Deriv_dfdx(z_eval, Spline, kx, ky+1, kz);
-    double Finite_dfdx_11 = BiCubic_Deriv_dfdx(z_eval, Spline, kx+1, ky+1, kz);
-    
-    double Finite_dfdy_00 = BiCubic_Deriv_dfdy(z_eval, Spline, kx, ky, kz);
-    double Finite_dfdy_10 = BiCubic_Deriv_dfdy(z_eval, Spline, kx+1, ky, kz);
-    double Finite_dfdy_01 = BiCubic_Deriv_dfdy(z_eval, Spline, kx, ky+1, kz);
-    double Finite_dfdy_11 = BiCubic_Deriv_dfdy(z_eval, Spline, kx+1, ky+1, kz);
-    
-    double Finite_ddfdxdy_00 = BiCubic_Deriv_ddfdxdy(z_eval, Spline, kx, ky, kz);
-    double Finite_ddfdxdy_10 = BiCubic_Deriv_ddfdxdy(z_eval, Spline, kx+1, ky, kz);
-    double Finite_ddfdxdy_01 = BiCubic_Deriv_ddfdxdy(z_eval, Spline, kx, ky+1, kz);
-    double Finite_ddfdxdy_11 = BiCubic_Deriv_ddfdxdy(z_eval, Spline, kx+1, ky+1, kz);
-    
-    // Bicubic Spline f and evaluate it
-        X_vec[0] = Eval_Vert_Spline_f(z_eval, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_f(z_eval, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_f(z_eval, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_f(z_eval, Spline, kx+1, ky+1, kz);
-    
-        X_vec[4] = Finite_dfdx_00*dx_scalar;
-        X_vec[5] = Finite_dfdx_10*dx_scalar;
-        X_vec[6] = Finite_dfdx_01*dx_scalar;
-        X_vec[7] = Finite_dfdx_11*dx_scalar;
-    
-        X_vec[8] =  Finite_dfdy_00*dy_scalar;
-        X_vec[9] =  Finite_dfdy_10*dy_scalar;
-        X_vec[10] = Finite_dfdy_01*dy_scalar;
-        X_vec[11] = Finite_dfdy_11*dy_scalar;
-    
-        X_vec[12]   = Finite_ddfdxdy_00*dx_scalar*dy_scalar;
-        X_vec[13]   = Finite_ddfdxdy_10*dx_scalar*dy_scalar;
-        X_vec[14]	= Finite_ddfdxdy_01*dx_scalar*dy_scalar;
-        X_vec[15]   = Finite_ddfdxdy_11*dx_scalar*dy_scalar;
-    
-        // Set A[j] by matrix multiplication
-        for(int j = 0; j < 16; j++){
-            A_vec[j] = 0;
-            for(int k = 0; k < 16; k++){
-                A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-            }
-        }
-    
-        // Evaluate f(x,y,z) = Sum{k1,k2 = 0...3} c_{k1,k2}(z) x^k1 y^k2
-        // where c_{k1,k2}(z) = a[k1 + 4*k2](z)
-        f = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            f+=1.0*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
-	
-    // Bicubic Spline df/dx
-        X_vec[0] = Finite_dfdx_00;
-        X_vec[1] = Finite_dfdx_10;
-        X_vec[2] = Finite_dfdx_01;
-        X_vec[3] = Finite_dfdx_11;
-    
-        X_vec[4] = BiCubic_Deriv_ddfdxdx(z_eval, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_ddfdxdx(z_eval, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_ddfdxdx(z_eval, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_ddfdxdx(z_eval, Spline, kx+1, ky+1,kz)*dx_scalar;
-    
-        X_vec[8]   =  Finite_ddfdxdy_00*dy_scalar;
-        X_vec[9]   =  Finite_ddfdxdy_10*dy_scalar;
-        X_vec[10]	= Finite_ddfdxdy_01*dy_scalar;
-        X_vec[11]   = Finite_ddfdxdy_11*dy_scalar;
-    
-        X_vec[12]   = BiCubic_Deriv_dddfdxdxdy(z_eval, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdxdy(z_eval, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdxdy(z_eval, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdxdy(z_eval, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-    
-        // Set A[j] by matrix multiplication
-        for(int j = 0; j < 16; j++){
-            A_vec[j] = 0;
-            for(int k = 0; k < 16; k++){
-                A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-            }
-        }
-    
-        // Evaluate approriate derivatives of df/dx(x,y) = Sum{k1,k2 = 0...3} c_{k1,k2} x^k1 y^k2
-        // where c_{k1,k2} = a[k1 + 4*k2]
-        dfdx = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            dfdx+=1.0*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
-    
-    // Bicubic Spline df/dy
-        X_vec[0] = Finite_dfdy_00;
-        X_vec[1] = Finite_dfdy_10;
-        X_vec[2] = Finite_dfdy_01;
-        X_vec[3] = Finite_dfdy_11;
-    
-        X_vec[4]   = Finite_ddfdxdy_00*dx_scalar;
-        X_vec[5]   = Finite_ddfdxdy_10*dx_scalar;
-        X_vec[6]   = Finite_ddfdxdy_01*dx_scalar;
-        X_vec[7]   = Finite_ddfdxdy_11*dx_scalar;
-    
-        X_vec[8] =  BiCubic_Deriv_ddfdydy(z_eval, Spline, kx, ky,kz)*dy_scalar;
-        X_vec[9] =  BiCubic_Deriv_ddfdydy(z_eval, Spline, kx+1, ky,kz)*dy_scalar;
-        X_vec[10] = BiCubic_Deriv_ddfdydy(z_eval, Spline, kx, ky+1,kz)*dy_scalar;
-        X_vec[11] = BiCubic_Deriv_ddfdydy(z_eval, Spline, kx+1, ky+1,kz)*dy_scalar;
-    
-        X_vec[12]   = BiCubic_Deriv_dddfdxdydy(z_eval, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdydy(z_eval, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdydy(z_eval, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdydy(z_eval, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-    
-        // Set A[j] by matrix multiplication
-        for(int j = 0; j < 16; j++){
-            A_vec[j] = 0;
-            for(int k = 0; k < 16; k++){
-                A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-            }
-        }
-    
-        // Evaluate approriate derivatives of df/dx(x,y) = Sum{k1,k2 = 0...3} c_{k1,k2} x^k1 y^k2
-        // where c_{k1,k2} = a[k1 + 4*k2]
-        dfdy = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            dfdy+=1.0*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
-    
-    // Bicubic Spline df/dz and evaluate df/dz, d^2f/dxdz, and d^2f/dydz from the Bicubic Spline
-        X_vec[0] = Eval_Vert_Spline_dfdz(z_eval, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_dfdz(z_eval, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_dfdz(z_eval, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_dfdz(z_eval, Spline, kx+1, ky+1, kz);
-    
-        X_vec[4] = Eval_Vert_Spline_ddfdxdz(z_eval, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = Eval_Vert_Spline_ddfdxdz(z_eval, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = Eval_Vert_Spline_ddfdxdz(z_eval, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = Eval_Vert_Spline_ddfdxdz(z_eval, Spline, kx+1, ky+1,kz)*dx_scalar;
-    
-        X_vec[8] =  Eval_Vert_Spline_ddfdydz(z_eval, Spline, kx, ky,kz)*dy_scalar;
-        X_vec[9] =  Eval_Vert_Spline_ddfdydz(z_eval, Spline, kx+1, ky,kz)*dy_scalar;
-        X_vec[10] = Eval_Vert_Spline_ddfdydz(z_eval, Spline, kx, ky+1,kz)*dy_scalar;
-        X_vec[11] = Eval_Vert_Spline_ddfdydz(z_eval, Spline, kx+1, ky+1,kz)*dy_scalar;
-    
-        X_vec[12]   = BiCubic_Deriv_dddfdxdydz(z_eval, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdydz(z_eval, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdydz(z_eval, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdydz(z_eval, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-    
-        // Set A[j] by matrix multiplication
-        for(int j = 0; j < 16; j++){
-            A_vec[j] = 0;
-            for(int k = 0; k < 16; k++){
-                A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-            }
-        }
-    
-        // Evaluate approriate derivatives of df/dx(x,y) = Sum{k1,k2 = 0...3} c_{k1,k2} x^k1 y^k2
-        // where c_{k1,k2} = a[k1 + 4*k2]
-        dfdz = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            dfdz+=1.0*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
+    val =     px[0] + y_scaled*(px[1] + y_scaled*(px[2] + y_scaled*px[3]));
+    dval_dx = dpx[0] + y_scaled*(dpx[1] + y_scaled*(dpx[2] + y_scaled*dpx[3]));
+    dval_dy = px[1] + y_scaled*(2.0*px[2] + y_scaled*3.0*px[3]);
 }
 
-void Eval_Spline_AllOrder2(double x, double y, double z, struct MultiDimSpline_3D & Spline, double & f, double & dfdx, double & dfdy, double & dfdz, double & ddfdxdx, double & ddfdydy, double & ddfdzdz, double & ddfdxdy, double & ddfdxdz, double & ddfdydz){
-    double A_vec[16];
-	double X_vec[16];
-    
+void Eval_Spline_Fused(double x, double y, double z, const struct MultiDimSpline_3D & Spline, struct MultiDimSpline_3D_Cursor & cursor, struct MultiDimSpline_3D_Eval & result, int order){
     // Locate kx, ky, kz such that (x[kx] <= x' <= x[kx+1]), (y[ky] <= y' <= y[ky+1]), and (z[kz] <= z' <= z[kz+1])
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
+    double x_eval = min(max(x, Spline.x_vals[0]), Spline.x_vals[Spline.length_x-1]);   // Check that x_min <= x_eval <= x_max
+    double y_eval = min(max(y, Spline.y_vals[0]), Spline.y_vals[Spline.length_y-1]);   // Check that y_min <= y_eval <= y_max
+    double z_eval = min(max(z, Spline.z_vals[0]), Spline.z_vals[Spline.length_z-1]);   // Check that z_min <= z_eval <= z_max
     
-    int kx = Find_Segment(x_eval, Spline.x_vals, Spline.length_x, Spline.accel[0]);
-    int ky = Find_Segment(y_eval, Spline.y_vals, Spline.length_y, Spline.accel[1]);
-    int kz = Find_Segment(z_eval, Spline.z_vals, Spline.length_z, Spline.accel[2]);
+    int kx = Find_Segment(x_eval, Spline.x_vals, Spline.length_x, cursor.accel[0]);
+    int ky = Find_Segment(y_eval, Spline.y_vals, Spline.length_y, cursor.accel[1]);
+    int kz = Find_Segment(z_eval, Spline.z_vals, Spline.length_z, cursor.accel[2]);
     
     // Compute the dx and dy scaling so that the grid square can be treated as a unit grid then the scaled versions of x and y within the unit grid
     double dx_scalar = Spline.x_vals[kx+1] - Spline.x_vals[kx];
     double dy_scalar = Spline.y_vals[ky+1] - Spline.y_vals[ky];
+    double dz_scalar = Spline.z_vals[kz+1] - Spline.z_vals[kz];
     
     double x_scaled = (x_eval - Spline.x_vals[kx])/dx_scalar;
-	double y_scaled = (y_eval - Spline.y_vals[ky])/dy_scalar;
-    
-    // Precompute finite difference df/dx, df/dy, and d^2f/dxdy which are used multiple times
-    double Finite_dfdx_00 = BiCubic_Deriv_dfdx(z_eval, Spline, kx, ky, kz);
-    double Finite_dfdx_10 = BiCubic_Deriv_dfdx(z_eval, Spline, kx+1, ky, kz);
-    double Finite_dfdx_01 = BiCubic_Deriv_dfdx(z_eval, Spline, kx, ky+1, kz);
-    double Finite_dfdx_11 = BiCubic_Deriv_dfdx(z_eval, Spline, kx+1, ky+1, kz);
-
-    double Finite_dfdy_00 = BiCubic_Deriv_dfdy(z_eval, Spline, kx, ky, kz);
-    double Finite_dfdy_10 = BiCubic_Deriv_dfdy(z_eval, Spline, kx+1, ky, kz);
-    double Finite_dfdy_01 = BiCubic_Deriv_dfdy(z_eval, Spline, kx, ky+1, kz);
-    double Finite_dfdy_11 = BiCubic_Deriv_dfdy(z_eval, Spline, kx+1, ky+1, kz);
-
-    double Finite_ddfdxdy_00 = BiCubic_Deriv_ddfdxdy(z_eval, Spline, kx, ky, kz);
-    double Finite_ddfdxdy_10 = BiCubic_Deriv_ddfdxdy(z_eval, Spline, kx+1, ky, kz);
-    double Finite_ddfdxdy_01 = BiCubic_Deriv_ddfdxdy(z_eval, Spline, kx, ky+1, kz);
-    double Finite_ddfdxdy_11 = BiCubic_Deriv_ddfdxdy(z_eval, Spline, kx+1, ky+1, kz);
-
-    // Bicubic Spline f and evaluate it
-        X_vec[0] = Eval_Vert_Spline_f(z_eval, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_f(z_eval, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_f(z_eval, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_f(z_eval, Spline, kx+1, ky+1, kz);
-    
-        X_vec[4] = Finite_dfdx_00*dx_scalar;
-        X_vec[5] = Finite_dfdx_10*dx_scalar;
-        X_vec[6] = Finite_dfdx_01*dx_scalar;
-        X_vec[7] = Finite_dfdx_11*dx_scalar;
-    
-        X_vec[8] =  Finite_dfdy_00*dy_scalar;
-        X_vec[9] =  Finite_dfdy_10*dy_scalar;
-        X_vec[10] = Finite_dfdy_01*dy_scalar;
-        X_vec[11] = Finite_dfdy_11*dy_scalar;
-    
-        X_vec[12]   = Finite_ddfdxdy_00*dx_scalar*dy_scalar;
-        X_vec[13]   = Finite_ddfdxdy_10*dx_scalar*dy_scalar;
-        X_vec[14]	= Finite_ddfdxdy_01*dx_scalar*dy_scalar;
-        X_vec[15]   = Finite_ddfdxdy_11*dx_scalar*dy_scalar;
-    
-        // Set A[j] by matrix multiplication
-        for(int j = 0; j < 16; j++){
-            A_vec[j] = 0;
-            for(int k = 0; k < 16; k++){
-                A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-            }
-        }
-    
-        // Evaluate f(x,y,z) = Sum{k1,k2 = 0...3} c_{k1,k2}(z) x^k1 y^k2
-        // where c_{k1,k2}(z) = a[k1 + 4*k2](z)
-        f = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            f+=1.0*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
-	
-    // Bicubic Spline df/dx and evaluate df/dx, d^2f/dx^2, and d^2f/dxdy
-        X_vec[0] = Finite_dfdx_00;
-        X_vec[1] = Finite_dfdx_10;
-        X_vec[2] = Finite_dfdx_01;
-        X_vec[3] = Finite_dfdx_11;
-    
-        X_vec[4] = BiCubic_Deriv_ddfdxdx(z_eval, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_ddfdxdx(z_eval, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_ddfdxdx(z_eval, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_ddfdxdx(z_eval, Spline, kx+1, ky+1,kz)*dx_scalar;
-    
-        X_vec[8]   =  Finite_ddfdxdy_00*dy_scalar;
-        X_vec[9]   =  Finite_ddfdxdy_10*dy_scalar;
-        X_vec[10]	= Finite_ddfdxdy_01*dy_scalar;
-        X_vec[11]   = Finite_ddfdxdy_11*dy_scalar;
-    
-        X_vec[12]   = BiCubic_Deriv_dddfdxdxdy(z_eval, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdxdy(z_eval, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdxdy(z_eval, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdxdy(z_eval, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-
-    
-        // Set A[j] by matrix multiplication
-        for(int j = 0; j < 16; j++){
-            A_vec[j] = 0;
-            for(int k = 0; k < 16; k++){
-                A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-            }
+    double y_scaled = (y_eval - Spline.y_vals[ky])/dy_scalar;
+    double z_scaled = (z_eval - Spline.z_vals[kz])/dz_scalar;
+    
+    // Evaluate the vertical splines at nodes kx-2...kx+3 and ky-2...ky+3 (limited to the grid), which covers the corners of
+    // the cell and every neighbour used in the discrete x and y derivatives.  The coefficients for a fixed kz are contiguous.
+    int x0 = max(kx - 2, 0),    x_len = min(kx + 3, Spline.length_x - 1) - x0 + 1;
+    int y0 = max(ky - 2, 0),    y_len = min(ky + 3, Spline.length_y - 1) - y0 + 1;
+    
+    double Vert_f[6][6], Vert_dfdz[6][6], Vert_ddfdzdz[6][6];
+    for(int i = 0; i < x_len; i++){
+        const double* coeffs = Spline.f_coeffs + Coeff_Index(Spline, x0 + i, y0, kz);
+        for(int j = 0; j < y_len; j++, coeffs += 4){
+            Vert_f[i][j] = coeffs[0] + z_scaled*(coeffs[1] + z_scaled*(coeffs[2] + z_scaled*coeffs[3]));
+            if(order > 0) Vert_dfdz[i][j] = (coeffs[1] + z_scaled*(2.0*coeffs[2] + z_scaled*3.0*coeffs[3]))/dz_scalar;
+            if(order > 1) Vert_ddfdzdz[i][j] = (2.0*coeffs[2] + 6.0*z_scaled*coeffs[3])/(dz_scalar*dz_scalar);
         }
+    }
     
-        // Evaluate approriate derivatives of df/dx(x,y) = Sum{k1,k2 = 0...3} c_{k1,k2} x^k1 y^k2
-        // where c_{k1,k2} = a[k1 + 4*k2]
-        dfdx = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            dfdx+=1.0*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
-    
-        ddfdxdx = 0;
-        for(int k1 = 1; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            ddfdxdx+=1.0*k1*A_vec[k1 + 4*k2]*pow(x_scaled,k1-1)*pow(y_scaled,k2)/dx_scalar;
-        }}
-    
-        ddfdxdy = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 1; k2 < 4; k2++){
-            ddfdxdy+=1.0*k2*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2-1)/dy_scalar;
-        }}
-    
-    // Bicubic Spline df/dy and evaluate df/dy and d^2f/dy^2 from the Bicubic Spline
-        X_vec[0] = Finite_dfdy_00;
-        X_vec[1] = Finite_dfdy_10;
-        X_vec[2] = Finite_dfdy_01;
-        X_vec[3] = Finite_dfdy_11;
-    
-        X_vec[4]   = Finite_ddfdxdy_00*dx_scalar;
-        X_vec[5]   = Finite_ddfdxdy_10*dx_scalar;
-        X_vec[6]   = Finite_ddfdxdy_01*dx_scalar;
-        X_vec[7]   = Finite_ddfdxdy_11*dx_scalar;
-    
-        X_vec[8] =  BiCubic_Deriv_ddfdydy(z_eval, Spline, kx, ky,kz)*dy_scalar;
-        X_vec[9] =  BiCubic_Deriv_ddfdydy(z_eval, Spline, kx+1, ky,kz)*dy_scalar;
-        X_vec[10] = BiCubic_Deriv_ddfdydy(z_eval, Spline, kx, ky+1,kz)*dy_scalar;
-        X_vec[11] = BiCubic_Deriv_ddfdydy(z_eval, Spline, kx+1, ky+1,kz)*dy_scalar;
-    
-        X_vec[12]   = BiCubic_Deriv_dddfdxdydy(z_eval, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdydy(z_eval, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdydy(z_eval, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdydy(z_eval, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-    
-        // Set A[j] by matrix multiplication
-        for(int j = 0; j < 16; j++){
-            A_vec[j] = 0;
-            for(int k = 0; k < 16; k++){
-                A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-            }
-        }
-    
-        // Evaluate approriate derivatives of df/dx(x,y) = Sum{k1,k2 = 0...3} c_{k1,k2} x^k1 y^k2
-        // where c_{k1,k2} = a[k1 + 4*k2]
-        dfdy = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            dfdy+=1.0*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
-    
-        ddfdydy = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 1; k2 < 4; k2++){
-            ddfdydy+=1.0*k2*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2-1)/dy_scalar;
-        }}
-    
-    
-    // Bicubic Spline df/dz and evaluate df/dz, d^2f/dxdz, and d^2f/dydz from the Bicubic Spline
-        X_vec[0] = Eval_Vert_Spline_dfdz(z_eval, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_dfdz(z_eval, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_dfdz(z_eval, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_dfdz(z_eval, Spline, kx+1, ky+1, kz);
-    
-        X_vec[4] = Eval_Vert_Spline_ddfdxdz(z_eval, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = Eval_Vert_Spline_ddfdxdz(z_eval, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = Eval_Vert_Spline_ddfdxdz(z_eval, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = Eval_Vert_Spline_ddfdxdz(z_eval, Spline, kx+1, ky+1,kz)*dx_scalar;
-    
-        X_vec[8] =  Eval_Vert_Spline_ddfdydz(z_eval, Spline, kx, ky,kz)*dy_scalar;
-        X_vec[9] =  Eval_Vert_Spline_ddfdydz(z_eval, Spline, kx+1, ky,kz)*dy_scalar;
-        X_vec[10] = Eval_Vert_Spline_ddfdydz(z_eval, Spline, kx, ky+1,kz)*dy_scalar;
-        X_vec[11] = Eval_Vert_Spline_ddfdydz(z_eval, Spline, kx+1, ky+1,kz)*dy_scalar;
+    // Gather the 4x4 block of nodes kx-1...kx+2, ky-1...ky+2 with one-sided differences at the grid edges,
+    // along with the vertical splines of df/dx and df/dy at each of them
+    int ix[4], iy[4];
+    for(int n = 0; n < 4; n++){
+        ix[n] = min(max(kx - 1 + n, 0), Spline.length_x - 1);
+        iy[n] = min(max(ky - 1 + n, 0), Spline.length_y - 1);
+    }
     
-        X_vec[12]   = BiCubic_Deriv_dddfdxdydz(z_eval, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_dddfdxdydz(z_eval, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_dddfdxdydz(z_eval, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_dddfdxdydz(z_eval, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
+    double rdx[2], rdy[2];
+    for(int n = 0; n < 2; n++){
+        rdx[n] = 1.0/(Spline.x_vals[ix[n+2]] - Spline.x_vals[ix[n]]);
+        rdy[n] = 1.0/(Spline.y_vals[iy[n+2]] - Spline.y_vals[iy[n]]);
+    }
     
-        // Set A[j] by matrix multiplication
-        for(int j = 0; j < 16; j++){
-            A_vec[j] = 0;
-            for(int k = 0; k < 16; k++){
-                A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
+    double f_blk[4][4], dfdz_blk[4][4], ddfdzdz_blk[4][4];
+    double dfdx_blk[4][4], ddfdxdz_blk[4][4];
+    double dfdy_blk[4][4], ddfdydz_blk[4][4];
+    for(int a = 0; a < 4; a++){
+        int i =    ix[a] - x0;
+        int i_up = min(ix[a] + 1, Spline.length_x - 1) - x0;
+        int i_dn = max(ix[a] - 1, 0) - x0;
+        
+        for(int b = 0; b < 4; b++){
+            int j =    iy[b] - y0;
+            int j_up = min(iy[b] + 1, Spline.length_y - 1) - y0;
+            int j_dn = max(iy[b] - 1, 0) - y0;
+            
+            f_blk[a][b] = Vert_f[i][j];
+            if(order > 0){
+                double rdx_node = 1.0/(Spline.x_vals[i_up + x0] - Spline.x_vals[i_dn + x0]);
+                double rdy_node = 1.0/(Spline.y_vals[j_up + y0] - Spline.y_vals[j_dn + y0]);
+                
+                dfdz_blk[a][b] =    Vert_dfdz[i][j];
+                dfdx_blk[a][b] =    (Vert_f[i_up][j] - Vert_f[i_dn][j])*rdx_node;
+                dfdy_blk[a][b] =    (Vert_f[i][j_up] - Vert_f[i][j_dn])*rdy_node;
+                ddfdxdz_blk[a][b] = (Vert_dfdz[i_up][j] - Vert_dfdz[i_dn][j])*rdx_node;
+                ddfdydz_blk[a][b] = (Vert_dfdz[i][j_up] - Vert_dfdz[i][j_dn])*rdy_node;
             }
+            if(order > 1) ddfdzdz_blk[a][b] = Vert_ddfdzdz[i][j];
         }
+    }
     
-        // Evaluate approriate derivatives of df/dx(x,y) = Sum{k1,k2 = 0...3} c_{k1,k2} x^k1 y^k2
-        // where c_{k1,k2} = a[k1 + 4*k2]
-        dfdz = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            dfdz+=1.0*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
-    
-        ddfdxdz = 0;
-        for(int k1 = 1; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            ddfdxdz+=1.0*k1*A_vec[k1 + 4*k2]*pow(x_scaled,k1-1)*pow(y_scaled,k2)/dx_scalar;
-        }}
-    
-        ddfdydz = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 1; k2 < 4; k2++){
-            ddfdydz+=1.0*k2*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2-1)/dy_scalar;
-        }}   
-    
-    // Bicubic Spline d^2f/dz^2
-        X_vec[0] = Eval_Vert_Spline_ddfdzdz(z_eval, Spline, kx, ky, kz);
-        X_vec[1] = Eval_Vert_Spline_ddfdzdz(z_eval, Spline, kx+1, ky, kz);
-        X_vec[2] = Eval_Vert_Spline_ddfdzdz(z_eval, Spline, kx, ky+1, kz);
-        X_vec[3] = Eval_Vert_Spline_ddfdzdz(z_eval, Spline, kx+1, ky+1, kz);
-    
-        X_vec[4] = BiCubic_Deriv_dddfdxdzdz(z_eval, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[5] = BiCubic_Deriv_dddfdxdzdz(z_eval, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[6] = BiCubic_Deriv_dddfdxdzdz(z_eval, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[7] = BiCubic_Deriv_dddfdxdzdz(z_eval, Spline, kx+1, ky+1,kz)*dx_scalar;
-    
-        X_vec[8] =  BiCubic_Deriv_dddfdydzdz(z_eval, Spline, kx, ky,kz)*dx_scalar;
-        X_vec[9] =  BiCubic_Deriv_dddfdydzdz(z_eval, Spline, kx+1, ky,kz)*dx_scalar;
-        X_vec[10] = BiCubic_Deriv_dddfdydzdz(z_eval, Spline, kx, ky+1,kz)*dx_scalar;
-        X_vec[11] = BiCubic_Deriv_dddfdydzdz(z_eval, Spline, kx+1, ky+1,kz)*dx_scalar;
-    
-        X_vec[12]   = BiCubic_Deriv_ddddfdxdydzdz(z_eval, Spline, kx, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[13]   = BiCubic_Deriv_ddddfdxdydzdz(z_eval, Spline, kx+1, ky, kz)*dx_scalar*dy_scalar;
-        X_vec[14]	= BiCubic_Deriv_ddddfdxdydzdz(z_eval, Spline, kx, ky+1, kz)*dx_scalar*dy_scalar;
-        X_vec[15]   = BiCubic_Deriv_ddddfdxdydzdz(z_eval, Spline, kx+1, ky+1, kz)*dx_scalar*dy_scalar;
-    
-        // Set A[j] by matrix multiplication
-        for(int j = 0; j < 16; j++){
-            A_vec[j] = 0;
-            for(int k = 0; k < 16; k++){
-                A_vec[j] += BiCubic_ConversionMatrix[j][k]*X_vec[k];
-            }
-        }
+    double X_vec[16], dval_dx, dval_dy;
     
-        // Evaluate d^2f/dz^2(x,y) = Sum{k1,k2 = 0...3} c_{k1,k2} x^k1 y^k2
-        // where c_{k1,k2} = a[k1 + 4*k2]
-        ddfdzdz = 0;
-        for(int k1 = 0; k1 < 4; k1++){
-        for(int k2 = 0; k2 < 4; k2++){
-            ddfdzdz+=1.0*A_vec[k1 + 4*k2]*pow(x_scaled,k1)*pow(y_scaled,k2);
-        }}
+    // Bicubic spline f and evaluate it
+    for(int n = 0; n < 4; n++){
+        int a = n%2, b = n/2;
+        X_vec[n] =      f_blk[a+1][b+1];
+        X_vec[n + 4] =  Diff_x(f_blk, a, b, rdx)*dx_scalar;
+        X_vec[n + 8] =  Diff_y(f_blk, a, b, rdy)*dy_scalar;
+        X_vec[n + 12] = Diff_xy(f_blk, a, b, rdx, rdy)*dx_scalar*dy_scalar;
+    }
+    BiCubic_Patch(X_vec, x_scaled, y_scaled, result.f, dval_dx, dval_dy);
+    if(order < 1) return;
+    
+    // Bicubic spline df/dx and evaluate df/dx, d^2f/dx^2, and d^2f/dxdy
+    for(int n = 0; n < 4; n++){
+        int a = n%2, b = n/2;
+        X_vec[n] =      Diff_x(f_blk, a, b, rdx);
+        X_vec[n + 4] =  Diff_x(dfdx_blk, a, b, rdx)*dx_scalar;
+        X_vec[n + 8] =  Diff_xy(f_blk, a, b, rdx, rdy)*dy_scalar;
+        X_vec[n + 12] = Diff_xy(dfdx_blk, a, b, rdx, rdy)*dx_scalar*dy_scalar;
+    }
+    BiCubic_Patch(X_vec, x_scaled, y_scaled, result.df[0], dval_dx, dval_dy);
+    result.ddf[0][0] = dval_dx/dx_scalar;
+    result.ddf[0][1] = dval_dy/dy_scalar;
+    
+    // Bicubic spline df/dy and evaluate df/dy and d^2f/dy^2
+    for(int n = 0; n < 4; n++){
+        int a = n%2, b = n/2;
+        X_vec[n] =      Diff_y(f_blk, a, b, rdy);
+        X_vec[n + 4] =  Diff_xy(f_blk, a, b, rdx, rdy)*dx_scalar;
+        X_vec[n + 8] =  Diff_y(dfdy_blk, a, b, rdy)*dy_scalar;
+        X_vec[n + 12] = Diff_xy(dfdy_blk, a, b, rdx, rdy)*dx_scalar*dy_scalar;
+    }
+    BiCubic_Patch(X_vec, x_scaled, y_scaled, result.df[1], dval_dx, dval_dy);
+    result.ddf[1][1] = dval_dy/dy_scalar;
+    
+    // Bicubic spline df/dz and evaluate df/dz, d^2f/dxdz, and d^2f/dydz
+    for(int n = 0; n < 4; n++){
+        int a = n%2, b = n/2;
+        X_vec[n] =      dfdz_blk[a+1][b+1];
+        X_vec[n + 4] =  ddfdxdz_blk[a+1][b+1]*dx_scalar;
+        X_vec[n + 8] =  ddfdydz_blk[a+1][b+1]*dy_scalar;
+        X_vec[n + 12] = Diff_xy(dfdz_blk, a, b, rdx, rdy)*dx_scalar*dy_scalar;
+    }
+    BiCubic_Patch(X_vec, x_scaled, y_scaled, result.df[2], dval_dx, dval_dy);
+    result.ddf[0][2] = dval_dx/dx_scalar;
+    result.ddf[1][2] = dval_dy/dy_scalar;
+    
+    result.ddf[1][0] = result.ddf[0][1];
+    result.ddf[2][0] = result.ddf[0][2];
+    result.ddf[2][1] = result.ddf[1][2];
+    if(order < 2) return;
+    
+    // Bicubic spline d^2f/dz^2
+    for(int n = 0; n < 4; n++){
+        int a = n%2, b = n/2;
+        X_vec[n] =      ddfdzdz_blk[a+1][b+1];
+        X_vec[n + 4] =  Diff_x(ddfdzdz_blk, a, b, rdx)*dx_scalar;
+        X_vec[n + 8] =  Diff_y(ddfdzdz_blk, a, b, rdy)*dy_scalar;
+        X_vec[n + 12] = Diff_xy(ddfdzdz_blk, a, b, rdx, rdy)*dx_scalar*dy_scalar;
+    }
+    BiCubic_Patch(X_vec, x_scaled, y_scaled, result.ddf[2][2], dval_dx, dval_dy);
 }
 
 
@@ -1631,9 +557,6 @@ void Spline_Multi_G2S(char* profile_prefix, char* locx, char* locy, char* option
     Temp_Spline.y_vals = y_vals;            Windu_Spline.y_vals = y_vals;           Windv_Spline.y_vals = y_vals;           Density_Spline.y_vals = y_vals;
     Temp_Spline.z_vals = z_vals;            Windu_Spline.z_vals = z_vals;           Windv_Spline.z_vals = z_vals;           Density_Spline.z_vals = z_vals;
     Temp_Spline.f_vals = T_vals;            Windu_Spline.f_vals = u_vals;           Windv_Spline.f_vals = v_vals;           Density_Spline.f_vals = rho_vals;
-    Temp_Spline.f_slopes = T_slopes;        Windu_Spline.f_slopes = u_slopes;       Windv_Spline.f_slopes = v_slopes;       Density_Spline.f_slopes = rho_slopes;
-    Temp_Spline.dfdx_slopes = T_slopes_dx;  Windu_Spline.dfdx_slopes = u_slopes_dx; Windv_Spline.dfdx_slopes = v_slopes_dx; Density_Spline.dfdx_slopes = rho_slopes_dx;
-    Temp_Spline.dfdy_slopes = T_slopes_dy;  Windu_Spline.dfdy_slopes = u_slopes_dy; Windv_Spline.dfdy_slopes = v_slopes_dy; Density_Spline.dfdy_slopes = rho_slopes_dy;
     GeoAc_SetPropRegion();
     
     BuildSlopesArrays(Temp_Spline);     BuildSlopesArrays(Windu_Spline);
@@ -1653,12 +576,13 @@ void ClearAll(){
 //-------------------------------------//
 //---------Atmospheric Density---------//
 //-------------------------------------//
+thread_local struct MultiDimSpline_3D_Cursor G2S_Cursor = {{0, 0, 0}};  // Shared by the single-point functions below (per thread), evaluation loops should hold their own
+
 double rho(double x, double y, double z){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
+    struct MultiDimSpline_3D_Eval Density;
+    Eval_Spline_Fused(x, y, z, Density_Spline, G2S_Cursor, Density, 0);
     
-    return Eval_Spline_f(x_eval,y_eval,z_eval,Density_Spline);
+    return Density.f;
 }
 
 //-------------------------------------------//
@@ -1669,29 +593,25 @@ double rho(double x, double y, double z){
 double gamR = 0.00040187; // gamma * R in km^2/s^2 * 1/K, c(x,y,z) = sqrt(gamma*r*T(x,y,z))
 
 double c(double x, double y, double z){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
+    struct MultiDimSpline_3D_Eval Temp;
+    Eval_Spline_Fused(x, y, z, Temp_Spline, G2S_Cursor, Temp, 0);
     
-    return sqrt(gamR * Eval_Spline_f(x_eval,y_eval,z_eval,Temp_Spline));
+    return sqrt(gamR * Temp.f);
 }
 
 double c_diff(double x, double y, double z, int n){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
+    struct MultiDimSpline_3D_Eval Temp;
+    Eval_Spline_Fused(x, y, z, Temp_Spline, G2S_Cursor, Temp, 1);
     
-    return gamR / (2.0 * c(x,y,z)) * Eval_Spline_df(x_eval,y_eval,z_eval,n,Temp_Spline);
+    return gamR / (2.0 * sqrt(gamR * Temp.f)) * Temp.df[n];
 }
 
 double c_ddiff(double x, double y, double z, int n1, int n2){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
-    double SndSpd = c(x,y,z);
+    struct MultiDimSpline_3D_Eval Temp;
+    Eval_Spline_Fused(x, y, z, Temp_Spline, G2S_Cursor, Temp, 2);
+    double SndSpd = sqrt(gamR * Temp.f);
     
-    return gamR / (2.0 * SndSpd) * Eval_Spline_ddf(x_eval,y_eval,z_eval,n1,n2,Temp_Spline)
-             - pow(gamR,2)/(4.0 * pow(SndSpd,3)) * Eval_Spline_df(x_eval,y_eval,z_eval,n1,Temp_Spline)*Eval_Spline_df(x_eval,y_eval,z_eval,n2,Temp_Spline);
+    return gamR / (2.0 * SndSpd) * Temp.ddf[n1][n2] - pow(gamR,2)/(4.0 * pow(SndSpd,3)) * Temp.df[n1] * Temp.df[n2];
 }
 
 
@@ -1700,29 +620,25 @@ double c_ddiff(double x, double y, double z, int n1, int n2){
 //------------and its Derivatives-----------//
 //------------------------------------------//
 double u(double x, double y, double z){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
-
-    return Eval_Spline_f(x_eval, y_eval, z_eval, Windu_Spline);
+    struct MultiDimSpline_3D_Eval Windu;
+    Eval_Spline_Fused(x, y, z, Windu_Spline, G2S_Cursor, Windu, 0);
+    
+    return Windu.f;
 }
 
 
 double u_diff(double x, double y, double z, int n){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
+    struct MultiDimSpline_3D_Eval Windu;
+    Eval_Spline_Fused(x, y, z, Windu_Spline, G2S_Cursor, Windu, 1);
     
-    return Eval_Spline_df(x_eval, y_eval, z_eval, n, Windu_Spline);
-
+    return Windu.df[n];
 }
 
 double u_ddiff(double x, double y, double z, int n1, int n2){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
+    struct MultiDimSpline_3D_Eval Windu;
+    Eval_Spline_Fused(x, y, z, Windu_Spline, G2S_Cursor, Windu, 2);
     
-    return Eval_Spline_ddf(x_eval, y_eval, z_eval, n1, n2, Windu_Spline);
+    return Windu.ddf[n1][n2];
 }
 
 
@@ -1731,29 +647,25 @@ double u_ddiff(double x, double y, double z, int n1, int n2){
 //-------------and its Derivatives------------//
 //--------------------------------------------//
 double v(double x, double y, double z){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
+    struct MultiDimSpline_3D_Eval Windv;
+    Eval_Spline_Fused(x, y, z, Windv_Spline, G2S_Cursor, Windv, 0);
     
-    return Eval_Spline_f(x_eval, y_eval, z_eval, Windv_Spline);
+    return Windv.f;
 }
 
 
 double v_diff(double x, double y, double z, int n){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
-    
-    return Eval_Spline_df(x_eval, y_eval, z_eval, n, Windv_Spline);
+    struct MultiDimSpline_3D_Eval Windv;
+    Eval_Spline_Fused(x, y, z, Windv_Spline, G2S_Cursor, Windv, 1);
     
+    return Windv.df[n];
 }
 
 double v_ddiff(double x, double y, double z, int n1, int n2){
-    double x_eval = min(x, x_max);  x_eval = max(x_eval, x_min);    // Check that x_min <= x_eval <= x_max
-    double y_eval = min(y, y_max);  y_eval = max(y_eval, y_min);    // Check that y_min <= y_eval <= y_max
-    double z_eval = min(z, z_max);  z_eval = max(z_eval, z_min);    // Check that z_min <= z_eval <= z_max
+    struct MultiDimSpline_3D_Eval Windv;
+    Eval_Spline_Fused(x, y, z, Windv_Spline, G2S_Cursor, Windv, 2);
     
-    return Eval_Spline_ddf(x_eval, y_eval, z_eval, n1, n2, Windv_Spline);
+    return Windv.ddf[n1][n2];
 }
 
 
@@ -46,7 +46,7 @@ double GroundTopography(double x, double y){
 //------Parameters for Interpolation------//
 //----------------------------------------//
 int z_cnt;          // Number of vertical points
-int accel;          // Acceleration index
+thread_local int accel = 0;    // Index of previous table look up, shared by the splines (common z grid) and kept per thread
 double* z_vals;     // z_k elements (z_cnt length)
 
 double* T_vals;    // Temperature at (r_i, z_k) (r_cnt x z_cnt)
@@ -211,50 +211,43 @@ void Set_Slopes(struct NaturalCubicSpline_1D & Spline){
 //-----and Evaluate the 1D Vertical Splines------//
 //-----------------------------------------------//
 int Find_Segment(double x, double* x_vals, int length, int & prev){
-    int index = length + 1;
-    bool done = false;
+    // Points outside of the nodes are clamped to the first or last segment (the cubic there is extrapolated).
+    // Otherwise check the previous index and its neighbours, then the index implied by evenly spaced nodes
+    // (exact in O(1) for a uniform grid), and finally bisect for non-uniform grids.
+    int k_max = length - 2;
     
-    if(x > x_vals[length-1] || x < x_vals[0]){
-        cout << "Cannot interpolate outside of given bounds.  x = " << x << " is invalid." << '\n';
-    } else {
-        
-        // Check previous index and bounding segments
-        if(x >= x_vals[prev] && x <= x_vals[prev+1]){
-            done = true;
-        }
-
-        if(!done && prev+2 <= length-1){
-            if(x >= x_vals[prev+1] && x <= x_vals[prev+2]){
-                done = true;
-                prev = prev + 1;
-            }
-        }
-        if(!done && prev-1 >= 0){
-            if(x >= x_vals[prev-1] && x <= x_vals[prev]){
-                done = true;
-                prev = prev - 1;
-            }
-        }
+    if(x <= x_vals[0]){             prev = 0;       return prev;}
+    if(x >= x_vals[length-1]){      prev = k_max;   return prev;}
     
-        if(!done){
-            for(int i = 0; i < length; i++){
-                if(x >= x_vals[i] && x <= x_vals[i+1]){
-                    index = i;
-                    break;
-                }
-                if (x >= x_vals[length - 2 - i] && x < x_vals[length - 1 - i]){
-                    index = (length - 2) - i;
-                    break;
-                }
-            }
-            prev = index;
-        }
-        return prev;
+    // Check previous index and bounding segments
+    if(prev >= 0 && prev <= k_max){
+        if(x >= x_vals[prev]){
+            if(x <= x_vals[prev+1]){                                return prev;}
+            if(prev+1 <= k_max && x <= x_vals[prev+2]){ prev++;     return prev;}
+        } else if(prev-1 >= 0 && x >= x_vals[prev-1]){  prev--;     return prev;}
+    }
+    
+    // Uniform grid estimate
+    int k = int((x - x_vals[0])/(x_vals[length-1] - x_vals[0]) * (length - 1));
+    k = min(max(k, 0), k_max);
+    if(x >= x_vals[k] && x <= x_vals[k+1]){ prev = k;   return prev;}
+    
+    // Bisection keeping x_vals[lo] <= x < x_vals[hi], starting from the side of the estimate containing x
+    int lo = 0, hi = length - 1;
+    if(x < x_vals[k])   hi = k;
+    else                lo = k + 1;
+    
+    while(hi - lo > 1){
+        int mid = (lo + hi)/2;
+        if(x >= x_vals[mid])    lo = mid;
+        else                    hi = mid;
     }
+    prev = lo;
+    return prev;
 }
 
 double Eval_Spline_f(double x, struct NaturalCubicSpline_1D & Spline){
-    int k = Find_Segment(x, Spline.x_vals, Spline.length, Spline.accel);
+    int k = Find_Segment(x, Spline.x_vals, Spline.length, accel);
     
     if(k < Spline.length){
         double X = (x - Spline.x_vals[k])/(Spline.x_vals[k+1] - Spline.x_vals[k]);
@@ -266,7 +259,7 @@ double Eval_Spline_f(double x, struct NaturalCubicSpline_1D & Spline){
 }
 
 double Eval_Spline_df(double x, struct NaturalCubicSpline_1D & Spline){
-    int k = Find_Segment(x, Spline.x_vals, Spline.length, Spline.accel);
+    int k = Find_Segment(x, Spline.x_vals, Spline.length, accel);
     
     if(k < Spline.length){
         double X = (x - Spline.x_vals[k])/(Spline.x_vals[k+1] - Spline.x_vals[k]);
@@ -280,7 +273,7 @@ double Eval_Spline_df(double x, struct NaturalCubicSpline_1D & Spline){
 }
 
 double Eval_Spline_ddf(double x, struct NaturalCubicSpline_1D & Spline){
-    int k = Find_Segment(x, Spline.x_vals, Spline.length, Spline.accel);
+    int k = Find_Segment(x, Spline.x_vals, Spline.length, accel);
     
     if(k < Spline.length){
         double X = (x - Spline.x_vals[k])/(Spline.x_vals[k+1] - Spline.x_vals[k]);
@@ -305,7 +298,6 @@ void Spline_Single_G2S(char* file_name, char* format){
     SetUp_G2S_Arrays(file_name);
     
     Temp_Spline.length = z_cnt;     Windu_Spline.length = z_cnt;    Windv_Spline.length = z_cnt;    Density_Spline.length = z_cnt;
-    Temp_Spline.accel = accel;      Windu_Spline.accel = accel;     Windv_Spline.accel = accel;     Density_Spline.accel = accel;
     Temp_Spline.x_vals = z_vals;    Windu_Spline.x_vals = z_vals;   Windv_Spline.x_vals = z_vals;   Density_Spline.x_vals = z_vals;
     Temp_Spline.f_vals = T_vals;    Windu_Spline.f_vals = u_vals;   Windv_Spline.f_vals = v_vals;   Density_Spline.f_vals = rho_vals;
     Temp_Spline.slopes = T_slopes;  Windu_Spline.slopes = u_slopes; Windv_Spline.slopes = v_slopes; Density_Spline.slopes = rho_slopes;
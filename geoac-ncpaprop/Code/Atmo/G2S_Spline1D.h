@@ -47,7 +47,6 @@ void Clear_G2S_Arrays();                // Clear and delete the G2S arrays
 //-------------------------------------//
 struct NaturalCubicSpline_1D{
 	int length;			// Length of input files (x and f(x))
-    int accel;          // Index of previous table look up; used to increase spline speed
 	double* x_vals;     // 1D array of x values
 	double* f_vals;     // 1D array of f(x) values, f_vals[i] = f(x[i])
 	double* slopes;     // Slopes used to generate natural cubic spline solution
@@ -3,17 +3,26 @@
 
 using namespace std;
 
-//Initial angles at the source
-	extern double   GeoAc_theta;	// inclination angle of ray path
-	extern double   GeoAc_phi;      // azimuth angle of ray path
+//-------------------------------------------------------------//
+//------Solver context: launch angles, equation set config,----//
+//------and the source terms of the ray currently traced-------//
+//-------------------------------------------------------------//
+struct GeoAc_Sources_Struct;                // Defined by the equation set linked into each binary (GeoAc.EquationSets.*.cpp)
 
-// Parameters for configuring solver
-    extern int      GeoAc_EqCnt;		// Number of equations to solve
-    extern int      GeoAc_dim;          // Number of dimensions (2 or 3)
+struct GeoAcContext{
+	double  theta;                          // inclination angle of ray path
+	double  phi;                            // azimuth angle of ray path
 
-    extern bool     GeoAc_CalcAmp;      // Is amplitude to be calculated?
-    extern bool     GeoAc_AtmoStrat;	// Is the medium stratified?
+    int     EqCnt;                          // Number of equations to solve
+    int     dim;                            // Number of dimensions (2 or 3)
 
+    bool    CalcAmp;                        // Is amplitude to be calculated?
+    bool    AtmoStrat;                      // Is the medium stratified?
+
+    struct GeoAc_Sources_Struct* Sources;   // Per-ray source terms and atmosphere lookup state (owned, see GeoAc_InitContext)
+};
+
+// Parameters for configuring solver (shared by all contexts)
     extern double   GeoAc_ds_min;       // Smallest possible ds for solver
     extern double   GeoAc_ds_max;       // Largest possible ds for solver
 
@@ -43,7 +43,7 @@ double Modify_d_theta(double dr, double dr_dtheta){
 }
 
 
-bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double theta_min, double theta_max, double & theta_estimate, double & phi_estimate, double & theta_next, int bounces, double azimuth_error_limit){
+bool GeoAc_EstimateEigenray(GeoAcContext & ctx, double Source_Loc[3], double Receiver_Loc[2], double theta_min, double theta_max, double & theta_estimate, double & phi_estimate, double & theta_next, int bounces, double azimuth_error_limit){
     
     double GC_r_rcvr = Calc_GC_Distance(Source_Loc[0], Source_Loc[1], Receiver_Loc[0], Receiver_Loc[1]);
     double phi = Calc_Bearing(Source_Loc[0], Source_Loc[1], Receiver_Loc[0], Receiver_Loc[1]);
@@ -57,8 +57,8 @@ bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double
     theta_estimate = theta_max;
     
     double** solution;
-    GeoAc_ConfigureCalcAmp(false);                      // Only calculate the ray path geometry to accelerate the search.
-    GeoAc_BuildSolutionArray(solution, GeoAc_length);   // Build the array for the ray path.
+    GeoAc_ConfigureCalcAmp(ctx, false);                      // Only calculate the ray path geometry to accelerate the search.
+    GeoAc_BuildSolutionArray(ctx, solution, GeoAc_length);   // Build the array for the ray path.
     
     double r, r_prev, d_theta = d_theta_big, d_phi = 10.0;
     bool BreakCheck, success, theta_max_reached;
@@ -66,7 +66,7 @@ bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double
     success = 0;
     theta_max_reached = false;
     while(fabs(d_phi) > azimuth_error_limit && iterations < 5){
-        GeoAc_phi =     (90.0 - phi)*Pi/180.0;
+        ctx.phi =     (90.0 - phi)*Pi/180.0;
         r = GC_r_rcvr;
         r_prev = GC_r_rcvr;
         
@@ -74,14 +74,14 @@ bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double
         for(double theta = theta_min; theta < theta_max; theta+=d_theta){
             if(theta+d_theta >= theta_max) theta_max_reached = true;
             
-            GeoAc_theta =	theta*Pi/180.0;
-            GeoAc_SetInitialConditions(solution, Source_Loc[2], Source_Loc[0]*Pi/180.0, Source_Loc[1]*Pi/180.0);
+            ctx.theta =	theta*Pi/180.0;
+            GeoAc_SetInitialConditions(ctx, solution, Source_Loc[2], Source_Loc[0]*Pi/180.0, Source_Loc[1]*Pi/180.0);
             
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
             if(!BreakCheck){
                 for(int n_bnc = 1; n_bnc <= bounces; n_bnc++){
-                    GeoAc_SetReflectionConditions(solution,k);
-                    k = GeoAc_Propagate_RK4(solution, BreakCheck);
+                    GeoAc_SetReflectionConditions(ctx, solution,k);
+                    k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
                     if(BreakCheck) break;
                 }
             }
@@ -95,7 +95,7 @@ bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double
             }
             
             if(verbose_output){
-                cout << '\t' << '\t' << "Ray launched at inclination=" << GeoAc_theta * 180.0/Pi << " degrees arrives at range " << r;
+                cout << '\t' << '\t' << "Ray launched at inclination=" << ctx.theta * 180.0/Pi << " degrees arrives at range " << r;
                 cout << " km after " << bounces << " bounces.  Exact arrival at " << solution[k][1]*180.0/Pi << " degrees N latitude, " << solution[k][2]*180.0/Pi << " degrees E longitude" << '\n';
             }
             
@@ -136,7 +136,7 @@ bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double
 }
 
 
-void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double & lt, double & lp, double freq, int bnc_cnt, int iterate_limit, char title[]){
+void GeoAc_3DEigenray_LM(GeoAcContext & ctx, double Source_Loc[3], double Receiver_Loc[2], double & lt, double & lp, double freq, int bnc_cnt, int iterate_limit, char title[]){
 	bool BreakCheck;
     char output_buffer [60];
     ofstream raypath;
@@ -154,8 +154,8 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
     int	iterations = 0, k, GeoAc_length = GeoAc_ray_limit * int(1.0/(GeoAc_ds_min*10));
     double** solution;
     
-    GeoAc_ConfigureCalcAmp(true);
-    GeoAc_BuildSolutionArray(solution, GeoAc_length);
+    GeoAc_ConfigureCalcAmp(ctx, true);
+    GeoAc_BuildSolutionArray(ctx, solution, GeoAc_length);
 
     if(verbose_output) cout << '\t' << '\t' << "Searching for exact eigenray using auxiliary parameters." << '\n';
 	for(int n = 0; n <= iterate_limit; n++){
@@ -165,16 +165,16 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
         }
         
         // Initialize the solution array and calculate the ray path
-        GeoAc_theta =	lt*Pi/180.0;
-		GeoAc_phi = 	lp*Pi/180.0;
-		GeoAc_SetInitialConditions(solution, Source_Loc[2], Source_Loc[0]*Pi/180.0, Source_Loc[1]*Pi/180.0);
+        ctx.theta =	lt*Pi/180.0;
+		ctx.phi = 	lp*Pi/180.0;
+		GeoAc_SetInitialConditions(ctx, solution, Source_Loc[2], Source_Loc[0]*Pi/180.0, Source_Loc[1]*Pi/180.0);
         if(verbose_output) cout << '\t' << '\t' << "Plotting ray path with theta = " << lt << ", phi = " << 90.0 - lp;
 		
-        k = GeoAc_Propagate_RK4(solution, BreakCheck);
+        k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
         if(BreakCheck) break;
         for(int n_bnc = 1; n_bnc <= bnc_cnt; n_bnc++){
-            GeoAc_SetReflectionConditions(solution,k);
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
+            GeoAc_SetReflectionConditions(ctx, solution,k);
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
             if(BreakCheck) break;
         }
         if(BreakCheck) break;
@@ -199,35 +199,35 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
             attenuation = 0.0;
             travel_time = 0.0;
             
-            GeoAc_SetInitialConditions(solution, Source_Loc[2], Source_Loc[0]*Pi/180.0, Source_Loc[1]*Pi/180.0);
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
+            GeoAc_SetInitialConditions(ctx, solution, Source_Loc[2], Source_Loc[0]*Pi/180.0, Source_Loc[1]*Pi/180.0);
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
 
             for(int m=1;m<k;m++){
-                GeoAc_TravelTimeSegment(travel_time, solution, m-1,m);
-                GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
+                GeoAc_TravelTimeSegment(ctx, travel_time, solution, m-1,m);
+                GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
                     
                 if(m % 25 == 0){
                     raypath << solution[m][0] - r_earth;
                     raypath << '\t' << setprecision(8) << solution[m][1] * 180.0/Pi;
                     raypath << '\t' << setprecision(8) << solution[m][2] * 180.0/Pi;
-                    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));
+                    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));
                     raypath << '\t' << -attenuation;
                     raypath << '\t' << travel_time << '\n';
                 }
             }
             for(int n_bnc = 1; n_bnc <= bnc_cnt; n_bnc++){
-                GeoAc_SetReflectionConditions(solution,k);
+                GeoAc_SetReflectionConditions(ctx, solution,k);
                 
-                k = GeoAc_Propagate_RK4(solution, BreakCheck);
+                k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
                 for(int m = 1; m < k; m++){
-                    GeoAc_TravelTimeSegment(travel_time, solution, m-1,m);
-                    GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
+                    GeoAc_TravelTimeSegment(ctx, travel_time, solution, m-1,m);
+                    GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
                     
                     if(m % 25 == 0){
                         raypath << solution[m][0] - r_earth;
                         raypath << '\t' << solution[m][1]*180.0/3.14159;
                         raypath << '\t' << solution[m][2]*180.0/3.14159;
-                        raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));
+                        raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));
                         raypath << '\t' << attenuation;
                         raypath << '\t' << travel_time << '\n';
                     }
@@ -247,7 +247,7 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
                 cout << '\t' << '\t' << '\t' << "theta, phi = " << setprecision(8) << lt << ", " << 90.0 - lp << " degrees." << '\n';
                 cout << '\t' << '\t' << '\t' << "Travel Time = " << travel_time << " seconds." << '\n';
                 cout << '\t' << '\t' << '\t' << "Celerity = " << Calc_GC_Distance(Source_Loc[0], Source_Loc[1],Receiver_Loc[0],Receiver_Loc[1])/travel_time << " km/s." << '\n';
-                cout << '\t' << '\t' << '\t' << "Amplitude = " << 20.0*log10(GeoAc_Amplitude(solution,k)) << " dB." << '\n';
+                cout << '\t' << '\t' << '\t' << "Amplitude = " << 20.0*log10(GeoAc_Amplitude(ctx, solution,k)) << " dB." << '\n';
                 cout << '\t' << '\t' << '\t' << "Atmospheric Attenuation = " << -attenuation << " dB." << '\n';
                 cout << '\t' << '\t' << '\t' << "Arrival inclination = " << arrival_incl << " degrees." << '\n';
                 cout << '\t' << '\t' << '\t' << "Bearing to source = " << Calc_Bearing(Receiver_Loc[0], Receiver_Loc[1], Source_Loc[0], Source_Loc[1]) << " degrees." << '\n';
@@ -259,7 +259,7 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
             results << '\t' << "theta, phi = " << setprecision(8) << lt << ", " << 90.0 - lp << " degrees." << '\n';
             results << '\t' << "Travel Time = " << travel_time << " seconds." << '\n';
             results << '\t' << "Celerity = " << Calc_GC_Distance(Source_Loc[0], Source_Loc[1],Receiver_Loc[0],Receiver_Loc[1])/travel_time << " km/s." << '\n';
-            results << '\t' << "Amplitude (geometric) = " << 20.0*log10(GeoAc_Amplitude(solution,k)) << " dB." << '\n';
+            results << '\t' << "Amplitude (geometric) = " << 20.0*log10(GeoAc_Amplitude(ctx, solution,k)) << " dB." << '\n';
             results << '\t' << "Atmospheric attenuation = " << -attenuation << " dB." << '\n';
             results << '\t' << "Arrival inclination = " << arrival_incl << " degrees." << '\n';
             results << '\t' << "Bearing to source = " << Calc_Bearing(Receiver_Loc[0], Receiver_Loc[1], Source_Loc[0], Source_Loc[1]) << " degrees." << '\n';
@@ -313,7 +313,7 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
             dr_prev = dr;
         }
         // Clear the solution array and prepare to trace the new ray path
-        GeoAc_ClearSolutionArray(solution,k);
+        GeoAc_ClearSolutionArray(ctx, solution,k);
 	}
     GeoAc_DeleteSolutionArray(solution, GeoAc_length);
 }
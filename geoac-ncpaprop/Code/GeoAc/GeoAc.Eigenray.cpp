@@ -5,6 +5,12 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <atomic>
 
 #include "Atmo_State.h"
 #include "GeoAc.Parameters.h"
@@ -27,7 +33,7 @@ double Modify_d_theta(double dr, double dr_dtheta){
     return d_theta_big - (d_theta_big - d_theta_small) * exp(-dr*dr/width);
 }
 
-bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double theta_min, double theta_max, double & theta_estimate, double & phi_estimate, double & theta_next, int bounces, double azimuth_error_limit){
+bool GeoAc_EstimateEigenray(GeoAcContext & ctx, double Source_Loc[3], double Receiver_Loc[2], double theta_min, double theta_max, double & theta_estimate, double & phi_estimate, double & theta_next, int bounces, double azimuth_error_limit){
 
     double r_rcvr = sqrt(pow(Receiver_Loc[0] - Source_Loc[0], 2) + pow(Receiver_Loc[1] - Source_Loc[1], 2));
     double phi = 180.0/3.14159 * atan2(Receiver_Loc[1] - Source_Loc[1], Receiver_Loc[0] - Source_Loc[0]);
@@ -41,8 +47,8 @@ bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double
     theta_estimate = theta_max;
     
     double** solution;
-    GeoAc_ConfigureCalcAmp(false);                      // Only calculate the ray path geometry to accelerate the search.
-    GeoAc_BuildSolutionArray(solution, GeoAc_length);   // Build the array for the ray path.
+    GeoAc_ConfigureCalcAmp(ctx, false);                      // Only calculate the ray path geometry to accelerate the search.
+    GeoAc_BuildSolutionArray(ctx, solution, GeoAc_length);   // Build the array for the ray path.
     
     double r, r_prev, d_theta = d_theta_big, d_phi = 10.0;
     bool BreakCheck, success, theta_max_reached;
@@ -50,7 +56,7 @@ bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double
     success = 0;
     theta_max_reached = false;
     while(fabs(d_phi) > azimuth_error_limit && iterations < 5){
-        GeoAc_phi =     phi*Pi/180.0;
+        ctx.phi =     phi*Pi/180.0;
         r = r_rcvr;
         r_prev = r_rcvr;
 
@@ -58,14 +64,14 @@ bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double
         for(double theta = theta_min; theta <= theta_max; theta+=d_theta){
             if(theta + d_theta >= theta_max)  theta_max_reached = true;
             
-            GeoAc_theta =	theta*Pi/180.0;
-            GeoAc_SetInitialConditions(solution, Source_Loc[0], Source_Loc[1], Source_Loc[2]);
+            ctx.theta =	theta*Pi/180.0;
+            GeoAc_SetInitialConditions(ctx, solution, Source_Loc[0], Source_Loc[1], Source_Loc[2]);
         
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
             if(!BreakCheck){
                 for(int n_bnc = 1; n_bnc <= bounces; n_bnc++){
-                    GeoAc_SetReflectionConditions(solution,k);
-                    k = GeoAc_Propagate_RK4(solution, BreakCheck);
+                    GeoAc_SetReflectionConditions(ctx, solution,k);
+                    k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
                     if(BreakCheck) break;
                 }
             }
@@ -120,14 +126,13 @@ bool GeoAc_EstimateEigenray(double Source_Loc[3], double Receiver_Loc[2], double
     return false;
 }
 
-void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double & theta, double & phi, double freq, int bnc_cnt, int iterate_limit, char title[]){
-	bool BreakCheck;
-    char output_buffer [60];
-    ofstream raypath;
+bool GeoAc_3DEigenray_LM(GeoAcContext & ctx, double Source_Loc[3], double Receiver_Loc[2], double & theta, double & phi, double freq, int bnc_cnt, int iterate_limit, ostream & raypath, ostream & summary, ostream & console){
+	bool BreakCheck, found = false;
     double D, attenuation, back_az, back_az_dev, arrival_incl, dr, dr_prev = 10000.0, travel_time;
     double M_Comps[3], nu0[3], M, nu0_xy[2];
 
-    if(GeoAc_AtmoStrat){
+    GeoAc_ConfigureCalcAmp(ctx, true);
+    if(ctx.AtmoStrat){
         M_Comps[0] = u(Source_Loc[0], Source_Loc[1], Source_Loc[2]) / c(Source_Loc[0], Source_Loc[1], Source_Loc[2]);
         M_Comps[1] = v(Source_Loc[0], Source_Loc[1], Source_Loc[2]) / c(Source_Loc[0], Source_Loc[1], Source_Loc[2]);
         M_Comps[2] = w(Source_Loc[0], Source_Loc[1], Source_Loc[2]) / c(Source_Loc[0], Source_Loc[1], Source_Loc[2]);
@@ -145,43 +150,42 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
     int	k, GeoAc_length = GeoAc_ray_limit * int(1.0/(GeoAc_ds_min*10));
     double** solution;
     
-    GeoAc_ConfigureCalcAmp(true);
-    GeoAc_BuildSolutionArray(solution, GeoAc_length);
+    GeoAc_BuildSolutionArray(ctx, solution, GeoAc_length);
     
-    if(verbose_output) cout << '\t' << '\t' << "Searching for exact eigenray using auxiliary parameters." << '\n';
+    if(verbose_output) console << '\t' << '\t' << "Searching for exact eigenray using auxiliary parameters." << '\n';
 	for(int n = 0; n <= iterate_limit; n++){
         if(n == iterate_limit){
-            if(verbose_output){cout << '\t' <<'\t' << '\t' << "Search for exact eigenray maxed out iterations.  No eigenray idenfied." << '\n' << '\n';}
+            if(verbose_output){console << '\t' <<'\t' << '\t' << "Search for exact eigenray maxed out iterations.  No eigenray idenfied." << '\n' << '\n';}
             break;
         }
         
 		// Initialize the solution array and calculate the ray path
-    GeoAc_theta =	theta*Pi/180.0;
-		GeoAc_phi   = phi*Pi/180.0;
+    ctx.theta =	theta*Pi/180.0;
+		ctx.phi   = phi*Pi/180.0;
         
-        if(GeoAc_AtmoStrat){
-            nu0[0] = cos(GeoAc_theta) * cos(GeoAc_phi);
-            nu0[1] = cos(GeoAc_theta) * sin(GeoAc_phi);
-            nu0[2] = sin(GeoAc_theta);
+        if(ctx.AtmoStrat){
+            nu0[0] = cos(ctx.theta) * cos(ctx.phi);
+            nu0[1] = cos(ctx.theta) * sin(ctx.phi);
+            nu0[2] = sin(ctx.theta);
         
             M = 1.0 + (nu0[0] * M_Comps[0] + nu0[1] * M_Comps[1] + nu0[2] * M_Comps[2]);
             nu0_xy[0] = nu0[0] / M;
             nu0_xy[1] = nu0[1] / M;
         }
         
-        GeoAc_SetInitialConditions(solution, Source_Loc[0], Source_Loc[1], Source_Loc[2]);
-        if(verbose_output) cout << '\t' << '\t' << "Plotting ray path with theta = " << theta << ", phi = " << 90.0 - phi;
+        GeoAc_SetInitialConditions(ctx, solution, Source_Loc[0], Source_Loc[1], Source_Loc[2]);
+        if(verbose_output) console << '\t' << '\t' << "Plotting ray path with theta = " << theta << ", phi = " << 90.0 - phi;
 
-        k = GeoAc_Propagate_RK4(solution, BreakCheck);
+        k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
         if(BreakCheck){
-            if(verbose_output) cout << '\t' << "Ray path left propagation region." << '\n';
+            if(verbose_output) console << '\t' << "Ray path left propagation region." << '\n';
             break;
         }
         for(int n_bnc = 1; n_bnc <= bnc_cnt; n_bnc++){
-            GeoAc_SetReflectionConditions(solution,k);
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
+            GeoAc_SetReflectionConditions(ctx, solution,k);
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
             if(BreakCheck){
-                if(verbose_output) cout << '\t' << "Ray path left propagation region." << '\n';
+                if(verbose_output) console << '\t' << "Ray path left propagation region." << '\n';
                 break;
             }
         }
@@ -191,14 +195,11 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
         x = solution[k][0];     dx = Receiver_Loc[0] - x;
         y = solution[k][1];     dy = Receiver_Loc[1] - y;
         dr = sqrt(dx*dx+dy*dy);
-        if(verbose_output) cout << '\t' << '\t' << "Arrival after " << bnc_cnt << " reflections at (" << x << ", " << y << "), distance to receiver = " << dr << " km." << '\n';
+        if(verbose_output) console << '\t' << '\t' << "Arrival after " << bnc_cnt << " reflections at (" << x << ", " << y << "), distance to receiver = " << dr << " km." << '\n';
 
         if(dr < tolerance){ // found an eigenray
         
         
-            sprintf(output_buffer, "%s_Eigenray-%i.dat", title, eigenray_count);
-            raypath.open(output_buffer);
-            
             // DV  - save some info about the eigenray in the raypath file
 
             
@@ -230,8 +231,8 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
             attenuation = 0.0;
             travel_time = 0.0;
             
-            GeoAc_SetInitialConditions(solution, Source_Loc[0], Source_Loc[1], Source_Loc[2]);
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
+            GeoAc_SetInitialConditions(ctx, solution, Source_Loc[0], Source_Loc[1], Source_Loc[2]);
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
             
             //cout << "in GeoAc.Eigenray.cpp: k=" << k << endl;
             //cout << "GeoAc_AtmoStrat flag = " << GeoAc_AtmoStrat << endl;
@@ -243,14 +244,14 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
             double nu_0_xy[3], J;
             double c0 = c(Source_Loc[0], Source_Loc[1], Source_Loc[2]); 
     
-            if (GeoAc_AtmoStrat) {
+            if (ctx.AtmoStrat) {
               
               double u0 = u(Source_Loc[0], Source_Loc[1], Source_Loc[2]);
               double v0 = v(Source_Loc[0], Source_Loc[1], Source_Loc[2]);
               double w0 = w(Source_Loc[0], Source_Loc[1], Source_Loc[2]);
               
               double M_comps[3] = { u0/c0,   v0/c0,     w0/c0}; // initial v0/c0 vector where v0 is the wind vector  - Mach components      
-              double nu_0[3]    = { cos(GeoAc_theta) * cos(GeoAc_phi),  cos(GeoAc_theta) * sin(GeoAc_phi),    sin(GeoAc_theta)}; // n = initial unit vector in nthe direction of the ray
+              double nu_0[3]    = { cos(ctx.theta) * cos(ctx.phi),  cos(ctx.theta) * sin(ctx.phi),    sin(ctx.theta)}; // n = initial unit vector in nthe direction of the ray
               double M1 = 1.0 + (nu_0[0] * M_comps[0] + nu_0[1] * M_comps[1] + nu_0[2] * M_comps[2]); // 1 + v0/c0*n
               nu_0_xy[0] = nu_0[0]/M1;
               nu_0_xy[1] = nu_0[1]/M1; // n/(1+v0/c0*n) = c0*n/(c0+v0*n) = c0*initial_slowness_x; slowness here is the grad of eikonal as in Pierce; looks like Phil defines slowness as c0*grad(Pierce eikonal)
@@ -278,7 +279,7 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
               raypath << '\t' << u(solution[m][0], solution[m][1], solution[m][2]);
               raypath << '\t' << v(solution[m][0], solution[m][1], solution[m][2]);
               raypath << '\t' << w(solution[m][0], solution[m][1], solution[m][2]);
-              if (GeoAc_AtmoStrat) {
+              if (ctx.AtmoStrat) {
                 raypath << '\t' << nu_0_xy[0]/c0;     // slowness_x for stratified case
                 raypath << '\t' << nu_0_xy[1]/c0;     // slowness_y for stratified case
                 raypath << '\t' << solution[m][3]/c0; // slowness_z for stratified case
@@ -288,7 +289,7 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
                 raypath << '\t' << solution[m][4]/c0; // slowness_y
                 raypath << '\t' << solution[m][5]/c0; // slowness_z 
               }
-              J = GeoAc_Jacobian(solution, 0);
+              J = GeoAc_Jacobian(ctx, solution, 0);
               //cout << "at ground level J= " << J << endl;  
               raypath << '\t' << J << endl; // store the Jacobian        
             } 
@@ -296,12 +297,12 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
              
 
             for( int m = 1; m < k ; m++){
-                GeoAc_TravelTimeSegment(travel_time, solution, m-1,m);
-                GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
+                GeoAc_TravelTimeSegment(ctx, travel_time, solution, m-1,m);
+                GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
                 
                 // DV
                 // double GeoAc_Jacobian(double ** solution, int index)                
-                J = GeoAc_Jacobian(solution, m);
+                J = GeoAc_Jacobian(ctx, solution, m);
                 //cout << m << '\t' << J << endl;
                 //cout << m << '\t' << u(solution[m][0], solution[m][1], solution[m][2]) << endl;
                 //cout << m << '\t' << v(solution[m][0], solution[m][1], solution[m][2]) << endl;
@@ -314,7 +315,7 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
                     raypath << solution[m][0];
                     raypath << '\t' << solution[m][1];
                     raypath << '\t' << max(solution[m][2],0.0);
-                    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));
+                    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));
                     raypath << '\t' << -attenuation;
                     //raypath << '\t' << travel_time << '\n';
                     
@@ -329,7 +330,7 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
                     raypath << '\t' << u(solution[m][0], solution[m][1], solution[m][2]);
                     raypath << '\t' << v(solution[m][0], solution[m][1], solution[m][2]);
                     raypath << '\t' << w(solution[m][0], solution[m][1], solution[m][2]);
-                    if (GeoAc_AtmoStrat) {
+                    if (ctx.AtmoStrat) {
                       raypath << '\t' << nu_0_xy[0]/c0;     // slowness_x for stratified case
                       raypath << '\t' << nu_0_xy[1]/c0;     // slowness_y for stratified case
                       raypath << '\t' << solution[m][3]/c0; // slowness_z for stratified case
@@ -345,19 +346,19 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
             }
             
             for(int n_bnc = 1; n_bnc <= bnc_cnt; n_bnc++){
-                GeoAc_SetReflectionConditions(solution,k);
-                k = GeoAc_Propagate_RK4(solution, BreakCheck);
+                GeoAc_SetReflectionConditions(ctx, solution,k);
+                k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
 
                 for(int m = 1; m < k; m++){
-                    GeoAc_TravelTimeSegment(travel_time, solution, m-1,m);
-                    GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
-                    double J = GeoAc_Jacobian(solution, m); // DV
+                    GeoAc_TravelTimeSegment(ctx, travel_time, solution, m-1,m);
+                    GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
+                    double J = GeoAc_Jacobian(ctx, solution, m); // DV
                     
                     if(m % 25 == 0){
                         raypath << solution[m][0];
                         raypath << '\t' << solution[m][1];
                         raypath << '\t' << solution[m][2];
-                        raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));
+                        raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));
                         raypath << '\t' << attenuation;
                         //raypath << '\t' << travel_time << '\n';
                         
@@ -369,7 +370,7 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
                         raypath << '\t' << u(solution[m][0], solution[m][1], solution[m][2]);
                         raypath << '\t' << v(solution[m][0], solution[m][1], solution[m][2]);
                         raypath << '\t' << w(solution[m][0], solution[m][1], solution[m][2]);
-                        if (GeoAc_AtmoStrat) {
+                        if (ctx.AtmoStrat) {
                           raypath << '\t' << nu_0_xy[0]/c0;     // slowness_x for stratified case
                           raypath << '\t' << nu_0_xy[1]/c0;     // slowness_y for stratified case
                           raypath << '\t' << solution[m][3]/c0; // slowness_z for stratified case
@@ -385,10 +386,9 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
                 }
                 
             }
-            raypath.close();
             
-            if(GeoAc_AtmoStrat){
-                back_az = (90.0 - GeoAc_phi * 180.0/Pi) + 180.0;
+            if(ctx.AtmoStrat){
+                back_az = (90.0 - ctx.phi * 180.0/Pi) + 180.0;
                 arrival_incl = - asin(c(solution[k][0], solution[k][1], z_grnd) / c(Source_Loc[0], Source_Loc[1], Source_Loc[2]) * solution[k][3]) * 180.0 / Pi;
             } else {
                 back_az = 90.0 - atan2(-solution[k][4], -solution[k][3]) * 180.0 / Pi;
@@ -401,33 +401,31 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
             while(back_az_dev > 180.0)  back_az_dev-=360.0;
             while(back_az_dev < -180.0) back_az_dev+=360.0;
             
-            if(!verbose_output) cout << '\t' << "Eigenray identified:" << '\t' << "theta, phi = " << setprecision(8) << theta << ", " << 90.0 - phi << " degrees." << '\n';
+            if(!verbose_output) console << '\t' << "Eigenray identified:" << '\t' << "theta, phi = " << setprecision(8) << theta << ", " << 90.0 - phi << " degrees." << '\n';
             if(verbose_output){
-                cout << '\t' << '\t' << "Eigenray Identified:" << '\n';
-                cout << '\t' << '\t' << '\t' << "theta, phi = " << setprecision(8) << theta << ", " << 90.0 - phi << " degrees." << '\n';
-                cout << '\t' << '\t' << '\t' << "Travel Time = " << travel_time << " seconds." << '\n';
-                cout << '\t' << '\t' << '\t' <<  "Celerity = " << sqrt(pow(solution[k][0] - Source_Loc[0],2) + pow(solution[k][1] - Source_Loc[1],2))/travel_time << " km/s." << '\n';
-                cout << '\t' << '\t' << '\t' <<  "Amplitude (geometric) = " << 20.0*log10(GeoAc_Amplitude(solution,k)) << " dB." << '\n';
-                cout << '\t' << '\t' << '\t' <<  "Atmospheric Attenuation = " << -attenuation << " dB." << '\n';
-                cout << '\t' << '\t' << '\t' << "Arrival inclination = " << arrival_incl << " degrees." << '\n';
-                cout << '\t' << '\t' << '\t' <<  "Azimuth to source = " << 90.0 - atan2(Source_Loc[1] - Receiver_Loc[1], Source_Loc[0] - Receiver_Loc[0]) * 180.0/Pi << '\n';
-                cout << '\t' << '\t' << '\t' <<  "Back Azimuth of arrival = " << back_az << '\n';
-                cout << '\t' << '\t' << '\t' <<  "Azimuth Deviation = " << back_az_dev  << " degrees." << '\n' << '\n';
+                console << '\t' << '\t' << "Eigenray Identified:" << '\n';
+                console << '\t' << '\t' << '\t' << "theta, phi = " << setprecision(8) << theta << ", " << 90.0 - phi << " degrees." << '\n';
+                console << '\t' << '\t' << '\t' << "Travel Time = " << travel_time << " seconds." << '\n';
+                console << '\t' << '\t' << '\t' <<  "Celerity = " << sqrt(pow(solution[k][0] - Source_Loc[0],2) + pow(solution[k][1] - Source_Loc[1],2))/travel_time << " km/s." << '\n';
+                console << '\t' << '\t' << '\t' <<  "Amplitude (geometric) = " << 20.0*log10(GeoAc_Amplitude(ctx, solution,k)) << " dB." << '\n';
+                console << '\t' << '\t' << '\t' <<  "Atmospheric Attenuation = " << -attenuation << " dB." << '\n';
+                console << '\t' << '\t' << '\t' << "Arrival inclination = " << arrival_incl << " degrees." << '\n';
+                console << '\t' << '\t' << '\t' <<  "Azimuth to source = " << 90.0 - atan2(Source_Loc[1] - Receiver_Loc[1], Source_Loc[0] - Receiver_Loc[0]) * 180.0/Pi << '\n';
+                console << '\t' << '\t' << '\t' <<  "Back Azimuth of arrival = " << back_az << '\n';
+                console << '\t' << '\t' << '\t' <<  "Azimuth Deviation = " << back_az_dev  << " degrees." << '\n' << '\n';
             }
             
-            results << "Eigenray-" << eigenray_count << ".  " << bnc_cnt << " bounce(s)." << '\n';
-            results << '\t' << "theta, phi = " << setprecision(8) << theta << ", " << 90.0 - phi << " degrees." << '\n';
-            results << '\t' << "Travel Time = " << travel_time << " seconds." << '\n';
-            results << '\t' << "Celerity = " << sqrt(pow(solution[k][0] - Source_Loc[0],2) + pow(solution[k][1] - Source_Loc[1],2))/travel_time << " km/s." << '\n';
-            results << '\t' << "Amplitude (geometric) = " << 20.0*log10(GeoAc_Amplitude(solution,k)) << " dB." << '\n';
-            results << '\t' << "Atmospheric attenuation = " << -attenuation << " dB." << '\n';
-            results << '\t' << "Arrival inclination = " << arrival_incl << " degrees." << '\n';
-            results << '\t' << "Azimuth to source = " << 90.0 - atan2(Source_Loc[1] - Receiver_Loc[1], Source_Loc[0] - Receiver_Loc[0]) * 180.0/Pi << '\n';
-            results << '\t' << "Back azimuth of arrival = " << back_az << '\n';
-            results << '\t' << "Azimuth deviation = " << back_az_dev << " degrees." << '\n' << '\n';
-            
-            eigenray_count++;
+            summary << '\t' << "theta, phi = " << setprecision(8) << theta << ", " << 90.0 - phi << " degrees." << '\n';
+            summary << '\t' << "Travel Time = " << travel_time << " seconds." << '\n';
+            summary << '\t' << "Celerity = " << sqrt(pow(solution[k][0] - Source_Loc[0],2) + pow(solution[k][1] - Source_Loc[1],2))/travel_time << " km/s." << '\n';
+            summary << '\t' << "Amplitude (geometric) = " << 20.0*log10(GeoAc_Amplitude(ctx, solution,k)) << " dB." << '\n';
+            summary << '\t' << "Atmospheric attenuation = " << -attenuation << " dB." << '\n';
+            summary << '\t' << "Arrival inclination = " << arrival_incl << " degrees." << '\n';
+            summary << '\t' << "Azimuth to source = " << 90.0 - atan2(Source_Loc[1] - Receiver_Loc[1], Source_Loc[0] - Receiver_Loc[0]) * 180.0/Pi << '\n';
+            summary << '\t' << "Back azimuth of arrival = " << back_az << '\n';
+            summary << '\t' << "Azimuth deviation = " << back_az_dev << " degrees." << '\n' << '\n';
             
+            found = true;
             break;
         } else if(n > 0 && dr > dr_prev){
             // If the range to the receiver has increased, undo the previous changes to theta and phi,
@@ -438,14 +436,14 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
             step_scalar/=2.0;
             
             if(sqrt(dt*dt+dp*dp) * step_scalar < 1.0e-12){
-                if (verbose_output) cout << '\t' << '\t' <<  '\t' << "Step size too small, psuedo-critical ray path likely." << '\n' << '\n';
+                if (verbose_output) console << '\t' << '\t' <<  '\t' << "Step size too small, psuedo-critical ray path likely." << '\n' << '\n';
                 break;
             }
         } else {
             step_scalar = min(1.0, step_scalar * 1.25);
             
             // Calculate the transformation matrix to obtain dt and dp from dx and dy
-            if(GeoAc_AtmoStrat){
+            if(ctx.AtmoStrat){
                 dx_dt = solution[k][4] - nu0_xy[0] / solution[k][3] * solution[k][6];
                 dy_dt = solution[k][5] - nu0_xy[1] / solution[k][3] * solution[k][6];
                 dx_dp = solution[k][8] - nu0_xy[0] / solution[k][3] * solution[k][10];
@@ -471,9 +469,216 @@ void GeoAc_3DEigenray_LM(double Source_Loc[3], double Receiver_Loc[2], double &
             dr_prev = dr;
         }
         // Clear the solution array and prepare to trace the new ray path
-        GeoAc_ClearSolutionArray(solution,k);
+        GeoAc_ClearSolutionArray(ctx, solution,k);
 	}
     GeoAc_DeleteSolutionArray(solution, GeoAc_length);
+    
+    return found;
+}
+
+void GeoAc_3DEigenray_LM(GeoAcContext & ctx, double Source_Loc[3], double Receiver_Loc[2], double & theta, double & phi, double freq, int bnc_cnt, int iterate_limit, char title[]){
+    char output_buffer [60];
+    ostringstream raypath_buffer, summary_buffer;
+    
+    if(GeoAc_3DEigenray_LM(ctx, Source_Loc, Receiver_Loc, theta, phi, freq, bnc_cnt, iterate_limit, raypath_buffer, summary_buffer, cout)){
+        sprintf(output_buffer, "%s_Eigenray-%i.dat", title, eigenray_count);
+        ofstream raypath(output_buffer);
+        raypath << raypath_buffer.str();
+        raypath.close();
+        
+        results << "Eigenray-" << eigenray_count << ".  " << bnc_cnt << " bounce(s)." << '\n';
+        results << summary_buffer.str();
+        eigenray_count++;
+    }
+}
+
+
+//--------------------------------------------------------------//
+//-------Multiple receiver, multiple bounce eigenray search-----//
+//--------------------------------------------------------------//
+// Define the coarse fan used to seed the multiple receiver search (modifiable via command line)
+double d_theta_fan = 0.5;       // Inclination spacing of the fan (degrees)
+double d_phi_fan = 2.0;         // Azimuth spacing of the fan (degrees)
+double phi_fan_width = 8.0;     // Azimuths traced on either side of the direction to each receiver (degrees)
+
+struct GeoAc_EigenrayTask{
+    int rcvr;               // Receiver index
+    int bnc;                // Number of ground reflections
+    double theta, phi;      // Launch angles, estimated from the fan and then refined
+    bool found;             // Did the refinement converge?
+    string raypath;         // Eigenray path, written to file once all searches are complete
+    string summary;         // Eigenray summary for the results file
+    string console;         // Screen output of the refinement
+};
+
+// Run task(0)...task(task_cnt - 1) on a pool of threads, each thread takes the next task once its current one is finished
+template<typename Task> void GeoAc_RunThreadPool(int task_cnt, int thread_cnt, Task task){
+    atomic<int> next(0);
+    vector<thread> pool;
+    
+    for(int n = 0; n < max(1, min(thread_cnt, task_cnt)); n++){
+        pool.push_back(thread([&](){
+            for(int k = next++; k < task_cnt; k = next++) task(k);
+        }));
+    }
+    for(int n = 0; n < int(pool.size()); n++) pool[n].join();
+}
+
+// Check if p lies in the triangle (a, b, c) and compute its barycentric weights
+bool GeoAc_InTriangle(double p[2], double a[2], double b[2], double c[2], double w[3]){
+    double det = (b[1] - c[1])*(a[0] - c[0]) + (c[0] - b[0])*(a[1] - c[1]);
+    if(fabs(det) < 1.0e-12) return false;
+    
+    w[0] = ((b[1] - c[1])*(p[0] - c[0]) + (c[0] - b[0])*(p[1] - c[1]))/det;
+    w[1] = ((c[1] - a[1])*(p[0] - c[0]) + (a[0] - c[0])*(p[1] - c[1]))/det;
+    w[2] = 1.0 - w[0] - w[1];
+    
+    return (w[0] >= 0.0 && w[1] >= 0.0 && w[2] >= 0.0);
+}
+
+void GeoAc_3DEigenray_Multi(double Source_Loc[3], double Receiver_Locs[][2], int rcvr_cnt, double theta_min, double theta_max, int bnc_min, int bnc_max, double freq, int iterate_limit, int thread_cnt, char title[]){
+    int GeoAc_length = GeoAc_ray_limit * int(1.0/(GeoAc_ds_min*10));
+    
+    // Collect the fan azimuths (as multiples of d_phi_fan) needed to bracket the arrivals at each receiver
+    set<int> col_set;
+    for(int r = 0; r < rcvr_cnt; r++){
+        double phi_rcvr = atan2(Receiver_Locs[r][1] - Source_Loc[1], Receiver_Locs[r][0] - Source_Loc[0])*180.0/Pi;
+        for(int j = int(floor((phi_rcvr - phi_fan_width)/d_phi_fan)); j <= int(ceil((phi_rcvr + phi_fan_width)/d_phi_fan)); j++){
+            col_set.insert(j);
+        }
+    }
+    vector<int> cols(col_set.begin(), col_set.end());
+    int col_cnt = cols.size(), theta_cnt = int((theta_max - theta_min)/d_theta_fan) + 1, bnc_cnt = bnc_max + 1;
+    
+    // Trace the fan once, geometry only, storing the arrival after each reflection for all receivers and bounce counts
+    vector<double> fan_x(col_cnt*theta_cnt*bnc_cnt), fan_y(col_cnt*theta_cnt*bnc_cnt);
+    vector<char> fan_valid(col_cnt*theta_cnt*bnc_cnt, 0);
+    
+    cout << "Tracing coarse fan of " << col_cnt*theta_cnt << " ray paths (" << col_cnt << " azimuths, " << theta_cnt << " inclinations) using " << thread_cnt << " thread(s)." << '\n';
+    GeoAc_RunThreadPool(col_cnt, thread_cnt, [&](int col){
+        GeoAcContext ctx;
+        bool BreakCheck;
+        double** solution;
+        
+        GeoAc_InitContext(ctx);
+        GeoAc_ConfigureCalcAmp(ctx, false);
+        GeoAc_BuildSolutionArray(ctx, solution, GeoAc_length);
+        
+        ctx.phi = cols[col]*d_phi_fan*Pi/180.0;
+        for(int i = 0; i < theta_cnt; i++){
+            ctx.theta = (theta_min + i*d_theta_fan)*Pi/180.0;
+            GeoAc_SetInitialConditions(ctx, solution, Source_Loc[0], Source_Loc[1], Source_Loc[2]);
+            
+            int k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
+            for(int n_bnc = 0; n_bnc <= bnc_max; n_bnc++){
+                if(n_bnc > 0 && !BreakCheck){
+                    GeoAc_SetReflectionConditions(ctx, solution, k);
+                    k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
+                }
+                int n = (col*theta_cnt + i)*bnc_cnt + n_bnc;
+                fan_valid[n] = !BreakCheck;
+                fan_x[n] = solution[k][0];
+                fan_y[n] = solution[k][1];
+            }
+        }
+        GeoAc_DeleteSolutionArray(solution, GeoAc_length);
+        GeoAc_ClearContext(ctx);
+    });
+    
+    // Seed a refinement for every fan cell whose arrivals enclose a receiver
+    vector<GeoAc_EigenrayTask> tasks;
+    for(int r = 0; r < rcvr_cnt; r++){
+    for(int n_bnc = bnc_min; n_bnc <= bnc_max; n_bnc++){
+        int first_task = tasks.size();
+        for(int col = 0; col < col_cnt - 1; col++){
+            if(cols[col + 1] != cols[col] + 1) continue;
+            
+            for(int i = 0; i < theta_cnt - 1; i++){
+                int corner[4] = {(col*theta_cnt + i)*bnc_cnt + n_bnc,           ((col + 1)*theta_cnt + i)*bnc_cnt + n_bnc,
+                                 ((col + 1)*theta_cnt + i + 1)*bnc_cnt + n_bnc, (col*theta_cnt + i + 1)*bnc_cnt + n_bnc};
+                if(!fan_valid[corner[0]] || !fan_valid[corner[1]] || !fan_valid[corner[2]] || !fan_valid[corner[3]]) continue;
+                
+                double arrival[4][2], theta_crnr[4], phi_crnr[4], w[3];
+                for(int m = 0; m < 4; m++){
+                    arrival[m][0] = fan_x[corner[m]];
+                    arrival[m][1] = fan_y[corner[m]];
+                    theta_crnr[m] = theta_min + (i + (m/2))*d_theta_fan;
+                    phi_crnr[m] = (cols[col] + ((m==1 || m==2) ? 1 : 0))*d_phi_fan;
+                }
+                
+                for(int tri = 0; tri < 2; tri++){
+                    int m1 = (tri==0) ? 1 : 2, m2 = (tri==0) ? 2 : 3;
+                    if(GeoAc_InTriangle(Receiver_Locs[r], arrival[0], arrival[m1], arrival[m2], w)){
+                        GeoAc_EigenrayTask task;
+                        task.rcvr = r;
+                        task.bnc = n_bnc;
+                        task.theta = w[0]*theta_crnr[0] + w[1]*theta_crnr[m1] + w[2]*theta_crnr[m2];
+                        task.phi =   w[0]*phi_crnr[0] + w[1]*phi_crnr[m1] + w[2]*phi_crnr[m2];
+                        task.found = false;
+                        tasks.push_back(task);
+                        break;
+                    }
+                }
+            }
+        }
+        
+        // Order the estimates for each receiver and bounce count by inclination
+        for(int t1 = first_task + 1; t1 < int(tasks.size()); t1++){
+            for(int t2 = t1; t2 > first_task && tasks[t2].theta < tasks[t2 - 1].theta; t2--) swap(tasks[t2], tasks[t2 - 1]);
+        }
+    }}
+    
+    // Refine the estimates in parallel, each search uses its own solver context and buffers its output
+    cout << "Refining " << tasks.size() << " eigenray estimate(s) to " << rcvr_cnt << " receiver(s) using " << thread_cnt << " thread(s)." << '\n';
+    GeoAc_RunThreadPool(tasks.size(), thread_cnt, [&](int t){
+        GeoAcContext ctx;
+        ostringstream raypath_buffer, summary_buffer, console_buffer;
+        
+        GeoAc_InitContext(ctx);
+        tasks[t].found = GeoAc_3DEigenray_LM(ctx, Source_Loc, Receiver_Locs[tasks[t].rcvr], tasks[t].theta, tasks[t].phi, freq, tasks[t].bnc, iterate_limit, raypath_buffer, summary_buffer, console_buffer);
+        GeoAc_ClearContext(ctx);
+        
+        tasks[t].raypath = raypath_buffer.str();
+        tasks[t].summary = summary_buffer.str();
+        tasks[t].console = console_buffer.str();
+    });
+    
+    // Write the eigenrays in receiver, bounce, inclination order; neighbouring cells of the fan can converge to the same eigenray
+    char output_buffer [60];
+    int t = 0;
+    for(int r = 0; r < rcvr_cnt; r++){
+        cout << "Receiver-" << r << " at (" << Receiver_Locs[r][0] << ", " << Receiver_Locs[r][1] << ")." << '\n';
+        results << "Receiver-" << r << ".  Location (kilometers) : (" << Receiver_Locs[r][0] << ", " << Receiver_Locs[r][1] << ", " << z_grnd << ")." << '\n' << '\n';
+        
+        for(int first_task = t; t < int(tasks.size()) && tasks[t].rcvr == r; t++){
+            if(!tasks[t].found){
+                cout << tasks[t].console;
+                continue;
+            }
+            
+            bool duplicate = false;
+            for(int t_prev = first_task; t_prev < t; t_prev++){
+                if(tasks[t_prev].found && tasks[t_prev].bnc == tasks[t].bnc && fabs(tasks[t_prev].theta - tasks[t].theta) < 0.01 && fabs(tasks[t_prev].phi - tasks[t].phi) < 0.01){
+                    duplicate = true;
+                    break;
+                }
+            }
+            if(duplicate){
+                tasks[t].found = false;
+                continue;
+            }
+            cout << tasks[t].console;
+            
+            sprintf(output_buffer, "%s_Eigenray-%i.dat", title, eigenray_count);
+            ofstream raypath(output_buffer);
+            raypath << tasks[t].raypath;
+            raypath.close();
+            
+            results << "Eigenray-" << eigenray_count << ".  " << tasks[t].bnc << " bounce(s)." << '\n';
+            results << tasks[t].summary;
+            eigenray_count++;
+        }
+    }
 }
 
 #endif /* GEOAC_EIGENRAY_CPP_ */
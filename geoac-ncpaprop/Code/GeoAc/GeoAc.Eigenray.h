@@ -5,6 +5,8 @@
 #include <iostream>
 #include <fstream>
 
+#include "GeoAc.Parameters.h"
+
 
 using namespace std;
 
@@ -14,12 +16,19 @@ extern double d_theta_big;
 extern double d_theta_small;
 extern ofstream results;
 
+extern double d_theta_fan;
+extern double d_phi_fan;
+extern double phi_fan_width;
+
 double Calc_Bearing(double, double, double, double);        // Function to calculate bearing between two lat/long locations
 double Calc_GC_Distance(double, double, double, double);    // Function to calculate great circle distance between two lat/long locations
 
 double Modify_d_theta(double, double);                      // Function to modify d_theta in GeoAc_EstimateEigenray function
 
-bool GeoAc_EstimateEigenray(double [3], double [2], double, double, double &, double &, double &, int, double);  // Function to identify inclination at fixed azimuth for specified arrival range
-void GeoAc_3DEigenray_LM(double [3], double [2], double &, double &, double, int, int, char []);       // Function to identify exact eigenray
+bool GeoAc_EstimateEigenray(GeoAcContext &, double [3], double [2], double, double, double &, double &, double &, int, double);  // Function to identify inclination at fixed azimuth for specified arrival range
+void GeoAc_3DEigenray_LM(GeoAcContext &, double [3], double [2], double &, double &, double, int, int, char []);       // Function to identify exact eigenray
+bool GeoAc_3DEigenray_LM(GeoAcContext &, double [3], double [2], double &, double &, double, int, int, ostream &, ostream &, ostream &);  // Function to identify exact eigenray, writing the ray path, summary, and screen output to streams
+
+void GeoAc_3DEigenray_Multi(double [3], double [][2], int, double, double, int, int, double, int, int, char []);    // Function to identify eigenrays to multiple receivers from a single coarse fan of rays
 
 #endif /* GEOAC_EIGENRAY_H_ */
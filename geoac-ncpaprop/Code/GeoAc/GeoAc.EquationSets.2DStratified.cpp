@@ -13,9 +13,9 @@ using namespace std;
 //----------------------------------------------//
 //-------Propagate in 2D, assume stratified-----//
 //----------------------------------------------//
-void GeoAc_SetSystem(){
-    GeoAc_dim = 2;				// Dimensions
-    GeoAc_AtmoStrat = true;     // Is the medium stratified?
+void GeoAc_SetSystem(GeoAcContext & ctx){
+    ctx.dim = 2;				// Dimensions
+    ctx.AtmoStrat = true;     // Is the medium stratified?
 }
 
 //-----------------------------------------------------------//
@@ -30,15 +30,32 @@ struct GeoAc_Sources_Struct{
 	double c_eff_ddiff;		// d^2 c/d z^2 = c''
 };
 
-	struct GeoAc_Sources_Struct GeoAc_Sources = {0.0, 0.0, 0.0, 0.0};
+//-----------------------------------------------------------//
+//-------Allocate and release the per-ray source terms-------//
+//-------------------held by a solver context----------------//
+//-----------------------------------------------------------//
+void GeoAc_InitContext(GeoAcContext & ctx){
+    ctx.theta = 0.0;
+    ctx.phi = 0.0;
+    ctx.EqCnt = 0;                                      // Set by GeoAc_ConfigureCalcAmp
+    ctx.CalcAmp = false;
+    ctx.Sources = new struct GeoAc_Sources_Struct();
+    GeoAc_SetSystem(ctx);
+}
+
+void GeoAc_ClearContext(GeoAcContext & ctx){
+    delete ctx.Sources;
+    ctx.Sources = NULL;
+}
 
 //----------------------------------------------------------------------//
 //-------Fill in solution[0][n] with the appropriate initial values-----//
 //----------------------------------------------------------------------//
-void GeoAc_SetInitialConditions(double ** & solution, double r0, double z0){
-	GeoAc_Sources.c_eff_0 = c(0.0,0.0,z0) + u(0.0,0.0,z0)*cos(GeoAc_phi) + v(0.0,0.0,z0)*sin(GeoAc_phi);
+void GeoAc_SetInitialConditions(GeoAcContext & ctx, double ** & solution, double r0, double z0){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
+	src.c_eff_0 = c(0.0,0.0,z0) + u(0.0,0.0,z0)*cos(ctx.phi) + v(0.0,0.0,z0)*sin(ctx.phi);
 
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		switch(index){
 			case(0):			// r(0) = 0
                 solution[0][index] = r0;
@@ -54,11 +71,11 @@ void GeoAc_SetInitialConditions(double ** & solution, double r0, double z0){
 				break;
 
 			case(2):			// nu_z(0) = sin(theta)
-				solution[0][index] =  sin(GeoAc_theta);
+				solution[0][index] =  sin(ctx.theta);
 				break;
 			
             case(5):			// dnu_z dtheta(0) = cos(theta)
-				solution[0][index] =  cos(GeoAc_theta);
+				solution[0][index] =  cos(ctx.theta);
 				break;
 			
             default:
@@ -71,11 +88,11 @@ void GeoAc_SetInitialConditions(double ** & solution, double r0, double z0){
 //--------------------------------------------------------------------------//
 //-------Taylor series fit to more accurately deterine intercept values-----//
 //--------------------------------------------------------------------------//
-void GeoAc_ApproximateIntercept(double ** solution, int k, double* & prev){
+void GeoAc_ApproximateIntercept(GeoAcContext & ctx, double ** solution, int k, double* & prev){
 	double dz_k = solution[k][1] - solution[k-1][1];    // set dz for step = z_k - z_{k-1}
 	double dz_grnd = solution[k-1][1] - z_grnd;         // set dz from z_{k-1} to ground
 
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		prev[index] = solution[k-1][index] + (solution[k-1][index] - solution[k][index])/dz_k*dz_grnd
 						+ 1.0/2.0*(solution[k][index] + solution[k-2][index] - 2.0*solution[k-1][index])/pow(dz_k,2.0)*pow(dz_grnd,2.0);
 		
@@ -85,14 +102,15 @@ void GeoAc_ApproximateIntercept(double ** solution, int k, double* & prev){
 //-------------------------------------------------------------------------//
 //-------Fill in solution[0][n] with the appropriate reflection values-----//
 //-------------------------------------------------------------------------//
-void GeoAc_SetReflectionConditions(double** & solution, int k_end){
-	double* prev = new double [GeoAc_EqCnt];
-	GeoAc_ApproximateIntercept(solution, k_end, prev);
+void GeoAc_SetReflectionConditions(GeoAcContext & ctx, double** & solution, int k_end){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
+	double* prev = new double [ctx.EqCnt];
+	GeoAc_ApproximateIntercept(ctx, solution, k_end, prev);
 
-    double c_eff_diff = c_diff(0.0,0.0,z_grnd,2) + u_diff(0.0,0.0,z_grnd,2)*cos(GeoAc_phi) + v_diff(0.0,0.0,z_grnd,2)*sin(GeoAc_phi);
-    double dnuz_ds = - GeoAc_Sources.c_eff_0 / pow(c(0.0,0.0,z_grnd),2) * c_eff_diff;
+    double c_eff_diff = c_diff(0.0,0.0,z_grnd,2) + u_diff(0.0,0.0,z_grnd,2)*cos(ctx.phi) + v_diff(0.0,0.0,z_grnd,2)*sin(ctx.phi);
+    double dnuz_ds = - src.c_eff_0 / pow(c(0.0,0.0,z_grnd),2) * c_eff_diff;
     
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		switch(index){
 			case(0):			// r(0) = r(s0)
 			case(3):			// R(0) = R(s0)
@@ -107,7 +125,7 @@ void GeoAc_SetReflectionConditions(double** & solution, int k_end){
 				solution[0][index] = -prev[index];
 				break;
 			case(5):			// mu_zt(0) =  	-mu_z(s0) + 2 d nu_z/ ds * ds0/dtheta
-				solution[0][index] = -prev[index] + 2.0 * dnuz_ds * prev[4]/(c(0.0,0.0,z_grnd)/GeoAc_Sources.c_eff_0 * prev[2]);
+				solution[0][index] = -prev[index] + 2.0 * dnuz_ds * prev[4]/(c(0.0,0.0,z_grnd)/src.c_eff_0 * prev[2]);
 				break;
 			default:
 				cout << "Unexpected index in Initial_Cond.  Model includes 6 variables." << '\n';
@@ -132,16 +150,17 @@ double GeoAc_Set_ds(double* current_values){
 //---------------------------------------//
 //-------Update the source functions-----//
 //---------------------------------------//
-void GeoAc_UpdateSources(double ray_length, double* current_values){
+void GeoAc_UpdateSources(GeoAcContext & ctx, double ray_length, double* current_values){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double z = current_values[1];			// Extract current z value
 	
-	GeoAc_Sources.c_eff = c(0,0,z) + u(0,0,z)*cos(GeoAc_phi) + v(0,0,z)*sin(GeoAc_phi);	// Update c_{eff}
-	GeoAc_Sources.c_eff_diff = c_diff(0,0,z,2) + u_diff(0,0,z,2)*cos(GeoAc_phi)			// Update d/dz c_{eff}
-									+ v_diff(0,0,z,2)*sin(GeoAc_phi);							
+	src.c_eff = c(0,0,z) + u(0,0,z)*cos(ctx.phi) + v(0,0,z)*sin(ctx.phi);	// Update c_{eff}
+	src.c_eff_diff = c_diff(0,0,z,2) + u_diff(0,0,z,2)*cos(ctx.phi)			// Update d/dz c_{eff}
+									+ v_diff(0,0,z,2)*sin(ctx.phi);							
 
-	if(GeoAc_CalcAmp){
-		GeoAc_Sources.c_eff_ddiff = c_ddiff(0,0,z,2,2) + u_ddiff(0,0,z,2,2)*cos(GeoAc_phi) // Update 2nd derivative
-										+ v_ddiff(0,0,z,2,2)*sin(GeoAc_phi);
+	if(ctx.CalcAmp){
+		src.c_eff_ddiff = c_ddiff(0,0,z,2,2) + u_ddiff(0,0,z,2,2)*cos(ctx.phi) // Update 2nd derivative
+										+ v_ddiff(0,0,z,2,2)*sin(ctx.phi);
 	}
 
 }
@@ -149,17 +168,18 @@ void GeoAc_UpdateSources(double ray_length, double* current_values){
 //-----------------------------------------------------------//
 //-------Evaluate the Source Equation For Specific Index-----//
 //-----------------------------------------------------------//
-double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number){
+double GeoAc_EvalSrcEq(GeoAcContext & ctx, double ray_length, double* current_values, int Eq_Number){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double result;
 	
 	double nu_z =	current_values [2];		double dzt = current_values [4];
 	double mu_z =  current_values [5];
-	double c = GeoAc_Sources.c_eff;			double c0 = GeoAc_Sources.c_eff_0;
-	double dc = GeoAc_Sources.c_eff_diff;	double ddc = GeoAc_Sources.c_eff_ddiff;
+	double c = src.c_eff;			double c0 = src.c_eff_0;
+	double dc = src.c_eff_diff;	double ddc = src.c_eff_ddiff;
 	
 	switch(Eq_Number){
 		case(0): // dr/ds
-			result = c/c0*cos(GeoAc_theta);
+			result = c/c0*cos(ctx.theta);
 			break;
 		case(1): // dz/ds
 			result = c/c0*nu_z;
@@ -168,7 +188,7 @@ double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number)
 			result = -c0/pow(c,2)*dc;
 			break;
 		case(3): // dR/ds
-			result = dc*dzt/c0*cos(GeoAc_theta) - c/c0*sin(GeoAc_theta);
+			result = dc*dzt/c0*cos(ctx.theta) - c/c0*sin(ctx.theta);
 			break;
 		case(4): // dZ/ds
 			result = dc*dzt/c0*nu_z + c/c0*mu_z;
@@ -183,15 +203,16 @@ double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number)
 //-------------------------------------------------------------------//
 //-------Calculate the Hamiltonian (Eikonal) To Check For Errors-----//
 //-------------------------------------------------------------------//
-double GeoAc_EvalHamiltonian(double ray_length, double* current_values){
-	double nu = sqrt( pow(cos(GeoAc_theta),2) + pow(current_values[2], 2));
-	return nu - GeoAc_Sources.c_eff_0/GeoAc_Sources.c_eff;
+double GeoAc_EvalHamiltonian(GeoAcContext & ctx, double ray_length, double* current_values){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
+	double nu = sqrt( pow(cos(ctx.theta),2) + pow(current_values[2], 2));
+	return nu - src.c_eff_0/src.c_eff;
 }
 
 //--------------------------------------------------------------------------//
 //-------Check if ray has left propagation region or returned to ground-----//
 //--------------------------------------------------------------------------//
-bool GeoAc_BreakCheck(double ** solution, int index){
+bool GeoAc_BreakCheck(GeoAcContext & ctx, double ** solution, int index){
 	double r 	= solution[index][0];
 	double z 	= solution[index][1];
 	
@@ -214,7 +235,7 @@ bool GeoAc_GroundCheck(double ** solution, int index){
 //----------------------------------------------------------------------------------//
 //-------Calculate the travel time from source to location or between locations-----//
 //----------------------------------------------------------------------------------//
-double GeoAc_TravelTime(double ** solution, int index){
+double GeoAc_TravelTime(GeoAcContext & ctx, double ** solution, int index){
 	double dr, dz, ds, z_avg, c_eff;
 	double traveltime = 0.0;
 
@@ -223,7 +244,7 @@ double GeoAc_TravelTime(double ** solution, int index){
 		dz = solution[n+1][1] - solution[n][1];
 		z_avg = solution[n][1] + dz/2.0;
 
-		c_eff = c(0,0,z_avg) + u(0,0,z_avg)*cos(GeoAc_phi) + v(0,0,z_avg)*sin(GeoAc_phi);
+		c_eff = c(0,0,z_avg) + u(0,0,z_avg)*cos(ctx.phi) + v(0,0,z_avg)*sin(ctx.phi);
 
 		ds = sqrt(pow(dr,2) + pow(dz,2));
 
@@ -232,7 +253,7 @@ double GeoAc_TravelTime(double ** solution, int index){
 	return traveltime;	
 }
 
-void GeoAc_TravelTimeSegment(double & time, double ** solution, int start, int end){
+void GeoAc_TravelTimeSegment(GeoAcContext & ctx, double & time, double ** solution, int start, int end){
 	double dr, dz, ds, z_avg, c_eff;
     
 	for (int n = start; n < end; n++){
@@ -240,7 +261,7 @@ void GeoAc_TravelTimeSegment(double & time, double ** solution, int start, int e
 		dz = solution[n+1][1] - solution[n][1];
 		z_avg = solution[n][1] + dz/2.0;
         
-		c_eff = c(0,0,z_avg) + u(0,0,z_avg)*cos(GeoAc_phi) + v(0,0,z_avg)*sin(GeoAc_phi);
+		c_eff = c(0,0,z_avg) + u(0,0,z_avg)*cos(ctx.phi) + v(0,0,z_avg)*sin(ctx.phi);
         
 		ds = sqrt(pow(dr,2) + pow(dz,2));
         
@@ -251,7 +272,7 @@ void GeoAc_TravelTimeSegment(double & time, double ** solution, int start, int e
 //--------------------------------------------------------------------------//
 //------Integrate the Sutherland Bass Attenuation Through the Ray Path------//
 //--------------------------------------------------------------------------//
-double GeoAc_SB_Atten(double ** solution, int end, double freq){
+double GeoAc_SB_Atten(GeoAcContext & ctx, double ** solution, int end, double freq){
 	double dr, dz, ds, x, y, z;
     double atten = 0.0;
 	for (int n = 0; n < end; n++){
@@ -260,8 +281,8 @@ double GeoAc_SB_Atten(double ** solution, int end, double freq){
 		dz = solution[n+1][1] - solution[n][1];
 		ds = sqrt(dr*dr + dz*dz);
         
-		x = (solution[n][0] + dr/2.0)*cos(GeoAc_phi);				// Calculate (x,y,z) at the midpoint between [n] and [n+1]
-		y = (solution[n][0] + dr/2.0)*sin(GeoAc_phi);
+		x = (solution[n][0] + dr/2.0)*cos(ctx.phi);				// Calculate (x,y,z) at the midpoint between [n] and [n+1]
+		y = (solution[n][0] + dr/2.0)*sin(ctx.phi);
 		z = solution[n][1] + dz/2.0;
         
 		atten += SuthBass_Alpha(x, y, z, freq)*ds;	// Add contribution to the attenuation
@@ -269,7 +290,7 @@ double GeoAc_SB_Atten(double ** solution, int end, double freq){
     return atten;
 }
 
-void GeoAc_SB_AttenSegment(double & atten, double ** solution, int start, int end, double freq){
+void GeoAc_SB_AttenSegment(GeoAcContext & ctx, double & atten, double ** solution, int start, int end, double freq){
 	double dr, dz, ds, x, y, z;
 	for (int n = start; n < end; n++){
 		
@@ -277,8 +298,8 @@ void GeoAc_SB_AttenSegment(double & atten, double ** solution, int start, int en
 		dz = solution[n+1][1] - solution[n][1];
 		ds = sqrt(dr*dr + dz*dz);
         
-		x = (solution[n][0] + dr/2.0)*cos(GeoAc_phi);				// Calculate (x,y,z) at the midpoint between [n] and [n+1]
-		y = (solution[n][0] + dr/2.0)*sin(GeoAc_phi);
+		x = (solution[n][0] + dr/2.0)*cos(ctx.phi);				// Calculate (x,y,z) at the midpoint between [n] and [n+1]
+		y = (solution[n][0] + dr/2.0)*sin(ctx.phi);
 		z = solution[n][1] + dz/2.0;
         
 		atten += SuthBass_Alpha(x, y, z, freq)*ds;	// Add contribution to the attenuation
@@ -288,11 +309,12 @@ void GeoAc_SB_AttenSegment(double & atten, double ** solution, int start, int en
 //-----------------------------------------------------------------------------------//
 //-------Calculate the Jacobian determinant and from it the ampltude coefficient-----//
 //-----------------------------------------------------------------------------------//
-double GeoAc_Jacobian(double ** solution, int index){
+double GeoAc_Jacobian(GeoAcContext & ctx, double ** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double r = solution[index][0];						
 	double z = solution[index][1];
-	double drds = c(0.0,0.0,z)/GeoAc_Sources.c_eff_0*cos(GeoAc_theta);
-	double dzds = c(0.0,0.0,z)/GeoAc_Sources.c_eff_0*solution[index][2];
+	double drds = c(0.0,0.0,z)/src.c_eff_0*cos(ctx.theta);
+	double dzds = c(0.0,0.0,z)/src.c_eff_0*solution[index][2];
 	double drdtheta = solution[index][3];				
 	double dzdtheta = solution[index][4];
 		
@@ -300,12 +322,13 @@ double GeoAc_Jacobian(double ** solution, int index){
 }
 
 
-double GeoAc_Amplitude(double ** solution, int index){
+double GeoAc_Amplitude(GeoAcContext & ctx, double ** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double z = solution[index][1];
-	double D = GeoAc_Jacobian(solution, index);
+	double D = GeoAc_Jacobian(ctx, solution, index);
 	
-	double Amp_Num = rho(0.0,0.0,z)*c(0.0,0.0,z)*cos(GeoAc_theta);
-	double Amp_Den = rho(0.0,0.0,z_grnd)*GeoAc_Sources.c_eff_0*D;
+	double Amp_Num = rho(0.0,0.0,z)*c(0.0,0.0,z)*cos(ctx.theta);
+	double Amp_Den = rho(0.0,0.0,z_grnd)*src.c_eff_0*D;
 	
 	
 	return 1.0/(4.0*Pi)*sqrt(fabs(Amp_Num/Amp_Den));	
@@ -315,11 +338,11 @@ double GeoAc_Amplitude(double ** solution, int index){
 //---------Count the caustics encountered by monitoring---------//
 //----how many times the Jacobian determinant changes sign------//
 //--------------------------------------------------------------//
-int GeoAc_CausticCnt(double ** solution, int start, int end){
+int GeoAc_CausticCnt(GeoAcContext & ctx, double ** solution, int start, int end){
 	int count = 0;
-	double current, prev = GeoAc_Jacobian(solution, start);
+	double current, prev = GeoAc_Jacobian(ctx, solution, start);
 	for(int n = start+1; n < end; n++){
-		current = GeoAc_Jacobian(solution,n);
+		current = GeoAc_Jacobian(ctx, solution,n);
 		if(current*prev < 0.0){
 			count++;
 		}
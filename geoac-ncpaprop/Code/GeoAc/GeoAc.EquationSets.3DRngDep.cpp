@@ -13,9 +13,9 @@ using namespace std;
 //--------------------------------------------------//
 //-------Propagate in 3D, assume non-stratified-----//
 //--------------------------------------------------//
-void GeoAc_SetSystem(){
-    GeoAc_dim = 3;				// Dimensions
-    GeoAc_AtmoStrat = false;     // Is the medium stratified?
+void GeoAc_SetSystem(GeoAcContext & ctx){
+    ctx.dim = 3;				// Dimensions
+    ctx.AtmoStrat = false;     // Is the medium stratified?
 }
 
 //-----------------------------------------------------------//
@@ -52,36 +52,46 @@ struct GeoAc_Sources_Struct{
     double dc_gr[3][2];     // Derivatives of c_gr components with respect to lt and lp
 	double dc_gr_mag[2];	// Derivatives of c_gr magnitude with respect to lt and lp
     
+    struct MultiDimSpline_3D_Cursor cursor;   // Spline segment search state shared by the temperature and wind evaluations
 };
 
-struct GeoAc_Sources_Struct GeoAc_Sources = {
-    {0.0, 0.0, 0.0}, 0.0,
-    0.0, {0.0, 0.0, 0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
-    0.0, {0.0, 0.0, 0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
-    0.0, {0.0, 0.0, 0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
-    0.0, {0.0, 0.0, 0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
-    0.0, 0.0, {0.0, 0.0},
-    {0.0, 0.0, 0.0}, 0.0, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}}, {0.0, 0.0}
-};
+//-----------------------------------------------------------//
+//-------Allocate and release the per-ray source terms-------//
+//-------------------held by a solver context----------------//
+//-----------------------------------------------------------//
+void GeoAc_InitContext(GeoAcContext & ctx){
+    ctx.theta = 0.0;
+    ctx.phi = 0.0;
+    ctx.EqCnt = 0;                                      // Set by GeoAc_ConfigureCalcAmp
+    ctx.CalcAmp = false;
+    ctx.Sources = new struct GeoAc_Sources_Struct();
+    GeoAc_SetSystem(ctx);
+}
+
+void GeoAc_ClearContext(GeoAcContext & ctx){
+    delete ctx.Sources;
+    ctx.Sources = NULL;
+}
 
 //----------------------------------------------------------------------//
 //-------Fill in solution[0][n] with the appropriate initial values-----//
 //----------------------------------------------------------------------//
-void GeoAc_SetInitialConditions(double ** & solution, double x0, double y0, double z0){
-    GeoAc_Sources.src_loc[0] = x0;
-    GeoAc_Sources.src_loc[1] = y0;
-    GeoAc_Sources.src_loc[2] = z0;
-	  GeoAc_Sources.c0 = c(x0, y0, z0);
-    
-    double MachComps[3] =   { u(x0, y0, z0)/GeoAc_Sources.c0,   v(x0, y0, z0)/GeoAc_Sources.c0,     w(x0, y0, z0)/GeoAc_Sources.c0};
-    double nu0[3] =         { cos(GeoAc_theta)*cos(GeoAc_phi),  cos(GeoAc_theta)*sin(GeoAc_phi),    sin(GeoAc_theta)};
-    double mu0_th[3] =      {-sin(GeoAc_theta)*cos(GeoAc_phi), -sin(GeoAc_theta)*sin(GeoAc_phi),    cos(GeoAc_theta)};
-    double mu0_ph[3] =      {-cos(GeoAc_theta)*sin(GeoAc_phi),  cos(GeoAc_theta)*cos(GeoAc_phi),    0.0};
+void GeoAc_SetInitialConditions(GeoAcContext & ctx, double ** & solution, double x0, double y0, double z0){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
+    src.src_loc[0] = x0;
+    src.src_loc[1] = y0;
+    src.src_loc[2] = z0;
+	  src.c0 = c(x0, y0, z0);
+    
+    double MachComps[3] =   { u(x0, y0, z0)/src.c0,   v(x0, y0, z0)/src.c0,     w(x0, y0, z0)/src.c0};
+    double nu0[3] =         { cos(ctx.theta)*cos(ctx.phi),  cos(ctx.theta)*sin(ctx.phi),    sin(ctx.theta)};
+    double mu0_th[3] =      {-sin(ctx.theta)*cos(ctx.phi), -sin(ctx.theta)*sin(ctx.phi),    cos(ctx.theta)};
+    double mu0_ph[3] =      {-cos(ctx.theta)*sin(ctx.phi),  cos(ctx.theta)*cos(ctx.phi),    0.0};
     
     double MachScalar = 1.0 + (nu0[0]*MachComps[0] + nu0[1]*MachComps[1] + nu0[2]*MachComps[2]);
-    GeoAc_Sources.nu0 = 1.0/MachScalar;
+    src.nu0 = 1.0/MachScalar;
     
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		switch(index){
 			case(0):			// x(0) = x0
                 solution[0][index] =  x0;
@@ -127,11 +137,7 @@ void GeoAc_SetInitialConditions(double ** & solution, double x0, double y0, doub
 		}
 	}
 
-    for(int n = 0; n < 3; n++){
-        Temp_Spline.accel[n] =  0;
-        Windu_Spline.accel[n] = 0;
-        Windv_Spline.accel[n] = 0;
-    }
+    Reset_Cursor(src.cursor);
     
 }
 
@@ -139,12 +145,12 @@ void GeoAc_SetInitialConditions(double ** & solution, double x0, double y0, doub
 //--------------------------------------------------------------------------//
 //-------Taylor series fit to more accurately deterine intercept values-----//
 //--------------------------------------------------------------------------//
-void GeoAc_ApproximateIntercept(double ** solution, int k, double* & prev){
+void GeoAc_ApproximateIntercept(GeoAcContext & ctx, double ** solution, int k, double* & prev){
 	double result;
 	double dz_k = solution[k][2] - solution[k-1][2];    // set dz for step = z_k - z_{k-1}
 	double dz_grnd = solution[k-1][2] - z_grnd;         // set dz from z_{k-1} to ground (assuming z = 0 is ground)
     
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		prev[index] = solution[k-1][index] 	+ (solution[k-1][index] - solution[k][index])/dz_k*dz_grnd
                             + 1.0/2.0*(solution[k][index] + solution[k-2][index] - 2.0*solution[k-1][index])/pow(dz_k,2.0)*pow(dz_grnd,2.0);
 		
@@ -154,17 +160,18 @@ void GeoAc_ApproximateIntercept(double ** solution, int k, double* & prev){
 //-------------------------------------------------------------------------//
 //-------Fill in solution[0][n] with the appropriate reflection values-----//
 //-------------------------------------------------------------------------//
-void GeoAc_SetReflectionConditions(double** & solution, int k_end){
-	double* prev = new double [GeoAc_EqCnt];
-	GeoAc_ApproximateIntercept(solution, k_end, prev);
+void GeoAc_SetReflectionConditions(GeoAcContext & ctx, double** & solution, int k_end){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
+	double* prev = new double [ctx.EqCnt];
+	GeoAc_ApproximateIntercept(ctx, solution, k_end, prev);
 
     double c_grnd = c(prev[0], prev[1], z_grnd);
-	double dnuz_ds = - 1.0/c_grnd * (GeoAc_Sources.c0/c_grnd * c_diff(prev[0], prev[1],z_grnd, 2)
+	double dnuz_ds = - 1.0/c_grnd * (src.c0/c_grnd * c_diff(prev[0], prev[1],z_grnd, 2)
                                                    + prev[3] * u_diff(prev[0], prev[1],z_grnd, 2)
                                                         + prev[4] * v_diff(prev[0],prev[1],z_grnd, 2)
                                                             + prev[5] * w_diff(prev[0],prev[1],z_grnd, 2));
 	
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		switch(index){
 			case(0):			// x(0) = 		x(s0)
 			case(1):			// y(0) = 		y(s0)
@@ -193,7 +200,7 @@ void GeoAc_SetReflectionConditions(double** & solution, int k_end){
                 
 			case(11):			// mu_zt(0) =  	-mu_zt(s0) + 2 d nu_z/ ds * ds0/dtheta
  			case(17):			// mu_zp(0) = 	-mu_zp(s0) + 2 d nu_z/ ds * ds0/dphi
-				solution[0][index] =  -prev[index] + 2.0 * dnuz_ds*prev[index - 3]/(c_grnd/GeoAc_Sources.c0 * prev[5]);
+				solution[0][index] =  -prev[index] + 2.0 * dnuz_ds*prev[index - 3]/(c_grnd/src.c0 * prev[5]);
 				break;
 		}
 	}
@@ -215,120 +222,126 @@ double GeoAc_Set_ds(double* current_values){
 //---------------------------------------//
 //-------Update the source functions-----//
 //---------------------------------------//
-void GeoAc_UpdateSources(double ray_length, double* current_values){
+void GeoAc_UpdateSources(GeoAcContext & ctx, double ray_length, double* current_values){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
     // Extract ray location and eikonal vector components
     double x = current_values[0],		y = current_values[1], 	z = current_values[2];
 	double nu[3] = {current_values[3], 	current_values[4], 		current_values[5]};
     
+    // The three splines share a grid so that the cursor located by the temperature evaluation is reused for the winds
+    struct MultiDimSpline_3D_Eval Temp, Windu, Windv;
     double temp;
-    double dtemp[3];
+    double* dtemp = Temp.df;
     
-    if(!GeoAc_CalcAmp){
-        Eval_Spline_AllOrder1(x, y, z, Temp_Spline, temp, dtemp[0], dtemp[1], dtemp[2]);
+    if(!ctx.CalcAmp){
+        Eval_Spline_Fused(x, y, z, Temp_Spline,  src.cursor, Temp,  1);
+        Eval_Spline_Fused(x, y, z, Windu_Spline, src.cursor, Windu, 1);
+        Eval_Spline_Fused(x, y, z, Windv_Spline, src.cursor, Windv, 1);
+        
+        temp = Temp.f;
+        src.u = Windu.f;
+        src.v = Windv.f;
         for(int n = 0; n < 3; n++){
-            Windu_Spline.accel[n] = Temp_Spline.accel[n];
-            Windv_Spline.accel[n] = Temp_Spline.accel[n];
+            src.du[n] = Windu.df[n];
+            src.dv[n] = Windv.df[n];
         }
-        
-        Eval_Spline_AllOrder1(x, y, z, Windu_Spline, GeoAc_Sources.u, GeoAc_Sources.du[0], GeoAc_Sources.du[1], GeoAc_Sources.du[2]);
-        Eval_Spline_AllOrder1(x, y, z, Windv_Spline, GeoAc_Sources.v, GeoAc_Sources.dv[0], GeoAc_Sources.dv[1], GeoAc_Sources.dv[2]);
-        GeoAc_Sources.w = w(x,y,z);
+        src.w = w(x,y,z);
  
-        GeoAc_Sources.c = sqrt(gamR * temp);
+        src.c = sqrt(gamR * temp);
         for(int n = 0; n < 3; n++){
-            GeoAc_Sources.dc[n] = gamR / (2.0 * GeoAc_Sources.c) * dtemp[n];
-            GeoAc_Sources.dw[n] = w_diff(x,y,z,n);
+            src.dc[n] = gamR / (2.0 * src.c) * dtemp[n];
+            src.dw[n] = w_diff(x,y,z,n);
         }
         
-        GeoAc_Sources.nu_mag = 	 sqrt(nu[0]*nu[0] + nu[1]*nu[1] + nu[2]*nu[2]);
+        src.nu_mag = 	 sqrt(nu[0]*nu[0] + nu[1]*nu[1] + nu[2]*nu[2]);
         
-        GeoAc_Sources.c_gr[0] =  GeoAc_Sources.c*nu[0]/GeoAc_Sources.nu_mag + GeoAc_Sources.u;
-        GeoAc_Sources.c_gr[1] =  GeoAc_Sources.c*nu[1]/GeoAc_Sources.nu_mag + GeoAc_Sources.v;
-        GeoAc_Sources.c_gr[2] =  GeoAc_Sources.c*nu[2]/GeoAc_Sources.nu_mag + GeoAc_Sources.w;
+        src.c_gr[0] =  src.c*nu[0]/src.nu_mag + src.u;
+        src.c_gr[1] =  src.c*nu[1]/src.nu_mag + src.v;
+        src.c_gr[2] =  src.c*nu[2]/src.nu_mag + src.w;
         
-        GeoAc_Sources.c_gr_mag = sqrt(pow(GeoAc_Sources.c_gr[0],2) + pow(GeoAc_Sources.c_gr[1],2) + pow(GeoAc_Sources.c_gr[2],2));
+        src.c_gr_mag = sqrt(pow(src.c_gr[0],2) + pow(src.c_gr[1],2) + pow(src.c_gr[2],2));
     }
 
     double X_th[3], X_ph[3], mu_th[3], mu_ph[3];
-    double ddtemp[3][3];
-    double ddWindu[3][3];
-    double ddWindv[3][3];
+    double (*ddtemp)[3] =  Temp.ddf;
+    double (*ddWindu)[3] = Windu.ddf;
+    double (*ddWindv)[3] = Windv.ddf;
     
-    if(GeoAc_CalcAmp){
+    if(ctx.CalcAmp){
         X_th[0]  = current_values[6];       X_th[1]  = current_values[7];       X_th[2]  = current_values[8];
 		mu_th[0] = current_values[9];		mu_th[1] = current_values[10];		mu_th[2] = current_values[11];
         X_ph[0]  = current_values[12];      X_ph[1]  = current_values[13];      X_ph[2]  = current_values[14];
 		mu_ph[0] = current_values[15];		mu_ph[1] = current_values[16];		mu_ph[2] = current_values[17];
         
-        Eval_Spline_AllOrder2(x, y, z, Temp_Spline, temp, dtemp[0], dtemp[1], dtemp[2], ddtemp[0][0], ddtemp[1][1], ddtemp[2][2], ddtemp[0][1], ddtemp[0][2], ddtemp[1][2]);
+        Eval_Spline_Fused(x, y, z, Temp_Spline,  src.cursor, Temp,  2);
+        Eval_Spline_Fused(x, y, z, Windu_Spline, src.cursor, Windu, 2);
+        Eval_Spline_Fused(x, y, z, Windv_Spline, src.cursor, Windv, 2);
+
+        temp = Temp.f;
+        src.u = Windu.f;
+        src.v = Windv.f;
         for(int n = 0; n < 3; n++){
-            Windu_Spline.accel[n] = Temp_Spline.accel[n];
-            Windv_Spline.accel[n] = Temp_Spline.accel[n];
+            src.du[n] = Windu.df[n];
+            src.dv[n] = Windv.df[n];
         }
-
-        Eval_Spline_AllOrder2(x, y, z, Windu_Spline, GeoAc_Sources.u, GeoAc_Sources.du[0], GeoAc_Sources.du[1], GeoAc_Sources.du[2], ddWindu[0][0], ddWindu[1][1], ddWindu[2][2], ddWindu[0][1], ddWindu[0][2], ddWindu[1][2]);
-        Eval_Spline_AllOrder2(x, y, z, Windv_Spline, GeoAc_Sources.v, GeoAc_Sources.dv[0], GeoAc_Sources.dv[1], GeoAc_Sources.dv[2], ddWindv[0][0], ddWindv[1][1], ddWindv[2][2], ddWindv[0][1], ddWindv[0][2], ddWindv[1][2]);
-        GeoAc_Sources.w = w(x,y,z);
-
-        ddtemp[1][0] = ddtemp[0][1];    ddtemp[2][0] = ddtemp[0][2];    ddtemp[2][1] = ddtemp[1][2];
-        ddWindu[1][0] = ddWindu[0][1];  ddWindu[2][0] = ddWindu[0][2];  ddWindu[2][1] = ddWindu[1][2];
-        ddWindv[1][0] = ddWindv[0][1];  ddWindv[2][0] = ddWindv[0][2];  ddWindv[2][1] = ddWindv[1][2];
+        src.w = w(x,y,z);
         
-        GeoAc_Sources.c = sqrt(gamR * temp);
+        src.c = sqrt(gamR * temp);
         for(int n = 0; n < 3; n++){
-            GeoAc_Sources.dc[n] = gamR / (2.0 * GeoAc_Sources.c) * dtemp[n];
-            GeoAc_Sources.dw[n] = w_diff(x,y,z,n);
+            src.dc[n] = gamR / (2.0 * src.c) * dtemp[n];
+            src.dw[n] = w_diff(x,y,z,n);
             
-            GeoAc_Sources.ddc[n][0] = 0.0;            GeoAc_Sources.ddc[n][1] = 0.0;
-            GeoAc_Sources.ddu[n][0] = 0.0;            GeoAc_Sources.ddu[n][1] = 0.0;
-            GeoAc_Sources.ddv[n][0] = 0.0;            GeoAc_Sources.ddv[n][1] = 0.0;
-            GeoAc_Sources.ddw[n][0] = 0.0;            GeoAc_Sources.ddw[n][1] = 0.0;
+            src.ddc[n][0] = 0.0;            src.ddc[n][1] = 0.0;
+            src.ddu[n][0] = 0.0;            src.ddu[n][1] = 0.0;
+            src.ddv[n][0] = 0.0;            src.ddv[n][1] = 0.0;
+            src.ddw[n][0] = 0.0;            src.ddw[n][1] = 0.0;
             for(int m = 0; m < 3; m++){
-                GeoAc_Sources.ddc[n][0] += X_th[m]*(gamR/(2.0*GeoAc_Sources.c) * ddtemp[n][m] - pow(gamR,2)/(4.0 * pow(GeoAc_Sources.c,3)) * dtemp[n]*dtemp[m]);
-                GeoAc_Sources.ddc[n][1] += X_ph[m]*(gamR/(2.0*GeoAc_Sources.c) * ddtemp[n][m] - pow(gamR,2)/(4.0 * pow(GeoAc_Sources.c,3)) * dtemp[n]*dtemp[m]);
+                src.ddc[n][0] += X_th[m]*(gamR/(2.0*src.c) * ddtemp[n][m] - pow(gamR,2)/(4.0 * pow(src.c,3)) * dtemp[n]*dtemp[m]);
+                src.ddc[n][1] += X_ph[m]*(gamR/(2.0*src.c) * ddtemp[n][m] - pow(gamR,2)/(4.0 * pow(src.c,3)) * dtemp[n]*dtemp[m]);
                 
-                GeoAc_Sources.ddu[n][0] += X_th[m]*ddWindu[n][m];       GeoAc_Sources.ddu[n][1] += X_ph[m]*ddWindu[n][m];
-                GeoAc_Sources.ddv[n][0] += X_th[m]*ddWindv[n][m];       GeoAc_Sources.ddv[n][1] += X_ph[m]*ddWindv[n][m];
-                GeoAc_Sources.ddw[n][0] += X_th[m]*w_ddiff(x,y,z,n,m);  GeoAc_Sources.ddw[n][1] += X_ph[m]*w_ddiff(x,y,z,n,m);
+                src.ddu[n][0] += X_th[m]*ddWindu[n][m];       src.ddu[n][1] += X_ph[m]*ddWindu[n][m];
+                src.ddv[n][0] += X_th[m]*ddWindv[n][m];       src.ddv[n][1] += X_ph[m]*ddWindv[n][m];
+                src.ddw[n][0] += X_th[m]*w_ddiff(x,y,z,n,m);  src.ddw[n][1] += X_ph[m]*w_ddiff(x,y,z,n,m);
             }
         }
 
-        GeoAc_Sources.dc[3] = 0.0;      GeoAc_Sources.dc[4] = 0.0;
-        GeoAc_Sources.du[3] = 0.0;      GeoAc_Sources.du[4] = 0.0;
-        GeoAc_Sources.dv[3] = 0.0;      GeoAc_Sources.dv[4] = 0.0;
-        GeoAc_Sources.dw[3] = 0.0;      GeoAc_Sources.dw[4] = 0.0;
+        src.dc[3] = 0.0;      src.dc[4] = 0.0;
+        src.du[3] = 0.0;      src.du[4] = 0.0;
+        src.dv[3] = 0.0;      src.dv[4] = 0.0;
+        src.dw[3] = 0.0;      src.dw[4] = 0.0;
         for(int n = 0; n < 3; n++){
-            GeoAc_Sources.dc[3] += X_th[n]*GeoAc_Sources.dc[n];     GeoAc_Sources.dc[4] += X_ph[n]*GeoAc_Sources.dc[n];
-            GeoAc_Sources.du[3] += X_th[n]*GeoAc_Sources.du[n];     GeoAc_Sources.du[4] += X_ph[n]*GeoAc_Sources.du[n];
-            GeoAc_Sources.dv[3] += X_th[n]*GeoAc_Sources.dv[n];     GeoAc_Sources.dv[4] += X_ph[n]*GeoAc_Sources.dv[n];
-            GeoAc_Sources.dw[3] += X_th[n]*GeoAc_Sources.dw[n];     GeoAc_Sources.dw[4] += X_ph[n]*GeoAc_Sources.dw[n];
+            src.dc[3] += X_th[n]*src.dc[n];     src.dc[4] += X_ph[n]*src.dc[n];
+            src.du[3] += X_th[n]*src.du[n];     src.du[4] += X_ph[n]*src.du[n];
+            src.dv[3] += X_th[n]*src.dv[n];     src.dv[4] += X_ph[n]*src.dv[n];
+            src.dw[3] += X_th[n]*src.dw[n];     src.dw[4] += X_ph[n]*src.dw[n];
         }
         
-        GeoAc_Sources.nu_mag = 	 sqrt(nu[0]*nu[0] + nu[1]*nu[1] + nu[2]*nu[2]);
-		GeoAc_Sources.dnu_mag[0] = (nu[0]*mu_th[0] + nu[1]*mu_th[1] + nu[2]*mu_th[2])/GeoAc_Sources.nu_mag;
-		GeoAc_Sources.dnu_mag[1] = (nu[0]*mu_ph[0] + nu[1]*mu_ph[1] + nu[2]*mu_ph[2])/GeoAc_Sources.nu_mag;
+        src.nu_mag = 	 sqrt(nu[0]*nu[0] + nu[1]*nu[1] + nu[2]*nu[2]);
+		src.dnu_mag[0] = (nu[0]*mu_th[0] + nu[1]*mu_th[1] + nu[2]*mu_th[2])/src.nu_mag;
+		src.dnu_mag[1] = (nu[0]*mu_ph[0] + nu[1]*mu_ph[1] + nu[2]*mu_ph[2])/src.nu_mag;
         
-        GeoAc_Sources.c_gr[0] =  GeoAc_Sources.c*nu[0]/GeoAc_Sources.nu_mag + GeoAc_Sources.u;
-        GeoAc_Sources.c_gr[1] =  GeoAc_Sources.c*nu[1]/GeoAc_Sources.nu_mag + GeoAc_Sources.v;
-        GeoAc_Sources.c_gr[2] =  GeoAc_Sources.c*nu[2]/GeoAc_Sources.nu_mag + GeoAc_Sources.w;
-        GeoAc_Sources.c_gr_mag = sqrt(pow(GeoAc_Sources.c_gr[0],2) + pow(GeoAc_Sources.c_gr[1],2) + pow(GeoAc_Sources.c_gr[2],2));
+        src.c_gr[0] =  src.c*nu[0]/src.nu_mag + src.u;
+        src.c_gr[1] =  src.c*nu[1]/src.nu_mag + src.v;
+        src.c_gr[2] =  src.c*nu[2]/src.nu_mag + src.w;
+        src.c_gr_mag = sqrt(pow(src.c_gr[0],2) + pow(src.c_gr[1],2) + pow(src.c_gr[2],2));
         
-        GeoAc_Sources.dc_gr[0][0] = nu[0]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[3] + GeoAc_Sources.c*mu_th[0]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[0]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[0] + GeoAc_Sources.du[3];
-        GeoAc_Sources.dc_gr[1][0] = nu[1]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[3] + GeoAc_Sources.c*mu_th[1]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[1]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[0] + GeoAc_Sources.dv[3];
-        GeoAc_Sources.dc_gr[2][0] = nu[2]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[3] + GeoAc_Sources.c*mu_th[2]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[2]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[0] + GeoAc_Sources.dw[3];
-        GeoAc_Sources.dc_gr_mag[0] = (GeoAc_Sources.c_gr[0]*GeoAc_Sources.dc_gr[0][0] + GeoAc_Sources.c_gr[1]*GeoAc_Sources.dc_gr[1][0] + GeoAc_Sources.c_gr[2]*GeoAc_Sources.dc_gr[2][0])/GeoAc_Sources.c_gr_mag;
+        src.dc_gr[0][0] = nu[0]/src.nu_mag*src.dc[3] + src.c*mu_th[0]/src.nu_mag - src.c*nu[0]/pow(src.nu_mag,2) * src.dnu_mag[0] + src.du[3];
+        src.dc_gr[1][0] = nu[1]/src.nu_mag*src.dc[3] + src.c*mu_th[1]/src.nu_mag - src.c*nu[1]/pow(src.nu_mag,2) * src.dnu_mag[0] + src.dv[3];
+        src.dc_gr[2][0] = nu[2]/src.nu_mag*src.dc[3] + src.c*mu_th[2]/src.nu_mag - src.c*nu[2]/pow(src.nu_mag,2) * src.dnu_mag[0] + src.dw[3];
+        src.dc_gr_mag[0] = (src.c_gr[0]*src.dc_gr[0][0] + src.c_gr[1]*src.dc_gr[1][0] + src.c_gr[2]*src.dc_gr[2][0])/src.c_gr_mag;
         
-        GeoAc_Sources.dc_gr[0][1] = nu[0]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[4] + GeoAc_Sources.c*mu_ph[0]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[0]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[1] + GeoAc_Sources.du[4];
-        GeoAc_Sources.dc_gr[1][1] = nu[1]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[4] + GeoAc_Sources.c*mu_ph[1]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[1]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[1] + GeoAc_Sources.dv[4];
-        GeoAc_Sources.dc_gr[2][1] = nu[2]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[4] + GeoAc_Sources.c*mu_ph[2]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[2]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[1] + GeoAc_Sources.dw[4];        
-        GeoAc_Sources.dc_gr_mag[1] = (GeoAc_Sources.c_gr[0]*GeoAc_Sources.dc_gr[0][1] + GeoAc_Sources.c_gr[1]*GeoAc_Sources.dc_gr[1][1] + GeoAc_Sources.c_gr[2]*GeoAc_Sources.dc_gr[2][1])/GeoAc_Sources.c_gr_mag;
+        src.dc_gr[0][1] = nu[0]/src.nu_mag*src.dc[4] + src.c*mu_ph[0]/src.nu_mag - src.c*nu[0]/pow(src.nu_mag,2) * src.dnu_mag[1] + src.du[4];
+        src.dc_gr[1][1] = nu[1]/src.nu_mag*src.dc[4] + src.c*mu_ph[1]/src.nu_mag - src.c*nu[1]/pow(src.nu_mag,2) * src.dnu_mag[1] + src.dv[4];
+        src.dc_gr[2][1] = nu[2]/src.nu_mag*src.dc[4] + src.c*mu_ph[2]/src.nu_mag - src.c*nu[2]/pow(src.nu_mag,2) * src.dnu_mag[1] + src.dw[4];        
+        src.dc_gr_mag[1] = (src.c_gr[0]*src.dc_gr[0][1] + src.c_gr[1]*src.dc_gr[1][1] + src.c_gr[2]*src.dc_gr[2][1])/src.c_gr_mag;
 	}
 }
 
 //-----------------------------------------------------------//
 //-------Evaluate the Source Equation For Specific Index-----//
 //-----------------------------------------------------------//
-double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number){
+double GeoAc_EvalSrcEq(GeoAcContext & ctx, double ray_length, double* current_values, int Eq_Number){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double result;
     
 	// Set variables used in all equations
@@ -340,33 +353,33 @@ double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number)
 		case(0):	// d x / d s
         case(1):    // d y / d s
         case(2):    // d z / d s
-			result = GeoAc_Sources.c_gr[Eq_Number]/GeoAc_Sources.c_gr_mag;
+			result = src.c_gr[Eq_Number]/src.c_gr_mag;
 			break;
             
 		case(3): 	// d nu_x /ds
 		case(4): 	// d nu_y / ds
 		case(5): 	// d nu_z / ds
-			result = -1.0/GeoAc_Sources.c_gr_mag*(GeoAc_Sources.nu_mag*GeoAc_Sources.dc[Eq_Number-3]
-                                                        + nu[0]*GeoAc_Sources.du[Eq_Number-3] + nu[1]*GeoAc_Sources.dv[Eq_Number-3] + nu[2]*GeoAc_Sources.dw[Eq_Number-3]);
+			result = -1.0/src.c_gr_mag*(src.nu_mag*src.dc[Eq_Number-3]
+                                                        + nu[0]*src.du[Eq_Number-3] + nu[1]*src.dv[Eq_Number-3] + nu[2]*src.dw[Eq_Number-3]);
 			break;
             
             
 		case(6):	// d X_th/ds
         case(7):	// d Y_th/ds
         case(8): 	// d Z_th/ds
-			result = GeoAc_Sources.dc_gr[Eq_Number-6][0]/GeoAc_Sources.c_gr_mag
-                        - GeoAc_Sources.c_gr[Eq_Number-6]/pow(GeoAc_Sources.c_gr_mag,2) * GeoAc_Sources.dc_gr_mag[0];
+			result = src.dc_gr[Eq_Number-6][0]/src.c_gr_mag
+                        - src.c_gr[Eq_Number-6]/pow(src.c_gr_mag,2) * src.dc_gr_mag[0];
 			break;
             
             
 		case(9): 	// d mu_x_th /ds
 		case(10): 	// d mu_y_th /ds
 		case(11): 	// d mu_z_th /ds
-			result = 1.0/pow(GeoAc_Sources.c_gr_mag,2) * GeoAc_Sources.dc_gr_mag[0]*(GeoAc_Sources.nu_mag*GeoAc_Sources.dc[Eq_Number-9]
-                                                                                        + nu[0]*GeoAc_Sources.du[Eq_Number-9] + nu[1]*GeoAc_Sources.dv[Eq_Number-9] + nu[2]*GeoAc_Sources.dw[Eq_Number-9])
-                            - 1.0/GeoAc_Sources.c_gr_mag*(GeoAc_Sources.dnu_mag[0]*GeoAc_Sources.dc[Eq_Number-9] + GeoAc_Sources.nu_mag*GeoAc_Sources.ddc[Eq_Number-9][0]
-                                                            + mu_th[0]*GeoAc_Sources.du[Eq_Number-9] + mu_th[1]*GeoAc_Sources.dv[Eq_Number-9] + mu_th[2]*GeoAc_Sources.dw[Eq_Number-9]
-                                                                    + nu[0]*GeoAc_Sources.ddu[Eq_Number-9][0] + nu[1]*GeoAc_Sources.ddv[Eq_Number-9][0] + nu[2]*GeoAc_Sources.ddw[Eq_Number-9][0]);
+			result = 1.0/pow(src.c_gr_mag,2) * src.dc_gr_mag[0]*(src.nu_mag*src.dc[Eq_Number-9]
+                                                                                        + nu[0]*src.du[Eq_Number-9] + nu[1]*src.dv[Eq_Number-9] + nu[2]*src.dw[Eq_Number-9])
+                            - 1.0/src.c_gr_mag*(src.dnu_mag[0]*src.dc[Eq_Number-9] + src.nu_mag*src.ddc[Eq_Number-9][0]
+                                                            + mu_th[0]*src.du[Eq_Number-9] + mu_th[1]*src.dv[Eq_Number-9] + mu_th[2]*src.dw[Eq_Number-9]
+                                                                    + nu[0]*src.ddu[Eq_Number-9][0] + nu[1]*src.ddv[Eq_Number-9][0] + nu[2]*src.ddw[Eq_Number-9][0]);
             
 			break;
             
@@ -374,18 +387,18 @@ double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number)
 		case(12):  	// dX_ph/ds
 		case(13):  	// dY_ph/ds
         case(14):	// dZ_ph/ds
-			result = GeoAc_Sources.dc_gr[Eq_Number-12][1]/GeoAc_Sources.c_gr_mag
-                        - GeoAc_Sources.c_gr[Eq_Number-12]/pow(GeoAc_Sources.c_gr_mag,2) * GeoAc_Sources.dc_gr_mag[1];
+			result = src.dc_gr[Eq_Number-12][1]/src.c_gr_mag
+                        - src.c_gr[Eq_Number-12]/pow(src.c_gr_mag,2) * src.dc_gr_mag[1];
 			break;
             
 		case(15): 	// d mu_x_ph/ds
 		case(16): 	// d mu_y_ph/ds
 		case(17): 	// d mu_z_ph/ds
-			result = 1.0/pow(GeoAc_Sources.c_gr_mag,2) * GeoAc_Sources.dc_gr_mag[1]*(GeoAc_Sources.nu_mag*GeoAc_Sources.dc[Eq_Number-15]
-                                                                                            + nu[0]*GeoAc_Sources.du[Eq_Number-15] + nu[1]*GeoAc_Sources.dv[Eq_Number-15] + nu[2]*GeoAc_Sources.dw[Eq_Number-15])
-                            - 1.0/GeoAc_Sources.c_gr_mag*(GeoAc_Sources.dnu_mag[1]*GeoAc_Sources.dc[Eq_Number-15] + GeoAc_Sources.nu_mag*GeoAc_Sources.ddc[Eq_Number-15][1]
-                                                            + mu_ph[0]*GeoAc_Sources.du[Eq_Number-15] + mu_ph[1]*GeoAc_Sources.dv[Eq_Number-15] + mu_ph[2]*GeoAc_Sources.dw[Eq_Number-15]
-                                                                + nu[0]*GeoAc_Sources.ddu[Eq_Number-15][1] + nu[1]*GeoAc_Sources.ddv[Eq_Number-15][1] + nu[2]*GeoAc_Sources.ddw[Eq_Number-15][1]);
+			result = 1.0/pow(src.c_gr_mag,2) * src.dc_gr_mag[1]*(src.nu_mag*src.dc[Eq_Number-15]
+                                                                                            + nu[0]*src.du[Eq_Number-15] + nu[1]*src.dv[Eq_Number-15] + nu[2]*src.dw[Eq_Number-15])
+                            - 1.0/src.c_gr_mag*(src.dnu_mag[1]*src.dc[Eq_Number-15] + src.nu_mag*src.ddc[Eq_Number-15][1]
+                                                            + mu_ph[0]*src.du[Eq_Number-15] + mu_ph[1]*src.dv[Eq_Number-15] + mu_ph[2]*src.dw[Eq_Number-15]
+                                                                + nu[0]*src.ddu[Eq_Number-15][1] + nu[1]*src.ddv[Eq_Number-15][1] + nu[2]*src.ddw[Eq_Number-15][1]);
 			break;
             
 	}
@@ -395,7 +408,7 @@ double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number)
 //-------------------------------------------------------------------//
 //-------Calculate the Hamiltonian (Eikonal) To Check For Errors-----//
 //-------------------------------------------------------------------//
-double GeoAc_EvalHamiltonian(double ray_length, double* current_values, double c0){
+double GeoAc_EvalHamiltonian(GeoAcContext & ctx, double ray_length, double* current_values, double c0){
 	double x = current_values[0],  y = current_values[1], z = current_values[2];
 	double nu[3] = {current_values[3], current_values[4], current_values[5]};
 	
@@ -403,16 +416,17 @@ double GeoAc_EvalHamiltonian(double ray_length, double* current_values, double c
                     + (u(x,y,z)*nu[0] + v(x,y,z)*nu[1] + w(x,y,z)*nu[2])/c(x,y,z);
 }
 
-double GeoAc_EvalHamiltonian(double** solution, int index){
+double GeoAc_EvalHamiltonian(GeoAcContext & ctx, double** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double x = solution[index][0],          y = solution[index][1],         z = solution[index][2];
-	double x0 = GeoAc_Sources.src_loc[0], 	y0 = GeoAc_Sources.src_loc[1], 	z0 = GeoAc_Sources.src_loc[2];
+	double x0 = src.src_loc[0], 	y0 = src.src_loc[1], 	z0 = src.src_loc[2];
 	double nu[3] = {solution[index][3],     solution[index][4],             solution[index][5]};
-    double c0 = GeoAc_Sources.c0;
+    double c0 = src.c0;
     
 	return sqrt(nu[0]*nu[0] + nu[1]*nu[1] + nu[2]*nu[2]) - c0/c(x,y,z)*(1.0 - (u(x,y,z)*nu[0] + v(x,y,z)*nu[1] + w(x,y,z)*nu[2])/c0);
 }
 
-double GeoAc_EvalHamiltonian_Deriv(double** solution, int index){
+double GeoAc_EvalHamiltonian_Deriv(GeoAcContext & ctx, double** solution, int index){
 	double  x =           solution[index][0],y = solution[index][1], z = solution[index][2],
             X_th[3] =    {solution[index][6],    solution[index][7],     solution[index][8]},
             X_ph[3] =    {solution[index][12],   solution[index][13],    solution[index][14]},
@@ -448,7 +462,7 @@ double GeoAc_EvalHamiltonian_Deriv(double** solution, int index){
 //--------Check if the ray has left the propagation--------//
 //-------------region or returned to the ground------------//
 //---------------------------------------------------------//
-bool GeoAc_BreakCheck(double ** solution, int index){
+bool GeoAc_BreakCheck(GeoAcContext & ctx, double ** solution, int index){
 	double x 	= solution[index][0];
     double y    = solution[index][1];
     double z 	= solution[index][2];
@@ -475,7 +489,7 @@ bool GeoAc_GroundCheck(double ** solution, int index){
 //----------------------------------------------------------------------------------//
 //-------Calculate the travel time from source to location or between locations-----//
 //----------------------------------------------------------------------------------//
-double GeoAc_TravelTime(double ** solution, int index){
+double GeoAc_TravelTime(GeoAcContext & ctx, double ** solution, int index){
     double dx, dy, dz, ds, x, y, z, nu[3], nu_mag, c_prop[3], c_prop_mag;
     double SndSpd;
 	double traveltime = 0;
@@ -509,7 +523,7 @@ double GeoAc_TravelTime(double ** solution, int index){
 }
 
 
-void GeoAc_TravelTimeSegment(double & time, double ** solution, int start, int end){
+void GeoAc_TravelTimeSegment(GeoAcContext & ctx, double & time, double ** solution, int start, int end){
 	double dx, dy, dz, ds, x, y, z, nu[3], nu_mag, c_prop[3], c_prop_mag;
     double SndSpd;
     
@@ -544,7 +558,7 @@ void GeoAc_TravelTimeSegment(double & time, double ** solution, int start, int e
 //-----------------------------------------------------------------------------------//
 //-------Calculate the Jacobian determinant and from it the ampltude coefficient-----//
 //-----------------------------------------------------------------------------------//
-double GeoAc_Jacobian(double ** solution, int index){
+double GeoAc_Jacobian(GeoAcContext & ctx, double ** solution, int index){
 	double x = solution[index][0], y = solution[index][1], z = solution[index][2];
 	double nu[3] = 	{solution[index][3], solution[index][4], solution[index][5]};
 	double nu_mag = sqrt(nu[0]*nu[0] + nu[1]*nu[1] + nu[2]*nu[2]);
@@ -563,12 +577,13 @@ double GeoAc_Jacobian(double ** solution, int index){
 }
 
 
-double GeoAc_Amplitude(double ** solution, int index){
+double GeoAc_Amplitude(GeoAcContext & ctx, double ** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double x =      solution[index][0],         y = solution[index][1],         z = solution[index][2];
-    double x0 =     GeoAc_Sources.src_loc[0],   y0 = GeoAc_Sources.src_loc[1],  z0 = GeoAc_Sources.src_loc[2];
+    double x0 =     src.src_loc[0],   y0 = src.src_loc[1],  z0 = src.src_loc[2];
 	double nu[3] = {solution[index][3],         solution[index][4],             solution[index][5]};
     
-	double 	c0 = GeoAc_Sources.c0,
+	double 	c0 = src.c0,
             SndSpd = c(x,y,z),
             Windu = u(x,y,z),
             Windv = v(x,y,z),
@@ -579,13 +594,13 @@ double GeoAc_Amplitude(double ** solution, int index){
             nu_mag = (c0 - nu[0]*Windu - nu[1]*Windv - nu[2]*Windw)/SndSpd,
             nu_mag0 = 1.0 - nu[0]*Windu0/c0 - nu[1]*Windv0/c0 - nu[2]*Windw0/c0,
             c_prop[3] =  {SndSpd*nu[0]/nu_mag + Windu,                  SndSpd*nu[1]/nu_mag + Windv,                    SndSpd*nu[2]/nu_mag + Windw},
-            c_prop0[3] = {c0*cos(GeoAc_theta)*cos(GeoAc_phi) + Windu0, 	c0*cos(GeoAc_theta)*sin(GeoAc_phi) + Windv0, 	c0*sin(GeoAc_theta) + Windw0};
+            c_prop0[3] = {c0*cos(ctx.theta)*cos(ctx.phi) + Windu0, 	c0*cos(ctx.theta)*sin(ctx.phi) + Windv0, 	c0*sin(ctx.theta) + Windw0};
     
 	double  c_prop_mag = sqrt(pow(c_prop[0],2) + pow(c_prop[1],2) + pow(c_prop[2],2)),
     c_prop_mag0 = sqrt(pow(c_prop0[0],2) + pow(c_prop0[1],2) + pow(c_prop0[2],2));
 	
-	double D = GeoAc_Jacobian(solution, index);
-	double Amp_Num = rho(x,y,z) * nu_mag * pow(SndSpd,3) * c_prop_mag0 * cos(GeoAc_theta);
+	double D = GeoAc_Jacobian(ctx, solution, index);
+	double Amp_Num = rho(x,y,z) * nu_mag * pow(SndSpd,3) * c_prop_mag0 * cos(ctx.theta);
 	double Amp_Den = rho(x0,y0,z0) * nu_mag0* pow(c0,3) * c_prop_mag * D;
     
 	return 1.0/(4.0*Pi)*sqrt(fabs(Amp_Num/Amp_Den));
@@ -595,7 +610,7 @@ double GeoAc_Amplitude(double ** solution, int index){
 //--------------------------------------------------------------------------//
 //------Integrate the Sutherland Bass Attenuation Through the Ray Path------//
 //--------------------------------------------------------------------------//
-double GeoAc_SB_Atten(double ** solution, int end, double freq){
+double GeoAc_SB_Atten(GeoAcContext & ctx, double ** solution, int end, double freq){
 	double dx, dy, dz, ds, x, y, z;
     double atten = 0.0;
 	for (int n = 0; n < end; n++){
@@ -615,7 +630,7 @@ double GeoAc_SB_Atten(double ** solution, int end, double freq){
     return atten;
 }
 
-void GeoAc_SB_AttenSegment(double & atten, double ** solution, int start, int end, double freq){
+void GeoAc_SB_AttenSegment(GeoAcContext & ctx, double & atten, double ** solution, int start, int end, double freq){
 	double dx, dy, dz, ds, x, y, z;
 	for (int n = start; n < end; n++){
 		
@@ -637,12 +652,12 @@ void GeoAc_SB_AttenSegment(double & atten, double ** solution, int start, int en
 //---------Count the caustics encountered by monitoring---------//
 //----how many times the Jacobian determinant changes sign------//
 //--------------------------------------------------------------//
-int GeoAc_CausticCnt(double ** solution, int start, int end){
+int GeoAc_CausticCnt(GeoAcContext & ctx, double ** solution, int start, int end){
 	int count = 0;
-	double current, prev = GeoAc_Jacobian(solution, 1);
+	double current, prev = GeoAc_Jacobian(ctx, solution, 1);
 	
     for(int n = start; n < end; n++){
-		current = GeoAc_Jacobian(solution,n);
+		current = GeoAc_Jacobian(ctx, solution,n);
 		if(current*prev < 0.0) count++;
 		prev = current;
 	}
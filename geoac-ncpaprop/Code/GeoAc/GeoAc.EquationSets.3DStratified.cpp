@@ -11,9 +11,9 @@ using namespace std;
 //----------------------------------------------//
 //-------Propagate in 3D, assume stratified-----//
 //----------------------------------------------//
-void GeoAc_SetSystem(){
-    GeoAc_dim = 3;				// Dimensions
-    GeoAc_AtmoStrat = true;     // Is the medium stratified?
+void GeoAc_SetSystem(GeoAcContext & ctx){
+    ctx.dim = 3;				// Dimensions
+    ctx.AtmoStrat = true;     // Is the medium stratified?
 }
 
 //-----------------------------------------------------------//
@@ -53,47 +53,56 @@ struct GeoAc_Sources_Struct{
   double dc_prop_mag[2];	// Angular derivatives of c_prop (magnitudes)
 };
 
-    struct GeoAc_Sources_Struct GeoAc_Sources = {{0.0, 0.0, 0.0}, 0.0,
-                                                 {0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}},
-                                                 0.0, 0.0, 0.0,
-												 0.0, 0.0, 0.0,
-												 0.0, 0.0, 0.0,
-												 0.0, 0.0, 0.0,
-                                                 0.0, {0.0, 0.0},
-                                                 {0.0, 0.0, 0.0}, 0.0,
-                                                 {{0.0, 0.0}, {0.0, 0.0},{0.0, 0.0}}, {0.0, 0.0}};
+//-----------------------------------------------------------//
+//-------Allocate and release the per-ray source terms-------//
+//-------------------held by a solver context----------------//
+//-----------------------------------------------------------//
+void GeoAc_InitContext(GeoAcContext & ctx){
+    ctx.theta = 0.0;
+    ctx.phi = 0.0;
+    ctx.EqCnt = 0;                                      // Set by GeoAc_ConfigureCalcAmp
+    ctx.CalcAmp = false;
+    ctx.Sources = new struct GeoAc_Sources_Struct();
+    GeoAc_SetSystem(ctx);
+}
+
+void GeoAc_ClearContext(GeoAcContext & ctx){
+    delete ctx.Sources;
+    ctx.Sources = NULL;
+}
 
 //----------------------------------------------------------------------//
 //-------Fill in solution[0][n] with the appropriate initial values-----//
 //----------------------------------------------------------------------//
-void GeoAc_SetInitialConditions(double ** & solution, double x0, double y0, double z0){
+void GeoAc_SetInitialConditions(GeoAcContext & ctx, double ** & solution, double x0, double y0, double z0){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
     // DV annotated
-    GeoAc_Sources.src_loc[0] = x0;
-    GeoAc_Sources.src_loc[1] = y0;
-    GeoAc_Sources.src_loc[2] = z0;
-	  GeoAc_Sources.c0 = c(x0, y0, z0);
+    src.src_loc[0] = x0;
+    src.src_loc[1] = y0;
+    src.src_loc[2] = z0;
+	  src.c0 = c(x0, y0, z0);
     
-    double M_Comps[3] = { u(x0, y0, z0) / GeoAc_Sources.c0,   v(x0, y0, z0) / GeoAc_Sources.c0,     w(x0, y0, z0) / GeoAc_Sources.c0}; // initial v0/c0 vector where v0 is the wind vector  - Mach components
-    double nu0[3] =     { cos(GeoAc_theta) * cos(GeoAc_phi),  cos(GeoAc_theta) * sin(GeoAc_phi),    sin(GeoAc_theta)}; // n = initial unit vector in nthe direction of the ray
-    double mu0_th[3] =  {-sin(GeoAc_theta) * cos(GeoAc_phi), -sin(GeoAc_theta) * sin(GeoAc_phi),    cos(GeoAc_theta)}; // d nu0/d theta
-    double mu0_ph[3] =  {-cos(GeoAc_theta) * sin(GeoAc_phi),  cos(GeoAc_theta) * cos(GeoAc_phi),    0.0};
+    double M_Comps[3] = { u(x0, y0, z0) / src.c0,   v(x0, y0, z0) / src.c0,     w(x0, y0, z0) / src.c0}; // initial v0/c0 vector where v0 is the wind vector  - Mach components
+    double nu0[3] =     { cos(ctx.theta) * cos(ctx.phi),  cos(ctx.theta) * sin(ctx.phi),    sin(ctx.theta)}; // n = initial unit vector in nthe direction of the ray
+    double mu0_th[3] =  {-sin(ctx.theta) * cos(ctx.phi), -sin(ctx.theta) * sin(ctx.phi),    cos(ctx.theta)}; // d nu0/d theta
+    double mu0_ph[3] =  {-cos(ctx.theta) * sin(ctx.phi),  cos(ctx.theta) * cos(ctx.phi),    0.0};
     
     double M = 1.0 + (nu0[0] * M_Comps[0] + nu0[1] * M_Comps[1] + nu0[2] * M_Comps[2]); // 1 + v0/c0*n
     double dM_th = mu0_th[0] * M_Comps[0] + mu0_th[1] * M_Comps[1] + mu0_th[2] * M_Comps[2];
     double dM_ph = mu0_ph[0] * M_Comps[0] + mu0_ph[1] * M_Comps[1] + mu0_ph[2] * M_Comps[2];
     
-    GeoAc_Sources.nu0_xy[0] = nu0[0] / M; // n/(1+v0/c0*n) = c0*n/(c0+v0*n) = c0*initial_slowness_x; slowness here is the grad of eikonal as in Pierce; looks like Phil defines slowness as c0*grad(Pierce eikonal)
-    GeoAc_Sources.nu0_xy[1] = nu0[1] / M;
-    GeoAc_Sources.mu0_xy[0][0] = mu0_th[0] / M - nu0[0] / pow(M,2.0) * dM_th;
-    GeoAc_Sources.mu0_xy[1][0] = mu0_th[1] / M - nu0[1] / pow(M,2.0) * dM_th;
-    GeoAc_Sources.mu0_xy[0][1] = mu0_ph[0] / M - nu0[0] / pow(M,2.0) * dM_ph;
-    GeoAc_Sources.mu0_xy[1][1] = mu0_ph[1] / M - nu0[1] / pow(M,2.0) * dM_ph;
+    src.nu0_xy[0] = nu0[0] / M; // n/(1+v0/c0*n) = c0*n/(c0+v0*n) = c0*initial_slowness_x; slowness here is the grad of eikonal as in Pierce; looks like Phil defines slowness as c0*grad(Pierce eikonal)
+    src.nu0_xy[1] = nu0[1] / M;
+    src.mu0_xy[0][0] = mu0_th[0] / M - nu0[0] / pow(M,2.0) * dM_th;
+    src.mu0_xy[1][0] = mu0_th[1] / M - nu0[1] / pow(M,2.0) * dM_th;
+    src.mu0_xy[0][1] = mu0_ph[0] / M - nu0[0] / pow(M,2.0) * dM_ph;
+    src.mu0_xy[1][1] = mu0_ph[1] / M - nu0[1] / pow(M,2.0) * dM_ph;
     
     // DV
     // cout << "in GeoAc_SetInitialConditions 3D Stratified - " << endl;
 
 
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		switch(index){
 			case(0):			// x(0) = x0
                 solution[0][index] = x0;
@@ -138,12 +147,12 @@ void GeoAc_SetInitialConditions(double ** & solution, double x0, double y0, doub
 //--------------------------------------------------------------------------//
 //-------Taylor series fit to more accurately deterine intercept values-----//
 //--------------------------------------------------------------------------//
-void GeoAc_ApproximateIntercept(double ** solution, int k, double* & prev){
+void GeoAc_ApproximateIntercept(GeoAcContext & ctx, double ** solution, int k, double* & prev){
 	double result;
 	double dz_k = solution[k][2] - solution[k-1][2];	// set dz for step = z_k - z_{k-1}
 	double dz_grnd = solution[k-1][2] - z_grnd;         // set dz from z_{k-1} to ground (assuming z = 0 is ground)
 
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		prev[index] = solution[k-1][index] + (solution[k-1][index] - solution[k][index])/dz_k*dz_grnd
 						+ 1.0/2.0*(solution[k][index] + solution[k-2][index] - 2.0*solution[k-1][index])/pow(dz_k,2.0)*pow(dz_grnd,2.0);	
 		
@@ -153,17 +162,18 @@ void GeoAc_ApproximateIntercept(double ** solution, int k, double* & prev){
 //-------------------------------------------------------------------------//
 //-------Fill in solution[0][n] with the appropriate reflection values-----//
 //-------------------------------------------------------------------------//
-void GeoAc_SetReflectionConditions(double** & solution, int k_end){
-	double* prev = new double [GeoAc_EqCnt];
-	GeoAc_ApproximateIntercept(solution, k_end, prev);
+void GeoAc_SetReflectionConditions(GeoAcContext & ctx, double** & solution, int k_end){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
+	double* prev = new double [ctx.EqCnt];
+	GeoAc_ApproximateIntercept(ctx, solution, k_end, prev);
 
 	double x = prev[0], y = prev[1];
-	double dnuz_ds = - 1.0/c(x,y,z_grnd) * (GeoAc_Sources.c0 / c(x,y,z_grnd) * c_diff(x,y,z_grnd,2)
-                                            + GeoAc_Sources.nu0_xy[0] * u_diff(x,y,z_grnd,2)
-											 + GeoAc_Sources.nu0_xy[1] * v_diff(x,y,z_grnd,2)
+	double dnuz_ds = - 1.0/c(x,y,z_grnd) * (src.c0 / c(x,y,z_grnd) * c_diff(x,y,z_grnd,2)
+                                            + src.nu0_xy[0] * u_diff(x,y,z_grnd,2)
+											 + src.nu0_xy[1] * v_diff(x,y,z_grnd,2)
 											  + prev[3] * w_diff(x,y,z_grnd,2));
 
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		switch(index){
 			case(0):			// x(0) = x(s0)
 			case(1):			// y(0) = y(s0)
@@ -181,7 +191,7 @@ void GeoAc_SetReflectionConditions(double** & solution, int k_end){
 				break;
 			case(7):			// mu_zt(0) = -mu_zt(s0) + 2 dnu_z/ds * ds_0/dtheta
 			case(11):			// mu_zp(0) = -mu_zp(s0) + 2 dnu_z/ds * ds_0/dphi
-				solution[0][index] = -prev[index] + 2.0 * dnuz_ds * prev[index - 1]/(c(x,y,z_grnd) / GeoAc_Sources.c0 * prev[3]);
+				solution[0][index] = -prev[index] + 2.0 * dnuz_ds * prev[index - 1]/(c(x,y,z_grnd) / src.c0 * prev[3]);
 				break;
 			default:
 				cout << "Unexpected index in Initial_Cond.  Model includes 12 variables." << '\n';
@@ -205,47 +215,48 @@ double GeoAc_Set_ds(double* current_values){
 //---------------------------------------//
 //-------Update the source functions-----//
 //---------------------------------------//
-void GeoAc_UpdateSources(double ray_length, double* current_values){
+void GeoAc_UpdateSources(GeoAcContext & ctx, double ray_length, double* current_values){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double x = current_values[0];
 	double y = current_values[1];
 	double z = current_values[2];
-	double nu[3] = {GeoAc_Sources.nu0_xy[0], GeoAc_Sources.nu0_xy[1], current_values[3]};
+	double nu[3] = {src.nu0_xy[0], src.nu0_xy[1], current_values[3]};
 
-    GeoAc_Sources.c = c(x,y,z);		GeoAc_Sources.dc = c_diff(x,y,z,2);
-    GeoAc_Sources.u = u(x,y,z);		GeoAc_Sources.du = u_diff(x,y,z,2);
-    GeoAc_Sources.v = v(x,y,z);		GeoAc_Sources.dv = v_diff(x,y,z,2);
-    GeoAc_Sources.w = w(x,y,z);		GeoAc_Sources.dw = w_diff(x,y,z,2);
+    src.c = c(x,y,z);		src.dc = c_diff(x,y,z,2);
+    src.u = u(x,y,z);		src.du = u_diff(x,y,z,2);
+    src.v = v(x,y,z);		src.dv = v_diff(x,y,z,2);
+    src.w = w(x,y,z);		src.dw = w_diff(x,y,z,2);
 
-    GeoAc_Sources.nu_mag = 	GeoAc_Sources.c0 / GeoAc_Sources.c * (1.0 - (nu[0] * GeoAc_Sources.u + nu[1] * GeoAc_Sources.v + nu[2] * GeoAc_Sources.w) / GeoAc_Sources.c0);
+    src.nu_mag = 	src.c0 / src.c * (1.0 - (nu[0] * src.u + nu[1] * src.v + nu[2] * src.w) / src.c0);
 
-    GeoAc_Sources.c_prop[0] = GeoAc_Sources.c * nu[0] / GeoAc_Sources.nu_mag + GeoAc_Sources.u;
-    GeoAc_Sources.c_prop[1] = GeoAc_Sources.c * nu[1] / GeoAc_Sources.nu_mag + GeoAc_Sources.v;
-    GeoAc_Sources.c_prop[2] = GeoAc_Sources.c * nu[2] / GeoAc_Sources.nu_mag + GeoAc_Sources.w;
-    GeoAc_Sources.c_prop_mag = sqrt(pow(GeoAc_Sources.c_prop[0],2) + pow(GeoAc_Sources.c_prop[1],2) + pow(GeoAc_Sources.c_prop[2],2));
+    src.c_prop[0] = src.c * nu[0] / src.nu_mag + src.u;
+    src.c_prop[1] = src.c * nu[1] / src.nu_mag + src.v;
+    src.c_prop[2] = src.c * nu[2] / src.nu_mag + src.w;
+    src.c_prop_mag = sqrt(pow(src.c_prop[0],2) + pow(src.c_prop[1],2) + pow(src.c_prop[2],2));
 
 	double dwinds[3], mu_th[3], mu_ph[3], Zth, Zph, dnu_th, dnu_ph;
-	if(GeoAc_CalcAmp){
-		GeoAc_Sources.ddc = c_ddiff(x,y,z,2,2);     GeoAc_Sources.ddu = u_ddiff(x,y,z,2,2);
-		GeoAc_Sources.ddv = v_ddiff(x,y,z,2,2);     GeoAc_Sources.ddw = w_ddiff(x,y,z,2,2);
+	if(ctx.CalcAmp){
+		src.ddc = c_ddiff(x,y,z,2,2);     src.ddu = u_ddiff(x,y,z,2,2);
+		src.ddv = v_ddiff(x,y,z,2,2);     src.ddw = w_ddiff(x,y,z,2,2);
 
-		mu_th[0] = GeoAc_Sources.mu0_xy[0][0];  mu_th[1] = GeoAc_Sources.mu0_xy[1][0]; 	mu_th[2] = current_values[7];   Zth = current_values[6];
-		mu_ph[0] = GeoAc_Sources.mu0_xy[0][1];	mu_ph[1] = GeoAc_Sources.mu0_xy[1][1];  mu_ph[2] = current_values[11];  Zph = current_values[10];
+		mu_th[0] = src.mu0_xy[0][0];  mu_th[1] = src.mu0_xy[1][0]; 	mu_th[2] = current_values[7];   Zth = current_values[6];
+		mu_ph[0] = src.mu0_xy[0][1];	mu_ph[1] = src.mu0_xy[1][1];  mu_ph[2] = current_values[11];  Zph = current_values[10];
 
-		GeoAc_Sources.dnu_mag[0] = (nu[0] * mu_th[0] + nu[1] * mu_th[1] + nu[2] * mu_th[2]) / GeoAc_Sources.nu_mag;
-		GeoAc_Sources.dnu_mag[1] = (nu[0] * mu_ph[0] + nu[1] * mu_ph[1] + nu[2] * mu_ph[2]) / GeoAc_Sources.nu_mag;   
+		src.dnu_mag[0] = (nu[0] * mu_th[0] + nu[1] * mu_th[1] + nu[2] * mu_th[2]) / src.nu_mag;
+		src.dnu_mag[1] = (nu[0] * mu_ph[0] + nu[1] * mu_ph[1] + nu[2] * mu_ph[2]) / src.nu_mag;   
 		
 		dwinds[0] = u_diff(x,y,z,2);
         dwinds[1] = v_diff(x,y,z,2);
         dwinds[2] = w_diff(x,y,z,2);
         for(int n = 0; n < 3; n++){
-            GeoAc_Sources.dc_prop[n][0] = nu[n] / GeoAc_Sources.nu_mag * GeoAc_Sources.dc * Zth + GeoAc_Sources.c * mu_th[n] / GeoAc_Sources.nu_mag
-                        - GeoAc_Sources.c * nu[n] / pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[0] + dwinds[n] * Zth;
-            GeoAc_Sources.dc_prop[n][1] = nu[n] / GeoAc_Sources.nu_mag * GeoAc_Sources.dc * Zph + GeoAc_Sources.c * mu_ph[n] / GeoAc_Sources.nu_mag
-                        - GeoAc_Sources.c * nu[n] / pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[1] + dwinds[n] * Zph;
+            src.dc_prop[n][0] = nu[n] / src.nu_mag * src.dc * Zth + src.c * mu_th[n] / src.nu_mag
+                        - src.c * nu[n] / pow(src.nu_mag,2) * src.dnu_mag[0] + dwinds[n] * Zth;
+            src.dc_prop[n][1] = nu[n] / src.nu_mag * src.dc * Zph + src.c * mu_ph[n] / src.nu_mag
+                        - src.c * nu[n] / pow(src.nu_mag,2) * src.dnu_mag[1] + dwinds[n] * Zph;
         }
 
-        GeoAc_Sources.dc_prop_mag[0] = (GeoAc_Sources.c_prop[0] * GeoAc_Sources.dc_prop[0][0] + GeoAc_Sources.c_prop[1] * GeoAc_Sources.dc_prop[1][0] + GeoAc_Sources.c_prop[2] * GeoAc_Sources.dc_prop[2][0]) / GeoAc_Sources.c_prop_mag;
-        GeoAc_Sources.dc_prop_mag[1] = (GeoAc_Sources.c_prop[0] * GeoAc_Sources.dc_prop[0][1] + GeoAc_Sources.c_prop[1] * GeoAc_Sources.dc_prop[1][1] + GeoAc_Sources.c_prop[2] * GeoAc_Sources.dc_prop[2][1]) / GeoAc_Sources.c_prop_mag;
+        src.dc_prop_mag[0] = (src.c_prop[0] * src.dc_prop[0][0] + src.c_prop[1] * src.dc_prop[1][0] + src.c_prop[2] * src.dc_prop[2][0]) / src.c_prop_mag;
+        src.dc_prop_mag[1] = (src.c_prop[0] * src.dc_prop[0][1] + src.c_prop[1] * src.dc_prop[1][1] + src.c_prop[2] * src.dc_prop[2][1]) / src.c_prop_mag;
 
 	}
 }
@@ -253,62 +264,63 @@ void GeoAc_UpdateSources(double ray_length, double* current_values){
 //-----------------------------------------------------------//
 //-------Evaluate the Source Equation For Specific Index-----//
 //-----------------------------------------------------------//
-double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number){
+double GeoAc_EvalSrcEq(GeoAcContext & ctx, double ray_length, double* current_values, int Eq_Number){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double result;
 
-    double cp_mag = GeoAc_Sources.c_prop_mag;
+    double cp_mag = src.c_prop_mag;
 	double nu[3], mu[3];
     
 	switch(Eq_Number){
 		case(0): // dx/ds
 		case(1): // dy/ds
 		case(2): // dz/ds
-			result = GeoAc_Sources.c_prop[Eq_Number] / cp_mag;
+			result = src.c_prop[Eq_Number] / cp_mag;
 			break;
             
 		case(3): // d nu_z /ds
-            nu[0] = GeoAc_Sources.nu0_xy[0];
-            nu[1] = GeoAc_Sources.nu0_xy[1];
+            nu[0] = src.nu0_xy[0];
+            nu[1] = src.nu0_xy[1];
             nu[2] = current_values[3];
             
-            result = -1.0 / cp_mag * (GeoAc_Sources.nu_mag * GeoAc_Sources.dc
-                                            + (nu[0] * GeoAc_Sources.du + nu[1] * GeoAc_Sources.dv + nu[2] * GeoAc_Sources.dw));
+            result = -1.0 / cp_mag * (src.nu_mag * src.dc
+                                            + (nu[0] * src.du + nu[1] * src.dv + nu[2] * src.dw));
 			break;
 
 		case(4): // dXt/ds
 		case(5): // dYt/ds
 		case(6): // dZt/ds
-			result = GeoAc_Sources.dc_prop[Eq_Number - 4][0] / cp_mag
-                        - GeoAc_Sources.c_prop[Eq_Number - 4] / pow(cp_mag,2) * GeoAc_Sources.dc_prop_mag[0];
+			result = src.dc_prop[Eq_Number - 4][0] / cp_mag
+                        - src.c_prop[Eq_Number - 4] / pow(cp_mag,2) * src.dc_prop_mag[0];
 			break;
 
 
 		case(7): // d mu_zt /ds
-            nu[0] = GeoAc_Sources.nu0_xy[0];    mu[0] = GeoAc_Sources.mu0_xy[0][0];
-            nu[1] = GeoAc_Sources.nu0_xy[1];    mu[1] = GeoAc_Sources.mu0_xy[1][0];
+            nu[0] = src.nu0_xy[0];    mu[0] = src.mu0_xy[0][0];
+            nu[1] = src.nu0_xy[1];    mu[1] = src.mu0_xy[1][0];
             nu[2] = current_values[3];          mu[2] = current_values[7];
     
-			result = 1.0 / pow(cp_mag, 2) * (GeoAc_Sources.nu_mag * GeoAc_Sources.dc + (nu[0] * GeoAc_Sources.du + nu[1] * GeoAc_Sources.dv + nu[2] *GeoAc_Sources.dw)) * GeoAc_Sources.dc_prop_mag[0]
-						-1.0 / cp_mag * (GeoAc_Sources.dnu_mag[0] * GeoAc_Sources.dc + (mu[0] * GeoAc_Sources.du + mu[1] * GeoAc_Sources.dv + mu[2] * GeoAc_Sources.dw
-                                                + (GeoAc_Sources.nu_mag * GeoAc_Sources.ddc + nu[0] * GeoAc_Sources.ddu + nu[1] * GeoAc_Sources.ddv + nu[2] * GeoAc_Sources.ddw) * current_values[6]));
+			result = 1.0 / pow(cp_mag, 2) * (src.nu_mag * src.dc + (nu[0] * src.du + nu[1] * src.dv + nu[2] *src.dw)) * src.dc_prop_mag[0]
+						-1.0 / cp_mag * (src.dnu_mag[0] * src.dc + (mu[0] * src.du + mu[1] * src.dv + mu[2] * src.dw
+                                                + (src.nu_mag * src.ddc + nu[0] * src.ddu + nu[1] * src.ddv + nu[2] * src.ddw) * current_values[6]));
 			break;
 
 
 		case(8):  // dXp/ds
 		case(9):  // dYp/ds
 		case(10): // dZp/ds
-			result =  GeoAc_Sources.dc_prop[Eq_Number - 8][1] / cp_mag
-                        - GeoAc_Sources.c_prop[Eq_Number - 8] / pow(cp_mag,2) * GeoAc_Sources.dc_prop_mag[1];
+			result =  src.dc_prop[Eq_Number - 8][1] / cp_mag
+                        - src.c_prop[Eq_Number - 8] / pow(cp_mag,2) * src.dc_prop_mag[1];
 			break;
 
 		case(11): // d mu_zp/ds
-            nu[0] = GeoAc_Sources.nu0_xy[0];    mu[0] = GeoAc_Sources.mu0_xy[0][1];
-            nu[1] = GeoAc_Sources.nu0_xy[1];    mu[1] = GeoAc_Sources.mu0_xy[1][1];
+            nu[0] = src.nu0_xy[0];    mu[0] = src.mu0_xy[0][1];
+            nu[1] = src.nu0_xy[1];    mu[1] = src.mu0_xy[1][1];
             nu[2] = current_values[3];          mu[2] = current_values[11];
             
-			result = 1.0 / pow(cp_mag, 2) * (GeoAc_Sources.nu_mag * GeoAc_Sources.dc + (nu[0] * GeoAc_Sources.du + nu[1] * GeoAc_Sources.dv + nu[2] *GeoAc_Sources.dw)) * GeoAc_Sources.dc_prop_mag[1]
-            -1.0 / cp_mag * (GeoAc_Sources.dnu_mag[1] * GeoAc_Sources.dc + (mu[0] * GeoAc_Sources.du + mu[1] * GeoAc_Sources.dv + mu[2] * GeoAc_Sources.dw
-                                                                            + (GeoAc_Sources.nu_mag * GeoAc_Sources.ddc + nu[0] * GeoAc_Sources.ddu + nu[1] * GeoAc_Sources.ddv + nu[2] * GeoAc_Sources.ddw) * current_values[10]));
+			result = 1.0 / pow(cp_mag, 2) * (src.nu_mag * src.dc + (nu[0] * src.du + nu[1] * src.dv + nu[2] *src.dw)) * src.dc_prop_mag[1]
+            -1.0 / cp_mag * (src.dnu_mag[1] * src.dc + (mu[0] * src.du + mu[1] * src.dv + mu[2] * src.dw
+                                                                            + (src.nu_mag * src.ddc + nu[0] * src.ddu + nu[1] * src.ddv + nu[2] * src.ddw) * current_values[10]));
 			break;
 	}
 	return result;
@@ -317,19 +329,20 @@ double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number)
 //-------------------------------------------------------------------//
 //-------Calculate the Hamiltonian (Eikonal) To Check For Errors-----//
 //-------------------------------------------------------------------//
-double GeoAc_EvalHamiltonian(double ** solution, int k){
+double GeoAc_EvalHamiltonian(GeoAcContext & ctx, double ** solution, int k){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double x = solution[k][0], y = solution[k][1], z = solution[k][2];
-    double nu[3] = {GeoAc_Sources.nu0_xy[0], GeoAc_Sources.nu0_xy[1], solution[k][3]};
+    double nu[3] = {src.nu0_xy[0], src.nu0_xy[1], solution[k][3]};
     	
     return fabs(sqrt(nu[0] * nu[0] + nu[1] * nu[1] + nu[2] * nu[2])
-                - GeoAc_Sources.c0 / c(x,y,z)*(1.0 - (nu[0] * u(x,y,z) + nu[1] * v(x,y,z) + nu[2] * w(x,y,z)) / GeoAc_Sources.c0));
+                - src.c0 / c(x,y,z)*(1.0 - (nu[0] * u(x,y,z) + nu[1] * v(x,y,z) + nu[2] * w(x,y,z)) / src.c0));
 }
 
 
 //--------------------------------------------------------------------------//
 //-------Check if ray has left propagation region or returned to ground-----//
 //--------------------------------------------------------------------------//
-bool GeoAc_BreakCheck(double ** solution, int index){
+bool GeoAc_BreakCheck(GeoAcContext & ctx, double ** solution, int index){
 	double r 	= sqrt(pow(solution[index][0],2) + pow(solution[index][1],2));
 	double z 	= solution[index][2];
 	
@@ -350,12 +363,13 @@ bool GeoAc_GroundCheck(double ** solution, int index){
 //----------------------------------------------------------------------------------//
 //-------Calculate the travel time from source to location or between locations-----//
 //----------------------------------------------------------------------------------//
-double GeoAc_TravelTime(double ** solution, int index){
+double GeoAc_TravelTime(GeoAcContext & ctx, double ** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double dx, dy, dz, ds, x, y, z, nu[3], nu_mag, c_prop[3], c_prop_mag;
 	double traveltime = 0;
 	
-    nu[0] = GeoAc_Sources.nu0_xy[0];
-    nu[1] = GeoAc_Sources.nu0_xy[1];
+    nu[0] = src.nu0_xy[0];
+    nu[1] = src.nu0_xy[1];
     
 	for (int n = 0; n < index; n++){
 		
@@ -380,12 +394,13 @@ double GeoAc_TravelTime(double ** solution, int index){
 	return traveltime;	
 }
 
-void GeoAc_TravelTimeSegment(double & time, double ** solution, int start, int end){
+void GeoAc_TravelTimeSegment(GeoAcContext & ctx, double & time, double ** solution, int start, int end){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double dx, dy, dz, ds, x, y, z, nu[3], nu_mag, c_prop[3], c_prop_mag;
 	double traveltime = 0;
 	
-    nu[0] = GeoAc_Sources.nu0_xy[0];
-    nu[1] = GeoAc_Sources.nu0_xy[1];
+    nu[0] = src.nu0_xy[0];
+    nu[1] = src.nu0_xy[1];
     
 	for (int n = start; n < end; n++){
 		
@@ -412,11 +427,12 @@ void GeoAc_TravelTimeSegment(double & time, double ** solution, int start, int e
 //-----------------------------------------------------------------------------------//
 //-------Calculate the Jacobian determinant and from it the ampltude coefficient-----//
 //-----------------------------------------------------------------------------------//
-double GeoAc_Jacobian(double ** solution, int index){
+double GeoAc_Jacobian(GeoAcContext & ctx, double ** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double x = solution[index][0], y = solution[index][1], z = solution[index][2];
-    double x0 = GeoAc_Sources.src_loc[0], y0 = GeoAc_Sources.src_loc[1], z0 = GeoAc_Sources.src_loc[2];
+    double x0 = src.src_loc[0], y0 = src.src_loc[1], z0 = src.src_loc[2];
     
-	double nu[3] = 		{GeoAc_Sources.nu0_xy[0], GeoAc_Sources.nu0_xy[1], solution[index][3]};
+	double nu[3] = 		{src.nu0_xy[0], src.nu0_xy[1], solution[index][3]};
 	double nu_mag = 	(c(x0,y0,z0) - nu[0]*u(x,y,z) - nu[1]*v(x,y,z))/c(x,y,z);
 	double c_prop[3] = 	{c(x,y,z) * nu[0] / nu_mag + u(x,y,z),
                          c(x,y,z) * nu[1] / nu_mag + v(x,y,z),
@@ -433,11 +449,12 @@ double GeoAc_Jacobian(double ** solution, int index){
 }
 
 
-double GeoAc_Amplitude(double ** solution, int index){
+double GeoAc_Amplitude(GeoAcContext & ctx, double ** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double x = solution[index][0], y = solution[index][1], z = solution[index][2];
-    double x0 = GeoAc_Sources.src_loc[0], y0 = GeoAc_Sources.src_loc[1], z0 = GeoAc_Sources.src_loc[2];
+    double x0 = src.src_loc[0], y0 = src.src_loc[1], z0 = src.src_loc[2];
     
-	double nu[3] = 		{GeoAc_Sources.nu0_xy[0], GeoAc_Sources.nu0_xy[1], solution[index][3]};
+	double nu[3] = 		{src.nu0_xy[0], src.nu0_xy[1], solution[index][3]};
     double nu_mag = 	(c(x0,y0,z0) - nu[0]*u(x,y,z) - nu[1]*v(x,y,z))/c(x,y,z);
     double nu_mag0 =    1.0 - (nu[0] * u(x0,y0,z0) - nu[1] * v(x0,y0,z0))/c(x0,y0,z0);
 	
@@ -446,9 +463,9 @@ double GeoAc_Amplitude(double ** solution, int index){
 
 	double  c_prop_mag =  sqrt(pow(c_prop[0],2) + pow(c_prop[1],2) + pow(c_prop[2],2)),
             c_prop_mag0 = sqrt(pow(c_prop0[0],2) + pow(c_prop0[1],2) + pow(c_prop0[2],2));
-	double  D = GeoAc_Jacobian(solution, index);
+	double  D = GeoAc_Jacobian(ctx, solution, index);
 	
-	double  Amp_Num = rho(x,y,z) * nu_mag * pow(c(x,y,z),3) * c_prop_mag0 * cos(GeoAc_theta);
+	double  Amp_Num = rho(x,y,z) * nu_mag * pow(c(x,y,z),3) * c_prop_mag0 * cos(ctx.theta);
 	double  Amp_Den = rho(x0,y0,z0) * nu_mag0* pow(c(x0,y0,z0),3) * c_prop_mag * D;
 	
 	
@@ -458,7 +475,7 @@ double GeoAc_Amplitude(double ** solution, int index){
 //--------------------------------------------------------------------------//
 //------Integrate the Sutherland Bass Attenuation Through the Ray Path------//
 //--------------------------------------------------------------------------//
-double GeoAc_SB_Atten(double ** solution, int end, double freq){
+double GeoAc_SB_Atten(GeoAcContext & ctx, double ** solution, int end, double freq){
 	double dx, dy, dz, ds, x, y, z;
     double atten = 0.0;
 	for (int n = 0; n < end; n++){
@@ -477,7 +494,7 @@ double GeoAc_SB_Atten(double ** solution, int end, double freq){
     return atten;
 }
 
-void GeoAc_SB_AttenSegment(double & atten, double ** solution, int start, int end, double freq){
+void GeoAc_SB_AttenSegment(GeoAcContext & ctx, double & atten, double ** solution, int start, int end, double freq){
 	double dx, dy, dz, ds, x, y, z;
 	for (int n = start; n < end; n++){
 		
@@ -499,11 +516,11 @@ void GeoAc_SB_AttenSegment(double & atten, double ** solution, int start, int en
 //---------Count the caustics encountered by monitoring---------//
 //----how many times the Jacobian determinant changes sign------//
 //--------------------------------------------------------------//
-int GeoAc_CausticCnt(double ** solution, int start, int index){
+int GeoAc_CausticCnt(GeoAcContext & ctx, double ** solution, int start, int index){
 	int count = 0;
-	double current, prev = GeoAc_Jacobian(solution, 1);
+	double current, prev = GeoAc_Jacobian(ctx, solution, 1);
 	for(int n = 2; n < index; n++){
-		current = GeoAc_Jacobian(solution,n);
+		current = GeoAc_Jacobian(ctx, solution,n);
 		if(current*prev < 0.0){
 			count++;
 		}
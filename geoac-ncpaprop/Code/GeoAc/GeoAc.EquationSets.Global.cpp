@@ -12,9 +12,9 @@ using namespace std;
 //--------------------------------------------------//
 //-------Propagate in 3D, assume non-stratified-----//
 //--------------------------------------------------//
-void GeoAc_SetSystem(){
-    GeoAc_dim = 3;				// Dimensions
-    GeoAc_AtmoStrat = false;     // Is the medium stratified?
+void GeoAc_SetSystem(GeoAcContext & ctx){
+    ctx.dim = 3;				// Dimensions
+    ctx.AtmoStrat = false;     // Is the medium stratified?
 }
 
 //-----------------------------------------------------------//
@@ -58,37 +58,44 @@ struct GeoAc_Sources_Struct{
     double d_GeoTerms[3][2];    // Angular derivatives of the extra terms keeping the eikonal vector direction constant
 };
 
-struct GeoAc_Sources_Struct GeoAc_Sources = {
-    {0.0, 0.0, 0.0}, 0.0,
-    0.0, {0.0, 0.0, 0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
-    0.0, {0.0, 0.0, 0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
-    0.0, {0.0, 0.0, 0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
-    0.0, {0.0, 0.0, 0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
-    0.0, 0.0, {0.0, 0.0},
-    {0.0, 0.0, 0.0}, 0.0, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}}, {0.0, 0.0},
-    {0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
-    {0.0, 0.0, 0.0}, {{0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}}
-};
+//-----------------------------------------------------------//
+//-------Allocate and release the per-ray source terms-------//
+//-------------------held by a solver context----------------//
+//-----------------------------------------------------------//
+void GeoAc_InitContext(GeoAcContext & ctx){
+    ctx.theta = 0.0;
+    ctx.phi = 0.0;
+    ctx.EqCnt = 0;                                      // Set by GeoAc_ConfigureCalcAmp
+    ctx.CalcAmp = false;
+    ctx.Sources = new struct GeoAc_Sources_Struct();
+    GeoAc_SetSystem(ctx);
+}
+
+void GeoAc_ClearContext(GeoAcContext & ctx){
+    delete ctx.Sources;
+    ctx.Sources = NULL;
+}
 
 //----------------------------------------------------------------------//
 //-------Fill in solution[0][n] with the appropriate initial values-----//
 //----------------------------------------------------------------------//
-void GeoAc_SetInitialConditions(double ** & solution, double r0, double theta0, double phi0){
-    GeoAc_Sources.src_loc[0] = r0 + r_earth;
-    GeoAc_Sources.src_loc[1] = theta0;
-    GeoAc_Sources.src_loc[2] = phi0;    
-	GeoAc_Sources.c0 = c(r0 + r_earth, theta0, phi0);
-    
-    double MachComps[3] = { w(r0 + r_earth, theta0, phi0)/GeoAc_Sources.c0,
-                            v(r0 + r_earth, theta0, phi0)/GeoAc_Sources.c0,
-                            u(r0 + r_earth, theta0, phi0)/GeoAc_Sources.c0};
-    double nu0[3] =    {sin(GeoAc_theta),  cos(GeoAc_theta)*sin(GeoAc_phi),    cos(GeoAc_theta)*cos(GeoAc_phi)};
-    double mu0_lt[3] = {cos(GeoAc_theta), -sin(GeoAc_theta)*sin(GeoAc_phi),   -sin(GeoAc_theta)*cos(GeoAc_phi)};
-    double mu0_lp[3] = {0.0,               cos(GeoAc_theta)*cos(GeoAc_phi),   -cos(GeoAc_theta)*sin(GeoAc_phi)};
+void GeoAc_SetInitialConditions(GeoAcContext & ctx, double ** & solution, double r0, double theta0, double phi0){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
+    src.src_loc[0] = r0 + r_earth;
+    src.src_loc[1] = theta0;
+    src.src_loc[2] = phi0;    
+	src.c0 = c(r0 + r_earth, theta0, phi0);
+    
+    double MachComps[3] = { w(r0 + r_earth, theta0, phi0)/src.c0,
+                            v(r0 + r_earth, theta0, phi0)/src.c0,
+                            u(r0 + r_earth, theta0, phi0)/src.c0};
+    double nu0[3] =    {sin(ctx.theta),  cos(ctx.theta)*sin(ctx.phi),    cos(ctx.theta)*cos(ctx.phi)};
+    double mu0_lt[3] = {cos(ctx.theta), -sin(ctx.theta)*sin(ctx.phi),   -sin(ctx.theta)*cos(ctx.phi)};
+    double mu0_lp[3] = {0.0,               cos(ctx.theta)*cos(ctx.phi),   -cos(ctx.theta)*sin(ctx.phi)};
     double MachScalar = 1.0 + (nu0[0]*MachComps[0] + nu0[1]*MachComps[1] + nu0[2]*MachComps[2]);
-    GeoAc_Sources.nu0 = 1.0/MachScalar;
+    src.nu0 = 1.0/MachScalar;
     
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		switch(index){
 			case(0):			// r(0) = r0 relative to earth radius
 				solution[0][index] =  r0 + r_earth;
@@ -137,12 +144,12 @@ void GeoAc_SetInitialConditions(double ** & solution, double r0, double theta0,
 //--------------------------------------------------------------------------//
 //-------Taylor series fit to more accurately deterine intercept values-----//
 //--------------------------------------------------------------------------//
-void GeoAc_ApproximateIntercept(double ** solution, int k, double* & prev){
+void GeoAc_ApproximateIntercept(GeoAcContext & ctx, double ** solution, int k, double* & prev){
 	double result;
 	double dr_k = solution[k][0] - solution[k-1][0];            // set dr for step = r_k - r_{k-1}
 	double dr_grnd = solution[k-1][0] - (r_earth + z_grnd);	// set dr from r_{k-1} to ground
     
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		prev[index] = solution[k-1][index] 	+ (solution[k-1][index] - solution[k][index])/dr_k*dr_grnd;
                         + 1.0/2.0*(solution[k][index] + solution[k-2][index] - 2.0*solution[k-1][index])/pow(dr_k,2.0)*pow(dr_grnd,2.0);
 	}
@@ -151,19 +158,20 @@ void GeoAc_ApproximateIntercept(double ** solution, int k, double* & prev){
 //-------------------------------------------------------------------------//
 //-------Fill in solution[0][n] with the appropriate reflection values-----//
 //-------------------------------------------------------------------------//
-void GeoAc_SetReflectionConditions(double** & solution, int k_end){
-	double* prev = new double [GeoAc_EqCnt];
-	GeoAc_ApproximateIntercept(solution, k_end, prev);
+void GeoAc_SetReflectionConditions(GeoAcContext & ctx, double** & solution, int k_end){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
+	double* prev = new double [ctx.EqCnt];
+	GeoAc_ApproximateIntercept(ctx, solution, k_end, prev);
     
     double c_ref = c(prev[0], prev[1], prev[2]);
-	double dnu_r_ds = - 1.0/c_ref * (GeoAc_Sources.c0/c_ref * c_diff(prev[0],prev[1],prev[2],0)
+	double dnu_r_ds = - 1.0/c_ref * (src.c0/c_ref * c_diff(prev[0],prev[1],prev[2],0)
                                                          + prev[3] * w_diff(prev[0],prev[1],prev[2],0)
                                                             + prev[4] * v_diff(prev[0],prev[1],prev[2],0)
                                                                 + prev[5] * u_diff(prev[0],prev[1],prev[2],0)
                                                                     + c_ref/prev[0] * (pow(prev[4],2) + pow(prev[5],2)));
     
 	
-	for(int index = 0; index < GeoAc_EqCnt; index++){
+	for(int index = 0; index < ctx.EqCnt; index++){
 		switch(index){
 			case(0):			// r(s0+) = 		r_ground (theta(s0-),phi(s0-))
                 solution[0][index] = r_earth + z_grnd;
@@ -197,7 +205,7 @@ void GeoAc_SetReflectionConditions(double** & solution, int k_end){
                 
             case(9):			// mu_r_lt(s0+) = 	-mu_r_lt(s0-) + 2 d nu_r/ds * ds0/dlt
             case(15):			// mu_r_lp(s0+) = 	mu_r_lp(s0-)  2 d nu_r/ds * sd0/dlp
-                solution[0][index] =  -prev[index] + 2.0*dnu_r_ds * prev[index - 3]/(c_ref / GeoAc_Sources.c0 * prev[3]);
+                solution[0][index] =  -prev[index] + 2.0*dnu_r_ds * prev[index - 3]/(c_ref / src.c0 * prev[3]);
                 break;       
         }
 	}
@@ -219,59 +227,60 @@ double GeoAc_Set_ds(double* current_values){
 //---------------------------------------//
 //-------Update the source functions-----//
 //---------------------------------------//
-void GeoAc_UpdateSources(double ray_length, double* current_values){
+void GeoAc_UpdateSources(GeoAcContext & ctx, double ray_length, double* current_values){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
     // Extract ray location and eikonal vector components
     double r = current_values[0],		theta = current_values[1], 	phi = current_values[2];
 	double nu[3] = {current_values[3], 	current_values[4], 		current_values[5]};
     
 	// Update thermodynamic sound speed, winds and their r, theta, and phi derivatives
-    GeoAc_Sources.c = c(r,theta,phi);
-    GeoAc_Sources.w = w(r,theta,phi);
-    GeoAc_Sources.v = v(r,theta,phi);
-    GeoAc_Sources.u = u(r,theta,phi);
-    
-    GeoAc_Sources.dc[0] = c_diff(r,theta,phi,0);
-    GeoAc_Sources.dw[0] = w_diff(r,theta,phi,0);
-    GeoAc_Sources.dv[0] = v_diff(r,theta,phi,0);
-    GeoAc_Sources.du[0] = u_diff(r,theta,phi,0);
-    
-    GeoAc_Sources.dc[1] = c_diff(r,theta,phi,1);
-    GeoAc_Sources.dw[1] = w_diff(r,theta,phi,1);
-    GeoAc_Sources.dv[1] = v_diff(r,theta,phi,1);
-    GeoAc_Sources.du[1] = u_diff(r,theta,phi,1);
-    
-    GeoAc_Sources.dc[2] = c_diff(r,theta,phi,2);
-    GeoAc_Sources.dw[2] = w_diff(r,theta,phi,2);
-    GeoAc_Sources.dv[2] = v_diff(r,theta,phi,2);
-    GeoAc_Sources.du[2] = u_diff(r,theta,phi,2);
+    src.c = c(r,theta,phi);
+    src.w = w(r,theta,phi);
+    src.v = v(r,theta,phi);
+    src.u = u(r,theta,phi);
+    
+    src.dc[0] = c_diff(r,theta,phi,0);
+    src.dw[0] = w_diff(r,theta,phi,0);
+    src.dv[0] = v_diff(r,theta,phi,0);
+    src.du[0] = u_diff(r,theta,phi,0);
+    
+    src.dc[1] = c_diff(r,theta,phi,1);
+    src.dw[1] = w_diff(r,theta,phi,1);
+    src.dv[1] = v_diff(r,theta,phi,1);
+    src.du[1] = u_diff(r,theta,phi,1);
+    
+    src.dc[2] = c_diff(r,theta,phi,2);
+    src.dw[2] = w_diff(r,theta,phi,2);
+    src.dv[2] = v_diff(r,theta,phi,2);
+    src.du[2] = u_diff(r,theta,phi,2);
     
     // Update Eikonal vector magnitude and group velocity
-    GeoAc_Sources.nu_mag = 	 sqrt( nu[0]*nu[0] + nu[1]*nu[1] + nu[2]*nu[2]);
+    src.nu_mag = 	 sqrt( nu[0]*nu[0] + nu[1]*nu[1] + nu[2]*nu[2]);
 
-    GeoAc_Sources.c_gr[0] =  GeoAc_Sources.c*nu[0]/GeoAc_Sources.nu_mag + GeoAc_Sources.w;
-    GeoAc_Sources.c_gr[1] =  GeoAc_Sources.c*nu[1]/GeoAc_Sources.nu_mag + GeoAc_Sources.v;
-    GeoAc_Sources.c_gr[2] =  GeoAc_Sources.c*nu[2]/GeoAc_Sources.nu_mag + GeoAc_Sources.u;
+    src.c_gr[0] =  src.c*nu[0]/src.nu_mag + src.w;
+    src.c_gr[1] =  src.c*nu[1]/src.nu_mag + src.v;
+    src.c_gr[2] =  src.c*nu[2]/src.nu_mag + src.u;
     
-    GeoAc_Sources.c_gr_mag = sqrt(pow(GeoAc_Sources.c_gr[0],2) + pow(GeoAc_Sources.c_gr[1],2) + pow(GeoAc_Sources.c_gr[2],2));
+    src.c_gr_mag = sqrt(pow(src.c_gr[0],2) + pow(src.c_gr[1],2) + pow(src.c_gr[2],2));
     
     // Update geometric coefficients
-    GeoAc_Sources.GeoCoeff[0] = 1.0;
-    GeoAc_Sources.GeoCoeff[1] = 1.0/r;
-    GeoAc_Sources.GeoCoeff[2] = 1.0/(r*cos(theta));
+    src.GeoCoeff[0] = 1.0;
+    src.GeoCoeff[1] = 1.0/r;
+    src.GeoCoeff[2] = 1.0/(r*cos(theta));
     
     // Update Eikonal geometric terms
-    GeoAc_Sources.GeoTerms[0] = 0.0;
-    GeoAc_Sources.GeoTerms[1] = (nu[0]*GeoAc_Sources.v - nu[1]*GeoAc_Sources.w);
-    GeoAc_Sources.GeoTerms[2] = (nu[0]*GeoAc_Sources.u - nu[2]*GeoAc_Sources.w)*cos(theta) + (nu[1]*GeoAc_Sources.u - nu[2]*GeoAc_Sources.v)*sin(theta);
+    src.GeoTerms[0] = 0.0;
+    src.GeoTerms[1] = (nu[0]*src.v - nu[1]*src.w);
+    src.GeoTerms[2] = (nu[0]*src.u - nu[2]*src.w)*cos(theta) + (nu[1]*src.u - nu[2]*src.v)*sin(theta);
     
-    GeoAc_Sources.GeoTerms[0] += 1.0/r * (nu[1]*GeoAc_Sources.c_gr[1] + nu[2]*GeoAc_Sources.c_gr[2]);
-    GeoAc_Sources.GeoTerms[1] += -nu[0]*GeoAc_Sources.c_gr[1] + nu[2]*GeoAc_Sources.c_gr[2]*tan(theta);
-    GeoAc_Sources.GeoTerms[2] += -GeoAc_Sources.c_gr[2]*(nu[0]*cos(theta) + nu[1]*sin(theta));
+    src.GeoTerms[0] += 1.0/r * (nu[1]*src.c_gr[1] + nu[2]*src.c_gr[2]);
+    src.GeoTerms[1] += -nu[0]*src.c_gr[1] + nu[2]*src.c_gr[2]*tan(theta);
+    src.GeoTerms[2] += -src.c_gr[2]*(nu[0]*cos(theta) + nu[1]*sin(theta));
     
     
     // The following code is only used if amplitudes are to be calculated; the above results are sufficient for producing ray geometry
 	double R_lt[3], R_lp[3], mu_lt[3], mu_lp[3];
-	if(GeoAc_CalcAmp){
+	if(ctx.CalcAmp){
 
         R_lt[0]  = current_values[6];       R_lt[1]  = current_values[7];       R_lt[2]  = current_values[8];
 		mu_lt[0] = current_values[9];		mu_lt[1] = current_values[10];		mu_lt[2] = current_values[11];
@@ -279,99 +288,100 @@ void GeoAc_UpdateSources(double ray_length, double* current_values){
 		mu_lp[0] = current_values[15];		mu_lp[1] = current_values[16];		mu_lp[2] = current_values[17];
         
         // Update lt, lp, and second order derivatives of sound speed and winds
-        GeoAc_Sources.dc[3] = 0.0;  GeoAc_Sources.dc[4] = 0.0;
-        GeoAc_Sources.dw[3] = 0.0;  GeoAc_Sources.dw[4] = 0.0;
-        GeoAc_Sources.dv[3] = 0.0;  GeoAc_Sources.dv[4] = 0.0;
-        GeoAc_Sources.du[3] = 0.0;  GeoAc_Sources.du[4] = 0.0;
+        src.dc[3] = 0.0;  src.dc[4] = 0.0;
+        src.dw[3] = 0.0;  src.dw[4] = 0.0;
+        src.dv[3] = 0.0;  src.dv[4] = 0.0;
+        src.du[3] = 0.0;  src.du[4] = 0.0;
 
         for(int n = 0; n < 3; n++){
-            GeoAc_Sources.ddc[n][0] = 0.0;
-            GeoAc_Sources.ddw[n][0] = 0.0;
-            GeoAc_Sources.ddv[n][0] = 0.0;
-            GeoAc_Sources.ddu[n][0] = 0.0;
+            src.ddc[n][0] = 0.0;
+            src.ddw[n][0] = 0.0;
+            src.ddv[n][0] = 0.0;
+            src.ddu[n][0] = 0.0;
             
-            GeoAc_Sources.ddc[n][1] = 0.0;
-            GeoAc_Sources.ddw[n][1] = 0.0;
-            GeoAc_Sources.ddv[n][1] = 0.0;
-            GeoAc_Sources.ddu[n][1] = 0.0;
+            src.ddc[n][1] = 0.0;
+            src.ddw[n][1] = 0.0;
+            src.ddv[n][1] = 0.0;
+            src.ddu[n][1] = 0.0;
         }
 
         
         for(int n = 0; n < 3; n++){
-            GeoAc_Sources.dc[3] += R_lt[n]*c_diff(r,theta,phi,n);
-            GeoAc_Sources.dw[3] += R_lt[n]*w_diff(r,theta,phi,n);
-            GeoAc_Sources.dv[3] += R_lt[n]*v_diff(r,theta,phi,n);
-            GeoAc_Sources.du[3] += R_lt[n]*u_diff(r,theta,phi,n);
+            src.dc[3] += R_lt[n]*c_diff(r,theta,phi,n);
+            src.dw[3] += R_lt[n]*w_diff(r,theta,phi,n);
+            src.dv[3] += R_lt[n]*v_diff(r,theta,phi,n);
+            src.du[3] += R_lt[n]*u_diff(r,theta,phi,n);
             
-            GeoAc_Sources.dc[4] += R_lp[n]*c_diff(r,theta,phi,n);
-            GeoAc_Sources.dw[4] += R_lp[n]*w_diff(r,theta,phi,n);
-            GeoAc_Sources.dv[4] += R_lp[n]*v_diff(r,theta,phi,n);
-            GeoAc_Sources.du[4] += R_lp[n]*u_diff(r,theta,phi,n);
+            src.dc[4] += R_lp[n]*c_diff(r,theta,phi,n);
+            src.dw[4] += R_lp[n]*w_diff(r,theta,phi,n);
+            src.dv[4] += R_lp[n]*v_diff(r,theta,phi,n);
+            src.du[4] += R_lp[n]*u_diff(r,theta,phi,n);
             
             for(int m = 0; m < 3; m++){
-                GeoAc_Sources.ddc[m][0] += R_lt[n]*c_ddiff(r, theta, phi, m, n);
-                GeoAc_Sources.ddw[m][0] += R_lt[n]*w_ddiff(r, theta, phi, m, n);
-                GeoAc_Sources.ddv[m][0] += R_lt[n]*v_ddiff(r, theta, phi, m, n);
-                GeoAc_Sources.ddu[m][0] += R_lt[n]*u_ddiff(r, theta, phi, m, n);
-
-                GeoAc_Sources.ddc[m][1] += R_lp[n]*c_ddiff(r, theta, phi, m, n);
-                GeoAc_Sources.ddw[m][1] += R_lp[n]*w_ddiff(r, theta, phi, m, n);
-                GeoAc_Sources.ddv[m][1] += R_lp[n]*v_ddiff(r, theta, phi, m, n);
-                GeoAc_Sources.ddu[m][1] += R_lp[n]*u_ddiff(r, theta, phi, m, n);
+                src.ddc[m][0] += R_lt[n]*c_ddiff(r, theta, phi, m, n);
+                src.ddw[m][0] += R_lt[n]*w_ddiff(r, theta, phi, m, n);
+                src.ddv[m][0] += R_lt[n]*v_ddiff(r, theta, phi, m, n);
+                src.ddu[m][0] += R_lt[n]*u_ddiff(r, theta, phi, m, n);
+
+                src.ddc[m][1] += R_lp[n]*c_ddiff(r, theta, phi, m, n);
+                src.ddw[m][1] += R_lp[n]*w_ddiff(r, theta, phi, m, n);
+                src.ddv[m][1] += R_lp[n]*v_ddiff(r, theta, phi, m, n);
+                src.ddu[m][1] += R_lp[n]*u_ddiff(r, theta, phi, m, n);
             }
         }
         
         // Update lt and lp derivatives of eikonal vector magnitude
-		GeoAc_Sources.dnu_mag[0] = (nu[0]*mu_lt[0] + nu[1]*mu_lt[1] + nu[2]*mu_lt[2])/GeoAc_Sources.nu_mag;
-		GeoAc_Sources.dnu_mag[1] = (nu[0]*mu_lp[0] + nu[1]*mu_lp[1] + nu[2]*mu_lp[2])/GeoAc_Sources.nu_mag;
+		src.dnu_mag[0] = (nu[0]*mu_lt[0] + nu[1]*mu_lt[1] + nu[2]*mu_lt[2])/src.nu_mag;
+		src.dnu_mag[1] = (nu[0]*mu_lp[0] + nu[1]*mu_lp[1] + nu[2]*mu_lp[2])/src.nu_mag;
         
 
 		// Update lt and lp derivatives of group velocity
-        GeoAc_Sources.dc_gr[0][0] = nu[0]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[3] + GeoAc_Sources.c*mu_lt[0]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[0]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[0] + GeoAc_Sources.dw[3];
-        GeoAc_Sources.dc_gr[1][0] = nu[1]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[3] + GeoAc_Sources.c*mu_lt[1]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[1]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[0] + GeoAc_Sources.dv[3];
-        GeoAc_Sources.dc_gr[2][0] = nu[2]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[3] + GeoAc_Sources.c*mu_lt[2]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[2]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[0] + GeoAc_Sources.du[3];
+        src.dc_gr[0][0] = nu[0]/src.nu_mag*src.dc[3] + src.c*mu_lt[0]/src.nu_mag - src.c*nu[0]/pow(src.nu_mag,2) * src.dnu_mag[0] + src.dw[3];
+        src.dc_gr[1][0] = nu[1]/src.nu_mag*src.dc[3] + src.c*mu_lt[1]/src.nu_mag - src.c*nu[1]/pow(src.nu_mag,2) * src.dnu_mag[0] + src.dv[3];
+        src.dc_gr[2][0] = nu[2]/src.nu_mag*src.dc[3] + src.c*mu_lt[2]/src.nu_mag - src.c*nu[2]/pow(src.nu_mag,2) * src.dnu_mag[0] + src.du[3];
         
-        GeoAc_Sources.dc_gr[0][1] = nu[0]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[4] + GeoAc_Sources.c*mu_lp[0]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[0]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[1] + GeoAc_Sources.dw[4];
-        GeoAc_Sources.dc_gr[1][1] = nu[1]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[4] + GeoAc_Sources.c*mu_lp[1]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[1]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[1] + GeoAc_Sources.dv[4];
-        GeoAc_Sources.dc_gr[2][1] = nu[2]/GeoAc_Sources.nu_mag*GeoAc_Sources.dc[4] + GeoAc_Sources.c*mu_lp[2]/GeoAc_Sources.nu_mag - GeoAc_Sources.c*nu[2]/pow(GeoAc_Sources.nu_mag,2) * GeoAc_Sources.dnu_mag[1] + GeoAc_Sources.du[4];
+        src.dc_gr[0][1] = nu[0]/src.nu_mag*src.dc[4] + src.c*mu_lp[0]/src.nu_mag - src.c*nu[0]/pow(src.nu_mag,2) * src.dnu_mag[1] + src.dw[4];
+        src.dc_gr[1][1] = nu[1]/src.nu_mag*src.dc[4] + src.c*mu_lp[1]/src.nu_mag - src.c*nu[1]/pow(src.nu_mag,2) * src.dnu_mag[1] + src.dv[4];
+        src.dc_gr[2][1] = nu[2]/src.nu_mag*src.dc[4] + src.c*mu_lp[2]/src.nu_mag - src.c*nu[2]/pow(src.nu_mag,2) * src.dnu_mag[1] + src.du[4];
 
-        GeoAc_Sources.dc_gr_mag[0] = (GeoAc_Sources.c_gr[0]*GeoAc_Sources.dc_gr[0][0] + GeoAc_Sources.c_gr[1]*GeoAc_Sources.dc_gr[1][0] + GeoAc_Sources.c_gr[2]*GeoAc_Sources.dc_gr[2][0])/GeoAc_Sources.c_gr_mag;
-        GeoAc_Sources.dc_gr_mag[1] = (GeoAc_Sources.c_gr[0]*GeoAc_Sources.dc_gr[0][1] + GeoAc_Sources.c_gr[1]*GeoAc_Sources.dc_gr[1][1] + GeoAc_Sources.c_gr[2]*GeoAc_Sources.dc_gr[2][1])/GeoAc_Sources.c_gr_mag;
+        src.dc_gr_mag[0] = (src.c_gr[0]*src.dc_gr[0][0] + src.c_gr[1]*src.dc_gr[1][0] + src.c_gr[2]*src.dc_gr[2][0])/src.c_gr_mag;
+        src.dc_gr_mag[1] = (src.c_gr[0]*src.dc_gr[0][1] + src.c_gr[1]*src.dc_gr[1][1] + src.c_gr[2]*src.dc_gr[2][1])/src.c_gr_mag;
 
-        GeoAc_Sources.d_GeoCoeff[0][0] = 0.0;
-        GeoAc_Sources.d_GeoCoeff[1][0] = -R_lt[0]/(pow(r,2));
-        GeoAc_Sources.d_GeoCoeff[2][0] = -R_lt[0]/(pow(r,2)*cos(theta)) + sin(theta)/(r*pow(cos(theta),2))*R_lt[1];
+        src.d_GeoCoeff[0][0] = 0.0;
+        src.d_GeoCoeff[1][0] = -R_lt[0]/(pow(r,2));
+        src.d_GeoCoeff[2][0] = -R_lt[0]/(pow(r,2)*cos(theta)) + sin(theta)/(r*pow(cos(theta),2))*R_lt[1];
  
-        GeoAc_Sources.d_GeoCoeff[0][1] = 0.0;
-        GeoAc_Sources.d_GeoCoeff[1][1] = -R_lp[0]/(pow(r,2));
-        GeoAc_Sources.d_GeoCoeff[2][1] = -R_lp[0]/(pow(r,2)*cos(theta)) + sin(theta)/(r*pow(cos(theta),2))*R_lp[1];
+        src.d_GeoCoeff[0][1] = 0.0;
+        src.d_GeoCoeff[1][1] = -R_lp[0]/(pow(r,2));
+        src.d_GeoCoeff[2][1] = -R_lp[0]/(pow(r,2)*cos(theta)) + sin(theta)/(r*pow(cos(theta),2))*R_lp[1];
         
-        GeoAc_Sources.d_GeoTerms[0][0] = 0.0;
-        GeoAc_Sources.d_GeoTerms[1][0] = (mu_lt[0]*GeoAc_Sources.v + nu[0]*GeoAc_Sources.dv[3] - mu_lt[1]*GeoAc_Sources.w - nu[1] * GeoAc_Sources.dw[3]);
-        GeoAc_Sources.d_GeoTerms[2][0] = (mu_lt[0]*GeoAc_Sources.u + nu[0]*GeoAc_Sources.du[3] - mu_lt[2]*GeoAc_Sources.w - nu[2] * GeoAc_Sources.dw[3])*cos(theta) - (nu[0]*GeoAc_Sources.u - nu[2]*GeoAc_Sources.w)*R_lt[1]*sin(theta)
-                                            + (mu_lt[1]*GeoAc_Sources.u + nu[1]*GeoAc_Sources.du[3] - mu_lt[2]*GeoAc_Sources.v - nu[2] * GeoAc_Sources.dv[3])*sin(theta) + (nu[1]*GeoAc_Sources.u - nu[2]*GeoAc_Sources.v)*R_lt[1]*cos(theta);
+        src.d_GeoTerms[0][0] = 0.0;
+        src.d_GeoTerms[1][0] = (mu_lt[0]*src.v + nu[0]*src.dv[3] - mu_lt[1]*src.w - nu[1] * src.dw[3]);
+        src.d_GeoTerms[2][0] = (mu_lt[0]*src.u + nu[0]*src.du[3] - mu_lt[2]*src.w - nu[2] * src.dw[3])*cos(theta) - (nu[0]*src.u - nu[2]*src.w)*R_lt[1]*sin(theta)
+                                            + (mu_lt[1]*src.u + nu[1]*src.du[3] - mu_lt[2]*src.v - nu[2] * src.dv[3])*sin(theta) + (nu[1]*src.u - nu[2]*src.v)*R_lt[1]*cos(theta);
         
-        GeoAc_Sources.d_GeoTerms[0][0] += -R_lt[0]/pow(r,2)*(nu[1]*GeoAc_Sources.c_gr[1] + nu[2]*GeoAc_Sources.c_gr[2])
-                                            + 1.0/r*(mu_lt[1]*GeoAc_Sources.c_gr[1] + nu[1]*GeoAc_Sources.dc_gr[1][0] + mu_lt[2]*GeoAc_Sources.c_gr[2] + nu[2]*GeoAc_Sources.dc_gr[2][0]);
-        GeoAc_Sources.d_GeoTerms[1][0] += -mu_lt[0]*GeoAc_Sources.c_gr[1] - nu[0]*GeoAc_Sources.dc_gr[1][0] + mu_lt[2]*GeoAc_Sources.c_gr[2]*tan(theta) + nu[2]*GeoAc_Sources.dc_gr[2][0]*tan(theta) + nu[2]*GeoAc_Sources.c_gr[2]*R_lt[1]/pow(cos(theta),2);
-        GeoAc_Sources.d_GeoTerms[2][0] += -GeoAc_Sources.dc_gr[2][0]*(nu[0]*cos(theta) + nu[1]*sin(theta)) - GeoAc_Sources.c_gr[2]*(mu_lt[0]*cos(theta) - nu[0]*R_lt[1]*sin(theta) + mu_lt[1]*sin(theta) + nu[1]*R_lt[1]*cos(theta));
+        src.d_GeoTerms[0][0] += -R_lt[0]/pow(r,2)*(nu[1]*src.c_gr[1] + nu[2]*src.c_gr[2])
+                                            + 1.0/r*(mu_lt[1]*src.c_gr[1] + nu[1]*src.dc_gr[1][0] + mu_lt[2]*src.c_gr[2] + nu[2]*src.dc_gr[2][0]);
+        src.d_GeoTerms[1][0] += -mu_lt[0]*src.c_gr[1] - nu[0]*src.dc_gr[1][0] + mu_lt[2]*src.c_gr[2]*tan(theta) + nu[2]*src.dc_gr[2][0]*tan(theta) + nu[2]*src.c_gr[2]*R_lt[1]/pow(cos(theta),2);
+        src.d_GeoTerms[2][0] += -src.dc_gr[2][0]*(nu[0]*cos(theta) + nu[1]*sin(theta)) - src.c_gr[2]*(mu_lt[0]*cos(theta) - nu[0]*R_lt[1]*sin(theta) + mu_lt[1]*sin(theta) + nu[1]*R_lt[1]*cos(theta));
         
-        GeoAc_Sources.d_GeoTerms[0][1] = 0.0;
-        GeoAc_Sources.d_GeoTerms[1][1] = (mu_lp[0]*GeoAc_Sources.v + nu[0]*GeoAc_Sources.dv[4] - mu_lp[1]*GeoAc_Sources.w - nu[1] * GeoAc_Sources.dw[4]);
-        GeoAc_Sources.d_GeoTerms[2][1] = (mu_lp[0]*GeoAc_Sources.u + nu[0]*GeoAc_Sources.du[4] - mu_lp[2]*GeoAc_Sources.w - nu[2] * GeoAc_Sources.dw[4])*cos(theta) - (nu[0]*GeoAc_Sources.u - nu[2]*GeoAc_Sources.w)*R_lp[1]*sin(theta)
-                                            + (mu_lp[1]*GeoAc_Sources.u + nu[1]*GeoAc_Sources.du[4] - mu_lp[2]*GeoAc_Sources.v - nu[2] * GeoAc_Sources.dv[4])*sin(theta) + (nu[1]*GeoAc_Sources.u - nu[2]*GeoAc_Sources.v)*R_lp[1]*cos(theta);
+        src.d_GeoTerms[0][1] = 0.0;
+        src.d_GeoTerms[1][1] = (mu_lp[0]*src.v + nu[0]*src.dv[4] - mu_lp[1]*src.w - nu[1] * src.dw[4]);
+        src.d_GeoTerms[2][1] = (mu_lp[0]*src.u + nu[0]*src.du[4] - mu_lp[2]*src.w - nu[2] * src.dw[4])*cos(theta) - (nu[0]*src.u - nu[2]*src.w)*R_lp[1]*sin(theta)
+                                            + (mu_lp[1]*src.u + nu[1]*src.du[4] - mu_lp[2]*src.v - nu[2] * src.dv[4])*sin(theta) + (nu[1]*src.u - nu[2]*src.v)*R_lp[1]*cos(theta);
         
-        GeoAc_Sources.d_GeoTerms[0][1] += -R_lp[0]/pow(r,2)*(nu[1]*GeoAc_Sources.c_gr[1] + nu[2]*GeoAc_Sources.c_gr[2])
-                                            + 1.0/r*(mu_lp[1]*GeoAc_Sources.c_gr[1] + nu[1]*GeoAc_Sources.dc_gr[1][1] + mu_lp[2]*GeoAc_Sources.c_gr[2] + nu[2]*GeoAc_Sources.dc_gr[2][1]);
-        GeoAc_Sources.d_GeoTerms[1][1] += -mu_lp[0]*GeoAc_Sources.c_gr[1] - nu[0]*GeoAc_Sources.dc_gr[1][1] + mu_lp[2]*GeoAc_Sources.c_gr[2]*tan(theta) + nu[2]*GeoAc_Sources.dc_gr[2][1]*tan(theta) + nu[2]*GeoAc_Sources.c_gr[2]*R_lp[1]/pow(cos(theta),2);
-        GeoAc_Sources.d_GeoTerms[2][1] += -GeoAc_Sources.dc_gr[2][1]*(nu[0]*cos(theta) + nu[1]*sin(theta)) - GeoAc_Sources.c_gr[2]*(mu_lp[0]*cos(theta) - nu[0]*R_lp[1]*sin(theta) + mu_lp[1]*sin(theta) + nu[1]*R_lp[1]*cos(theta));
+        src.d_GeoTerms[0][1] += -R_lp[0]/pow(r,2)*(nu[1]*src.c_gr[1] + nu[2]*src.c_gr[2])
+                                            + 1.0/r*(mu_lp[1]*src.c_gr[1] + nu[1]*src.dc_gr[1][1] + mu_lp[2]*src.c_gr[2] + nu[2]*src.dc_gr[2][1]);
+        src.d_GeoTerms[1][1] += -mu_lp[0]*src.c_gr[1] - nu[0]*src.dc_gr[1][1] + mu_lp[2]*src.c_gr[2]*tan(theta) + nu[2]*src.dc_gr[2][1]*tan(theta) + nu[2]*src.c_gr[2]*R_lp[1]/pow(cos(theta),2);
+        src.d_GeoTerms[2][1] += -src.dc_gr[2][1]*(nu[0]*cos(theta) + nu[1]*sin(theta)) - src.c_gr[2]*(mu_lp[0]*cos(theta) - nu[0]*R_lp[1]*sin(theta) + mu_lp[1]*sin(theta) + nu[1]*R_lp[1]*cos(theta));
 
     }
 }
 //-----------------------------------------------------------//
 //-------Evaluate the Source Equation For Specific Index-----//
 //-----------------------------------------------------------//
-double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number){
+double GeoAc_EvalSrcEq(GeoAcContext & ctx, double ray_length, double* current_values, int Eq_Number){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double result;
     
 	// Set variables used in all equations
@@ -383,36 +393,36 @@ double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number)
 		case(0):	// d r / d s
         case(1):    // d theta / d s
         case(2):    // d phi / d s
-			result = GeoAc_Sources.GeoCoeff[Eq_Number]*GeoAc_Sources.c_gr[Eq_Number]/GeoAc_Sources.c_gr_mag;
+			result = src.GeoCoeff[Eq_Number]*src.c_gr[Eq_Number]/src.c_gr_mag;
 			break;
             
 		case(3): 	// d nu_r /ds
 		case(4): 	// d nu_theta / ds
 		case(5): 	// d nu_phi / ds
-			result = -GeoAc_Sources.GeoCoeff[Eq_Number-3]/GeoAc_Sources.c_gr_mag*(GeoAc_Sources.nu_mag*GeoAc_Sources.dc[Eq_Number-3]
-                        + nu[0]*GeoAc_Sources.dw[Eq_Number-3] + nu[1]*GeoAc_Sources.dv[Eq_Number-3] + nu[2]*GeoAc_Sources.du[Eq_Number-3] + GeoAc_Sources.GeoTerms[Eq_Number-3]);
+			result = -src.GeoCoeff[Eq_Number-3]/src.c_gr_mag*(src.nu_mag*src.dc[Eq_Number-3]
+                        + nu[0]*src.dw[Eq_Number-3] + nu[1]*src.dv[Eq_Number-3] + nu[2]*src.du[Eq_Number-3] + src.GeoTerms[Eq_Number-3]);
 			break;
             
             
 		case(6):	// d R_lt/ds
         case(7):	// d Theta_lt/ds
         case(8): 	// d Phi_lt/ds
-			result = GeoAc_Sources.d_GeoCoeff[Eq_Number-6][0]*GeoAc_Sources.c_gr[Eq_Number-6]/GeoAc_Sources.c_gr_mag
-                         + GeoAc_Sources.GeoCoeff[Eq_Number-6]*GeoAc_Sources.dc_gr[Eq_Number-6][0]/GeoAc_Sources.c_gr_mag
-                            - GeoAc_Sources.GeoCoeff[Eq_Number-6]*GeoAc_Sources.c_gr[Eq_Number-6]/pow(GeoAc_Sources.c_gr_mag,2) * GeoAc_Sources.dc_gr_mag[0];
+			result = src.d_GeoCoeff[Eq_Number-6][0]*src.c_gr[Eq_Number-6]/src.c_gr_mag
+                         + src.GeoCoeff[Eq_Number-6]*src.dc_gr[Eq_Number-6][0]/src.c_gr_mag
+                            - src.GeoCoeff[Eq_Number-6]*src.c_gr[Eq_Number-6]/pow(src.c_gr_mag,2) * src.dc_gr_mag[0];
 			break;
             
             
 		case(9): 	// d mu_r_lt /ds
 		case(10): 	// d mu_theta_lt /ds
 		case(11): 	// d mu_phi_lt /ds
-			result = -GeoAc_Sources.d_GeoCoeff[Eq_Number-9][0]/GeoAc_Sources.c_gr_mag*(GeoAc_Sources.nu_mag*GeoAc_Sources.dc[Eq_Number-9]
-                            + nu[0]*GeoAc_Sources.dw[Eq_Number-9] + nu[1]*GeoAc_Sources.dv[Eq_Number-9] + nu[2]*GeoAc_Sources.du[Eq_Number-9] + GeoAc_Sources.GeoTerms[Eq_Number-9])
-                    + GeoAc_Sources.GeoCoeff[Eq_Number-9]/pow(GeoAc_Sources.c_gr_mag,2) * GeoAc_Sources.dc_gr_mag[0]*(GeoAc_Sources.nu_mag*GeoAc_Sources.dc[Eq_Number-9]
-                            + nu[0]*GeoAc_Sources.dw[Eq_Number-9] + nu[1]*GeoAc_Sources.dv[Eq_Number-9] + nu[2]*GeoAc_Sources.du[Eq_Number-9])
-                    - GeoAc_Sources.GeoCoeff[Eq_Number-9]/GeoAc_Sources.c_gr_mag*(GeoAc_Sources.dnu_mag[0]*GeoAc_Sources.dc[Eq_Number-9] + GeoAc_Sources.nu_mag*GeoAc_Sources.ddc[Eq_Number-9][0]
-                            + mu_lt[0]*GeoAc_Sources.dw[Eq_Number-9] + mu_lt[1]*GeoAc_Sources.dv[Eq_Number-9] + mu_lt[2]*GeoAc_Sources.du[Eq_Number-9]
-                                + nu[0]*GeoAc_Sources.ddw[Eq_Number-9][0] + nu[1]*GeoAc_Sources.ddv[Eq_Number-9][0] + nu[2]*GeoAc_Sources.ddu[Eq_Number-9][0] + GeoAc_Sources.d_GeoTerms[Eq_Number-9][0]);
+			result = -src.d_GeoCoeff[Eq_Number-9][0]/src.c_gr_mag*(src.nu_mag*src.dc[Eq_Number-9]
+                            + nu[0]*src.dw[Eq_Number-9] + nu[1]*src.dv[Eq_Number-9] + nu[2]*src.du[Eq_Number-9] + src.GeoTerms[Eq_Number-9])
+                    + src.GeoCoeff[Eq_Number-9]/pow(src.c_gr_mag,2) * src.dc_gr_mag[0]*(src.nu_mag*src.dc[Eq_Number-9]
+                            + nu[0]*src.dw[Eq_Number-9] + nu[1]*src.dv[Eq_Number-9] + nu[2]*src.du[Eq_Number-9])
+                    - src.GeoCoeff[Eq_Number-9]/src.c_gr_mag*(src.dnu_mag[0]*src.dc[Eq_Number-9] + src.nu_mag*src.ddc[Eq_Number-9][0]
+                            + mu_lt[0]*src.dw[Eq_Number-9] + mu_lt[1]*src.dv[Eq_Number-9] + mu_lt[2]*src.du[Eq_Number-9]
+                                + nu[0]*src.ddw[Eq_Number-9][0] + nu[1]*src.ddv[Eq_Number-9][0] + nu[2]*src.ddu[Eq_Number-9][0] + src.d_GeoTerms[Eq_Number-9][0]);
             
 			break;
             
@@ -420,21 +430,21 @@ double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number)
 		case(12):  	// dR_lp/ds
 		case(13):  	// dTheta_lp/ds
         case(14):	// dPhi_lp/ds
-			result = GeoAc_Sources.d_GeoCoeff[Eq_Number-12][1]*GeoAc_Sources.c_gr[Eq_Number-12]/GeoAc_Sources.c_gr_mag
-                        + GeoAc_Sources.GeoCoeff[Eq_Number-12]*GeoAc_Sources.dc_gr[Eq_Number-12][1]/GeoAc_Sources.c_gr_mag
-                            - GeoAc_Sources.GeoCoeff[Eq_Number-12]*GeoAc_Sources.c_gr[Eq_Number-12]/pow(GeoAc_Sources.c_gr_mag,2) * GeoAc_Sources.dc_gr_mag[1];
+			result = src.d_GeoCoeff[Eq_Number-12][1]*src.c_gr[Eq_Number-12]/src.c_gr_mag
+                        + src.GeoCoeff[Eq_Number-12]*src.dc_gr[Eq_Number-12][1]/src.c_gr_mag
+                            - src.GeoCoeff[Eq_Number-12]*src.c_gr[Eq_Number-12]/pow(src.c_gr_mag,2) * src.dc_gr_mag[1];
 			break;
             
 		case(15): 	// d mu_r_lp/ds
 		case(16): 	// d mu_t_lp/ds
 		case(17): 	// d mu_p_lp/ds
-			result = -GeoAc_Sources.d_GeoCoeff[Eq_Number-15][1]/GeoAc_Sources.c_gr_mag*(GeoAc_Sources.nu_mag*GeoAc_Sources.dc[Eq_Number-15]
-                        + nu[0]*GeoAc_Sources.dw[Eq_Number-15] + nu[1]*GeoAc_Sources.dv[Eq_Number-15] + nu[2]*GeoAc_Sources.du[Eq_Number-15] + GeoAc_Sources.GeoTerms[Eq_Number-15])
-                    + GeoAc_Sources.GeoCoeff[Eq_Number-15]/pow(GeoAc_Sources.c_gr_mag,2) * GeoAc_Sources.dc_gr_mag[1]*(GeoAc_Sources.nu_mag*GeoAc_Sources.dc[Eq_Number-15]
-                        + nu[0]*GeoAc_Sources.dw[Eq_Number-15] + nu[1]*GeoAc_Sources.dv[Eq_Number-15] + nu[2]*GeoAc_Sources.du[Eq_Number-15])
-                    - GeoAc_Sources.GeoCoeff[Eq_Number-15]/GeoAc_Sources.c_gr_mag*(GeoAc_Sources.dnu_mag[1]*GeoAc_Sources.dc[Eq_Number-15] + GeoAc_Sources.nu_mag*GeoAc_Sources.ddc[Eq_Number-15][1]
-                        + mu_lp[0]*GeoAc_Sources.dw[Eq_Number-15] + mu_lp[1]*GeoAc_Sources.dv[Eq_Number-15] + mu_lp[2]*GeoAc_Sources.du[Eq_Number-15]
-                            + nu[0]*GeoAc_Sources.ddw[Eq_Number-15][1] + nu[1]*GeoAc_Sources.ddv[Eq_Number-15][1] + nu[2]*GeoAc_Sources.ddu[Eq_Number-15][1] + GeoAc_Sources.d_GeoTerms[Eq_Number-15][1]);
+			result = -src.d_GeoCoeff[Eq_Number-15][1]/src.c_gr_mag*(src.nu_mag*src.dc[Eq_Number-15]
+                        + nu[0]*src.dw[Eq_Number-15] + nu[1]*src.dv[Eq_Number-15] + nu[2]*src.du[Eq_Number-15] + src.GeoTerms[Eq_Number-15])
+                    + src.GeoCoeff[Eq_Number-15]/pow(src.c_gr_mag,2) * src.dc_gr_mag[1]*(src.nu_mag*src.dc[Eq_Number-15]
+                        + nu[0]*src.dw[Eq_Number-15] + nu[1]*src.dv[Eq_Number-15] + nu[2]*src.du[Eq_Number-15])
+                    - src.GeoCoeff[Eq_Number-15]/src.c_gr_mag*(src.dnu_mag[1]*src.dc[Eq_Number-15] + src.nu_mag*src.ddc[Eq_Number-15][1]
+                        + mu_lp[0]*src.dw[Eq_Number-15] + mu_lp[1]*src.dv[Eq_Number-15] + mu_lp[2]*src.du[Eq_Number-15]
+                            + nu[0]*src.ddw[Eq_Number-15][1] + nu[1]*src.ddv[Eq_Number-15][1] + nu[2]*src.ddu[Eq_Number-15][1] + src.d_GeoTerms[Eq_Number-15][1]);
 			break;
             
 	}
@@ -444,7 +454,7 @@ double GeoAc_EvalSrcEq(double ray_length, double* current_values, int Eq_Number)
 //-------------------------------------------------------------------//
 //-------Calculate the Hamiltonian (Eikonal) To Check For Errors-----//
 //-------------------------------------------------------------------//
-double GeoAc_EvalHamiltonian(double ray_length, double* current_values, double c0){
+double GeoAc_EvalHamiltonian(GeoAcContext & ctx, double ray_length, double* current_values, double c0){
 	double r = current_values[0],  theta = current_values[1], phi = current_values[2];
 	double nu[3] = {current_values[3], current_values[4], current_values[5]};
 	
@@ -452,15 +462,16 @@ double GeoAc_EvalHamiltonian(double ray_length, double* current_values, double c
                 + (w(r,theta,phi)*nu[0] + v(r,theta,phi)*nu[1] + u(r,theta,phi)*nu[2])/c(r, theta, phi);
 }
 
-double GeoAc_EvalHamiltonian(double** solution, int index){
+double GeoAc_EvalHamiltonian(GeoAcContext & ctx, double** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	double nu[3] = {solution[index][3], solution[index][4], solution[index][5]};
 	double r = solution[index][0],	theta = solution[index][1],	phi = solution[index][2];
-	double r0 = GeoAc_Sources.src_loc[0], 	theta0 = GeoAc_Sources.src_loc[1], 	phi0 = GeoAc_Sources.src_loc[2];
+	double r0 = src.src_loc[0], 	theta0 = src.src_loc[1], 	phi0 = src.src_loc[2];
     
 	return sqrt(nu[0]*nu[0] + nu[1]*nu[1] + nu[2]*nu[2]) - c(r0,theta0,phi0)/c(r,theta,phi) + (w(r,theta,phi)*nu[0] + v(r,theta,phi)*nu[1] + u(r,theta,phi)*nu[2])/c(r, theta, phi);
 }
 
-double GeoAc_EvalHamiltonian_Deriv(double** solution, int index){
+double GeoAc_EvalHamiltonian_Deriv(GeoAcContext & ctx, double** solution, int index){
 	double  r = solution[index][0],
             theta = solution[index][1],
             phi = solution[index][2],
@@ -497,13 +508,14 @@ double GeoAc_EvalHamiltonian_Deriv(double** solution, int index){
 //--------------------------------------------------------------------------//
 //-------Check if ray has left propagation region or returned to ground-----//
 //--------------------------------------------------------------------------//
-bool GeoAc_BreakCheck(double ** solution, int index){
+bool GeoAc_BreakCheck(GeoAcContext & ctx, double ** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
 	bool check = false;
 
 	double alt      = solution[index][0];
 
-    double GC_Dist1 = pow(sin((solution[index][1] - GeoAc_Sources.src_loc[1])/2.0),2);
-    double GC_Dist2 = cos(GeoAc_Sources.src_loc[1]) * cos(solution[index][1]) * pow(sin((solution[index][2] - GeoAc_Sources.src_loc[2])/2.0),2);
+    double GC_Dist1 = pow(sin((solution[index][1] - src.src_loc[1])/2.0),2);
+    double GC_Dist2 = cos(src.src_loc[1]) * cos(solution[index][1]) * pow(sin((solution[index][2] - src.src_loc[2])/2.0),2);
     double range = 2.0 * r_earth * asin(sqrt(GC_Dist1 + GC_Dist2));
  
     if(alt > GeoAc_vert_limit)      check = true;
@@ -524,7 +536,7 @@ bool GeoAc_GroundCheck(double ** solution, int index){
 //----------------------------------------------------------------------------------//
 //-------Calculate the travel time from source to location or between locations-----//
 //----------------------------------------------------------------------------------//
-double GeoAc_TravelTime(double ** solution, int index){
+double GeoAc_TravelTime(GeoAcContext & ctx, double ** solution, int index){
     double dr, dt, dp, ds, r, t, p, nu[3], nu_mag, c_prop[3], c_prop_mag;
 	double traveltime = 0.0;
 	
@@ -558,7 +570,7 @@ double GeoAc_TravelTime(double ** solution, int index){
 }
 
 
-void GeoAc_TravelTimeSegment(double & time, double ** solution, int start, int end){
+void GeoAc_TravelTimeSegment(GeoAcContext & ctx, double & time, double ** solution, int start, int end){
     double dr, dt, dp, ds, r, t, p, nu[3], nu_mag, c_prop[3], c_prop_mag;
     
 	for (int n = start; n < end; n++){
@@ -590,7 +602,7 @@ void GeoAc_TravelTimeSegment(double & time, double ** solution, int start, int e
 //-----------------------------------------------------------------------------------//
 //-------Calculate the Jacobian determinant and from it the ampltude coefficient-----//
 //-----------------------------------------------------------------------------------//
-double GeoAc_Jacobian(double ** solution, int index){
+double GeoAc_Jacobian(GeoAcContext & ctx, double ** solution, int index){
 	double r = solution[index][0], theta = solution[index][1], phi = solution[index][2];
     
 	double nu[3] = 		{solution[index][3], solution[index][4], solution[index][5]};
@@ -606,22 +618,23 @@ double GeoAc_Jacobian(double ** solution, int index){
 }
 
 
-double GeoAc_Amplitude(double ** solution, int index){
-    double r0 = GeoAc_Sources.src_loc[0], theta0 = GeoAc_Sources.src_loc[1], phi0 = GeoAc_Sources.src_loc[2];
+double GeoAc_Amplitude(GeoAcContext & ctx, double ** solution, int index){
+    struct GeoAc_Sources_Struct & src = *ctx.Sources;
+    double r0 = src.src_loc[0], theta0 = src.src_loc[1], phi0 = src.src_loc[2];
 	double r = solution[index][0], theta = solution[index][1], phi = solution[index][2];
 	double nu[3] = {solution[index][3], solution[index][4], solution[index][5]};
-    double nu0[3] = {sin(GeoAc_theta),  cos(GeoAc_theta)*sin(GeoAc_phi),    cos(GeoAc_theta)*cos(GeoAc_phi)};
+    double nu0[3] = {sin(ctx.theta),  cos(ctx.theta)*sin(ctx.phi),    cos(ctx.theta)*cos(ctx.phi)};
     
-    double  nu_mag = (GeoAc_Sources.c0 - nu[0]*w(r,theta,phi) - nu[1]*v(r,theta,phi) - nu[2]*u(r,theta,phi))/c(r,theta,phi),
-            nu_mag0 = GeoAc_Sources.nu0,
+    double  nu_mag = (src.c0 - nu[0]*w(r,theta,phi) - nu[1]*v(r,theta,phi) - nu[2]*u(r,theta,phi))/c(r,theta,phi),
+            nu_mag0 = src.nu0,
             c_prop[3] =  {c(r,theta,phi)*nu[0]/nu_mag + w(r,theta,phi),			c(r,theta,phi)*nu[1]/nu_mag + v(r,theta,phi), 			c(r,theta,phi)*nu[2]/nu_mag + u(r, theta, phi)},
-            c_prop0[3] = {GeoAc_Sources.c0*nu0[0]/nu_mag0 + w(r0,theta0,phi0),	GeoAc_Sources.c0*nu0[1]/nu_mag + v(r0,theta0,phi0),		GeoAc_Sources.c0*nu0[2]/nu_mag + u(r0, theta0, phi0)};
+            c_prop0[3] = {src.c0*nu0[0]/nu_mag0 + w(r0,theta0,phi0),	src.c0*nu0[1]/nu_mag + v(r0,theta0,phi0),		src.c0*nu0[2]/nu_mag + u(r0, theta0, phi0)};
     
 	double  c_prop_mag =  sqrt(pow(c_prop[0],2) +  pow(c_prop[1],2) +  pow(c_prop[2],2)),
             c_prop_mag0 = sqrt(pow(c_prop0[0],2) + pow(c_prop0[1],2) + pow(c_prop0[2],2));
 	
-	double D = GeoAc_Jacobian(solution, index);	
-	double Amp_Num = rho(r,theta,phi) *  nu_mag * pow(c(r,theta,phi),3)  *  c_prop_mag0 * cos(GeoAc_theta);
+	double D = GeoAc_Jacobian(ctx, solution, index);	
+	double Amp_Num = rho(r,theta,phi) *  nu_mag * pow(c(r,theta,phi),3)  *  c_prop_mag0 * cos(ctx.theta);
 	double Amp_Den = rho(r0,theta0,phi0)*nu_mag0* pow(c(r0,theta0,phi0),3)* c_prop_mag  * D;
     
 	return 1.0/(4.0*Pi)*sqrt(fabs(Amp_Num/Amp_Den));	
@@ -630,7 +643,7 @@ double GeoAc_Amplitude(double ** solution, int index){
 //--------------------------------------------------------------------------//
 //------Integrate the Sutherland Bass Attenuation Through the Ray Path------//
 //--------------------------------------------------------------------------//
-double GeoAc_SB_Atten(double ** solution, int end, double freq){
+double GeoAc_SB_Atten(GeoAcContext & ctx, double ** solution, int end, double freq){
 	double dr, dt, dp, ds, r, t, p;
     double atten = 0.0;
 	for (int n = 0; n < end; n++){
@@ -650,7 +663,7 @@ double GeoAc_SB_Atten(double ** solution, int end, double freq){
     return atten;
 }
 
-void GeoAc_SB_AttenSegment(double & atten, double ** solution, int start, int end, double freq){
+void GeoAc_SB_AttenSegment(GeoAcContext & ctx, double & atten, double ** solution, int start, int end, double freq){
 	double dr, dt, dp, ds, r, t, p;
 	for (int n = start; n < end; n++){
 		
@@ -672,11 +685,11 @@ void GeoAc_SB_AttenSegment(double & atten, double ** solution, int start, int en
 //---------Count the caustics encountered by monitoring---------//
 //----how many times the Jacobian determinant changes sign------//
 //--------------------------------------------------------------//
-int GeoAc_CausticCnt(double ** solution, int start, int end){
+int GeoAc_CausticCnt(GeoAcContext & ctx, double ** solution, int start, int end){
 	int count = 0;
-	double current, prev = GeoAc_Jacobian(solution, 1);
+	double current, prev = GeoAc_Jacobian(ctx, solution, 1);
 	for(int n = start; n < end; n++){
-		current = GeoAc_Jacobian(solution,n);
+		current = GeoAc_Jacobian(ctx, solution,n);
 		if(current*prev < 0.0){
 			count++;
 		}
@@ -21,20 +21,20 @@ using namespace std;
 //--------------------------------------//
 //----Functions To Set Up The Solver----//
 //--------------------------------------//
-void GeoAc_SetEqCnt(){
-	switch(GeoAc_dim){
+void GeoAc_SetEqCnt(GeoAcContext & ctx){
+	switch(ctx.dim){
 		case(2):
-			if(GeoAc_CalcAmp && GeoAc_AtmoStrat){               GeoAc_EqCnt = 6;}	// 2D propagation solving for rays and amplitude in stratified atmosphere
-            else if(!(GeoAc_CalcAmp) && GeoAc_AtmoStrat){       GeoAc_EqCnt = 3;}	// 2D propagation solving for rays only in stratified atmosphere
-            else if(GeoAc_CalcAmp && !(GeoAc_AtmoStrat)){       GeoAc_EqCnt = 8;}   // 2D propagation solving for rays and amplitude in horizontally varying atmosphere
-            else if(!(GeoAc_CalcAmp) && !(GeoAc_AtmoStrat)){    GeoAc_EqCnt = 4;} 	// 2D propagation solving for rays only in horizontally varying atmosphere
+			if(ctx.CalcAmp && ctx.AtmoStrat){               ctx.EqCnt = 6;}	// 2D propagation solving for rays and amplitude in stratified atmosphere
+            else if(!(ctx.CalcAmp) && ctx.AtmoStrat){       ctx.EqCnt = 3;}	// 2D propagation solving for rays only in stratified atmosphere
+            else if(ctx.CalcAmp && !(ctx.AtmoStrat)){       ctx.EqCnt = 8;}   // 2D propagation solving for rays and amplitude in horizontally varying atmosphere
+            else if(!(ctx.CalcAmp) && !(ctx.AtmoStrat)){    ctx.EqCnt = 4;} 	// 2D propagation solving for rays only in horizontally varying atmosphere
 			break;
             
 		case(3):
-			if(GeoAc_CalcAmp && GeoAc_AtmoStrat){               GeoAc_EqCnt = 12;}	// 3D propagation solving for rays and amplitude in stratified atmosphere
-            else if(!(GeoAc_CalcAmp) && GeoAc_AtmoStrat){		GeoAc_EqCnt = 4;}   // 3D propagation solving for rays only in stratified atmosphere
-            else if(GeoAc_CalcAmp && !(GeoAc_AtmoStrat)){		GeoAc_EqCnt = 18;}  // 3D propagation solving for rays and amplitude in horizontally varying atmosphere
-			else if(!(GeoAc_CalcAmp) && !(GeoAc_AtmoStrat)){    GeoAc_EqCnt = 6;}   // 3D propagation solving for rays only in horizontally varying atmosphere
+			if(ctx.CalcAmp && ctx.AtmoStrat){               ctx.EqCnt = 12;}	// 3D propagation solving for rays and amplitude in stratified atmosphere
+            else if(!(ctx.CalcAmp) && ctx.AtmoStrat){		ctx.EqCnt = 4;}   // 3D propagation solving for rays only in stratified atmosphere
+            else if(ctx.CalcAmp && !(ctx.AtmoStrat)){		ctx.EqCnt = 18;}  // 3D propagation solving for rays and amplitude in horizontally varying atmosphere
+			else if(!(ctx.CalcAmp) && !(ctx.AtmoStrat)){    ctx.EqCnt = 6;}   // 3D propagation solving for rays only in horizontally varying atmosphere
 			break;
 
 		default:
@@ -43,26 +43,26 @@ void GeoAc_SetEqCnt(){
 	}
 }
 
-void GeoAc_ConfigureCalcAmp(bool calc_amp){
-	GeoAc_CalcAmp = calc_amp;
-    GeoAc_SetSystem();    
-	GeoAc_SetEqCnt();
+void GeoAc_ConfigureCalcAmp(GeoAcContext & ctx, bool calc_amp){
+	ctx.CalcAmp = calc_amp;
+    GeoAc_SetSystem(ctx);    
+	GeoAc_SetEqCnt(ctx);
 }
 
 
 //----------------------------------------------------------------//
 //----Functions To Build, Clear, and Delete the Solution Array----//
 //----------------------------------------------------------------//
-void GeoAc_BuildSolutionArray(double ** & solution, int length){
+void GeoAc_BuildSolutionArray(GeoAcContext & ctx, double ** & solution, int length){
 	solution = new double* [length];
 	for(int n = 0; n < length; n++){
-		solution[n] = new double [GeoAc_EqCnt];
+		solution[n] = new double [ctx.EqCnt];
 	}
 }
 
-void GeoAc_ClearSolutionArray(double ** & solution, int index){
+void GeoAc_ClearSolutionArray(GeoAcContext & ctx, double ** & solution, int index){
 	for(int n1 = 0; n1 < index; n1++){
-		for(int n2 = 0; n2 < GeoAc_EqCnt; n2++){
+		for(int n2 = 0; n2 < ctx.EqCnt; n2++){
 			solution[n1][n2] = 0.0;
 		}
 	}
@@ -11,19 +11,21 @@
 #include <cstdlib>
 #include <cstring>
 
+#include "GeoAc.Parameters.h"
+
 using namespace std;
 
 //--------------------------------------//
 //----Functions To Set Up The Solver----//
 //--------------------------------------//
-void GeoAc_SetEqCnt();
-void GeoAc_ConfigureCalcAmp(bool);
+void GeoAc_SetEqCnt(GeoAcContext &);
+void GeoAc_ConfigureCalcAmp(GeoAcContext &, bool);
 
 //----------------------------------------------------------------//
 //----Functions To Build, Clear, and Delete the Solution Array----//
 //----------------------------------------------------------------//
-void GeoAc_BuildSolutionArray(double ** &, int);
-void GeoAc_ClearSolutionArray(double ** &, int);
+void GeoAc_BuildSolutionArray(GeoAcContext &, double ** &, int);
+void GeoAc_ClearSolutionArray(GeoAcContext &, double ** &, int);
 void GeoAc_DeleteSolutionArray(double ** &, int);
 
 //-------------------------------------------------//
@@ -5,17 +5,7 @@
 
 using namespace std;
 
-//Initial angles at the source
-	double	GeoAc_theta;	// inclination angle
-	double 	GeoAc_phi;      // azimuth angle
-
-// Parameters for configuring solver
-    int     GeoAc_EqCnt;		// Number of equations to solve for
-    int     GeoAc_dim;          // Number of dimensions
-
-    bool    GeoAc_CalcAmp;      // Is amplitude to be calculated?
-    bool    GeoAc_AtmoStrat;    // Is the medium stratified?
-
+// Parameters for configuring solver (shared by all contexts)
     double GeoAc_ds_min =  0.001;   // Smallest possible ds for solver
     double GeoAc_ds_max =  0.5;     // Largest possible ds for solver
 
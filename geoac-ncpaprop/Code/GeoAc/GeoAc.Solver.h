@@ -2,10 +2,11 @@
 #define GEOAC_SOLVER_H_
 
 #include <math.h>
+#include "GeoAc.Parameters.h"
 
 using namespace std;
 
-int GeoAc_Propagate_RK4(double ** &, bool &);
+int GeoAc_Propagate_RK4(GeoAcContext &, double ** &, bool &);
 
 
 #endif /* GEOAC_SOLVER_H_ */
@@ -99,7 +99,9 @@ void GeoAc2D_RunProp(char* inputs[], int count){
     }
     z_src = max(z_src, z_grnd);
     if(WriteCaustics) CalcAmp=true;
-    GeoAc_ConfigureCalcAmp(CalcAmp);
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
+    GeoAc_ConfigureCalcAmp(ctx, CalcAmp);
     
     // Extract the file name from the input and use it to distinguish the resulting output
     char file_title[50];
@@ -161,37 +163,37 @@ void GeoAc2D_RunProp(char* inputs[], int count){
     }
     
 	double** solution;
-	GeoAc_BuildSolutionArray(solution,length);
+	GeoAc_BuildSolutionArray(ctx, solution,length);
     
 	for(double theta = theta_min; theta <= theta_max; theta+=theta_step){
 		cout << "Plotting ray path w/ theta = " << theta << ", phi = " << azimuth << '\n';
-		GeoAc_theta = theta*Pi/180.0;
-        GeoAc_phi = Pi/2.0 - azimuth*Pi/180.0;
+		ctx.theta = theta*Pi/180.0;
+        ctx.phi = Pi/2.0 - azimuth*Pi/180.0;
         
-		GeoAc_SetInitialConditions(solution, 0.0, z_src);
+		GeoAc_SetInitialConditions(ctx, solution, 0.0, z_src);
         travel_time_sum = 0.0;
         attenuation = 0.0;
         z_max = 0.0;
 		
 		for(int bnc_cnt = 0; bnc_cnt <= bounces; bnc_cnt++){
             
-			k = GeoAc_Propagate_RK4(solution, BreakCheck);
+			k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
             if(WriteCaustics) {
                 sprintf(output_buffer, "%s_caustics-path%i.dat", file_title, bnc_cnt);
                 caustics.open(output_buffer,fstream::app);
             }
             
-            if(WriteCaustics) D_prev = GeoAc_Jacobian(solution,1);
+            if(WriteCaustics) D_prev = GeoAc_Jacobian(ctx, solution,1);
             
             for(int m = 1; m < k ; m++){
-                GeoAc_TravelTimeSegment(travel_time_sum, solution, m-1,m);
-                GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
-                if(WriteCaustics) D = GeoAc_Jacobian(solution,m);
+                GeoAc_TravelTimeSegment(ctx, travel_time_sum, solution, m-1,m);
+                GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
+                if(WriteCaustics) D = GeoAc_Jacobian(ctx, solution,m);
                 
    				if(m % 25 == 0){
                     raypath << solution[m][0];
                     raypath << '\t' << max(solution[m][1],0.0);
-                    if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));}
+                    if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));}
                     else{           raypath << '\t' << 0.0;}
                     raypath << '\t' << -attenuation;
                     raypath << '\t' << travel_time_sum;
@@ -216,20 +218,21 @@ void GeoAc2D_RunProp(char* inputs[], int count){
 			results << '\t' << travel_time_sum;
             results << '\t' << z_max;
             results << '\t' << -theta;
-            if(CalcAmp){    results << '\t' << 20.0*log10(GeoAc_Amplitude(solution,k));}
+            if(CalcAmp){    results << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,k));}
             else{           results << '\t' << 0.0;}
             results << '\t' << -attenuation;
 			results << '\n';
             
-			GeoAc_SetReflectionConditions(solution,k);
+			GeoAc_SetReflectionConditions(ctx, solution,k);
 		}
-		GeoAc_ClearSolutionArray(solution,k);
+		GeoAc_ClearSolutionArray(ctx, solution,k);
         raypath << '\n';
 	}
 	
 	raypath.close();
 	results.close();
 	GeoAc_DeleteSolutionArray(solution, length);
+    GeoAc_ClearContext(ctx);
 }
 
 void GeoAc2D_RunInteractive(char* inputs[], int count){
@@ -262,7 +265,9 @@ void GeoAc2D_RunInteractive(char* inputs[], int count){
     }
     if(z_src < z_grnd) z_src=z_grnd;
     if(WriteCaustics) CalcAmp=true;
-    GeoAc_ConfigureCalcAmp(CalcAmp);
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
+    GeoAc_ConfigureCalcAmp(ctx, CalcAmp);
     
     // Define variables used for analysis
     double theta, azimuth;
@@ -276,7 +281,7 @@ void GeoAc2D_RunInteractive(char* inputs[], int count){
     ofstream caustics;
     
     double** solution;
-    GeoAc_BuildSolutionArray(solution,length);
+    GeoAc_BuildSolutionArray(ctx, solution,length);
     
     keepgoing='y';
     while(keepgoing=='y' || keepgoing=='Y'){
@@ -304,28 +309,28 @@ void GeoAc2D_RunInteractive(char* inputs[], int count){
         cout << '\n';
 
         cout << '\t' << "Plotting ray path w/ theta = " << theta << ", phi = " << azimuth << '\n';
-        GeoAc_theta = theta*Pi/180.0;
-        GeoAc_phi = Pi/2.0 - azimuth*Pi/180.0;
+        ctx.theta = theta*Pi/180.0;
+        ctx.phi = Pi/2.0 - azimuth*Pi/180.0;
         
-        GeoAc_SetInitialConditions(solution, 0.0, z_src);
+        GeoAc_SetInitialConditions(ctx, solution, 0.0, z_src);
         travel_time_sum = 0.0;
         attenuation = 0.0;
         z_max = 0.0;
 		
         for(int bnc_cnt = 0; bnc_cnt <= bounces; bnc_cnt++){
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
-            if(WriteCaustics) D_prev = GeoAc_Jacobian(solution,1);
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
+            if(WriteCaustics) D_prev = GeoAc_Jacobian(ctx, solution,1);
             
             for(int m = 1; m < k ; m++){     // write profiles to data files and vector arrays
-                GeoAc_TravelTimeSegment(travel_time_sum, solution, m-1,m);
-                GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
+                GeoAc_TravelTimeSegment(ctx, travel_time_sum, solution, m-1,m);
+                GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
                 z_max = max(z_max, solution[m][2]);
-                if(WriteCaustics) D = GeoAc_Jacobian(solution,m);
+                if(WriteCaustics) D = GeoAc_Jacobian(ctx, solution,m);
 
                 if(m % 25 == 0){
                     raypath << solution[m][0];
                     raypath << '\t' << max(solution[m][1],0.0);
-                    if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));}
+                    if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));}
                     else {          raypath << '\t' << 0.0;}
                     raypath << '\t' << -attenuation;
                     raypath << '\t' << travel_time_sum;
@@ -339,12 +344,12 @@ void GeoAc2D_RunInteractive(char* inputs[], int count){
                 if(WriteCaustics) D_prev = D;
             }
             if(BreakCheck) break;
-            GeoAc_SetReflectionConditions(solution,k);
+            GeoAc_SetReflectionConditions(ctx, solution,k);
         }
     
         if(!BreakCheck){
             cout << '\t' << '\t' << "Arrival Range = " << solution[k][0] << '\n';
-            if(CalcAmp){    cout << '\t' << '\t' << "Geometric Attenuation = " << 20.0*log10(GeoAc_Amplitude(solution,k)) << " dB." << '\n';}
+            if(CalcAmp){    cout << '\t' << '\t' << "Geometric Attenuation = " << 20.0*log10(GeoAc_Amplitude(ctx, solution,k)) << " dB." << '\n';}
             cout << '\t' << '\t' << "Atmospheric Attenuation = " << -attenuation << " dB." << '\n';
             cout << '\t' << '\t' << "Turning Height = " << z_max << "km." << '\n';
             cout << '\t' << '\t' << "Travel Time = " << travel_time_sum << "sec." << '\n';
@@ -359,6 +364,7 @@ void GeoAc2D_RunInteractive(char* inputs[], int count){
     }
     
     GeoAc_DeleteSolutionArray(solution, length);
+    GeoAc_ClearContext(ctx);
 }
 
 
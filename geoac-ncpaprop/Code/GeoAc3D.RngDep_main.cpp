@@ -5,6 +5,8 @@
 #include <sstream>
 #include <math.h>
 #include <time.h>
+#include <vector>
+#include <thread>
 
 #include "Atmo/G2S_MultiDimSpline3D.h"
 #include "Atmo/Atmo_State.h"
@@ -78,6 +80,26 @@ void GeoAc3D_RngDep_Usage(){
     cout << '\t' << '\t' << "iterations"        << '\t' << "integer"            << '\t' << '\t' << "25" << '\n';
     cout << '\t' << '\t' << "azimuth_err_lim"   << '\t' << "degrees"            << '\t' << '\t' << "2.0" << '\n' << '\n';
     
+    cout << '\t' << "-eig_multi (Search for all eigenrays connecting a source at (0.0, 0.0, z_src) to each receiver (x, y, z_grnd) listed in rcvr_file" << '\n';
+    cout << '\t' << '\t' << '\t' << "using a single coarse fan of rays to estimate launch angles and refining the estimates in parallel)" << '\n';
+    cout << '\t' << '\t' << "Parameter"  << '\t' << "Units/Options" << '\t' << "Default Value" << '\n';
+    cout << '\t' << '\t' << "---------------------------------------------" << '\n';
+    cout << '\t' << '\t' << "rcvr_file"         << '\t' << "x [km]  y [km]"     << '\t' << "None" << '\n';
+    cout << '\t' << '\t' << "theta_min"         << '\t' << "degrees"            << '\t' << '\t' << "0.5" << '\n';
+    cout << '\t' << '\t' << "theta_max"         << '\t' << "degrees"            << '\t' << '\t' << "45.0" << '\n';
+    cout << '\t' << '\t' << "bnc_min"           << '\t' << '\t' << "integer"    << '\t' << '\t' << "0" << '\n';
+    cout << '\t' << '\t' << "bnc_max"           << '\t' << '\t' << "integer"    << '\t' << '\t' << "0" << '\n';
+    cout << '\t' << '\t' << "bounces"           << '\t' << '\t' << "See Manual" << '\t' << "0" << '\n';
+    cout << '\t' << '\t' << "x_src"             << '\t' << '\t' << "km"         << '\t' << '\t' << "Midpoint of loc-x file" << '\n';
+    cout << '\t' << '\t' << "y_src"             << '\t' << '\t' << "km"         << '\t' << '\t' << "Midpoint of loc-y file" << '\n';
+    cout << '\t' << '\t' << "z_src"             << '\t' << '\t' << "km"         << '\t' << '\t' << "0.0" << '\n';
+    cout << '\t' << '\t' << "fan_theta_step"    << '\t' << "degrees"            << '\t' << '\t' << "0.5" << '\n';
+    cout << '\t' << '\t' << "fan_phi_step"      << '\t' << "degrees"            << '\t' << '\t' << "2.0" << '\n';
+    cout << '\t' << '\t' << "fan_phi_width"     << '\t' << "degrees"            << '\t' << '\t' << "8.0" << '\n';
+    cout << '\t' << '\t' << "cpu_cnt"           << '\t' << '\t' << "integer"    << '\t' << '\t' << "Available cores" << '\n';
+    cout << '\t' << '\t' << "Verbose"           << '\t' << '\t' << "True/False" << '\t' << "False" << '\n';
+    cout << '\t' << '\t' << "iterations"        << '\t' << "integer"            << '\t' << '\t' << "25" << '\n' << '\n';
+    
     cout << '\t' << "-eig_direct (Search for a single eigenray connecting a source at (0.0, 0.0, z_src) to a receiver at (x_rcvr, y_rcvr, z_grnd)" << '\n';
     cout << '\t' << '\t' << '\t' << "near an estimated azimuth and inclination pair assuming a specific number of ground reflections)" << '\n';
     cout << '\t' << '\t' << "Parameter"  << '\t' << "Units/Options" << '\t' << "Default Value" << '\n';
@@ -108,7 +130,8 @@ void GeoAc3D_RngDep_Usage(){
     
     cout << "Examples (Note - Profiles are not provided, these examples will not run without user specified profiles):" << '\n';
     cout << '\t' << "./GeoAc3D.RngDep -prop Profiles/Profile Profiles/loc_x.dat Profiles/loc_y.dat theta_step=2.0 bounces=2 azimuth=-45.0" << '\n';
-    cout << '\t' << "./GeoAc3D.RngDep -eig_search Profiles/Profile Profiles/loc_x.dat Profiles/loc_y.dat x_rcvr=300.0 y_rcvr=150.0 verbose=True" << '\n' << '\n';
+    cout << '\t' << "./GeoAc3D.RngDep -eig_search Profiles/Profile Profiles/loc_x.dat Profiles/loc_y.dat x_rcvr=300.0 y_rcvr=150.0 verbose=True" << '\n';
+    cout << '\t' << "./GeoAc3D.RngDep -eig_multi Profiles/Profile Profiles/loc_x.dat Profiles/loc_y.dat rcvr_file=stations.dat bnc_max=2 cpu_cnt=8" << '\n' << '\n';
 }
 
 void GeoAc3D_RngDep_RunProp(char* inputs[], int count){
@@ -167,7 +190,9 @@ void GeoAc3D_RngDep_RunProp(char* inputs[], int count){
     
     Spline_Multi_G2S(inputs[2], inputs[3], inputs[4], ProfileFormat);
     GeoAc_SetPropRegion();
-    GeoAc_ConfigureCalcAmp(CalcAmp);
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
+    GeoAc_ConfigureCalcAmp(ctx, CalcAmp);
     
     char file_title[50];
     for(int m = 0; m < 50; m++){
@@ -247,15 +272,15 @@ void GeoAc3D_RngDep_RunProp(char* inputs[], int count){
     }
     
 	double** solution;
-	GeoAc_BuildSolutionArray(solution,length);
+	GeoAc_BuildSolutionArray(ctx, solution,length);
 	
     for(double phi = phi_min;       phi <= phi_max;     phi+=phi_step){
     for(double theta = theta_min;   theta <= theta_max; theta+=theta_step){
         cout << "Plotting ray path w/ theta = " << theta << ", phi = " << phi << "." << '\n';
-        GeoAc_theta = theta*Pi/180.0;
-        GeoAc_phi = Pi/2.0 - phi*Pi/180.0;
+        ctx.theta = theta*Pi/180.0;
+        ctx.phi = Pi/2.0 - phi*Pi/180.0;
             
-        GeoAc_SetInitialConditions(solution, x_src, y_src, z_src);
+        GeoAc_SetInitialConditions(ctx, solution, x_src, y_src, z_src);
         travel_time_sum = 0.0;
         attenuation = 0.0;
         z_max = 0.0;
@@ -272,14 +297,14 @@ void GeoAc3D_RngDep_RunProp(char* inputs[], int count){
           double c0 = c(Source_Loc[0], Source_Loc[1], Source_Loc[2]); 
           
           
-          if (GeoAc_AtmoStrat) {
+          if (ctx.AtmoStrat) {
             
             double u0 = u(Source_Loc[0], Source_Loc[1], Source_Loc[2]);
             double v0 = v(Source_Loc[0], Source_Loc[1], Source_Loc[2]);
             double w0 = w(Source_Loc[0], Source_Loc[1], Source_Loc[2]);
             
             double M_comps[3] = { u0/c0,   v0/c0,     w0/c0}; // initial v0/c0 vector where v0 is the wind vector  - Mach components      
-            double nu_0[3]    = { cos(GeoAc_theta) * cos(GeoAc_phi),  cos(GeoAc_theta) * sin(GeoAc_phi),    sin(GeoAc_theta)}; // n = initial unit vector in nthe direction of the ray
+            double nu_0[3]    = { cos(ctx.theta) * cos(ctx.phi),  cos(ctx.theta) * sin(ctx.phi),    sin(ctx.theta)}; // n = initial unit vector in nthe direction of the ray
             double M1 = 1.0 + (nu_0[0] * M_comps[0] + nu_0[1] * M_comps[1] + nu_0[2] * M_comps[2]); // 1 + v0/c0*n
             nu_0_xy[0] = nu_0[0]/M1;
             nu_0_xy[1] = nu_0[1]/M1; // n/(1+v0/c0*n) = c0*n/(c0+v0*n) = c0*initial_slowness_x; slowness here is the grad of eikonal as in Pierce; looks like Phil defines slowness as c0*grad(Pierce eikonal)
@@ -291,26 +316,26 @@ void GeoAc3D_RngDep_RunProp(char* inputs[], int count){
          
             
         for(int bnc_cnt = 0; bnc_cnt <= bounces; bnc_cnt++){
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
                 
             if(WriteRays || WriteCaustics){
                 if(WriteCaustics){
                     sprintf(output_buffer, "%s_caustics-path%i.dat", file_title, bnc_cnt);
                     caustics.open(output_buffer,fstream::app);
                     
-                    D_prev = GeoAc_Jacobian(solution,1);
+                    D_prev = GeoAc_Jacobian(ctx, solution,1);
                 }
                 
                 for(int m = 1; m < k ; m++){     // write profiles to data files and vector arrays
-                    if(WriteCaustics){D = GeoAc_Jacobian(solution,m);}
-                    GeoAc_TravelTimeSegment(travel_time_sum, solution, m-1,m);
-                    GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
+                    if(WriteCaustics){D = GeoAc_Jacobian(ctx, solution,m);}
+                    GeoAc_TravelTimeSegment(ctx, travel_time_sum, solution, m-1,m);
+                    GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
                     
                     if(WriteRays && m % 25 == 0){
                         raypath << solution[m][0];
                         raypath << '\t' << solution[m][1];
                         raypath << '\t' << max(solution[m][2],0.0);
-                        if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));}
+                        if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));}
                         else{           raypath << '\t' << 0.0;}
                         raypath << '\t' << -attenuation;
                         raypath << '\t' << travel_time_sum;
@@ -327,7 +352,7 @@ void GeoAc3D_RngDep_RunProp(char* inputs[], int count){
                       raypath << '\t' << u(solution[m][0], solution[m][1], solution[m][2]);
                       raypath << '\t' << v(solution[m][0], solution[m][1], solution[m][2]);
                       raypath << '\t' << w(solution[m][0], solution[m][1], solution[m][2]);
-                      if (GeoAc_AtmoStrat) {
+                      if (ctx.AtmoStrat) {
                         raypath << '\t' << nu_0_xy[0]/c0;     // slowness_x for stratified case
                         raypath << '\t' << nu_0_xy[1]/c0;     // slowness_y for stratified case
                         raypath << '\t' << solution[m][3]/c0; // slowness_z for stratified case
@@ -354,8 +379,8 @@ void GeoAc3D_RngDep_RunProp(char* inputs[], int count){
                 }
                 if(WriteCaustics) caustics.close();
             } else {
-                travel_time_sum += GeoAc_TravelTime(solution,k);
-                attenuation+= GeoAc_SB_Atten(solution,k,freq);
+                travel_time_sum += GeoAc_TravelTime(ctx, solution,k);
+                attenuation+= GeoAc_SB_Atten(ctx, solution,k,freq);
             }
             if(BreakCheck) break;
             z_max = 0.0;
@@ -377,16 +402,16 @@ void GeoAc3D_RngDep_RunProp(char* inputs[], int count){
             results << '\t' << z_max;
             results << '\t' << inclination;
             results << '\t' << back_az;
-            if(CalcAmp){    results << '\t' << 20.0*log10(GeoAc_Amplitude(solution,k));}
+            if(CalcAmp){    results << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,k));}
             else{           results << '\t' << 0.0;}
             results << '\t' << -attenuation;
             results << '\n';
                 
-            GeoAc_SetReflectionConditions(solution,k);
+            GeoAc_SetReflectionConditions(ctx, solution,k);
             
         }
         if(WriteRays){raypath << '\n';}
-        GeoAc_ClearSolutionArray(solution,k);
+        GeoAc_ClearSolutionArray(ctx, solution,k);
     }
     results << '\n';
     }
@@ -396,6 +421,7 @@ void GeoAc3D_RngDep_RunProp(char* inputs[], int count){
 	GeoAc_DeleteSolutionArray(solution, length);
     
     ClearAll();
+    GeoAc_ClearContext(ctx);
 }
 
 void GeoAc3D_RngDep_RunInteractive(char* inputs[], int count){
@@ -436,7 +462,9 @@ void GeoAc3D_RngDep_RunInteractive(char* inputs[], int count){
     
     Spline_Multi_G2S(inputs[2], inputs[3], inputs[4], ProfileFormat);
     GeoAc_SetPropRegion();
-    GeoAc_ConfigureCalcAmp(true);
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
+    GeoAc_ConfigureCalcAmp(ctx, true);
     
     char file_title[50];
     for(int m = 0; m < 50; m++){
@@ -460,7 +488,7 @@ void GeoAc3D_RngDep_RunInteractive(char* inputs[], int count){
     ofstream caustics;
     
     double** solution;
-    GeoAc_BuildSolutionArray(solution,length);
+    GeoAc_BuildSolutionArray(ctx, solution,length);
 	
     keepgoing='y';
     while(keepgoing=='y' || keepgoing=='Y'){
@@ -491,29 +519,29 @@ void GeoAc3D_RngDep_RunInteractive(char* inputs[], int count){
         cout << '\n';
         cout << '\t' << "Plotting ray path w/ theta = " << theta << ", phi = " << phi << '\n';
         
-        GeoAc_theta = theta*Pi/180.0;
-        GeoAc_phi = Pi/2.0 - phi*Pi/180.0;
+        ctx.theta = theta*Pi/180.0;
+        ctx.phi = Pi/2.0 - phi*Pi/180.0;
         
-        GeoAc_SetInitialConditions(solution, x_src, y_src, z_src);
+        GeoAc_SetInitialConditions(ctx, solution, x_src, y_src, z_src);
         travel_time_sum = 0.0;
         attenuation = 0.0;
         z_max = 0.0;
         
         for(int bnc = 0; bnc <= bnc_cnt; bnc++){
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
-            if(WriteCaustics){ D_prev = GeoAc_Jacobian(solution,1);}
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
+            if(WriteCaustics){ D_prev = GeoAc_Jacobian(ctx, solution,1);}
             
             for(int m = 1; m < k ; m++){     // write profiles to data files and vector arrays
-                GeoAc_TravelTimeSegment(travel_time_sum, solution, m-1,m);
-                GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
+                GeoAc_TravelTimeSegment(ctx, travel_time_sum, solution, m-1,m);
+                GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
                 z_max = max (z_max, solution[m][2]);
-                if(WriteCaustics){ D = GeoAc_Jacobian(solution,m);}
+                if(WriteCaustics){ D = GeoAc_Jacobian(ctx, solution,m);}
                 
                 if(m % 25 == 0){
                     raypath << solution[m][0];
                     raypath << '\t' << solution[m][1];
                     raypath << '\t' << max(solution[m][2],0.0);
-                    if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));}
+                    if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));}
                     else{           raypath << '\t' << 0.0;}
                     raypath << '\t' << -attenuation;
                     raypath << '\t' << travel_time_sum;
@@ -528,7 +556,7 @@ void GeoAc3D_RngDep_RunInteractive(char* inputs[], int count){
                 if(WriteCaustics){D_prev = D;}
             }
             if(BreakCheck) break;
-            GeoAc_SetReflectionConditions(solution,k);
+            GeoAc_SetReflectionConditions(ctx, solution,k);
         }
         
         double range = sqrt(pow(solution[k][0],2) + pow(solution[k][1],2));
@@ -540,7 +568,7 @@ void GeoAc3D_RngDep_RunInteractive(char* inputs[], int count){
         if(!BreakCheck){
             cout << '\t' << '\t' << "Ray path arrived at " << solution[k][0] << " km E-W, " << solution[k][1] << " km N-S." << '\n';
             cout << '\t' << '\t' << "Arrival range = " << range << " km at azimuth " << atan2(solution[k][1], solution[k][0])*180.0/Pi << " degrees from N." << '\n';
-            if(CalcAmp){ cout << '\t' << '\t' << "Geometric attenuation = " << 20.0*log10(GeoAc_Amplitude(solution,k)) << " dB." << '\n';}
+            if(CalcAmp){ cout << '\t' << '\t' << "Geometric attenuation = " << 20.0*log10(GeoAc_Amplitude(ctx, solution,k)) << " dB." << '\n';}
             cout << '\t' << '\t' << "Atmospheric attenuation = " << -attenuation << " dB." << '\n';
             cout << '\t' << '\t' << "Arrival celerity = " << range/travel_time_sum << " km/sec." << '\n';
             cout << '\t' << '\t' << "Turning height of the ray = " << z_max << " km." << '\n';
@@ -557,6 +585,7 @@ void GeoAc3D_RngDep_RunInteractive(char* inputs[], int count){
     
 	GeoAc_DeleteSolutionArray(solution, length);
     ClearAll();
+    GeoAc_ClearContext(ctx);
 }
 
 void GeoAc3D_RngDep_RunEigSearch(char* inputs[], int count){
@@ -614,7 +643,9 @@ void GeoAc3D_RngDep_RunEigSearch(char* inputs[], int count){
     
     Spline_Multi_G2S(inputs[2], inputs[3], inputs[4],ProfileFormat);
     GeoAc_SetPropRegion();
-    GeoAc_ConfigureCalcAmp(true);
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
+    GeoAc_ConfigureCalcAmp(ctx, true);
     // Extract the file name from the input and use it to distinguish the output
 	char output_buffer[60];
     char file_title[50];
@@ -644,8 +675,8 @@ void GeoAc3D_RngDep_RunEigSearch(char* inputs[], int count){
         
         theta_start = theta_min;
         while(theta_start < theta_max){
-            estimate_success = GeoAc_EstimateEigenray(Source_Loc, Receiver_Loc, theta_start, theta_max, theta_est, phi_est, theta_next, n_bnc, azimuth_err_lim);
-            if(estimate_success)  GeoAc_3DEigenray_LM(Source_Loc, Receiver_Loc, theta_est, phi_est, freq, n_bnc, iterations, file_title);
+            estimate_success = GeoAc_EstimateEigenray(ctx, Source_Loc, Receiver_Loc, theta_start, theta_max, theta_est, phi_est, theta_next, n_bnc, azimuth_err_lim);
+            if(estimate_success)  GeoAc_3DEigenray_LM(ctx, Source_Loc, Receiver_Loc, theta_est, phi_est, freq, n_bnc, iterations, file_title);
             
             theta_start = theta_next;
         }
@@ -653,6 +684,7 @@ void GeoAc3D_RngDep_RunEigSearch(char* inputs[], int count){
     
     results.close();
     cout << '\t' << "Identified " << eigenray_count << " eigenray(s)." << '\n';
+    GeoAc_ClearContext(ctx);
 }
 
 void GeoAc3D_RngDep_RunEigDirect(char* inputs[], int count){
@@ -716,11 +748,131 @@ void GeoAc3D_RngDep_RunEigDirect(char* inputs[], int count){
         file_title[m]=inputs[2][m];
     }
     
-    GeoAc_3DEigenray_LM(Source_Loc, Receiver_Loc, theta_est, phi_est, freq, bounces, iterations, file_title);
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
+    GeoAc_3DEigenray_LM(ctx, Source_Loc, Receiver_Loc, theta_est, phi_est, freq, bounces, iterations, file_title);
+    GeoAc_ClearContext(ctx);
 }
 
 
 
+void GeoAc3D_RngDep_RunEigMulti(char* inputs[], int count){
+    double Source_Loc [3]   = {0.0, 0.0, 0.0};
+    double theta_min = 0.5, theta_max = 45.0;
+    int bnc_min = 0, bnc_max = 0;
+    int iterations=25;
+    int cpu_cnt = max(1, int(thread::hardware_concurrency()));
+    char* rcvr_file = NULL;
+    verbose_output=false;
+    double freq = 0.1;
+    char* ProfileFormat = "zTuvdp";
+    char input_check;
+    z_grnd=0.0;
+    tweak_abs = 0.3;
+    
+    for(int i = 5; i < count; i++){
+        if (strncmp(inputs[i], "rcvr_file=",10) == 0){              rcvr_file = inputs[i]+10;}
+        else if (strncmp(inputs[i], "theta_min=",10) == 0){         theta_min = atof(inputs[i]+10);}
+        else if (strncmp(inputs[i], "theta_max=",10) == 0){         theta_max = atof(inputs[i]+10);}
+        else if (strncmp(inputs[i], "bnc_min=",8) == 0){            bnc_min = atoi(inputs[i]+8);}
+        else if (strncmp(inputs[i], "bnc_max=",8) == 0){            bnc_max = atoi(inputs[i]+8);}
+        else if (strncmp(inputs[i], "bounces=",8) == 0){
+            bnc_min = atoi(inputs[i]+8);
+            bnc_max = atoi(inputs[i]+8);
+        }
+        else if (strncmp(inputs[i], "x_src=",6) == 0){              Source_Loc[0] = atof(inputs[i]+6);}
+        else if (strncmp(inputs[i], "y_src=",6) == 0){              Source_Loc[1] = atof(inputs[i]+6);}
+        else if (strncmp(inputs[i], "z_src=",6) == 0){              Source_Loc[2] = atof(inputs[i]+6);}
+        
+        else if (strncmp(inputs[i], "fan_theta_step=",15) == 0){    d_theta_fan = atof(inputs[i]+15);}
+        else if (strncmp(inputs[i], "fan_phi_step=",13) == 0){      d_phi_fan = atof(inputs[i]+13);}
+        else if (strncmp(inputs[i], "fan_phi_width=",14) == 0){     phi_fan_width = atof(inputs[i]+14);}
+        else if (strncmp(inputs[i], "cpu_cnt=",8) == 0){            cpu_cnt = max(1, atoi(inputs[i]+8));}
+        
+        else if (strncmp(inputs[i], "Verbose=",8) == 0){            verbose_output = string2bool(inputs[i]+8);}
+        else if (strncmp(inputs[i], "verbose=",8) == 0){            verbose_output = string2bool(inputs[i]+8);}
+        else if (strncmp(inputs[i], "iterations=",11) == 0){        iterations=atof(inputs[i]+11);}
+
+        else if (strncmp(inputs[i], "freq=",5) == 0){               freq = atof(inputs[i]+5);}
+        else if (strncmp(inputs[i], "abs_coeff=",10) == 0){         tweak_abs = max(0.0, atof(inputs[i]+10));}
+        else if (strncmp(inputs[i], "z_grnd=",7) == 0){             z_grnd = atof(inputs[i]+7);}
+        else if (strncmp(inputs[i], "profile_format=",15) == 0){    ProfileFormat = inputs[i]+15;}
+        else if (strncmp(inputs[i], "alt_max=",8) == 0){            GeoAc_vert_limit = atof(inputs[i]+8);}
+        else if (strncmp(inputs[i], "x_min=",6) == 0){              GeoAc_x_min_limit = atof(inputs[i]+6);}
+        else if (strncmp(inputs[i], "x_max=",6) == 0){              GeoAc_x_max_limit = atof(inputs[i]+6);}
+        else if (strncmp(inputs[i], "y_min=",6) == 0){              GeoAc_y_min_limit = atof(inputs[i]+6);}
+        else if (strncmp(inputs[i], "y_max=",6) == 0){              GeoAc_y_max_limit = atof(inputs[i]+6);}
+        
+        else{
+            cout << "***WARNING*** Unrecognized parameter entry: " << inputs[i] << '\n';
+            cout << "Continue? (y/n):"; cin >> input_check;
+            if(input_check!='y' && input_check!='Y') return;
+        }
+    }
+    Source_Loc[2] = max(Source_Loc[2], z_grnd);
+    
+    Spline_Multi_G2S(inputs[2], inputs[3], inputs[4],ProfileFormat);
+    GeoAc_SetPropRegion();
+    
+    // Load the receiver locations (x, y in km, one receiver per line)
+    if(rcvr_file == NULL){
+        cout << "Receiver file must be specified using rcvr_file=..." << '\n';
+        return;
+    }
+    ifstream rcvr_in(rcvr_file);
+    if(!rcvr_in.is_open()){
+        cout << "Cannot open receiver file " << rcvr_file << '\n';
+        return;
+    }
+    vector<double> rcvr_vals;
+    string line;
+    while(getline(rcvr_in, line)){
+        double x, y;
+        if(line.find("#") == 0) continue;
+        istringstream line_in(line);
+        if(line_in >> x >> y){
+            rcvr_vals.push_back(x);
+            rcvr_vals.push_back(y);
+        }
+    }
+    rcvr_in.close();
+    
+    int rcvr_cnt = rcvr_vals.size()/2;
+    double (*Receiver_Locs)[2] = new double [max(rcvr_cnt, 1)][2];
+    for(int r = 0; r < rcvr_cnt; r++){
+        Receiver_Locs[r][0] = rcvr_vals[2*r];
+        Receiver_Locs[r][1] = rcvr_vals[2*r + 1];
+    }
+    
+    // Extract the file name from the input and use it to distinguish the output
+	char output_buffer[60];
+    char file_title[50];
+    for(int m = 0; m < 50; m++){
+        if(inputs[2][m]=='.'){
+            file_title[m]='\0';
+            break;
+        }
+        file_title[m]=inputs[2][m];
+    }
+    
+    sprintf(output_buffer, "%s_results.dat", file_title);
+    results.open(output_buffer);
+    
+    results << "GeoAc3D.RngDep - Multiple Receiver Eigenray Run Summary:" << '\n';
+    results << '\t' << "Profile used: " << inputs[2] << '\n';
+    results << '\t' << "Source Location (kilometers) : (" << Source_Loc[0] << ", " << Source_Loc[1] << ", " <<  Source_Loc[2] << ")." << '\n';
+    results << '\t' << "Receiver file: " << rcvr_file << " (" << rcvr_cnt << " receivers)." << '\n';
+    results << '\t' << "Inclination range (degrees): " << theta_min << " - " << theta_max << "." << '\n';
+    results << '\t' << "Ground reflection (bounce) limits: " << bnc_min << " - " << bnc_max << "." << '\n' << '\n';
+    
+    GeoAc_3DEigenray_Multi(Source_Loc, Receiver_Locs, rcvr_cnt, theta_min, theta_max, bnc_min, bnc_max, freq, iterations, cpu_cnt, file_title);
+    
+    results.close();
+    cout << '\t' << "Identified " << eigenray_count << " eigenray(s)." << '\n';
+    
+    delete [] Receiver_Locs;
+}
+
 int main(int argc, char* argv[]){
     
     if(argc < 5){
@@ -743,6 +895,10 @@ int main(int argc, char* argv[]){
         GeoAc3D_RngDep_RunEigDirect(argv, argc);
         
         
+    } else if (strncmp(argv[1], "-eig_multi",10) == 0){
+        GeoAc3D_RngDep_RunEigMulti(argv, argc);
+        
+        
     } else {
         cout << "Unrecognized option." << '\n';
         return 0;
@@ -160,7 +160,9 @@ void GeoAcGlobal_RunProp(char* inputs[], int count){
     }
     z_src=max(z_src,z_grnd);
     if(WriteCaustics) CalcAmp=true;
-    GeoAc_ConfigureCalcAmp(CalcAmp);
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
+    GeoAc_ConfigureCalcAmp(ctx, CalcAmp);
     
     // Extract the file name from the input and use it to distinguish the resulting output
     char file_title[50];
@@ -232,41 +234,41 @@ void GeoAcGlobal_RunProp(char* inputs[], int count){
     }
     
 	double** solution;
-	GeoAc_BuildSolutionArray(solution,length);
+	GeoAc_BuildSolutionArray(ctx, solution,length);
     
     for(double phi = phi_min;           phi <= phi_max;     phi+=phi_step){
         for(double theta = theta_min;   theta <= theta_max; theta+=theta_step){
             cout << "Plotting ray path w/ theta = " << theta << ", phi = " << phi << '\n';
-            GeoAc_theta = theta*Pi/180.0;
-            GeoAc_phi = Pi/2.0 - phi*Pi/180.0;
+            ctx.theta = theta*Pi/180.0;
+            ctx.phi = Pi/2.0 - phi*Pi/180.0;
             
-            GeoAc_SetInitialConditions(solution, z_src, lat_src*Pi/180.0, lon_src*Pi/180.0);
+            GeoAc_SetInitialConditions(ctx, solution, z_src, lat_src*Pi/180.0, lon_src*Pi/180.0);
             travel_time_sum = 0.0;
             attenuation = 0.0;
             r_max = 0.0;
             
             for(int bnc_cnt = 0; bnc_cnt <= bounces; bnc_cnt++){
                 
-                k = GeoAc_Propagate_RK4(solution, BreakCheck);
+                k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
                 
                 if(WriteRays || WriteCaustics){
                     if(WriteCaustics){
                         sprintf(output_buffer, "%s_caustics-path%i.dat", file_title, bnc_cnt);
                         caustics.open(output_buffer,fstream::app);
                     
-                        D_prev = GeoAc_Jacobian(solution,1);
+                        D_prev = GeoAc_Jacobian(ctx, solution,1);
                     }
                     
                     for(int m = 1; m < k ; m++){     // write profiles to data files and vector arrays
-                        if(WriteCaustics) D = GeoAc_Jacobian(solution,m);
-                        GeoAc_TravelTimeSegment(travel_time_sum, solution, m-1,m);
-                        GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
+                        if(WriteCaustics) D = GeoAc_Jacobian(ctx, solution,m);
+                        GeoAc_TravelTimeSegment(ctx, travel_time_sum, solution, m-1,m);
+                        GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
                         
                         if(WriteRays && m % 25 == 0){
                             raypath << solution[m][0] - r_earth;
                             raypath << '\t' << setprecision(8) << solution[m][1] * 180.0/Pi;
                             raypath << '\t' << setprecision(8) << solution[m][2] * 180.0/Pi;
-                            if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));}
+                            if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));}
                             else{           raypath << '\t' << 0.0;}
                             raypath << '\t' << -attenuation;
                             raypath << '\t' << travel_time_sum << '\n';
@@ -282,8 +284,8 @@ void GeoAcGlobal_RunProp(char* inputs[], int count){
                     }
                     if(WriteCaustics) caustics.close();
                 } else {
-                    travel_time_sum+= GeoAc_TravelTime(solution, k);
-                    attenuation+= GeoAc_SB_Atten(solution,k,freq);
+                    travel_time_sum+= GeoAc_TravelTime(ctx, solution, k);
+                    attenuation+= GeoAc_SB_Atten(ctx, solution,k,freq);
                 }
                 
                 if(BreakCheck) break;
@@ -307,15 +309,15 @@ void GeoAcGlobal_RunProp(char* inputs[], int count){
                 results << '\t' << r_max;
                 results << '\t' << inclination;
                 results << '\t' << back_az;
-                if(CalcAmp){    results << '\t' << 20.0*log10(GeoAc_Amplitude(solution,k));}
+                if(CalcAmp){    results << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,k));}
                 else{           results << '\t' << 0.0;}
                 results << '\t' << -attenuation;
                 results << '\n';
                 
-                GeoAc_SetReflectionConditions(solution,k);	
+                GeoAc_SetReflectionConditions(ctx, solution,k);	
             }
             if(WriteRays){raypath << '\n';}
-            GeoAc_ClearSolutionArray(solution,k);
+            GeoAc_ClearSolutionArray(ctx, solution,k);
         }
         results << '\n';
     }
@@ -325,6 +327,7 @@ void GeoAcGlobal_RunProp(char* inputs[], int count){
 	caustics.close();
 	GeoAc_DeleteSolutionArray(solution, length);
 
+    GeoAc_ClearContext(ctx);
 }
 
 void GeoAcGlobal_RunInteractive(char* inputs[], int count){
@@ -361,7 +364,9 @@ void GeoAcGlobal_RunInteractive(char* inputs[], int count){
     if(WriteCaustics) CalcAmp=true;
     
     Spline_Single_G2S(inputs[2],ProfileFormat);         // Load profile into spline
-    GeoAc_ConfigureCalcAmp(CalcAmp);       // State if amplitude coefficient is to be calculated
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
+    GeoAc_ConfigureCalcAmp(ctx, CalcAmp);       // State if amplitude coefficient is to be calculated
     
     // Extract the file name from the input and use it to distinguish the resulting output
     char file_title[50];
@@ -386,7 +391,7 @@ void GeoAcGlobal_RunInteractive(char* inputs[], int count){
     ofstream caustics;
     
     double** solution;
-    GeoAc_BuildSolutionArray(solution,length);
+    GeoAc_BuildSolutionArray(ctx, solution,length);
     
     keepgoing='y';
     while(keepgoing=='y' || keepgoing=='Y'){
@@ -416,29 +421,29 @@ void GeoAcGlobal_RunInteractive(char* inputs[], int count){
         
         cout << '\n';
         cout << '\t' << "Plotting ray path w/ theta = " << theta << ", phi = " << phi << '\n';
-        GeoAc_theta = theta*Pi/180.0;
-        GeoAc_phi = Pi/2.0 - phi*Pi/180.0;
+        ctx.theta = theta*Pi/180.0;
+        ctx.phi = Pi/2.0 - phi*Pi/180.0;
         
-        GeoAc_SetInitialConditions(solution, z_src, lat_src*Pi/180.0, lon_src*Pi/180.0);
+        GeoAc_SetInitialConditions(ctx, solution, z_src, lat_src*Pi/180.0, lon_src*Pi/180.0);
         travel_time_sum = 0.0;
         attenuation = 0.0;
         r_max = 0.0;
 		
         for(int bnc = 0; bnc <= bnc_cnt; bnc++){
-            k = GeoAc_Propagate_RK4(solution, BreakCheck);
-            if(WriteCaustics){ D_prev = GeoAc_Jacobian(solution,1);}
+            k = GeoAc_Propagate_RK4(ctx, solution, BreakCheck);
+            if(WriteCaustics){ D_prev = GeoAc_Jacobian(ctx, solution,1);}
             
             for(int m = 1; m < k ; m++){     // write profiles to data files and vector arrays
-                GeoAc_TravelTimeSegment(travel_time_sum, solution, m-1,m);
-                GeoAc_SB_AttenSegment(attenuation, solution, m-1, m, freq);
+                GeoAc_TravelTimeSegment(ctx, travel_time_sum, solution, m-1,m);
+                GeoAc_SB_AttenSegment(ctx, attenuation, solution, m-1, m, freq);
                 r_max = max(r_max, solution[m][0] - r_earth);
-                if(WriteCaustics){ D = GeoAc_Jacobian(solution,m);}
+                if(WriteCaustics){ D = GeoAc_Jacobian(ctx, solution,m);}
                 
                 if(m % 25 == 0){
                     raypath << solution[m][0] - r_earth;
                     raypath << '\t' << setprecision(8) << solution[m][1] * 180.0/Pi;
                     raypath << '\t' << setprecision(8) << solution[m][2] * 180.0/Pi;
-                    if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(solution,m));}
+                    if(CalcAmp){    raypath << '\t' << 20.0*log10(GeoAc_Amplitude(ctx, solution,m));}
                     else{           raypath << '\t' << 0.0;}
                     raypath << '\t' << -attenuation;
                     raypath << '\t' << travel_time_sum;
@@ -454,7 +459,7 @@ void GeoAcGlobal_RunInteractive(char* inputs[], int count){
                 if(WriteCaustics){D_prev = D;}
             }
             if(BreakCheck) break;
-            GeoAc_SetReflectionConditions(solution,k);
+            GeoAc_SetReflectionConditions(ctx, solution,k);
         }
         
         double GC_Dist1 = pow(sin((solution[k][1] - lat_src*Pi/180.0)/2.0),2);
@@ -472,7 +477,7 @@ void GeoAcGlobal_RunInteractive(char* inputs[], int count){
         if(!BreakCheck){
             cout << '\t' << '\t' << "Ray path arrived at " << solution[k][1]*180.0/Pi << " degrees latitude, " << solution[k][2]*180.0/Pi << " degrees longitude." << '\n';
             cout << '\t' << '\t' << "Arrival range = " << range << " km at azimuth " << bearing << " degrees from N." << '\n';
-            if(CalcAmp) cout << '\t' << '\t' << "Geometric attenuation = " << 20.0*log10(GeoAc_Amplitude(solution,k)) << " dB." << '\n';
+            if(CalcAmp) cout << '\t' << '\t' << "Geometric attenuation = " << 20.0*log10(GeoAc_Amplitude(ctx, solution,k)) << " dB." << '\n';
             cout << '\t' << '\t' << "Atmospheric attenuation = " << -attenuation << " dB." << '\n';
             cout << '\t' << '\t' << "Arrival celerity = " << range/travel_time_sum << "km/sec." << '\n';
             cout << '\t' << '\t' << "Back azimuth of the arrival = " << back_az  << " degrees from N. " << '\n' << '\n';
@@ -487,6 +492,7 @@ void GeoAcGlobal_RunInteractive(char* inputs[], int count){
     }
     GeoAc_DeleteSolutionArray(solution, length);
     
+    GeoAc_ClearContext(ctx);
 }
 
 void GeoAcGlobal_RunEigSearch(char* inputs[], int count){
@@ -566,13 +572,15 @@ void GeoAcGlobal_RunEigSearch(char* inputs[], int count){
     results << '\t' << "Inclination range (degrees): " << theta_min << " - " << theta_max << "." << '\n';
     results << '\t' << "Ground reflection (bounce) limits: " << bnc_min << " - " << bnc_max << "." << '\n' << '\n';
     
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
     for(int n_bnc = bnc_min; n_bnc <= bnc_max; n_bnc++){
         cout << "Searching for " << n_bnc << " bounce eigenrays." << '\n';
         
         theta_start = theta_min;
         while(theta_start < theta_max){
-            estimate_success = GeoAc_EstimateEigenray(Source_Loc, Receiver_Loc, theta_start, theta_max, theta_est, phi_est, theta_next, n_bnc, azimuth_err_lim);
-            if(estimate_success)  GeoAc_3DEigenray_LM(Source_Loc, Receiver_Loc, theta_est, phi_est, freq, n_bnc, iterations, file_title);
+            estimate_success = GeoAc_EstimateEigenray(ctx, Source_Loc, Receiver_Loc, theta_start, theta_max, theta_est, phi_est, theta_next, n_bnc, azimuth_err_lim);
+            if(estimate_success)  GeoAc_3DEigenray_LM(ctx, Source_Loc, Receiver_Loc, theta_est, phi_est, freq, n_bnc, iterations, file_title);
             
             theta_start = theta_next;
         }
@@ -581,6 +589,7 @@ void GeoAcGlobal_RunEigSearch(char* inputs[], int count){
     results.close();
     cout << "Identified " << eigenray_count << " eigenray(s)." << '\n';
     
+    GeoAc_ClearContext(ctx);
 }
 
 void GeoAcGlobal_RunEigDirect(char* inputs[], int count){
@@ -643,7 +652,10 @@ void GeoAcGlobal_RunEigDirect(char* inputs[], int count){
         file_title[m]=inputs[2][m];
     }
 
-    GeoAc_3DEigenray_LM(Source_Loc, Receiver_Loc, theta_est, phi_est, freq, bounces, iterations, file_title);
+    GeoAcContext ctx;
+    GeoAc_InitContext(ctx);
+    GeoAc_3DEigenray_LM(ctx, Source_Loc, Receiver_Loc, theta_est, phi_est, freq, bounces, iterations, file_title);
+    GeoAc_ClearContext(ctx);
 }
 
 
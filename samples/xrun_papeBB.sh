@@ -20,6 +20,13 @@
 # "084_papeTL_0.164062" is the file number 84 obtained for a frequency offset
 # 0.164062 Hz. The number of files should obviously be Nfreq as expected by
 # tdpape for pulse propagation. 
+#
+# The same set of files can also be obtained from a single pape run that
+# marches all the frequencies together (see pape --help), e.g.
+#
+##   ../bin/pape --atmosfile1d NCPA_canonical_profile_zuvwtdp.dat --atmosfileorder zuvwtdp --skiplines 0 --azimuth 90 --batch_fmax $fmax --batch_nfreq $Nfreq --batch_dir $directory --sourceheight_km 0 --receiverheight_km 0 --maxheight_km 150 --starter_type gaussian --n_pade 6 --maxrange_km $maxrange_km
+#
+# All frequencies then use the range step of fmax.
 
 # ---------------------------------------------------------------------------
 # User input (probably a good idea to avoid blanks around the equal sign):
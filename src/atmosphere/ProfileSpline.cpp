@@ -0,0 +1,258 @@
+#include "ProfileSpline.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <sstream>
+
+NCPA::ProfileSpline::ProfileSpline() {
+	nz_ = 0;
+	nvars_ = 0;
+	z_ = 0;
+	coef_ = 0;
+	uniform_ = false;
+	invdz_ = 0.0;
+}
+
+NCPA::ProfileSpline::ProfileSpline( const ProfileSpline &other ) {
+	nz_ = 0;
+	nvars_ = 0;
+	z_ = 0;
+	coef_ = 0;
+	uniform_ = false;
+	invdz_ = 0.0;
+	copy_( other );
+}
+
+NCPA::ProfileSpline &NCPA::ProfileSpline::operator=( const ProfileSpline &other ) {
+	if (this != &other) {
+		clear_();
+		copy_( other );
+	}
+	return *this;
+}
+
+NCPA::ProfileSpline::~ProfileSpline() {
+	clear_();
+}
+
+void NCPA::ProfileSpline::clear_() {
+	if (z_ != 0)
+		delete [] z_;
+	if (coef_ != 0)
+		delete [] coef_;
+	z_ = 0;
+	coef_ = 0;
+	nz_ = 0;
+	nvars_ = 0;
+	uniform_ = false;
+	invdz_ = 0.0;
+}
+
+void NCPA::ProfileSpline::copy_( const ProfileSpline &other ) {
+	nz_ = other.nz_;
+	nvars_ = other.nvars_;
+	uniform_ = other.uniform_;
+	invdz_ = other.invdz_;
+	if (other.z_ != 0) {
+		z_ = new double[ nz_ ];
+		std::memcpy( z_, other.z_, nz_ * sizeof(double) );
+	}
+	if (other.coef_ != 0) {
+		unsigned int ncoef = 4 * nvars_ * (nz_ - 1);
+		coef_ = new double[ ncoef ];
+		std::memcpy( coef_, other.coef_, ncoef * sizeof(double) );
+	}
+}
+
+void NCPA::ProfileSpline::init( unsigned int nz, const double *z, unsigned int nvars ) {
+	if (nz < 2) {
+		throw std::invalid_argument( "ProfileSpline requires at least two altitude points!" );
+	}
+	for (unsigned int i = 1; i < nz; i++) {
+		if (!(z[ i ] > z[ i-1 ])) {
+			std::ostringstream es("");
+			es << "ProfileSpline altitudes must be strictly ascending (z[" << i << "] = "
+			   << z[ i ] << ")!";
+			throw std::invalid_argument( es.str() );
+		}
+	}
+
+	clear_();
+	nz_ = nz;
+	nvars_ = nvars;
+	z_ = new double[ nz_ ];
+	std::memcpy( z_, z, nz_ * sizeof(double) );
+
+	unsigned int ncoef = 4 * nvars_ * (nz_ - 1);
+	coef_ = new double[ ncoef ];
+	std::memset( coef_, 0, ncoef * sizeof(double) );
+
+	// Evenly-spaced grids (the usual case for G2S and model profiles) can be
+	// indexed directly instead of searched
+	double dz = (z_[ nz_-1 ] - z_[ 0 ]) / (nz_ - 1);
+	uniform_ = true;
+	for (unsigned int i = 1; i < nz_; i++) {
+		if (std::fabs( (z_[ i ] - z_[ i-1 ]) - dz ) > 1.0e-10 * dz) {
+			uniform_ = false;
+			break;
+		}
+	}
+	invdz_ = 1.0 / dz;
+}
+
+void NCPA::ProfileSpline::setVariable( unsigned int var, const double *q ) {
+	if (coef_ == 0) {
+		throw std::runtime_error( "ProfileSpline has not been initialized!" );
+	}
+	if (var >= nvars_) {
+		std::ostringstream es("");
+		es << "ProfileSpline variable " << var << " is out of range!";
+		throw std::range_error( es.str() );
+	}
+
+	// Second-derivative coefficients c_i of the natural spline, from the
+	// tridiagonal system
+	//   h_(i-1) c_(i-1) + 2 (h_(i-1) + h_i) c_i + h_i c_(i+1) = 3 (dq_i/h_i - dq_(i-1)/h_(i-1))
+	// with c_0 = c_(n-1) = 0, solved by forward elimination and back substitution.
+	double *c = new double[ nz_ ];
+	double *diag = new double[ nz_ ];
+	c[ 0 ] = 0.0;
+	c[ nz_-1 ] = 0.0;
+	for (unsigned int i = 1; i < nz_-1; i++) {
+		double hm = z_[ i ] - z_[ i-1 ];
+		double hp = z_[ i+1 ] - z_[ i ];
+		diag[ i ] = 2.0 * (hm + hp);
+		c[ i ] = 3.0 * ((q[ i+1 ] - q[ i ]) / hp - (q[ i ] - q[ i-1 ]) / hm);
+		if (i > 1) {
+			double m = hm / diag[ i-1 ];
+			diag[ i ] -= m * hm;
+			c[ i ] -= m * c[ i-1 ];
+		}
+	}
+	for (unsigned int i = nz_-2; i >= 1; i--) {
+		double hp = z_[ i+1 ] - z_[ i ];
+		c[ i ] = (c[ i ] - hp * c[ i+1 ]) / diag[ i ];
+	}
+
+	for (unsigned int i = 0; i < nz_-1; i++) {
+		double h = z_[ i+1 ] - z_[ i ];
+		double *cf = coef_ + 4 * (i * nvars_ + var);
+		cf[ 0 ] = q[ i ];
+		cf[ 1 ] = (q[ i+1 ] - q[ i ]) / h - h * (c[ i+1 ] + 2.0 * c[ i ]) / 3.0;
+		cf[ 2 ] = c[ i ];
+		cf[ 3 ] = (c[ i+1 ] - c[ i ]) / (3.0 * h);
+	}
+
+	delete [] c;
+	delete [] diag;
+}
+
+bool NCPA::ProfileSpline::ready() const {
+	return (coef_ != 0);
+}
+
+unsigned int NCPA::ProfileSpline::nz() const {
+	return nz_;
+}
+
+unsigned int NCPA::ProfileSpline::nvars() const {
+	return nvars_;
+}
+
+double NCPA::ProfileSpline::zmin() const {
+	return z_[ 0 ];
+}
+
+double NCPA::ProfileSpline::zmax() const {
+	return z_[ nz_-1 ];
+}
+
+unsigned int NCPA::ProfileSpline::locate( double z, ProfileSplineCursor &cursor ) const {
+	unsigned int last = nz_ - 2;
+	unsigned int i;
+
+	if (uniform_) {
+		double s = (z - z_[ 0 ]) * invdz_;
+		i = (s <= 0.0) ? 0 : (unsigned int)s;
+		i = (i > last) ? last : i;
+		cursor.interval = i;
+		return i;
+	}
+
+	// Rays move smoothly in altitude, so the previous interval or one of its
+	// neighbours almost always contains the new point
+	i = (cursor.interval > last) ? last : cursor.interval;
+	if (z >= z_[ i ]) {
+		if (i == last || z < z_[ i+1 ]) {
+			cursor.interval = i;
+			return i;
+		}
+		if (i+1 == last || z < z_[ i+2 ]) {
+			cursor.interval = i+1;
+			return i+1;
+		}
+	} else if (i == 0) {
+		return 0;
+	} else if (z >= z_[ i-1 ]) {
+		cursor.interval = i-1;
+		return i-1;
+	}
+
+	unsigned int bottom = 0, top = nz_ - 1, middle;
+	while (top - bottom > 1) {
+		middle = (top + bottom) >> 1;
+		if (z >= z_[ middle ])
+			bottom = middle;
+		else
+			top = middle;
+	}
+	cursor.interval = bottom;
+	return bottom;
+}
+
+void NCPA::ProfileSpline::eval( double z, ProfileSplineCursor &cursor, double *f,
+		double *df, double *ddf ) const {
+	unsigned int i = locate( z, cursor );
+	double dz = z - z_[ i ];
+	const double *cf = coef_ + 4 * i * nvars_;
+
+	if (f != 0) {
+		for (unsigned int k = 0; k < nvars_; k++) {
+			const double *a = cf + 4*k;
+			f[ k ] = a[0] + dz * (a[1] + dz * (a[2] + dz * a[3]));
+		}
+	}
+	if (df != 0) {
+		for (unsigned int k = 0; k < nvars_; k++) {
+			const double *a = cf + 4*k;
+			df[ k ] = a[1] + dz * (2.0 * a[2] + 3.0 * dz * a[3]);
+		}
+	}
+	if (ddf != 0) {
+		for (unsigned int k = 0; k < nvars_; k++) {
+			const double *a = cf + 4*k;
+			ddf[ k ] = 2.0 * a[2] + 6.0 * dz * a[3];
+		}
+	}
+}
+
+double NCPA::ProfileSpline::eval( unsigned int var, double z, ProfileSplineCursor &cursor ) const {
+	unsigned int i = locate( z, cursor );
+	double dz = z - z_[ i ];
+	const double *a = coef_ + 4 * (i * nvars_ + var);
+	return a[0] + dz * (a[1] + dz * (a[2] + dz * a[3]));
+}
+
+double NCPA::ProfileSpline::eval_deriv( unsigned int var, double z, ProfileSplineCursor &cursor ) const {
+	unsigned int i = locate( z, cursor );
+	double dz = z - z_[ i ];
+	const double *a = coef_ + 4 * (i * nvars_ + var);
+	return a[1] + dz * (2.0 * a[2] + 3.0 * dz * a[3]);
+}
+
+double NCPA::ProfileSpline::eval_deriv2( unsigned int var, double z, ProfileSplineCursor &cursor ) const {
+	unsigned int i = locate( z, cursor );
+	double dz = z - z_[ i ];
+	const double *a = coef_ + 4 * (i * nvars_ + var);
+	return 2.0 * a[2] + 6.0 * dz * a[3];
+}
@@ -0,0 +1,98 @@
+#ifndef __PROFILESPLINE_H__
+#define __PROFILESPLINE_H__
+
+namespace NCPA {
+
+	/**
+	 * Caller-owned interval cache for ProfileSpline lookups.  Each thread (or each
+	 * ray) should hold its own cursor; the spline itself is never modified by an
+	 * evaluation, so any number of cursors may be used against one spline at once.
+	 */
+	struct ProfileSplineCursor {
+		unsigned int interval;
+		ProfileSplineCursor() : interval( 0 ) {}
+	};
+
+	/**
+	 * Natural cubic spline of several profile variables sampled on a common
+	 * altitude grid.  The four polynomial coefficients of every variable are
+	 * stored together for each grid interval, so that all variables, and their
+	 * first and second derivatives, can be evaluated at one altitude after a
+	 * single interval lookup.  The coefficients reproduce gsl_interp_cspline.
+	 *
+	 * Evaluation does not check bounds: altitudes outside the grid are
+	 * extrapolated from the first or last interval.  Range checking is left to
+	 * the owning profile.
+	 */
+	class ProfileSpline {
+
+	public:
+		ProfileSpline();
+		ProfileSpline( const ProfileSpline &other );
+		ProfileSpline &operator=( const ProfileSpline &other );
+		~ProfileSpline();
+
+		/**
+		 * Sets up the altitude grid and allocates coefficient storage for nvars
+		 * variables, all of which are initially zero.
+		 * @param nz The number of altitude points (at least 2)
+		 * @param z The altitude grid, strictly ascending
+		 * @param nvars The number of variables to be splined on the grid
+		 */
+		void init( unsigned int nz, const double *z, unsigned int nvars );
+
+		/**
+		 * Computes the spline coefficients of one variable from its samples.
+		 * Other variables are left untouched, so this may be called again to
+		 * replace a single variable (e.g. effective sound speed) cheaply.
+		 * @param var The variable slot, 0 <= var < nvars()
+		 * @param q The nz() samples of the variable
+		 */
+		void setVariable( unsigned int var, const double *q );
+
+		bool ready() const;
+		unsigned int nz() const;
+		unsigned int nvars() const;
+		double zmin() const;
+		double zmax() const;
+
+		/**
+		 * Finds the interval i with z_i <= z < z_(i+1), clamped to the grid.
+		 * Uniform grids are indexed directly; otherwise the interval held by the
+		 * cursor and its neighbours are tried before falling back to bisection.
+		 */
+		unsigned int locate( double z, ProfileSplineCursor &cursor ) const;
+
+		/**
+		 * Evaluates every variable at z.  Any of the output arrays may be null;
+		 * non-null arrays must hold nvars() values.
+		 * @param z The altitude
+		 * @param cursor The caller's interval cache
+		 * @param f Output values
+		 * @param df Output first derivatives with respect to z
+		 * @param ddf Output second derivatives with respect to z
+		 */
+		void eval( double z, ProfileSplineCursor &cursor, double *f,
+			double *df = 0, double *ddf = 0 ) const;
+
+		double eval( unsigned int var, double z, ProfileSplineCursor &cursor ) const;
+		double eval_deriv( unsigned int var, double z, ProfileSplineCursor &cursor ) const;
+		double eval_deriv2( unsigned int var, double z, ProfileSplineCursor &cursor ) const;
+
+	protected:
+		unsigned int nz_, nvars_;
+		double *z_;
+
+		// coef_[ 4 * (interval * nvars_ + var) + k ] holds the k'th-order coefficient
+		double *coef_;
+
+		// Set when the grid is evenly spaced, so that lookup is one multiply
+		bool uniform_;
+		double invdz_;
+
+		void clear_();
+		void copy_( const ProfileSpline &other );
+	};
+}
+
+#endif
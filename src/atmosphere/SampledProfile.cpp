@@ -35,9 +35,6 @@ void NCPA::SampledProfile::init_() {
 
 	z_ = t_ = u_ = v_ = w_ = rho_ = p_ = c0_ = ceff_ = 0;
 	
-	t_acc = u_acc = v_acc = w_acc = p_acc = rho_acc = c0_acc = ceff_acc = 0;
-	t_spline = u_spline = v_spline = w_spline = p_spline = rho_spline = c0_spline = ceff_spline = 0;
-	
 	good_ = false;
 	hasW_ = false;
 	hasP_ = false;
@@ -64,22 +61,6 @@ void NCPA::SampledProfile::clearOut() {
 	hasW_ = false;
 	hasRho_ = false;
 	delete origin_;
-	delete t_acc;
-	delete u_acc;
-	delete v_acc;
-	delete w_acc;
-	delete p_acc;
-	delete rho_acc;
-	delete c0_acc;
-	delete ceff_acc;
-	delete t_spline;
-	delete u_spline;
-	delete v_spline;
-	delete w_spline;
-	delete p_spline;
-	delete rho_spline;
-	delete c0_spline;
-	delete ceff_spline;
 }
 
 NCPA::SampledProfile::~SampledProfile() {
@@ -258,39 +239,23 @@ NCPA::SampledProfile::SampledProfile( SampledProfile &p ) {
 
 void NCPA::SampledProfile::initSplines() {
 	
-	t_acc = gsl_interp_accel_alloc();
-	t_spline = gsl_spline_alloc( gsl_interp_cspline, nz_ );
-	u_acc = gsl_interp_accel_alloc();
-	u_spline = gsl_spline_alloc( gsl_interp_cspline, nz_ );
-	v_acc = gsl_interp_accel_alloc();
-	v_spline = gsl_spline_alloc( gsl_interp_cspline, nz_ );
-	w_acc = gsl_interp_accel_alloc();
-	w_spline = gsl_spline_alloc( gsl_interp_cspline, nz_ );
-	p_acc = gsl_interp_accel_alloc();
-	p_spline = gsl_spline_alloc( gsl_interp_cspline, nz_ );
-	rho_acc = gsl_interp_accel_alloc();
-	rho_spline = gsl_spline_alloc( gsl_interp_cspline, nz_ );
-	c0_acc = gsl_interp_accel_alloc();
-	c0_spline = gsl_spline_alloc( gsl_interp_cspline, nz_ );
-	ceff_acc = gsl_interp_accel_alloc();
-	ceff_spline = gsl_spline_alloc( gsl_interp_cspline, nz_ );
+	spline_.init( nz_, z_, SPLINE_NVARS );
+	cursor_.interval = 0;
 	
-	gsl_spline_init( t_spline, z_, t_, nz_ );
-	gsl_spline_init( u_spline, z_, u_, nz_ );
-	gsl_spline_init( v_spline, z_, v_, nz_ );
-	gsl_spline_init( w_spline, z_, w_, nz_ );
+	spline_.setVariable( SPLINE_T, t_ );
+	spline_.setVariable( SPLINE_U, u_ );
+	spline_.setVariable( SPLINE_V, v_ );
+	spline_.setVariable( SPLINE_W, w_ );
 	if (p_ != 0)
-		gsl_spline_init( p_spline, z_, p_, nz_ );
+		spline_.setVariable( SPLINE_P, p_ );
 	if (rho_ != 0)
-		gsl_spline_init( rho_spline, z_, rho_, nz_ );
+		spline_.setVariable( SPLINE_RHO, rho_ );
 	if (c0_ != 0)
-		gsl_spline_init( c0_spline, z_, c0_, nz_ );
+		spline_.setVariable( SPLINE_C0, c0_ );
 	if (ceff_ != 0)
-		gsl_spline_init( ceff_spline, z_, ceff_, nz_ );
+		spline_.setVariable( SPLINE_CEFF, ceff_ );
 }
 
-
-
 NCPA::SampledProfile::SampledProfile( std::string filename, const char *order, int skiplines, bool inMPS ) {
 	init_();
 
@@ -660,7 +625,8 @@ void NCPA::SampledProfile::setPropagationAzimuth( double newPropAz ) {
 			ceff_[ i ] = c0_[ i ] + std::sqrt( u_[i]*u_[i] + v_[i]*v_[i] ) * std::cos( NCPA::deg2rad(propAz_) - direction );
 		}
 		
-		gsl_spline_init( ceff_spline, z_, ceff_, nz_ );
+		if (spline_.ready())
+			spline_.setVariable( SPLINE_CEFF, ceff_ );
 	}
 }
 
@@ -751,7 +717,7 @@ double NCPA::SampledProfile::t( double z ) {
 		throw e2;
 	} else {
 		//return t_[ z2ind_( z ) ];
-		return gsl_spline_eval( t_spline, z, t_acc );
+		return spline_.eval( SPLINE_T, z, cursor_ );
 	}
 }
 
@@ -768,7 +734,7 @@ double NCPA::SampledProfile::u( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval( u_spline, z, u_acc );
+		return spline_.eval( SPLINE_U, z, cursor_ );
 	}
 }
 
@@ -785,7 +751,7 @@ double NCPA::SampledProfile::v( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval( v_spline, z, v_acc );
+		return spline_.eval( SPLINE_V, z, cursor_ );
 	}
 }
 
@@ -802,7 +768,7 @@ double NCPA::SampledProfile::w( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval( w_spline, z, w_acc );
+		return spline_.eval( SPLINE_W, z, cursor_ );
 	}
 }
 
@@ -819,7 +785,7 @@ double NCPA::SampledProfile::p( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval( p_spline, z, p_acc );
+		return spline_.eval( SPLINE_P, z, cursor_ );
 	}
 }
 
@@ -836,7 +802,7 @@ double NCPA::SampledProfile::rho( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval( rho_spline, z, rho_acc );
+		return spline_.eval( SPLINE_RHO, z, cursor_ );
 	}
 }
 
@@ -854,7 +820,7 @@ double NCPA::SampledProfile::c0( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval( c0_spline, z, c0_acc );
+		return spline_.eval( SPLINE_C0, z, cursor_ );
 	}
 }
 
@@ -873,10 +839,38 @@ double NCPA::SampledProfile::ceff( double z, double phi ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval( ceff_spline, z, ceff_acc );
+		return spline_.eval( SPLINE_CEFF, z, cursor_ );
+	}
+}
+
+void NCPA::SampledProfile::evaluate( double z, ProfileSplineCursor &cursor, double *f,
+		double *df, double *ddf ) const {
+	if ((!good_) || (!spline_.ready())) {
+		std::runtime_error e( "Profile is not ready!" );
+		throw e;
+	} else if (z < minZ_ ) {
+		spline_.eval( minZ_, cursor, f );
+		for (unsigned int k = 0; k < SPLINE_NVARS; k++) {
+			if (df != 0)
+				df[ k ] = 0.0;
+			if (ddf != 0)
+				ddf[ k ] = 0.0;
+		}
+	} else if ( z > maxZ_) {
+		std::ostringstream es("Requested altitude ");
+		es << z;
+		es << " is out of bounds in evaluate()!";
+		std::range_error e2( es.str() );
+		throw e2;
+	} else {
+		spline_.eval( z, cursor, f, df, ddf );
 	}
 }
 
+const NCPA::ProfileSpline *NCPA::SampledProfile::spline() const {
+	return &spline_;
+}
+
 double NCPA::SampledProfile::z( unsigned int index ) const {
 	if (index >= nz_) {
 		std::range_error e("Index out of bounds!");
@@ -886,7 +880,26 @@ double NCPA::SampledProfile::z( unsigned int index ) const {
 	return z_[ index ];
 }
 
+int NCPA::SampledProfile::splineSlot_( const double *q ) const {
+	if (q == 0)       return -1;
+	if (q == t_)      return SPLINE_T;
+	if (q == u_)      return SPLINE_U;
+	if (q == v_)      return SPLINE_V;
+	if (q == w_)      return SPLINE_W;
+	if (q == p_)      return SPLINE_P;
+	if (q == rho_)    return SPLINE_RHO;
+	if (q == c0_)     return SPLINE_C0;
+	if (q == ceff_)   return SPLINE_CEFF;
+	return -1;
+}
+
 double NCPA::SampledProfile::d_dz( double z, double *q ) {
+	// Member profiles are differentiated analytically from their splines; finite
+	// differences of the samples are only used for arrays we don't own
+	int slot = splineSlot_( q );
+	if (slot >= 0 && spline_.ready()) {
+		return spline_.eval_deriv( slot, z, cursor_ );
+	}
 /*
 	unsigned int zind = z2ind_floor_( z );
 	if (zind+1 == nz_)
@@ -918,6 +931,10 @@ double NCPA::SampledProfile::d_dz( double z, double *q ) {
 }
 
 double NCPA::SampledProfile::dd_dzdz( double z, double *q ) {
+	int slot = splineSlot_( q );
+	if (slot >= 0 && spline_.ready()) {
+		return spline_.eval_deriv2( slot, z, cursor_ );
+	}
 /*
 	unsigned int zind = z2ind_floor_( z );
 	if (zind+1 == nz_)
@@ -941,7 +958,7 @@ double NCPA::SampledProfile::dd_dzdz( double z, double *q ) {
 			dq = q[ nz_-1 ] - 2*q[ nz_-2 ] + q[ nz_-3 ];
 			return dq / (dz*dz);
 	} else {
-			dz = z_[zind+1] + z_[zind];
+			dz = z_[zind+1] - z_[zind];
 			dq = q[ zind+1 ] - 2*q[ zind ] + q[ zind-1 ];
 			return dq / (dz*dz);
 	}
@@ -960,7 +977,7 @@ double NCPA::SampledProfile::dtdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv( t_spline, z, t_acc );
+		return spline_.eval_deriv( SPLINE_T, z, cursor_ );
 	}
 }
 
@@ -977,7 +994,7 @@ double NCPA::SampledProfile::dudz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv( u_spline, z, u_acc );
+		return spline_.eval_deriv( SPLINE_U, z, cursor_ );
 	}
 }
 
@@ -994,7 +1011,7 @@ double NCPA::SampledProfile::dvdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv( v_spline, z, v_acc );
+		return spline_.eval_deriv( SPLINE_V, z, cursor_ );
 	}
 }
 	
@@ -1011,7 +1028,7 @@ double NCPA::SampledProfile::dwdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv( w_spline, z, w_acc );
+		return spline_.eval_deriv( SPLINE_W, z, cursor_ );
 	}
 }
 
@@ -1028,7 +1045,7 @@ double NCPA::SampledProfile::dpdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv( p_spline, z, p_acc );
+		return spline_.eval_deriv( SPLINE_P, z, cursor_ );
 	}
 }
 
@@ -1045,7 +1062,7 @@ double NCPA::SampledProfile::drhodz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv( rho_spline, z, rho_acc );
+		return spline_.eval_deriv( SPLINE_RHO, z, cursor_ );
 	}
 }
 
@@ -1062,7 +1079,7 @@ double NCPA::SampledProfile::ddtdzdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv2( t_spline, z, t_acc );
+		return spline_.eval_deriv2( SPLINE_T, z, cursor_ );
 	}
 }
 
@@ -1079,7 +1096,7 @@ double NCPA::SampledProfile::ddudzdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv2( u_spline, z, u_acc );
+		return spline_.eval_deriv2( SPLINE_U, z, cursor_ );
 	}
 }
 
@@ -1096,7 +1113,7 @@ double NCPA::SampledProfile::ddvdzdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv2( v_spline, z, v_acc );
+		return spline_.eval_deriv2( SPLINE_V, z, cursor_ );
 	}
 }
 
@@ -1113,7 +1130,7 @@ double NCPA::SampledProfile::ddwdzdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv2( w_spline, z, w_acc );
+		return spline_.eval_deriv2( SPLINE_W, z, cursor_ );
 	}
 }
 
@@ -1130,7 +1147,7 @@ double NCPA::SampledProfile::ddpdzdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv2( p_spline, z, p_acc );
+		return spline_.eval_deriv2( SPLINE_P, z, cursor_ );
 	}
 }
 
@@ -1147,7 +1164,7 @@ double NCPA::SampledProfile::ddrhodzdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv2( rho_spline, z, rho_acc );
+		return spline_.eval_deriv2( SPLINE_RHO, z, cursor_ );
 	}
 }
 
@@ -1165,7 +1182,7 @@ double NCPA::SampledProfile::dceffdz( double z, double phi ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv( ceff_spline, z, ceff_acc );
+		return spline_.eval_deriv( SPLINE_CEFF, z, cursor_ );
 	}
 }
 
@@ -1183,7 +1200,7 @@ double NCPA::SampledProfile::ddceffdzdz( double z, double phi ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv2( ceff_spline, z, ceff_acc );
+		return spline_.eval_deriv2( SPLINE_CEFF, z, cursor_ );
 	}
 }
 
@@ -1200,7 +1217,7 @@ double NCPA::SampledProfile::dc0dz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv( c0_spline, z, c0_acc );
+		return spline_.eval_deriv( SPLINE_C0, z, cursor_ );
 	}
 }
 
@@ -1219,7 +1236,7 @@ double NCPA::SampledProfile::ddc0dzdz( double z ) {
 		std::range_error e2( es.str() );
 		throw e2;
 	} else {
-		return gsl_spline_eval_deriv2( c0_spline, z, c0_acc );
+		return spline_.eval_deriv2( SPLINE_C0, z, cursor_ );
 	}
 }
 
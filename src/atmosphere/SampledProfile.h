@@ -2,6 +2,7 @@
 #define __SAMPLEDPROFILE_H__
 
 #include "AtmosphericProfile.h"
+#include "ProfileSpline.h"
 #include "geographic.h"
 #include <string>
 #include <iostream>
@@ -18,18 +19,30 @@ namespace NCPA {
 		double z0_, propAz_, minZ_, maxZ_;
 		double *z_, *t_, *u_, *v_, *w_, *rho_, *p_, *c0_, *ceff_;
 
-		// Spline objects and accelerators
-		gsl_interp_accel *t_acc, *u_acc, *v_acc, *w_acc, *p_acc, *rho_acc, *c0_acc, *ceff_acc;
-		gsl_spline *t_spline, *u_spline, *v_spline, *w_spline, *p_spline, *rho_spline, *c0_spline, *ceff_spline;
+		// Cubic coefficients for every variable, interleaved per interval, and the
+		// cursor used by the single-variable accessors.  Those accessors share
+		// cursor_ and so are not thread-safe; concurrent callers should use
+		// evaluate() with their own cursor.
+		ProfileSpline spline_;
+		ProfileSplineCursor cursor_;
 		
 		virtual void init_();
 		virtual void clearOut();
 		virtual void initSplines();
+		int splineSlot_( const double *q ) const;
 		
 		virtual double d_dz( double z, double *q );
 		virtual double dd_dzdz( double z, double *q );
 		
 	public:
+		/**
+		 * Variable slots in the arrays filled by evaluate().
+		 */
+		enum {
+			SPLINE_T = 0, SPLINE_U, SPLINE_V, SPLINE_W, SPLINE_P, SPLINE_RHO,
+			SPLINE_C0, SPLINE_CEFF, SPLINE_NVARS
+		};
+		
 		SampledProfile();
 		virtual ~SampledProfile();
 		SampledProfile( double lat, double lon, int nz, double *z, double *t,
@@ -80,6 +93,23 @@ namespace NCPA {
 		virtual double c0( double z );
 		virtual double ceff( double z, double phi );
 		
+		/**
+		 * Evaluates all profile variables at one altitude with a single interval
+		 * lookup.  This method does not modify the profile, so it may be called
+		 * from several threads at once provided each uses its own cursor and the
+		 * propagation azimuth is not changed meanwhile.  Below the lowest altitude
+		 * the surface values and zero derivatives are returned, as in the
+		 * single-variable accessors.
+		 * @param z The altitude
+		 * @param cursor The caller's interval cache
+		 * @param f Output values, indexed by SPLINE_T ... SPLINE_CEFF
+		 * @param df Output first derivatives, or null
+		 * @param ddf Output second derivatives, or null
+		 */
+		virtual void evaluate( double z, ProfileSplineCursor &cursor, double *f,
+			double *df = 0, double *ddf = 0 ) const;
+		const ProfileSpline *spline() const;
+		
 		virtual double z0();
 		//virtual unsigned int firstValidIndex();
 		virtual double z( unsigned int zind ) const;
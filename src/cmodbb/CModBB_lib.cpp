@@ -4,6 +4,8 @@
 #include <fftw3.h>
 #include "anyoption.h"
 #include "CModBB_lib.h"
+#include "BroadbandSynthesis.h"
+#include "DispersionStore.h"
 
 using namespace NCPA;
 using namespace std;
@@ -82,6 +84,22 @@ int readDispersion_cbb_ascii(string filen, double *f_vec, int *mode_count, \
 }
 
 
+int readDispersion_cbb_store(string filen, double *f_vec, int *mode_count, \
+								double *prho_zsrc, double *prho_zrcv, complex<double> **kc, \
+								complex<double> **mode_S, complex<double> **mode_R)
+{
+  // same as readDispersion_cbb_ascii() for a dispersion container;
+  // the arrays must hold getNfreq() frequencies
+  int n;
+  ComplexModeSet modes(mode_count, kc, mode_S, mode_R);
+
+  printf("Reading dispersion container %s\n", filen.c_str());
+  n = readDispersionStore(filen, modes, 0, f_vec, prho_zsrc, prho_zrcv, MAX_MODES);
+  printf("Found modes at %d positive frequencies in file %s\n",n, filen.c_str());
+  return 0; 
+}
+
+
 int count_rows_arbcol(const char *filename) {
   int answer,c;
   FILE *f=fopen(filename,"r");
@@ -133,91 +151,6 @@ double half_hann(int begin,int end,int i) {
 }
 
 
-// 20130710 - 'fft_pulse_prop' with comments; has complex<double> **kc parameter
-void fft_pulse_prop(double t0, int n_freqs, double df, double *f_vec, \
-                    double range, complex<double> *dft_vec, \
-                    complex<double> *pulse_vec, \
-                    int *mode_count, double rho_zsrc, double rho_zrcv, \
-                    complex<double> **kc, \
-                    complex<double> **mode_S, complex<double> **mode_R)
-{
-  int i,i0,j,smooth_space;
-  double sqrt_rho_ratio = sqrt(rho_zrcv/rho_zsrc);
-  complex<double> cup,pot,k_H,mode_prod,t_phase,*arg_vec;
-  complex<double> I (0.0, 1.0);
-  complex<double> expov8pir = I*exp(-I*Pi*0.25)/sqrt(8.0*Pi*range);
-  
-  fftw_plan p;
-
-  if(FFTN < n_freqs){
-      throw invalid_argument("fft too short (i.e. FFTN < n_freqs), exiting.");
-  }
-  
-  arg_vec = new complex<double> [FFTN];
-
-  for(i=0;i*df<f_vec[0];i++) arg_vec[i]=0.0; // left zero pad up to f_min present in the spectrum;
-  //printf("in fft_pulse_prop:f_vec[0] = %f; df = %f; i=%d\n", f_vec[0], df, i);
-
-  i0 = i;
-  for(i=0;i<n_freqs;i++){
-      t_phase=exp(-I*2.0*Pi*f_vec[i]*t0); // corresponding to reduced time t0
-      cup=0.0;
-      for(j=0;j<mode_count[i];j++){
-          k_H = kc[i][j];
-          pot = exp(I*range*k_H);
-          mode_prod = mode_S[i][j]*mode_R[i][j];
-          pot = mode_prod*pot;
-          pot = pot/sqrt(k_H);
-          cup = cup+pot; // modal sum: sum( exp(ikr)/sqrt(k)*Vr*Vs )
-      }
-      cup=cup*t_phase;
-      
-      // up to a factor ((delayed Fourier pressure component)*source_spectrum*df) 
-      // (see eq. 5.14 pg 274 and eq. 8.9 pg 480 in Comp. Oc. Acoust. 1994 ed.)
-      cup=cup*dft_vec[i]*df;
-
-      // the reduced pressure is defined as: 
-      // (actual pressure)/sqrt(rho(z)): p_reduced(r,z) = p(r,z)/sqrt(rho(z))
-
-      // Note on mode scaling in this code vs. the modes in Computational Oc. Acoust. 1994: 
-      // V_book =  sqrt(rho)*V_in_this_code; 
-      // Thus the formula for the Fourier component of pressure using the modes in this code
-      // is given in DV Modess notes eq. 25 pg. 3 and contains the factor sqrt_rho_ratio
-      // as opposed to the factor 1/rho(z_s) in the book eq. 5.14 pg 274.
-      arg_vec[i0+i] = expov8pir*cup*sqrt_rho_ratio; // note sqrt_rho_ratio
-      //cout << "i=" << i << "; arg_vec[i0+i] = " << arg_vec[i0+i] << ";  range=" << range << ";  expov8pir=" << expov8pir << endl;
-  }
-
-  smooth_space=(int)floor(0.1*n_freqs); // smoothly zero out on right; as in RW (July 2012)
-
-  for(i=n_freqs-smooth_space;i<n_freqs;i++){
-      arg_vec[i]=arg_vec[i]*half_hann(n_freqs-smooth_space,n_freqs-df,i);
-  }
-  for(;i<FFTN;i++) arg_vec[i]=0.0; // right zero pad
-  
-  // save arg_vec for debugging purposes
-  if (0) {
-      FILE *fp = fopen("arg_vec.dat", "w");
-      for (i=0; i<FFTN; i++) {
-          fprintf(fp, "%12.6f %15.6e %15.6e\n", i*df, real(arg_vec[i]), imag(arg_vec[i]));
-      }
-      fclose(fp);
-      printf("arg_vec saved in file 'arg_vec.dat' with format: i*df | Re(arg_vec) | Im(arg_vec)\n");
-  }
-   
-  // 
-  //perform fft of arg_vec to obtain the propagated time domain pulse
-  //
-  p=fftw_plan_dft_1d(FFTN, reinterpret_cast<fftw_complex*>(arg_vec), \
-												   reinterpret_cast<fftw_complex*>(pulse_vec), \
-												   FFTW_FORWARD,FFTW_ESTIMATE); 												 
-  fftw_execute(p); 
-  fftw_destroy_plan(p);
-  delete [] arg_vec;
-}  // end of debug version of 'fft_pulse_prop'
-
-
-// the source spectrum is loaded/computed in this function
 int get_source_spectrum( \
 								int n_freqs, double f_step, double *f_vec, double f_center, \
 								complex<double> *dft_vec, complex<double> *pulse_vec, \
@@ -381,7 +314,7 @@ int pulse_prop_src2rcv_grid2(\
 					int n_freqs, double f_step, double *f_vec, \
 					double f_center, int *mode_count, double rho_zsrc, double rho_zrcv, \
 					complex<double> **kc, complex<double> **mode_S, complex<double> **mode_R, \
-					int src_flg, string srcfile, int pprop_src2rcv_flg) 
+					int src_flg, string srcfile, int pprop_src2rcv_flg, bool packed_flg) 
 {
   int i,n;
   double rr, tskip, fmx, t0;	
@@ -398,6 +331,11 @@ int pulse_prop_src2rcv_grid2(\
   
   get_source_spectrum(n_freqs,  f_step, f_vec,  f_center, \
 								      dft_vec, pulse_vec, arg_vec, src_flg,  srcfile);
+
+  // the modal data are packed once for all the ranges (unless --synthesis_form direct)
+  ComplexModeSet modes(mode_count, kc, mode_S, mode_R);
+  BroadbandSynthesis<ComplexModeSet> synth(modes, n_freqs, FFTN, f_step, f_vec, rho_zsrc, rho_zrcv, \
+                                           packed_flg);
 								      
 	
 	if (pprop_src2rcv_flg) { // propagation to one receiver at distance RR from source
@@ -408,9 +346,7 @@ int pulse_prop_src2rcv_grid2(\
 	    //
 	    // fft propagation: note that here 'pulse_vec' is rewritten with the propagated pulse
 	    //							
-      fft_pulse_prop( t0, n_freqs, f_step, f_vec, R_start, \
-								      dft_vec, pulse_vec, mode_count, rho_zsrc, rho_zrcv, \
-								      kc, mode_S, mode_R);
+      synth.propagate( t0, R_start, dft_vec, pulse_vec );
 	
       // save propagated pulse to file
 	    // DV 20150930 - factor of two necessary because we only used 
@@ -454,9 +390,7 @@ int pulse_prop_src2rcv_grid2(\
           t0=tskip+rr/max_cel;
           printf("%8.3f     %9.3f      %9.3f\n", max_cel, t0, rr/1000.0);
 
-          fft_pulse_prop( t0, n_freqs, f_step, f_vec, rr, \
-					            dft_vec, pulse_vec, mode_count, rho_zsrc, rho_zrcv, kc, \
-					            mode_S, mode_R);
+          synth.propagate( t0, rr, dft_vec, pulse_vec );
 							              
           for(i=0;i<FFTN;i++){
               //fprintf(f,"%10.3f %12.6f %15.6e\n", rr/1000.0, 1.0*i/fmx, real(pulse_vec[i]));
@@ -470,6 +404,8 @@ int pulse_prop_src2rcv_grid2(\
       printf("Propagation results saved in file: %s\n", filename);
       printf("with columns: R (km) | time (s) | pulse(R,t) |\n");
   }
+  printf("Modal sums (%s form, FFT excluded): %g s\n", \
+         packed_flg ? "packed" : "direct", synth.sumSeconds());
 
   delete [] dft_vec;
   delete [] arg_vec;
@@ -571,150 +507,6 @@ int plotInitialPulse(int src_flg, double freq, double fmax) {
 */
 
 
-int getFile_list(string dir, list<string> &files, string pattern)
-{
-  int pos = -1;
-  string a;
-  DIR *dp;
-  struct dirent *dirp;
-  if((dp = opendir(dir.c_str())) == NULL) {
-      std::ostringstream es;
-      es << "Error opening directory:" << dir;
-      throw invalid_argument(es.str());
-  }
-
-  while ((dirp = readdir(dp)) != NULL) {
-      a = string(dirp->d_name);
-      pos = a.find(pattern);
-      if (pos>=0) {
-          //cout << a << " pos=" << pos << endl;
-          files.push_back(string(dirp->d_name));
-      }
-      else {
-          //cout << "this file does not fit pattern: " << a << endl;
-      }
-  }
-  closedir(dp);
-  return 0;
-}
-
-
-complex<double> ***getPz1z2 (int I1, int I2, double r1, double r2, double dr, string dirn, list<string> files)
-{
-  // read from files created with writeDispersion_cbb_bin()
-
-  int lenI, ier;
-  int ir, j, jj, iz;
-  int Nfreq, Nz_grid, Nz_subgrid, NN, nmods;
-  int Nrng_steps = (int) (r2-r1)/dr+1;  
-
-  double rho_zsrc, *rho_rcv, sqrtrho;
-  double *kr, *ki;
-  double *Re_vs, *Im_vs, **Re_vr, **Im_vr;
-  double rr, df, dz, delZ, z_min, freq;
-  complex<double> kH, epio8, epio8ovr, sumM;
-  complex<double> II (0.0, 1.0);
-  complex<double> ***Pfzr;  
-  FILE *fp;
-  list<string>::iterator it;  
-
-  int    szi = sizeof(int);
-  double szd = sizeof(double);
-  int Nfiles = files.size();
-  std::string fullname;
-
-  lenI  = I2-I1+1;
-  epio8 = II*exp(-II*(Pi/4.0))/sqrt(8.0*Pi);
-
-  // allocate 3-rank tensor
-  Pfzr = c3Darray(Nfiles, Nrng_steps, lenI);
-
-  // iterate over sorted file list
-  jj = 0;
-  for (it=files.begin(); it!=files.end(); ++it) {
-  
-      cout << "Iteration " << jj << "; processing file: " << (*it) << endl;
-
-      fullname = dirn + "/" + (*it);
-      fp = fopen(fullname.c_str(), "r");
-      if (fp==NULL) {
-          std::ostringstream es;
-          es << "file << " << fullname << " could not be opened.\n";
-          throw invalid_argument(es.str());
-      }
-
-      // read 4(ints) + 6(doubles) = 4*4+6*8 = 64 bytes
-      ier = fread(&freq,       szd, 1, fp);
-      ier = fread(&nmods,      szi, 1, fp);		
-      ier = fread(&Nfreq,      szi, 1, fp);
-      ier = fread(&df,         szd, 1, fp);
-      ier = fread(&Nz_grid,    szi, 1, fp);
-      ier = fread(&dz,         szd, 1, fp);      
-      ier = fread(&Nz_subgrid, szi, 1, fp);
-      ier = fread(&delZ,       szd, 1, fp);
-      ier = fread(&z_min,      szd, 1, fp);
-      ier = fread(&rho_zsrc,   szd, 1, fp);
-      
-      NN = Nz_grid/Nz_subgrid; // integer division
-
-      if (nmods>0) {
-          kr      = new double [nmods];
-          ki      = new double [nmods];
-          Re_vs   = new double [nmods]; // holds the real value of each mode at source height
-          Im_vs   = new double [nmods]; // holds the imag value of each mode at source height
-          rho_rcv = new double [lenI];
-          Re_vr   = dmatrix(lenI, nmods);
-          Im_vr   = dmatrix(lenI, nmods);
-
-          // have read 4(ints) + 6(doubles) = 4*4+6*8 = 64 bytes so far
-          // now read the wavenumbers and mode values at src height 
-          ier = fread(kr,    szd, nmods, fp);
-          ier = fread(ki,    szd, nmods, fp);
-          ier = fread(Re_vs, szd, nmods, fp);
-          ier = fread(Im_vs, szd, nmods, fp);
-
-          // at each z on the z-subgrid we saved (2*nmods+1) doubles i.e.
-          // we offset to the requested altitude specified by I1: I1*(2*nmods+1)*szd bytes
-          fseek(fp, (I1)*(2*nmods+1)*szd, SEEK_CUR);
-            
-          for (iz=0; iz<lenI; iz++) { // at each z level reading (nmods+1)*szd bytes
-              ier = fread(&rho_rcv[iz], szd, 1, fp);  // read rho at all subgrid heights
-              ier = fread(Re_vr[iz], szd, nmods, fp); // read real part of all modes at all subgrid heights
-              ier = fread(Im_vr[iz], szd, nmods, fp); // read imag part of all modes at all subgrid heights
-          }
-
-          rr = r1;
-          for (ir=0; ir<Nrng_steps; ir++) {
-              epio8ovr = epio8/sqrt(rr*rho_zsrc);
-              for (iz=0; iz<lenI; iz++) {
-                  sumM = complex<double> (0.0, 0.0);
-                  sqrtrho = sqrt(rho_rcv[iz]);
-                  for (j=0; j<nmods; j++) {
-                      kH =  kr[j] + II*ki[j];							
-                      //sumM += vs[j]*vr[iz][j]*sqrtrho*exp(II*kH*rr)/sqrt(kH);
-                      sumM += (Re_vs[j]+II*Im_vs[j])*(Re_vr[iz][j]+II*Im_vr[iz][j])*sqrtrho*exp(II*kH*rr)/sqrt(kH);
-                  }
-                  Pfzr[jj][ir][iz] = epio8ovr*sumM;
-              }
-              rr = rr + dr;
-          }
-
-          delete[] kr;
-          delete[] ki;
-          delete[] Re_vs;
-          delete[] Im_vs;
-          delete[] rho_rcv;
-          free_dmatrix(Re_vr,lenI,nmods);
-          free_dmatrix(Im_vr,lenI,nmods);
-      }
-      fclose(fp);
-      jj++;
-  } // end for loop by files
-  //printf(" ... Pfzr done.\n");
-  return Pfzr;
-}
-
-
 /*
 complex<double> **cmatrix(long nr, long nc) {
   // allocate a complex<double> matrix
@@ -785,193 +577,48 @@ void free_c3Darray(complex<double> ***data, size_t xlen, size_t ylen)
 }
 */
 
-// comparison, freq in filename.
-bool compare_freq (string first, string second)
-{
-  string a, b;
-  string patt1 ("_");
-  string patt2 ("_nm.bin");
-  size_t pos1, pos2;
-  double x, y;
-    
-  pos2 = first.find(patt2);
-  pos1 = first.rfind(patt1, pos2-1) + patt1.length();
-  
-  a = first.substr(pos1, pos2-pos1);
-  b = second.substr(pos1, pos2-pos1);
-  
-  x = strtod(a.c_str(), NULL);
-  y = strtod(b.c_str(), NULL);
-
-  if (x<y) {return true; }
-  else     {return false;}
-}
-
-
 int process2DPressure(double R_start_km, double width_km, double height_km, \
                       double c_ref, double tmstep, int ntsteps, double f_center, \
                       string framefn, string dirn) 
 {
   // compute the 2D spatial pressure field in (width_km by height_km) window 
-  // starting at R_start_km
-  // cout << "in process2DPressure():\n";
-  
-  char   filename [256]; // holds the frame file name(s)
-  int    i, j, ier, m, n, k, Nx, Nz, NN, zs;
-  int    I1, I2, lenI;
-  int    Nfreq, Nz_grid, Nz_subgrid, nmods, Nfiles;
-  double tmin, tmax, tt;
-  double freq, fr, df, f_max, scale;	
-  double dz, delZ, z_min;
-  double r1, r2, dr, sumP;
-  double **pp;
-
+  // starting at R_start_km; the frames are written by the code shared with
+  // ModBB (see BroadbandSynthesis.h)
+  int    i, Nfreq;
+  double df, f_max, scale;
   complex<double> *S; //source spectrum
-  complex<double> II = complex<double> (0.0, 1.0);	
-  complex<double> ***Pfzr;
-  string fullname;
-  FILE *fp;
-
-  list<string> files;
-  list<string>::iterator it;
-  string pattern (".bin");
-
-  // get and sort the files (they have the frequency in the name)
-  getFile_list(dirn, files, pattern);
-  files.sort(compare_freq);
-
-  if (0) { //print the sorted file list
-      cout << "sorted list contains:" << endl;
-      for (it=files.begin(); it!=files.end(); ++it) {
-          cout << *it << endl;
-      }
-      cout << endl;
-  }
-  
-  // get necessary info from 1 file
-  fullname = dirn + "/" + (*files.begin());
-  fp = fopen(fullname.c_str(), "r");
-  if (fp==NULL) {
-        std::ostringstream es;
-        es << "file << " << fullname << " could not be opened.";
-        throw invalid_argument(es.str());
-  }
-  ier = fread(&freq,       sizeof(double), 1, fp);
-  ier = fread(&nmods,      sizeof(int),    1, fp);		
-  ier = fread(&Nfreq,      sizeof(int),    1, fp);
-  ier = fread(&df,         sizeof(double), 1, fp);
-  ier = fread(&Nz_grid,    sizeof(int),    1, fp);
-  ier = fread(&dz,         sizeof(double), 1, fp);  
-  ier = fread(&Nz_subgrid, sizeof(int),    1, fp);
-  ier = fread(&delZ,       sizeof(double), 1, fp);
-  ier = fread(&z_min,      sizeof(double), 1, fp);
-  fclose(fp);
 
+  NCPA::DispersionGrid grid(dirn, 2);
+  Nfreq = grid.getNfreq();
+  df    = grid.getF_step();
   f_max = Nfreq*df; // fmax
-  Nfiles = files.size();
-  
-  cout << "Nfiles    = " << Nfiles << endl;
-  cout << "Nfreq     = " << Nfreq  << endl;
-  cout << "max freq  = " << f_max  << endl;
-  cout << "delta_Z   = " << delZ   << endl;
-  cout << "freq step = " << df     << endl;
-
-  if (Nfreq != Nfiles) {
-      throw invalid_argument("Error: number of frequencies is not equal to the number of files" );
-  }
+
+  cout << "Nfiles    = " << Nfreq        << endl;
+  cout << "Nfreq     = " << Nfreq        << endl;
+  cout << "max freq  = " << f_max        << endl;
+  cout << "delta_Z   = " << grid.getDelZ() << endl;
+  cout << "freq step = " << df           << endl;
 
   // compute the source spectrum using Roger's pulse
-  S = new complex<double> [Nfreq]; 
   if ((5*f_center - f_max)>1.0E-16) {
       cout << "f_max    = " << f_max    << " Hz" << endl;
       cout << "f_center = " << f_center << " Hz" << endl;
       throw invalid_argument("f_center must be at least 5 times smaller than f_max.");
   }
+  S = new complex<double> [Nfreq]; 
   scale = 1.0/f_center;
   for(i=0; i<Nfreq; i++) {
       S[i]=pulse_spec_fit(scale,(i+1)*df);
   }
 
-  // the subgrid (window) parameters
-  r1   = R_start_km*1000;
-  r2   = r1 + width_km*1000;
-  dr   = delZ;          // make horizontal spacing equal to the vertical spacing
-  Nx   = (int)((r2-r1)/dr)+1;
-  Nz   = (int) (height_km*1000.0/delZ)+1;
-  tmin = r1/c_ref;
-  tmax = r2/c_ref;
-
-  // check if enough memory is available; if not, will iterate more than once
-  long maxel = 4000000; // maximum number of elements in the window (matrix)
-  zs = Nz;              // zs = how many z-levels to be processed at a time; 
-  NN = 0;               // NN is number of iterations-1  (see loop below)
-  if (Nx*zs>maxel) {    // zs is adjusted down when not enough memory is available 
-      NN  =(Nx*zs)/maxel + 1;  // integer division (floor)
-      zs = zs/NN;              // integer division    
-  }
-
-  pp = dmatrix(zs,Nx); // allocate 2D pressure field
-  tt = tmin;
-  //cout <<"Computing the 2D pressure field..." << endl;
-  for (j=0; j<NN+1; j++) { // loop to get pressure spectrum at points on the jth subgrid of size [zs, Nx]
-      I1   = j*zs;         // zero-based index to pass to getPz1z2()
-      I2   = min(Nz-1, I1+zs-1);
-      lenI = I2-I1+1;
-      cout << "iteration = " << j+1 << " of " << NN+1 << endl;
-      
-      // get pressure field from height z(I1) to z(I2)
-      Pfzr = getPz1z2(I1, I2, r1, r2, dr, dirn, files); //Pfzr = c3Darray(Nfiles, Nrng_steps, lenI);
-			
-      for (k=0; k < ntsteps; k++) { // iterate over time steps
-          tt = tmin + k*tmstep;
-          sprintf(filename, "%s_%d.bin", framefn.c_str(), (int)floor(tt)); // filename
-
-          if (j==0)	{ // info in the file header - appears only once
-              fp = fopen(filename, "a+b");			
-              fwrite(&Nz,   1, sizeof(int),    fp);
-              fwrite(&Nx,   1, sizeof(int),    fp);
-              fwrite(&delZ, 1, sizeof(double), fp);
-              fwrite(&r1,   1, sizeof(double), fp);							
-              fwrite(&tt,   1, sizeof(double), fp);
-              fclose(fp);
-          }
-          for (n=0; n<Nx; n++) {       // for ranges on the x-grid
-              for (m=0; m<lenI; m++) { // for altitudes on z-grid							
-                  fr       = 0.0;
-                  sumP     = 0.0;
-                  pp[m][n] = 0.0;
-                  for (i=0; i<Nfreq; i++) { //integral over all positive frequencies to get pressure at (x,y,tt)
-		                  fr   = fr + df;
-		                  sumP = sumP + real(2.0*df*S[i]*Pfzr[i][n][m]*exp(-II*2.0*Pi*fr*tt));						
-                  }
-                  pp[m][n] = sumP;
-              }
-          }
-          cout << " ... saving 2D field at time " << tt << " secs to file " << filename << endl;
-          saveMatrix2bin(filename, pp, lenI, Nx);
-      }
-      free_c3Darray(Pfzr, Nfiles, Nx);		
-  }
+  NCPA::writePressureFrames(grid, S, R_start_km, width_km, height_km, c_ref, \
+                            tmstep, ntsteps, framefn, false);
 
   delete [] S;
-  free_dmatrix(pp, zs, Nx);
   return 0;
 }
 
 
-int saveMatrix2bin(const char *filename, double **M, int nr, int nc) {
-  int i,j, szd;
-  szd = sizeof(double);
-  FILE *fp = fopen(filename, "a+b");
-  for (i=0; i<nr; i++) {
-      for (j=0; j<nc; j++) {
-          fwrite(&M[i][j], szd, 1, fp);
-      }
-  }
-  fclose(fp);
-  return 0;
-}
-
 int saveAtm_profile(NCPA::SampledProfile *p, std::string wind_units) {
   int i, nz;
   double z, u, v, c, ceff, azi_rad; //dz_km; 
@@ -1,6 +1,7 @@
 #include "Atmosphere.h"
 #include <complex>
 #include <list>
+#include "DispersionStore.h"
 
 /*
 double **dmatrix(long nr, long nc);
@@ -20,6 +21,11 @@ int writeDispersion_bb_ascii(string filen, int Nz, double delZ, int NN, int sele
 int readDispersion_cbb_ascii(string filen, double *f_vec, int *mode_count, \
 								double *prho_zsrc, double *prho_zrcv, complex<double> **re_k, \
 								complex<double> **mode_S, complex<double> **mode_R);
+
+// the same for a dispersion container (see DispersionStore.h)
+int readDispersion_cbb_store(string filen, double *f_vec, int *mode_count, \
+								double *prho_zsrc, double *prho_zrcv, complex<double> **kc, \
+								complex<double> **mode_S, complex<double> **mode_R);
 					
 
 int count_rows_arbcol(const char *filename);								
@@ -43,14 +49,6 @@ int SolveModesBB(string filename, int Nfreq, double f_min, double fmax, int Nz_g
 double half_hann(int begin,int end,int i);
 
 
-void fft_pulse_prop(double t0, int n_freqs, double df, double *f_vec, \
-                    double range, complex<double> *dft_vec, \
-                    complex<double> *pulse_vec, \
-                    int *mode_count, double rho_zsrc, double rho_zrcv, \
-                    complex<double> **kc, \
-                    complex<double> **mode_S, complex<double> **mode_R);                    								
-                    
-								
 int pulse_prop(	const char *filename,double t0,double RR,  \
 								int n_freqs, double f_step, double *f_vec, double scale, \
 								int *mode_count, double rho_zsrc, double rho_zrcv, \
@@ -63,7 +61,7 @@ int pulse_prop_src2rcv_grid2(\
 					int n_freqs, double f_step, double *f_vec, \
 					double f_center, int *mode_count, double rho_zsrc, double rho_zrcv, \
 					complex<double> **kc, complex<double> **mode_S, complex<double> **mode_R, \
-					int src_flg, string srcfile, int pprop_src2rcv_flg);
+					int src_flg, string srcfile, int pprop_src2rcv_flg, bool packed_flg);
 
 int get_source_spectrum( \
 								int n_freqs, double f_step, double *f_vec, double f_center, \
@@ -76,19 +74,10 @@ complex<double> pulse_spec_fit(double scale, double x);
 
 //int plotInitialPulse(int src_flg, double freq, double fmax);
 
-int getFile_list(string dir, list<string> &files, string pattern);	
-
-complex<double> ***getPz1z2 (int I1, int I2, double r1, double r2, double dr, string dirn, list<string> files);
-
-// comparison, freq in filename.
-bool compare_freq (string first, string second);
-
 int process2DPressure(double R_start_km, double width_km, double height_km, \
 											double c_ref, double tmstep, int ntsteps, double f_center, \
 											string framefn, string dir_name);
 
-int saveMatrix2bin(const char *filename, double **M, int nr, int nc);
-
 int saveAtm_profile(NCPA::SampledProfile *p, std::string wind_units);
 
 int load_source_pulse_td(std::string srcpulsetdfn, vector<double> &t, vector<double> &tdp );
@@ -47,6 +47,7 @@ int main( int argc, char **argv ) {
   // flags related to writing dispersion file(s)
   bool   w_disp_src2rcv_flg;
   bool   w_disp_flg;
+  bool   disp_container_flg;
   //bool   usemodess_flg;
 
   // flags related to pulse propagation
@@ -61,6 +62,7 @@ int main( int argc, char **argv ) {
   // get dispersion / propagation flags
   w_disp_src2rcv_flg   = oBB->getW_disp_src2rcv_flg();
   w_disp_flg           = oBB->getW_disp_flg();
+  disp_container_flg   = oBB->getDisp_container_flg();
   pprop_grid_flg       = oBB->getPprop_grid_flg();
   pprop_s2r_flg        = oBB->getPprop_s2r_flg();
   pprop_s2r_grid_flg   = oBB->getPprop_s2r_grid_flg();
@@ -136,7 +138,7 @@ int main( int argc, char **argv ) {
       a = new SolveCModBB( out_disp_file, atmosfile, wind_units, atm_profile, Nfreq, \
                           f_min, f_step, f_max, Nz_grid, azi, z_min, \
                           maxheight, sourceheight, receiverheight, gnd_imp_model, \
-									        Lamb_wave_BC, w_disp_flg,  w_disp_src2rcv_flg);
+									        Lamb_wave_BC, w_disp_flg,  w_disp_src2rcv_flg, disp_container_flg);
 				         	 					 
       // solve for modes/ loop over frequencies (broadband) - main action happens here					 
       a->computeCModes();	
@@ -166,7 +168,14 @@ int main( int argc, char **argv ) {
       //cout << "pprop_s2r_disp_file = " << pprop_s2r_disp_file << endl;	
 
       // get number of (positive) frequencies from the dispersion file
-      Nfreq = count_rows_arbcol(pprop_s2r_disp_file.c_str());
+      bool disp_store = NCPA::DispersionStoreReader::isStore(pprop_s2r_disp_file);
+      if (disp_store) {
+          NCPA::DispersionStoreReader store(pprop_s2r_disp_file);
+          Nfreq = store.getNfreq();
+      }
+      else {
+          Nfreq = count_rows_arbcol(pprop_s2r_disp_file.c_str());
+      }
 
       f_vec      = new double [Nfreq];
       mode_count = new int [Nfreq];
@@ -175,8 +184,14 @@ int main( int argc, char **argv ) {
       mode_R     = cmatrix(Nfreq, MAX_MODES);
       
       // read the dispersion file
-      readDispersion_cbb_ascii(pprop_s2r_disp_file, f_vec, mode_count, \
+      if (disp_store) {
+          readDispersion_cbb_store(pprop_s2r_disp_file, f_vec, mode_count, \
+                                   &rho_zsrc, &rho_zrcv, kc, mode_S, mode_R);
+      }
+      else {
+          readDispersion_cbb_ascii(pprop_s2r_disp_file, f_vec, mode_count, \
 											        &rho_zsrc, &rho_zrcv, kc, mode_S, mode_R);							        
+      }
 											        															
       f_step   = f_vec[1] - f_vec[0];
       max_cel  = oBB->getMax_celerity();											      											        				  
@@ -191,7 +206,8 @@ int main( int argc, char **argv ) {
 											          R_start, DR, R_end, Nfreq, f_step, f_vec, \
 											          f_center, mode_count, rho_zsrc, rho_zrcv, \
 											          kc, mode_S, mode_R, \
-											          src_flg, src_file, pprop_s2r_flg);      
+											          src_flg, src_file, pprop_s2r_flg, \
+											          !oBB->getSynthesis_form().compare("packed"));      
       
       // temporary plotInitialPulse
       //if (oBB->getPlot_flg())  {
@@ -330,6 +346,13 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( " --Lamb_wave_BC            For a rigid ground: if ==1 it sets" );
   opt->addUsage( "                           admittance= = -1/2*dln(rho)/dz; [ 0 ]" );
 	opt->addUsage( " --wind_units              Use it to specify 'kmpersec' if the winds are given in km/s [mpersec]" ); 	
+  opt->addUsage( " --dispersion_container    Flag to write all frequencies to one indexed binary" );
+  opt->addUsage( "                           file, named by --out_disp_src2rcv_file or" );
+  opt->addUsage( "                           --out_dispersion_files, instead of an ascii file" );
+  opt->addUsage( "                           or one file per frequency. A rerun on the same" );
+  opt->addUsage( "                           container skips the frequencies it already holds." );
+  opt->addUsage( "                           The pulse propagation options accept the container" );
+  opt->addUsage( "                           in place of the dispersion file or directory." );
   opt->addUsage( "" );
   		
   opt->addUsage( "Options for PULSE PROPAGATION:" );
@@ -353,6 +376,8 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( " OPTIONAL [defaults]:" );
   opt->addUsage( " --f_center         The center frequency of the pulse; must be <= [f_max/5]." );
   opt->addUsage( " --max_celerity     Maximum celerity [300 m/s]." );	
+  opt->addUsage( " --synthesis_form   packed: modal sum terms computed once for all ranges;" );
+  opt->addUsage( "                    direct: recomputed at every range (for timing) [packed]." );
   opt->addUsage( "" );	   
   opt->addUsage( "" );
   opt->addUsage( "SOURCE TYPE options: Use one of the following 4 options to specify the source:" );
@@ -428,6 +453,7 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->setFlag( "get_impulse_resp" );
   opt->setFlag( "use_builtin_pulse" );  
   opt->setFlag( "plot" );
+  opt->setFlag( "dispersion_container" );
     
   opt->setOption( "atmosfile" );
   opt->setOption( "atmosfileorder" );
@@ -456,6 +482,7 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->setOption( "R_end_km" );
   opt->setOption( "DR_km" );
   opt->setOption( "max_celerity" );
+  opt->setOption( "synthesis_form" );
   opt->setOption( "range_R_km" );
   opt->setOption( "out_dispersion_files" );
   opt->setOption( "out_disp_src2rcv_file" );
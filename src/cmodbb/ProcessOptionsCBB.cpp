@@ -31,6 +31,7 @@ NCPA::ProcessOptionsCBB::ProcessOptionsCBB(AnyOption *opt)
   wind_units     = "mpersec";  // m/s
   Nfreq          = 1;          // a default number of frequencies
   srcfile        = "";
+  synthesis_form = "packed";   // modal sum terms packed once for all ranges
   f_center       = -1; // must have negative initialization value; 
 		                   // used later to decide if f_center is reset by input option
 		                   // used for built-in pulse  
@@ -52,6 +53,9 @@ NCPA::ProcessOptionsCBB::ProcessOptionsCBB(AnyOption *opt)
       out_disp_file.assign(opt->getValue( "out_dispersion_files" ));
       cout << "out_dispersion_files = " << out_disp_file << endl;
   }
+
+  // all frequencies in one indexed file named by the option above
+  disp_container_flg = opt->getFlag( "dispersion_container" );
   
   // handle options for pulse propagation
   pprop_grid_flg = 0;
@@ -207,6 +211,15 @@ NCPA::ProcessOptionsCBB::ProcessOptionsCBB(AnyOption *opt)
             }
   }
 
+  // the form of the modal sums in the pulse synthesis
+  if ( opt->getValue( "synthesis_form" ) != NULL ) {
+      synthesis_form = opt->getValue( "synthesis_form" );
+      if (!( !synthesis_form.compare("packed") || !synthesis_form.compare("direct") ) ) {
+          delete opt;
+          throw invalid_argument("Bad synthesis_form: it can only be packed or direct.");
+      }
+  }
+
   //
   // logic to handle either computing the dispersion and modal values 
   // or to propagate a pulse
@@ -473,6 +486,10 @@ bool   NCPA::ProcessOptionsCBB::getW_disp_flg() {
   return w_disp_flg;
 }
 
+bool   NCPA::ProcessOptionsCBB::getDisp_container_flg() {
+  return disp_container_flg;
+}
+
 std::string   NCPA::ProcessOptionsCBB::getPprop_grid_dirname() {
   return pprop_grid_dirname;
 }
@@ -625,6 +642,10 @@ std::string   NCPA::ProcessOptionsCBB::getSrcfile() {
   return srcfile;
 }
 
+std::string   NCPA::ProcessOptionsCBB::getSynthesis_form() {
+  return synthesis_form;
+}
+
 int    NCPA::ProcessOptionsCBB::getSrc_flg() {
   return src_flg;
 }
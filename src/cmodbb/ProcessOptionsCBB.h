@@ -20,9 +20,11 @@ namespace NCPA {
       string getPprop_grid_dirname();
       string getFrame_file_stub();
       string getSrcfile(); 
+      string getSynthesis_form();
        
       bool   getW_disp_src2rcv_flg();
       bool   getW_disp_flg();
+      bool   getDisp_container_flg();
       bool   getPprop_grid_flg();
       bool   getPprop_s2r_flg();
       bool   getPprop_s2r_grid_flg();
@@ -69,9 +71,11 @@ namespace NCPA {
       string wind_units;      // default mpersec
       string gnd_imp_model;   // ("rigid");
       string srcfile;         // file name of the user-provided source spectrum or source waveform          
+      string synthesis_form;  // packed or direct modal sums in the pulse synthesis
       
       bool   w_disp_src2rcv_flg;
       bool   w_disp_flg;
+      bool   disp_container_flg;  // write the dispersion data to one container file
       bool   pprop_grid_flg;
       bool   pprop_s2r_flg;	
       bool   pprop_s2r_grid_flg;
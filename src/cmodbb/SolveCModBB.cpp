@@ -12,6 +12,7 @@
 #include "Atmosphere.h"
 #include "anyoption.h"
 #include "SolveCModBB.h"
+#include "BroadbandSynthesis.h"
 #include "slepceps.h"
 #include "slepcst.h"
 
@@ -30,11 +31,11 @@ NCPA::SolveCModBB::SolveCModBB( \
           int Nfreq, double f_min, double f_step, double f_max, int Nz_grid, double azi, \
           double z_min, double maxheight, double sourceheight, double receiverheight, \
           string gnd_imp_model, int Lamb_wave_BC, \
-          bool out_dispersion, bool out_disp_src2rcv)
+          bool out_dispersion, bool out_disp_src2rcv, bool disp_container)
 {
   setParams(  filename, atmosfile, wind_units, atm_profile, Nfreq, f_min, f_step, f_max, \
               Nz_grid, azi, z_min, maxheight, sourceheight, receiverheight, \
-              gnd_imp_model, Lamb_wave_BC, out_dispersion, out_disp_src2rcv);
+              gnd_imp_model, Lamb_wave_BC, out_dispersion, out_disp_src2rcv, disp_container);
 }
 
 
@@ -57,7 +58,7 @@ void NCPA::SolveCModBB::setParams( \
           int Nfreq1, double f_min1, double f_step1, double f_max1, int Nz_grid1, double azi1, \
           double z_min1, double maxheight1, double sourceheight1, double receiverheight1, \
           string gnd_imp_model1, int Lamb_wave_BC1, \
-          bool out_dispersion1, bool out_disp_src2rcv1)						
+          bool out_dispersion1, bool out_disp_src2rcv1, bool disp_container1)						
 {			
   tol               = 1.0E-8; // tolerance for Slepc computations
   filename          = filename1;
@@ -78,6 +79,7 @@ void NCPA::SolveCModBB::setParams( \
   Lamb_wave_BC      = Lamb_wave_BC1;
   out_dispersion    = out_dispersion1;
   out_disp_src2rcv  = out_disp_src2rcv1;
+  disp_container    = disp_container1;
   
   // get Hgt, zw, mw, T, rho, Pr in SI units; deleted in destructor
   Hgt = new double [Nz_grid];
@@ -159,7 +161,10 @@ void NCPA::SolveCModBB::printParams() {
   printf("Lamb wave boundary cond : %d\n", Lamb_wave_BC);
   printf("  SLEPc tolerance param : %g\n", tol);
   printf("    atmospheric profile : %s\n", atmosfile.c_str());
-  if (out_disp_src2rcv) {
+  if (disp_container) {
+  printf("   dispersion container : %s\n", disp_fn.c_str());
+  }
+  if (out_disp_src2rcv || disp_container) {
   printf("          data saved in : %s\n", disp_fn.c_str());
   } else {
   printf("   data saved in subdir : %s\n", subdir.c_str());
@@ -244,7 +249,12 @@ int NCPA::SolveCModBB::computeCModes() {
   ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size); CHKERRQ(ierr);
   
   FILE *fp = NULL;
-  if (out_disp_src2rcv) {
+  DispersionStoreWriter *store = NULL;
+  if (disp_container) {
+    // opened (or reopened to finish an interrupted run) for all frequencies
+    store = new DispersionStoreWriter(disp_fn, Nfreq, f_min, f_step, sourceheight, receiverheight, 2);
+  }
+  else if (out_disp_src2rcv) {
     // open dispersion file for writing
     fp = fopen(disp_fn.c_str(),"w");
   }
@@ -255,6 +265,10 @@ int NCPA::SolveCModBB::computeCModes() {
   for (int ii = 0; ii<Nfreq; ii++) {
 
       freq = ii*f_step + f_min;
+      if (store != NULL && store->has(ii)) {
+          cout << "Frequency " << freq << " Hz is already in " << disp_fn << endl;
+          continue;
+      }
       cout << "Now processing frequency = " << freq << " Hz" << endl;
 
       // Create the matrix A to use in the eigensystem problem: Ak=kx
@@ -432,7 +446,11 @@ int NCPA::SolveCModBB::computeCModes() {
       //
       // Output data: saving to file(s)
       //
-      if (out_dispersion) {
+      if (store != NULL) {
+          writeDispersion_container(store, ii, freq, select_modes, dz, sourceheight, receiverheight, \
+                                    rho, k_s, v_s, out_dispersion ? NN : 0);
+      }
+      else if (out_dispersion) {
           // printf ("Writing to file: %s at freq = %8.3f Hz...\n", filen.c_str(), freq);
           writeDispersion_cbb_bin( disp_fn, freq, Nfreq, f_step, Nz_grid, z_min, \
                                   Nz_subgrid, delZ, NN, select_modes, dz, \
@@ -454,9 +472,10 @@ int NCPA::SolveCModBB::computeCModes() {
       	
   }	// end BIG LOOP over frequencies
   
-  if (out_disp_src2rcv) {
+  if (fp != NULL) {
     fclose(fp); // close the dispersion file
   }
+  delete store;
 
   // Clean up
   delete[] alpha;
@@ -984,3 +1003,15 @@ int NCPA::SolveCModBB::writeDispersion_cbb_bin(\
   
   return 0;
 }
+
+
+int NCPA::SolveCModBB::writeDispersion_container(\
+					DispersionStoreWriter *store, int ii, double freq, int Nmodes, \
+					double dz, double z_src, double z_rcv, double *rho, \
+					complex<double> *kc, complex<double> **v_s, int NN)
+{
+  // saves the same values as the ascii file and, if NN > 0, rho and the
+  // modes every NN grid points as the binary files (see BroadbandSynthesis.h)
+  return writeDispersionRecord(store, ii, freq, Nmodes, Nz_grid, z_min, dz, z_src, z_rcv, \
+                               rho, kc, v_s, NN);
+}
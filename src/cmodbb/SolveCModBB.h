@@ -6,6 +6,7 @@
 #include "Atmosphere.h"
 #include "anyoption.h"
 #include "CModBB_lib.h"
+#include "DispersionStore.h"
 
 
 namespace NCPA {
@@ -17,7 +18,7 @@ namespace NCPA {
 	        int Nfreq, double f_min, double f_step, double f_max, int Nz_grid, double azi, \
 	        double z_min, double maxheight, double sourceheight, double receiverheight,\
 	        string gnd_imp_model, int Lamb_wave_BC, \
-	        bool out_dispersion, bool out_disp_src2rcv);
+	        bool out_dispersion, bool out_disp_src2rcv, bool disp_container);
 
       ~SolveCModBB(); //destructor
 
@@ -28,7 +29,7 @@ namespace NCPA {
 	        int Nfreq1, double f_min1, double f_step1, double f_max1, int Nz_grid1, double azi1, \
 	        double z_min1, double maxheight1, double sourceheight1, double receiverheight1, \
 	        string gnd_imp_model1, int Lamb_wave_BC1, \
-	        bool out_dispersion1, bool out_disp_src2rcv1);						
+	        bool out_dispersion1, bool out_disp_src2rcv1, bool disp_container1);						
 		
       void printParams();
 
@@ -74,9 +75,17 @@ namespace NCPA {
 					      double dz, double z_src, \
 					      double *rho, complex<double> *kc, complex<double> **v_s);				        			        	
 
+      // one frequency of the dispersion container; the full modes every
+      // NN grid points are included if NN > 0
+      int writeDispersion_container(\
+					      DispersionStoreWriter *store, int ii, double freq, int Nmodes, \
+					      double dz, double z_src, double z_rcv, double *rho, \
+					      complex<double> *kc, complex<double> **v_s, int NN);
+
     private:
       bool   out_dispersion;
       bool   out_disp_src2rcv;
+      bool   disp_container;  // all frequencies in one DispersionStore file
       bool   usemodess_flg;
       
       int    Nfreq;
@@ -0,0 +1,376 @@
+#include "BroadbandSynthesis.h"
+#include "util.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <dirent.h>
+
+using namespace std;
+
+namespace {
+  const double Pi = 3.141592653589793;
+
+  // comparison, freq in filename.
+  bool compare_freq(string first, string second)
+  {
+    string patt1 ("_");
+    string patt2 ("_nm.bin");
+    size_t pos2 = first.find(patt2);
+    size_t pos1 = first.rfind(patt1, pos2-1) + patt1.length();
+
+    double x = strtod(first.substr(pos1, pos2-pos1).c_str(), NULL);
+    double y = strtod(second.substr(pos1, pos2-pos1).c_str(), NULL);
+    return x < y;
+  }
+
+  //
+  // The modal sum of the pressure spectrum at every frequency of grid, for
+  // Nx ranges from r1 every dr and the lenI heights from index I1:
+  //   Pfzr[i][ir][iz] = i exp(-i pi/4)/sqrt(8 pi r rho_src) sqrt(rho(z))
+  //                     * sum_m V_m(z_src) V_m(z) exp(i k_m r)/sqrt(k_m)
+  //
+  template<class ModeSet>
+  complex<double> ***modalPressure(NCPA::DispersionGrid &grid, int I1, int lenI, \
+                                   double r1, double dr, int Nx, bool zero_attn_flg)
+  {
+    int jj, ir, iz, j, nm, stride;
+    double rr, sqrtrho;
+    const double *row;
+    complex<double> kH, epio8, epio8ovr, sumM;
+    complex<double> II (0.0, 1.0);
+    complex<double> ***Pfzr = NCPA::c3Darray(grid.getNfreq(), Nx, lenI);
+    NCPA::DispersionRecord rec;
+
+    epio8 = II*exp(-II*(Pi/4.0))/sqrt(8.0*Pi);
+    for (jj=0; jj<grid.getNfreq(); jj++) {
+        grid.load(jj, I1, lenI, rec);
+        nm = rec.nmodes;
+        if (nm == 0) {
+            continue;
+        }
+        stride = 1 + ModeSet::ncomp*nm;
+        rr     = r1;
+        for (ir=0; ir<Nx; ir++) {
+            epio8ovr = epio8/sqrt(rr*rec.rho_zsrc);
+            for (iz=0; iz<lenI; iz++) {
+                sumM    = complex<double> (0.0, 0.0);
+                row     = rec.rows + (size_t)iz*stride;
+                sqrtrho = sqrt(row[0]);
+                for (j=0; j<nm; j++) {
+                    // 20160717 taking zero_attn_flg into consideration
+                    kH = rec.k_re[j] + (II*rec.k_im[j])*(1.0-(double)zero_attn_flg);
+                    sumM += ModeSet::value(rec.mode_S, nm, j)*ModeSet::value(row+1, nm, j) \
+                            *sqrtrho*exp(II*kH*rr)/sqrt(kH);
+                }
+                Pfzr[jj][ir][iz] = epio8ovr*sumM;
+            }
+            rr = rr + dr;
+        }
+    }
+    return Pfzr;
+  }
+}
+
+NCPA::PulseFFT::PulseFFT(int NFFT) {
+  if (NFFT < 1) {
+      throw invalid_argument("The FFT needs at least one point");
+  }
+  nfft = NFFT;
+  in   = (fftw_complex *) fftw_malloc(sizeof(fftw_complex)*nfft);
+  out  = (fftw_complex *) fftw_malloc(sizeof(fftw_complex)*nfft);
+  plan = fftw_plan_dft_1d(nfft, in, out, FFTW_FORWARD, FFTW_ESTIMATE);
+}
+
+NCPA::PulseFFT::~PulseFFT() {
+  fftw_destroy_plan(plan);
+  fftw_free(in);
+  fftw_free(out);
+}
+
+int NCPA::PulseFFT::size() {
+  return nfft;
+}
+
+complex<double> *NCPA::PulseFFT::spectrum() {
+  return reinterpret_cast< complex<double> * >(in);
+}
+
+void NCPA::PulseFFT::taper(int n_freqs, int end) {
+  if (nfft < n_freqs) {
+      throw invalid_argument("fft too short (i.e. NFFT < n_freqs), exiting.");
+  }
+  complex<double> *arg_vec = spectrum();
+  int i, begin;
+  double w;
+
+  // smoothly zero out on right; as in RW (July 2012)
+  begin = n_freqs - (int)floor(0.1*n_freqs);
+  for (i=begin; i<n_freqs; i++) {
+      w = (i <= end) ? 0.5*(cos(Pi*(i-begin)/(end-begin))+1.0) : 0.0;
+      arg_vec[i] = arg_vec[i]*w;
+  }
+  for (; i<nfft; i++) {
+      arg_vec[i] = 0.0;   // right zero pad
+  }
+}
+
+void NCPA::PulseFFT::transform(complex<double> *pulse_vec) {
+  fftw_execute(plan);
+  const complex<double> *res = reinterpret_cast< const complex<double> * >(out);
+  for (int i=0; i<nfft; i++) {
+      pulse_vec[i] = res[i];
+  }
+}
+
+
+void NCPA::packModes(vector<double> &v, const double *modes, int Nmodes) {
+  v.insert(v.end(), modes, modes + Nmodes);
+}
+
+void NCPA::packModes(vector<double> &v, const complex<double> *modes, int Nmodes) {
+  int m;
+  for (m=0; m<Nmodes; m++) { v.push_back(real(modes[m])); }
+  for (m=0; m<Nmodes; m++) { v.push_back(imag(modes[m])); }
+}
+
+
+NCPA::DispersionGrid::DispersionGrid(string dirn_, int ncomp_)
+  : dirn(dirn_), ncomp(ncomp_), store(NULL)
+{
+  if (DispersionStoreReader::isStore(dirn)) {
+      // all frequencies in one dispersion container
+      DispersionRecord rec;
+      store = new DispersionStoreReader(dirn);
+      if (store->getNcomp() != ncomp || store->getCount() != store->getNfreq()) {
+          delete store;
+          throw invalid_argument(dirn + (ncomp == 1 ? \
+                  " is not a complete dispersion container of real modes" : \
+                  " is not a complete dispersion container of complex modes"));
+      }
+      store->record(0, rec);
+      if (rec.nz_full == 0) {
+          delete store;
+          throw invalid_argument(dirn + " does not hold the full modes; write it with --out_dispersion_files");
+      }
+      Nfreq = store->getNfreq();
+      df    = store->getF_step();
+      delZ  = rec.dz;
+      return;
+  }
+
+  // get and sort the files (they have the frequency in the name)
+  DIR *dp;
+  struct dirent *dirp;
+  list<string> names;
+  if ((dp = opendir(dirn.c_str())) == NULL) {
+      throw invalid_argument("Error opening directory:" + dirn);
+  }
+  while ((dirp = readdir(dp)) != NULL) {
+      string a (dirp->d_name);
+      if (a.find(".bin") != string::npos) {
+          names.push_back(a);
+      }
+  }
+  closedir(dp);
+  if (names.empty()) {
+      throw invalid_argument("No dispersion files (*.bin) in directory " + dirn);
+  }
+  names.sort(compare_freq);
+  files.assign(names.begin(), names.end());
+
+  // get necessary info from 1 file
+  int    nmods, Nz_grid, Nz_subgrid;
+  double freq, dz;
+  string fullname = dirn + "/" + files[0];
+  FILE *fp = fopen(fullname.c_str(), "r");
+  if (fp==NULL) {
+      throw invalid_argument("file << " + fullname + " could not be opened.");
+  }
+  size_t ok = fread(&freq,    sizeof(double), 1, fp);
+  ok += fread(&nmods,   sizeof(int),    1, fp);
+  ok += fread(&Nfreq,   sizeof(int),    1, fp);
+  ok += fread(&df,      sizeof(double), 1, fp);
+  ok += fread(&Nz_grid, sizeof(int),    1, fp);
+  ok += fread(&dz,      sizeof(double), 1, fp);
+  ok += fread(&Nz_subgrid, sizeof(int), 1, fp);
+  ok += fread(&delZ,    sizeof(double), 1, fp);
+  fclose(fp);
+  if (ok != 8) {
+      throw invalid_argument("file " + fullname + " is too short.");
+  }
+  if (Nfreq != (int) files.size()) {
+      throw invalid_argument("Error: number of frequencies is not equal to the number of files" );
+  }
+}
+
+NCPA::DispersionGrid::~DispersionGrid() {
+  delete store;
+}
+
+int NCPA::DispersionGrid::getNcomp() {
+  return ncomp;
+}
+
+int NCPA::DispersionGrid::getNfreq() {
+  return Nfreq;
+}
+
+double NCPA::DispersionGrid::getF_step() {
+  return df;
+}
+
+double NCPA::DispersionGrid::getDelZ() {
+  return delZ;
+}
+
+void NCPA::DispersionGrid::load(int jj, int I1, int lenI, DispersionRecord &rec) {
+  size_t stride;
+
+  if (store != NULL) {
+      // the modes are used in place in the container's memory map
+      store->record(jj, rec);
+      if (I1 + lenI > (int) rec.nz_full) {
+          throw invalid_argument("The requested height is above the modes in the dispersion container");
+      }
+      rec.rows += (size_t)I1*(1 + ncomp*rec.nmodes);
+      return;
+  }
+
+  // a file holds freq, nmods, Nfreq, df, Nz_grid, dz, Nz_subgrid, delZ,
+  // z_min, rho_zsrc, then Re k, Im k and the modes at the source, then
+  // (rho, modes) at each height of the z-subgrid
+  int    nmods, ints[3];
+  double dbls[5];
+  string fullname = dirn + "/" + files[jj];
+
+  cout << "Iteration " << jj << "; processing file: " << files[jj] << endl;
+  FILE *fp = fopen(fullname.c_str(), "r");
+  if (fp==NULL) {
+      throw invalid_argument("file << " + fullname + " could not be opened.");
+  }
+  size_t ok = fread(&rec.freq, sizeof(double), 1, fp);
+  ok += fread(&nmods,        sizeof(int),    1, fp);
+  ok += fread(&ints[0],      sizeof(int),    1, fp);
+  ok += fread(&dbls[0],      sizeof(double), 1, fp);
+  ok += fread(&ints[1],      sizeof(int),    1, fp);
+  ok += fread(&dbls[1],      sizeof(double), 1, fp);
+  ok += fread(&ints[2],      sizeof(int),    1, fp);
+  ok += fread(&rec.dz,       sizeof(double), 1, fp);
+  ok += fread(&rec.z0,       sizeof(double), 1, fp);
+  ok += fread(&rec.rho_zsrc, sizeof(double), 1, fp);
+  if (ok != 10) {
+      fclose(fp);
+      throw invalid_argument("file " + fullname + " is too short.");
+  }
+  rec.nmodes   = (nmods > 0) ? nmods : 0;
+  rec.nz_full  = lenI;
+  rec.rho_zrcv = 0.0;
+  if (rec.nmodes == 0) {
+      fclose(fp);
+      return;
+  }
+
+  stride = 1 + ncomp*rec.nmodes;
+  buf.resize((2 + ncomp)*rec.nmodes + lenI*stride);
+  ok = fread(&buf[0], sizeof(double), (2 + ncomp)*rec.nmodes, fp);
+  // at each z on the z-subgrid we saved stride doubles i.e.
+  // we offset to the requested altitude specified by I1
+  fseek(fp, I1*stride*sizeof(double), SEEK_CUR);
+  ok += fread(&buf[(2 + ncomp)*rec.nmodes], sizeof(double), lenI*stride, fp);
+  fclose(fp);
+  if (ok != buf.size()) {
+      throw invalid_argument("file " + fullname + " is too short for the requested heights.");
+  }
+
+  rec.k_re   = &buf[0];
+  rec.k_im   = rec.k_re + rec.nmodes;
+  rec.mode_S = rec.k_im + rec.nmodes;
+  rec.mode_R = NULL;
+  rec.rows   = rec.mode_S + ncomp*rec.nmodes;
+}
+
+
+void NCPA::writePressureFrames(DispersionGrid &grid, const complex<double> *S, \
+                               double R_start_km, double width_km, double height_km, \
+                               double c_ref, double tmstep, int ntsteps, string framefn, \
+                               bool zero_attn_flg)
+{
+  char   filename [256]; // holds the frame file name(s)
+  int    i, j, m, n, k, Nx, Nz, NN, zs, I1, I2, lenI;
+  int    Nfreq = grid.getNfreq();
+  double tmin, tt, fr, sumP;
+  double df    = grid.getF_step();
+  double delZ  = grid.getDelZ();
+  double r1, r2, dr;
+  double **pp;
+  complex<double> II = complex<double> (0.0, 1.0);
+  complex<double> ***Pfzr;
+  FILE *fp;
+
+  // the subgrid (window) parameters
+  r1   = R_start_km*1000;
+  r2   = r1 + width_km*1000;
+  dr   = delZ;          // make horizontal spacing equal to the vertical spacing
+  Nx   = (int)((r2-r1)/dr)+1;
+  Nz   = (int) (height_km*1000.0/delZ)+1;
+  tmin = r1/c_ref;
+
+  // check if enough memory is available; if not, will iterate more than once
+  long maxel = 4000000; // maximum number of elements in the window (matrix)
+  zs = Nz;              // zs = how many z-levels to be processed at a time;
+  NN = 0;               // NN is number of iterations-1  (see loop below)
+  if (Nx*zs>maxel) {    // zs is adjusted down when not enough memory is available
+      NN  =(Nx*zs)/maxel + 1;  // integer division (floor)
+      zs = zs/NN;              // integer division
+  }
+
+  pp = dmatrix(zs,Nx); // allocate 2D pressure field
+  for (j=0; j<NN+1; j++) { // loop to get pressure spectrum at points on the jth subgrid of size [zs, Nx]
+      I1   = j*zs;
+      I2   = min(Nz-1, I1+zs-1);
+      lenI = I2-I1+1;
+      cout << "iteration = " << j+1 << " of " << NN+1 << endl;
+
+      // get pressure field from height z(I1) to z(I2)
+      if (grid.getNcomp() == 1) {
+          Pfzr = modalPressure<RealModeSet>(grid, I1, lenI, r1, dr, Nx, zero_attn_flg);
+      }
+      else {
+          Pfzr = modalPressure<ComplexModeSet>(grid, I1, lenI, r1, dr, Nx, zero_attn_flg);
+      }
+
+      for (k=0; k < ntsteps; k++) { // iterate over time steps
+          tt = tmin + k*tmstep;
+          sprintf(filename, "%s_%d.bin", framefn.c_str(), (int)floor(tt)); // filename
+
+          fp = fopen(filename, "a+b");
+          if (j==0)	{ // info in the file header - appears only once
+              fwrite(&Nz,   1, sizeof(int),    fp);
+              fwrite(&Nx,   1, sizeof(int),    fp);
+              fwrite(&delZ, 1, sizeof(double), fp);
+              fwrite(&r1,   1, sizeof(double), fp);
+              fwrite(&tt,   1, sizeof(double), fp);
+          }
+          for (n=0; n<Nx; n++) {       // for ranges on the x-grid
+              for (m=0; m<lenI; m++) { // for altitudes on z-grid
+                  fr       = 0.0;
+                  sumP     = 0.0;
+                  for (i=0; i<Nfreq; i++) { //integral over all positive frequencies to get pressure at (x,y,tt)
+                      fr   = fr + df;
+                      sumP = sumP + real(2.0*df*S[i]*Pfzr[i][n][m]*exp(-II*2.0*Pi*fr*tt));
+                  }
+                  pp[m][n] = sumP;
+              }
+          }
+          cout << " ... saving 2D field at time " << tt << " secs to file " << filename << endl;
+          for (m=0; m<lenI; m++) {
+              fwrite(pp[m], sizeof(double), Nx, fp);
+          }
+          fclose(fp);
+      }
+      free_c3Darray(Pfzr, Nfreq, Nx);
+  }
+  free_dmatrix(pp, zs, Nx);
+}
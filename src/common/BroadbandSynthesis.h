@@ -0,0 +1,377 @@
+#ifndef _BROADBANDSYNTHESIS_H_
+#define _BROADBANDSYNTHESIS_H_
+
+#include <complex>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <fftw3.h>
+#include "DispersionStore.h"
+
+namespace NCPA {
+
+  //
+  // The modal (dispersion) data of a broadband run, one row per frequency:
+  // the horizontal wavenumbers and the modes at the source and receiver
+  // heights. ModBB has real modes with complex wavenumbers, CModBB complex
+  // modes and wavenumbers; BroadbandSynthesis works on either through k()
+  // and product().
+  //
+  // value() reads mode j of a row of ncomp*nm stored values (see
+  // DispersionStore.h) and set() fills frequency i from a stored record.
+  // taperEnd() is the last bin of the spectral taper each code has always
+  // used.
+  //
+  struct RealModeSet {
+    typedef double value_type;
+    static const int ncomp = 1;
+
+    int     *mode_count;
+    double  **re_k, **im_k;
+    double  **mode_S, **mode_R;
+
+    RealModeSet(int *count, double **rk, double **ik, double **mS, double **mR)
+      : mode_count(count), re_k(rk), im_k(ik), mode_S(mS), mode_R(mR) {}
+
+    std::complex<double> k(int i, int j) const {
+      return std::complex<double>(re_k[i][j], im_k[i][j]);
+    }
+    std::complex<double> product(int i, int j) const {
+      return mode_S[i][j]*mode_R[i][j];
+    }
+
+    static double value(const double *v, int, int j) {
+      return v[j];
+    }
+    static int taperEnd(int n_freqs, double) {
+      return n_freqs - 1;
+    }
+    void set(int i, const DispersionRecord &rec) {
+      mode_count[i] = rec.nmodes;
+      for (int m=0; m<mode_count[i]; m++) {
+          re_k[i][m]   = rec.k_re[m];
+          im_k[i][m]   = rec.k_im[m];
+          mode_S[i][m] = rec.mode_S[m];
+          mode_R[i][m] = rec.mode_R[m];
+      }
+    }
+  };
+
+  struct ComplexModeSet {
+    typedef std::complex<double> value_type;
+    static const int ncomp = 2;
+
+    int                   *mode_count;
+    std::complex<double>  **kc;
+    std::complex<double>  **mode_S, **mode_R;
+
+    ComplexModeSet(int *count, std::complex<double> **k_c, std::complex<double> **mS, \
+                   std::complex<double> **mR)
+      : mode_count(count), kc(k_c), mode_S(mS), mode_R(mR) {}
+
+    std::complex<double> k(int i, int j) const {
+      return kc[i][j];
+    }
+    std::complex<double> product(int i, int j) const {
+      return mode_S[i][j]*mode_R[i][j];
+    }
+
+    static std::complex<double> value(const double *v, int nm, int j) {
+      return std::complex<double>(v[j], v[nm+j]);
+    }
+    // CModBB passed the frequency step as the (int) end of its half Hann
+    // window, which is n_freqs-1 whenever df < 1 Hz
+    static int taperEnd(int n_freqs, double df) {
+      return (int)(n_freqs - df);
+    }
+    void set(int i, const DispersionRecord &rec) {
+      int nm = rec.nmodes;
+      mode_count[i] = nm;
+      for (int m=0; m<nm; m++) {
+          kc[i][m]     = std::complex<double>(rec.k_re[m], rec.k_im[m]);
+          mode_S[i][m] = value(rec.mode_S, nm, m);
+          mode_R[i][m] = value(rec.mode_R, nm, m);
+      }
+    }
+  };
+
+
+  //
+  // NFFT-point forward transform of a one-sided spectrum into a pulse. The
+  // buffers and the FFTW plan are made once and reused for every range.
+  //
+  class PulseFFT {
+    public:
+      PulseFFT(int NFFT);
+      ~PulseFFT();
+
+      int                   size();
+      std::complex<double> *spectrum();     // NFFT bins, filled by the caller
+
+      // smoothly zeroes the top 10% of the n_freqs bins, with a half Hann
+      // window reaching zero at bin 'end', and everything above them, as
+      // the modal codes always did
+      void taper(int n_freqs, int end);
+
+      // forward transform of spectrum() into pulse_vec (NFFT values)
+      void transform(std::complex<double> *pulse_vec);
+
+    private:
+      int            nfft;
+      fftw_complex  *in, *out;
+      fftw_plan      plan;
+  };
+
+
+  //
+  // Fourier synthesis of the pulse propagated to a range from the modal sum
+  //   P(f, r) = i exp(-i pi/4)/sqrt(8 pi r) sqrt(rho_rcv/rho_src)
+  //             * sum_m V_m(z_src) V_m(z_rcv) exp(i k_m r)/sqrt(k_m)
+  // in a window starting at the reduced time t0, for pulse_prop_src2rcv_grid2
+  // in ModBB and CModBB. The range-independent part of each term,
+  // V_m V_m/sqrt(k_m), and the wavenumbers are packed once at construction,
+  // so that each range costs one complex exponential per mode and one FFT.
+  //
+  // With packed = false every range recomputes the terms from the ModeSet,
+  // as the codes did before; it is kept to time the two forms against each
+  // other (--synthesis_form). sumSeconds() is the CPU time spent so far on
+  // the modal sums, packing included and the FFTs excluded.
+  //
+  template<class ModeSet>
+  class BroadbandSynthesis {
+    public:
+      BroadbandSynthesis(const ModeSet &modes, int n_freqs, int NFFT, double df, \
+                         const double *f_vec, double rho_zsrc, double rho_zrcv, \
+                         bool packed = true);
+
+      // pulse_vec gets the NFFT samples of the pulse at range (m) for the
+      // source spectrum dft_vec, with the df of the Fourier integral applied
+      void propagate(double t0, double range, const std::complex<double> *dft_vec, \
+                     std::complex<double> *pulse_vec);
+
+      double sumSeconds();
+
+    private:
+      ModeSet                             modes;
+      bool                                packed;
+      int                                 n_freqs, i0, taper_end;
+      double                              df, sqrt_rho_ratio, sum_seconds;
+      std::vector<double>                 freq;
+      std::vector<int>                    first;   // modes of frequency i: first[i]..first[i+1]-1
+      std::vector< std::complex<double> > kH, coef;
+      PulseFFT                            fft;
+  };
+
+
+  template<class ModeSet>
+  BroadbandSynthesis<ModeSet>::BroadbandSynthesis(const ModeSet &modes_, int n_freqs_, int NFFT, \
+                         double df_, const double *f_vec, double rho_zsrc, double rho_zrcv, \
+                         bool packed_)
+    : modes(modes_), packed(packed_), n_freqs(n_freqs_),
+      taper_end(ModeSet::taperEnd(n_freqs_, df_)), df(df_),
+      sqrt_rho_ratio(std::sqrt(rho_zrcv/rho_zsrc)), sum_seconds(0.0),
+      freq(f_vec, f_vec + n_freqs_), first(n_freqs_ + 1), fft(NFFT)
+  {
+    int i, j;
+    std::clock_t c0 = std::clock();
+    // left zero pad up to the first frequency present in the spectrum
+    for (i0=0; i0*df < 0.99*freq[0]; i0++) {}
+
+    if (!packed) {
+        return;
+    }
+    first[0] = 0;
+    for (i=0; i<n_freqs; i++) {
+        first[i+1] = first[i] + modes.mode_count[i];
+    }
+    kH.resize(first[n_freqs]);
+    coef.resize(first[n_freqs]);
+    for (i=0; i<n_freqs; i++) {
+        for (j=0; j<modes.mode_count[i]; j++) {
+            kH[first[i]+j]   = modes.k(i, j);
+            coef[first[i]+j] = modes.product(i, j)/std::sqrt(kH[first[i]+j]);
+        }
+    }
+    sum_seconds += (double)(std::clock() - c0)/CLOCKS_PER_SEC;
+  }
+
+  template<class ModeSet>
+  void BroadbandSynthesis<ModeSet>::propagate(double t0, double range, \
+                         const std::complex<double> *dft_vec, std::complex<double> *pulse_vec)
+  {
+    const double Pi = 3.141592653589793;
+    int i, j;
+    std::complex<double> I (0.0, 1.0);
+    std::complex<double> cup, t_phase;
+    std::complex<double> expov8pir = I*std::exp(-I*Pi*0.25)/std::sqrt(8.0*Pi*range);
+    std::complex<double> *arg_vec  = fft.spectrum();
+    std::complex<double> k_H;
+    std::clock_t c0 = std::clock();
+
+    for (i=0; i<i0; i++) {
+        arg_vec[i] = 0.0;
+    }
+    for (i=0; i<n_freqs; i++) {
+        cup = 0.0;
+        if (packed) {
+            for (j=first[i]; j<first[i+1]; j++) {
+                cup += coef[j]*std::exp(I*range*kH[j]);   // modal sum: sum( exp(ikr)/sqrt(k)*Vr*Vs )
+            }
+        }
+        else {
+            for (j=0; j<modes.mode_count[i]; j++) {
+                k_H  = modes.k(i, j);
+                cup += modes.product(i, j)*std::exp(I*range*k_H)/std::sqrt(k_H);
+            }
+        }
+        t_phase = std::exp(-I*2.0*Pi*freq[i]*t0);    // corresponding to reduced time t0
+        arg_vec[i0+i] = expov8pir*cup*t_phase*dft_vec[i]*df*sqrt_rho_ratio;
+    }
+    sum_seconds += (double)(std::clock() - c0)/CLOCKS_PER_SEC;
+    fft.taper(n_freqs, taper_end);
+    fft.transform(pulse_vec);
+  }
+
+  template<class ModeSet>
+  double BroadbandSynthesis<ModeSet>::sumSeconds() {
+    return sum_seconds;
+  }
+
+
+  //
+  // Fills the frequencies i0, i0+1, ... of modes, f_vec and the densities
+  // from a complete dispersion container of the same mode type; returns the
+  // number of frequencies read. ModBB keeps the DC frequency in slot 0 and
+  // so reads from i0 = 1.
+  //
+  template<class ModeSet>
+  int readDispersionStore(std::string filen, ModeSet &modes, int i0, double *f_vec, \
+                          double *rho_zsrc, double *rho_zrcv, int max_modes)
+  {
+    DispersionStoreReader store(filen);
+    DispersionRecord rec;
+
+    if (store.getNcomp() != ModeSet::ncomp) {
+        throw std::invalid_argument(filen + (ModeSet::ncomp == 1 ? \
+                " holds complex modes; use CModBB to read it" : \
+                " holds real modes; use ModBB to read it"));
+    }
+    if (store.getCount() != store.getNfreq()) {
+        std::ostringstream es;
+        es << filen << " holds " << store.getCount() << " of " << store.getNfreq()
+           << " frequencies; finish the dispersion run first";
+        throw std::invalid_argument(es.str());
+    }
+    for (int n=0; n<store.getNfreq(); n++) {
+        store.record(n, rec);
+        if ((int) rec.nmodes > max_modes) {
+            throw std::invalid_argument(filen + ": more modes than MAX_MODES at one frequency");
+        }
+        f_vec[i0+n] = rec.freq;
+        *rho_zsrc   = rec.rho_zsrc;
+        *rho_zrcv   = rec.rho_zrcv;
+        modes.set(i0+n, rec);
+    }
+    return store.getNfreq();
+  }
+
+
+  // appends the Nmodes mode values to v as the container stores them
+  void packModes(std::vector<double> &v, const double *modes, int Nmodes);
+  void packModes(std::vector<double> &v, const std::complex<double> *modes, int Nmodes);
+
+  //
+  // Stores frequency slot ii of a dispersion container: the wavenumbers k,
+  // rho and the modes v_s (on the Nz_grid heights from z_min every dz) at
+  // the source and receiver and, if NN > 0, rho and the modes every NN grid
+  // points, as the per-frequency binary files have them.
+  //
+  template<class T>
+  int writeDispersionRecord(DispersionStoreWriter *store, int ii, double freq, int Nmodes, \
+                            int Nz_grid, double z_min, double dz, double z_src, double z_rcv, \
+                            const double *rho, const std::complex<double> *k, T **v_s, int NN)
+  {
+    int iz, m;
+    int n_zsrc = (int) std::ceil(z_src/dz);
+    int n_zrcv = (int) std::ceil(z_rcv/dz);
+    std::vector<double> kr(Nmodes), ki(Nmodes), vs, vr, rows;
+
+    for (m=0; m<Nmodes; m++) {
+        kr[m] = std::real(k[m]);
+        ki[m] = std::imag(k[m]);
+    }
+    packModes(vs, v_s[n_zsrc], Nmodes);
+    packModes(vr, v_s[n_zrcv], Nmodes);
+
+    DispersionRecord rec;
+    rec.freq     = freq;
+    rec.nmodes   = Nmodes;
+    rec.nz_full  = 0;
+    rec.rho_zsrc = rho[n_zsrc];
+    rec.rho_zrcv = rho[n_zrcv];
+    rec.z0       = z_min;
+    rec.dz       = NN*dz;
+    rec.k_re     = kr.data();
+    rec.k_im     = ki.data();
+    rec.mode_S   = vs.data();
+    rec.mode_R   = vr.data();
+    if (NN > 0) {
+        for (iz=0; iz<Nz_grid; iz+=NN) {
+            rows.push_back(rho[iz]);
+            packModes(rows, v_s[iz], Nmodes);
+            rec.nz_full++;
+        }
+    }
+    rec.rows = rows.data();
+
+    store->append(ii, rec);
+    return 0;
+  }
+
+
+  //
+  // The full modes of a broadband run for the 2D pressure frames, read
+  // either from a dispersion container or from a directory of the
+  // per-frequency binary files (*_nm.bin, sorted by the frequency in their
+  // names); both hold, at each height, rho followed by ncomp*nm mode values.
+  //
+  class DispersionGrid {
+    public:
+      DispersionGrid(std::string dirn, int ncomp);
+      ~DispersionGrid();
+
+      int    getNcomp();
+      int    getNfreq();
+      double getF_step();
+      double getDelZ();
+
+      // points rec at frequency jj, with rec.rows starting at height index
+      // I1 and holding (at least) lenI heights
+      void   load(int jj, int I1, int lenI, DispersionRecord &rec);
+
+    private:
+      std::string               dirn;
+      int                       ncomp, Nfreq;
+      double                    df, delZ;
+      DispersionStoreReader     *store;
+      std::vector<std::string>  files;
+      std::vector<double>       buf;   // the values of a file frequency
+  };
+
+  //
+  // Writes the frames framefn_<t>.bin of the 2D pressure in the window of
+  // width_km by height_km starting at R_start_km, for ntsteps times every
+  // tmstep from R_start/c_ref. S is the source spectrum at the grid's
+  // frequencies (i+1)*df; zero_attn_flg drops the imaginary part of the
+  // wavenumbers.
+  //
+  void writePressureFrames(DispersionGrid &grid, const std::complex<double> *S, \
+                           double R_start_km, double width_km, double height_km, \
+                           double c_ref, double tmstep, int ntsteps, std::string framefn, \
+                           bool zero_attn_flg);
+}
+
+#endif
@@ -0,0 +1,304 @@
+#include "DispersionStore.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace {
+  const char     *DISP_MAGIC   = "NCPADSPC";
+  const uint32_t  DISP_VERSION = 1;
+  const size_t    HEADER_BYTES = 56;   // up to the offset table
+  const size_t    RECORD_BYTES = 48;   // record fields before the arrays
+
+  struct StoreHeader {
+    uint32_t  Nfreq, ncomp;
+    double    f_min, f_step, z_src, z_rcv;
+  };
+
+  void packHeader(const StoreHeader &h, char *buf) {
+    uint32_t zero = 0;
+    memcpy(buf,      DISP_MAGIC, 8);
+    memcpy(buf + 8,  &DISP_VERSION, 4);
+    memcpy(buf + 12, &h.Nfreq, 4);
+    memcpy(buf + 16, &h.ncomp, 4);
+    memcpy(buf + 20, &zero, 4);
+    memcpy(buf + 24, &h.f_min, 8);
+    memcpy(buf + 32, &h.f_step, 8);
+    memcpy(buf + 40, &h.z_src, 8);
+    memcpy(buf + 48, &h.z_rcv, 8);
+  }
+
+  // false if buf does not start with the container magic
+  bool unpackHeader(const char *buf, StoreHeader &h, string filename) {
+    uint32_t version;
+    if (memcmp( buf, DISP_MAGIC, 8 ) != 0) {
+        return false;
+    }
+    memcpy(&version, buf + 8, 4);
+    if (version != DISP_VERSION) {
+        throw runtime_error(filename + " is not a version 1 dispersion container!");
+    }
+    memcpy(&h.Nfreq, buf + 12, 4);
+    memcpy(&h.ncomp, buf + 16, 4);
+    memcpy(&h.f_min, buf + 24, 8);
+    memcpy(&h.f_step, buf + 32, 8);
+    memcpy(&h.z_src, buf + 40, 8);
+    memcpy(&h.z_rcv, buf + 48, 8);
+    return true;
+  }
+
+  size_t recordBytes(size_t nmodes, size_t nz_full, size_t ncomp) {
+    return RECORD_BYTES + 8*(2*nmodes + 2*ncomp*nmodes + nz_full*(1 + ncomp*nmodes));
+  }
+
+  bool sameValue(double a, double b) {
+    return fabs(a - b) <= 1.0e-9*fmax(fabs(a), fabs(b));
+  }
+}
+
+
+NCPA::DispersionStoreWriter::DispersionStoreWriter(string filename_, int Nfreq_, double f_min, \
+                            double f_step, double z_src, double z_rcv, int ncomp_) {
+  filename = filename_;
+  Nfreq    = Nfreq_;
+  ncomp    = ncomp_;
+  if (Nfreq < 1 || (ncomp != 1 && ncomp != 2)) {
+      throw invalid_argument("A dispersion container needs at least one frequency and 1 or 2 values per mode");
+  }
+  fd = open( filename.c_str(), O_RDWR | O_CREAT, 0666 );
+  if (fd < 0) {
+      throw runtime_error("Could not open dispersion container " + filename);
+  }
+
+  StoreHeader h;
+  h.Nfreq  = Nfreq;
+  h.ncomp  = ncomp;
+  h.f_min  = f_min;
+  h.f_step = f_step;
+  h.z_src  = z_src;
+  h.z_rcv  = z_rcv;
+
+  // the descriptor is closed (which also drops the lock) on any error
+  try {
+      lock();
+      struct stat st;
+      fstat(fd, &st);
+      if (st.st_size == 0) {
+          vector<char> buf(HEADER_BYTES + 8*Nfreq, 0);
+          packHeader(h, &buf[0]);
+          if (pwrite(fd, &buf[0], buf.size(), 0) != (ssize_t) buf.size()) {
+              throw runtime_error("Error writing dispersion container " + filename);
+          }
+      }
+      else {
+          // restarting (or joining) a run: the container must describe the same one
+          char buf[ HEADER_BYTES ];
+          StoreHeader old;
+          if (pread(fd, buf, HEADER_BYTES, 0) != (ssize_t) HEADER_BYTES || !unpackHeader(buf, old, filename)) {
+              throw runtime_error(filename + " exists and is not a dispersion container");
+          }
+          if (old.Nfreq != h.Nfreq || old.ncomp != h.ncomp || !sameValue(old.f_min, h.f_min)
+              || !sameValue(old.f_step, h.f_step) || !sameValue(old.z_src, h.z_src)
+              || !sameValue(old.z_rcv, h.z_rcv)) {
+              throw invalid_argument("Dispersion container " + filename + " was written for other frequencies or heights");
+          }
+      }
+  }
+  catch (...) {
+      close(fd);
+      throw;
+  }
+  unlock();
+}
+
+NCPA::DispersionStoreWriter::~DispersionStoreWriter() {
+  close(fd);
+}
+
+void NCPA::DispersionStoreWriter::lock() {
+  if (flock(fd, LOCK_EX) != 0) {
+      throw runtime_error("Could not lock dispersion container " + filename);
+  }
+}
+
+void NCPA::DispersionStoreWriter::unlock() {
+  flock(fd, LOCK_UN);
+}
+
+bool NCPA::DispersionStoreWriter::has(int i) {
+  uint64_t off = 0;
+  if (i < 0 || i >= Nfreq) {
+      throw out_of_range("Frequency slot beyond the dispersion container");
+  }
+  lock();
+  ssize_t n = pread(fd, &off, 8, HEADER_BYTES + 8*(size_t)i);
+  unlock();
+  return n == 8 && off != 0;
+}
+
+void NCPA::DispersionStoreWriter::append(int i, const DispersionRecord &rec) {
+  if (i < 0 || i >= Nfreq) {
+      throw out_of_range("Frequency slot beyond the dispersion container");
+  }
+
+  // the record in one buffer, so it goes out in a single write
+  size_t nm = rec.nmodes, nv = ncomp*nm, nrow = 1 + nv;
+  vector<char> buf(recordBytes(nm, rec.nz_full, ncomp));
+  char *p = &buf[0];
+  memcpy(p,      &rec.freq, 8);
+  memcpy(p + 8,  &rec.nmodes, 4);
+  memcpy(p + 12, &rec.nz_full, 4);
+  memcpy(p + 16, &rec.rho_zsrc, 8);
+  memcpy(p + 24, &rec.rho_zrcv, 8);
+  memcpy(p + 32, &rec.z0, 8);
+  memcpy(p + 40, &rec.dz, 8);
+  p += RECORD_BYTES;
+  if (nm > 0) {
+      memcpy(p, rec.k_re, 8*nm);    p += 8*nm;
+      memcpy(p, rec.k_im, 8*nm);    p += 8*nm;
+      memcpy(p, rec.mode_S, 8*nv);  p += 8*nv;
+      memcpy(p, rec.mode_R, 8*nv);  p += 8*nv;
+  }
+  if (rec.nz_full > 0) {
+      memcpy(p, rec.rows, 8*nrow*rec.nz_full);
+  }
+
+  lock();
+  uint64_t off = 0;
+  size_t   slot = HEADER_BYTES + 8*(size_t)i;
+  if (pread(fd, &off, 8, slot) == 8 && off != 0) {
+      unlock();       // written by another process in the meantime
+      return;
+  }
+  off = (uint64_t) lseek(fd, 0, SEEK_END);
+  bool ok = pwrite(fd, &buf[0], buf.size(), off) == (ssize_t) buf.size();
+  // the record reaches the disk before the index points to it
+  ok = ok && fdatasync(fd) == 0;
+  ok = ok && pwrite(fd, &off, 8, slot) == 8;
+  unlock();
+  if (!ok) {
+      throw runtime_error("Error writing dispersion container " + filename);
+  }
+}
+
+
+NCPA::DispersionStoreReader::DispersionStoreReader(string filename_) {
+  filename = filename_;
+  int fd = open( filename.c_str(), O_RDONLY );
+  if (fd < 0) {
+      throw runtime_error("Could not open dispersion container " + filename);
+  }
+  struct stat st;
+  fstat(fd, &st);
+  map_size = st.st_size;
+  if (map_size < HEADER_BYTES) {
+      close(fd);
+      throw runtime_error(filename + " is not a dispersion container");
+  }
+  void *m = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED) {
+      throw runtime_error("Could not map dispersion container " + filename);
+  }
+  map = (const char *) m;
+
+  StoreHeader h;
+  if (!unpackHeader(map, h, filename) || map_size < HEADER_BYTES + 8*(size_t)h.Nfreq) {
+      munmap((void *) map, map_size);
+      throw runtime_error(filename + " is not a dispersion container");
+  }
+  Nfreq   = h.Nfreq;
+  ncomp   = h.ncomp;
+  f_min   = h.f_min;
+  f_step  = h.f_step;
+  z_src   = h.z_src;
+  z_rcv   = h.z_rcv;
+  offsets = (const uint64_t *) (map + HEADER_BYTES);
+}
+
+NCPA::DispersionStoreReader::~DispersionStoreReader() {
+  munmap((void *) map, map_size);
+}
+
+bool NCPA::DispersionStoreReader::isStore(string filename) {
+  char magic[ 8 ];
+  ifstream in( filename.c_str(), ios_base::in | ios_base::binary );
+  in.read( magic, 8 );
+  return in.good() && memcmp( magic, DISP_MAGIC, 8 ) == 0;
+}
+
+int NCPA::DispersionStoreReader::getNfreq() {
+  return Nfreq;
+}
+
+int NCPA::DispersionStoreReader::getNcomp() {
+  return ncomp;
+}
+
+int NCPA::DispersionStoreReader::getCount() {
+  int n = 0;
+  for (int i=0; i<Nfreq; i++) {
+      if (has(i)) { n++; }
+  }
+  return n;
+}
+
+double NCPA::DispersionStoreReader::getF_min() {
+  return f_min;
+}
+
+double NCPA::DispersionStoreReader::getF_step() {
+  return f_step;
+}
+
+double NCPA::DispersionStoreReader::getZ_src() {
+  return z_src;
+}
+
+double NCPA::DispersionStoreReader::getZ_rcv() {
+  return z_rcv;
+}
+
+bool NCPA::DispersionStoreReader::has(int i) {
+  if (i < 0 || i >= Nfreq) {
+      return false;
+  }
+  // a record appended after the file was mapped is not visible
+  uint64_t off = offsets[i];
+  if (off == 0 || off + RECORD_BYTES > map_size) {
+      return false;
+  }
+  uint32_t nmodes, nz_full;
+  memcpy(&nmodes, map + off + 8, 4);
+  memcpy(&nz_full, map + off + 12, 4);
+  return off + recordBytes(nmodes, nz_full, ncomp) <= map_size;
+}
+
+void NCPA::DispersionStoreReader::record(int i, DispersionRecord &rec) {
+  if (!has(i)) {
+      throw out_of_range("Frequency slot not written in dispersion container " + filename);
+  }
+  const char *p = map + offsets[i];
+  memcpy(&rec.freq, p, 8);
+  memcpy(&rec.nmodes, p + 8, 4);
+  memcpy(&rec.nz_full, p + 12, 4);
+  memcpy(&rec.rho_zsrc, p + 16, 8);
+  memcpy(&rec.rho_zrcv, p + 24, 8);
+  memcpy(&rec.z0, p + 32, 8);
+  memcpy(&rec.dz, p + 40, 8);
+
+  const double *d = (const double *) (p + RECORD_BYTES);
+  size_t nm = rec.nmodes, nv = ncomp*nm;
+  rec.k_re   = d;
+  rec.k_im   = d + nm;
+  rec.mode_S = d + 2*nm;
+  rec.mode_R = d + 2*nm + nv;
+  rec.rows   = d + 2*nm + 2*nv;
+}
@@ -0,0 +1,103 @@
+#ifndef _DISPERSIONSTORE_H_
+#define _DISPERSIONSTORE_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace NCPA {
+
+  //
+  // One file holding the modal (dispersion) data of all the frequencies of a
+  // broadband run, indexed so that any frequency can be reached directly.
+  //
+  // The format is written in native byte order:
+  //   char[8]   "NCPADSPC"
+  //   uint32    format version (1)
+  //   uint32    number of frequency slots Nfreq
+  //   uint32    values per mode value: 1 (real modes) or 2 (complex modes)
+  //   uint32    unused (0)
+  //   float64   f_min, f_step (Hz): slot i is the frequency f_min + i*f_step
+  //   float64   source height, receiver height (m)
+  //   uint64    Nfreq record offsets from the start of the file; 0 for a
+  //             frequency not written yet
+  // followed by the records in the order they were written. A record is
+  //   float64   frequency (Hz)
+  //   uint32    number of modes nm
+  //   uint32    number of heights nzs of the full modes (0 if not stored)
+  //   float64   rho at the source, rho at the receiver
+  //   float64   first height, height spacing (m) of the full modes
+  //   float64   Re k[nm], Im k[nm]
+  //   float64   modes at the source, then at the receiver: ncomp*nm each
+  //   float64   nzs rows of (rho, modes): 1 + ncomp*nm each
+  // where complex mode values are stored as nm real parts followed by nm
+  // imaginary parts. Every field is a multiple of 8 bytes, so the reader can
+  // use the values in place in a memory map of the file.
+  //
+  // Several processes may append to the same file at once (e.g. the workers
+  // of a broadband run): each record is appended and then indexed under an
+  // exclusive lock, and is flushed to disk before its offset is written, so an
+  // interrupted run leaves only complete, indexed records. A run restarted on
+  // the same file skips the frequencies it already holds.
+  //
+  struct DispersionRecord {
+    double        freq;
+    uint32_t      nmodes, nz_full;
+    double        rho_zsrc, rho_zrcv;
+    double        z0, dz;
+    const double  *k_re, *k_im;
+    const double  *mode_S, *mode_R;   // ncomp*nmodes values each
+    const double  *rows;              // nz_full*(1 + ncomp*nmodes) values
+  };
+
+  class DispersionStoreWriter {
+    public:
+      // opens or creates the container; an existing one must have the same
+      // frequencies, heights and mode type
+      DispersionStoreWriter(std::string filename, int Nfreq, double f_min, double f_step, \
+                            double z_src, double z_rcv, int ncomp);
+      ~DispersionStoreWriter();
+
+      bool has(int i);          // frequency slot i already written
+      // writes frequency slot i unless another writer did it first
+      void append(int i, const DispersionRecord &rec);
+
+    private:
+      std::string  filename;
+      int          fd, Nfreq, ncomp;
+
+      void lock();
+      void unlock();
+  };
+
+  class DispersionStoreReader {
+    public:
+      DispersionStoreReader(std::string filename);
+      ~DispersionStoreReader();
+
+      // true if the file is a dispersion container
+      static bool isStore(std::string filename);
+
+      int    getNfreq();
+      int    getNcomp();
+      int    getCount();        // frequency slots written
+      double getF_min();
+      double getF_step();
+      double getZ_src();
+      double getZ_rcv();
+
+      bool   has(int i);
+      // points rec into the map; throws if slot i is empty
+      void   record(int i, DispersionRecord &rec);
+
+    private:
+      std::string     filename;
+      int             Nfreq, ncomp;
+      double          f_min, f_step, z_src, z_rcv;
+      const char      *map;
+      size_t          map_size;
+      const uint64_t  *offsets;
+  };
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include "Field2DFile.h"
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+  const char     *FIELD2D_MAGIC   = "NCPAFLD2";
+  const uint32_t  FIELD2D_VERSION = 1;
+
+  void writeHeader(ofstream &out, const NCPA::Field2DHeader &h) {
+    out.write( FIELD2D_MAGIC, 8 );
+    out.write( (const char *)&FIELD2D_VERSION, sizeof(uint32_t) );
+    out.write( (const char *)&h.sample_bytes, sizeof(uint32_t) );
+    out.write( (const char *)&h.freq, sizeof(double) );
+    out.write( (const char *)&h.zsrc, sizeof(double) );
+    out.write( (const char *)&h.zrcv, sizeof(double) );
+    out.write( (const char *)&h.azimuth, sizeof(double) );
+    out.write( (const char *)&h.r0, sizeof(double) );
+    out.write( (const char *)&h.dr, sizeof(double) );
+    out.write( (const char *)&h.nr, sizeof(uint32_t) );
+    out.write( (const char *)&h.z0, sizeof(double) );
+    out.write( (const char *)&h.dz, sizeof(double) );
+    out.write( (const char *)&h.nz, sizeof(uint32_t) );
+  }
+}
+
+NCPA::Field2DWriter::Field2DWriter(string filename_, const Field2DHeader &header) {
+  filename = filename_;
+  hdr      = header;
+  hdr.nr   = 0;
+  if (hdr.sample_bytes != 4 && hdr.sample_bytes != 8) {
+      throw invalid_argument("2D field samples must be 4 or 8 bytes");
+  }
+  out.open( filename.c_str(), ios_base::out | ios_base::binary );
+  if (!out.good()) {
+      throw runtime_error("Could not open 2D field file " + filename);
+  }
+  writeHeader(out, hdr);
+  if (hdr.sample_bytes == 4) { row32.resize(2*hdr.nz); }
+  else                       { row64.resize(2*hdr.nz); }
+}
+
+NCPA::Field2DWriter::~Field2DWriter() {
+  close();
+}
+
+void NCPA::Field2DWriter::writeRow(const complex<double> *p, int stride, complex<double> scale) {
+  if (hdr.sample_bytes == 4) {
+      for (uint32_t i=0; i<hdr.nz; i++) {
+          complex<double> v = scale*p[i*stride];
+          row32[2*i]   = (float) real(v);
+          row32[2*i+1] = (float) imag(v);
+      }
+      out.write( (const char *)&row32[0], row32.size()*sizeof(float) );
+  }
+  else {
+      for (uint32_t i=0; i<hdr.nz; i++) {
+          complex<double> v = scale*p[i*stride];
+          row64[2*i]   = real(v);
+          row64[2*i+1] = imag(v);
+      }
+      out.write( (const char *)&row64[0], row64.size()*sizeof(double) );
+  }
+  if (!out.good()) {
+      throw runtime_error("Error writing 2D field file " + filename);
+  }
+  hdr.nr++;
+}
+
+void NCPA::Field2DWriter::close() {
+  if (!out.is_open()) { return; }
+  // the header now gets the number of rows
+  out.seekp(0);
+  writeHeader(out, hdr);
+  out.close();
+}
+
+
+NCPA::Field2DReader::Field2DReader(string filename_) {
+  filename = filename_;
+  in.open( filename.c_str(), ios_base::in | ios_base::binary );
+  if (!in.good()) {
+      throw runtime_error("Could not open 2D field file " + filename);
+  }
+  char     magic[ 8 ];
+  uint32_t version;
+  in.read( magic, 8 );
+  in.read( (char *)&version, sizeof(uint32_t) );
+  if (!in.good() || strncmp( magic, FIELD2D_MAGIC, 8 ) != 0 || version != FIELD2D_VERSION) {
+      throw runtime_error(filename + " is not a version 1 2D field file!");
+  }
+  in.read( (char *)&hdr.sample_bytes, sizeof(uint32_t) );
+  in.read( (char *)&hdr.freq, sizeof(double) );
+  in.read( (char *)&hdr.zsrc, sizeof(double) );
+  in.read( (char *)&hdr.zrcv, sizeof(double) );
+  in.read( (char *)&hdr.azimuth, sizeof(double) );
+  in.read( (char *)&hdr.r0, sizeof(double) );
+  in.read( (char *)&hdr.dr, sizeof(double) );
+  in.read( (char *)&hdr.nr, sizeof(uint32_t) );
+  in.read( (char *)&hdr.z0, sizeof(double) );
+  in.read( (char *)&hdr.dz, sizeof(double) );
+  in.read( (char *)&hdr.nz, sizeof(uint32_t) );
+  if (!in.good() || (hdr.sample_bytes != 4 && hdr.sample_bytes != 8)) {
+      throw runtime_error("Bad header in 2D field file " + filename);
+  }
+  data_start = in.tellg();
+
+  if (hdr.nr == 0 && hdr.nz > 0) {
+      // not closed by the writer: count the complete rows
+      in.seekg(0, ios_base::end);
+      streamoff nbytes = in.tellg() - data_start;
+      hdr.nr = (uint32_t) (nbytes / (2*hdr.nz*hdr.sample_bytes));
+  }
+}
+
+const NCPA::Field2DHeader &NCPA::Field2DReader::header() {
+  return hdr;
+}
+
+double NCPA::Field2DReader::range(unsigned int ir) {
+  return hdr.r0 + ir*hdr.dr;
+}
+
+double NCPA::Field2DReader::height(unsigned int iz) {
+  return hdr.z0 + iz*hdr.dz;
+}
+
+void NCPA::Field2DReader::readRow(unsigned int ir, complex<double> *row) {
+  if (ir >= hdr.nr) {
+      throw out_of_range("Range row beyond the end of 2D field file " + filename);
+  }
+  in.clear();
+  in.seekg(data_start + (streamoff) ir*2*hdr.nz*hdr.sample_bytes);
+  if (hdr.sample_bytes == 4) {
+      vector<float> buf(2*hdr.nz);
+      in.read( (char *)&buf[0], buf.size()*sizeof(float) );
+      for (uint32_t i=0; i<hdr.nz; i++) {
+          row[i] = complex<double>(buf[2*i], buf[2*i+1]);
+      }
+  }
+  else {
+      vector<double> buf(2*hdr.nz);
+      in.read( (char *)&buf[0], buf.size()*sizeof(double) );
+      for (uint32_t i=0; i<hdr.nz; i++) {
+          row[i] = complex<double>(buf[2*i], buf[2*i+1]);
+      }
+  }
+  if (!in.good()) {
+      throw runtime_error("Error reading 2D field file " + filename);
+  }
+}
+
+void NCPA::Field2DReader::readAll(vector< complex<double> > &field) {
+  field.resize((size_t) hdr.nr*hdr.nz);
+  for (uint32_t ir=0; ir<hdr.nr; ir++) {
+      readRow(ir, &field[(size_t) ir*hdr.nz]);
+  }
+}
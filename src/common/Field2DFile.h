@@ -0,0 +1,79 @@
+#ifndef _FIELD2DFILE_H_
+#define _FIELD2DFILE_H_
+
+#include <complex>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace NCPA {
+
+  //
+  // Binary file of a complex 2D field p(r,z), e.g. the 2D transmission loss of
+  // pape, stored one range row at a time on a regular (r,z) grid.
+  //
+  // The format is written in native byte order:
+  //   char[8]   "NCPAFLD2"
+  //   uint32    format version (1)
+  //   uint32    bytes per real value: 4 (float32) or 8 (float64)
+  //   float64   frequency (Hz), source height (m), receiver height (m),
+  //             azimuth (deg)
+  //   float64   first range, range spacing (m)
+  //   uint32    number of ranges; 0 if the writer was not closed
+  //   float64   first height, height spacing (m)
+  //   uint32    number of heights
+  // followed by the rows, each nz (Re p, Im p) pairs in height order.
+  //
+  // The number of ranges is filled in when the writer is closed; the reader
+  // falls back on the file size for a file left incomplete by an aborted run.
+  //
+  struct Field2DHeader {
+    uint32_t  sample_bytes;
+    double    freq, zsrc, zrcv, azimuth;
+    double    r0, dr;
+    uint32_t  nr;
+    double    z0, dz;
+    uint32_t  nz;
+  };
+
+  class Field2DWriter {
+    public:
+      // header.nr is ignored; it counts the rows written
+      Field2DWriter(std::string filename, const Field2DHeader &header);
+      ~Field2DWriter();
+
+      // stores scale*p[i*stride] for i = 0 ... nz-1 as the next range row
+      void writeRow(const std::complex<double> *p, int stride, std::complex<double> scale);
+      void close();
+
+    private:
+      std::ofstream        out;
+      std::string          filename;
+      Field2DHeader        hdr;
+      std::vector<float>   row32;
+      std::vector<double>  row64;
+  };
+
+  class Field2DReader {
+    public:
+      Field2DReader(std::string filename);
+
+      const Field2DHeader &header();
+      double range(unsigned int ir);     // m
+      double height(unsigned int iz);    // m
+
+      // range row ir (nz values)
+      void readRow(unsigned int ir, std::complex<double> *row);
+      // the whole field, row after row (nr*nz values)
+      void readAll(std::vector< std::complex<double> > &field);
+
+    private:
+      std::ifstream        in;
+      std::string          filename;
+      Field2DHeader        hdr;
+      std::streamoff       data_start;
+  };
+}
+
+#endif
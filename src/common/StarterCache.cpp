@@ -0,0 +1,168 @@
+#include "StarterCache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+  const char     *STARTER_MAGIC   = "NCPASTRT";
+  const uint32_t  STARTER_VERSION = 1;
+}
+
+bool NCPA::StarterField::sameKey(const StarterField &other) const {
+  return type == other.type && freq == other.freq && zsrc == other.zsrc
+      && z0 == other.z0 && dz == other.dz && nz == other.nz
+      && ground_hash == other.ground_hash;
+}
+
+void NCPA::writeStarterField(string filename, const StarterField &sf) {
+  if (sf.psi.size() != sf.nz) {
+      throw invalid_argument("Starter field has the wrong number of heights");
+  }
+  ofstream out( filename.c_str(), ios_base::out | ios_base::binary );
+  if (!out.good()) {
+      throw runtime_error("Could not open starter field file " + filename);
+  }
+  uint32_t ntype = sf.type.size();
+  out.write( STARTER_MAGIC, 8 );
+  out.write( (const char *)&STARTER_VERSION, sizeof(uint32_t) );
+  out.write( (const char *)&ntype, sizeof(uint32_t) );
+  out.write( sf.type.c_str(), ntype );
+  out.write( (const char *)&sf.freq, sizeof(double) );
+  out.write( (const char *)&sf.zsrc, sizeof(double) );
+  out.write( (const char *)&sf.z0, sizeof(double) );
+  out.write( (const char *)&sf.dz, sizeof(double) );
+  out.write( (const char *)&sf.nz, sizeof(uint32_t) );
+  out.write( (const char *)&sf.ground_hash, sizeof(uint64_t) );
+  for (uint32_t i=0; i<sf.nz; i++) {
+      double re = real(sf.psi[i]), im = imag(sf.psi[i]);
+      out.write( (const char *)&re, sizeof(double) );
+      out.write( (const char *)&im, sizeof(double) );
+  }
+  if (!out.good()) {
+      throw runtime_error("Error writing starter field file " + filename);
+  }
+}
+
+bool NCPA::readStarterField(string filename, StarterField &sf) {
+  ifstream in( filename.c_str(), ios_base::in | ios_base::binary );
+  if (!in.good()) {
+      throw runtime_error("Could not open starter field file " + filename);
+  }
+  char     magic[ 8 ];
+  uint32_t version, ntype;
+  in.read( magic, 8 );
+  if (!in.good() || strncmp( magic, STARTER_MAGIC, 8 ) != 0) {
+      return false;
+  }
+  in.read( (char *)&version, sizeof(uint32_t) );
+  in.read( (char *)&ntype, sizeof(uint32_t) );
+  if (!in.good() || version != STARTER_VERSION || ntype > 256) {
+      throw runtime_error(filename + " is not a version 1 starter field file!");
+  }
+  vector<char> type(ntype + 1, '\0');
+  in.read( &type[0], ntype );
+  sf.type = &type[0];
+  in.read( (char *)&sf.freq, sizeof(double) );
+  in.read( (char *)&sf.zsrc, sizeof(double) );
+  in.read( (char *)&sf.z0, sizeof(double) );
+  in.read( (char *)&sf.dz, sizeof(double) );
+  in.read( (char *)&sf.nz, sizeof(uint32_t) );
+  in.read( (char *)&sf.ground_hash, sizeof(uint64_t) );
+  if (!in.good()) {
+      throw runtime_error("Bad header in starter field file " + filename);
+  }
+  vector<double> buf(2*sf.nz);
+  in.read( (char *)&buf[0], buf.size()*sizeof(double) );
+  if (!in.good()) {
+      throw runtime_error("Error reading starter field file " + filename);
+  }
+  sf.psi.resize(sf.nz);
+  for (uint32_t i=0; i<sf.nz; i++) {
+      sf.psi[i] = complex<double>(buf[2*i], buf[2*i+1]);
+  }
+  return true;
+}
+
+
+NCPA::StarterCache::StarterCache(string dirname) {
+  dir    = dirname;
+  hits   = 0;
+  misses = 0;
+}
+
+uint64_t NCPA::StarterCache::hash(const void *data, size_t nbytes, uint64_t h) {
+  const unsigned char *p = (const unsigned char *) data;
+  for (size_t i=0; i<nbytes; i++) {
+      h ^= p[i];
+      h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+uint64_t NCPA::StarterCache::keyHash(const StarterField &sf) {
+  uint64_t h = hash(sf.type.c_str(), sf.type.size());
+  h = hash(&sf.freq, sizeof(double), h);
+  h = hash(&sf.zsrc, sizeof(double), h);
+  h = hash(&sf.z0, sizeof(double), h);
+  h = hash(&sf.dz, sizeof(double), h);
+  h = hash(&sf.nz, sizeof(uint32_t), h);
+  return hash(&sf.ground_hash, sizeof(uint64_t), h);
+}
+
+string NCPA::StarterCache::entryFile(uint64_t key) {
+  char name[ 32 ];
+  snprintf(name, sizeof(name), "starter_%016llx.bin", (unsigned long long) key);
+  return dir + "/" + name;
+}
+
+bool NCPA::StarterCache::lookup(StarterField &sf) {
+  uint64_t key = keyHash(sf);
+  pair< multimap<uint64_t, StarterField>::iterator, multimap<uint64_t, StarterField>::iterator > r = entries.equal_range(key);
+  for (multimap<uint64_t, StarterField>::iterator it = r.first; it != r.second; ++it) {
+      if (it->second.sameKey(sf)) {
+          sf.psi = it->second.psi;
+          hits++;
+          return true;
+      }
+  }
+
+  if (!dir.empty()) {
+      string filename = entryFile(key);
+      ifstream probe( filename.c_str() );
+      if (probe.good()) {
+          probe.close();
+          StarterField stored;
+          // a damaged entry is simply recomputed and rewritten
+          try {
+              if (readStarterField(filename, stored) && stored.sameKey(sf)) {
+                  entries.insert(make_pair(key, stored));
+                  sf.psi = stored.psi;
+                  hits++;
+                  return true;
+              }
+          }
+          catch (runtime_error &) {}
+      }
+  }
+  misses++;
+  return false;
+}
+
+void NCPA::StarterCache::store(const StarterField &sf) {
+  uint64_t key = keyHash(sf);
+  entries.insert(make_pair(key, sf));
+  if (!dir.empty()) {
+      writeStarterField(entryFile(key), sf);
+  }
+}
+
+int NCPA::StarterCache::getHits() {
+  return hits;
+}
+
+int NCPA::StarterCache::getMisses() {
+  return misses;
+}
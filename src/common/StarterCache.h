@@ -0,0 +1,74 @@
+#ifndef _STARTERCACHE_H_
+#define _STARTERCACHE_H_
+
+#include <complex>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace NCPA {
+
+  //
+  // A PE starter field psi(z) on a regular height grid, together with
+  // everything it was computed from: the starter type, frequency, source
+  // height, the grid itself and a hash of the lower-boundary data (the
+  // profile near the ground, or the contents of a modal starter file).
+  //
+  // The same layout is used for the modal starters ModESS writes in binary
+  // and for the entries StarterCache keeps on disk, in native byte order:
+  //   char[8]   "NCPASTRT"
+  //   uint32    format version (1)
+  //   uint32    length of the type name, followed by the name
+  //   float64   frequency (Hz), source height (m)
+  //   float64   first height, height spacing (m)
+  //   uint32    number of heights
+  //   uint64    lower-boundary hash
+  // followed by nz (Re psi, Im psi) pairs in height order.
+  //
+  struct StarterField {
+    std::string                        type;
+    double                             freq, zsrc;
+    double                             z0, dz;
+    uint32_t                           nz;
+    uint64_t                           ground_hash;
+    std::vector< std::complex<double> > psi;
+
+    // same type, frequency, source height, grid and lower boundary
+    bool sameKey(const StarterField &other) const;
+  };
+
+  void writeStarterField(std::string filename, const StarterField &sf);
+  // false if the file is not a binary starter field (e.g. a text modal starter)
+  bool readStarterField(std::string filename, StarterField &sf);
+
+  //
+  // Starter fields already computed in this run, and optionally in earlier
+  // runs: entries are kept in memory and, if a directory is given, also
+  // stored there as one file per key so the next run can reuse them.
+  //
+  class StarterCache {
+    public:
+      StarterCache(std::string dirname = "");
+
+      // fills sf.psi and returns true if a field with sf's key is cached
+      bool lookup(StarterField &sf);
+      void store(const StarterField &sf);
+
+      int  getHits();
+      int  getMisses();
+
+      // FNV-1a, continued from h
+      static uint64_t hash(const void *data, size_t nbytes, uint64_t h = 14695981039346656037ULL);
+
+    private:
+      uint64_t    keyHash(const StarterField &sf);
+      std::string entryFile(uint64_t key);
+
+      std::string                              dir;
+      std::multimap<uint64_t, StarterField>    entries;
+      int                                      hits, misses;
+  };
+}
+
+#endif
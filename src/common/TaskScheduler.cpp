@@ -0,0 +1,320 @@
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "TaskScheduler.h"
+
+using namespace NCPA;
+using namespace std;
+
+
+// orders task indices by decreasing cost; ties keep task order
+struct TaskCostCompare {
+  const vector<double> *cost;
+  bool operator()(int a, int b) const {
+    if ((*cost)[a] != (*cost)[b]) {
+      return (*cost)[a] > (*cost)[b];
+    }
+    return a < b;
+  }
+};
+
+
+NCPA::TaskScheduler::TaskScheduler(int Ntasks1, int jobs1, string outfile1)
+{
+  init(Ntasks1, jobs1, vector<string>(1, outfile1));
+}
+
+
+NCPA::TaskScheduler::TaskScheduler(int Ntasks1, int jobs1, const vector<string> &outfiles1)
+{
+  init(Ntasks1, jobs1, outfiles1);
+}
+
+
+void NCPA::TaskScheduler::init(int Ntasks1, int jobs1, const vector<string> &outfiles1)
+{
+  Ntasks      = Ntasks1;
+  jobs       = (jobs1 < 1) ? 1 : jobs1;
+  if (jobs > Ntasks) {
+      jobs = (Ntasks < 1) ? 1 : Ntasks;
+  }
+  outfiles   = outfiles1;
+  current    = -1;
+  notify_fd  = -1;
+  shared_pos = NULL;
+  is_worker  = false;
+  finished   = false;
+  fp.assign(outfiles.size(), (FILE *) NULL);
+  cost.assign(Ntasks, 1.0);
+}
+
+
+NCPA::TaskScheduler::~TaskScheduler()
+{
+  closeFiles();
+  if (is_worker && !finished) {
+      // a worker must never fall back into the caller's code path
+      // (e.g. after an error return from the solver)
+      fflush(stdout);
+      _exit(1);
+  }
+  if (shared_pos != NULL) {
+      munmap(shared_pos, sizeof(int));
+  }
+}
+
+
+int NCPA::TaskScheduler::getJobs() {
+  return jobs;
+}
+
+
+void NCPA::TaskScheduler::setCost(int ii, double c) {
+  if ((ii >= 0) && (ii < Ntasks)) {
+      cost[ii] = c;
+  }
+}
+
+
+string NCPA::TaskScheduler::partName(int k, int ii) {
+  std::ostringstream fn;
+  fn << outfiles[k] << ".part" << ii;
+  return fn.str();
+}
+
+
+// opens the part files of task ii, or the output files themselves if ii < 0
+void NCPA::TaskScheduler::openFiles(int ii) {
+  for (size_t k = 0; k < outfiles.size(); k++) {
+      if (!outfiles[k].empty()) {
+          string name = (ii < 0) ? outfiles[k] : partName(k, ii);
+          fp[k] = fopen(name.c_str(), "w");
+      }
+  }
+}
+
+
+void NCPA::TaskScheduler::closeFiles() {
+  for (size_t k = 0; k < fp.size(); k++) {
+      if (fp[k] != NULL) {
+          fclose(fp[k]);
+          fp[k] = NULL;
+      }
+  }
+}
+
+
+//
+// Returns true in every process that should go on to run tasks:
+// the calling process itself when running serially, or each forked worker.
+// In the parent of a parallel run it returns false, after all workers have
+// exited and their results have been merged.
+//
+bool NCPA::TaskScheduler::run() {
+
+  if (jobs == 1) {
+      openFiles(-1);
+      return true;
+  }
+
+  // largest-first order of the task indices
+  order.resize(Ntasks);
+  for (int ii = 0; ii < Ntasks; ii++) {
+      order[ii] = ii;
+  }
+  TaskCostCompare cmp;
+  cmp.cost = &cost;
+  std::stable_sort(order.begin(), order.end(), cmp);
+
+  shared_pos = (int *) mmap(NULL, sizeof(int), PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared_pos == MAP_FAILED) {
+      shared_pos = NULL;
+      throw runtime_error("TaskScheduler: could not map shared work counter");
+  }
+  *shared_pos = 0;
+
+  int fds[2];
+  if (pipe(fds) != 0) {
+      throw runtime_error("TaskScheduler: could not create pipe");
+  }
+
+  cout << "Scheduling " << Ntasks << " tasks on " << jobs
+       << " processes, most expensive first" << endl;
+
+  // don't let the workers inherit (and repeat) buffered output
+  fflush(stdout);
+  fflush(stderr);
+
+  for (int w = 0; w < jobs; w++) {
+      pid_t pid = fork();
+      if (pid == 0) {
+          close(fds[0]);
+          notify_fd = fds[1];
+          is_worker = true;
+          workers.clear();
+          return true;
+      }
+      else if (pid < 0) {
+          std::ostringstream es;
+          es << "TaskScheduler: fork failed: " << strerror(errno);
+          throw runtime_error(es.str());
+      }
+      workers.push_back(pid);
+  }
+
+  close(fds[1]);
+  collect(fds[0]);
+  close(fds[0]);
+  return false;
+}
+
+
+//
+// Parent side: receive completed task indices from the workers and
+// append each part file to its output as soon as all lower tasks
+// are in.
+//
+void NCPA::TaskScheduler::collect(int read_fd) {
+  vector<FILE *> out(outfiles.size(), (FILE *) NULL);
+  for (size_t k = 0; k < outfiles.size(); k++) {
+      if (!outfiles[k].empty()) {
+          out[k] = fopen(outfiles[k].c_str(), "w");
+      }
+  }
+
+  vector<char> done(Ntasks, 0);
+  int next_write = 0;
+  int ii;
+  char buf[65536];
+
+  while (true) {
+      ssize_t nr = read(read_fd, &ii, sizeof(int));
+      if (nr == 0) {
+          break;                      // all workers closed the pipe
+      }
+      if (nr < 0) {
+          if (errno == EINTR) continue;
+          break;
+      }
+      if ((nr != sizeof(int)) || (ii < 0) || (ii >= Ntasks)) {
+          continue;
+      }
+      done[ii] = 1;
+
+      while ((next_write < Ntasks) && done[next_write]) {
+          for (size_t k = 0; k < out.size(); k++) {
+              if (out[k] == NULL) {
+                  continue;
+              }
+              string part = partName(k, next_write);
+              FILE *in = fopen(part.c_str(), "r");
+              if (in != NULL) {
+                  size_t n;
+                  while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+                      fwrite(buf, 1, n, out[k]);
+                  }
+                  fclose(in);
+                  remove(part.c_str());
+              }
+              fflush(out[k]);
+          }
+          next_write++;
+      }
+  }
+
+  for (size_t k = 0; k < out.size(); k++) {
+      if (out[k] != NULL) {
+          fclose(out[k]);
+      }
+  }
+
+  int failed = 0;
+  for (size_t w = 0; w < workers.size(); w++) {
+      int status = 0;
+      waitpid(workers[w], &status, 0);
+      if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+          failed++;
+      }
+  }
+  workers.clear();
+
+  if (failed || (next_write < Ntasks)) {
+      std::ostringstream es;
+      es << "TaskScheduler: " << failed << " worker process(es) failed; "
+         << (Ntasks - next_write) << " tasks were not written to "
+         << (outfiles.empty() ? string("") : outfiles[0]);
+      throw runtime_error(es.str());
+  }
+}
+
+
+void NCPA::TaskScheduler::notifyDone() {
+  closeFiles();
+  if ((current >= 0) && (notify_fd >= 0)) {
+      ssize_t nw;
+      do {
+          nw = write(notify_fd, &current, sizeof(int));
+      } while ((nw < 0) && (errno == EINTR));
+  }
+  current = -1;
+}
+
+
+//
+// Gets the next task index for this process; returns false when there
+// are no tasks left.  In a worker this also reports the previous
+// task as complete, so a 'continue' in the caller's loop is fine.
+//
+bool NCPA::TaskScheduler::next(int *ii) {
+  if (!is_worker) {
+      current++;
+      if (current >= Ntasks) {
+          return false;
+      }
+      *ii = current;
+      return true;
+  }
+
+  notifyDone();
+  int pos = __sync_fetch_and_add(shared_pos, 1);
+  if (pos >= Ntasks) {
+      return false;
+  }
+  current = order[pos];
+  openFiles(current);
+  *ii = current;
+  return true;
+}
+
+
+FILE *NCPA::TaskScheduler::output(int k) {
+  if ((k < 0) || (k >= (int) fp.size())) {
+      return NULL;
+  }
+  return fp[k];
+}
+
+
+//
+// Closes the output.  Workers report their last task and exit here.
+//
+void NCPA::TaskScheduler::finish() {
+  if (!is_worker) {
+      closeFiles();
+      return;
+  }
+  notifyDone();
+  close(notify_fd);
+  finished = true;
+  fflush(stdout);
+  fflush(stderr);
+  _exit(0);
+}
@@ -0,0 +1,79 @@
+#ifndef _TASKSCHEDULER_H_
+#define _TASKSCHEDULER_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace NCPA {
+
+  //
+  // Distributes Ntasks independent tasks (e.g. the frequencies of a broadband
+  // run, or the source cases of a batch run) over 'jobs' worker processes.
+  // Tasks are handed out most-expensive-first from a shared counter, so a
+  // worker that finishes early simply takes the next task instead of idling
+  // behind a fixed partition.  Each worker writes one part file per task; the
+  // parent process streams the parts into the single output file in task
+  // order as soon as they are complete.
+  //
+  // A run may produce several output files (e.g. a lossy and a lossless
+  // transmission loss); each gets its own part files and is merged the same
+  // way, and output(k) is the k-th of them.  An empty file name means the
+  // tasks write nothing there.
+  //
+  // Worker processes are used rather than threads because PETSc/SLEPc (and
+  // FFTW planning) are not thread-safe; each worker initializes them on its own.
+  //
+  // With jobs <= 1 no processes are forked and the tasks are visited in
+  // order, writing straight to the output file.
+  //
+  // Typical use:
+  //    TaskScheduler sched(Ntasks, jobs, filename);
+  //    for (ii...) sched.setCost(ii, estimated_cost);   // only if jobs > 1
+  //    if (sched.run()) {          // false in the parent once all is merged
+  //        ... initialize SLEPc ...
+  //        while (sched.next(&ii)) { ... write to sched.output() ... }
+  //        ... finalize SLEPc ...
+  //        sched.finish();         // workers exit here
+  //    }
+  //
+  class TaskScheduler {
+    public:
+      TaskScheduler(int Ntasks, int jobs, std::string outfile);
+      TaskScheduler(int Ntasks, int jobs, const std::vector<std::string> &outfiles);
+      ~TaskScheduler();
+
+      int  getJobs();
+      void setCost(int ii, double cost);
+
+      bool run();
+      bool next(int *ii);
+      FILE *output(int k = 0);
+      void finish();
+
+    private:
+      int    Ntasks;
+      int    jobs;
+      int    current;       // task index in progress in this process
+      int    notify_fd;     // worker end of the completion pipe
+      int    *shared_pos;   // position in 'order' shared by all workers
+      bool   is_worker;
+      bool   finished;
+
+      std::vector<std::string>  outfiles;
+      std::vector<FILE *>       fp;       // output files (serial) or current part files (worker)
+      std::vector<double>       cost;
+      std::vector<int>          order;
+      std::vector<pid_t>        workers;
+
+      void init(int Ntasks, int jobs, const std::vector<std::string> &outfiles);
+      std::string partName(int k, int ii);
+      void openFiles(int ii);
+      void closeFiles();
+      void notifyDone();
+      void collect(int read_fd);
+  };
+}
+
+#endif
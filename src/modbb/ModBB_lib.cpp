@@ -4,6 +4,8 @@
 #include <fftw3.h>
 #include "anyoption.h"
 #include "ModBB_lib.h"
+#include "BroadbandSynthesis.h"
+#include "DispersionStore.h"
 #include "util.h"
 
 using namespace NCPA;
@@ -85,6 +87,25 @@ int readDispersion_bb_ascii(string filen, double *f_vec, int *mode_count, \
   return 0; 
 }
 
+
+int readDispersion_bb_store(string filen, double *f_vec, int *mode_count, \
+						    double *prho_zsrc, double *prho_zrcv, double **re_k, double **im_k, \
+							double **mode_S, double **mode_R)
+{
+  // same as readDispersion_bb_ascii() for a dispersion container;
+  // the arrays must hold getNfreq()+1 frequencies
+  int n;
+  RealModeSet modes(mode_count, re_k, im_k, mode_S, mode_R);
+
+  printf("--> Reading dispersion container %s\n", filen.c_str());
+  f_vec[0] = 0; // the DC frequency
+  mode_count[0] = 0;
+  n = readDispersionStore(filen, modes, 1, f_vec, prho_zsrc, prho_zrcv, MAX_MODES);
+  printf("--> Found modes at %d positive frequencies in file %s\n", n, filen.c_str());
+
+  return 0; 
+}
+
 int count_rows_arbcol(const char *filename) {
   int answer,c;
   FILE *f=fopen(filename,"r");
@@ -627,126 +648,6 @@ int get_source_spectrum( \
 
 
 
-// -----------------------------------------------------------------------
-// DV 20151017: Added NFFT as argument 
-// 20130710 - 'fft_pulse_prop' with comments
-// dft_vec has the source spectrum (for positive frequencies)
-// arg_vec will hold the (delayed Fourier pressure component)*source_spectrum*df
-// pulse_vec is the fft(arg_vec) i.e. the time domain propagated waveform (pulse)
-void fft_pulse_prop(double t0, int n_freqs, int NFFT, double df, double *f_vec, \
-                    double range, complex<double> *dft_vec, \
-                    complex<double> *pulse_vec, \
-                    int *mode_count, double rho_zsrc, double rho_zrcv, \
-                    double **re_k, double **im_k, \
-                    double **mode_S, double **mode_R)
-{
-  int i,i0,j,smooth_space;
-  double sqrt_rho_ratio = sqrt(rho_zrcv/rho_zsrc);
-  complex<double> cup,pot,k_H,mode_prod,t_phase,*arg_vec;
-  complex<double> I (0.0, 1.0);
-  complex<double> expov8pir = I*exp(-I*Pi*0.25)/sqrt(8.0*Pi*range);
-  
-  fftw_plan p;
-
-  if(NFFT < n_freqs){
-      throw invalid_argument("fft too short (i.e. NFFT < n_freqs), exiting.");
-  }
-  
-  arg_vec = new complex<double> [NFFT];
-
-  //printf("!!! in fft_pulse_prop: sqrt_rho_ratio = %g\n", sqrt_rho_ratio);
-  
-  
-  // old left zero-pad; sometimes with a C compiler it gives i=2 even if fvec[0]=df
-  // so I rewrote it below; DV
-  //for(i=0;i*df<f_vec[0];i++) arg_vec[i]=0.0; // left zero pad up to f_min present in the spectrum;
-  
-  // new left zero pad up to f_min present in the spectrum;
-  //for(i=0;(fabs(i*df-f_vec[0])>1.0e-10) & (i*df<f_vec[0]); i++) arg_vec[i]=0.0;
-  //printf("in fft_pulse_prop:f_vec[0] = %f; df = %f; i=%d\n", f_vec[0], df, i);
-
-  for(i=0;i*df<0.99*f_vec[0];i++) arg_vec[i]=0.0; // left zero pad
-  i0 = i;
-  for(i=0;i<n_freqs;i++){
-      t_phase=exp(-I*2.0*Pi*f_vec[i]*t0); // corresponding to reduced time t0; note f_vec[i+1]
-      cup=0.0;
-      for(j=0;j<mode_count[i];j++){
-          k_H = re_k[i][j]+I*im_k[i][j];
-          pot = exp(I*range*k_H);
-          mode_prod = mode_S[i][j]*mode_R[i][j];
-          pot = mode_prod*pot;
-          pot = pot/sqrt(k_H);
-          cup = cup+pot; // modal sum: sum( exp(ikr)/sqrt(k)*Vr*Vs )
-      }
-      cup=cup*t_phase;
-      
-      // up to a factor ((delayed Fourier pressure component)*source_spectrum*df) 
-      // (see eq. 5.14 pg 274 and eq. 8.9 pg 480 in Comp. Oc. Acoust. 1994 ed.)
-      //cup=cup*dft_vec[i]*df;
-      cup=cup*dft_vec[i]; // will multiply by df at the end; note f_vec[i+1]
-
-      // the reduced pressure is defined as: 
-      // (actual pressure)/sqrt(rho(z)): p_reduced(r,z) = p(r,z)/sqrt(rho(z))
-
-      // Note on mode scaling in this code vs. the modes in Computational Oc. Acoust. 1994: 
-      // V_book =  sqrt(rho)*V_in_this_code; 
-      // Thus the formula for the Fourier component of pressure using the modes in this code
-      // is given in DV Modess notes eq. 25 pg. 3 and contains the factor sqrt_rho_ratio
-      // as opposed to the factor 1/rho(z_s) in the book eq. 5.14 pg 274.
-      arg_vec[i0+i] = expov8pir*cup*sqrt_rho_ratio; // note sqrt_rho_ratio
-      //arg_vec[i0+i]=sqrt(I/(8.0*Pi*range))*cup;
-
-  }
-
-  smooth_space=(int)floor(0.1*n_freqs); // smoothly zero out on right; as in RW (July 2012)
-
-  for(i=n_freqs-smooth_space;i<n_freqs;i++){
-      //arg_vec[i]=arg_vec[i]*half_hann(n_freqs-smooth_space,n_freqs-df,i); // old code : has df in it
-      arg_vec[i]=arg_vec[i]*half_hann(n_freqs-smooth_space,n_freqs-1,i); // changed df to 1 as df doesn't make sense here
-  }
-  for(;i<NFFT;i++) arg_vec[i] = 0.0; // right zero pad
-  
-  // save arg_vec for debugging purposes
-  if (0) {
-      FILE *fp = fopen("modbb_arg_vec.dat", "w");
-      for (i=0; i<NFFT; i++) {
-          fprintf(fp, "%12.9f %15.6e %15.6e\n", 1.0*i*df, real(arg_vec[i]), imag(arg_vec[i]));
-      }
-      fclose(fp);
-      printf("arg_vec saved in file 'modbb_arg_vec.dat' with format: i*df | Re(arg_vec) | Im(arg_vec)\n");
-
-      //for(int n=0; n<5; n++) {
-      //  printf("k[n][0]=%g\n", re_k[n][0]);
-      //}
-
-      fp = fopen("modbb_dft_vec.dat", "w");
-      for (i=0; i<n_freqs; i++) {
-          fprintf(fp, "%12.9f %15.6e %15.6e\n", 1.0*i*df, real(dft_vec[i]), imag(dft_vec[i]));
-      }
-      fclose(fp);
-      printf("dft_vec saved in file 'modbb_dft_vec.dat' with format: i*df | Re(dft_vec) | Im(dft_vec)\n");
-  }
-   
-  // 
-  //perform fft of arg_vec to obtain the propagated time domain pulse
-  //
-  p=fftw_plan_dft_1d(NFFT, reinterpret_cast<fftw_complex*>(arg_vec), \
-                           reinterpret_cast<fftw_complex*>(pulse_vec), \
-											FFTW_FORWARD,FFTW_ESTIMATE); 												 
-  fftw_execute(p); 
-  fftw_destroy_plan(p);
-  
-  // multiply by df to complete the Fourier integral 
-  for(i=0;i<NFFT;i++){
-    pulse_vec[i] = df*pulse_vec[i];
-  }
-
-  delete [] arg_vec;
-}  // end of debug version of 'fft_pulse_prop'
-//-----------------------------------------------------------------------
-
-
-
 // DV 20151017: Added NFFT as argument
 // DV 20160717: Added no_attenuation flag
 int pulse_prop_src2rcv_grid2(\
@@ -755,7 +656,8 @@ int pulse_prop_src2rcv_grid2(\
           int n_freqs, int NFFT,  double f_step, double *f_vec, \
           double f_center, int *mode_count, double rho_zsrc, double rho_zrcv, \
           double **re_k, double **im_k, double **mode_S, double **mode_R, \
-          int src_flg, string srcfile, int pprop_src2rcv_flg, bool zero_attn_flg) 
+          int src_flg, string srcfile, int pprop_src2rcv_flg, bool zero_attn_flg, \
+          bool packed_flg) 
 {
   int i,n;
   double rr, tskip, fmx, t0;	
@@ -790,6 +692,11 @@ int pulse_prop_src2rcv_grid2(\
 								      
   get_source_spectrum(n_freqs, NFFT, f_step, f_vec,  f_center, \
 					  dft_vec, pulse_vec, arg_vec, src_flg, srcfile);
+
+  // the modal data are packed once for all the ranges (unless --synthesis_form direct)
+  RealModeSet modes(mode_count, re_k, im_k, mode_S, mode_R);
+  BroadbandSynthesis<RealModeSet> synth(modes, n_freqs, NFFT, f_step, f_vec, rho_zsrc, rho_zrcv, \
+                                        packed_flg);
 	
 	if (pprop_src2rcv_flg) { // propagation to one receiver at distance RR from source
 	    cout << "--> Doing pulse propagation source-to-receiver at one range: " 
@@ -800,9 +707,7 @@ int pulse_prop_src2rcv_grid2(\
 	    // fft propagation: note that here 'pulse_vec' is overwritten with the propagated pulse
 	    //							
 								      
-      fft_pulse_prop( t0, n_freqs, NFFT, f_step, f_vec, R_start, \
-                      dft_vec, pulse_vec, mode_count, rho_zsrc, rho_zrcv, \
-                      re_k, im_k, mode_S, mode_R);						      
+      synth.propagate( t0, R_start, dft_vec, pulse_vec );
       
       // save propagated pulse to file
 	  // DV 20150514 - factor of two necessary because we only used 
@@ -834,10 +739,7 @@ int pulse_prop_src2rcv_grid2(\
           t0=tskip+rr/max_cel;
           printf("%8.3f     %9.3f      %9.3f\n", max_cel, t0, rr/1000.0);
 
-          // the call with NFFT as argument			            
-          fft_pulse_prop( t0, n_freqs, NFFT, f_step, f_vec, rr, \
-                          dft_vec, pulse_vec, mode_count, rho_zsrc, rho_zrcv, \
-                          re_k, im_k, mode_S, mode_R);					            
+          synth.propagate( t0, rr, dft_vec, pulse_vec );
 
           // DV 20170810 - parameter 'factor' to make it easy to agree with other codes 
           // (e.g. Roger Waxler's modal code)
@@ -854,6 +756,8 @@ int pulse_prop_src2rcv_grid2(\
       printf("Propagation results saved in file: %s\n", filename);
       printf("with columns: R (km) | time (s) | pulse(R,t) |\n");
   }
+  printf("Modal sums (%s form, FFT excluded): %g s\n", \
+         packed_flg ? "packed" : "direct", synth.sumSeconds());
 
   delete [] dft_vec;
   delete [] arg_vec;
@@ -1032,142 +936,6 @@ int plotInitialPulse(int src_flg, double freq, double fmax) {
 */
 
 
-int getFile_list(string dir, list<string> &files, string pattern)
-{
-  int pos = -1;
-  string a;
-  DIR *dp;
-  struct dirent *dirp;
-  if((dp = opendir(dir.c_str())) == NULL) {
-      std::ostringstream es;
-      es << "Error opening directory:" << dir;
-      throw invalid_argument(es.str());
-  }
-
-  while ((dirp = readdir(dp)) != NULL) {
-      a = string(dirp->d_name);
-      pos = a.find(pattern);
-      if (pos>=0) {
-          //cout << a << " pos=" << pos << endl;
-          files.push_back(string(dirp->d_name));
-      }
-      else {
-          //cout << "this file does not fit pattern: " << a << endl;
-      }
-  }
-  closedir(dp);
-  return 0;
-}
-
-
-complex<double> ***getPz1z2 (int I1, int I2, double r1, double r2, double dr, string dirn, list<string> files, bool zero_attn_flg) 
-{
-  int lenI, ier;
-  int ir, j, jj, iz;
-  int Nfreq, Nz_grid, Nz_subgrid, nmods;
-  //double NN;
-  int Nrng_steps = (int) (r2-r1)/dr+1;  
-
-  double rho_zsrc, *rho_rcv, sqrtrho;
-  double *kr, *ki;
-  double *vs, **vr;
-  double rr, df, dz, delZ, z_min, freq;
-  complex<double> kH, epio8, epio8ovr, sumM;
-  complex<double> II (0.0, 1.0);
-  complex<double> ***Pfzr;  
-  FILE *fp;
-  list<string>::iterator it;  
-
-  int    szi = sizeof(int);
-  double szd = sizeof(double);
-  int Nfiles = files.size();
-  std::string fullname;
-
-  lenI = I2-I1+1;
-  epio8 = II*exp(-II*(Pi/4.0))/sqrt(8.0*Pi);
-
-  // allocate 3-rank tensor
-  Pfzr = NCPA::c3Darray(Nfiles, Nrng_steps, lenI);
-
-  // iterate over sorted file list
-  jj = 0;
-  for (it=files.begin(); it!=files.end(); ++it) {
-  
-      cout << "Iteration " << jj << "; processing file: " << (*it) << endl;
-
-      fullname = dirn + "/" + (*it);
-      fp = fopen(fullname.c_str(), "r");
-      if (fp==NULL) {
-          std::ostringstream es;
-          es << "file << " << fullname << " could not be opened.\n";
-          throw invalid_argument(es.str());
-      }
-
-      ier = fread(&freq,       szd, 1, fp);
-      ier = fread(&nmods,      szi, 1, fp);		
-      ier = fread(&Nfreq,      szi, 1, fp);
-      ier = fread(&df,         szd, 1, fp);
-      ier = fread(&Nz_grid,    szi, 1, fp);
-      ier = fread(&dz,         szd, 1, fp);      
-      ier = fread(&Nz_subgrid, szi, 1, fp);
-      ier = fread(&delZ,       szd, 1, fp);
-      ier = fread(&z_min,      szd, 1, fp);
-      ier = fread(&rho_zsrc,   szd, 1, fp);
-      
-      //NN = Nz_grid/Nz_subgrid; // integer division
-
-      if (nmods>0) {
-          kr      = new double [nmods];
-          ki      = new double [nmods];
-          vs      = new double [nmods];
-          rho_rcv = new double [lenI];
-          vr      = dmatrix(lenI, nmods);
-
-          // read 4(ints) + 6(doubles) = 4*4+6*8 = 64 bytes so far
-          ier = fread(kr, szd, nmods, fp);
-          ier = fread(ki, szd, nmods, fp);
-          ier = fread(vs, szd, nmods, fp);
-
-          // at each z on the z-subgrid we saved (nmods+1) doubles i.e.
-          // we offset to the requested altitude specified by I1: I1*(nmods+1)*szd bytes
-          fseek(fp, (I1)*(nmods+1)*szd, SEEK_CUR);
-            
-          for (iz=0; iz<lenI; iz++) { // at each z level reading (nmods+1)*szd bytes
-              ier = fread(&rho_rcv[iz], szd, 1, fp);  // read rho at all subgrid heights
-              ier = fread(vr[iz], szd, nmods, fp);
-          }
-
-          rr = r1;
-          for (ir=0; ir<Nrng_steps; ir++) {
-              epio8ovr = epio8/sqrt(rr*rho_zsrc);
-              for (iz=0; iz<lenI; iz++) {
-                  sumM = complex<double> (0.0, 0.0);
-                  sqrtrho = sqrt(rho_rcv[iz]);
-                  for (j=0; j<nmods; j++) {
-                      //kH =  kr[j] + II*ki[j];
-                      // 20160717 taking zero_attn_flg into consideration 
-                      kH =  kr[j] + (II*ki[j])*(1.0-(double)zero_attn_flg); // 20160717					
-                      sumM += vs[j]*vr[iz][j]*sqrtrho*exp(II*kH*rr)/sqrt(kH);     
-                  }
-                  Pfzr[jj][ir][iz] = epio8ovr*sumM;
-              }
-              rr = rr + dr;
-          }
-
-          delete[] kr;
-          delete[] ki;
-          delete[] vs;
-          delete[] rho_rcv;
-          free_dmatrix(vr,lenI,nmods);
-      }
-      fclose(fp);
-      jj++;
-  } // end for loop by files
-  ier = ier + 1; // useless line just to avoid warning by the compiler that 'ier' is not used
-  //printf(" ... Pfzr done.\n");
-  return Pfzr;
-}
-
 /*
 complex<double> **cmatrix(long nr, long nc) {
   // allocate a complex<double> matrix
@@ -1238,29 +1006,6 @@ void free_c3Darray(std::complex<double> ***data, size_t xlen, size_t ylen)
 }
 */
 
-// comparison, freq in filename.
-bool compare_freq (string first, string second)
-{
-  string a, b;
-  string patt1 ("_");
-  string patt2 ("_nm.bin");
-  size_t pos1, pos2;
-  double x, y;
-    
-  pos2 = first.find(patt2);
-  pos1 = first.rfind(patt1, pos2-1) + patt1.length();
-  
-  a = first.substr(pos1, pos2-pos1);
-  b = second.substr(pos1, pos2-pos1);
-  
-  x = strtod(a.c_str(), NULL);
-  y = strtod(b.c_str(), NULL);
-
-  if (x<y) {return true; }
-  else     {return false;}
-}
-
-
 // DV 20160717 - added zero_atten flag
 int process2DPressure(double R_start_km, double width_km, double height_km, \
                       double c_ref, double tmstep, int ntsteps, double f_center, \
@@ -1268,75 +1013,22 @@ int process2DPressure(double R_start_km, double width_km, double height_km, \
                       bool zero_attn_flg) 
 {
   // compute the 2D spatial pressure field in (width_km by height_km) window 
-  // starting at R_start_km
-  // cout << "in process2DPressure():\n";
-  
-  char   filename [256]; // holds the frame file name(s)
-  int    i, j, ier, m, n, k, Nx, Nz, NN, zs;
-  int    I1, I2, lenI;
-  int    Nfreq, Nz_grid, Nz_subgrid, nmods, Nfiles;
-  double tmin, tt;
-  //double tmax;
-  double freq, fr, df, f_max;	
-  double dz, delZ, z_min;
-  double r1, r2, dr, sumP;
+  // starting at R_start_km; the frames are written by the code shared with
+  // CModBB (see BroadbandSynthesis.h)
+  int    i, Nfreq;
+  double df;
   double *f_vec;
-  double **pp;
-
   complex<double> *S, *pulse_vec, *arg_vec; //source spectrum
-  complex<double> II = complex<double> (0.0, 1.0);	
-  complex<double> ***Pfzr;
-  string fullname;
-  FILE *fp;
-
-  list<string> files;
-  list<string>::iterator it;
-  string pattern (".bin");
-
-  // get and sort the files (they have the frequency in the name)
-  getFile_list(dirn, files, pattern);
-  files.sort(compare_freq);
-
-  if (0) { //print the sorted file list
-      cout << "sorted list contains:" << endl;
-      for (it=files.begin(); it!=files.end(); ++it) {
-          cout << *it << endl;
-      }
-      cout << endl;
-  }
-  
-  // get necessary info from 1 file
-  fullname = dirn + "/" + (*files.begin());
-  fp = fopen(fullname.c_str(), "r");
-  if (fp==NULL) {
-        std::ostringstream es;
-        es << "file << " << fullname << " could not be opened.";
-        throw invalid_argument(es.str());
-  }
-  ier = fread(&freq,       sizeof(double), 1, fp);
-  ier = fread(&nmods,      sizeof(int),    1, fp);		
-  ier = fread(&Nfreq,      sizeof(int),    1, fp);
-  ier = fread(&df,         sizeof(double), 1, fp);
-  ier = fread(&Nz_grid,    sizeof(int),    1, fp);
-  ier = fread(&dz,         sizeof(double), 1, fp);  
-  ier = fread(&Nz_subgrid, sizeof(int),    1, fp);
-  ier = fread(&delZ,       sizeof(double), 1, fp);
-  ier = fread(&z_min,      sizeof(double), 1, fp);
-  fclose(fp);
-  ier = ier + 1; // useless line just to avoid warning by the compiler that 'ier' is not used
 
-  f_max = Nfreq*df; // fmax
-  Nfiles = files.size();
-  
-  cout << "Nfiles    = " << Nfiles << endl;
-  cout << "Nfreq     = " << Nfreq  << endl;
-  cout << "max freq  = " << f_max  << endl;
-  cout << "delta_Z   = " << delZ   << endl;
-  cout << "freq step = " << df     << endl;
-
-  if (Nfreq != Nfiles) {
-      throw invalid_argument("Error: number of frequencies is not equal to the number of files" );
-  }
+  NCPA::DispersionGrid grid(dirn, 1);
+  Nfreq = grid.getNfreq();
+  df    = grid.getF_step();
+
+  cout << "Nfiles    = " << Nfreq        << endl;
+  cout << "Nfreq     = " << Nfreq        << endl;
+  cout << "max freq  = " << Nfreq*df     << endl;
+  cout << "delta_Z   = " << grid.getDelZ() << endl;
+  cout << "freq step = " << df           << endl;
 
   // get the source spectrum with function get_source_spectrum
   // for this we need some intermediary arrays
@@ -1357,87 +1049,14 @@ int process2DPressure(double R_start_km, double width_km, double height_km, \
 	delete [] arg_vec;
 	delete [] f_vec;						      
 
-  // the subgrid (window) parameters
-  r1   = R_start_km*1000;
-  r2   = r1 + width_km*1000;
-  dr   = delZ;          // make horizontal spacing equal to the vertical spacing
-  Nx   = (int)((r2-r1)/dr)+1;
-  Nz   = (int) (height_km*1000.0/delZ)+1;
-  tmin = r1/c_ref;
-  //tmax = r2/c_ref;
-
-  // check if enough memory is available; if not, will iterate more than once
-  long maxel = 4000000; // maximum number of elements in the window (matrix)
-  zs = Nz;              // zs = how many z-levels to be processed at a time; 
-  NN = 0;               // NN is number of iterations-1  (see loop below)
-  if (Nx*zs>maxel) {    // zs is adjusted down when not enough memory is available 
-      NN  =(Nx*zs)/maxel + 1;  // integer division (floor)
-      zs = zs/NN;              // integer division    
-  }
-
-  pp = dmatrix(zs,Nx); // allocate 2D pressure field
-  tt = tmin;
-  //cout <<"Computing the 2D pressure field..." << endl;
-  for (j=0; j<NN+1; j++) { // loop to get pressure spectrum at points on the jth subgrid of size [zs, Nx]
-      I1   = j*zs;         // zero-based index to pass to getPz1z2()
-      I2   = min(Nz-1, I1+zs-1);
-      lenI = I2-I1+1;
-      cout << "iteration = " << j+1 << " of " << NN+1 << endl;
-      
-      // get pressure field from height z(I1) to z(I2)
-      // Pfzr = getPz1z2 (I1, I2, r1, r2, dr, dirn, files); //Pfzr = c3Darray(Nfiles, Nrng_steps, lenI);
-      Pfzr = getPz1z2 (I1, I2, r1, r2, dr, dirn, files, zero_attn_flg); //Pfzr = c3Darray(Nfiles, Nrng_steps, lenI);
-			
-      for (k=0; k < ntsteps; k++) { // iterate over time steps
-          tt = tmin + k*tmstep;
-          sprintf(filename, "%s_%d.bin", framefn.c_str(), (int)floor(tt)); // filename
-
-          if (j==0)	{ // info in the file header - appears only once
-              fp = fopen(filename, "a+b");			
-              fwrite(&Nz,   1, sizeof(int),    fp);
-              fwrite(&Nx,   1, sizeof(int),    fp);
-              fwrite(&delZ, 1, sizeof(double), fp);
-              fwrite(&r1,   1, sizeof(double), fp);							
-              fwrite(&tt,   1, sizeof(double), fp);
-              fclose(fp);
-          }
-          for (n=0; n<Nx; n++) {       // for ranges on the x-grid
-              for (m=0; m<lenI; m++) { // for altitudes on z-grid							
-                  fr       = 0.0;
-                  sumP     = 0.0;
-                  pp[m][n] = 0.0;
-                  for (i=0; i<Nfreq; i++) { //integral over all positive frequencies to get pressure at (x,y,tt)
-		                  fr   = fr + df;
-		                  sumP = sumP + real(2.0*df*S[i]*Pfzr[i][n][m]*exp(-II*2.0*Pi*fr*tt));						
-                  }
-                  pp[m][n] = sumP;
-              }
-          }
-          cout << " ... saving 2D field at time " << tt << " secs to file " << filename << endl;
-          saveMatrix2bin(filename, pp, lenI, Nx);
-      }
-      NCPA::free_c3Darray(Pfzr, Nfiles, Nx);		
-  }
+  NCPA::writePressureFrames(grid, S, R_start_km, width_km, height_km, c_ref, \
+                            tmstep, ntsteps, framefn, zero_attn_flg);
 
   delete [] S;
-  free_dmatrix(pp, zs, Nx);
   return 0;
 }
 
 
-int saveMatrix2bin(const char *filename, double **M, int nr, int nc) {
-  int i,j, szd;
-  szd = sizeof(double);
-  FILE *fp = fopen(filename, "a+b");
-  for (i=0; i<nr; i++) {
-      for (j=0; j<nc; j++) {
-          fwrite(&M[i][j], szd, 1, fp);
-      }
-  }
-  fclose(fp);
-  return 0;
-}
-
 /*
 int saveAtm_profile(NCPA::SampledProfile *p, std::string wind_units) {
   int i, nz;
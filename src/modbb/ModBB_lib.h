@@ -2,6 +2,7 @@
 #include <complex>
 #include <list>
 #include "util.h"
+#include "DispersionStore.h"
 
 
 //double **dmatrix(long nr, long nc);
@@ -17,6 +18,11 @@ int readDispersion_bb_ascii(string filen, double *f_vec, int *mode_count, \
 								double *rho_zsrc, double *rho_zrcv, double **re_k, double **im_k, \
 								double **mode_S, double **mode_R);						
 
+// the same for a dispersion container (see DispersionStore.h)
+int readDispersion_bb_store(string filen, double *f_vec, int *mode_count, \
+								double *rho_zsrc, double *rho_zrcv, double **re_k, double **im_k, \
+								double **mode_S, double **mode_R);
+
 int count_rows_arbcol(const char *filename);								
 
 int writeDispersion_bb_bin(string filen, int Nz, double delZ, int NN, int select_modes, double dz, double z_src, double freq, complex<double> *k_pert, double **v_s);
@@ -37,21 +43,6 @@ int SolveModesBB(string filename, int Nfreq, double f_min, double fmax, int Nz_g
 		
 double half_hann(int begin,int end,int i);
 				
-void fft_pulse_prop(double t0, int n_freqs, double df, double *f_vec, \
-                    double range, complex<double> *dft_vec, \
-                    complex<double> *pulse_vec, \
-                    int *mode_count, double rho_zsrc, double rho_zrcv, \
-                    double **re_k, double **im_k, \
-                    double **mode_S, double **mode_R);
-
-// DV 20151017: Added NFFT as argument            
-void fft_pulse_prop(double t0, int n_freqs, int NFFT, double df, double *f_vec, \
-                    double range, complex<double> *dft_vec, \
-                    complex<double> *pulse_vec, \
-                    int *mode_count, double rho_zsrc, double rho_zrcv, \
-                    double **re_k, double **im_k, \
-                    double **mode_S, double **mode_R);
-
 // DV 20160717: Added no_attenuation flag                  
 int pulse_prop_src2rcv_grid2(\
           const char *filename,double max_cel, \
@@ -59,7 +50,8 @@ int pulse_prop_src2rcv_grid2(\
 					int n_freqs, int NFFT, double f_step, double *f_vec, \
 					double scale, int *mode_count, double rho_zsrc, double rho_zrcv, \
 					double **re_k, double **im_k, double **mode_S, double **mode_R, \
-					int src_flg, string srcfile, int pprop_src2rcv_flg, bool zero_attn_flg); 
+					int src_flg, string srcfile, int pprop_src2rcv_flg, bool zero_attn_flg, \
+					bool packed_flg); 
 									
 					
 					
@@ -88,10 +80,6 @@ void model_pulse_fft(double power, double scale, double dt, int NFFT, complex<do
 
 //int plotInitialPulse(int src_flg, double freq, double fmax);
 
-int getFile_list(string dir, list<string> &files, string pattern);	
-
-complex<double> ***getPz1z2 (int I1, int I2, double r1, double r2, double dr, string dirn, list<string> files, bool zero_attn_flg);
-
 //complex<double> **cmatrix(long nr, long nc);
 
 //int free_cmatrix(complex<double>**v, long nr, long nc);
@@ -99,16 +87,12 @@ complex<double> ***getPz1z2 (int I1, int I2, double r1, double r2, double dr, st
 //complex<double> ***c3Darray(size_t xlen, size_t ylen, size_t zlen);
 //void free_c3Darray(complex<double> ***data, size_t xlen, size_t ylen);
 
-// comparison, freq in filename.
-bool compare_freq (string first, string second);
 											
 int process2DPressure(double R_start_km, double width_km, double height_km, \
                       double c_ref, double tmstep, int ntsteps, double f_center, \
                       string framefn, string dirn, int src_flg, string srcfile, \
                       bool zero_attn_flg);											
 
-int saveMatrix2bin(const char *filename, double **M, int nr, int nc);
-
 //int saveAtm_profile(NCPA::SampledProfile *p, std::string wind_units);
 
 int load_source_pulse_td(std::string srcpulsetdfn, vector<double> &t, vector<double> &tdp );
@@ -128,7 +128,14 @@ int main( int argc, char **argv ) {
       //cout << "pprop_s2r_disp_file = " << pprop_s2r_disp_file << endl;	
 
       // get number of (positive) frequencies from the dispersion file
-      Nfreq = count_rows_arbcol(pprop_s2r_disp_file.c_str());
+      bool disp_store = NCPA::DispersionStoreReader::isStore(pprop_s2r_disp_file);
+      if (disp_store) {
+          NCPA::DispersionStoreReader store(pprop_s2r_disp_file);
+          Nfreq = store.getNfreq();
+      }
+      else {
+          Nfreq = count_rows_arbcol(pprop_s2r_disp_file.c_str());
+      }
       Nfreq = Nfreq + 1; // count the DC frequency
 
       f_vec      = new double [Nfreq];
@@ -139,8 +146,14 @@ int main( int argc, char **argv ) {
       mode_R     = dmatrix(Nfreq, MAX_MODES);
       	
       // read the dispersion file
-      readDispersion_bb_ascii(pprop_s2r_disp_file, f_vec, mode_count, \
-                              &rho_zsrc, &rho_zrcv, re_k, im_k, mode_S, mode_R);     
+      if (disp_store) {
+          readDispersion_bb_store(pprop_s2r_disp_file, f_vec, mode_count, \
+                                  &rho_zsrc, &rho_zrcv, re_k, im_k, mode_S, mode_R);
+      }
+      else {
+          readDispersion_bb_ascii(pprop_s2r_disp_file, f_vec, mode_count, \
+                                  &rho_zsrc, &rho_zrcv, re_k, im_k, mode_S, mode_R);     
+      }
 											        															
       f_step   = f_vec[1] - f_vec[0];
       max_cel  = oBB->getMax_celerity();     
@@ -156,7 +169,8 @@ int main( int argc, char **argv ) {
 								R_start, DR, R_end, Nfreq, NFFT, f_step, f_vec, \
 								f_center, mode_count, rho_zsrc, rho_zrcv, \
 								re_k, im_k, mode_S, mode_R, \
-								src_flg, src_file, pprop_s2r_flg, zero_attn_flg);
+								src_flg, src_file, pprop_s2r_flg, zero_attn_flg, \
+								!oBB->getSynthesis_form().compare("packed"));
       
       //// temporary plotInitialPulse
       //if (oBB->getPlot_flg())  {
@@ -349,6 +363,11 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( "                           phase speed. See also the --wvnum_filter flag" );
   opt->addUsage( "                           and the --c_max option." );
   opt->addUsage( " --c_max                   Specify the maximum phase speed (in m/sec)." );
+  opt->addUsage( " --jobs                    Number of processes computing the frequencies" );
+  opt->addUsage( "                           of the dispersion run [1]. Frequencies are" );
+  opt->addUsage( "                           estimated by mode count and handed out most" );
+  opt->addUsage( "                           expensive first; the output file is still" );
+  opt->addUsage( "                           written in frequency order." );
 	
   opt->addUsage( "" );
   opt->addUsage( "FLAGS (no value required after the flag itself):" );
@@ -367,6 +386,14 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( "                           the parameters:" );
   opt->addUsage( "                              --c_min   minimum phase speed (in m/sec)." );
   opt->addUsage( "                              --c_max   maximum phase speed (in m/sec)." );
+  opt->addUsage( " --dispersion_container    Write all frequencies to one indexed binary file," );
+  opt->addUsage( "                           named by --out_disp_src2rcv_file or" );
+  opt->addUsage( "                           --out_dispersion_files, instead of an ascii file" );
+  opt->addUsage( "                           or one file per frequency. Several runs (or --jobs" );
+  opt->addUsage( "                           workers) may write to the same container, and a" );
+  opt->addUsage( "                           rerun skips the frequencies it already holds." );
+  opt->addUsage( "                           The pulse propagation options accept the container" );
+  opt->addUsage( "                           in place of the dispersion file or directory." );
   opt->addUsage( "" );
   opt->addUsage( "" );
   opt->addUsage( "Options for PULSE PROPAGATION:" );
@@ -393,6 +420,8 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( " --max_celerity     Maximum celerity [340 m/s]." );
   opt->addUsage( " --nfft             Number of points used in the FFT computation. ");
   opt->addUsage( "                    Defaults to [4*f_max/f_step]." );		
+  opt->addUsage( " --synthesis_form   packed: modal sum terms computed once for all ranges;" );
+  opt->addUsage( "                    direct: recomputed at every range (for timing) [packed]." );
   
   opt->addUsage( "" );	   
   opt->addUsage( "" );
@@ -510,6 +539,7 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->setFlag( "plot");
   opt->setFlag( "use_zero_attn");
   opt->setFlag( "wvnum_filter");
+  opt->setFlag( "dispersion_container");
   
   opt->setOption( "atmosfile" );
   opt->setOption( "atmosfileorder" );
@@ -551,9 +581,11 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->setOption( "src_spectrum_file" );
   opt->setOption( "src_waveform_file" );
   opt->setOption( "nfft" );
+  opt->setOption( "synthesis_form" );
   opt->setOption( "use_attn_file" );
   opt->setOption( "c_min" );
   opt->setOption( "c_max" );
+  opt->setOption( "jobs" );
 
   // Process the command-line arguments
   opt->processFile( "./ModBB.options" );
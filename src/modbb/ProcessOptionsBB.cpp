@@ -31,7 +31,9 @@ NCPA::ProcessOptionsBB::ProcessOptionsBB(AnyOption *opt)
   wind_units     = "mpersec";  // m/s
   usrattfile     = "";             // user-provided attenuation filename
   Nfreq          = 1;          // a default number of frequencies
+  jobs           = 1;          // number of worker processes for the dispersion run
   srcfile        = "";
+  synthesis_form = "packed";   // modal sum terms packed once for all ranges
   f_center       = -1;  // must have negative initialization value; 
 		                // used later to decide if f_center is reset by input 
 		                // option used for built-in pulse
@@ -64,6 +66,9 @@ NCPA::ProcessOptionsBB::ProcessOptionsBB(AnyOption *opt)
       w_disp_flg = 1;      out_disp_file.assign(opt->getValue( "out_dispersion_files" ));
       cout << "out_dispersion_files = " << out_disp_file << endl;
   }
+
+  // all frequencies in one indexed file named by the option above
+  disp_container_flg = opt->getFlag( "dispersion_container" );
   
   // if computing dispersion ask which mode computation to be used: Modess or WMod
   if (((int)w_disp_src2rcv_flg + (int)w_disp_flg)>0) { 
@@ -287,6 +292,15 @@ NCPA::ProcessOptionsBB::ProcessOptionsBB(AnyOption *opt)
             }
   }  
 
+  // the form of the modal sums in the pulse synthesis
+  if ( opt->getValue( "synthesis_form" ) != NULL ) {
+      synthesis_form = opt->getValue( "synthesis_form" );
+      if (!( !synthesis_form.compare("packed") || !synthesis_form.compare("direct") ) ) {
+          delete opt;
+          throw invalid_argument("Bad synthesis_form: it can only be packed or direct.");
+      }
+  }
+
   //
   // logic to handle either computing the dispersion and modal values 
   // or to propagate a pulse
@@ -397,6 +411,15 @@ NCPA::ProcessOptionsBB::ProcessOptionsBB(AnyOption *opt)
           }
       }             	    
 
+      // Number of worker processes sharing the frequency loop
+      if ( opt->getValue( "jobs" ) != NULL ) {
+                jobs = atoi(opt->getValue( "jobs" ));
+                if (jobs < 1) {
+                    delete opt;
+                    throw invalid_argument("Option --jobs must be at least 1.");
+                }
+      }
+
       // Number of points on the z-grid
       if ( opt->getValue( "Nz_grid" ) != NULL ) {
                 Nz_grid = atoi(opt->getValue( "Nz_grid" ));
@@ -553,6 +576,10 @@ bool   NCPA::ProcessOptionsBB::getW_disp_flg() {
   return w_disp_flg;
 }
 
+bool   NCPA::ProcessOptionsBB::getDisp_container_flg() {
+  return disp_container_flg;
+}
+
 std::string   NCPA::ProcessOptionsBB::getPprop_grid_dirname() {
   return pprop_grid_dirname;
 }
@@ -713,6 +740,10 @@ std::string   NCPA::ProcessOptionsBB::getSrcfile() {
   return srcfile;
 }
 
+std::string   NCPA::ProcessOptionsBB::getSynthesis_form() {
+  return synthesis_form;
+}
+
 std::string   NCPA::ProcessOptionsBB::getUsrAttFile() {
   return usrattfile;
 }
@@ -734,6 +765,10 @@ bool   NCPA::ProcessOptionsBB::getZeroAttn_flg() {
   return zero_attn_flg;
 }
 
+int    NCPA::ProcessOptionsBB::getJobs() {
+  return jobs;
+}
+
 int    NCPA::ProcessOptionsBB::getNFFT() {
   return NFFT;
 }
@@ -21,9 +21,11 @@ namespace NCPA {
       string getFrame_file_stub();
       string getSrcfile();
       string getUsrAttFile();      
+      string getSynthesis_form();
             
       bool   getW_disp_src2rcv_flg();
       bool   getW_disp_flg();
+      bool   getDisp_container_flg();
       bool   getPprop_grid_flg();
       bool   getPprop_s2r_flg();
       bool   getPprop_s2r_grid_flg();
@@ -41,6 +43,7 @@ namespace NCPA {
       int    getNtsteps();
       int    getSrc_flg();
       int    getNFFT();
+      int    getJobs();
 
       double getZ_min(); 
       double getMax_celerity();
@@ -78,9 +81,11 @@ namespace NCPA {
       string gnd_imp_model;   // ("rigid");
       string srcfile;         // file name of the user-provided source spectrum or source waveform
       string usrattfile;          // user-provided attenuation filename  
+      string synthesis_form;  // packed or direct modal sums in the pulse synthesis
       
       bool   w_disp_src2rcv_flg;
       bool   w_disp_flg;
+      bool   disp_container_flg;  // write the dispersion data to one container file
       bool   pprop_grid_flg;
       bool   pprop_s2r_flg;	
       bool   pprop_s2r_grid_flg;
@@ -100,6 +105,7 @@ namespace NCPA {
       int    src_flg;         // source flag; 0 for impulse response; 1 for built-in impulse 
                               // 2 for source spectrum file; 3 for source waveform file provided
       int    NFFT;            // number of fft points 
+      int    jobs;            // number of worker processes computing frequencies
    
       double RR;
       double R_start;
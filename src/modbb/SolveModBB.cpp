@@ -12,6 +12,8 @@
 #include "Atmosphere.h"
 #include "anyoption.h"
 #include "SolveModBB.h"
+#include "TaskScheduler.h"
+#include "BroadbandSynthesis.h"
 #include "slepceps.h"
 #include "slepcst.h"
 
@@ -91,6 +93,8 @@ void NCPA::SolveModBB::setParams( \
   out_disp_src2rcv  = out_disp_src2rcv1;
   usemodess_flg     = usemodess_flg1;
   turnoff_WKB       = turnoff_WKB1;
+  jobs              = 1;
+  disp_container    = false;
   
   
   // get Hgt, zw, mw, T, rho, Pr in SI units; deleted in destructor
@@ -230,6 +234,8 @@ void NCPA::SolveModBB::setParams(ProcessOptionsBB *oBB, SampledProfile *atm_prof
       out_disp_src2rcv = oBB->getW_disp_src2rcv_flg();
   
       turnoff_WKB    = oBB->getTurnoff_WKB();
+      jobs           = oBB->getJobs();
+      disp_container = oBB->getDisp_container_flg();
       //cout << "turnoff_WKB = " << turnoff_WKB << endl;
 
       // default values for c_min, c_max and wvnum_filter_flg
@@ -326,10 +332,14 @@ void NCPA::SolveModBB::printParams() {
   printf("  SLEPc tolerance param : %g\n", tol);
   printf("    atmospheric profile : %s\n", atmosfile.c_str());
   printf("       turnoff_WKB flag : %d\n", turnoff_WKB);
+  printf("                   jobs : %d\n", jobs);
+  if (disp_container) {
+  printf("   dispersion container : %s\n", disp_fn.c_str());
+  }
   if (!usrattfile.empty()) {
   printf("  User attenuation file : %s\n", usrattfile.c_str());
   }
-  if (out_disp_src2rcv) {
+  if (out_disp_src2rcv || disp_container) {
   printf("          data saved in : %s\n", disp_fn.c_str());
   } else {
   printf("   data saved in subdir : %s\n", subdir.c_str());
@@ -421,23 +431,39 @@ int NCPA::SolveModBB::computeModESS() {
   }
   }
 
+  // hand the frequencies out to 'jobs' worker processes, largest first;
+  // the source-to-receiver dispersion file is merged back in order
+  TaskScheduler sched(Nfreq, jobs, (out_disp_src2rcv && !disp_container) ? disp_fn : string(""));
+  if (sched.getJobs() > 1) {
+      estimateFrequencyCosts(&sched, diag, NULL, NULL, NULL);
+  }
+  if (sched.run()) {
+
+  // every process opens the container itself, so that each one has its own lock
+  DispersionStoreWriter *store = NULL;
+  if (disp_container) {
+      store = new DispersionStoreWriter(disp_fn, Nfreq, f_min, f_step, sourceheight, receiverheight, 1);
+  }
+
   // Initialize Slepc
   SlepcInitialize(PETSC_NULL,PETSC_NULL,(char*)0,PETSC_NULL);
   ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank); CHKERRQ(ierr);
   ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size); CHKERRQ(ierr);
   
   FILE *fp = NULL;
-  if (out_disp_src2rcv) {
-    // open dispersion file for writing
-    fp = fopen(disp_fn.c_str(),"w");
-  }
 
   //
-  // big loop over frequencies; no parallelization here yet
+  // big loop over frequencies
   //
-  for (int ii = 0; ii<Nfreq; ii++) {
+  int ii;
+  while (sched.next(&ii)) {
 
       freq = ii*f_step + f_min;
+      fp   = sched.output();
+      if (store != NULL && store->has(ii)) {
+          cout << "Frequency " << freq << " Hz is already in " << disp_fn << endl;
+          continue;
+      }
       cout << "Now processing frequency = " << freq << " Hz" << endl;
 
       ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
@@ -494,6 +520,10 @@ int NCPA::SolveModBB::computeModESS() {
           if (wvnum_filter_flg) {
               printf(" -> Check the frequency and/or perhaps choose different c_min and c_max values.\n");
           }
+          if (store != NULL) {  // so that a restart does not try it again
+              writeDispersion_container(store, ii, freq, 0, dz, sourceheight, receiverheight, \
+                                        rho, k_pert, v_s, out_dispersion ? NN : 0);
+          }
           continue;
           //printf("Aborted\n");
           //exit(1);
@@ -620,7 +650,11 @@ int NCPA::SolveModBB::computeModESS() {
       //
       // Output data: saving to file(s)
       //
-      if (out_dispersion) {
+      if (store != NULL) {
+          writeDispersion_container(store, ii, freq, select_modes, dz, sourceheight, receiverheight, \
+                                    rho, k_pert, v_s, out_dispersion ? NN : 0);
+      }
+      else if (out_dispersion) {
           // printf ("Writing to file: %s at freq = %8.3f Hz...\n", filen.c_str(), freq);
           writeDispersion_bb_bin3( disp_fn, freq, Nfreq, f_step, Nz_grid, z_min, 
                                    Nz_subgrid, delZ, NN, select_modes, dz, 
@@ -644,10 +678,12 @@ int NCPA::SolveModBB::computeModESS() {
       ierr = VecDestroy(&xr); CHKERRQ(ierr);
       ierr = VecDestroy(&xi); CHKERRQ(ierr); 	
   }	// end BIG LOOP over frequencies
-  
-  if (fp != NULL) {
-    fclose(fp); // close the dispersion file
-  }
+
+  delete store;
+
+  // SlepcFinalize
+  ierr = SlepcFinalize();CHKERRQ(ierr);	
+  } // end sched.run()
 
   // Clean up
   delete[] alpha;
@@ -660,8 +696,8 @@ int NCPA::SolveModBB::computeModESS() {
   free_dmatrix(v,Nz_grid,MAX_MODES);
   free_dmatrix(v_s,Nz_grid,MAX_MODES);
 
-  // SlepcFinalize
-  ierr = SlepcFinalize();CHKERRQ(ierr);	
+  // closes the dispersion file; worker processes exit here
+  sched.finish();
 	
   return 0;		
 }  // end of SolveModBB::computeModess
@@ -744,23 +780,39 @@ int NCPA::SolveModBB::computeWmodes() {
   }
   }
 
+  // hand the frequencies out to 'jobs' worker processes, largest first;
+  // the source-to-receiver dispersion file is merged back in order
+  TaskScheduler sched(Nfreq, jobs, (out_disp_src2rcv && !disp_container) ? disp_fn : string(""));
+  if (sched.getJobs() > 1) {
+      estimateFrequencyCosts(&sched, diag, kd, md, cd);
+  }
+  if (sched.run()) {
+
+  // every process opens the container itself, so that each one has its own lock
+  DispersionStoreWriter *store = NULL;
+  if (disp_container) {
+      store = new DispersionStoreWriter(disp_fn, Nfreq, f_min, f_step, sourceheight, receiverheight, 1);
+  }
+
   // Initialize Slepc
   SlepcInitialize(PETSC_NULL,PETSC_NULL,(char*)0,PETSC_NULL);
   ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank); CHKERRQ(ierr);
   ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size); CHKERRQ(ierr);
 
   FILE *fp = NULL;
-  if (out_disp_src2rcv) {
-    // open dispersion file for writing
-    fp = fopen(disp_fn.c_str(),"w");
-  }
   
   //
-  // big loop over frequencies; no parallelization here yet
+  // big loop over frequencies
   //
-  for (int ii = 0; ii<Nfreq; ii++) {
+  int ii;
+  while (sched.next(&ii)) {
 
       freq = ii*f_step + f_min;
+      fp   = sched.output();
+      if (store != NULL && store->has(ii)) {
+          cout << "Frequency " << freq << " Hz is already in " << disp_fn << endl;
+          continue;
+      }
       cout << "Now processing frequency = " << freq << " Hz" << endl;
 
       ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
@@ -818,6 +870,10 @@ int NCPA::SolveModBB::computeWmodes() {
         if (wvnum_filter_flg) {
             printf(" -> Check and perhaps choose different c_min and c_max values.\n");
         }
+        if (store != NULL) {  // so that a restart does not try it again
+            writeDispersion_container(store, ii, freq, 0, dz, sourceheight, receiverheight, \
+                                      rho, k_pert, v_s, out_dispersion ? NN : 0);
+        }
         continue;
         //printf("Aborted\n");
         //exit(1);
@@ -1028,7 +1084,11 @@ int NCPA::SolveModBB::computeWmodes() {
       //
       // Output data: saving to file(s)
       //
-      if (out_dispersion) {
+      if (store != NULL) {
+          writeDispersion_container(store, ii, freq, select_modes, dz, sourceheight, receiverheight, \
+                                    rho, k_pert, v_s, out_dispersion ? NN : 0);
+      }
+      else if (out_dispersion) {
           // printf ("Writing to file: %s at freq = %8.3f Hz...\n", filen.c_str(), freq);
           writeDispersion_bb_bin3( disp_fn, freq, Nfreq, f_step, Nz_grid, z_min, \
                                   Nz_subgrid, delZ, NN, select_modes, dz, \
@@ -1055,10 +1115,13 @@ int NCPA::SolveModBB::computeWmodes() {
       
       	
   }	// end BIG LOOP over frequencies
+
+  delete store;
+
+  // SlepcFinalize
+  ierr = SlepcFinalize();CHKERRQ(ierr);	
+  } // end sched.run()
   
-  if (fp != NULL) {
-    fclose(fp); // close the dispersion file
-  }
   // free the rest of locally dynamically allocated space
   delete[] alpha;
   delete[] diag;
@@ -1073,13 +1136,56 @@ int NCPA::SolveModBB::computeWmodes() {
   free_dmatrix(v, Nz_grid, MAX_MODES);
   free_dmatrix(v_s, Nz_grid, MAX_MODES);  
 
-  // SlepcFinalize
-  ierr = SlepcFinalize();CHKERRQ(ierr);	
+  // closes the dispersion file; worker processes exit here
+  sched.finish();
 	
   return 0;		
 }  // end of SolveModesBB::computeWmodes
 
 
+//
+// Estimate the relative cost of every frequency for the scheduler from the
+// number of modes in [k_min, k_max], which the Sturm sequence count gives
+// without solving the eigenproblem. The eigensolver work grows with the
+// number of modes requested, so high frequencies are scheduled first.
+// kd, md and cd are only needed (and only used) for WMod.
+//
+int NCPA::SolveModBB::estimateFrequencyCosts(TaskScheduler *sched, \
+                    double *diag, double *kd, double *md, double *cd)
+{
+  int    nev = 0;
+  double freq, admittance, k_min, k_max;
+  double dz       = (maxheight - z_min)/Nz_grid;
+  double z_min_km = z_min/1000.0;
+
+  admittance = 0.0;
+  if ((gnd_imp_model.compare("rigid")==0) && Lamb_wave_BC) {
+      admittance = -atm_profile->drhodz(z_min/1000.0)/1000.0/atm_profile->rho(z_min_km)/2.0; // SI units
+  }
+
+  for (int ii = 0; ii<Nfreq; ii++) {
+      freq  = ii*f_step + f_min;
+      k_min = 0;
+      k_max = 0;
+      if (usemodess_flg) {
+          getModalTraceModESS(Nz_grid, z_min, sourceheight, receiverheight, dz, \
+                              atm_profile, admittance, freq, azi, diag, &k_min, &k_max, turnoff_WKB);
+      }
+      else {
+          getModalTraceWMod(Nz_grid, z_min, sourceheight, receiverheight, dz, atm_profile, admittance, \
+                            freq, diag, kd, md, cd, &k_min, &k_max, turnoff_WKB);
+      }
+      if (wvnum_filter_flg) {
+          k_min = 2*Pi*freq/c_max;
+          k_max = 2*Pi*freq/c_min;
+      }
+      getNumberOfModes(Nz_grid,dz,diag,k_min,k_max,&nev);
+      sched->setCost(ii, (double) nev + 1.0);
+  }
+  return 0;
+}
+
+
 
 /*
 // updated getAbsorption function: bug fixed by Joel and Jelle - Jun 2012
@@ -2000,3 +2106,15 @@ int NCPA::SolveModBB::writeDispersion_bb_bin3(\
   printf("           file %s created\n", dispf_name);
   return 0;
 }
+
+
+int NCPA::SolveModBB::writeDispersion_container(\
+					DispersionStoreWriter *store, int ii, double freq, int Nmodes, \
+					double dz, double z_src, double z_rcv, double *rho, \
+					complex<double> *k_pert, double **v_s, int NN)
+{
+  // saves the same values as the ascii file and, if NN > 0, rho and the
+  // modes every NN grid points as the binary files (see BroadbandSynthesis.h)
+  return writeDispersionRecord(store, ii, freq, Nmodes, Nz_grid, z_min, dz, z_src, z_rcv, \
+                               rho, k_pert, v_s, NN);
+}
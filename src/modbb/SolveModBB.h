@@ -7,6 +7,8 @@
 #include "anyoption.h"
 #include "ModBB_lib.h"
 #include "ProcessOptionsBB.h"
+#include "TaskScheduler.h"
+#include "DispersionStore.h"
 
 
 namespace NCPA {
@@ -42,6 +44,9 @@ namespace NCPA {
       int computeModESS();
       int computeWmodes();
 
+      int estimateFrequencyCosts(TaskScheduler *sched, \
+                    double *diag, double *kd, double *md, double *cd);
+
       int getAbsorption(int n, double dz, NCPA::SampledProfile *atm_profile, double freq, double *alpha);
       
       int getAbsorption(int n, double dz, NCPA::SampledProfile *atm_profile, double freq, string usrattfile, double *alpha);
@@ -93,17 +98,26 @@ namespace NCPA {
 					      double dz, double z_src, \
 					      double *rho, double *kreal, double *kim, double **v_s);				        			        	
 
+      // one frequency of the dispersion container; the full modes every
+      // NN grid points are included if NN > 0
+      int writeDispersion_container(\
+					      DispersionStoreWriter *store, int ii, double freq, int Nmodes, \
+					      double dz, double z_src, double z_rcv, double *rho, \
+					      std::complex<double> *k_pert, double **v_s, int NN);
+
     private:
       bool   out_dispersion;
       bool   out_disp_src2rcv;
       bool   usemodess_flg;
       bool   turnoff_WKB;
       bool   wvnum_filter_flg;
+      bool   disp_container;  // all frequencies in one DispersionStore file
       
       int    Nfreq;
       int    Nz_grid;  
       int    Nrng_steps;
       int    Lamb_wave_BC;
+      int    jobs;            // number of worker processes for the frequency loop
       			
       double f_min;
       double f_step;
@@ -181,6 +181,9 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->addUsage( "                          where scP is the scaled pressure such that it can" );
 	opt->addUsage( "                          be directly ingested into pape to obtain the" );
 	opt->addUsage( "                          transmission loss." );
+	opt->addUsage( " --modal_starter_format   text or binary [text]. The binary file holds the" );
+	opt->addUsage( "                          starter at every grid height in full precision;" );
+	opt->addUsage( "                          pape reads either format." );
 
 	opt->addUsage( " --c_min                  Specify the minimum phase speed (in m/sec)." );
 	opt->addUsage( "                          This is used in conjunction with the --wvnum_filter" );
@@ -188,6 +191,10 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->addUsage( "                          phase speed. See also the --wvnum_filter flag" );
 	opt->addUsage( "                          and the --c_max option." );
 	opt->addUsage( " --c_max                  Specify the maximum phase speed (in m/sec)." );
+	opt->addUsage( " --jobs                   Number of processes computing the azimuths of an" );
+	opt->addUsage( "                          (N by 2D) run [1]. Azimuths are estimated by mode" );
+	opt->addUsage( "                          count and handed out most expensive first; the" );
+	opt->addUsage( "                          Nby2D files are still written in azimuth order." );
 
 	opt->addUsage( "" );	 
 	opt->addUsage( "FLAGS (no value required):" );
@@ -265,6 +272,7 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->setOption( "atmosfile" );
 	opt->setOption( "atmosfileorder" );
 	opt->setOption( "modal_starter_file" );
+	opt->setOption( "modal_starter_format" );
 	opt->setOption( "wind_units" );
 	opt->setOption( "skiplines" );		
 	opt->setOption( "azimuth" );
@@ -285,6 +293,7 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->setOption( "use_attn_file" );
 	opt->setOption( "c_min" );
 	opt->setOption( "c_max" );
+	opt->setOption( "jobs" );
 
 	// Process the command-line arguments
 	opt->processFile( "./Modess.options" );
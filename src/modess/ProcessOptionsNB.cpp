@@ -30,6 +30,7 @@ NCPA::ProcessOptionsNB::ProcessOptionsNB(AnyOption *opt) {
   tol              = 1.0E-08;     // tolerance for Slepc calculations
   c_min            = 0.0;         // minimum sound speed requested by user to do wavenumber filtering
   c_max            = 0.0;         // maximum sound speed requested by user to do wavenumber filtering
+  jobs             = 1;           // number of worker processes for the (N by 2D) azimuths
   
   write_2D_TLoss     = opt->getFlag( "write_2D_TLoss");
   write_phase_speeds = opt->getFlag( "write_phase_speeds" );
@@ -147,6 +148,15 @@ NCPA::ProcessOptionsNB::ProcessOptionsNB(AnyOption *opt) {
   }
   	                 
 
+  // Number of worker processes sharing the (N by 2D) azimuths
+  if ( opt->getValue( "jobs" ) != NULL ) {
+      jobs = atoi(opt->getValue( "jobs" ));
+      if (jobs < 1) {
+          delete opt;
+          throw invalid_argument("Option --jobs must be at least 1.");
+      }
+  }
+
   if (opt->getValue( "maxrange_km" ) != NULL) {
       maxrange = atof( opt->getValue( "maxrange_km" ))*1000.0;
       if (maxrange < 1000) {
@@ -244,6 +254,15 @@ NCPA::ProcessOptionsNB::ProcessOptionsNB(AnyOption *opt) {
       modal_starter_file = opt->getValue( "modal_starter_file" );
   }
 
+  modal_starter_format = "text";
+  if ( opt->getValue( "modal_starter_format" ) != NULL ) {
+      modal_starter_format = opt->getValue( "modal_starter_format" );
+      if (!( !modal_starter_format.compare("text") || !modal_starter_format.compare("binary") ) ) {
+          delete opt;
+          throw invalid_argument("Bad modal_starter_format: it can only be text or binary.");
+      }
+  }
+
   // wavenumber filtering option
   wvnum_filter_flg = 0;
 
@@ -296,6 +315,10 @@ std::string   NCPA::ProcessOptionsNB::getModalStarterFile() {
   return modal_starter_file;
 }
 
+std::string   NCPA::ProcessOptionsNB::getModalStarterFormat() {
+  return modal_starter_format;
+}
+
 
 int    NCPA::ProcessOptionsNB::getSkiplines() {
   return skiplines;
@@ -357,6 +380,10 @@ int    NCPA::ProcessOptionsNB::getNz_grid() {
   return Nz_grid;
 }
 
+int    NCPA::ProcessOptionsNB::getJobs() {
+  return jobs;
+}
+
 std::string   NCPA::ProcessOptionsNB::getGnd_imp_model() {
   return gnd_imp_model;
 }
@@ -16,11 +16,13 @@ namespace NCPA {
       string   getWindUnits();
       string   getUsrAttFile();
       string   getModalStarterFile();
+      string   getModalStarterFormat();
          
       int    getSkiplines();
       int    getNrng_steps();
       int    getNz_grid();
       int    getLamb_wave_BC();
+      int    getJobs();
       
       double getFreq();
       double getAzimuth();
@@ -55,6 +57,7 @@ namespace NCPA {
       string   wind_units;          // default mpersec
       string   usrattfile;          // user-provided attenuation filename
       string   modal_starter_file;
+      string   modal_starter_format; // text or binary
 
       bool     write_2D_TLoss;
       bool     write_phase_speeds;
@@ -72,6 +75,7 @@ namespace NCPA {
       int      Nfreq;               // number of positive frequencies 
       int      skiplines;           // number of lines to skip in "atmosfile"
       int      Lamb_wave_BC;        // for rigid ground: if ==1 then admittance = -1/2*dln(rho)/dz
+      int      jobs;                // number of worker processes for the (N by 2D) azimuths
      
       double   freq;                // Hz	
       double   z_min;               // meters
@@ -11,6 +11,7 @@
 #include "slepceps.h"
 #include "slepcst.h"
 #include "ProcessOptionsNB.h"
+#include "StarterCache.h"
 
 #define MAX_MODES 4000 
 
@@ -38,6 +39,8 @@ void NCPA::SolveModNB::setParams(ProcessOptionsNB *oNB, SampledProfile *atm_prof
 	gnd_imp_model  = oNB->getGnd_imp_model();
 	usrattfile     = oNB->getUsrAttFile();
 	modstartfile   = oNB->getModalStarterFile();
+	modstartformat = oNB->getModalStarterFormat();
+	write_ceff     = true;
 	//atmosfileorder = oNB->getAtmosfileorder();
   
   
@@ -80,12 +83,14 @@ void NCPA::SolveModNB::setParams(ProcessOptionsNB *oNB, SampledProfile *atm_prof
 		turnoff_WKB = 1; // don't use WKB least phase speed estim. when saving any of the above values
 	}
   
-	Naz = 1; // Number of azimuths: default is a propagation along a single azimuth
+	Naz  = 1; // Number of azimuths: default is a propagation along a single azimuth
+	jobs = 1;
 	if (Nby2Dprop) {
 		azi      = oNB->getAzimuthStart();
 		azi_max  = oNB->getAzimuthEnd();
 		azi_step = oNB->getAzimuthStep();
 		Naz      = (int) ((azi_max - azi)/azi_step) + 1;
+		jobs     = oNB->getJobs();
 	}
 
 	azi_min     = azi;
@@ -181,6 +186,7 @@ void NCPA::SolveModNB::printParams() {
 		printf("     azimuth_start (deg): %g\n", azi_min);
 		printf("       azimuth_end (deg): %g\n", azi_max);
 		printf("      azimuth_step (deg): %g\n", azi_step);
+		printf("                   jobs : %d\n", jobs);
 	}
 	printf("                Nz_grid : %d\n", Nz_grid);
 	printf("      z_min (meters MSL): %g\n", z_min);
@@ -206,6 +212,7 @@ void NCPA::SolveModNB::printParams() {
 	}
 	if (!modstartfile.empty()) {
 		printf(" modal starter saved in : %s\n", modstartfile.c_str());
+		printf("   modal starter format : %s\n", modstartformat.c_str());
 	}
 
 	printf("       wvnum_filter_flg : %d\n", wvnum_filter_flg);
@@ -260,10 +267,28 @@ int NCPA::SolveModNB::computeModes() {
 	//dz_km    = dz/1000.0;
 	z_min_km = z_min/1000.0;
   
+	// hand the (N by 2D) azimuths out to 'jobs' worker processes, largest
+	// first; the Nby2D TL files are merged back in azimuth order
+	vector<string> tl_files;
+	if (Nby2Dprop) {
+		tl_files.push_back("Nby2D_tloss_1d.nm");
+		tl_files.push_back("Nby2D_tloss_1d.lossless.nm");
+	}
+	TaskScheduler sched(Naz, jobs, tl_files);
+	if (sched.getJobs() > 1) {
+		estimateAzimuthCosts(&sched, diag);
+	}
+	if (sched.run()) {
+
+	// Initialize Slepc
+	SlepcInitialize(PETSC_NULL,PETSC_NULL,(char*)0,PETSC_NULL);
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank); CHKERRQ(ierr);
+	ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size); CHKERRQ(ierr);  
+
 	//
 	// loop over azimuths (if not (N by 2D) it's only one azimuth)
 	//
-	for (it=0; it<Naz; it++) {
+	while (sched.next(&it)) {
   
 		azi = azi_min + it*azi_step; // degrees (not radians)
 		cout << endl << "Now processing azimuth = " << azi << " (" << it+1 << " of " 
@@ -271,6 +296,9 @@ int NCPA::SolveModNB::computeModes() {
 
 		atm_profile->setPropagationAzimuth(azi);
 
+		// ceff.nm is left by the last azimuth, whichever process computes it
+		write_ceff = (it == Naz-1);
+
 		// compute absorption
 		getAbsorption(Nz_grid, dz, atm_profile, freq, usrattfile, alpha);
 
@@ -312,11 +340,6 @@ int NCPA::SolveModNB::computeModes() {
 		printf ("______________________________________________________________________\n\n");
 		printf (" -> Normal mode solution at %5.3f Hz and %5.2f deg (%d modes)...\n", freq, azi, nev);
 		printf (" -> Discrete spectrum: %5.2f m/s to %5.2f m/s\n", 2*PI*freq/k_max, 2*PI*freq/k_min);
-    
-		// Initialize Slepc
-		SlepcInitialize(PETSC_NULL,PETSC_NULL,(char*)0,PETSC_NULL); /* @todo move out of loop? */
-		ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank); CHKERRQ(ierr);
-		ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size); CHKERRQ(ierr);  
 
 		// Create the matrix A to use in the eigensystem problem: Ak=kx
 		ierr = MatCreate(PETSC_COMM_WORLD,&A); CHKERRQ(ierr);
@@ -461,7 +484,7 @@ int NCPA::SolveModNB::computeModes() {
 
 		if (Nby2Dprop) { // if (N by 2D is requested)
 			getTLoss1DNx2(azi, select_modes, dz, Nrng_steps, rng_step, sourceheight, 
-				      receiverheight, rho, k_pert, v_s, Nby2Dprop, it);
+				      receiverheight, rho, k_pert, v_s, sched.output(0), sched.output(1));
 		}
 		else {
 			cout << "Writing to file: 1D transmission loss at the ground..." << endl;
@@ -541,6 +564,7 @@ int NCPA::SolveModNB::computeModes() {
   
 	// Finalize Slepc
 	ierr = SlepcFinalize();CHKERRQ(ierr);
+	} // end sched.run()
   
 	// free the class-wide (profile) arrays; it could be done in a destructor as well
 	delete[] Hgt;
@@ -559,11 +583,52 @@ int NCPA::SolveModNB::computeModes() {
 	delete[] k_pert;
 	free_dmatrix(v, Nz_grid, MAX_MODES);
 	free_dmatrix(v_s, Nz_grid, MAX_MODES);
+
+	// closes the Nby2D files; worker processes exit here
+	sched.finish();
   
 	return 0;
 } // end of computeModes()
 
 
+//
+// Estimate the relative cost of every azimuth for the scheduler from the
+// number of modes in [k_min, k_max], which the Sturm sequence count gives
+// without solving the eigenproblem. Downwind azimuths duct more modes and
+// are scheduled first.
+//
+int NCPA::SolveModNB::estimateAzimuthCosts(TaskScheduler *sched, double *diag)
+{
+	int    it, nev = 0;
+	double azimuth, admittance, k_min, k_max;
+	double dz       = (maxheight - z_min)/Nz_grid;
+	double z_min_km = z_min/1000.0;
+
+	admittance = 0.0;
+	if ((gnd_imp_model.compare("rigid")==0) && Lamb_wave_BC) {
+		admittance = -atm_profile->drhodz(z_min_km) / 1000.0
+			/ atm_profile->rho(z_min_km) / 2.0; // SI units
+	}
+
+	write_ceff = false;
+	for (it=0; it<Naz; it++) {
+		azimuth = azi_min + it*azi_step;
+		k_min   = 0;
+		k_max   = 0;
+		atm_profile->setPropagationAzimuth(azimuth);
+		getModalTrace(Nz_grid, z_min, sourceheight, receiverheight, dz, atm_profile, admittance, 
+			      freq, azimuth, diag, &k_min, &k_max, turnoff_WKB, c_eff);
+		if (wvnum_filter_flg) {
+			k_min = 2 * PI * freq / c_max;
+			k_max = 2 * PI * freq / c_min;
+		}
+		getNumberOfModes(Nz_grid,dz,diag,k_min,k_max,&nev);
+		sched->setCost(it, (double) nev + 1.0);
+	}
+	return 0;
+}
+
+
 // updated getAbsorption function: bug fixed by Joel and Jelle - Jun 2012
 // updated: will accept attenuation coeff. loaded from a file
 // @todo Make this a method of SampledProfile or AtmosphericProfile
@@ -929,7 +994,7 @@ int NCPA::SolveModNB::getModalTrace( int nz, double z_min, double sourceheight,
    
 	// optional save ceff
 	// @todo add flag to turn on/off
-	if (1) {
+	if (write_ceff) {
 		double *target;
 		target = new double [p->nz()];
 		p->get_ceff(target, p->nz());
@@ -1148,17 +1213,46 @@ void NCPA::SolveModNB::getModalStarter(int nz, int select_modes, double dz, doub
 	// where Vm are the modes computed in this code. Note that Vm(z) = Psi_m(z)/sqrt(rho(z)), 
 	// 
 
+	int z_cnd = int ((340.0/freq)/10/dz);
+	StarterField modal_starter;
+	computeModalStarter(nz, select_modes, dz, freq, z_src, k_pert, v_s, &modal_starter);
+
+	if (!modstartformat.compare("binary")) {
+		writeStarterField(modstartfile, modal_starter);
+	}
+	else {
+		FILE *mstfile = fopen(modstartfile.c_str(),"w");
+		for (int j=0; j<nz; j=j+z_cnd) {
+			fprintf(mstfile,"%10.3f   %16.12e   %16.12e\n", (j*dz)/1000.0, 
+				real(modal_starter.psi[j]), imag(modal_starter.psi[j]));
+		}
+		fprintf(mstfile,"\n");
+		fclose(mstfile);
+	}
+	printf("           file %s created\n", modstartfile.c_str());  
+
+}
+
+// The modal starter on the full z-grid, which getModalStarter() writes out
+void NCPA::SolveModNB::computeModalStarter(int nz, int select_modes, double dz, double freq, 
+	double z_src, complex<double> *k_pert, double **v_s, StarterField *sf) {
+
 	int j, m;
 	int n_zsrc = (int) ceil(z_src/dz);
-	double z;
 	complex<double> modal_sum;
   
 	double k0 = (2*PI*freq/340.0); // reference wavenumber
-	int z_cnd = int ((340.0/freq)/10/dz);
-	FILE *mstfile = fopen(modstartfile.c_str(),"w");
 
-	for (j=0; j<nz; j=j+z_cnd) {
-		z = (j)*dz;
+	sf->type        = "modess";
+	sf->freq        = freq;
+	sf->zsrc        = z_src;
+	sf->z0          = 0.0;
+	sf->dz          = dz;
+	sf->nz          = nz;
+	sf->ground_hash = StarterCache::hash(c_eff, (n_zsrc+1)*sizeof(double));
+	sf->psi.resize(nz);
+
+	for (j=0; j<nz; j++) {
 		modal_sum = 0.0;
 		
 		// Use the commented lines if the modes must be scaled by sqrt(rho)
@@ -1177,20 +1271,15 @@ void NCPA::SolveModNB::getModalStarter(int nz, int select_modes, double dz, doub
 		//modal_sum = sqrt2Pi/rhos*modal_sum; // modal starter at particular z
 		//modal_sum = factor/rhos*modal_sum; // modal starter at particular z
       
-      
-		fprintf(mstfile,"%10.3f   %16.12e   %16.12e\n", z/1000.0, real(modal_sum), imag(modal_sum));
+		sf->psi[j] = modal_sum;
 	}
-	fprintf(mstfile,"\n");
-	fclose(mstfile);
-	printf("           file %s created\n", modstartfile.c_str());  
-
 }
 
 
 // 20150603 DV added code to account for sqrt(rho_rcv/rho_src) if so chosen
 int NCPA::SolveModNB::getTLoss1DNx2(double azimuth, int select_modes, double dz, int n_r, double dr, 
 	double z_src, double z_rcv, double *rho, complex<double> *k_pert, double **v_s, 
-	bool Nx2, int iter) {
+	FILE *tloss_1d, FILE *tloss_ll_1d) {
 
 	// !!! note the modes assumed here are the modes in Oc. Acoust. divided by sqrt(rho(z))
 	// Thus the formula for (physical) pressure is:
@@ -1208,19 +1297,12 @@ int NCPA::SolveModNB::getTLoss1DNx2(double azimuth, int select_modes, double dz,
 	
 	// the 4*PI factor ensures that the modal sum below ends up being the actual TL
 	complex<double> expov8pi =  4*PI*I*exp(-I*PI*0.25)/sqrt(8.0*PI); 
-	FILE *tloss_1d, *tloss_ll_1d;
   
 	sqrtrho_ratio = sqrt(rho[n_zrcv]/rho[n_zsrc]);
 	
-	if (iter==0) {
-		tloss_1d    = fopen("Nby2D_tloss_1d.nm","w");
-		tloss_ll_1d = fopen("Nby2D_tloss_1d.lossless.nm","w");
-	}
-	else {  // append
-		tloss_1d    = fopen("Nby2D_tloss_1d.nm","a");
-		tloss_ll_1d = fopen("Nby2D_tloss_1d.lossless.nm","a");
+	if (tloss_1d == NULL || tloss_ll_1d == NULL) {
+		throw runtime_error( "Could not open the Nby2D_tloss_1d files for writing" );
 	}
-	// @todo make sure files were opened properly
 
 	for (i=0; i<n_r; i++) {
 		r = (i+1)*dr;
@@ -1276,9 +1358,6 @@ int NCPA::SolveModNB::getTLoss1DNx2(double azimuth, int select_modes, double dz,
 	}
 	fprintf(tloss_1d, "\n");
 	fprintf(tloss_ll_1d, "\n");
-  
-	fclose(tloss_1d);
-	fclose(tloss_ll_1d);
 	return 0;
 }
 
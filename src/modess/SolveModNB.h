@@ -1,6 +1,8 @@
 #ifndef _SOLVEMODNB_H_
 #define _SOLVEMODNB_H_
 #include "ProcessOptionsNB.h"
+#include "StarterCache.h"
+#include "TaskScheduler.h"
 
 namespace NCPA {
 	class SolveModNB {
@@ -39,8 +41,10 @@ namespace NCPA {
       
 
       
+		// appends the TL along one azimuth to the open (N by 2D) files
 		int getTLoss1DNx2(double azimuth, int select_modes, double dz, int n_r, double dr, double z_src, 
-			double z_rcv,  double *rho, complex<double> *k_pert, double **v_s, bool Nx2, int iter);      
+			double z_rcv,  double *rho, complex<double> *k_pert, double **v_s, FILE *tloss_1d, 
+			FILE *tloss_ll_1d);      
 
 		int getTLoss2D(int nz, int select_modes, double dz, int n_r, double dr, double z_src, 
 			double *rho, complex<double> *k_pert, double **v_s); 
@@ -51,6 +55,10 @@ namespace NCPA {
 		void getModalStarter(int nz, int select_modes, double dz, double freq,  double z_src, 
 			double z_rcv, double *rho, complex<double> *k_pert, double **v_s, string modstartfile);
 
+		// the modal starter on the full z-grid, in memory
+		void computeModalStarter(int nz, int select_modes, double dz, double freq, double z_src, 
+			complex<double> *k_pert, double **v_s, StarterField *sf);
+
 		int writeDispersion(int select_modes, double dz, double z_src, double z_rcv, double freq, 
 			complex<double> *k_pert, double **v_s, double *rho);
 
@@ -61,6 +69,8 @@ namespace NCPA {
 		int writePhaseAndGroupSpeeds(int nz, double dz, int select_modes, double freq, 
 			complex<double> *k_pert, double **v_s, double *c_eff);   
 
+		int estimateAzimuthCosts(NCPA::TaskScheduler *sched, double *diag);
+
 	private:
 		bool   write_2D_TLoss;
 		bool   write_phase_speeds;
@@ -70,11 +80,13 @@ namespace NCPA {
 		bool   Nby2Dprop;
 		bool   turnoff_WKB;
 		bool   wvnum_filter_flg;
+		bool   write_ceff;         // getModalTrace() saves ceff.nm
           
 		int    Nz_grid;
 		int    Nrng_steps;
 		int    Lamb_wave_BC; 
 		int    Naz;
+		int    jobs;
 		int    skiplines;
       
 		double freq;
@@ -98,6 +110,7 @@ namespace NCPA {
 		std::string wind_units;
 		std::string usrattfile;
 		std::string modstartfile; // store the modal starter in this file
+		std::string modstartformat; // ... as text or binary
 		//std::string atmosfileorder;
       
 	}; 
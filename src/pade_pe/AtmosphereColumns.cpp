@@ -0,0 +1,37 @@
+#include <stdexcept>
+#include "AtmosphereColumns.h"
+
+using namespace NCPA;
+using namespace std;
+
+NCPA::AtmosphereColumns::AtmosphereColumns(int nz_, int nr_) {
+  if (nz_ < 1 || nr_ < 1) {
+      throw invalid_argument("A 2D atmosphere needs at least one height and one profile.");
+  }
+  nz   = nz_;
+  nr   = nr_;
+  data = new double [ (size_t) ATM_NQ*nr*nz ]();
+}
+
+NCPA::AtmosphereColumns::~AtmosphereColumns() {
+  delete [] data;
+}
+
+int NCPA::AtmosphereColumns::getNz() {
+  return nz;
+}
+
+int NCPA::AtmosphereColumns::getNr() {
+  return nr;
+}
+
+double *NCPA::AtmosphereColumns::block(AtmQuantity q) {
+  return data + (size_t) q*nr*nz;
+}
+
+double *NCPA::AtmosphereColumns::column(AtmQuantity q, int ir) {
+  if (ir < 0 || ir >= nr) {
+      throw out_of_range("Atmospheric profile index out of range.");
+  }
+  return data + ((size_t) q*nr + ir)*nz;
+}
@@ -0,0 +1,39 @@
+#ifndef _AtmosphereColumns_H_
+#define _AtmosphereColumns_H_
+
+//
+// Range-dependent atmosphere for pape: nr profiles of T, rho, p and the two
+// horizontal wind components on a common height grid of nz points.
+//
+// Everything is held in one allocation, quantity after quantity, and within
+// a quantity profile after profile, so that each profile ("column") is nz
+// contiguous values. A column can then be handed directly to the
+// interpolation code as a 1D profile, and the quantity blocks have the same
+// layout as in a G2S .env file, which lets readG2SBinary() read them in
+// place.
+//
+namespace NCPA {
+
+  // in the order of the G2S .env file
+  enum AtmQuantity { ATM_T = 0, ATM_RHO, ATM_PR, ATM_ZW, ATM_MW, ATM_NQ };
+
+  class AtmosphereColumns {
+    public:
+      AtmosphereColumns(int nz, int nr);
+      ~AtmosphereColumns();
+
+      int     getNz();
+      int     getNr();
+
+      // nr*nz values of quantity q, profile after profile
+      double *block(AtmQuantity q);
+      // nz values of quantity q in profile ir
+      double *column(AtmQuantity q, int ir);
+
+    private:
+      int     nz, nr;
+      double *data;
+  }; // mandatory semicolon here
+}
+
+#endif
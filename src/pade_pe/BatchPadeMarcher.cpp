@@ -0,0 +1,167 @@
+#include <stdexcept>
+#include "BatchPadeMarcher.h"
+
+using namespace NCPA;
+using namespace std;
+
+NCPA::BatchPadeMarcher::BatchPadeMarcher(int nz_, int n_pade_, int nlanes) {
+  if (nlanes < 1) {
+      throw invalid_argument("BatchPadeMarcher needs at least one lane.");
+  }
+  nz     = nz_;
+  n_pade = n_pade_;
+  K      = nlanes;
+
+  cp_re   = new double [ n_pade*K ]();     cp_im   = new double [ n_pade*K ]();
+  cpo_re  = new double [ n_pade*K ]();     cpo_im  = new double [ n_pade*K ]();
+  cmo_re  = new double [ n_pade*K ]();     cmo_im  = new double [ n_pade*K ]();
+  gam_re  = new double [ n_pade*nz*K ]();  gam_im  = new double [ n_pade*nz*K ]();
+  ibet_re = new double [ n_pade*nz*K ]();  ibet_im = new double [ n_pade*nz*K ]();
+  qd_re   = new double [ nz*K ]();         qd_im   = new double [ nz*K ]();
+  psi_re  = new double [ nz*K ]();         psi_im  = new double [ nz*K ]();
+  work_re = new double [ nz*K ]();         work_im = new double [ nz*K ]();
+  damp    = new double [ nz*K ]();
+}
+
+NCPA::BatchPadeMarcher::~BatchPadeMarcher() {
+  delete [] cp_re;   delete [] cp_im;
+  delete [] cpo_re;  delete [] cpo_im;
+  delete [] cmo_re;  delete [] cmo_im;
+  delete [] gam_re;  delete [] gam_im;
+  delete [] ibet_re; delete [] ibet_im;
+  delete [] qd_re;   delete [] qd_im;
+  delete [] psi_re;  delete [] psi_im;
+  delete [] work_re; delete [] work_im;
+  delete [] damp;
+}
+
+int NCPA::BatchPadeMarcher::getNlanes() {
+  return K;
+}
+
+void NCPA::BatchPadeMarcher::setOperator(int k, complex<double> *cm, complex<double> *cp, complex<double> *Qd, complex<double> *Qo, double *damping) {
+  for (int i=0; i<nz; i++) {
+      qd_re[i*K + k] = real(Qd[i]);
+      qd_im[i*K + k] = imag(Qd[i]);
+      damp[i*K + k]  = damping[i];
+  }
+  for (int j=0; j<n_pade; j++) {
+      complex<double> cpo = cp[j]*Qo[0];
+      complex<double> cmo = cm[j]*Qo[0];
+      cp_re[j*K + k]  = real(cp[j]);  cp_im[j*K + k]  = imag(cp[j]);
+      cpo_re[j*K + k] = real(cpo);    cpo_im[j*K + k] = imag(cpo);
+      cmo_re[j*K + k] = real(cmo);    cmo_im[j*K + k] = imag(cmo);
+
+      // Thomas algorithm factorization of (1 + cm_j*Q)
+      complex<double> bet = 1.0 + cm[j]*Qd[0];
+      if (bet == 0.0) throw invalid_argument("Singular Pade operator (Error 1 in tridag)");
+      for (int i=0; i<nz; i++) {
+          int n = (j*nz + i)*K + k;
+          if (i > 0) {
+              complex<double> gam = cmo/bet;
+              bet = 1.0 + cm[j]*Qd[i] - cmo*gam;
+              if (bet == 0.0) throw invalid_argument("Singular Pade operator (Error 2 in tridag)");
+              gam_re[n] = real(gam);  gam_im[n] = imag(gam);
+          }
+          complex<double> ibet = 1.0/bet;
+          ibet_re[n] = real(ibet);  ibet_im[n] = imag(ibet);
+      }
+  }
+}
+
+void NCPA::BatchPadeMarcher::setField(int k, complex<double> *psi) {
+  for (int i=0; i<nz; i++) {
+      psi_re[i*K + k] = real(psi[i]);
+      psi_im[i*K + k] = imag(psi[i]);
+  }
+}
+
+void NCPA::BatchPadeMarcher::getField(int k, complex<double> *psi) {
+  for (int i=0; i<nz; i++) {
+      psi[i] = complex<double>(psi_re[i*K + k], psi_im[i*K + k]);
+  }
+}
+
+complex<double> NCPA::BatchPadeMarcher::getField(int k, int iz) {
+  return complex<double>(psi_re[iz*K + k], psi_im[iz*K + k]);
+}
+
+void NCPA::BatchPadeMarcher::march() {
+  // none of the arrays overlap, which lets the lane loops vectorize
+  double * __restrict__ pr = psi_re;
+  double * __restrict__ pi = psi_im;
+  double * __restrict__ wr = work_re;
+  double * __restrict__ wi = work_im;
+  const double * __restrict__ qdr = qd_re;
+  const double * __restrict__ qdi = qd_im;
+  const double * __restrict__ dmp = damp;
+
+  for (int j=0; j<n_pade; j++) {
+      const double * __restrict__ cpr = cp_re  + j*K;
+      const double * __restrict__ cpi = cp_im  + j*K;
+      const double * __restrict__ bor = cpo_re + j*K;
+      const double * __restrict__ boi = cpo_im + j*K;
+      const double * __restrict__ clr = cmo_re + j*K;
+      const double * __restrict__ cli = cmo_im + j*K;
+      const double * __restrict__ gr  = gam_re  + j*nz*K;
+      const double * __restrict__ gi  = gam_im  + j*nz*K;
+      const double * __restrict__ ibr = ibet_re + j*nz*K;
+      const double * __restrict__ ibi = ibet_im + j*nz*K;
+
+      // right-hand side: work = psi + cp_j*Qd*psi + cp_j*Qo*(psi above + psi below)
+      for (int i=0; i<nz; i++) {
+          int f = i*K;
+          for (int k=0; k<K; k++) {
+              double qr = qdr[f+k]*pr[f+k] - qdi[f+k]*pi[f+k];
+              double qi = qdr[f+k]*pi[f+k] + qdi[f+k]*pr[f+k];
+              wr[f+k] = pr[f+k] + (cpr[k]*qr - cpi[k]*qi);
+              wi[f+k] = pi[f+k] + (cpr[k]*qi + cpi[k]*qr);
+          }
+      }
+      for (int i=0; i<nz-1; i++) {
+          int f = i*K;
+          for (int k=0; k<K; k++) {
+              wr[f+k]   += bor[k]*pr[f+K+k] - boi[k]*pi[f+K+k];
+              wi[f+k]   += bor[k]*pi[f+K+k] + boi[k]*pr[f+K+k];
+              wr[f+K+k] += bor[k]*pr[f+k]   - boi[k]*pi[f+k];
+              wi[f+K+k] += bor[k]*pi[f+k]   + boi[k]*pr[f+k];
+          }
+      }
+      // the top row is left as it is
+      for (int k=0, f=(nz-1)*K; k<K; k++) {
+          wr[f+k] = pr[f+k];
+          wi[f+k] = pi[f+k];
+      }
+
+      // forward substitution: psi = L^-1 work
+      for (int k=0; k<K; k++) {
+          pr[k] = wr[k]*ibr[k] - wi[k]*ibi[k];
+          pi[k] = wr[k]*ibi[k] + wi[k]*ibr[k];
+      }
+      for (int i=1; i<nz; i++) {
+          int f = i*K;
+          for (int k=0; k<K; k++) {
+              double re = wr[f+k] - (clr[k]*pr[f-K+k] - cli[k]*pi[f-K+k]);
+              double im = wi[f+k] - (clr[k]*pi[f-K+k] + cli[k]*pr[f-K+k]);
+              pr[f+k] = re*ibr[f+k] - im*ibi[f+k];
+              pi[f+k] = re*ibi[f+k] + im*ibr[f+k];
+          }
+      }
+
+      // back substitution, then the range-step damping of the row below,
+      // which is no longer needed
+      for (int i=nz-2; i>=0; i--) {
+          int f = i*K;
+          for (int k=0; k<K; k++) {
+              pr[f+k] -= gr[f+K+k]*pr[f+K+k] - gi[f+K+k]*pi[f+K+k];
+              pi[f+k] -= gr[f+K+k]*pi[f+K+k] + gi[f+K+k]*pr[f+K+k];
+              pr[f+K+k] *= dmp[f+K+k];
+              pi[f+K+k] *= dmp[f+K+k];
+          }
+      }
+      for (int k=0; k<K; k++) {
+          pr[k] *= dmp[k];
+          pi[k] *= dmp[k];
+      }
+  }
+}
@@ -0,0 +1,55 @@
+#ifndef _BatchPadeMarcher_H_
+#define _BatchPadeMarcher_H_
+
+#include <complex>
+
+//
+// Product-form Pade range step for K fields ("lanes") marched in lockstep,
+// e.g. K frequencies on a shared z- and range grid.
+//
+// Every lane has the same tridiagonal structure; only the coefficients
+// differ. Fields and coefficients are stored lane-interleaved, with real and
+// imaginary parts in separate arrays, so that the innermost loop of each
+// sweep runs over the lanes and vectorizes. The tridiagonal factorization
+// of each Pade term is computed when the lane's operator is set and reused
+// at every step until the operator changes; the right-hand side is formed
+// from Q itself, so a step streams only the factors of 1 + cm_j*Q.
+//
+// Each lane does exactly the same arithmetic whatever K is, so a lane's
+// result does not depend on the other lanes marched with it.
+//
+namespace NCPA {
+  class BatchPadeMarcher {
+    public:
+      BatchPadeMarcher(int nz, int n_pade, int nlanes);
+      ~BatchPadeMarcher();
+
+      // Pade coefficients cm, cp (n_pade), the Q operator diagonal and
+      // off-diagonal Qd, Qo (nz, as from buildQOperatorVectors) and the
+      // per-step damping (nz) of one lane
+      void setOperator(int lane, std::complex<double> *cm_coeff, std::complex<double> *cp_coeff, std::complex<double> *Qd, std::complex<double> *Qo, double *damping);
+
+      void setField(int lane, std::complex<double> *psi);
+      void getField(int lane, std::complex<double> *psi);
+      std::complex<double> getField(int lane, int iz);
+
+      // one range step of every lane: for each Pade term j,
+      // psi <- damping * (1 + cm_j*Q)^-1 (1 + cp_j*Q) psi
+      void march();
+
+      int  getNlanes();
+
+    private:
+      int     nz, n_pade, K;
+
+      // index (j*K + lane): cp_j, cp_j*Qo and cm_j*Qo; Qo is the same at every
+      // height on the uniform z-grid
+      double *cp_re, *cp_im, *cpo_re, *cpo_im, *cmo_re, *cmo_im;
+      // index ((j*nz + iz)*K + lane): LU factors of 1 + cm_j*Q
+      double *gam_re, *gam_im, *ibet_re, *ibet_im;
+      // index (iz*K + lane)
+      double *qd_re, *qd_im, *psi_re, *psi_im, *work_re, *work_im, *damp;
+  }; // mandatory semicolon here
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include <sstream>
+#include <unistd.h>
 #include <stdexcept>
 #include "anyoption.h"
 #include "ProcessOptionsPE.h"
@@ -23,14 +24,23 @@ NCPA::ProcessOptionsPE::ProcessOptionsPE(AnyOption *opt) {
   sourceheight     = z_min;       // meters
   receiverheight   = z_min;       // meters
   rng_step         = 1.0/10.0;    // wavelengths
+  rng_step_m       = 0.0;         // meters; if > 0 it overrides rng_step
   Nz_grid          = 20000;       // number of points on the z-grid	
   skiplines        = 0;           // skiplines in "atmosfile"
   grnd_imp_model   = "rigid";     // rigid ground
   wind_units       = "mpersec";   // m/s
   req_profile_step = maxrange;    // specifies the range step to request a new profile 
   starter_type     = "gaussian";  // starter field type
+  starter_cache    = "";          // no persistent starter cache
   usrattfile       = "";          // user-provided attenuation filename
+  profile_interp   = "none";      // switch between range-dependent profiles
   n_pade           = 4;
+  pade_form        = "product";   // Pade range step as a product of n_pade terms
+  batch_dir        = "papeBB";    // output directory of a multi-frequency run
+  batch_width      = 8;           // frequencies marched in lockstep
+  tloss2d_format   = "text";      // 2D TL file format
+  tloss2d_rstep    = 1;           // 2D TL at every range step ...
+  tloss2d_zstep    = 20;          // ... and every 20th grid height
   do_lossless      = 0;           // flag; if=1 => no atmospheric absorption
   ncpatoy          = 0;
 
@@ -116,6 +126,37 @@ NCPA::ProcessOptionsPE::ProcessOptionsPE(AnyOption *opt) {
       throw invalid_argument( "Option --azimuth is required!" );
   }	
 	
+  // multi-frequency run: either a list of frequencies or, as in
+  // samples/xrun_papeBB.sh, batch_nfreq frequencies i*batch_fmax/batch_nfreq
+  if ( opt->getValue( "batch_freqs" ) != NULL ) {
+      string s = opt->getValue( "batch_freqs" );
+      for (unsigned int i=0; i<s.size(); i++) {
+          if (s[i] == '_') { s[i] = ' '; }
+      }
+      istringstream iss(s);
+      double f;
+      while (iss >> f) {
+          batch_freqs.push_back(f);
+      }
+  }
+  else if ( opt->getValue( "batch_fmax" ) != NULL ) {
+      if ( opt->getValue( "batch_nfreq" ) == NULL ) {
+          delete opt;
+          throw invalid_argument( "Option --batch_fmax requires --batch_nfreq!" );
+      }
+      double fmax  = atof(opt->getValue( "batch_fmax" ));
+      int    nfreq = atoi(opt->getValue( "batch_nfreq" ));
+      for (int i=1; i<=nfreq; i++) {
+          batch_freqs.push_back(i*fmax/nfreq);
+      }
+  }
+  for (unsigned int i=0; i<batch_freqs.size(); i++) {
+      if (batch_freqs[i] <= 0) {
+          delete opt;
+          throw invalid_argument("Frequency must be positive.");
+      }
+  }
+
   if ( opt->getValue( "freq" ) != NULL ) {
       freq = atof(opt->getValue( "freq" ));
       if (freq < 0) {
@@ -124,11 +165,26 @@ NCPA::ProcessOptionsPE::ProcessOptionsPE(AnyOption *opt) {
           throw invalid_argument("Frequency must be positive.");
       }
   }
+  else if (!batch_freqs.empty()) {
+      freq = batch_freqs[0];
+  }
   else {
       delete opt;
       throw invalid_argument( "Option --freq is required!" );
   }	                 
 
+  if ( opt->getValue( "batch_dir" ) != NULL ) {
+      batch_dir = opt->getValue( "batch_dir" );
+  }
+
+  if ( opt->getValue( "batch_width" ) != NULL ) {
+      batch_width = atoi(opt->getValue( "batch_width" ));
+      if (batch_width < 1) {
+          delete opt;
+          throw invalid_argument("batch_width must be at least 1.");
+      }
+  }
+
   if (opt->getValue( "maxrange_km" ) != NULL) {
       maxrange = atof( opt->getValue( "maxrange_km" ))*1000.0;
       if (maxrange < 1000) {
@@ -179,6 +235,14 @@ NCPA::ProcessOptionsPE::ProcessOptionsPE(AnyOption *opt) {
       //cout << "rng_step = " << rng_step << endl;
   }     
 
+  if (opt->getValue( "rng_step_m" ) != NULL) {
+      rng_step_m = atof( opt->getValue("rng_step_m") );
+      if (rng_step_m <= 0) {
+          delete opt;
+          throw invalid_argument("rng_step_m must be positive.");
+      }
+  }
+
   if ( opt->getValue( "Nz_grid" ) != NULL ) {
       Nz_grid = atoi(opt->getValue( "Nz_grid" ));
       if (Nz_grid < 10) {
@@ -203,11 +267,36 @@ NCPA::ProcessOptionsPE::ProcessOptionsPE(AnyOption *opt) {
       throw invalid_argument("Please provide the modal starter file name. Use option --modal_starter_file");
     }
   }
+
+  if (opt->getValue( "starter_cache" ) != NULL) {
+      starter_cache = opt->getValue( "starter_cache" );
+  }
   
   if (opt->getValue( "n_pade" ) != NULL) {
       n_pade = atoi(opt->getValue( "n_pade" ));
   }  
 
+  if (opt->getValue( "pade_form" ) != NULL) {
+      pade_form = opt->getValue( "pade_form" );
+      if (!( !pade_form.compare("product") || !pade_form.compare("sum") ) ) {
+        delete opt;
+        throw invalid_argument("Bad pade_form: it can only be product or sum.");
+      }
+  }
+
+  // by default one thread per Pade term, up to the number of processors
+  pade_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if (pade_threads < 1 || pade_threads > n_pade) {
+      pade_threads = n_pade;
+  }
+  if (opt->getValue( "pade_threads" ) != NULL) {
+      pade_threads = atoi(opt->getValue( "pade_threads" ));
+      if (pade_threads < 1) {
+          delete opt;
+          throw invalid_argument("pade_threads must be at least 1.");
+      }
+  }
+
   //string grnd_imp_model ("rigid");
   if ( opt->getValue( "ground_impedance_model" ) != NULL ) {
       //cout << opt->getValue( "ground_impedance_model" ) << endl;
@@ -247,9 +336,57 @@ NCPA::ProcessOptionsPE::ProcessOptionsPE(AnyOption *opt) {
       }
   }
 
+  if ( opt->getValue( "profile_interp" ) != NULL ) {
+      profile_interp = opt->getValue( "profile_interp" );
+      if (!( !profile_interp.compare("none") || !profile_interp.compare("linear") || !profile_interp.compare("cosine") ) ) {
+        delete opt;
+        throw invalid_argument("Bad profile_interp: it can only be none, linear or cosine.");
+      }
+  }
+
   
   do_lossless    = opt->getFlag("do_lossless");
   write_2D_TLoss = opt->getFlag("write_2D_TLoss");
+  tloss2d_float  = opt->getFlag("tloss2d_float");
+
+  if (opt->getValue( "tloss2d_format" ) != NULL) {
+      tloss2d_format = opt->getValue( "tloss2d_format" );
+      if (!( !tloss2d_format.compare("text") || !tloss2d_format.compare("binary") ) ) {
+        delete opt;
+        throw invalid_argument("Bad tloss2d_format: it can only be text or binary.");
+      }
+  }
+
+  if (opt->getValue( "tloss2d_rstep" ) != NULL) {
+      tloss2d_rstep = atoi(opt->getValue( "tloss2d_rstep" ));
+      if (tloss2d_rstep < 1) {
+          delete opt;
+          throw invalid_argument("tloss2d_rstep must be at least 1.");
+      }
+  }
+
+  if (opt->getValue( "tloss2d_zstep" ) != NULL) {
+      tloss2d_zstep = atoi(opt->getValue( "tloss2d_zstep" ));
+      if (tloss2d_zstep < 1) {
+          delete opt;
+          throw invalid_argument("tloss2d_zstep must be at least 1.");
+      }
+  }
+
+  if (!batch_freqs.empty()) {
+      if (write_2D_TLoss) {
+          delete opt;
+          throw invalid_argument("Multi-frequency runs write the 1D TL only; drop --write_2D_TLoss.");
+      }
+      if (!pade_form.compare("sum")) {
+          delete opt;
+          throw invalid_argument("Multi-frequency runs use the product-form Pade step; drop --pade_form sum.");
+      }
+      if (!starter_type.compare("modal")) {
+          delete opt;
+          throw invalid_argument("A modal starter file holds one frequency; use a gaussian or greene starter for multi-frequency runs.");
+      }
+  }
   
 } // ------- End of processOptions -----------------------------------
 
@@ -257,7 +394,12 @@ NCPA::ProcessOptionsPE::ProcessOptionsPE(AnyOption *opt) {
 // utility to print the parameters to the screen
 void NCPA::ProcessOptionsPE::printParams() {
   printf("\n High-Angle PE run info:\n");
+  if (batch_freqs.empty()) {
   printf("                   freq : %g\n", freq);
+  } else {
+  printf("            frequencies : %d from %g to %g\n", (int) batch_freqs.size(), batch_freqs.front(), batch_freqs.back());
+  printf("              batch_dir : %s\n", batch_dir.c_str());
+  }
   printf("                azimuth : %g\n", azi);
   printf("                Nz_grid : %d\n", Nz_grid);
   printf("      z_min (meters MSL): %g\n", z_min);
@@ -266,7 +408,14 @@ void NCPA::ProcessOptionsPE::printParams() {
   printf(" receiverheight_km (AGL): %g\n", receiverheight/1000.0);    
   printf("            maxrange_km : %g\n", maxrange/1000.0);  
   printf("        PE starter_type : %s\n", starter_type.c_str());
+  if (!starter_cache.empty()) {
+  printf("          starter_cache : %s\n", starter_cache.c_str());
+  }
   printf("  N Pade coeffs (n_pade): %d\n", n_pade); 
+  printf("              pade_form : %s\n", pade_form.c_str());
+  if (!pade_form.compare("sum")) {
+  printf("           pade_threads : %d\n", pade_threads);
+  }
   printf("         grnd_imp_model : %s\n", grnd_imp_model.c_str());
   if (do_lossless) {
   printf("         atm absorption : %s\n", "not considered");
@@ -274,6 +423,10 @@ void NCPA::ProcessOptionsPE::printParams() {
   printf("         atm absorption : %s\n", "yes");
   }
   printf("    write_2D_TLoss flag : %d\n", write_2D_TLoss);
+  if (write_2D_TLoss) {
+  printf("         tloss2d_format : %s%s\n", tloss2d_format.c_str(), (!tloss2d_format.compare("binary") && tloss2d_float) ? " (float32)" : "");
+  printf("   tloss2d_rstep, zstep : %d, %d\n", tloss2d_rstep, tloss2d_zstep);
+  }
   if (ncpatoy) {
   printf("use NCPA canonical prof : %d\n", ncpatoy);
   } else if (filetype==3) {
@@ -282,6 +435,9 @@ void NCPA::ProcessOptionsPE::printParams() {
   printf("    atmospheric profile : %s\n", atmosfile.c_str());
   }
   printf("             wind_units : %s\n", wind_units.c_str());
+  if (filetype==1 || filetype==3) {
+  printf("         profile_interp : %s\n", profile_interp.c_str());
+  }
   if (!usrattfile.empty()) {
   printf("  User attenuation file : %s\n", usrattfile.c_str());
   }
@@ -325,6 +481,14 @@ std::string   NCPA::ProcessOptionsPE::getModalStarterFile() {
   return modstartfile;
 }
 
+std::string   NCPA::ProcessOptionsPE::getStarterCache() {
+  return starter_cache;
+}
+
+std::string   NCPA::ProcessOptionsPE::getProfileInterp() {
+  return profile_interp;
+}
+
 int   NCPA::ProcessOptionsPE::getSkiplines() {
   return skiplines;
 }
@@ -361,6 +525,10 @@ double NCPA::ProcessOptionsPE::getRngStep() {
   return rng_step;
 }
 
+double NCPA::ProcessOptionsPE::getRngStepMeters() {
+  return rng_step_m;
+}
+
 int   NCPA::ProcessOptionsPE::getNz_grid() {
   return Nz_grid;
 }
@@ -369,6 +537,42 @@ int   NCPA::ProcessOptionsPE::getNpade() {
   return n_pade;
 }
 
+int   NCPA::ProcessOptionsPE::getPadeThreads() {
+  return pade_threads;
+}
+
+std::string   NCPA::ProcessOptionsPE::getPadeForm() {
+  return pade_form;
+}
+
+std::vector<double> NCPA::ProcessOptionsPE::getBatchFreqs() {
+  return batch_freqs;
+}
+
+std::string   NCPA::ProcessOptionsPE::getBatchDir() {
+  return batch_dir;
+}
+
+int   NCPA::ProcessOptionsPE::getBatchWidth() {
+  return batch_width;
+}
+
+std::string   NCPA::ProcessOptionsPE::getTLoss2DFormat() {
+  return tloss2d_format;
+}
+
+int   NCPA::ProcessOptionsPE::getTLoss2DRstep() {
+  return tloss2d_rstep;
+}
+
+int   NCPA::ProcessOptionsPE::getTLoss2DZstep() {
+  return tloss2d_zstep;
+}
+
+bool   NCPA::ProcessOptionsPE::getTLoss2DFloat() {
+  return tloss2d_float;
+}
+
 std::string   NCPA::ProcessOptionsPE::getGrnd_imp_model() {
   return grnd_imp_model;
 }
@@ -1,6 +1,7 @@
 #ifndef _ProcessOptionsPE_H_
 #define _ProcessOptionsPE_H_
 
+#include <vector>
 #include "anyoption.h"
 
 namespace NCPA {
@@ -24,12 +25,22 @@ namespace NCPA {
       string   getStarterType();
       string   getUsrAttFile();
       string   getModalStarterFile();
+      string   getStarterCache();
+      string   getProfileInterp();
+      string   getPadeForm();
+      string   getBatchDir();
+      string   getTLoss2DFormat();
+      std::vector<double> getBatchFreqs();
       //string   getWindUnits();
             
       int      getFiletype();
       int      getSkiplines();
       int      getNz_grid();
       int      getNpade();
+      int      getPadeThreads();
+      int      getBatchWidth();
+      int      getTLoss2DRstep();
+      int      getTLoss2DZstep();
             
       double   getFreq();
       double   getAzimuth();
@@ -38,11 +49,13 @@ namespace NCPA {
       double   getSourceheight();
       double   getReceiverheight();
       double   getRngStep();
+      double   getRngStepMeters();
       double   getZ_min();
       double   getReq_profile_step();
       double   getMax_celerity();
                
       bool     getWrite_2D_TLoss();
+      bool     getTLoss2DFloat();
       bool     getProfile_ranges_given_flag();
       bool     getNoabsorption();
       bool     getPlot_flg();
@@ -57,12 +70,22 @@ namespace NCPA {
       string   starter_type;        // PE starter field type
       string   usrattfile;          // user-provided attenuation filename
       string   modstartfile;
+      string   starter_cache;       // directory of reusable starter fields; empty for none
+      string   profile_interp;      // blending between range-dependent profiles
+      string   pade_form;           // product or sum (partial-fraction) Pade step
+      string   batch_dir;           // output directory of a multi-frequency run
+      std::vector<double> batch_freqs; // frequencies marched together; empty for one --freq
+      string   tloss2d_format;      // text or binary 2D TL file
 
       int      filetype;            // the filetype: atmosfile, slicefile, etc.
       int      Nz_grid;             // number of points on the z-grid		
       int      Nfreq;               // number of positive frequencies 
       int      skiplines;           // number of lines to skip in "atmosfile" 
       int      n_pade;              // number of Pade coefficients
+      int      pade_threads;        // threads solving the sum-form Pade terms
+      int      batch_width;         // frequencies per batch of lockstep lanes
+      int      tloss2d_rstep;       // 2D TL saved at every tloss2d_rstep-th range step
+      int      tloss2d_zstep;       // ... and every tloss2d_zstep-th grid height
                    
       double   freq;                // Hz	
       double   z_min;               // meters
@@ -72,10 +95,12 @@ namespace NCPA {
       double   sourceheight;        // meters
       double   receiverheight;      // meters
       double   rng_step;            // units of wavelength
+      double   rng_step_m;          // meters; overrides rng_step if > 0
       double   req_profile_step;    // the profiles are requested at equidistant intervals specified by this number      
       
       bool     ncpatoy;             // flag to use built-in NCPA canonical profiles   
       bool     write_2D_TLoss;      // compute 2D TL
+      bool     tloss2d_float;       // float32 instead of float64 binary 2D TL
       bool     profile_ranges_given;// flag signaling that prf_ranges_km are given    
       bool     do_lossless;         // flag to compute the with no atm. absorption
       bool     plot_flg;
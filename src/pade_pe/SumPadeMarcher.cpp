@@ -0,0 +1,171 @@
+#include <stdexcept>
+#include "SumPadeMarcher.h"
+
+using namespace NCPA;
+using namespace std;
+
+NCPA::SumPadeMarcher::SumPadeMarcher(int nz_, int n_pade_, int nthreads_) {
+  nz       = nz_;
+  n_pade   = n_pade_;
+  nthreads = nthreads_;
+  if (nthreads < 1)      { nthreads = 1; }
+  if (nthreads > n_pade) { nthreads = n_pade; }
+
+  A0 = 1.0;
+  beta.assign(n_pade, 0.0);
+  for (int j=0; j<n_pade; j++) {
+      term.push_back(new complex<double> [ nz ]);
+      gam.push_back(new complex<double> [ nz ]);
+  }
+  Cl = Cd = Cu = NULL;
+  rhs = NULL;
+
+  generation = 0;
+  pending    = 0;
+  quit       = false;
+  failure    = NULL;
+  pthread_mutex_init(&lock, NULL);
+  pthread_cond_init(&start, NULL);
+  pthread_cond_init(&done, NULL);
+
+  // the calling thread solves the terms j = 0, nthreads, 2*nthreads, ...
+  // and worker t the terms j = t, t+nthreads, ...
+  args.resize(nthreads);
+  for (int t=1; t<nthreads; t++) {
+      args[t].self  = this;
+      args[t].first = t;
+      pthread_t thread;
+      if (pthread_create(&thread, NULL, SumPadeMarcher::runWorker, &args[t]) != 0) {
+          nthreads = t;   // carry on with the threads we have
+          break;
+      }
+      workers.push_back(thread);
+  }
+}
+
+NCPA::SumPadeMarcher::~SumPadeMarcher() {
+  pthread_mutex_lock(&lock);
+  quit = true;
+  pthread_cond_broadcast(&start);
+  pthread_mutex_unlock(&lock);
+  for (int t=0; t<(int) workers.size(); t++) {
+      pthread_join(workers[t], NULL);
+  }
+  pthread_cond_destroy(&done);
+  pthread_cond_destroy(&start);
+  pthread_mutex_destroy(&lock);
+  for (int j=0; j<n_pade; j++) {
+      delete [] term[j];
+      delete [] gam[j];
+  }
+}
+
+int NCPA::SumPadeMarcher::getNthreads() {
+  return nthreads;
+}
+
+void NCPA::SumPadeMarcher::setCoefficients(complex<double> *cm, complex<double> *cp) {
+  A0 = 1.0;
+  for (int k=0; k<n_pade; k++) {
+      A0 *= cp[k]/cm[k];
+  }
+  // residue of term j: numerator at the pole q_j = -1/cm_j over the other
+  // denominator factors there
+  for (int j=0; j<n_pade; j++) {
+      complex<double> q = -1.0/cm[j];
+      complex<double> b = 1.0;
+      for (int k=0; k<n_pade; k++) {
+          b *= 1.0 + cp[k]*q;
+          if (k != j) {
+              if (abs(cm[k]-cm[j]) == 0.0) {
+                  throw invalid_argument("Repeated Pade denominator roots: the sum form needs distinct roots.");
+              }
+              b /= 1.0 + cm[k]*q;
+          }
+      }
+      beta[j] = b;
+  }
+}
+
+void NCPA::SumPadeMarcher::march(complex<double> **Cl_, complex<double> **Cd_, complex<double> **Cu_, complex<double> *psi_o) {
+  Cl  = Cl_;
+  Cd  = Cd_;
+  Cu  = Cu_;
+  rhs = psi_o;
+
+  pthread_mutex_lock(&lock);
+  generation++;
+  pending = nthreads - 1;
+  failure = NULL;
+  pthread_cond_broadcast(&start);
+  pthread_mutex_unlock(&lock);
+
+  const char *own = solveTerms(0);
+
+  pthread_mutex_lock(&lock);
+  while (pending > 0) {
+      pthread_cond_wait(&done, &lock);
+  }
+  if (own == NULL) own = failure;
+  pthread_mutex_unlock(&lock);
+
+  // raised here rather than in solveTerms, which also runs on the workers
+  if (own != NULL) throw invalid_argument(own);
+
+  for (int i=0; i<nz; i++) {
+      complex<double> sum = A0*psi_o[i];
+      for (int j=0; j<n_pade; j++) {
+          sum += beta[j]*term[j][i];
+      }
+      psi_o[i] = sum;
+  }
+}
+
+const char *NCPA::SumPadeMarcher::solveTerms(int first) {
+  // Thomas algorithm for each term, with preallocated scratch
+  for (int j=first; j<n_pade; j+=nthreads) {
+      complex<double> *x = term[j], *g = gam[j];
+      complex<double> bet;
+      if (Cd[0][j] == 0.0) return "Singular Pade operator (Error 1 in tridag)";
+
+      x[0] = rhs[0]/(bet=Cd[0][j]);
+      for (int i=1; i<nz; i++) {
+          g[i] = Cu[i-1][j]/bet;
+          bet  = Cd[i][j]-Cl[i][j]*g[i];
+          if (bet == 0.0) return "Singular Pade operator (Error 2 in tridag)";
+          x[i] = (rhs[i]-Cl[i][j]*x[i-1])/bet;
+      }
+      for (int i=(nz-2); i>=0; i--) {
+          x[i] -= g[i+1]*x[i+1];
+      }
+  }
+  return NULL;
+}
+
+void *NCPA::SumPadeMarcher::runWorker(void *arg) {
+  SumPadeMarcher *me    = ((WorkerArg *) arg)->self;
+  int             first = ((WorkerArg *) arg)->first;
+  unsigned long   seen  = 0;
+  while (true) {
+      pthread_mutex_lock(&(me->lock));
+      while (me->generation == seen && !me->quit) {
+          pthread_cond_wait(&(me->start), &(me->lock));
+      }
+      if (me->quit) {
+          pthread_mutex_unlock(&(me->lock));
+          break;
+      }
+      seen = me->generation;
+      pthread_mutex_unlock(&(me->lock));
+
+      const char *err = me->solveTerms(first);
+
+      pthread_mutex_lock(&(me->lock));
+      if (err != NULL && me->failure == NULL) me->failure = err;
+      if (--(me->pending) == 0) {
+          pthread_cond_signal(&(me->done));
+      }
+      pthread_mutex_unlock(&(me->lock));
+  }
+  return NULL;
+}
@@ -0,0 +1,66 @@
+#ifndef _SumPadeMarcher_H_
+#define _SumPadeMarcher_H_
+
+#include <complex>
+#include <vector>
+#include <pthread.h>
+
+//
+// Partial-fraction (sum-form) Pade range step.
+//
+// The product form used by pape applies
+//     prod_j (1 + cp_j*Q) / (1 + cm_j*Q)
+// as n_pade dependent tridiagonal solves. The same rational function is
+//     A0 + sum_j beta_j / (1 + cm_j*Q)
+// with A0 = prod_j cp_j/cm_j and beta_j the residues at Q = -1/cm_j, so each
+// term is a tridiagonal solve on the same right-hand side. The terms are
+// independent and are solved concurrently by a fixed set of threads, one or
+// more terms each, then summed.
+//
+namespace NCPA {
+  class SumPadeMarcher {
+    public:
+      // nthreads includes the calling thread; it is limited to n_pade
+      SumPadeMarcher(int nz, int n_pade, int nthreads);
+      ~SumPadeMarcher();
+
+      // A0 and beta_j from the product form coefficients
+      void setCoefficients(std::complex<double> *cm_coeff, std::complex<double> *cp_coeff);
+
+      // one range step: psi_o <- (A0 + sum_j beta_j (1 + cm_j*Q)^-1) psi_o, where
+      // (1 + cm_j*Q) is given by column j of Cl, Cd, Cu as built by buildBCVectors
+      void march(std::complex<double> **Cl, std::complex<double> **Cd, std::complex<double> **Cu, std::complex<double> *psi_o);
+
+      int  getNthreads();
+
+    private:
+      int  nz, n_pade, nthreads;
+      std::complex<double>               A0;
+      std::vector< std::complex<double> > beta;
+      std::vector< std::complex<double>* > term;   // solution of term j
+      std::vector< std::complex<double>* > gam;    // tridiagonal scratch of term j
+
+      // current step, shared with the workers
+      std::complex<double> **Cl, **Cd, **Cu, *rhs;
+
+      std::vector< pthread_t > workers;
+      pthread_mutex_t lock;
+      pthread_cond_t  start, done;
+      unsigned long   generation;
+      int             pending;
+      bool            quit;
+      const char     *failure;   // first singular term reported by a worker
+
+      // NULL, or the message for a singular term
+      const char *solveTerms(int first);
+      static void *runWorker(void *arg);
+
+      struct WorkerArg {
+        SumPadeMarcher *self;
+        int             first;
+      };
+      std::vector< WorkerArg > args;
+  }; // mandatory semicolon here
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <vector>
 #include <math.h>
+#include <stdexcept>
 #include "binaryreader.h"
 
 #include <gsl/gsl_interp.h>
@@ -14,7 +15,7 @@ typedef unsigned char byte;
   AtmLibrary::AtmLibrary() { 
 }
 
-void AtmLibrary::readG2SBinary( ifstream* g2s_env, double *alt, double *range, double **zw_2D, double **mw_2D, double **T_2D, double **rho_2D, double **pr_2D)
+void AtmLibrary::readG2SBinary( ifstream* g2s_env, double *alt, double *range, NCPA::AtmosphereColumns *atm)
  {
   g2s_env->seekg( 0 , ios_base::beg );             // go back to beginning of file
   NCPA::BinaryReader *binread = new NCPA::BinaryReader();
@@ -25,84 +26,45 @@ void AtmLibrary::readG2SBinary( ifstream* g2s_env, double *alt, double *range, d
   int atm_r = filevars[ 0 ];
   int atm_z = filevars[ 1 ];
   delete [] filevars;
+  if (atm_r != atm->getNr() || atm_z != atm->getNz()) {
+      delete binread;
+      throw invalid_argument("The 2D atmosphere does not have the dimensions of the G2S file.");
+  }
 
-  // get physical information per profile. this gives us range and altitude arrays
-  double *lats     = new double[ atm_r ];
-  double *lons     = new double[ atm_r ];
-  double *bazs     = new double[ atm_r ];
-  double *ground_m = new double[ atm_r ];
-  binread->readLittleDoubleArray( g2s_env, atm_r, lats );
-  binread->readLittleDoubleArray( g2s_env, atm_r, lons );
-  binread->readLittleDoubleArray( g2s_env, atm_r, bazs );
+  // get physical information per profile. this gives us range and altitude arrays;
+  // latitude, longitude, back azimuth and ground height are skipped
+  g2s_env->seekg( 8 * 3 * atm_r, ios_base::cur );
   binread->readLittleDoubleArray( g2s_env, atm_r, range );
-  binread->readLittleDoubleArray( g2s_env, atm_r, ground_m );
+  g2s_env->seekg( 8 * atm_r, ios_base::cur );
   binread->readLittleDoubleArray( g2s_env, atm_z, alt );
-  delete [] lats;
-  delete [] lons;
-  delete [] bazs;
-  delete [] ground_m;
-
-  // get atmospheric per array. for now, just store c_eff values
-  double *temp_K        = new double[ atm_z ];
-  double *density_gpcm3 = new double[ atm_z ];
-  double *pressure_hPa  = new double[ atm_z ];
-  double *wind_zw_mps   = new double[ atm_z ];
-  double *wind_mw_mps   = new double[ atm_z ];
-  double *wind_vert_mps = new double[ atm_z ];
-  int bytesToSkipFromBeg = 8 * 5 * atm_r + 8 * atm_z + 8;
-  for (int i = 0; i < atm_r; i++) {
-   int bytesToSkipBefore  = 8 * i * atm_z;
-   int bytesToSkipAfter   = 8 * atm_z * (atm_r - i - 1);
 
-   // for subsequent iterations, skip to correct beginning
-   if (i > 0) {
-     g2s_env->seekg( bytesToSkipFromBeg, ios_base::beg );
-    }
+  // the file holds T, density, pressure, zonal and meridional wind (and the
+  // unused vertical wind) one quantity after another, each profile by profile:
+  // the layout of AtmosphereColumns, so every profile is read in place
+  for (int q = 0; q < NCPA::ATM_NQ; q++) {
+      for (int i = 0; i < atm_r; i++) {
+          binread->readLittleDoubleArray( g2s_env, atm_z, atm->column((NCPA::AtmQuantity) q, i) );
+      }
+  }
+  if (!g2s_env->good()) {
+      delete binread;
+      throw invalid_argument("The G2S file is shorter than its header says.");
+  }
 
-   g2s_env->seekg( bytesToSkipBefore, ios_base::cur );
-   binread->readLittleDoubleArray( g2s_env, atm_z, temp_K );
-   g2s_env->seekg( bytesToSkipAfter, ios_base::cur );
-    
-   g2s_env->seekg( bytesToSkipBefore, ios_base::cur );
-   binread->readLittleDoubleArray( g2s_env, atm_z, density_gpcm3 );
-   g2s_env->seekg( bytesToSkipAfter, ios_base::cur );
-
-   g2s_env->seekg( bytesToSkipBefore, ios_base::cur );
-   binread->readLittleDoubleArray( g2s_env, atm_z, pressure_hPa );
-   g2s_env->seekg( bytesToSkipAfter, ios_base::cur );
-
-   g2s_env->seekg( bytesToSkipBefore, ios_base::cur );
-   binread->readLittleDoubleArray( g2s_env, atm_z, wind_zw_mps );
-   g2s_env->seekg( bytesToSkipAfter, ios_base::cur );
-
-   g2s_env->seekg( bytesToSkipBefore, ios_base::cur );
-   binread->readLittleDoubleArray( g2s_env, atm_z, wind_mw_mps );
-   g2s_env->seekg( bytesToSkipAfter, ios_base::cur );
-
-   g2s_env->seekg( bytesToSkipBefore, ios_base::cur );
-   binread->readLittleDoubleArray( g2s_env, atm_z, wind_vert_mps );
-   g2s_env->seekg( bytesToSkipAfter, ios_base::cur );
-
-   for(int j=0; j < atm_z; j++) {
-    if (i == atm_r-1) {
-     alt[j]    = alt[j]*1000;
-    }
-    zw_2D[j][i]  = wind_zw_mps[j];
-    mw_2D[j][i]  = wind_mw_mps[j];
-    T_2D[j][i]   = temp_K[j];
-    rho_2D[j][i] = density_gpcm3[j]*1000;     
-    pr_2D[j][i]  = pressure_hPa[j]*100;     
-   }
-   range[i] = range[i]*1000;
+  // convert to SI units
+  double *rho_ = atm->block(NCPA::ATM_RHO);
+  double *pr_  = atm->block(NCPA::ATM_PR);
+  for (long n = 0; n < (long) atm_r*atm_z; n++) {
+      rho_[n] = rho_[n]*1000;
+      pr_[n]  = pr_[n]*100;
+  }
+  for (int j = 0; j < atm_z; j++) {
+      alt[j] = alt[j]*1000;
+  }
+  for (int i = 0; i < atm_r; i++) {
+      range[i] = range[i]*1000;
   }
 
-  delete [] temp_K;
-  delete [] density_gpcm3;
-  delete [] pressure_hPa;
-  delete [] wind_zw_mps;
-  delete [] wind_mw_mps;
-  delete [] wind_vert_mps;
-  
   delete binread;
  }
 
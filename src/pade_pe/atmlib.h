@@ -8,6 +8,7 @@
 #define GASCONSTANT 287.058
 
 #include <iostream>
+#include "AtmosphereColumns.h"
 
 typedef long long int64;
 
@@ -24,7 +25,7 @@ private:
         int64 swap( int64 ); */
 
 public:
-        void readG2SBinary( std::ifstream*, double*, double*, double**, double**, double**, double**, double**);
+        void readG2SBinary( std::ifstream*, double*, double*, NCPA::AtmosphereColumns*);
         void readG2SAscii( std::ifstream*, double*, double*, double*, double*, double*, double*);
         void getNumberOfLines( std::ifstream*, int*);
         void getBinaryG2SDimensions( std::ifstream*, int*, int*);
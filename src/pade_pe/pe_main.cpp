@@ -27,6 +27,8 @@
 #include <stdexcept>
 #include <math.h>
 #include <time.h>
+#include <sys/time.h>
+#include <sys/stat.h>
 #include "atmlib.h"
 #include <gsl/gsl_interp.h>
 #include <gsl/gsl_spline.h>
@@ -35,10 +37,16 @@
 #include <vector>
 #include <dirent.h>
 #include <list>
+#include <algorithm>
  
 #include "anyoption.h"
 #include "ProcessOptionsPE.h"
 #include "Atmosphere.h"
+#include "SumPadeMarcher.h"
+#include "BatchPadeMarcher.h"
+#include "AtmosphereColumns.h"
+#include "Field2DFile.h"
+#include "StarterCache.h"
 
 using namespace NCPA;
 using namespace std;
@@ -47,20 +55,23 @@ typedef unsigned int uint;
 
 // PE functions
 void buildBCVectors(complex<double>*, complex<double>*, complex<double>*, complex<double>*, complex<double>**, complex<double>**, complex<double>**, complex<double>**, complex<double>**);
-void buildQOperatorVectors(complex<double>,complex<double>*,complex<double>*);
+void buildQOperatorVectors(complex<double>,double*,complex<double>*,complex<double>*);
+void getEffectiveSoundSpeed(double*);
 void buildAbsorptiveLayer();
 void getSqrtPadeCoefficients(complex<double>*,complex<double>*);
 //void getStarterField(string,complex<double>*, double, double);
-void getStarterField(string, string, complex<double>*, double, double);
-void rhsMultiplication(int,complex<double>**,complex<double>**,complex<double>*);
-void tridagSolver(int,complex<double>**,complex<double>**,complex<double>**,complex<double>*,complex<double>*);
-void marchField(complex<double>*,complex<double>*,double*);
-void writeField(complex<double>*,int,int,int,int,int);
+void getStarterField(string, string, complex<double>*, double, double, uint64_t);
+void computeStarterField(string, string, complex<double>*, double, double);
+uint64_t starterGroundHash(double*);
+void getStepDamping(double*,double*);
+void marchField(complex<double>*,complex<double>*,double*,int);
+void setLaneOperators(BatchPadeMarcher*, int, double*, complex<double>, double*, double**, double**, complex<double>*, complex<double>*, complex<double>*, complex<double>*, complex<double>**, complex<double>**, complex<double>**, complex<double>**, complex<double>**);
+void writeField(complex<double>*,int,int,int,int,int,int);
 
 // atmosphere, interpolation and allocation functions
 void loadG2S_1DAtmosphere(std::ifstream*);
 void loadG2S_2DAtmosphere(std::ifstream*);
-void copy1DAtmosphere(int);
+void select1DAtmosphere(int);
 void getG2SRangeIndex(int, int*);
 void loadToyAtmosphere();
 void initAtmosphere(ProcessOptionsPE *oPE);
@@ -70,6 +81,11 @@ int  checkSampling();
 void initInterpolation();
 void reinitInterpolation();
 void doInterpolation();
+void evalInterpolation();
+void getLaneAbsorption(double, string, bool, double*);
+void sampleProfile(int, int, double*, string, bool, double*, double**);
+double blendWeight(double, int, int);
+void blendProfiles(double, double*, double*, double*, double*, double*, double*);
 //void freeInterpolation();
 void freeGlobals(int filetype);
 //void allocateVectors(double*,double*,complex<double>*,complex<double>*,complex<double>*,complex<double>*,complex<double>*,complex<double>*,complex<double>*);
@@ -92,6 +108,7 @@ void load_1DAtm_ascii(string atmosfile, string atmosfileorder, int skiplines, st
 int load_2DAtm_ascii(vector<double> Rv, string dirname, string pattern, string atmosfileorder, int skiplines, string wind_units);
 void load_NthProfile(int J, string atmosfile, string atmosfileorder, int skiplines, string wind_units, int Nz0);
 void get2DAtmRangeIndex(int rr, int *atm_r_index);
+int  advanceProfilePair(double R, int atm_lo);
 //double getMaxheightAtmProfile(ProcessOptionsPE *oPE);
 
 
@@ -102,10 +119,10 @@ double  zsrc, zrcv, azi, freq, c0, zmin, zmax, rmax, dz, dr, rng_step;
 int     atm_nz, atm_nr, nz, nr, nzrcv, n_pade;
 
 double  *alt, *T, *rho, *pr, *zw, *mw, *atm_rng;
-double  **T_2D, **rho_2D, **pr_2D, **zw_2D, **mw_2D;
+AtmosphereColumns *atm2d = NULL;   // range-dependent profiles; T, rho, ... then point into it
 
 double  *alt_int, *T_int, *rho_int, *pr_int, *zw_int, *mw_int;
-double  *c_int, *abs_sb, *abs_layer;
+double  *c_int, *abs_layer;
 
 string wind_units;
 
@@ -114,6 +131,8 @@ vector<double> Rv(20,0.0);
 
 FILE * fid_tloss1d;
 FILE * fid_tloss2d;
+Field2DWriter *tloss2d_bin = NULL;   // binary 2D TL, instead of fid_tloss2d
+StarterCache  *starters    = NULL;   // starter fields computed so far
 
 gsl_interp_accel *acc_T, *acc_mw, *acc_zw, *acc_rho, *acc_pr;
 gsl_spline       *T_fit, *mw_fit, *zw_fit, *rho_fit, *pr_fit;
@@ -134,6 +153,12 @@ int main( int nargin, char **argv )
   // get parameters; defaults are specified in ProcessOptionsPE
   azi      = oPE->getAzimuth();
   freq     = oPE->getFreq();  
+  // frequencies of a multi-frequency run; otherwise just --freq
+  vector<double> freqs = oPE->getBatchFreqs();
+  bool batch = !freqs.empty();
+  if (!batch) { freqs.push_back(freq); }
+  // the range step is set by the highest frequency and shared by all
+  freq     = *max_element(freqs.begin(), freqs.end());
   //zmax     = oPE->getMaxheight();
   zmin     = oPE->getZ_min();  // ground level above MSL
   nz       = oPE->getNz_grid();
@@ -149,6 +174,11 @@ int main( int nargin, char **argv )
   starter_type = oPE->getStarterType(); // gaussian/greene/modal
   modstartfile = oPE->getModalStarterFile(); // filename of pre-computed modal starter
   int filetype = oPE->getFiletype();
+
+  // blending of the range-dependent profiles: 0 = none (switch), 1 = linear, 2 = cosine
+  int interp_mode = 0;
+  if (!oPE->getProfileInterp().compare("linear")) { interp_mode = 1; }
+  if (!oPE->getProfileInterp().compare("cosine")) { interp_mode = 2; }
   
   
   if (filetype==3) {          // if ascii profiles available in a directory
@@ -182,12 +212,20 @@ int main( int nargin, char **argv )
       dr = 1000.0;
       printf("Note!! range step reduced to dr = %g from %g m\n", dr, (c0/freq)*rng_step);
   }
+  if (oPE->getRngStepMeters() > 0) {
+      dr = oPE->getRngStepMeters();
+  }
   nr     = rmax/dr;
 
   printf("\n");
   printf("High Angle PE\n");
   printf(" -> Azimuth : %.2f degrees\n", azi);
-  printf(" -> Frequency: %.2f Hz\n", freq);
+  if (batch) {
+      printf(" -> Frequencies: %d from %.2f to %.2f Hz\n", (int) freqs.size(), *min_element(freqs.begin(), freqs.end()), freq);
+  }
+  else {
+      printf(" -> Frequency: %.2f Hz\n", freq);
+  }
   printf(" -> Source height (AGL): %.2f km\n", zsrc/1000);
   printf(" -> Receiver height(AGL): %.2f km\n", zrcv/1000);
   printf(" -> Ground level (MSL): %.2f km\n", zmin/1000);
@@ -201,7 +239,8 @@ int main( int nargin, char **argv )
   if (plotr*dr>1000.0) {
       plotr = (int) floor(1000.0/dr);
   }
-  int plotz  = 20;  // save the data in height at every (plotz*dz)
+  int plotz  = oPE->getTLoss2DZstep();        // save the 2D data in height at every (plotz*dz)
+  int plotr2d = plotr*oPE->getTLoss2DRstep(); // ... and in range at every (plotr2d*dr)
   
   /*
 
@@ -247,21 +286,17 @@ int main( int nargin, char **argv )
 
   // get attenuation
   string usrattfile;
-  usrattfile = oPE->getUsrAttFile();
-  AtmLibrary *atm_  = new AtmLibrary();
-  atm_->getAbsorptionCoefficients(nz,freq,alt_int,T_int,pr_int,c_int,usrattfile, abs_sb);
-  delete atm_;
-  
-  if (oPE->getNoabsorption()) {
-      // zero the absorption
+  usrattfile    = oPE->getUsrAttFile();
+  bool lossless = oPE->getNoabsorption();
+  if (lossless) {
       cout << " -> Atmospheric absorption is zero (lossless case)." << endl;
-      for (int i=0; i<nz; i++) {
-          abs_sb[i] = 0.0;
-      }
   }
 
   buildAbsorptiveLayer();
 
+  double *ceff = new double [ nz ];
+  getEffectiveSoundSpeed(ceff);
+
   complex<double> *Qd, *Qo, *cm_coeff, *cp_coeff, *psi_o, *psi_dr;
   complex<double> **Bo, **Bd, **Cl, **Cd, **Cu;
   Qd       = new complex<double> [ nz ];
@@ -284,73 +319,257 @@ int main( int nargin, char **argv )
       Cu[ i ]  = new complex<double>[ n_pade ];
   }
 
-  //getStarterField(starter_type.c_str(),psi_o, zsrc, zrcv);
-  getStarterField(starter_type, modstartfile, psi_o, zsrc, zrcv);
-
-  // save starter field?
-  if (0) {
-      FILE *f;
-      f = fopen("starter_field.dat", "w");
-      for (int i=0; i<nz; i++) {
-          fprintf(f, "%f %g %g\n", i*dz/1000.0, real(psi_o[i]), imag(psi_o[i]));
-      }
-      fclose(f);
-      printf(" !!!  starter field saved in starter_field.dat\n");
-  }
-   
   if ( abs(admittance) == 0.0) { printf(" -> Setting up finite-differences (rigid ground) ...\n"); }
   else                         { printf(" -> Setting up finite-differences (complex impedance (%.2f,%.2f)) ...\n", real(impedance), imag(impedance)); }
 
   cout << " -> Determining Pade coefficients (" << n_pade << ")" << endl;
-  getSqrtPadeCoefficients(cm_coeff,cp_coeff);
-  cout << " -> Setting up operators ..." << endl;
-  buildQOperatorVectors(admittance,Qd,Qo);
-  buildBCVectors(cm_coeff,cp_coeff,Qd,Qo,Bd,Bo,Cl,Cd,Cu);
 
-  cout << " -> Marching out in range ..." << endl;
-                     fid_tloss1d = fopen("tloss_1d.pe","w");
-  if (plot2d == 1) { fid_tloss2d = fopen("tloss_2d.pe","w"); }
+  // The frequencies are marched nlanes at a time, in lockstep on the shared
+  // range grid; a single-frequency run is one block of one lane. Lanes past
+  // the last frequency of the last block repeat it and are not written out.
+  int nfreq  = (int) freqs.size();
+  int nlanes = min(oPE->getBatchWidth(), nfreq);
+
+  // sum-form (partial fraction) Pade step: the n_pade terms are solved concurrently
+  SumPadeMarcher   *sumPade = NULL;
+  BatchPadeMarcher *lanes   = NULL;
+  if (!oPE->getPadeForm().compare("sum")) {
+      getSqrtPadeCoefficients(cm_coeff,cp_coeff);
+      sumPade = new SumPadeMarcher(nz, n_pade, oPE->getPadeThreads());
+      sumPade->setCoefficients(cm_coeff,cp_coeff);
+      cout << " -> Sum-form Pade step on " << sumPade->getNthreads() << " thread(s)" << endl;
+  }
+  else {
+      lanes = new BatchPadeMarcher(nz, n_pade, nlanes);
+      if (batch) { cout << " -> Marching " << nlanes << " frequencies per range step" << endl; }
+  }
+
+  vector<double> lane_freq(nlanes);
+  double **lane_abs  = new double* [ nlanes ];
+  double **lane_damp = new double* [ nlanes ];
+  FILE   **lane_fid  = new FILE*   [ nlanes ];
+  vector<string> lane_file(nlanes);
+  for (int k=0; k<nlanes; k++) {
+      lane_abs[k]  = new double [ nz ];
+      lane_damp[k] = new double [ nz ];
+  }
+
+  // With profile blending the two profiles bracketing the current range are kept
+  // sampled on the PE grid; each range step then only recomputes the operator
+  // coefficients from a weighted sum of the two.
+  bool   blend = (interp_mode > 0) && (filetype==1 || filetype==3) && (atm_nr > 1);
+  double *ceff_lo = NULL, *ceff_hi = NULL, **abs_lo = NULL, **abs_hi = NULL;
+  int    atm_lo  = 0;
+  double w_prev  = -1.0;
+  if (blend) {
+      printf(" -> Blending atm. profiles in range (%s)\n", oPE->getProfileInterp().c_str());
+      ceff_lo = new double [ nz ];
+      ceff_hi = new double [ nz ];
+      abs_lo  = new double* [ nlanes ];
+      abs_hi  = new double* [ nlanes ];
+      for (int k=0; k<nlanes; k++) {
+          abs_lo[k] = new double [ nz ];
+          abs_hi[k] = new double [ nz ];
+      }
+  }
+
+  string batch_dir = oPE->getBatchDir();
+  if (batch) {
+      mkdir(batch_dir.c_str(), 0755);   // may exist already
+  }
+  string starter_dir = oPE->getStarterCache();
+  if (!starter_dir.empty()) {
+      mkdir(starter_dir.c_str(), 0755);   // may exist already
+  }
+  starters = new StarterCache(starter_dir);
+  string tloss2d_file = "tloss_2d.pe";
+  if (plot2d == 1) {
+      if (!oPE->getTLoss2DFormat().compare("binary")) {
+          tloss2d_file = "tloss_2d.bin";
+          Field2DHeader h;
+          h.sample_bytes = oPE->getTLoss2DFloat() ? 4 : 8;
+          h.freq    = freq;
+          h.zsrc    = zsrc;
+          h.zrcv    = zrcv;
+          h.azimuth = azi;
+          h.r0      = plotr2d*dr;
+          h.dr      = plotr2d*dr;
+          h.nr      = 0;
+          h.z0      = alt_int[0];
+          h.dz      = plotz*dz;
+          h.nz      = (nz + plotz - 1)/plotz;
+          tloss2d_bin = new Field2DWriter(tloss2d_file, h);
+      }
+      else {
+          fid_tloss2d = fopen(tloss2d_file.c_str(),"w");
+      }
+  }
 
-  int atm_r0_index = 0;
-  int atm_dr_index;
   int rr;
-  //
-  // big loop: marching out
-  //
-  for (rr=1; rr<nr; rr++) {
-      if (rr % showR == 0) { printf("    -> Range %.f km\n", (rr*dr)/1000); }
-      writeField(psi_o,rr,nzrcv,plot2d,plotr,plotz);
+  double march_time = 0.0;   // seconds spent in the Pade steps
+  int    nsteps     = 0;
+  struct timeval tv_1, tv_2;
+
+  for (int f0=0; f0<nfreq; f0+=nlanes) {
+      if (f0 > 0 && (filetype==1 || filetype==3)) {
+          // the next block starts again from the first profile
+          select1DAtmosphere(0);
+          reinitInterpolation();
+          evalInterpolation();
+          getEffectiveSoundSpeed(ceff);
+      }
+      uint64_t ground_hash = starterGroundHash(ceff);
+
+      for (int k=0; k<nlanes; k++) {
+          lane_freq[k] = freqs[ min(f0+k, nfreq-1) ];
+          freq         = lane_freq[k];
+          lane_fid[k]  = NULL;
+          if (f0+k < nfreq) {
+              char fname[1024] = "tloss_1d.pe";
+              if (batch) {
+                  printf(" -> Frequency %d of %d: %g Hz\n", f0+k+1, nfreq, freq);
+                  snprintf(fname, sizeof(fname), "%s/%03d_papeTL_%g", batch_dir.c_str(), f0+k+1, freq);
+              }
+              // a batch file is written as <name>.part and renamed when complete,
+              // so that tdpape --stream only ever reads finished files
+              lane_file[k] = fname;
+              string open_name = batch ? lane_file[k] + ".part" : lane_file[k];
+              lane_fid[k] = fopen(open_name.c_str(),"w");
+              if (lane_fid[k] == NULL) {
+                  throw invalid_argument(string("Could not open output file ") + open_name);
+              }
+          }
+          getLaneAbsorption(freq, usrattfile, lossless, lane_abs[k]);
 
-      if (filetype!=0 && filetype !=2) {       // if not range-independent 1D atmosphere
-          if (filetype==1) {   //g2s env file 
-              getG2SRangeIndex(rr,&atm_dr_index); // loads 1D profiles at approx midway between ranges stored in atm_rng[]
+          //getStarterField(starter_type.c_str(),psi_o, zsrc, zrcv);
+          getStarterField(starter_type, modstartfile, psi_o, zsrc, zrcv, ground_hash);
+          if (lanes) { lanes->setField(k,psi_o); }
+      }
+
+      // save starter field?
+      if (0) {
+          FILE *f;
+          f = fopen("starter_field.dat", "w");
+          for (int i=0; i<nz; i++) {
+              fprintf(f, "%f %g %g\n", i*dz/1000.0, real(psi_o[i]), imag(psi_o[i]));
           }
-          else if (filetype==3) {
-              //getG2SRangeIndex(rr,&atm_dr_index);  // loads 1D profiles at approx midway between ranges stored in atm_rng[]
-              get2DAtmRangeIndex(rr, &atm_dr_index); // ensures 1D profiles loaded at requested ranges
+          fclose(f);
+          printf(" !!!  starter field saved in starter_field.dat\n");
+      }
 
+      if (blend) {
+          atm_lo = 0;
+          w_prev = -1.0;
+          sampleProfile(0, nlanes, &lane_freq[0], usrattfile, lossless, ceff_lo, abs_lo);
+          sampleProfile(1, nlanes, &lane_freq[0], usrattfile, lossless, ceff_hi, abs_hi);
+      }
+
+      cout << " -> Setting up operators ..." << endl;
+      setLaneOperators(lanes, nlanes, &lane_freq[0], admittance, ceff, lane_abs, lane_damp, cm_coeff, cp_coeff, Qd, Qo, Bd, Bo, Cl, Cd, Cu);
+
+      cout << " -> Marching out in range ..." << endl;
+      int atm_r0_index = 0;
+      int atm_dr_index = 0;
+      //
+      // big loop: marching out
+      //
+      for (rr=1; rr<nr; rr++) {
+          if (rr % showR == 0) { printf("    -> Range %.f km\n", (rr*dr)/1000); }
+          for (int k=0; k<nlanes; k++) {
+              if (lane_fid[k] == NULL) { continue; }
+              freq        = lane_freq[k];
+              fid_tloss1d = lane_fid[k];
+              if (lanes) {
+                  if (plot2d == 1) { lanes->getField(k,psi_o); }
+                  else             { psi_o[nzrcv] = lanes->getField(k,nzrcv); }
+              }
+              writeField(psi_o,rr,nzrcv,plot2d,plotr,plotr2d,plotz);
           }
 
-          if (atm_dr_index != atm_r0_index) {
-              printf(" -> using atm. profile #%d from range %g km\n", atm_dr_index, rr*dr/1000.0);
-              copy1DAtmosphere(atm_dr_index);
-              reinitInterpolation();
-              doInterpolation();
-              buildQOperatorVectors(admittance,Qd,Qo);
-              buildBCVectors(cm_coeff,cp_coeff,Qd,Qo,Bd,Bo,Cl,Cd,Cu);
-              atm_r0_index = atm_dr_index;
+          if (blend) {
+              // medium at the middle of the step
+              double R = (rr+0.5)*dr;
+              int    j = advanceProfilePair(R, atm_lo);
+              while (atm_lo < j) {
+                  atm_lo++;
+                  printf(" -> blending atm. profiles #%d and #%d from range %g km\n", atm_lo, atm_lo+1, rr*dr/1000.0);
+                  double  *tmp  = ceff_lo; ceff_lo = ceff_hi; ceff_hi = tmp;
+                  double **tmpa = abs_lo;  abs_lo  = abs_hi;  abs_hi  = tmpa;
+                  sampleProfile(atm_lo+1, nlanes, &lane_freq[0], usrattfile, lossless, ceff_hi, abs_hi);
+                  w_prev = -1.0;
+              }
+              double w = blendWeight(R, atm_lo, interp_mode);
+              if (w != w_prev) {   // nothing to update past the last profile
+                  for (int k=0; k<nlanes; k++) {
+                      blendProfiles(w, ceff_lo, ceff_hi, abs_lo[k], abs_hi[k], ceff, lane_abs[k]);
+                  }
+                  setLaneOperators(lanes, nlanes, &lane_freq[0], admittance, ceff, lane_abs, lane_damp, cm_coeff, cp_coeff, Qd, Qo, Bd, Bo, Cl, Cd, Cu);
+                  w_prev = w;
+              }
+          }
+          else if (filetype!=0 && filetype !=2) {       // if not range-independent 1D atmosphere
+              if (filetype==1) {   //g2s env file 
+                  getG2SRangeIndex(rr,&atm_dr_index); // loads 1D profiles at approx midway between ranges stored in atm_rng[]
+              }
+              else if (filetype==3) {
+                  //getG2SRangeIndex(rr,&atm_dr_index);  // loads 1D profiles at approx midway between ranges stored in atm_rng[]
+                  get2DAtmRangeIndex(rr, &atm_dr_index); // ensures 1D profiles loaded at requested ranges
+
+              }
+
+              if (atm_dr_index != atm_r0_index) {
+                  printf(" -> using atm. profile #%d from range %g km\n", atm_dr_index, rr*dr/1000.0);
+                  select1DAtmosphere(atm_dr_index);
+                  reinitInterpolation();
+                  doInterpolation();
+                  getEffectiveSoundSpeed(ceff);
+                  setLaneOperators(lanes, nlanes, &lane_freq[0], admittance, ceff, lane_abs, lane_damp, cm_coeff, cp_coeff, Qd, Qo, Bd, Bo, Cl, Cd, Cu);
+                  atm_r0_index = atm_dr_index;
+              }
+          }
+
+          gettimeofday(&tv_1, NULL);
+          if (sumPade) {
+              sumPade->march(Cl,Cd,Cu,psi_o);
+              // the product form damps once per term
+              marchField(psi_o,psi_o,lane_damp[0],n_pade);
+          }
+          else {
+              lanes->march();
+          }
+          gettimeofday(&tv_2, NULL);
+          march_time += (tv_2.tv_sec - tv_1.tv_sec) + 1.0e-6*(tv_2.tv_usec - tv_1.tv_usec);
+          nsteps++;
+      } // end of big loop
+
+      for (int k=0; k<nlanes; k++) {
+          if (lane_fid[k] == NULL) { continue; }
+          fclose(lane_fid[k]);
+          if (batch) {
+              rename((lane_file[k] + ".part").c_str(), lane_file[k].c_str());
           }
       }
+  } // end of frequency blocks
 
-      for (int i_pade=0; i_pade < n_pade; i_pade++) {
-          rhsMultiplication(i_pade,Bd,Bo,psi_o);
-          tridagSolver(i_pade,Cl,Cd,Cu,psi_o,psi_dr);
-          marchField(psi_o,psi_dr,abs_layer);
-      }      
-  } // end of big loop
+  if (nsteps > 0) {
+      if (nlanes > 1) {
+          printf(" -> Pade step (%s form, %d frequencies): %.3f ms per range step\n", oPE->getPadeForm().c_str(), nlanes, 1000.0*march_time/nsteps);
+      }
+      else {
+          printf(" -> Pade step (%s form): %.3f ms per range step\n", oPE->getPadeForm().c_str(), 1000.0*march_time/nsteps);
+      }
+  }
+  delete sumPade;
+  delete lanes;
+  if (!starter_dir.empty()) {
+      printf(" -> Starter cache %s: %d reused, %d computed\n", starter_dir.c_str(), starters->getHits(), starters->getMisses());
+  }
+  delete starters;
 
-  fclose(fid_tloss1d);
-  if (plot2d == 1) { fclose(fid_tloss2d); }
+  if (plot2d == 1) {
+      if (tloss2d_bin) { delete tloss2d_bin; }
+      else             { fclose(fid_tloss2d); }
+  }
 
   //// plot?
   //if (oPE->getPlot_flg()) {
@@ -359,12 +578,29 @@ int main( int nargin, char **argv )
   
   // print run info
   oPE->printParams();
-  cout << "Results saved in tloss_1d.pe" << endl;
-  if (plot2d == 1) { cout << "Results saved in tloss_2d.pe" << endl; }
+  if (batch) { cout << "Results saved in " << batch_dir << "/" << endl; }
+  else       { cout << "Results saved in tloss_1d.pe" << endl; }
+  if (plot2d == 1) { cout << "Results saved in " << tloss2d_file << endl; }
 
   //freeInterpolation(); 
   freeGlobals(filetype);
   deleteVectors(Qd,Qo,psi_o,psi_dr,Bo,Bd,Cl,Cd,Cu);
+  delete [] ceff;
+  for (int k=0; k<nlanes; k++) {
+      delete [] lane_abs[k];
+      delete [] lane_damp[k];
+      if (blend) {
+          delete [] abs_lo[k];
+          delete [] abs_hi[k];
+      }
+  }
+  delete [] lane_abs;
+  delete [] lane_damp;
+  delete [] lane_fid;
+  if (blend) {
+      delete [] ceff_lo; delete [] ceff_hi;
+      delete [] abs_lo;  delete [] abs_hi;
+  }
   delete opt;
   delete oPE;
 
@@ -390,7 +626,48 @@ void getSqrtPadeCoefficients( complex<double> *cm, complex<double> *cp) {
 }
 
 
-void getStarterField( string type, string modstartfile, complex<double> *psi_o, double src_height, double rcv_height) {
+// The profile from the ground up to the source, which together with c0
+// is the lower-boundary part of a starter's cache key
+uint64_t starterGroundHash(double *ceff) {
+  int nzs = min(nz-1, (int) ceil(zsrc/dz));
+  uint64_t h = StarterCache::hash(&c0, sizeof(double));
+  return StarterCache::hash(ceff, (nzs+1)*sizeof(double), h);
+}
+
+// The starter field from the cache if it was computed before for the same
+// frequency, source height, z-grid and lower boundary; a modal starter is
+// keyed on the contents of its file.
+void getStarterField( string type, string modstartfile, complex<double> *psi_o, double src_height, double rcv_height, uint64_t ground_hash) {
+  StarterField sf;
+  sf.type        = type;
+  sf.freq        = freq;
+  sf.zsrc        = src_height;
+  sf.z0          = alt_int[0];
+  sf.dz          = dz;
+  sf.nz          = nz;
+  sf.ground_hash = ground_hash;
+  if (!type.compare("modal")) {
+      ifstream in( modstartfile.c_str(), ios_base::in | ios_base::binary );
+      if (!in.good()) { cerr << " ERROR: Modal starter file does not exist. Exiting..." << endl; exit(0); } 
+      vector<char> bytes( (istreambuf_iterator<char>(in)), istreambuf_iterator<char>() );
+      if (!bytes.empty()) {
+          sf.ground_hash = StarterCache::hash(&bytes[0], bytes.size());
+      }
+  }
+
+  if (starters->lookup(sf)) {
+      cout << " -> " << type << " starter reused from the starter cache" << endl;
+      for (int i=0; i<nz; i++) {
+          psi_o[i] = sf.psi[i];
+      }
+      return;
+  }
+  computeStarterField(type, modstartfile, psi_o, src_height, rcv_height);
+  sf.psi.assign(psi_o, psi_o + nz);
+  starters->store(sf);
+}
+
+void computeStarterField( string type, string modstartfile, complex<double> *psi_o, double src_height, double rcv_height) {
   double fct = 1.0;
   if (src_height > 1) { // source off the ground
       fct = 2.0;
@@ -452,25 +729,44 @@ void getStarterField( string type, string modstartfile, complex<double> *psi_o,
       }
   }
   else if (! strcmp(type.c_str(),"modal")) {
-      //ifstream *starter = new ifstream( "modalstarter.nm", ios_base::in );
-      ifstream *starter = new ifstream( modstartfile.c_str(), ios_base::in );
-      if (!starter->good()) { cerr << " ERROR: Modal starter file does not exist. Exiting..." << endl; exit(0); } 
-      cout << " -> Modal starter loaded from file '" << modstartfile <<  "'" << endl;
-      float dummy;
-      int n_starter = -1;
-      while(!starter->eof() ) {
-          *starter >> dummy >> dummy >> dummy; 
-          n_starter++; 
+      StarterField msf;
+      int n_starter;
+      double *x, *re_psi, *im_psi;
+      if (readStarterField(modstartfile, msf)) {
+          // binary starter from ModESS, on its full z-grid from the ground;
+          // resplined below like the text one, since pape's grid starts at dz
+          cout << " -> Modal starter loaded from binary file '" << modstartfile <<  "'" << endl;
+          n_starter = msf.nz;
+          x      = new double [ n_starter ];
+          re_psi = new double [ n_starter ];
+          im_psi = new double [ n_starter ];
+          for (int i = 0; i < n_starter; i++ ) {
+              x[i]      = (msf.z0 + i*msf.dz)/1000.0;
+              re_psi[i] = real(msf.psi[i]);
+              im_psi[i] = imag(msf.psi[i]);
+          }
       }
-      double *x      = new double[ n_starter ];
-      double *re_psi = new double [ n_starter ];
-      double *im_psi = new double [ n_starter ];
-      starter->clear();
-      starter->seekg(0, ios::beg);
-      for (int i = 0; i < n_starter; i++ ) {
-          *starter >> x[i] >> re_psi[i] >> im_psi[i];
+      else {
+          //ifstream *starter = new ifstream( "modalstarter.nm", ios_base::in );
+          ifstream *starter = new ifstream( modstartfile.c_str(), ios_base::in );
+          if (!starter->good()) { cerr << " ERROR: Modal starter file does not exist. Exiting..." << endl; exit(0); } 
+          cout << " -> Modal starter loaded from file '" << modstartfile <<  "'" << endl;
+          float dummy;
+          n_starter = -1;
+          while(!starter->eof() ) {
+              *starter >> dummy >> dummy >> dummy; 
+              n_starter++; 
+          }
+          x      = new double[ n_starter ];
+          re_psi = new double [ n_starter ];
+          im_psi = new double [ n_starter ];
+          starter->clear();
+          starter->seekg(0, ios::beg);
+          for (int i = 0; i < n_starter; i++ ) {
+              *starter >> x[i] >> re_psi[i] >> im_psi[i];
+          }
+          delete starter;
       }
-      delete starter;
 
       // respline starter
       gsl_interp_accel* acc_msr = gsl_interp_accel_alloc();
@@ -516,15 +812,39 @@ void buildBCVectors(complex<double> *cm_coeff, complex<double> *cp_coeff, comple
   }
 }
 
-void buildQOperatorVectors(complex<double> alpha,complex<double> *Qd, complex<double> *Qo) {
+void setLaneOperators(BatchPadeMarcher *lanes, int nlanes, double *lane_freq, complex<double> admittance, double *ceff, double **lane_abs, double **lane_damp, complex<double> *cm_coeff, complex<double> *cp_coeff, complex<double> *Qd, complex<double> *Qo, complex<double> **Bd, complex<double> **Bo, complex<double> **Cl, complex<double> **Cd, complex<double> **Cu) {
+  // Pade coefficients, Q operator and step damping of every lane for the medium
+  // in ceff and lane_abs; without lanes (sum form) the single frequency goes to
+  // the Bd, ..., Cu matrices
+  for (int k=0; k<nlanes; k++) {
+      freq = lane_freq[k];
+      getSqrtPadeCoefficients(cm_coeff,cp_coeff);
+      buildQOperatorVectors(admittance,ceff,Qd,Qo);
+      getStepDamping(lane_abs[k],lane_damp[k]);
+      if (lanes) {
+          lanes->setOperator(k,cm_coeff,cp_coeff,Qd,Qo,lane_damp[k]);
+      }
+      else {
+          buildBCVectors(cm_coeff,cp_coeff,Qd,Qo,Bd,Bo,Cl,Cd,Cu);
+      }
+  }
+}
+
+void getEffectiveSoundSpeed(double *ceff) {
+  // effective sound speed along the propagation azimuth on the PE grid
+  for (int i=0; i<nz; i++) {
+      ceff[i] = c_int[i] + cos((PI/180.)*azi)*mw_int[i] + sin((PI/180.)*azi)*zw_int[i];
+  }
+}
+
+void buildQOperatorVectors(complex<double> alpha, double *ceff, complex<double> *Qd, complex<double> *Qo) {
   // builds the Q operator that has the vertical operator plus omega/c squared
   // in order to expand the square root operator later, the operator is scaled :: q = (Q-k0^2) / k0^2
   // so that the vertical operator becomes sqrt(1+q)
   double omega     = 2*PI*freq;
   double k0        = omega/c0;
   int    i         = 0;
-  double wind      = cos((PI/180.)*azi)*mw_int[i] + sin((PI/180.)*azi)*zw_int[i];
-  double kk        = pow(omega/(c_int[i]+wind),2) - pow(k0,2);
+  double kk        = pow(omega/ceff[i],2) - pow(k0,2);
 
   complex<double> bndcnd    = (1.0 / ( dz * alpha+ 1.0 ) - 2.0) / pow(dz,2);    // impedance boundary condition
   complex<double> fd_on__dg = bndcnd;
@@ -533,8 +853,7 @@ void buildQOperatorVectors(complex<double> alpha,complex<double> *Qd, complex<do
   Qo[i]      =   fd_off_dg / pow(k0,2);
   fd_on__dg  = -2.0/pow(dz,2);
   for (i=1; i<nz; i++) {
-      wind  = cos((PI/180.)*azi)*mw_int[i] + sin((PI/180.)*azi)*zw_int[i];
-      kk    = pow(omega/(c_int[i]+wind),2) - pow(k0,2);
+      kk    = pow(omega/ceff[i],2) - pow(k0,2);
       Qd[i] = ( fd_on__dg + kk ) / pow(k0,2);
       if (i < (nz - 1)) { Qo[i] = fd_off_dg / pow(k0,2); }
   }
@@ -563,49 +882,25 @@ void buildAbsorptiveLayer() {
   }
 }
 
-void rhsMultiplication(int i_pade, complex<double> **Bd, complex<double> **Bo, complex<double> *psi_o) {
-  complex<double> *work = new complex<double>[ nz ];
-  work[0] = Bd[0][i_pade]*psi_o[0] + Bo[0][i_pade]*psi_o[1];
-  for(int i=1; i<nz-1; i++) {
-      work[i] = Bo[i-1][i_pade]*psi_o[i-1] + Bd[i][i_pade]*psi_o[i] + Bo[i][i_pade]*psi_o[i+1];
-  }
-  work[nz-1] = Bo[nz-2][i_pade]*psi_o[nz-2] + Bd[nz-1][i_pade]*psi_o[nz-1];
-  for (int i=0; i<nz-1; i++) {
-      psi_o[i] = work[i];
-  }
-  delete [] work;
-}
-
-
-void tridagSolver(int i_pade, complex<double> **Cl, complex<double> **Cd, complex<double> **Cu, complex<double> *psi_o, complex<double> *psi_dr) {
-  complex<double> bet;
-  complex<double> *gam = new complex<double>[ nz ];
-  if (Cd[0][i_pade] == 0.0) cerr << "Error 1 in tridag" << endl;
-
-  psi_dr[0]=psi_o[0]/(bet=Cd[0][i_pade]);
-  for (int j=1;j<nz;j++) {
-      gam[j]=Cu[j-1][i_pade]/bet;
-      bet=Cd[j][i_pade]-Cl[j][i_pade]*gam[j];
-      if (bet == 0.0) cerr << "Error 2 in tridag" << endl;
-      psi_dr[j]=(psi_o[j]-Cl[j][i_pade]*psi_dr[j-1])/bet;
-  }
-  for (int j=(nz-2);j>=0;j--) {
-      psi_dr[j] -= gam[j+1]*psi_dr[j+1];
-  }
-
-  delete [] gam;
-}
-
-void marchField(complex<double> *psi_o,complex<double> *psi_dr,double *abs_layer) {
-  double damping;
+void getStepDamping(double *absorption, double *damping) {
+  // damping over one range step: absorbing layer plus tapered atmospheric absorption
   double rdx_factor = 0.3;
   double rdx_slope  = 0.25E-03;
   double rdx_height = 90.0E03;
   double taper;
   for (int i=0; i< nz; i++) {
-      taper   = (1.0-rdx_factor)/(1.0+exp(rdx_slope*(alt_int[i]-rdx_height)))+rdx_factor;
-      //damping = exp(-abs_layer[i]*dr);
-      damping = exp(-abs_layer[i]*dr) * exp(-taper*abs_sb[i]*1.0*dr);
+      taper      = (1.0-rdx_factor)/(1.0+exp(rdx_slope*(alt_int[i]-rdx_height)))+rdx_factor;
+      //damping[i] = exp(-abs_layer[i]*dr);
+      damping[i] = exp(-abs_layer[i]*dr) * exp(-taper*absorption[i]*1.0*dr);
+  }
+}
+
+void marchField(complex<double> *psi_o,complex<double> *psi_dr,double *step_damping,int nterms) {
+  // applies the range-step damping nterms times; psi_dr may be psi_o
+  double damping;
+  for (int i=0; i< nz; i++) {
+      damping = step_damping[i];
+      if (nterms > 1) { damping = pow(damping, nterms); }
       
       // CHH 191029: Rewrote to comply with c++11 syntax:
       //real(psi_o[i]) = real(psi_dr[i])*damping;
@@ -637,7 +932,7 @@ void writeField(complex<double> *psi_o,int rr,int nzrcv,int plot2d,int plotr,int
 
 // DV 20150929 - adjusting to get the modal starter to work and not give answers dependent on frequency
 
-void writeField(complex<double> *psi_o,int rr,int nzrcv,int plot2d,int plotr,int plotz) {
+void writeField(complex<double> *psi_o,int rr,int nzrcv,int plot2d,int plotr,int plotr2d,int plotz) {
   double  k0   = 2*PI*freq/c0;
   double  R    = rr*dr;
   complex<double> hank = sqrt(2.0/(PI*k0*R))*exp(I*(k0*R - PI/4.0)); // eq 6.4 page 345 in Oc. Acoust.
@@ -645,7 +940,12 @@ void writeField(complex<double> *psi_o,int rr,int nzrcv,int plot2d,int plotr,int
 
   if (rr % plotr == 0) {
       fprintf(fid_tloss1d,"%.3f %15.8e %15.8e\n", R/1000, real(psi_o[nzrcv]*hank), imag(psi_o[nzrcv]*hank));
-      if (plot2d == 1) {
+  }
+  if (plot2d == 1 && rr % plotr2d == 0) {
+      if (tloss2d_bin) {
+          tloss2d_bin->writeRow(psi_o, plotz, hank);
+      }
+      else {
           for (int i=0; i<nz; i=i+plotz) {
               fprintf(fid_tloss2d,"%.3f %.3f %15.8e %15.8e\n", R/1000, alt_int[i]/1000, real(psi_o[i]*hank), imag(psi_o[i]*hank));
           }
@@ -702,30 +1002,23 @@ void freeGlobals(int filetype) {
   delete [] atm_rng;
   delete [] c_int ;
   delete [] abs_layer;
-  delete [] abs_sb;
   
   delete [] alt ; delete [] alt_int;
-  delete [] zw  ; delete [] zw_int;
-  delete [] mw  ; delete [] mw_int;
-  delete [] T   ; delete [] T_int;
-  delete [] rho ; delete [] rho_int;
-  delete [] pr  ; delete [] pr_int;
-
-  if (filetype!=0 && filetype !=2)  {// if 2D arrays exist (this is the range-dep atm.)
-      // free the 2D global arrays
-      for (int i = 0; i < atm_nz; i++) {
-          delete [] T_2D[ i ];
-          delete [] rho_2D [ i ];
-          delete [] pr_2D  [ i ];
-          delete [] zw_2D  [ i ];
-          delete [] mw_2D  [ i ];
-      }
-      
-      delete zw_2D;
-      delete mw_2D;
-      delete T_2D;
-      delete rho_2D;
-      delete pr_2D;
+  delete [] zw_int;
+  delete [] mw_int;
+  delete [] T_int;
+  delete [] rho_int;
+  delete [] pr_int;
+
+  if (filetype!=0 && filetype !=2)  {// range-dependent atm.: the 1D profiles are columns of atm2d
+      delete atm2d;
+  }
+  else {
+      delete [] zw;
+      delete [] mw;
+      delete [] T;
+      delete [] rho;
+      delete [] pr;
   }
     
 }
@@ -754,7 +1047,6 @@ void initInterpolation() {
   zw_int  = new double [ nz ];
   mw_int  = new double [ nz ];
   c_int   = new double [ nz ];
-  abs_sb  = new double [ nz ];
 }
 
 void reinitInterpolation() {
@@ -768,6 +1060,15 @@ void reinitInterpolation() {
 void doInterpolation() {
   AtmLibrary *atm_  = new AtmLibrary();
   
+  evalInterpolation();
+  
+  // write out interpolated values for check
+  char profile_file[40] = "profile_int.dat";
+  atm_->writeProfile(profile_file,nz,zmin,alt_int,zw_int,mw_int,T_int,rho_int,pr_int);
+  delete atm_;
+}
+
+void evalInterpolation() {
   // Note that T_int, rho_int, etc below are computed values Above Ground Level (not MSL)
   for (int i=0; i< nz; i++) {
       alt_int[i] = dz*(i+1); // alt_int is altitude Above Ground Level (AGL)
@@ -778,11 +1079,51 @@ void doInterpolation() {
       mw_int[i]  = gsl_spline_eval(mw_fit , alt_int[i] + zmin, acc_mw );
       c_int[i]   = sqrt(GAMMA*pr_int[i]/rho_int[i]);
   }
-  
-  // write out interpolated values for check
-  char profile_file[40] = "profile_int.dat";
-  atm_->writeProfile(profile_file,nz,zmin,alt_int,zw_int,mw_int,T_int,rho_int,pr_int);
-  delete atm_;
+}
+
+
+void getLaneAbsorption(double f, string usrattfile, bool lossless, double *absorption) {
+  // absorption at frequency f on the PE grid, from the profile in the *_int arrays
+  if (lossless) {
+      for (int i=0; i<nz; i++) {
+          absorption[i] = 0.0;
+      }
+  }
+  else {
+      AtmLibrary *atm_  = new AtmLibrary();
+      atm_->getAbsorptionCoefficients(nz,f,alt_int,T_int,pr_int,c_int,usrattfile,absorption);
+      delete atm_;
+  }
+}
+
+void sampleProfile(int index, int nlanes, double *lane_freq, string usrattfile, bool lossless, double *ceff, double **absorption) {
+  // samples range-dependent profile #index on the PE grid: effective sound speed
+  // and the absorption at each lane frequency. Overwrites the *_int arrays.
+  select1DAtmosphere(index);
+  reinitInterpolation();
+  evalInterpolation();
+  getEffectiveSoundSpeed(ceff);
+  for (int k=0; k<nlanes; k++) {
+      getLaneAbsorption(lane_freq[k], usrattfile, lossless, absorption[k]);
+  }
+}
+
+double blendWeight(double R, int atm_lo, int interp_mode) {
+  // weight of profile #(atm_lo+1) at range R; 0 before atm_rng[atm_lo], 1 past atm_rng[atm_lo+1]
+  double t = (R - atm_rng[atm_lo])/(atm_rng[atm_lo+1] - atm_rng[atm_lo]);
+  if (t < 0.0) { t = 0.0; }
+  if (t > 1.0) { t = 1.0; }
+  if (interp_mode == 2) {   // raised cosine: smooth at the profile ranges
+      t = 0.5*(1.0 - cos(PI*t));
+  }
+  return t;
+}
+
+void blendProfiles(double w, double *ceff_lo, double *ceff_hi, double *abs_lo, double *abs_hi, double *ceff, double *absorption) {
+  for (int i=0; i<nz; i++) {
+      ceff[i]       = (1.0-w)*ceff_lo[i] + w*ceff_hi[i];
+      absorption[i] = (1.0-w)*abs_lo[i]  + w*abs_hi[i];
+  }
 }
 
 
@@ -927,27 +1268,12 @@ void loadG2S_2DAtmosphere(ifstream* profile) {
 
   alt     = new double  [ atm_nz ];
   atm_rng = new double  [ atm_nr ];
-  T_2D    = new double* [ atm_nz ];
-  rho_2D  = new double* [ atm_nz ];
-  pr_2D   = new double* [ atm_nz ];
-  zw_2D   = new double* [ atm_nz ];
-  mw_2D   = new double* [ atm_nz ];
-  for (int i = 0; i < atm_nz; i++) {
-      T_2D   [ i ]  = new double[ atm_nr ];
-      rho_2D [ i ]  = new double[ atm_nr ];
-      pr_2D  [ i ]  = new double[ atm_nr ];
-      zw_2D  [ i ]  = new double[ atm_nr ];
-      mw_2D  [ i ]  = new double[ atm_nr ];
-  }
+  atm2d   = new AtmosphereColumns(atm_nz, atm_nr);
 
-  atm_->readG2SBinary(profile,alt,atm_rng,zw_2D,mw_2D,T_2D,rho_2D,pr_2D);
+  atm_->readG2SBinary(profile,alt,atm_rng,atm2d);
+  delete atm_;
 
-  T       = new double [ atm_nz ];
-  rho     = new double [ atm_nz ];
-  pr      = new double [ atm_nz ];
-  zw      = new double [ atm_nz ];
-  mw      = new double [ atm_nz ];
-  copy1DAtmosphere(0);
+  select1DAtmosphere(0);
   
   zmax = alt[atm_nz-1]; // set the global zmax
   //printf("readG2SBinary: zmax= %g\n", zmax);
@@ -978,33 +1304,30 @@ void load_NthProfile(int J, string atmosfile, string atmosfileorder, int skiplin
       throw invalid_argument( " ");
   }
 
+  // the profile goes straight into column J of the 2D atmosphere
+  double *zw_  = atm2d->column(ATM_ZW,  J);
+  double *mw_  = atm2d->column(ATM_MW,  J);
+  double *T_   = atm2d->column(ATM_T,   J);
+  double *rho_ = atm2d->column(ATM_RHO, J);
+  double *pr_  = atm2d->column(ATM_PR,  J);
   p->get_z(  alt, atm_nz);
-  p->get_u(   zw, atm_nz);
-  p->get_v(   mw, atm_nz);
-  p->get_t(    T, atm_nz);
-  p->get_rho(rho, atm_nz);
-  p->get_p(   pr, atm_nz); 
+  p->get_u(  zw_, atm_nz);
+  p->get_v(  mw_, atm_nz);
+  p->get_t(   T_, atm_nz);
+  p->get_rho(rho_, atm_nz);
+  p->get_p(  pr_, atm_nz); 
   
   // convert to SI units
   double kmps2mps = 1.0;
   //if (!wind_units.compare("kmpersec")) {
       kmps2mps = 1000.0;
   //}
-  for (int i = 0; i < atm_nz; i++) {
-      alt[i] = alt[i]*1000;
-      rho[i] = rho[i]*1000;
-      pr[i]  = pr[i]*100;
-      zw[i]  = zw[i]*kmps2mps;
-      mw[i]  = mw[i]*kmps2mps;
-  }
-  
-  // populate the Nth profile in the 2D atmosphere
-  for (i=0; i<atm_nz; i++) {
-      T_2D  [i][J] = T  [i];
-      rho_2D[i][J] = rho[i];
-      pr_2D [i][J] = pr [i];
-      zw_2D [i][J] = zw [i];
-      mw_2D [i][J] = mw [i];
+  for (i = 0; i < atm_nz; i++) {
+      alt[i]  = alt[i]*1000;
+      rho_[i] = rho_[i]*1000;
+      pr_[i]  = pr_[i]*100;
+      zw_[i]  = zw_[i]*kmps2mps;
+      mw_[i]  = mw_[i]*kmps2mps;
   }
 
   delete p;
@@ -1097,19 +1420,7 @@ int load_2DAtm_ascii(vector<double> Rv, string dirname, string pattern, string a
 
   atm_rng = new double  [ atm_nr ];
   alt     = new double  [ atm_nz ];
-  T_2D    = new double* [ atm_nz ];
-  rho_2D  = new double* [ atm_nz ];
-  pr_2D   = new double* [ atm_nz ];
-  zw_2D   = new double* [ atm_nz ];
-  mw_2D   = new double* [ atm_nz ];
-  
-  for (i = 0; i < atm_nz; i++) {
-      T_2D   [ i ]  = new double[ atm_nr ];
-      rho_2D [ i ]  = new double[ atm_nr ];
-      pr_2D  [ i ]  = new double[ atm_nr ];
-      zw_2D  [ i ]  = new double[ atm_nr ];
-      mw_2D  [ i ]  = new double[ atm_nr ];
-  }
+  atm2d   = new AtmosphereColumns(atm_nz, atm_nr);
   
   //printf("atm_nz = %d\n", p->nz());
   for (i=0; i<atm_nr; i++) {
@@ -1118,13 +1429,7 @@ int load_2DAtm_ascii(vector<double> Rv, string dirname, string pattern, string a
       //printf("Rv[%d] = %g\n", i, Rv[i]);
   }
   
-  T   = new double [ atm_nz ];
-  rho = new double [ atm_nz ];
-  pr  = new double [ atm_nz ];
-  zw  = new double [ atm_nz ];
-  mw  = new double [ atm_nz ];
-
-  // populate T_2D,rho_2D, etc. by calling load_NthProfile()
+  // populate atm2d by calling load_NthProfile()
   i = 0;
   for (it=files.begin(); it!=files.end(); ++it) {
       s = (*it);
@@ -1141,7 +1446,7 @@ int load_2DAtm_ascii(vector<double> Rv, string dirname, string pattern, string a
   }
 
   printf(" -> Initializing with atm. profile #0 from range 0 km\n");
-  copy1DAtmosphere(0);
+  select1DAtmosphere(0);
   
   zmax = alt[atm_nz-1]; // set the global zmax
   //printf("load_2DAtm_ascii: zmax= %g\n", zmax);
@@ -1150,14 +1455,13 @@ int load_2DAtm_ascii(vector<double> Rv, string dirname, string pattern, string a
 }
 
 
-void copy1DAtmosphere(int index) {
-  for (int i=0; i< atm_nz; i++) {
-      T[i]   = T_2D[i][index];
-      rho[i] = rho_2D[i][index];
-      pr[i]  = pr_2D[i][index];
-      zw[i]  = zw_2D[i][index];
-      mw[i]  = mw_2D[i][index];
-  }
+void select1DAtmosphere(int index) {
+  // the 1D profile globals are views of profile #index; nothing is copied
+  T   = atm2d->column(ATM_T,   index);
+  rho = atm2d->column(ATM_RHO, index);
+  pr  = atm2d->column(ATM_PR,  index);
+  zw  = atm2d->column(ATM_ZW,  index);
+  mw  = atm2d->column(ATM_MW,  index);
 }
 
 void getG2SRangeIndex(int rr, int *atm_r_index) {
@@ -1165,15 +1469,12 @@ void getG2SRangeIndex(int rr, int *atm_r_index) {
  // this logic ensures to reload the next 1D profile as soon as we step 
  // into more than half way between the succesive profile distance
  
+  // The range only increases during the march, so the search starts from the
+  // index found at the previous step.
   double R     = rr*dr;
-  double min_r = fabs(atm_rng[0] - R);
-
-  int ii       = 0;
-  for (int i=1; i<atm_nr; i++) {
-      if (fabs(atm_rng[i] - R) < min_r) { 
-          min_r = fabs(atm_rng[i] - R );
-          ii    = i;
-      }
+  int ii       = *atm_r_index;
+  while (ii < atm_nr-1 && fabs(atm_rng[ii+1] - R) < fabs(atm_rng[ii] - R)) {
+      ii++;
   }
   *atm_r_index = ii;
 }
@@ -1182,16 +1483,24 @@ void getG2SRangeIndex(int rr, int *atm_r_index) {
 void get2DAtmRangeIndex(int rr, int *atm_r_index) {
   // this logic ensures to reload the next 1D profile as soon as we marched
   // more than the profile given in atm_rng[i] 
+  // The search starts from the index found at the previous step.
   double R = rr*dr; 
-  int ii   = 0;
-  for (int i=1; i<atm_nr; i++) {
-     if (R>= atm_rng[i]) {
-        ii = i;
-     }
+  int ii   = *atm_r_index;
+  while (ii < atm_nr-1 && R >= atm_rng[ii+1]) {
+     ii++;
   }
   *atm_r_index = ii;
 }
 
+int advanceProfilePair(double R, int atm_lo) {
+  // index of the first of the two profiles bracketing range R, searching
+  // forward from atm_lo; stays on the last pair past the last profile
+  while (atm_lo < atm_nr-2 && R >= atm_rng[atm_lo+1]) {
+     atm_lo++;
+  }
+  return atm_lo;
+}
+
 ///// END OF G2S routines /////
 
 void loadToyAtmosphere() {
@@ -1604,7 +1913,8 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( "                          (Ex: 'ztuvpd')" );
   opt->addUsage( " --skiplines              Lines at the beginning of the ASCII file to skip" );
   opt->addUsage( " --azimuth                Degrees in range [0,360), clockwise from North" );
-  opt->addUsage( " --freq                   Frequency [Hz]" );
+  opt->addUsage( " --freq                   Frequency [Hz]; not needed with --batch_freqs or" );
+  opt->addUsage( "                          --batch_fmax" );
 
   opt->addUsage( " --g2senvfile <filename>  Uses an .env binary file (for range-dependent code)" );   
   opt->addUsage( " --use_1D_profiles_from_dir" );
@@ -1636,18 +1946,43 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( " --rng_step               A usually fractional number specifying the range step" );
   opt->addUsage( "                          in wavelengths: e.g. --rng_step 0.1 means a step" );
   opt->addUsage( "                          of 0.1*wavelength [default is 0.1]." );
+  opt->addUsage( " --rng_step_m             Range step in meters; overrides --rng_step" );
   opt->addUsage( " --ground_impedance_model Name of the ground impedance models to be employed:" );
   opt->addUsage( "                          [rigid], others TBD" );
 	opt->addUsage( " --wind_units             Specify 'kmpersec' if the winds are given" );
 	opt->addUsage( "                          in km/s [ mpersec ]" );  
   opt->addUsage( " --n_pade                 Number of Pade coefficients [4]" );  
+  opt->addUsage( " --pade_form              Pade range step as a 'product' of n_pade terms" );
+  opt->addUsage( "                          applied in turn, or as a 'sum' of partial fractions" );
+  opt->addUsage( "                          whose terms are solved concurrently [product]" );
+  opt->addUsage( " --pade_threads           Threads solving the terms of the sum form" );
+  opt->addUsage( "                          [one per term, up to the number of processors]" );
+  opt->addUsage( "" );
+  opt->addUsage( " --batch_freqs            Multi-frequency run: frequencies in a string such as" );
+  opt->addUsage( "                          0.1_0.2_0.4 (underscores separate the numbers)." );
+  opt->addUsage( "                          The frequencies are marched together on the range" );
+  opt->addUsage( "                          step of the highest one; the TL of frequency #i is" );
+  opt->addUsage( "                          saved in <batch_dir>/<iii>_papeTL_<freq>, the layout" );
+  opt->addUsage( "                          tdpape reads. A single run with --rng_step_m set to" );
+  opt->addUsage( "                          that range step gives the same result." );
+  opt->addUsage( " --batch_fmax             With --batch_nfreq: the frequencies i*fmax/nfreq," );
+  opt->addUsage( " --batch_nfreq            i = 1, ..., nfreq, as in samples/xrun_papeBB.sh" );
+  opt->addUsage( " --batch_width            Frequencies advanced in one range step [8]" );
+  opt->addUsage( " --batch_dir              Output directory of a multi-frequency run [papeBB]" );
+  opt->addUsage( "                          Files are named *.part until they are complete." );
   opt->addUsage( "" );
   opt->addUsage( " --starter_type           Specifies one of 3 available PE starter" );
   opt->addUsage( "                          fields: gaussian, greene, modal." );
   opt->addUsage( "                          The default is 'gaussian'." );
   opt->addUsage( "                          'modal' requires a precomputed starter field" );
   opt->addUsage( "                          obtained by running Modess with option" ); 
-  opt->addUsage( "                          --modal_starter_file." );
+  opt->addUsage( "                          --modal_starter_file, as text or (with" );
+  opt->addUsage( "                          --modal_starter_format binary) in binary." );
+  opt->addUsage( " --starter_cache          Directory in which starter fields are kept and" );
+  opt->addUsage( "                          reused by later runs with the same frequency," );
+  opt->addUsage( "                          source height, z-grid and ground profile (or" );
+  opt->addUsage( "                          modal starter file). Without it starters are" );
+  opt->addUsage( "                          only reused within a run." );
   opt->addUsage( "" );	
   opt->addUsage( "" );	
   opt->addUsage( "" );	
@@ -1685,17 +2020,31 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->addUsage( "                              height (km AGL) and " );
 	opt->addUsage( "                              attenuation coefficients in np/m." );    
   opt->addUsage( "" );                        
+  opt->addUsage( " --tloss2d_format         Format of the 2D TL: 'text' (tloss_2d.pe) or 'binary'" );
+  opt->addUsage( "                          (tloss_2d.bin, read by NCPA::Field2DReader) [text]" );
+  opt->addUsage( " --tloss2d_rstep          2D TL saved at every n-th range step [1]" );
+  opt->addUsage( " --tloss2d_zstep          2D TL saved at every n-th grid height [20]" );
+  opt->addUsage( " --profile_interp         How the range-dependent profiles are combined between" );
+  opt->addUsage( "                          the ranges they are given at: 'none' switches to the" );
+  opt->addUsage( "                          next profile, 'linear' or 'cosine' blend the effective" );
+  opt->addUsage( "                          sound speed and absorption of the two bracketing" );
+  opt->addUsage( "                          profiles [none]" );
+  opt->addUsage( "" );
   opt->addUsage( "" );  
   opt->addUsage( "FLAGS (no value required):" );
   opt->addUsage( " --ncpatoy                Use built-in NCPA canonical profile" );
   opt->addUsage( " --write_2D_TLoss         Outputs the 2D transmission loss to" );
   opt->addUsage( "                          default file: tloss_2d.pe" );	
+  opt->addUsage( "                          (tloss_2d.bin with --tloss2d_format binary)" );
   opt->addUsage( " --do_lossless            Computation is done with no atm. absorption" );  
+  opt->addUsage( " --tloss2d_float          Stores the binary 2D TL as float32 [float64]" );
   opt->addUsage( "" );
   opt->addUsage( "" );
   opt->addUsage( " The column order of the output files is as follows (P is complex pressure):" );
   opt->addUsage( "  tloss_1d.pe:           r, 4*PI*Re(P), 4*PI*Im(P)" );
   opt->addUsage( "  tloss_2d.pe:        r, z, 4*PI*Re(P), 4*PI*Im(P)" );   
+  opt->addUsage( "  tloss_2d.bin:       header (grid, frequency, source and receiver heights)," );
+  opt->addUsage( "                      then rows of Re(P), Im(P) pairs, one row per range" );
   opt->addUsage( "" );
   opt->addUsage( "" );
   opt->addUsage( "--------------------------------------------------------------------" );  
@@ -1703,6 +2052,8 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( "" );
   opt->addUsage( "    ../bin/pape  --ncpatoy --azimuth 90 --freq 0.1 --write_2D_TLoss" );
   opt->addUsage( "" );
+  opt->addUsage( "    ../bin/pape  --ncpatoy --azimuth 90 --batch_fmax 2 --batch_nfreq 20 --batch_dir myTDPape_dir" );
+  opt->addUsage( "" );
   opt->addUsage( "    ../bin/pape --g2senvfile g2sgcp2011012606L.jordan.env --atmosfileorder zuvwtdp --skiplines 0 --azimuth 90 --freq 0.3 --sourceheight_km 0 --receiverheight_km 0 --maxheight_km 180 --starter_type gaussian --n_pade 6 --maxrange_km 500" ); 
   opt->addUsage( "" );
   opt->addUsage( "    ../bin/pape --atmosfile1d NCPA_canonical_profile_zuvwtdp.dat --atmosfileorder zuvwtdp --skiplines 0 --azimuth 90 --freq 0.1 --sourceheight_km 0 --receiverheight_km 0 --maxheight_km 180 --starter_type gaussian --n_pade 4 --maxrange_km 500 --write_2D_TLoss" );  
@@ -1728,6 +2079,7 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->setFlag( "write_2D_TLoss" );
   opt->setFlag( "ncpatoy" );
   opt->setFlag( "do_lossless" );
+  opt->setFlag( "tloss2d_float" );
   opt->setFlag( "plot" );
 
   opt->setOption( "atmosfile1d" );
@@ -1748,13 +2100,26 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->setOption( "stepsize" );
   opt->setOption( "Nz_grid" );
   opt->setOption( "n_pade" );
+  opt->setOption( "pade_form" );
+  opt->setOption( "pade_threads" );
+  opt->setOption( "batch_freqs" );
+  opt->setOption( "batch_fmax" );
+  opt->setOption( "batch_nfreq" );
+  opt->setOption( "batch_width" );
+  opt->setOption( "batch_dir" );
+  opt->setOption( "rng_step_m" );
   opt->setOption( "starter_type" );
   opt->setOption( "modal_starter_file" );
+  opt->setOption( "starter_cache" );
   opt->setOption( "ground_impedance_model" );
   opt->setOption( "Lamb_wave_BC" );
   opt->setOption( "use_profile_ranges_km" ); 
   opt->setOption( "use_profiles_at_steps_km" );
   opt->setOption( "use_attn_file" );
+  opt->setOption( "profile_interp" );
+  opt->setOption( "tloss2d_format" );
+  opt->setOption( "tloss2d_rstep" );
+  opt->setOption( "tloss2d_zstep" );
 
   // Process the command-line arguments
   opt->processFile( "./PaPE.options" );
@@ -15,6 +15,26 @@ NCPA::Acoustic2DEquationSet::Acoustic2DEquationSet( NCPA::AtmosphericSpecificati
 	azimuth = propagation_azimuth;
 	takeoff = takeoffangle;
 	rangeDependent_ = rangeDependent;
+	updateAngles();
+}
+
+void NCPA::Acoustic2DEquationSet::changeTakeoffAngle( double newAngle ) {
+	takeoff = newAngle;
+	updateAngles();
+}
+
+void NCPA::Acoustic2DEquationSet::changeAzimuth( double newAzimuth ) {
+	azimuth = newAzimuth;
+	updateAngles();
+}
+
+void NCPA::Acoustic2DEquationSet::updateAngles() {
+	double cart_angle = NCPA::deg2rad( 90 - azimuth );
+	costakeoff_ = std::cos( takeoff );
+	sintakeoff_ = std::sin( takeoff );
+	cosaz_ = std::cos( cart_angle );
+	sinaz_ = std::sin( cart_angle );
+	ceffGround_ = profile->ceff( 0.0, 0.0, profile->z0( 0.0, 0.0 ), azimuth );
 }
 
 int NCPA::Acoustic2DEquationSet::numberOfEquations() const { return 6; }
@@ -40,38 +60,50 @@ void NCPA::Acoustic2DEquationSet::setupInitialConditions( double *initialConditi
 }
 
 void NCPA::Acoustic2DEquationSet::results( double s, double *current_values, double *new_values ) {
+	evaluateRHS< true >( current_values, new_values );
+}
+
+template< bool Auxiliary >
+void NCPA::Acoustic2DEquationSet::evaluateRHS( const double *current_values, double *new_values ) const {
 	// Identify the current values by name, for ease of reading/debugging
 	double r = current_values[ 0 ];
 	double z = current_values[ 1 ];
 	double Zeta = current_values[ 2 ];
-	//double rt = current_values[ 3 ];
-	double zt = current_values[ 4 ];
-	double Zetat = current_values[ 5 ];
 	
 	// Calculate x and y values from r and azimuth
-	double cart_angle = NCPA::deg2rad( 90 - this->azimuth );
 	double x = 0.0;
 	double y = 0.0;
+	double c0 = ceffGround_;
 	if (rangeDependent_) {
-		x = r * std::cos( cart_angle );
-		y = r * std::sin( cart_angle );
+		x = r * cosaz_;
+		y = r * sinaz_;
+		c0 = this->profile->ceff( x, y, profile->z0(x,y), this->azimuth );
 	}
 	
 	double c = this->profile->ceff( x, y, z, this->azimuth );
-	double c0 = this->profile->ceff( x, y, profile->z0(x,y), this->azimuth );
 	double dc = this->profile->dceffdz( x, y, z, this->azimuth );
-	double ddc = this->profile->ddceffdzdz( x, y, z, this->azimuth );
+	double inv_c = 1.0 / c;
+	double c_over_c0 = c / c0;
 	
-	new_values[ 0 ] = std::cos( this->takeoff ) * c / c0;
+	new_values[ 0 ] = costakeoff_ * c_over_c0;
 	new_values[ 1 ] = c * Zeta;
-	new_values[ 2 ] = -dc / std::pow( c, 2 );
-	new_values[ 3 ] = (dc * zt * std::cos( this->takeoff ) / c0 )
-				- (std::sin( this->takeoff ) * c / c0 );
-	new_values[ 4 ] = dc * zt * Zeta + c * Zetat;
-	new_values[ 5 ] = (2.0 / std::pow( c, 3.0 ) * std::pow( dc, 2.0 ) * zt)
-				- (ddc / std::pow( c, 2.0 ) * zt);
-	
+	new_values[ 2 ] = -dc * inv_c * inv_c;
+
+	if (Auxiliary) {
+		//double rt = current_values[ 3 ];
+		double zt = current_values[ 4 ];
+		double Zetat = current_values[ 5 ];
+		double ddc = this->profile->ddceffdzdz( x, y, z, this->azimuth );
+
+		new_values[ 3 ] = (dc * zt * costakeoff_ / c0 ) - (sintakeoff_ * c_over_c0);
+		new_values[ 4 ] = dc * zt * Zeta + c * Zetat;
+		new_values[ 5 ] = (2.0 * inv_c * inv_c * inv_c * dc * dc * zt)
+					- (ddc * inv_c * inv_c * zt);
+	}
 }
+
+template void NCPA::Acoustic2DEquationSet::evaluateRHS< true >( const double *, double * ) const;
+template void NCPA::Acoustic2DEquationSet::evaluateRHS< false >( const double *, double * ) const;
 	
 	
 /*
@@ -22,6 +22,26 @@ namespace NCPA {
 			double transmissionLoss( double **solution, int steps, double &refDist ) const;
 			void setupInitialConditions( double *initialConditions, double zmin, double c0 ) const;
 			void setupInitialConditions( double *initialConditions, double zmin );
+			void changeTakeoffAngle( double newAngle );
+			void changeAzimuth( double newAzimuth );
+
+		protected:
+			// Trigonometric functions of the launch angles, refreshed when they change
+			double costakeoff_, sintakeoff_, cosaz_, sinaz_;
+
+			// Effective sound speed at the ground under the source; only used
+			// when the profile is treated as range-independent
+			double ceffGround_;
+
+			void updateAngles();
+
+			/*
+			 * Evaluates the right-hand side.  The path equations (0-2) are always
+			 * computed; the takeoff-angle derivatives (3-5), which need the second
+			 * derivative of ceff, only when Auxiliary is set.
+			 */
+			template< bool Auxiliary >
+			void evaluateRHS( const double *current_values, double *new_values ) const;
 
 	};
 }
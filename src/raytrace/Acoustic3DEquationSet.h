@@ -11,69 +11,79 @@ namespace NCPA {
 			Acoustic3DEquationSet( AtmosphericSpecification *spec, 
 				double takeoffAngle, double propagation_azimuth,
 				bool rangeDependent = true );
-			//double result( double t, double *current_values, int which );
 			void results( double t, double *current_values, double *new_values );
 			int numberOfEquations() const;
 
 			double calculateTravelTime( double **solution, int steps, 
 				double step_size, double azimuth = 0 ) const;
+
+			// Travel time accumulated over steps first..last inclusive, so that
+			// the time to each of several bounces can be summed segment by segment
+			double calculateTravelTime( double **solution, int first, int last,
+				double step_size ) const;
 			double calculateAmplitude( double **solution, int steps ) const;
 			double transmissionLoss( double **solution, int k, double &refRange ) const;
-			double Jacobian( double **solution, int steps ) const;
+			virtual double Jacobian( double **solution, int steps ) const;
 			double calculateArrivalAzimuth( double **solution, int steps, int averages ) const;
 			void setupInitialConditions( double *initialConditions, double zmin );
 
+			// Group velocity and its magnitude at a solution point, with a single
+			// set of atmospheric queries.  cg may be null if only the magnitude
+			// is wanted.
+			double groupVelocity( const double *point, double *cg, double *magnu = 0 ) const;
+
 
 		protected:
+			// Sound speed at the source-side ground point, which normalizes |nu|
+			double c0_0_;
+
+			// Set when the profile varies only with height, so that horizontal
+			// derivatives are known to be zero and needn't be requested
+			bool stratified_;
+
+			/*
+			 * Atmospheric state at one point of the ray: f holds (c0,u,v,w), grad
+			 * their gradients, and hess their Hessians (only filled in when the
+			 * auxiliary equations need them).  Gathered once per RHS evaluation.
+			 */
+			struct AtmosphereState {
+				double f[ 4 ], grad[ 4 ][ 3 ], hess[ 4 ][ 3 ][ 3 ];
+			};
+
 			/*
-			The following functions are neceessary to calculate ray path and Jacobian source functions in 
-			3 dimensions with source functions varying in more than 1 dimension (non-stratified):
-			        1.  Magnitude of nu vector
-			        2.  Components and magnitude of group velocity vector
-			        3.  Derivative of sound speed, winds, and group velocity with respect to angle
-			*/
-			double mag_nu( double r1, double r2, double r3,	double nu1, double nu2, double nu3 ) const;
-			double cg1( double r1, double r2, double r3, double nu1, double nu2, double nu3 ) const;
-			double cg2( double r1, double r2, double r3, double nu1, double nu2, double nu3 ) const;
-			double cg3( double r1, double r2, double r3, double nu1, double nu2, double nu3 ) const;
-			double cg_mag( double r1, double r2, double r3, double nu1, double nu2, double nu3 ) const;
-			double dc_angle( double r1, double r2, double r3, double dr1_angle, double dr2_angle, double dr3_angle ) const;
-			double du_angle( double r1, double r2, double r3, double dr1_angle, double dr2_angle, double dr3_angle ) const;
-			double dv_angle( double r1, double r2, double r3, double dr1_angle, double dr2_angle, double dr3_angle ) const;
-			double dw_angle( double r1, double r2, double r3, double dr1_angle, double dr2_angle, double dr3_angle ) const;
-			double dCg_angle( double r1, double r2, double r3, double nu1, double nu2, double nu3, double dr1_angle, 
-					double dr2_angle, double dr3_angle, double dnu1_angle, double dnu2_angle, double dnu3_angle ) const;
-					
+			 * Ray invariants derived from the state and the slowness direction nu:
+			 * |nu|, the group velocity and its magnitude, the terms
+			 * sub[k] = W_k/c + nu_k/|nu| shared by every angular derivative of the
+			 * group speed, and S[j] = |nu| dc/dx_j + nu . dW/dx_j, the slowness
+			 * forcing.
+			 */
+			struct RayInvariants {
+				double magnu, inv_magnu, cg[ 3 ], cgmag, inv_cgmag, sub[ 3 ], S[ 3 ];
+			};
+
+			void atmosphereState( double r1, double r2, double r3, bool hessians,
+				AtmosphereState &state ) const;
+			void rayInvariants( const AtmosphereState &state, const double *nu,
+				RayInvariants &inv ) const;
+
+			/*
+			 * Evaluates the right-hand side.  The position and slowness equations
+			 * (0-5) are always computed; the theta and phi auxiliary equations
+			 * (6-17), which need the atmospheric Hessians, only when Auxiliary is
+			 * set.  Instantiating with Auxiliary = false gives the geometry-only
+			 * kernel used when amplitudes and Jacobians aren't wanted.
+			 */
+			template< bool Auxiliary >
+			void evaluateRHS( const double *current_values, double *new_values ) const;
+
 			/*
-			 * This set of functions supplies the required atmospheric characteristics, instead of calculating them from
-			 * the AtmosphericSpecification.
+			 * d/ds of one block of auxiliary variables (dr/dangle, dnu/dangle), for
+			 * either launch angle.  Every term uses that angle's derivatives; the
+			 * original results() took the group-speed terms of the phi block from
+			 * the theta variables.
 			 */
-			double mag_nu(  double r1, double r2, double r3, double nu1, double nu2, double nu3,
-					double c0, double c0_0, double u, double v, double w ) const;
-			double cg1( 	double r1, double r2, double r3, double nu1, double nu2, double nu3,
-					double c0, double c0_0, double u, double v, double w ) const;
-			double cg2( 	double r1, double r2, double r3, double nu1, double nu2, double nu3,
-					double c0, double c0_0, double u, double v, double w ) const;
-			double cg3( 	double r1, double r2, double r3, double nu1, double nu2, double nu3,
-					double c0, double c0_0, double u, double v, double w ) const;
-			double cg_mag(  double r1, double r2, double r3, double nu1, double nu2, double nu3,
-					double c0, double c0_0, double u, double v, double w ) const;
-			double dc_angle( double r1, double r2, double r3, double dr1_angle, double dr2_angle, double dr3_angle,
-					 double dc0dx, double dc0dy, double dc0dz ) const;
-			double du_angle( double r1, double r2, double r3, double dr1_angle, double dr2_angle, double dr3_angle,
-					 double dudx, double dudy, double dudz ) const;
-			double dv_angle( double r1, double r2, double r3, double dr1_angle, double dr2_angle, double dr3_angle,
-					 double dvdx, double dvdy, double dvdz ) const;
-			double dw_angle( double r1, double r2, double r3, double dr1_angle, double dr2_angle, double dr3_angle,
-					 double dwdx, double dwdy, double dwdz ) const;
-			double dCg_angle( double r1, double r2, double r3, double nu1, double nu2, double nu3,
-					double dr1_angle, double dr2_angle, double dr3_angle, 
-					double dnu1_angle, double dnu2_angle, double dnu3_angle,
-					double c0, double c0_0, double u, double v, double w,
-					double dc0dx, double dc0dy, double dc0dz,
-					double dudx, double dudy, double dudz,
-					double dvdx, double dvdy, double dvdz,
-					double dwdx, double dwdy, double dwdz ) const;
+			void angleDerivatives( const AtmosphereState &state, const RayInvariants &inv,
+				const double *nu, const double *dr, const double *dnu, double *out ) const;
 
 	};
 }
@@ -0,0 +1,24 @@
+#include "Acoustic3DGeometryEquationSet.h"
+#include <stdexcept>
+
+NCPA::Acoustic3DGeometryEquationSet::Acoustic3DGeometryEquationSet( NCPA::AtmosphericSpecification *p,
+		double takeoffangle, double propagation_azimuth, bool rangeDependent )
+	: Acoustic3DEquationSet( p, takeoffangle, propagation_azimuth, rangeDependent ) { }
+
+int NCPA::Acoustic3DGeometryEquationSet::numberOfEquations() const { return 6; }
+
+void NCPA::Acoustic3DGeometryEquationSet::results( double, double *current_values, double *new_values ) {
+	evaluateRHS< false >( current_values, new_values );
+}
+
+double NCPA::Acoustic3DGeometryEquationSet::calculateAmplitude( double **, int ) const {
+	throw std::runtime_error( "Amplitudes are not available from a geometry-only ray trace!" );
+}
+
+double NCPA::Acoustic3DGeometryEquationSet::transmissionLoss( double **, int, double & ) const {
+	throw std::runtime_error( "Transmission loss is not available from a geometry-only ray trace!" );
+}
+
+double NCPA::Acoustic3DGeometryEquationSet::Jacobian( double **, int ) const {
+	throw std::runtime_error( "The Jacobian is not available from a geometry-only ray trace!" );
+}
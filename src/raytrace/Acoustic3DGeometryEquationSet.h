@@ -0,0 +1,33 @@
+#ifndef __ACOUSTIC3DGEOMETRYEQUATIONSET_H__
+#define __ACOUSTIC3DGEOMETRYEQUATIONSET_H__
+
+#include "AtmosphericSpecification.h"
+#include "Acoustic3DEquationSet.h"
+
+namespace NCPA {
+
+	/**
+	 * The kinematic part of Acoustic3DEquationSet: position and slowness only
+	 * (6 equations instead of 18).  Without the theta and phi auxiliary
+	 * variables there is no Jacobian, so amplitudes and transmission loss are
+	 * unavailable; travel time and arrival azimuth work as before.  Intended
+	 * for fan scans and travel-time tables where only ray geometry matters.
+	 */
+	class Acoustic3DGeometryEquationSet : public Acoustic3DEquationSet {
+
+		public:
+			Acoustic3DGeometryEquationSet( AtmosphericSpecification *spec,
+				double takeoffAngle, double propagation_azimuth,
+				bool rangeDependent = true );
+			void results( double t, double *current_values, double *new_values );
+			int numberOfEquations() const;
+
+			// These throw std::runtime_error, as the auxiliary equations they
+			// rely on aren't integrated
+			double calculateAmplitude( double **solution, int steps ) const;
+			double transmissionLoss( double **solution, int k, double &refRange ) const;
+			double Jacobian( double **solution, int steps ) const;
+	};
+}
+
+#endif
@@ -0,0 +1,241 @@
+#include "ArrivalTable.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <stdint.h>
+
+
+NCPA::ArrivalTable::ArrivalTable() {
+	zsrc_ = 0.0;
+	az0_ = 0.0;
+	daz_ = 1.0;
+	elev0_ = 0.0;
+	delev_ = 1.0;
+	naz_ = 0;
+	nelev_ = 0;
+	nbounce_ = 0;
+	fullCircle_ = false;
+}
+
+NCPA::ArrivalTable::ArrivalTable( double sourceHeight, double az0, double daz, unsigned int naz,
+		double elev0, double delev, unsigned int nelev ) {
+	if (naz == 0 || nelev == 0) {
+		throw std::invalid_argument( "Arrival table must hold at least one ray!" );
+	}
+	zsrc_ = sourceHeight;
+	az0_ = az0;
+	daz_ = (naz > 1 ? daz : 1.0);
+	naz_ = naz;
+	elev0_ = elev0;
+	delev_ = (nelev > 1 ? delev : 1.0);
+	nelev_ = nelev;
+	nbounce_ = 0;
+	fullCircle_ = (naz > 1) && (naz * daz_ >= 360.0 - 1.0e-6);
+}
+
+NCPA::ArrivalTable::ArrivalTable( const std::string &filename ) {
+	std::ifstream in( filename.c_str(), std::ios_base::in | std::ios_base::binary );
+	if (!in.good()) {
+		throw std::runtime_error( "Could not open arrival table " + filename );
+	}
+
+	char magic[ 8 ];
+	uint32_t version, naz, nelev, nbounce;
+	in.read( magic, 8 );
+	in.read( (char *)&version, sizeof(uint32_t) );
+	if (!in.good() || std::strncmp( magic, "NCPAARRV", 8 ) != 0 || version != 1) {
+		throw std::runtime_error( filename + " is not a version 1 arrival table!" );
+	}
+	in.read( (char *)&zsrc_, sizeof(double) );
+	in.read( (char *)&az0_, sizeof(double) );
+	in.read( (char *)&daz_, sizeof(double) );
+	in.read( (char *)&naz, sizeof(uint32_t) );
+	in.read( (char *)&elev0_, sizeof(double) );
+	in.read( (char *)&delev_, sizeof(double) );
+	in.read( (char *)&nelev, sizeof(uint32_t) );
+	in.read( (char *)&nbounce, sizeof(uint32_t) );
+	naz_ = naz;
+	nelev_ = nelev;
+	nbounce_ = nbounce;
+	fullCircle_ = (naz_ > 1) && (naz_ * daz_ >= 360.0 - 1.0e-6);
+
+	entries_.resize( naz_ * nelev_ * nbounce_ );
+	if (!entries_.empty()) {
+		in.read( (char *)&(entries_[ 0 ]), entries_.size() * sizeof(ArrivalEntry) );
+	}
+	if (!in.good()) {
+		throw std::runtime_error( "Arrival table " + filename + " is truncated!" );
+	}
+	in.close();
+}
+
+void NCPA::ArrivalTable::resizeBounces_( unsigned int nbounce ) {
+	ArrivalEntry missing = { -1.0f, 0.0f, 0.0f, 0.0f };
+	std::vector< ArrivalEntry > resized( naz_ * nelev_ * nbounce, missing );
+	for (unsigned int ray = 0; ray < naz_ * nelev_; ray++) {
+		for (unsigned int b = 0; b < nbounce_; b++) {
+			resized[ ray * nbounce + b ] = entries_[ ray * nbounce_ + b ];
+		}
+	}
+	entries_.swap( resized );
+	nbounce_ = nbounce;
+}
+
+void NCPA::ArrivalTable::set( unsigned int azind, unsigned int elevind, unsigned int bounce,
+		const ArrivalEntry &entry ) {
+	if (azind >= naz_ || elevind >= nelev_ || bounce == 0) {
+		throw std::out_of_range( "Arrival table index out of range!" );
+	}
+	if (bounce > nbounce_) {
+		resizeBounces_( bounce );
+	}
+	entries_[ (azind * nelev_ + elevind) * nbounce_ + bounce - 1 ] = entry;
+}
+
+const NCPA::ArrivalEntry &NCPA::ArrivalTable::get( unsigned int azind, unsigned int elevind,
+		unsigned int bounce ) const {
+	return entries_[ (azind * nelev_ + elevind) * nbounce_ + bounce - 1 ];
+}
+
+void NCPA::ArrivalTable::write( const std::string &filename ) const {
+	std::ofstream out( filename.c_str(), std::ios_base::out | std::ios_base::binary );
+	if (!out.good()) {
+		throw std::runtime_error( "Could not open arrival table " + filename );
+	}
+
+	uint32_t version = 1, naz = naz_, nelev = nelev_, nbounce = nbounce_;
+	out.write( "NCPAARRV", 8 );
+	out.write( (const char *)&version, sizeof(uint32_t) );
+	out.write( (const char *)&zsrc_, sizeof(double) );
+	out.write( (const char *)&az0_, sizeof(double) );
+	out.write( (const char *)&daz_, sizeof(double) );
+	out.write( (const char *)&naz, sizeof(uint32_t) );
+	out.write( (const char *)&elev0_, sizeof(double) );
+	out.write( (const char *)&delev_, sizeof(double) );
+	out.write( (const char *)&nelev, sizeof(uint32_t) );
+	out.write( (const char *)&nbounce, sizeof(uint32_t) );
+	if (!entries_.empty()) {
+		out.write( (const char *)&(entries_[ 0 ]), entries_.size() * sizeof(ArrivalEntry) );
+	}
+	if (!out.good()) {
+		throw std::runtime_error( "Error writing arrival table " + filename );
+	}
+	out.close();
+}
+
+// Appends the estimates for one azimuth of the fan, bounce by bounce in order
+// of increasing elevation.  Each bracketing pair of neighbouring rays on the
+// same bounce gives one estimate.
+void NCPA::ArrivalTable::crossings_( unsigned int azind, double range,
+		std::vector< Eigenray > &rays ) const {
+	for (unsigned int b = 1; b <= nbounce_; b++) {
+		for (unsigned int j = 0; j+1 < nelev_; j++) {
+			const ArrivalEntry &e0 = get( azind, j, b ), &e1 = get( azind, j+1, b );
+			if (e0.range < 0.0f || e1.range < 0.0f) {
+				continue;
+			}
+			double r0 = e0.range, r1 = e1.range;
+			if (!((r0 <= range && range < r1) || (r1 <= range && range < r0))) {
+				continue;
+			}
+			double t = (range - r0) / (r1 - r0);
+			Eigenray ray;
+			ray.bounce = b;
+			ray.azimuth = az0_ + azind * daz_;
+			ray.elevation = elev0_ + (j + t) * delev_;
+			ray.time = e0.time + t * (e1.time - e0.time);
+			ray.deviation = e0.deviation + t * (e1.deviation - e0.deviation);
+			ray.turningHeight = e0.turningHeight + t * (e1.turningHeight - e0.turningHeight);
+			rays.push_back( ray );
+		}
+	}
+}
+
+unsigned int NCPA::ArrivalTable::query( double range, double azimuth,
+		std::vector< Eigenray > &rays ) const {
+
+	// Locate the receiver between two azimuths of the fan
+	double offset = std::fmod( azimuth - az0_, 360.0 );
+	if (offset < 0.0) {
+		offset += 360.0;
+	}
+	double u = offset / daz_;
+	unsigned int i0, i1;
+	double w;
+	if (fullCircle_) {
+		i0 = ((unsigned int)std::floor( u )) % naz_;
+		i1 = (i0 + 1) % naz_;
+		w = u - std::floor( u );
+	} else {
+		double last = naz_ - 1.0;
+		if (u > last + 1.0e-6) {
+			return 0;
+		}
+		i0 = (u >= last ? (naz_ > 1 ? naz_ - 2 : 0) : (unsigned int)std::floor( u ));
+		i1 = (naz_ > 1 ? i0 + 1 : 0);
+		w = (naz_ > 1 ? u - i0 : 0.0);
+	}
+
+	std::vector< Eigenray > lower, upper;
+	crossings_( i0, range, lower );
+	if (i1 != i0 && w > 0.0) {
+		crossings_( i1, range, upper );
+	}
+
+	// Estimates on the two azimuths are matched bounce by bounce, in order of
+	// elevation.  Where the branches don't match up (a caustic or shadow edge
+	// between the azimuths), the nearer azimuth's estimates are used as-is.
+	unsigned int found = 0, a = 0, c = 0;
+	for (unsigned int b = 1; b <= nbounce_; b++) {
+		unsigned int na = a, nc = c;
+		while (na < lower.size() && lower[ na ].bounce == b) {
+			na++;
+		}
+		while (nc < upper.size() && upper[ nc ].bounce == b) {
+			nc++;
+		}
+
+		if (w > 0.0 && (na - a) == (nc - c)) {
+			for (unsigned int m = 0; m < na - a; m++) {
+				const Eigenray &lo = lower[ a+m ], &hi = upper[ c+m ];
+				Eigenray ray = lo;
+				ray.elevation = lo.elevation + w * (hi.elevation - lo.elevation);
+				ray.time = lo.time + w * (hi.time - lo.time);
+				ray.deviation = lo.deviation + w * (hi.deviation - lo.deviation);
+				ray.turningHeight = lo.turningHeight + w * (hi.turningHeight - lo.turningHeight);
+				ray.azimuth = azimuth;
+				rays.push_back( ray );
+				found++;
+			}
+		} else {
+			const std::vector< Eigenray > &nearer = (w < 0.5 ? lower : upper);
+			unsigned int first = (w < 0.5 ? a : c), end = (w < 0.5 ? na : nc);
+			for (unsigned int m = first; m < end; m++) {
+				Eigenray ray = nearer[ m ];
+				ray.azimuth = azimuth;
+				rays.push_back( ray );
+				found++;
+			}
+		}
+		a = na;
+		c = nc;
+	}
+	return found;
+}
+
+double NCPA::ArrivalTable::sourceHeight() const {
+	return zsrc_;
+}
+
+unsigned int NCPA::ArrivalTable::numberOfAzimuths() const {
+	return naz_;
+}
+
+unsigned int NCPA::ArrivalTable::numberOfElevations() const {
+	return nelev_;
+}
+
+unsigned int NCPA::ArrivalTable::numberOfBounces() const {
+	return nbounce_;
+}
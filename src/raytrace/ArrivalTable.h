@@ -0,0 +1,98 @@
+/**
+  * Precomputed ground arrivals for a fan of rays, and interpolated eigenray
+  * estimates drawn from them.
+  *
+  * The fan is a regular azimuth x elevation grid traced once for a single
+  * atmosphere and source height.  Each ray contributes one entry per bounce,
+  * so a receiver at (range, azimuth) is reached wherever the arrival range
+  * of a bounce crosses the receiver range between neighbouring elevations.
+  *
+  * The binary format holds the whole table, in native byte order:
+  *   char[8]   "NCPAARRV"
+  *   uint32    format version (1)
+  *   float64   source height, km
+  *   float64   first azimuth, azimuth step, degrees
+  *   uint32    number of azimuths
+  *   float64   first elevation, elevation step, degrees
+  *   uint32    number of elevations
+  *   uint32    number of bounces
+  * followed by naz x nelev x nbounce entries (bounce varying fastest), each
+  *   float32   range (km), travel time (s), back azimuth deviation (deg),
+  *             turning height (km)
+  * Bounces a ray did not reach have a negative range.
+  */
+
+#ifndef __ARRIVALTABLE_H__
+#define __ARRIVALTABLE_H__
+
+#include <string>
+#include <vector>
+
+namespace NCPA {
+
+	struct ArrivalEntry {
+		float range, time, deviation, turningHeight;
+	};
+
+	/**
+	  * One eigenray estimate for a receiver: the launch angles that reach it,
+	  * and the arrival quantities interpolated between the bracketing rays.
+	  */
+	struct Eigenray {
+		unsigned int bounce;
+		double azimuth, elevation, time, deviation, turningHeight;
+	};
+
+	class ArrivalTable {
+
+		public:
+			ArrivalTable();
+
+			/**
+			  * Sets up an empty table for the given fan.  Bounces are added as
+			  * rays report them.
+			  */
+			ArrivalTable( double sourceHeight, double az0, double daz, unsigned int naz,
+				double elev0, double delev, unsigned int nelev );
+
+			// Reads a table written by write()
+			ArrivalTable( const std::string &filename );
+
+			/**
+			  * Records the arrival of ray (azind, elevind) at bounce number bounce,
+			  * counted from 1.
+			  */
+			void set( unsigned int azind, unsigned int elevind, unsigned int bounce,
+				const ArrivalEntry &entry );
+			const ArrivalEntry &get( unsigned int azind, unsigned int elevind,
+				unsigned int bounce ) const;
+
+			void write( const std::string &filename ) const;
+
+			/**
+			  * Finds every eigenray estimate for a receiver at the given range
+			  * (km) and azimuth (degrees), appending them to rays.  The receiver
+			  * azimuth is taken as the launch azimuth, i.e. lateral deflection of
+			  * the ray by crosswinds is neglected.  Receivers outside the azimuth
+			  * fan produce no estimates.
+			  * @return The number of estimates found
+			  */
+			unsigned int query( double range, double azimuth, std::vector< Eigenray > &rays ) const;
+
+			double sourceHeight() const;
+			unsigned int numberOfAzimuths() const;
+			unsigned int numberOfElevations() const;
+			unsigned int numberOfBounces() const;
+
+		protected:
+			double zsrc_, az0_, daz_, elev0_, delev_;
+			unsigned int naz_, nelev_, nbounce_;
+			bool fullCircle_;
+			std::vector< ArrivalEntry > entries_;
+
+			void resizeBounces_( unsigned int nbounce );
+			void crossings_( unsigned int azind, double range, std::vector< Eigenray > &rays ) const;
+	};
+}
+
+#endif  // #ifndef __ARRIVALTABLE_H__
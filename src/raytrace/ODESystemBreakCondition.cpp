@@ -1,5 +1,7 @@
 #include "ODESystemBreakCondition.h"
 #include <iostream>
+#include <cmath>
+#include <stdexcept>
 
 NCPA::ODESystemBreakCondition::~ODESystemBreakCondition() {}
 
@@ -9,4 +11,57 @@ void NCPA::ODESystemBreakCondition::printMessage() const {
 	}
 }
 
+void NCPA::ODESystemBreakCondition::interpolateStep( const double *y0, const double *dy0, 
+		const double *y1, const double *dy1, int n, double h, double tau, double *y ) {
+	double tau2 = tau * tau, tau3 = tau2 * tau;
+	double h00 = 2.0*tau3 - 3.0*tau2 + 1.0;
+	double h10 = (tau3 - 2.0*tau2 + tau) * h;
+	double h01 = 3.0*tau2 - 2.0*tau3;
+	double h11 = (tau3 - tau2) * h;
+	for (int i = 0; i < n; i++) {
+		y[ i ] = h00*y0[ i ] + h10*dy0[ i ] + h01*y1[ i ] + h11*dy1[ i ];
+	}
+}
+
+double NCPA::ODESystemBreakCondition::eventFunction( const double * ) const {
+	throw std::logic_error( "No event function has been defined for this break condition!" );
+}
 
+double NCPA::ODESystemBreakCondition::locateEvent( const double *y0, const double *dy0, 
+		const double *y1, const double *dy1, int n, double h, double *y ) const {
+
+	// Illinois variant of false position: the retained end is halved in weight
+	// whenever it is kept twice, so convergence stays superlinear
+	double ta = 0.0, tb = 1.0;
+	double ga = eventFunction( y0 ), gb = eventFunction( y1 );
+	double t = 1.0;
+	int side = 0;
+	for (int iter = 0; iter < 50; iter++) {
+		if (ga == gb) {
+			break;
+		}
+		t = (ta * gb - tb * ga) / (gb - ga);
+		interpolateStep( y0, dy0, y1, dy1, n, h, t, y );
+		double g = eventFunction( y );
+		if (std::fabs( g ) < 1.0e-12 || (tb - ta) < 1.0e-12) {
+			return t;
+		}
+		if ((g > 0.0) == (ga > 0.0)) {
+			ta = t;
+			ga = g;
+			if (side == -1) {
+				gb /= 2.0;
+			}
+			side = -1;
+		} else {
+			tb = t;
+			gb = g;
+			if (side == 1) {
+				ga /= 2.0;
+			}
+			side = 1;
+		}
+	}
+	interpolateStep( y0, dy0, y1, dy1, n, h, t, y );
+	return t;
+}
@@ -13,6 +13,26 @@ namespace NCPA {
 			virtual ~ODESystemBreakCondition();
                         virtual bool shouldBreak( double **solution, int currentIteration ) = 0;
 			void printMessage() const;
+
+		protected:
+			// Cubic Hermite interpolation across one solver step of length h, from the
+			// n values y0, y1 and derivatives dy0, dy1 at either end.  tau runs from
+			// 0 at y0 to 1 at y1.  The interpolant is fourth-order accurate, matching RK4.
+			static void interpolateStep( const double *y0, const double *dy0, 
+				const double *y1, const double *dy1, int n, double h, double tau, 
+				double *y );
+
+			// Finds where eventFunction() changes sign within one solver step, by
+			// false position on the Hermite interpolant, and leaves the interpolated
+			// state there in y.  eventFunction() must have opposite signs at y0 and y1.
+			// @return The fraction of the step, in [0,1], at which the event falls
+			double locateEvent( const double *y0, const double *dy0, 
+				const double *y1, const double *dy1, int n, double h, 
+				double *y ) const;
+
+			// The function whose root locateEvent() finds.  Conditions that use
+			// locateEvent() must override this.
+			virtual double eventFunction( const double *state ) const;
         };
 }
 
@@ -0,0 +1,303 @@
+#include "RaySink.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+
+
+NCPA::RayRecord::RayRecord( unsigned int ncols ) {
+	azimuth = 0.0;
+	elevation = 0.0;
+	columns.resize( ncols );
+}
+
+void NCPA::RayRecord::reset( double az, double elev ) {
+	azimuth = az;
+	elevation = elev;
+	summaryKeys.clear();
+	summaryValues.clear();
+	for (unsigned int i = 0; i < columns.size(); i++) {
+		columns[ i ].clear();
+	}
+}
+
+void NCPA::RayRecord::addSummary( const std::string &key, double value ) {
+	summaryKeys.push_back( key );
+	summaryValues.push_back( value );
+}
+
+void NCPA::RayRecord::addPoint( const double *values ) {
+	for (unsigned int i = 0; i < columns.size(); i++) {
+		columns[ i ].push_back( values[ i ] );
+	}
+}
+
+void NCPA::RayRecord::truncate( unsigned int npts ) {
+	if (npts >= size()) {
+		return;
+	}
+	for (unsigned int i = 0; i < columns.size(); i++) {
+		columns[ i ].resize( npts );
+	}
+}
+
+unsigned int NCPA::RayRecord::size() const {
+	return columns.empty() ? 0 : columns[ 0 ].size();
+}
+
+unsigned int NCPA::RayRecord::numberOfColumns() const {
+	return columns.size();
+}
+
+
+
+NCPA::RayRecordPool::RayRecordPool( unsigned int nrecords, unsigned int ncols ) {
+	if (nrecords == 0) {
+		throw std::invalid_argument( "Ray record pool must hold at least one record!" );
+	}
+	for (unsigned int i = 0; i < nrecords; i++) {
+		all_.push_back( new RayRecord( ncols ) );
+	}
+	free_ = all_;
+	pthread_mutex_init( &lock_, NULL );
+	pthread_cond_init( &available_, NULL );
+}
+
+NCPA::RayRecordPool::~RayRecordPool() {
+	for (unsigned int i = 0; i < all_.size(); i++) {
+		delete all_[ i ];
+	}
+	pthread_cond_destroy( &available_ );
+	pthread_mutex_destroy( &lock_ );
+}
+
+NCPA::RayRecord *NCPA::RayRecordPool::acquire() {
+	pthread_mutex_lock( &lock_ );
+	while (free_.empty()) {
+		pthread_cond_wait( &available_, &lock_ );
+	}
+	RayRecord *record = free_.back();
+	free_.pop_back();
+	pthread_mutex_unlock( &lock_ );
+	return record;
+}
+
+void NCPA::RayRecordPool::release( RayRecord *record ) {
+	pthread_mutex_lock( &lock_ );
+	free_.push_back( record );
+	pthread_cond_signal( &available_ );
+	pthread_mutex_unlock( &lock_ );
+}
+
+
+
+NCPA::RaySink::RaySink( RayRecordPool *pool ) {
+	pool_ = pool;
+}
+
+NCPA::RaySink::~RaySink() { }
+
+void NCPA::RaySink::submit( RayRecord *ray ) {
+	try {
+		writeRay( *ray );
+	} catch (...) {
+		pool_->release( ray );
+		throw;
+	}
+	pool_->release( ray );
+}
+
+void NCPA::RaySink::close() { }
+
+
+
+NCPA::TextRaySink::TextRaySink( RayRecordPool *pool ) : RaySink( pool ) { }
+
+void NCPA::TextRaySink::writeRay( const RayRecord &ray ) {
+	char pathfile[4096];
+	sprintf( pathfile, "raypath_az%06.2f_elev%06.2f.txt", ray.azimuth, ray.elevation );
+	std::ofstream raypath( pathfile, std::ios_base::out );
+	if (!raypath.good()) {
+		throw std::runtime_error( std::string( "Could not open raypath file " ) + pathfile );
+	}
+
+	for (unsigned int i = 0; i < ray.summaryKeys.size(); i++) {
+		raypath << "# " << ray.summaryKeys[ i ] << ": " << ray.summaryValues[ i ] << std::endl;
+	}
+
+	unsigned int npts = ray.size(), ncols = ray.numberOfColumns();
+	for (unsigned int i = 0; i < npts; i++) {
+		raypath << ray.columns[ 0 ][ i ];
+		for (unsigned int j = 1; j < ncols; j++) {
+			raypath << "   " << ray.columns[ j ][ i ];
+		}
+		raypath << std::endl;
+	}
+	raypath << std::endl;
+	raypath.close();
+}
+
+
+
+NCPA::BinaryRaySink::BinaryRaySink( RayRecordPool *pool, const std::string &filename,
+		const std::vector< std::string > &columnNames ) : RaySink( pool ) {
+	out_.open( filename.c_str(), std::ios_base::out | std::ios_base::binary );
+	if (!out_.good()) {
+		throw std::runtime_error( "Could not open binary ray file " + filename );
+	}
+
+	uint32_t version = 1, ncols = columnNames.size();
+	out_.write( "NCPARAYS", 8 );
+	out_.write( (const char *)&version, sizeof(uint32_t) );
+	out_.write( (const char *)&ncols, sizeof(uint32_t) );
+	for (unsigned int i = 0; i < ncols; i++) {
+		out_.write( columnNames[ i ].c_str(), columnNames[ i ].size() + 1 );
+	}
+}
+
+NCPA::BinaryRaySink::~BinaryRaySink() {
+	if (out_.is_open()) {
+		out_.close();
+	}
+}
+
+void NCPA::BinaryRaySink::close() {
+	if (out_.is_open()) {
+		out_.close();
+	}
+}
+
+void NCPA::BinaryRaySink::writeRay( const RayRecord &ray ) {
+	uint32_t nsummary = ray.summaryKeys.size(), npts = ray.size();
+
+	out_.write( (const char *)&ray.azimuth, sizeof(double) );
+	out_.write( (const char *)&ray.elevation, sizeof(double) );
+	out_.write( (const char *)&nsummary, sizeof(uint32_t) );
+	for (unsigned int i = 0; i < nsummary; i++) {
+		out_.write( ray.summaryKeys[ i ].c_str(), ray.summaryKeys[ i ].size() + 1 );
+		out_.write( (const char *)&(ray.summaryValues[ i ]), sizeof(double) );
+	}
+	out_.write( (const char *)&npts, sizeof(uint32_t) );
+
+	scratch_.resize( npts );
+	for (unsigned int j = 0; j < ray.numberOfColumns(); j++) {
+		for (unsigned int i = 0; i < npts; i++) {
+			scratch_[ i ] = (float)ray.columns[ j ][ i ];
+		}
+		if (npts > 0) {
+			out_.write( (const char *)&(scratch_[ 0 ]), npts * sizeof(float) );
+		}
+	}
+
+	if (!out_.good()) {
+		throw std::runtime_error( "Error writing to binary ray file!" );
+	}
+}
+
+
+
+NCPA::AsyncRaySink::AsyncRaySink( RaySink *sink ) : RaySink( 0 ) {
+	sink_ = sink;
+	closing_ = false;
+	error_ = "";
+	pthread_mutex_init( &lock_, NULL );
+	pthread_cond_init( &ready_, NULL );
+	running_ = (pthread_create( &thread_, NULL, NCPA::AsyncRaySink::run_, this ) == 0);
+	if (!running_) {
+		throw std::runtime_error( "Could not start ray output thread!" );
+	}
+}
+
+NCPA::AsyncRaySink::~AsyncRaySink() {
+	try {
+		close();
+	} catch (...) { }
+	delete sink_;
+	pthread_cond_destroy( &ready_ );
+	pthread_mutex_destroy( &lock_ );
+}
+
+void NCPA::AsyncRaySink::submit( RayRecord *ray ) {
+	pthread_mutex_lock( &lock_ );
+	queue_.push_back( ray );
+	pthread_cond_signal( &ready_ );
+	pthread_mutex_unlock( &lock_ );
+	checkError_();
+}
+
+void NCPA::AsyncRaySink::close() {
+	if (running_) {
+		pthread_mutex_lock( &lock_ );
+		closing_ = true;
+		pthread_cond_signal( &ready_ );
+		pthread_mutex_unlock( &lock_ );
+		pthread_join( thread_, NULL );
+		running_ = false;
+		sink_->close();
+	}
+	checkError_();
+}
+
+void NCPA::AsyncRaySink::writeRay( const RayRecord & ) { }
+
+void NCPA::AsyncRaySink::checkError_() {
+	pthread_mutex_lock( &lock_ );
+	std::string err = error_;
+	error_ = "";
+	pthread_mutex_unlock( &lock_ );
+	if (err.size() > 0) {
+		throw std::runtime_error( err );
+	}
+}
+
+void *NCPA::AsyncRaySink::run_( void *self ) {
+	AsyncRaySink *me = (AsyncRaySink *)self;
+	while (true) {
+		pthread_mutex_lock( &(me->lock_) );
+		while (me->queue_.empty() && !me->closing_) {
+			pthread_cond_wait( &(me->ready_), &(me->lock_) );
+		}
+		if (me->queue_.empty()) {
+			pthread_mutex_unlock( &(me->lock_) );
+			break;
+		}
+		RayRecord *ray = me->queue_.front();
+		me->queue_.pop_front();
+		pthread_mutex_unlock( &(me->lock_) );
+
+		// The wrapped sink returns the record to the pool whether or not the
+		// write succeeds, so the solver can't stall on a lost record
+		try {
+			me->sink_->submit( ray );
+		} catch (std::exception &e) {
+			pthread_mutex_lock( &(me->lock_) );
+			if (me->error_.size() == 0) {
+				me->error_ = e.what();
+			}
+			pthread_mutex_unlock( &(me->lock_) );
+		}
+	}
+	return NULL;
+}
+
+
+
+NCPA::RaySink *NCPA::createRaySink( RayOutputFormat format, RayRecordPool *pool,
+		const std::string &binaryFile, const std::vector< std::string > &columnNames,
+		bool async ) {
+	RaySink *sink;
+	if (format == RAYBINARY) {
+		sink = new BinaryRaySink( pool, binaryFile, columnNames );
+	} else {
+		sink = new TextRaySink( pool );
+	}
+	if (async) {
+		try {
+			sink = new AsyncRaySink( sink );
+		} catch (...) {
+			delete sink;
+			throw;
+		}
+	}
+	return sink;
+}
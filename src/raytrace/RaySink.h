@@ -0,0 +1,168 @@
+/**
+  * Ray output records, a recycling pool for them, and the sinks that write
+  * them to disk.
+  *
+  * The binary format (RAYBINARY) holds a whole fan in one file, in native
+  * byte order:
+  *   char[8]   "NCPARAYS"
+  *   uint32    format version (1)
+  *   uint32    ncols
+  *   ncols x   null-terminated column name
+  * followed by one record per ray:
+  *   float64   launch azimuth, degrees
+  *   float64   launch elevation, degrees
+  *   uint32    nsummary
+  *   nsummary x (null-terminated key, float64 value)
+  *   uint32    npts
+  *   ncols x   npts float32 values, one column after another
+  */
+
+#ifndef __RAYSINK_H__
+#define __RAYSINK_H__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <pthread.h>
+
+namespace NCPA {
+
+	enum RayOutputFormat { RAYTEXT, RAYBINARY };
+
+	/**
+	  * One ray's summary quantities and (possibly decimated) path, stored one
+	  * column per output variable.  Records are reused from a RayRecordPool,
+	  * so clearing one keeps its storage.
+	  */
+	class RayRecord {
+
+		public:
+			RayRecord( unsigned int ncols );
+
+			// Empties the record for a new ray without releasing storage
+			void reset( double azimuth, double elevation );
+			void addSummary( const std::string &key, double value );
+			void addPoint( const double *values );
+
+			// Drops points past the first npts
+			void truncate( unsigned int npts );
+			unsigned int size() const;
+			unsigned int numberOfColumns() const;
+
+			double azimuth, elevation;
+			std::vector< std::string > summaryKeys;
+			std::vector< double > summaryValues;
+			std::vector< std::vector< double > > columns;
+	};
+
+	/**
+	  * A fixed set of RayRecords handed out and returned by the solver and the
+	  * writer.  acquire() waits while every record is in use, so the memory
+	  * held by queued output never exceeds the pool size.
+	  */
+	class RayRecordPool {
+
+		public:
+			RayRecordPool( unsigned int nrecords, unsigned int ncols );
+			~RayRecordPool();
+
+			RayRecord *acquire();
+			void release( RayRecord *record );
+
+		protected:
+			std::vector< RayRecord * > all_, free_;
+			pthread_mutex_t lock_;
+			pthread_cond_t available_;
+	};
+
+	/**
+	  * Base class for ray output.  submit() writes the ray and returns its
+	  * record to the pool.
+	  */
+	class RaySink {
+
+		public:
+			RaySink( RayRecordPool *pool );
+			virtual ~RaySink();
+
+			virtual void submit( RayRecord *ray );
+
+			// Waits for all submitted rays to be written
+			virtual void close();
+
+		protected:
+			RayRecordPool *pool_;
+			virtual void writeRay( const RayRecord &ray ) = 0;
+	};
+
+	/**
+	  * Writes each ray to its own raypath_az[azimuth]_elev[elevation].txt file
+	  * with a commented summary header, as raytrace.2d/3d always have.
+	  */
+	class TextRaySink : public RaySink {
+
+		public:
+			TextRaySink( RayRecordPool *pool );
+
+		protected:
+			void writeRay( const RayRecord &ray );
+	};
+
+	/**
+	  * Appends every ray to a single binary file, in the format described at
+	  * the top of this header.
+	  */
+	class BinaryRaySink : public RaySink {
+
+		public:
+			BinaryRaySink( RayRecordPool *pool, const std::string &filename,
+				const std::vector< std::string > &columnNames );
+			~BinaryRaySink();
+			void close();
+
+		protected:
+			std::ofstream out_;
+			std::vector< float > scratch_;
+			void writeRay( const RayRecord &ray );
+	};
+
+	/**
+	  * Hands rays to another sink on a background thread, so that formatting
+	  * and disk writes overlap with tracing the next ray.  The wrapped sink is
+	  * owned, and deleted, by this one.  Errors raised by the wrapped sink are
+	  * reported by the next submit() or by close().
+	  */
+	class AsyncRaySink : public RaySink {
+
+		public:
+			AsyncRaySink( RaySink *sink );
+			~AsyncRaySink();
+
+			void submit( RayRecord *ray );
+			void close();
+
+		protected:
+			RaySink *sink_;
+			std::deque< RayRecord * > queue_;
+			bool closing_, running_;
+			std::string error_;
+			pthread_t thread_;
+			pthread_mutex_t lock_;
+			pthread_cond_t ready_;
+
+			void writeRay( const RayRecord &ray );
+			void checkError_();
+			static void *run_( void *self );
+	};
+
+	/**
+	  * Builds the sink selected on the command line, wrapped for background
+	  * writing when async is set.  The caller deletes the returned sink.
+	  */
+	RaySink *createRaySink( RayOutputFormat format, RayRecordPool *pool,
+		const std::string &binaryFile, const std::vector< std::string > &columnNames,
+		bool async );
+}
+
+#endif  // #ifndef __RAYSINK_H__
@@ -1,4 +1,5 @@
 #include "ReflectionCondition2D.h"
+#include "Acoustic2DEquationSet.h"
 #include <stdexcept>
 #include <cmath>
 
@@ -10,11 +11,35 @@ NCPA::ReflectionCondition2D::ReflectionCondition2D( NCPA::AtmosphericSpecificati
 	bounces = 0;
 	message = "Maximum number of skips reached.";
 	triggered_ = false;
+	equations_ = 0;
+	stepSize_ = 0.0;
 }
 
 void NCPA::ReflectionCondition2D::reset() {
 	bounces = 0;
 	triggered_ = false;
+	reflectionSteps_.clear();
+	timeDeficits_.clear();
+}
+
+void NCPA::ReflectionCondition2D::setEquations( Acoustic2DEquationSet *equations, double stepSize ) {
+	equations_ = equations;
+	stepSize_ = stepSize;
+}
+
+double NCPA::ReflectionCondition2D::eventFunction( const double *state ) const {
+	double cart_angle = NCPA::deg2rad( 90 - this->propAzimuth );
+	return state[ 1 ] - spec->z0( state[ 0 ] * std::cos( cart_angle ), state[ 0 ] * std::sin( cart_angle ) );
+}
+
+double NCPA::ReflectionCondition2D::travelTimeDeficit( int last ) const {
+	double deficit = 0.0;
+	for (unsigned int i = 0; i < reflectionSteps_.size(); i++) {
+		if (reflectionSteps_[ i ] <= last) {
+			deficit += timeDeficits_[ i ];
+		}
+	}
+	return deficit;
 }
 
 bool NCPA::ReflectionCondition2D::triggered() const {
@@ -32,10 +57,30 @@ bool NCPA::ReflectionCondition2D::shouldBreak(double** solution, int k) {
 			std::runtime_error e( "Not enough steps yet taken to compute reflection conditions.  This usually means something has gone wrong, because you shouldn't be reflecting yet." );
 			throw e;
 		}
-		double conditions[ 6 ];
-		
-		conditions[0] = solution[k-1][0] + (solution[k][0] - solution[k-1][0])/(solution[k-1][1] - solution[k][1])*(solution[k-1][1] - z0)
+		double conditions[ 6 ], pre[ 6 ];
+		bool located = false;
+
+		// Find the state where the ray meets the ground, just before reflection
+		if (equations_ != 0 && eventFunction( solution[k-1] ) >= 0.0) {
+			double dy0[ 6 ], dy1[ 6 ];
+			equations_->results( 0.0, solution[k-1], dy0 );
+			equations_->results( 0.0, solution[k], dy1 );
+			double tau = locateEvent( solution[k-1], dy0, solution[k], dy1, 6, stepSize_, pre );
+			located = true;
+			conditions[0] = pre[0];
+			conditions[3] = pre[3];
+			conditions[4] = -pre[4];
+
+			// The reflected ray restarts from the contact point, so the rest of the
+			// step goes untravelled
+			x = pre[0] * std::cos( cart_angle );
+			y = pre[0] * std::sin( cart_angle );
+			reflectionSteps_.push_back( k );
+			timeDeficits_.push_back( (1.0 - tau) * stepSize_ / spec->ceff( x, y, spec->z0( x, y ), propAzimuth ) );
+		} else {
+			conditions[0] = solution[k-1][0] + (solution[k][0] - solution[k-1][0])/(solution[k-1][1] - solution[k][1])*(solution[k-1][1] - z0)
 				+ (solution[k][0] + solution[k-2][0] - 2*solution[k-1][0])/std::pow(solution[k-1][1] - solution[k][1],2.0)*std::pow(solution[k-1][1]-z0,2.0);
+		}
 		
 		// recalculate the incidence angle
 		x = conditions[0] * std::cos( cart_angle );
@@ -47,11 +92,13 @@ bool NCPA::ReflectionCondition2D::shouldBreak(double** solution, int k) {
 		conditions[1] = z0;
 		conditions[2] = std::sin( theta_new ) / ceff0;
 		
-		conditions[3] = solution[k-1][3] + (solution[k][3] - solution[k-1][3])/(solution[k-1][1] - solution[k][1])*(solution[k-1][1] - z0)
-				+ (solution[k][3] + solution[k-2][3] - 2*solution[k-1][3])/std::pow(solution[k-1][1] - solution[k][1],2.0)*std::pow(solution[k-1][1]-z0,2.0);
+		if (!located) {
+			conditions[3] = solution[k-1][3] + (solution[k][3] - solution[k-1][3])/(solution[k-1][1] - solution[k][1])*(solution[k-1][1] - z0)
+					+ (solution[k][3] + solution[k-2][3] - 2*solution[k-1][3])/std::pow(solution[k-1][1] - solution[k][1],2.0)*std::pow(solution[k-1][1]-z0,2.0);
 		
-		conditions[4] = -(solution[k-1][4] + (solution[k][4] - solution[k-1][4])/(solution[k-1][1] - solution[k][1])*(solution[k-1][1] - z0)
-				+ (solution[k][4] + solution[k-2][4] - 2*solution[k-1][4])/std::pow(solution[k-1][1] - solution[k][1],2.0)*std::pow(solution[k-1][1]-z0,2.0));
+			conditions[4] = -(solution[k-1][4] + (solution[k][4] - solution[k-1][4])/(solution[k-1][1] - solution[k][1])*(solution[k-1][1] - z0)
+					+ (solution[k][4] + solution[k-2][4] - 2*solution[k-1][4])/std::pow(solution[k-1][1] - solution[k][1],2.0)*std::pow(solution[k-1][1]-z0,2.0));
+		}
 		
 		conditions[5] = std::cos( theta_new ) / ceff0 - conditions[4] * spec->dceffdz(x,y,z0,propAzimuth) / ceff0 / ceff0 / std::sin( theta_new );
 		
@@ -11,11 +11,13 @@
 #ifndef __REFLECTIONCONDITION2D_H__
 #define __REFLECTIONCONDITION2D_H__
 #include <iostream>
+#include <vector>
 #include "ODESystemBreakCondition.h"
 #include "AtmosphericSpecification.h"
 
 namespace NCPA {
 	
+	class Acoustic2DEquationSet;
 
         class ReflectionCondition2D : public ODESystemBreakCondition {
 
@@ -26,6 +28,17 @@ namespace NCPA {
 			unsigned int bounces, maxbounces;
 			bool triggered_;
 
+			// Set by setEquations() to locate ground contacts within a step
+			Acoustic2DEquationSet *equations_;
+			double stepSize_;
+
+			// Solution steps at which reflections were applied, and the travel time
+			// in the unused part of each of those steps
+			std::vector< int > reflectionSteps_;
+			std::vector< double > timeDeficits_;
+
+			double eventFunction( const double *state ) const;
+
                 public:
                         ReflectionCondition2D( AtmosphericSpecification *atmosphere, double propagationAzimuth, unsigned int maxbounces = 0 );
                         bool shouldBreak( double **solution, int currentIteration );
@@ -34,6 +47,14 @@ namespace NCPA {
 			unsigned int countBounces() const;
 			bool triggered() const;
 			void reset();
+
+			/**
+			  * Locates each ground contact by root-finding on a cubic Hermite
+			  * interpolation of the step that crossed the ground, instead of
+			  * extrapolating from the last three steps.  See ReflectionCondition3D.
+			  */
+			void setEquations( Acoustic2DEquationSet *equations, double stepSize );
+			double travelTimeDeficit( int last ) const;
         };
 
 	
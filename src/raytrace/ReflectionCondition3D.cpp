@@ -8,22 +8,48 @@
  */
 
 #include "ReflectionCondition3D.h"
+#include "Acoustic3DEquationSet.h"
 #include <stdexcept>
 #include <cmath>
 
 
-NCPA::ReflectionCondition3D::ReflectionCondition3D( NCPA::AtmosphericSpecification *s, double az, unsigned int maxb ) {
+NCPA::ReflectionCondition3D::ReflectionCondition3D( NCPA::AtmosphericSpecification *s, double az, unsigned int maxb,
+		bool auxiliary ) {
 	propAzimuth = az;
 	spec = s;
 	maxbounces = maxb;
 	bounces = 0;
 	triggered_ = false;
+	auxiliary_ = auxiliary;
+	equations_ = 0;
+	stepSize_ = 0.0;
 	message = "Maximum number of skips reached.";
 }
 
 void NCPA::ReflectionCondition3D::reset() {
 	bounces = 0;
 	triggered_ = false;
+	reflectionSteps_.clear();
+	timeDeficits_.clear();
+}
+
+void NCPA::ReflectionCondition3D::setEquations( Acoustic3DEquationSet *equations, double stepSize ) {
+	equations_ = equations;
+	stepSize_ = stepSize;
+}
+
+double NCPA::ReflectionCondition3D::eventFunction( const double *state ) const {
+	return state[ 2 ] - spec->z0( state[ 0 ], state[ 1 ] );
+}
+
+double NCPA::ReflectionCondition3D::travelTimeDeficit( int last ) const {
+	double deficit = 0.0;
+	for (unsigned int i = 0; i < reflectionSteps_.size(); i++) {
+		if (reflectionSteps_[ i ] <= last) {
+			deficit += timeDeficits_[ i ];
+		}
+	}
+	return deficit;
 }
 
 bool NCPA::ReflectionCondition3D::triggered() const {
@@ -43,86 +69,84 @@ bool NCPA::ReflectionCondition3D::shouldBreak(double** soln, int k) {
 			throw e;
 		}
 		
-		double conditions[ 18 ];
-		double delta_z = soln[k-1][2] - z0;
+		// Geometry-only systems carry just position and slowness
+		unsigned int nvars = (auxiliary_ ? 18 : 6);
+		double conditions[ 18 ], pre[ 18 ];
+
+		// Find the state where the ray meets the ground, just before reflection
+		if (equations_ != 0 && eventFunction( soln[k-1] ) >= 0.0) {
+			double dy0[ 18 ], dy1[ 18 ];
+			int neqs = equations_->numberOfEquations();
+			equations_->results( 0.0, soln[k-1], dy0 );
+			equations_->results( 0.0, soln[k], dy1 );
+			double tau = locateEvent( soln[k-1], dy0, soln[k], dy1, neqs, stepSize_, pre );
+			z0 = spec->z0( pre[0], pre[1] );
+
+			// The reflected ray restarts from the contact point, so the rest of the
+			// step goes untravelled
+			reflectionSteps_.push_back( k );
+			timeDeficits_.push_back( (1.0 - tau) * stepSize_ / equations_->groupVelocity( pre, 0 ) );
+		} else {
+			// Taylor approximation from the last three steps
+			double delta_z = soln[k-1][2] - z0;
+			for (unsigned int i = 0; i < nvars; i++) {
+				pre[ i ] = soln[k-1][i] 
+					- (soln[k][i] - soln[k-1][i])/(soln[k][2] - soln[k-1][2])*delta_z
+					+ (soln[k][i] + soln[k-2][i] - 2.0*soln[k-1][i])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
+			}
+		}
+
 		double nu1_approx, nu2_approx, nu3_approx, theta_ref, phi_ref;
 		if (spec->stratified()) {
 			nu1_approx = soln[0][3];
 			nu2_approx = soln[0][4];
 			nu3_approx = -soln[0][5];
 		} else {
-			nu1_approx = soln[k-1][3] 
-				- (soln[k][3] - soln[k-1][3])/(soln[k][2] - soln[k-1][2])*delta_z
-				+ (soln[k][3] + soln[k-2][3] - 2.0*soln[k-1][3])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
-			nu2_approx = soln[k-1][4] 
-				- (soln[k][4] - soln[k-1][4])/(soln[k][2] - soln[k-1][2])*delta_z
-				+ (soln[k][4] + soln[k-2][4] - 2.0*soln[k-1][4])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
-			nu3_approx = soln[k-1][5] 
-				- (soln[k][5] - soln[k-1][5])/(soln[k][2] - soln[k-1][2])*delta_z
-				+ (soln[k][5] + soln[k-2][5] - 2.0*soln[k-1][5])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
+			nu1_approx = pre[3];
+			nu2_approx = pre[4];
+			nu3_approx = pre[5];
 		}
 		theta_ref = -std::asin(nu3_approx);
 		phi_ref = std::atan2(nu2_approx,nu1_approx);
 
-		// determine x and y at the reflection point using a Taylor approximation
-		conditions[0] = soln[k-1][0] 
-			- (soln[k][0] - soln[k-1][0])/(soln[k][2] - soln[k-1][2])*delta_z 
-			+ (soln[k][0] + soln[k-2][0] - 2.0*soln[k-1][0])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
-		conditions[1] = soln[k-1][1] 
-			- (soln[k][1] - soln[k-1][1])/(soln[k][2] - soln[k-1][2])*delta_z 
-			+ (soln[k][1] + soln[k-2][1] - 2.0*soln[k-1][1])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
+		// x and y at the reflection point
+		conditions[0] = pre[0];
+		conditions[1] = pre[1];
 		conditions[2] = z0;
-		
-		// dx/dtheta and dy/dtheta are continuous across the reflection, while dz/dtheta is continuous with a sign change
-		conditions[6] = soln[k-1][6] 
-			- (soln[k][6] - soln[k-1][6])/(soln[k][2] - soln[k-1][2])*delta_z
-			+ (soln[k][6] + soln[k-2][6] - 2.0*soln[k-1][6])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
-		conditions[7] = soln[k-1][7] 
-			- (soln[k][7] - soln[k-1][7])/(soln[k][2] - soln[k-1][2])*delta_z
-			+ (soln[k][7] + soln[k-2][7] - 2.0*soln[k-1][7])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
-		conditions[8] = -(
-			soln[k-1][8] 
-			- (soln[k][8] - soln[k-1][8])/(soln[k][2] - soln[k-1][2])*delta_z
-			+ (soln[k][8] + soln[k-2][8] - 2.0*soln[k-1][8])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z
-			);
-
-		// dx/dphi and dy/dphi are continuous across the reflection, while dz/dphi is continuous with a sign change
-		conditions[12] = soln[k-1][12] 
-			- (soln[k][12] - soln[k-1][12])/(soln[k][2] - soln[k-1][2])*delta_z
-			+ (soln[k][12] + soln[k-2][12] - 2.0*soln[k-1][12])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
-		conditions[13] = soln[k-1][13] 
-			- (soln[k][13] - soln[k-1][13])/(soln[k][2] - soln[k-1][2])*delta_z
-			+ (soln[k][13] + soln[k-2][13] - 2.0*soln[k-1][13])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z;
-		conditions[14] = -(
-			soln[k-1][14] 
-			- (soln[k][14] - soln[k-1][14])/(soln[k][2] - soln[k-1][2])*delta_z
-			+ (soln[k][14] + soln[k-2][14] - 2.0*soln[k-1][14])/pow(soln[k][2] - soln[k-1][2],2.0)*delta_z*delta_z
-			);
 
 		// calculate new nu vectors
 		conditions[3] = std::cos(theta_ref)*std::cos(phi_ref);
 		conditions[4] = std::cos(theta_ref)*std::sin(phi_ref);
 		conditions[5] = std::sin(theta_ref);
+
+		if (auxiliary_) {
 		
-		// derivatives of nu components wrt theta.  First, precalculate some atmospheric characteristics
-		double c = spec->c0(conditions[0],conditions[1],conditions[2]);
-		double dcdx = spec->dc0dx(conditions[0],conditions[1],conditions[2]);
-		double dcdy = spec->dc0dy(conditions[0],conditions[1],conditions[2]);
-		double dcdz = spec->dc0dz(conditions[0],conditions[1],conditions[2]);
-		conditions[9] = -std::sin(theta_ref)*std::cos(phi_ref) + dcdx / c * conditions[8]/conditions[5];
-		conditions[10] = -std::sin(theta_ref)*std::sin(phi_ref) + dcdy / c * conditions[8]/conditions[5];
-		conditions[11] = std::cos(theta_ref) - dcdz / c * conditions[8]/conditions[5];
-		
-		// derivatives of nu components wrt phi
-		conditions[15] = -std::cos(theta_ref)*std::sin(phi_ref) + dcdx/c * conditions[14]/conditions[5];
-		conditions[16] = std::cos(theta_ref)*std::cos(phi_ref) + dcdy/c * conditions[14]/conditions[5];
-		conditions[17] = -dcdz/c * conditions[14]/conditions[5];	
-		
-		
-		
+			// dx/dtheta and dy/dtheta are continuous across the reflection, while dz/dtheta is continuous with a sign change
+			conditions[6] = pre[6];
+			conditions[7] = pre[7];
+			conditions[8] = -pre[8];
+
+			// dx/dphi and dy/dphi are continuous across the reflection, while dz/dphi is continuous with a sign change
+			conditions[12] = pre[12];
+			conditions[13] = pre[13];
+			conditions[14] = -pre[14];
+
+			// derivatives of nu components wrt theta.  First, precalculate some atmospheric characteristics
+			double c = spec->c0(conditions[0],conditions[1],conditions[2]);
+			double dcdx = spec->dc0dx(conditions[0],conditions[1],conditions[2]);
+			double dcdy = spec->dc0dy(conditions[0],conditions[1],conditions[2]);
+			double dcdz = spec->dc0dz(conditions[0],conditions[1],conditions[2]);
+			conditions[9] = -std::sin(theta_ref)*std::cos(phi_ref) + dcdx / c * conditions[8]/conditions[5];
+			conditions[10] = -std::sin(theta_ref)*std::sin(phi_ref) + dcdy / c * conditions[8]/conditions[5];
+			conditions[11] = std::cos(theta_ref) - dcdz / c * conditions[8]/conditions[5];
 		
+			// derivatives of nu components wrt phi
+			conditions[15] = -std::cos(theta_ref)*std::sin(phi_ref) + dcdx/c * conditions[14]/conditions[5];
+			conditions[16] = std::cos(theta_ref)*std::cos(phi_ref) + dcdy/c * conditions[14]/conditions[5];
+			conditions[17] = -dcdz/c * conditions[14]/conditions[5];	
+		}
 		
-		for (unsigned int i = 0; i < 18; i++) {
+		for (unsigned int i = 0; i < nvars; i++) {
 			soln[k][i] = conditions[i];
 		}
 		
@@ -9,11 +9,14 @@
 #ifndef __REFLECTIONCONDITION3D_H__
 #define __REFLECTIONCONDITION3D_H__
 #include <iostream>
+#include <vector>
 #include "ODESystemBreakCondition.h"
 #include "AtmosphericSpecification.h"
 
 namespace NCPA {
 
+	class Acoustic3DEquationSet;
+
         class ReflectionCondition3D : public ODESystemBreakCondition {
 
 		protected:
@@ -21,13 +24,44 @@ namespace NCPA {
 			AtmosphericSpecification *spec;
 			unsigned int bounces, maxbounces;
 			bool triggered_;
+			bool auxiliary_;   // reflect the angle derivatives (variables 6-17) as well
+
+			// Set by setEquations() to locate ground contacts within a step
+			Acoustic3DEquationSet *equations_;
+			double stepSize_;
+
+			// Solution steps at which reflections were applied, and the travel time
+			// in the unused part of each of those steps
+			std::vector< int > reflectionSteps_;
+			std::vector< double > timeDeficits_;
+
+			double eventFunction( const double *state ) const;
 
                 public:
-                        ReflectionCondition3D( AtmosphericSpecification *atmosphere, double propagationAzimuth, unsigned int maxbounces = 0 );
+                        ReflectionCondition3D( AtmosphericSpecification *atmosphere, double propagationAzimuth, unsigned int maxbounces = 0,
+				bool auxiliary = true );
                         bool shouldBreak( double **solution, int currentIteration );
 			void setAzimuth( double az );
 			bool triggered() const;
 			void reset();
+
+			/**
+			  * Locates each ground contact by root-finding on a cubic Hermite
+			  * interpolation of the step that crossed the ground, instead of
+			  * extrapolating from the last three steps.  The reflected state is
+			  * placed at the contact point, so the remainder of that step is not
+			  * travelled; see travelTimeDeficit().
+			  * @param equations The equation set being solved
+			  * @param stepSize The solver step size
+			  */
+			void setEquations( Acoustic3DEquationSet *equations, double stepSize );
+
+			/**
+			  * The travel time to subtract from a step-counting travel time
+			  * calculation up to and including step last, for the partial steps
+			  * cut short by located reflections.
+			  */
+			double travelTimeDeficit( int last ) const;
         };
 
 	
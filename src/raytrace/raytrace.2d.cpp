@@ -7,6 +7,7 @@
 #include "ODESystem.h"
 #include "ReflectionCondition2D.h"
 #include "Slice.h"
+#include "RaySink.h"
 
 #include <iostream>
 #include <cmath>
@@ -80,6 +81,9 @@ int main( int argc, char **argv ) {
 	//double lat = 0, lon = 0;
 	unsigned int maxskips = 0;
 	bool inMPS = true;
+	int decimate = 1, outputBuffers = 4;
+	RayOutputFormat outputFormat = RAYTEXT;
+	string binaryFile = "raypaths.2d.bin";
 
 	// Elevation angle parameters
 	if (opt->getValue( "elev" ) != NULL) {
@@ -175,6 +179,33 @@ int main( int argc, char **argv ) {
 			inMPS = false;
 		}
 	}
+
+	// Output options
+	if (opt->getValue( "output_format" ) != NULL) {
+		if (strcmp( opt->getValue( "output_format" ), "binary" ) == 0) {
+			outputFormat = RAYBINARY;
+		} else if (strcmp( opt->getValue( "output_format" ), "text" ) != 0) {
+			delete opt;
+			throw invalid_argument( "Option --output_format must be 'text' or 'binary'!" );
+		}
+	}
+	if (opt->getValue( "binary_file" ) != NULL) {
+		binaryFile = opt->getValue( "binary_file" );
+	}
+	if (opt->getValue( "decimate" ) != NULL) {
+		decimate = atoi( opt->getValue( "decimate" ) );
+		if (decimate < 0) {
+			delete opt;
+			throw invalid_argument( "Option --decimate must be non-negative!" );
+		}
+	}
+	if (opt->getValue( "output_buffers" ) != NULL) {
+		outputBuffers = atoi( opt->getValue( "output_buffers" ) );
+		if (outputBuffers < 0) {
+			delete opt;
+			throw invalid_argument( "Option --output_buffers must be non-negative!" );
+		}
+	}
 	
 	// Process azimuth vector.  Since azimuths can wrap around from 360 to 0, we can't
 	// easily put it into a for loop.
@@ -324,6 +355,7 @@ int main( int argc, char **argv ) {
 	double *initialConditions;
 	int zindex;   // which variable is z?
 	Acoustic2DEquationSet *equations = new Acoustic2DEquationSet( spec, elev0, azimuth0, rangeDependent );
+	bouncer->setEquations( equations, maxraylength / steps );
 	initialConditions = new double[ 6 ];
 	zindex = 1;
 
@@ -336,6 +368,16 @@ int main( int argc, char **argv ) {
                 solution[ i ] = new double[ equations->numberOfEquations() ];
         }
 
+	// Set up the ray output.  Records are recycled through the pool; with
+	// output buffers requested, a background thread formats and writes up to
+	// that many rays while the next ones are traced.
+	vector< string > columnNames;
+	columnNames.push_back( "r" );
+	columnNames.push_back( "z" );
+	columnNames.push_back( "amplitude" );
+	RayRecordPool *raypool = new RayRecordPool( outputBuffers > 0 ? outputBuffers : 1, columnNames.size() );
+	RaySink *sink = createRaySink( outputFormat, raypool, binaryFile, columnNames, outputBuffers > 0 );
+
         // Output to screen the parameters under which we'll be working
 	cout 	<< "Ray Trace Parameters:" << endl
 		<< "Atmospheric File Name: " << atmosfile << endl
@@ -378,42 +420,47 @@ int main( int argc, char **argv ) {
 			
 			// get set up to analyze the results for turning height, amplitude, etc.
 			bool therm = false;
-			ostringstream fileholder("");
-			ostringstream currentSkip("");
+			RayRecord *ray = raypool->acquire();
+			ray->reset( azvec[ azind ], rad2deg(theta) );
+			unsigned int committed = 0;
 			turningHeight = 0.0;
-			//int caustics = 0;
-			//double *jac = new double[ k+1 ];
-			double *amp = new double[ k+1 ];
+			double point[ 3 ], prevAmp = 0.0, A = 0.0;
+			bool pointKept = true;
 			double A0 = 0.0, dist1km = 1e15;
 			int k_end = 0;
 			unsigned int skips = 0;
 			
-			// Iterate through the solution to output the raypath to a file and do some summary calculations
+			// Iterate through the solution to collect the raypath and do some summary calculations.
+			// Only every decimate'th step goes into the record, plus the ground contacts and the
+			// final point, so that skips still end where they touch down.
 			for (int i = 0; i <= k; i++) {
 				
 				if (i > 1 && solution[ i-2 ][ 1 ] > solution[ i-1 ][ 1 ] && solution[ i ][ 1 ] > solution[ i-1 ][ 1 ]) {
-					fileholder << currentSkip.str();
-					currentSkip.str("");
+					if (!pointKept && decimate > 0) {
+						ray->addPoint( point );
+					}
+					committed = ray->size();
 					k_end = i-1;
+					A = prevAmp;
 					skips++;
 				}
 				
-				// Output (r,z) or (x,y) to buffer
-				currentSkip << solution[ i ][ 0 ] << "   " << solution[ i ][ 1 ];
+				// (r,z) and the relative amplitude
+				point[ 0 ] = solution[ i ][ 0 ];
+				point[ 1 ] = solution[ i ][ 1 ];
+				point[ 2 ] = equations->calculateAmplitude(solution, i);
+				prevAmp = point[ 2 ];
 				
-				// Calculate the relative amplitude
-				amp[ i ] = equations->calculateAmplitude(solution, i);
-
-					
-				// Output the relative amplitude to the raypath file
-				currentSkip << "   " << amp[ i ];
+				pointKept = (decimate > 0 && i % decimate == 0);
+				if (pointKept) {
+					ray->addPoint( point );
+				}
 				
 				// Get distance from 1km reference point and see if it's the closest point yet
 				if (fabs( solution[i][0] - 1 ) < dist1km) {
 					dist1km = fabs(solution[i][0] - 1);
-					A0 = amp[ i ];
+					A0 = point[ 2 ];
 				}
-				currentSkip << endl;
 				
 				// Check for the highest point in the raypath
 				if (solution[i][zindex] > turningHeight) {
@@ -423,10 +470,14 @@ int main( int argc, char **argv ) {
 			
 			// report partially-complete bounces if requested
 			if (partial || k_end == 0 || bouncer->triggered()) {
-				fileholder << currentSkip.str();
-				currentSkip.str("");
+				if (!pointKept && decimate > 0) {
+					ray->addPoint( point );
+				}
+				committed = ray->size();
 				k_end = k;
+				A = prevAmp;
 			}
+			ray->truncate( committed );
 			
 			// If the ray died in the thermosphere, there is no applicable range
 			if(turningHeight > maxheight || solution[ k ][zindex] > maxheight){
@@ -437,13 +488,8 @@ int main( int argc, char **argv ) {
 				range = solution[k_end][0];
 			}
 
-			// name and open the raypath file
-			char pathfile[4096];
-			sprintf(pathfile,"raypath_az%06.2f_elev%06.2f.txt",azvec[azind],rad2deg(theta));
-			ofstream raypath(pathfile,ios_base::out);
-
-			double tau = equations->calculateTravelTime( solution, k_end, stepsize, azvec[ azind ] );
-			double A = amp[ k_end ];
+			double tau = equations->calculateTravelTime( solution, k_end, stepsize, azvec[ azind ] )
+				- bouncer->travelTimeDeficit( k_end );
 			//double dB = 20 * log10( A / A0 );
 			double refDist = 1.0;   // normalize amplitudes to 1 km
 			double dB = equations->transmissionLoss( solution, k_end, refDist );
@@ -472,30 +518,26 @@ int main( int argc, char **argv ) {
 				}
 			}
 			
-			// Output quantities to file
-			raypath << "# Azimuth: " << azvec[ azind ] << endl
-				<< "# Elevation: " << theta * 180/Pi << endl;
+			// Summary quantities go in the raypath header
+			ray->addSummary( "Azimuth", azvec[ azind ] );
+			ray->addSummary( "Elevation", theta * 180/Pi );
 			if (!therm) {
-				raypath << "# Turning Height: " << turningHeight << endl
-					<< "# Range: " << range << endl 
-					<< "# Travel Time: " << tau << endl
-					<< "# Celerity: " << range/tau << endl
-					<< "# Skips: " << bouncer->countBounces() << endl;
+				ray->addSummary( "Turning Height", turningHeight );
+				ray->addSummary( "Range", range );
+				ray->addSummary( "Travel Time", tau );
+				ray->addSummary( "Celerity", range/tau );
+				ray->addSummary( "Skips", bouncer->countBounces() );
 				
 				if (spec->rho(0,0,sourceheight) > 0) {
-					raypath << "# Final Amplitude: " << A << endl
-						<< "# Amplitude @ ~1km: " << A0 << endl
-						<< "# Transmission Loss (re 1 km): " << dB << endl;
+					ray->addSummary( "Final Amplitude", A );
+					ray->addSummary( "Amplitude @ ~1km", A0 );
+					ray->addSummary( "Transmission Loss (re 1 km)", dB );
 				}
 			}
 			
-			// Now output the raypath itself
-			raypath << fileholder.str() << endl;
-			
-			raypath.close();
+			// Hand the ray off to be written; the sink returns the record to the pool
+			sink->submit( ray );
 			bouncer->reset();
-			//delete [] jac;
-			delete [] amp;
 			
 			// If we died in the thermosphere, we can stop the calculation
 			if (therm) break;
@@ -503,6 +545,11 @@ int main( int argc, char **argv ) {
 		}
 	}
 
+	// Finish writing any queued rays
+	sink->close();
+	delete sink;
+	delete raypool;
+
 	// Clean up memory allocations
 	delete system;
 	delete equations;
@@ -551,6 +598,12 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->addUsage( " --stepsize               Ray length step size for computation, km [0.01]" );
 	opt->addUsage( " --skips                  Maximum number of skips to allow.  Use 0 for no limits.  [0]" );
 	opt->addUsage( " --wind_units             Specify 'kmpersec' if the winds are given in km/s [mpersec]" );
+	opt->addUsage( " --output_format          'text' for one raypath_az*_elev*.txt file per ray, or 'binary' for" );
+	opt->addUsage( "                          all rays in one file of float32 columns [text]" );
+	opt->addUsage( " --binary_file            Output file for --output_format binary [raypaths.2d.bin]" );
+	opt->addUsage( " --decimate               Write every Nth raypath step; 0 writes the summary only [1]" );
+	opt->addUsage( " --output_buffers         Rays held for writing on a background thread; 0 writes" );
+	opt->addUsage( "                          each ray before tracing the next [4]" );
 	opt->addUsage( "FLAGS (no value required):" );
 	opt->addUsage( " --partial                Report the final, incomplete raypath as well as the complete bounces." );
 	opt->addUsage( "" );
@@ -629,6 +682,10 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->setOption( "skiplines" );
 	opt->setOption( "skips" );
 	opt->setOption( "wind_units" );
+	opt->setOption( "output_format" );
+	opt->setOption( "binary_file" );
+	opt->setOption( "decimate" );
+	opt->setOption( "output_buffers" );
 
 	// Process the command-line arguments
 	opt->processFile( "./raytrace.2d.options" );
@@ -16,9 +16,12 @@
 #include "anyoption.h"
 #include "EquationSet.h"
 #include "Acoustic3DEquationSet.h"
+#include "Acoustic3DGeometryEquationSet.h"
 #include "BreakConditions.h"
 #include "ODESystem.h"
 #include "ReflectionCondition3D.h"
+#include "RaySink.h"
+#include "ArrivalTable.h"
 
 #include <iostream>
 #include <cmath>
@@ -70,6 +73,11 @@ int main( int argc, char **argv ) {
 		maxraylength = 0, stepsize = 0.01, maxrange = 1e12, sourceheight = -1, maxheight = 150;
 	unsigned int maxskips = 0;
 	bool inMPS = true;
+	int decimate = 1, outputBuffers = 4;
+	RayOutputFormat outputFormat = RAYTEXT;
+	string binaryFile = "raypaths.3d.bin";
+	string arrivalsFile = "arrivals.3d.dat";
+	string lutFile = "";
 	//double lat = 0, lon = 0;	
 
 	// Elevation angle parameters
@@ -164,9 +172,43 @@ int main( int argc, char **argv ) {
 		}
 	}
 
+	// Output options
+	if (opt->getValue( "output_format" ) != NULL) {
+		if (strcmp( opt->getValue( "output_format" ), "binary" ) == 0) {
+			outputFormat = RAYBINARY;
+		} else if (strcmp( opt->getValue( "output_format" ), "text" ) != 0) {
+			delete opt;
+			throw invalid_argument( "Option --output_format must be 'text' or 'binary'!" );
+		}
+	}
+	if (opt->getValue( "binary_file" ) != NULL) {
+		binaryFile = opt->getValue( "binary_file" );
+	}
+	if (opt->getValue( "decimate" ) != NULL) {
+		decimate = atoi( opt->getValue( "decimate" ) );
+		if (decimate < 0) {
+			delete opt;
+			throw invalid_argument( "Option --decimate must be non-negative!" );
+		}
+	}
+	if (opt->getValue( "arrivals_file" ) != NULL) {
+		arrivalsFile = opt->getValue( "arrivals_file" );
+	}
+	if (opt->getValue( "lut_file" ) != NULL) {
+		lutFile = opt->getValue( "lut_file" );
+	}
+	if (opt->getValue( "output_buffers" ) != NULL) {
+		outputBuffers = atoi( opt->getValue( "output_buffers" ) );
+		if (outputBuffers < 0) {
+			delete opt;
+			throw invalid_argument( "Option --output_buffers must be non-negative!" );
+		}
+	}
+
 	// Flags
 	bool rangeDependent = false;    // not ready for the other way yet
 	bool partial = opt->getFlag( "partial" );
+	bool geometryOnly = opt->getFlag( "geometry_only" ) || (lutFile.size() > 0);
 	//bool reflect = !opt->getFlag( "noreflect" );
 	//bool reflect = false;
 	
@@ -280,7 +322,7 @@ int main( int argc, char **argv ) {
 	condition = new UpwardRefractionCondition( 2, "Ray turned back upward" );
 	breakConditions.push_back( condition );
 	*/
-	ReflectionCondition3D *bouncer = new ReflectionCondition3D( spec, azimuth0, maxskips );
+	ReflectionCondition3D *bouncer = new ReflectionCondition3D( spec, azimuth0, maxskips, !geometryOnly );
 	breakConditions.push_back( bouncer );
 	condition = new MaximumBreakCondition( 2, maxheight, "Ray entering thermosphere...stopping solver." );
 	breakConditions.push_back( condition );
@@ -296,7 +338,13 @@ int main( int argc, char **argv ) {
 	Acoustic3DEquationSet *equations;
 	int zindex;   // which variable is z?
 
-	equations = new Acoustic3DEquationSet( spec, elev0, azimuth0, rangeDependent );
+	// Geometry-only runs integrate position and slowness alone (6 equations)
+	if (geometryOnly) {
+		equations = new Acoustic3DGeometryEquationSet( spec, elev0, azimuth0, rangeDependent );
+	} else {
+		equations = new Acoustic3DEquationSet( spec, elev0, azimuth0, rangeDependent );
+	}
+	bouncer->setEquations( equations, maxraylength / steps );
 	double initialConditions[ 18 ];
 	zindex = 2;
 	
@@ -309,6 +357,38 @@ int main( int argc, char **argv ) {
                 solution[ i ] = new double[ equations->numberOfEquations() ];
         }
 
+	// Set up the ray output.  Records are recycled through the pool; with
+	// output buffers requested, a background thread formats and writes up to
+	// that many rays while the next ones are traced.
+	vector< string > columnNames;
+	columnNames.push_back( "x" );
+	columnNames.push_back( "y" );
+	columnNames.push_back( "z" );
+	columnNames.push_back( "amplitude" );
+	columnNames.push_back( "jacobian" );
+	RayRecordPool *raypool = 0;
+	RaySink *sink = 0;
+	ofstream arrivals;
+	ArrivalTable *table = 0;
+	int nelev = (int)floor( (maxelev - elev0) / delev + 1.0e-6 ) + 1;
+	if (lutFile.size() > 0) {
+		table = new ArrivalTable( sourceheight, azimuth0, dazimuth, naz, 
+			rad2deg( elev0 ), rad2deg( delev ), nelev );
+	}
+	if (geometryOnly) {
+		// One line per ground arrival instead of raypath files
+		arrivals.open( arrivalsFile.c_str(), ios_base::out );
+		if (!arrivals.good()) {
+			throw runtime_error( "Could not open arrivals file " + arrivalsFile );
+		}
+		// enough digits for millisecond travel times across thousands of seconds
+		arrivals.precision( 9 );
+		arrivals << "# Azimuth   Elevation   Bounce   Range(km)   TravelTime(s)   Celerity(km/s)   TurningHeight(km)" << endl;
+	} else {
+		raypool = new RayRecordPool( outputBuffers > 0 ? outputBuffers : 1, columnNames.size() );
+		sink = createRaySink( outputFormat, raypool, binaryFile, columnNames, outputBuffers > 0 );
+	}
+
         // Output to screen the parameters under which we'll be working
 	cout 	<< "Ray Trace Parameters:" << endl
 		<< "Atmospheric File Name: " << atmosfile << endl
@@ -350,53 +430,122 @@ int main( int argc, char **argv ) {
 			
 			// the magic happens here
 			k = system->rk4( equations, solution, steps, initialConditions, raymin, maxraylength, breakConditions );
+
+			if (geometryOnly) {
+				// Record range, travel time and turning height at each ground contact.  Travel
+				// time is accumulated one skip at a time, each solution point after the
+				// source standing for the step that ends there.
+				bool therm = false;
+				int lastContact = 0, nArrivals = 0, k_end = 0;
+				double tau = 0.0, skipHeight = 0.0;
+				turningHeight = 0.0;
+				for (int i = 0; i <= k; i++) {
+					bool contact = false;
+					if (i > 1 && solution[ i-2 ][ 2 ] > solution[ i-1 ][ 2 ] && solution[ i ][ 2 ] > solution[ i-1 ][ 2 ]) {
+						contact = (solution[ i-1 ][ 2 ] <= spec->z0( solution[ i-1 ][ 0 ], solution[ i-1 ][ 1 ] ));
+						if (contact) {
+							k_end = i-1;
+						}
+					} else if (i == k && bouncer->triggered()) {
+						// the solver stopped on the final reflection
+						contact = true;
+						k_end = k;
+					}
+					if (solution[ i ][ 2 ] > skipHeight) {
+						skipHeight = solution[ i ][ 2 ];
+					}
+					if (skipHeight > turningHeight) {
+						turningHeight = skipHeight;
+					}
+					if (contact) {
+						tau += equations->calculateTravelTime( solution, lastContact+1, k_end, stepsize );
+						double arrivalTime = tau - bouncer->travelTimeDeficit( k_end );
+						range = sqrt( solution[k_end][0]*solution[k_end][0] + solution[k_end][1]*solution[k_end][1] );
+						nArrivals++;
+						arrivals << azvec[ azind ] << "   " << rad2deg(theta) << "   " << nArrivals 
+							<< "   " << range << "   " << arrivalTime << "   " << range/arrivalTime << "   " << skipHeight << endl;
+						int elevind = (int)floor( (theta - elev0) / delev + 0.5 );
+						if (table != 0 && elevind < nelev) {
+							double deviation = equations->calculateArrivalAzimuth( solution, k_end, 5 ) 
+								- azvec[ azind ];
+							while (deviation > 180.0)
+								deviation -= 360.0;
+							while (deviation < -180.0)
+								deviation += 360.0;
+							ArrivalEntry entry = { (float)range, (float)arrivalTime, (float)deviation, (float)skipHeight };
+							table->set( azind, elevind, nArrivals, entry );
+						}
+						lastContact = k_end;
+						skipHeight = solution[ i ][ 2 ];
+					}
+				}
+				therm = (turningHeight > maxheight || solution[ k ][ 2 ] > maxheight);
+				cout << "Ray trace for angle theta = " << theta*180/Pi << " completed." << endl
+					<< "Max Turning Height: " << turningHeight << " km" << endl
+					<< "Ground Arrivals: " << nArrivals << endl;
+				bouncer->reset();
+				if (therm) break;
+				continue;
+			}
 			
 			// get set up to analyze the results for turning height, amplitude, etc.
 			bool therm = false;
-			ostringstream fileholder("");
-			ostringstream currentSkip("");
+			RayRecord *ray = raypool->acquire();
+			ray->reset( azvec[ azind ], rad2deg(theta) );
+			unsigned int committed = 0;
 			turningHeight = 0.0;
 			int caustics = 0, k_end = 0;
 			unsigned int skips = 0;
-			double *jac = new double[ k+1 ];
-			double *amp = new double[ k+1 ];
+			double point[ 5 ], prevAmp = 0.0, A = 0.0;
+			bool pointKept = true;
 			double A0 = 0.0, dist1km = 1e15;
 			
-			// Iterate through the solution to output the raypath to a file and do some summary calculations
+			// Iterate through the solution to collect the raypath and do some summary calculations.
+			// Only every decimate'th step goes into the record, plus the ground contacts and the
+			// final point, so that skips still end where they touch down.
 			for (int i = 0; i <= k; i++) {
 				
 				// see if the ray bottomed out last time
 				if (i > 1 && solution[ i-2 ][ 2 ] > solution[ i-1 ][ 2 ] && solution[ i ][ 2 ] > solution[ i-1 ][ 2 ]) {
-					fileholder << currentSkip.str();
-					currentSkip.str("");
+					if (!pointKept && decimate > 0) {
+						ray->addPoint( point );
+					}
+					committed = ray->size();
 					k_end = i-1;
+					A = prevAmp;
 					skips++;
 				}
 				
-				// Output (r,z) or (x,y) to buffer
-				currentSkip << solution[ i ][ 0 ] << "   " << solution[ i ][ 1 ] << "   " << solution[ i ][ 2 ];
+				// (x,y,z)
+				point[ 0 ] = solution[ i ][ 0 ];
+				point[ 1 ] = solution[ i ][ 1 ];
+				point[ 2 ] = solution[ i ][ 2 ];
 				
 				// Jacobian is nan at the first step 
 				if (i == 0) {
-					jac[ i ] = 0;
-					amp[ i ] = 0;
+					point[ 3 ] = 0;
+					point[ 4 ] = 0;
 				} else {
 					// Calculate the relative amplitude
-					amp[ i ] = equations->calculateAmplitude(solution, i);
+					point[ 3 ] = equations->calculateAmplitude(solution, i);
 					// calculate the jacobian and test it for sign change, indicating passage through a caustic 
-					jac[ i ] = equations->Jacobian( solution, i );
-					if (jac[i]*jac[i-1] < 0) { 
+					double jac = equations->Jacobian( solution, i );
+					if (jac*point[ 4 ] < 0) { 
 						caustics++;
 					}
+					point[ 4 ] = jac;
 				}
+				prevAmp = point[ 3 ];
 				
-				// Output amplitude and Jacobian to buffer
-				currentSkip << "   " << amp[ i ] << "   " << jac[ i ] << endl;
+				pointKept = (decimate > 0 && i % decimate == 0);
+				if (pointKept) {
+					ray->addPoint( point );
+				}
 				
 				// Get distance from the 1 km reference point and see if it's the closest point yet
 				if (fabs(sqrt(solution[i][0]*solution[i][0] + solution[i][1]*solution[i][1]) - 1) < dist1km) {
 					dist1km = fabs(sqrt(solution[i][0]*solution[i][0] + solution[i][1]*solution[i][1]) - 1);
-					A0 = amp[ i ];
+					A0 = point[ 3 ];
 				}
 				
 				// Check for the highest point in the raypath
@@ -406,10 +555,14 @@ int main( int argc, char **argv ) {
 			}
 			
 			if (partial || bouncer->triggered() || k_end == 0) {
-				fileholder << currentSkip.str();
-				currentSkip.str("");
+				if (!pointKept && decimate > 0) {
+					ray->addPoint( point );
+				}
+				committed = ray->size();
 				k_end = k;
+				A = prevAmp;
 			}
+			ray->truncate( committed );
 			
 			// If the ray died in the thermosphere, there is no applicable range
 			if(turningHeight > maxheight || solution[ k ][zindex] > maxheight) {
@@ -420,13 +573,8 @@ int main( int argc, char **argv ) {
 				range = sqrt(solution[k_end][0]*solution[k_end][0] + solution[k_end][1]*solution[k_end][1]);
 			}
 
-			// name and open the raypath file
-			char pathfile[4096];
-			sprintf(pathfile,"raypath_az%06.2f_elev%06.2f.txt",azvec[azind],rad2deg(theta));
-			ofstream raypath(pathfile,ios_base::out);
-
-			double tau = equations->calculateTravelTime( solution, k_end, stepsize, azvec[ azind ] );
-			double A = amp[ k_end ];
+			double tau = equations->calculateTravelTime( solution, k_end, stepsize, azvec[ azind ] )
+				- bouncer->travelTimeDeficit( k_end );
 			//double dB = 20 * log10( A / A0 );
 			double refDist = 1.0;   // normalize amplitudes to 1 km
 			double dB = equations->transmissionLoss( solution, k_end, refDist );
@@ -458,40 +606,48 @@ int main( int argc, char **argv ) {
 				
 			}
 			
-			// Output quantities to file
-			raypath << "# Azimuth: " << azvec[ azind ] << endl
-				<< "# Elevation: " << theta * 180/Pi << endl;
+			// Summary quantities go in the raypath header
+			ray->addSummary( "Azimuth", azvec[ azind ] );
+			ray->addSummary( "Elevation", theta * 180/Pi );
 			if (!therm) {
-				raypath << "# Turning Height: " << turningHeight << endl
-					<< "# Range: " << range << endl 
-					<< "# Travel Time: " << tau << endl
-					<< "# Celerity: " << range/tau << endl;
+				ray->addSummary( "Turning Height", turningHeight );
+				ray->addSummary( "Range", range );
+				ray->addSummary( "Travel Time", tau );
+				ray->addSummary( "Celerity", range/tau );
 				
 				if (spec->rho(0,0,sourceheight) > 0) {
-					raypath << "# Final Amplitude: " << A << endl
-						<< "# Amplitude @ ~1km: " << A0 << endl
-						<< "# Transmission Loss (re 1 km): " << dB << endl;
+					ray->addSummary( "Final Amplitude", A );
+					ray->addSummary( "Amplitude @ ~1km", A0 );
+					ray->addSummary( "Transmission Loss (re 1 km)", dB );
 				}
-				raypath << "# Jacobian at Endpoint: " << ((Acoustic3DEquationSet *)equations)->Jacobian( solution, k_end ) << endl
-					<< "# Caustics Passed Through: " << caustics << endl;
+				ray->addSummary( "Jacobian at Endpoint", ((Acoustic3DEquationSet *)equations)->Jacobian( solution, k_end ) );
+				ray->addSummary( "Caustics Passed Through", caustics );
 				
 			}
 			
-			// Now output the raypath itself
-			raypath << fileholder.str() << endl;
-			
-			raypath.close();
+			// Hand the ray off to be written; the sink returns the record to the pool
+			sink->submit( ray );
 			bouncer->reset();
 			
-			delete [] jac;
-			delete [] amp;
-			
 			// If we died in the thermosphere, we can stop the calculation
 			if (therm) break;
 
 		}
 	}
 
+	// Finish writing any queued rays
+	if (geometryOnly) {
+		arrivals.close();
+		if (table != 0) {
+			table->write( lutFile );
+			delete table;
+		}
+	} else {
+		sink->close();
+		delete sink;
+		delete raypool;
+	}
+
 	// Clean up memory allocations
 	delete system;
 	delete equations;
@@ -539,8 +695,20 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->addUsage( " --stepsize               Ray length step size for computation, km [0.01]" );
 	opt->addUsage( " --skips                  Maximum number of skips to allow.  Enter 0 for no maximum.  [0]");
 	opt->addUsage( " --wind_units             Specify 'kmpersec' if the winds are given in km/s [mpersec]" );
+	opt->addUsage( " --output_format          'text' for one raypath_az*_elev*.txt file per ray, or 'binary' for" );
+	opt->addUsage( "                          all rays in one file of float32 columns [text]" );
+	opt->addUsage( " --binary_file            Output file for --output_format binary [raypaths.3d.bin]" );
+	opt->addUsage( " --decimate               Write every Nth raypath step; 0 writes the summary only [1]" );
+	opt->addUsage( " --output_buffers         Rays held for writing on a background thread; 0 writes" );
+	opt->addUsage( "                          each ray before tracing the next [4]" );
+	opt->addUsage( " --arrivals_file          Output file for --geometry_only [arrivals.3d.dat]" );
+	opt->addUsage( " --lut_file               Also store the arrivals of every bounce in a binary lookup" );
+	opt->addUsage( "                          table for raytrace.arrivals.  Implies --geometry_only." );
 	opt->addUsage( "FLAGS (no values required):" );
 	opt->addUsage( " --partial                Report the final, incomplete raypath as well as the complete bounces." );
+	opt->addUsage( " --geometry_only          Integrate ray position and slowness only, skipping amplitudes and" );
+	opt->addUsage( "                          Jacobians, and write the range, travel time and turning height of" );
+	opt->addUsage( "                          each ground arrival to --arrivals_file instead of raypath files." );
 	opt->addUsage( "" );
 	
 /*
@@ -577,6 +745,7 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->setFlag( "norange" );
 	opt->setFlag( "atmosout" );
 	opt->setFlag( "partial" );
+	opt->setFlag( "geometry_only" );
 	opt->setOption( "atmosfile" );
 	opt->setOption( "jetfile" );
 	opt->setOption( "elev" );
@@ -598,6 +767,12 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 	opt->setOption( "skiplines" );
 	opt->setOption( "skips" );
 	opt->setOption( "wind_units" );
+	opt->setOption( "output_format" );
+	opt->setOption( "binary_file" );
+	opt->setOption( "decimate" );
+	opt->setOption( "output_buffers" );
+	opt->setOption( "arrivals_file" );
+	opt->setOption( "lut_file" );
 
 	// Process the command-line arguments
 	opt->processFile( "./raytrace.3d.options" );
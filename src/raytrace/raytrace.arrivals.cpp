@@ -0,0 +1,139 @@
+/**
+ * Eigenray estimates from a precomputed arrival table (raytrace.3d --lut_file).
+ */
+
+#include "anyoption.h"
+#include "ArrivalTable.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+
+
+using namespace NCPA;
+using namespace std;
+
+// Function to parse the options from the command line/config file
+AnyOption *parseInputOptions( int argc, char **argv );
+
+// Writes the estimates for one receiver
+void printEigenrays( ostream &out, double range, double azimuth, const vector< Eigenray > &rays );
+
+int main( int argc, char **argv ) {
+
+	AnyOption *opt = parseInputOptions( argc, argv );
+
+	if (opt->getValue( "lut_file" ) == NULL) {
+		delete opt;
+		throw invalid_argument( "Option --lut_file is required!" );
+	}
+	string lutFile = opt->getValue( "lut_file" );
+
+	// Receivers come either from the command line or, one "range azimuth" pair per
+	// line, from a file
+	vector< double > ranges, azimuths;
+	if (opt->getValue( "receiver_file" ) != NULL) {
+		string receiverFile = opt->getValue( "receiver_file" );
+		ifstream in( receiverFile.c_str() );
+		if (!in.good()) {
+			delete opt;
+			throw runtime_error( "Could not open receiver file " + receiverFile );
+		}
+		string line;
+		while (getline( in, line )) {
+			if (line.size() == 0 || line[ 0 ] == '#') {
+				continue;
+			}
+			istringstream iss( line );
+			double r, az;
+			if (iss >> r >> az) {
+				ranges.push_back( r );
+				azimuths.push_back( az );
+			}
+		}
+		in.close();
+	} else if (opt->getValue( "range" ) != NULL && opt->getValue( "azimuth" ) != NULL) {
+		ranges.push_back( atof( opt->getValue( "range" ) ) );
+		azimuths.push_back( atof( opt->getValue( "azimuth" ) ) );
+	} else {
+		delete opt;
+		throw invalid_argument( "Either --range and --azimuth or --receiver_file must be specified!" );
+	}
+
+	ArrivalTable table( lutFile );
+	cout << "# Source height: " << table.sourceHeight() << " km" << endl
+	     << "# Range(km)   Azimuth   Bounce   Elevation   TravelTime(s)   Celerity(km/s)   BackAzimuthDeviation   TurningHeight(km)" << endl;
+
+	vector< Eigenray > rays;
+	for (unsigned int i = 0; i < ranges.size(); i++) {
+		rays.clear();
+		table.query( ranges[ i ], azimuths[ i ], rays );
+		printEigenrays( cout, ranges[ i ], azimuths[ i ], rays );
+	}
+
+	delete opt;
+	return 0;
+}
+
+void printEigenrays( ostream &out, double range, double azimuth, const vector< Eigenray > &rays ) {
+	for (unsigned int i = 0; i < rays.size(); i++) {
+		out << range << "   " << azimuth << "   " << rays[ i ].bounce << "   "
+		    << rays[ i ].elevation << "   " << rays[ i ].time << "   " << range / rays[ i ].time << "   "
+		    << rays[ i ].deviation << "   " << rays[ i ].turningHeight << endl;
+	}
+}
+
+
+AnyOption *parseInputOptions( int argc, char **argv ) {
+
+	// parse input options
+	AnyOption *opt = new AnyOption();
+
+	opt->addUsage( "Usage: " );
+	opt->addUsage( "" );
+	opt->addUsage( "The options below can be specified in a colon-separated file \"raytrace.arrivals.options\" or at the command line.  Command-line options override file options." );
+	opt->addUsage( " --help -h                Print this message and exit" );
+	opt->addUsage( "" );
+	opt->addUsage( "Interpolates eigenray launch angles, travel times, back azimuth deviations and" );
+	opt->addUsage( "turning heights from an arrival table written by raytrace.3d --lut_file." );
+	opt->addUsage( "REQUIRED (no default values):" );
+	opt->addUsage( " --lut_file               The arrival table" );
+	opt->addUsage( " --range                  Receiver range from the source (km)" );
+	opt->addUsage( " --azimuth                Receiver azimuth from the source, clockwise from north" );
+	opt->addUsage( "   or" );
+	opt->addUsage( " --receiver_file          File of receivers, one 'range azimuth' pair per line" );
+	opt->addUsage( "" );
+	opt->addUsage( "Examples (run from 'samples' directory):" );
+	opt->addUsage( "../bin/raytrace.3d --azimuth 0 --dazimuth 1 --maxazimuth 359 --elev 0.5 --delev 0.5 --maxelev 45 --skips 3 --atmosfile NCPA_canonical_profile_zuvwtdp.dat --atmosfileorder zuvwtdp --skiplines 0 --maxraylength 1200 --maxheight 140 --lut_file arrivals.3d.lut" );
+	opt->addUsage( "../bin/raytrace.arrivals --lut_file arrivals.3d.lut --range 250 --azimuth 90" );
+	opt->addUsage( "" );
+
+	// Set up the actual flags and stuff
+	opt->setFlag( "help", 'h' );
+	opt->setOption( "lut_file" );
+	opt->setOption( "range" );
+	opt->setOption( "azimuth" );
+	opt->setOption( "receiver_file" );
+
+	// Process the command-line arguments
+	opt->processFile( "./raytrace.arrivals.options" );
+	opt->processCommandArgs( argc, argv );
+
+	if( ! opt->hasOptions()) { // print usage if no options
+		opt->printUsage();
+		delete opt;
+		exit( 1 );
+	}
+
+	// Check to see if help text was requested
+	if ( opt->getFlag( "help" ) || opt->getFlag( 'h' ) ) {
+		opt->printUsage();
+		exit( 1 );
+	}
+
+	return opt;
+}
@@ -192,6 +192,33 @@ NCPA::ProcessOptionsTDPE::ProcessOptionsTDPE(AnyOption *opt)
             }
   }  
 
+  // streaming synthesis: the number of frequencies and the maximum
+  // frequency cannot be taken from a directory that is still being filled
+  stream_flg           = opt->getFlag( "stream" );
+  stream_timeout       = 600;
+  stream_partial_every = 0;
+  if (stream_flg) {
+      if ( opt->getValue( "stream_nfreq" ) != NULL && opt->getValue( "stream_fmax" ) != NULL ) {
+          Nfreq = atoi(opt->getValue( "stream_nfreq" ));
+          f_max = atof(opt->getValue( "stream_fmax" ));
+          cout << "Streaming " << Nfreq << " frequencies up to " << f_max << " Hz" << endl;
+          if (Nfreq < 2 || f_max <= 0.0) {
+              delete opt;
+              throw invalid_argument( "--stream_nfreq should be at least 2 and --stream_fmax strictly positive!" );
+          }
+      }
+      else {
+          delete opt;
+          throw invalid_argument( "Options --stream_nfreq and --stream_fmax are required with --stream!" );
+      }
+      if ( opt->getValue( "stream_timeout_s" ) != NULL ) {
+          stream_timeout = atoi(opt->getValue( "stream_timeout_s" ));
+      }
+      if ( opt->getValue( "stream_partial_every" ) != NULL ) {
+          stream_partial_every = atoi(opt->getValue( "stream_partial_every" ));
+      }
+  }
+
   //make sure we have the waveform output file name
   if ( opt->getValue( "waveform_out_file" ) != NULL ) {
       waveform_out_file.assign(opt->getValue( "waveform_out_file"));
@@ -302,6 +329,18 @@ int    NCPA::ProcessOptionsTDPE::getNFFT() {
   return NFFT;
 }
 
+bool   NCPA::ProcessOptionsTDPE::getStream_flg() {
+  return stream_flg;
+}
+
+int    NCPA::ProcessOptionsTDPE::getStream_timeout() {
+  return stream_timeout;
+}
+
+int    NCPA::ProcessOptionsTDPE::getStream_partial_every() {
+  return stream_partial_every;
+}
+
 	
 			
 
@@ -19,12 +19,15 @@ namespace NCPA {
       bool   getPprop_s2r_flg();
       bool   getPprop_s2r_grid_flg();
       bool   getPlot_flg();
+      bool   getStream_flg();
     
       int    getNrng_steps();
       int    getNfreq();
       int    getNtsteps();
       int    getSrc_flg();
       int    getNFFT();
+      int    getStream_timeout();
+      int    getStream_partial_every();
 
       double getZ_min(); 
       double getMax_celerity();
@@ -49,6 +52,7 @@ namespace NCPA {
       bool   pprop_s2r_flg;	
       bool   pprop_s2r_grid_flg;
       bool   plot_flg;
+      bool   stream_flg;      // synthesize while the pape files are being written
 
       int    Nrng_steps;      // number of range steps		
       int    Nfreq;           // number of positive frequencies 
@@ -56,6 +60,8 @@ namespace NCPA {
       int    src_flg;         // source flag; 0 for impulse response; 1 for built-in inpulse 
                               // 2 for source spectrum file; 3 for source waveform file provided
       int    NFFT;            // number of fft points 
+      int    stream_timeout;  // seconds to wait for a new pape file when streaming
+      int    stream_partial_every; // save partial waveforms every so many frequencies
       
       double RR;
       double R_start;
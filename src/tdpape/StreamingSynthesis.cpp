@@ -0,0 +1,74 @@
+#include <cmath>
+#include <stdexcept>
+#include "StreamingSynthesis.h"
+
+#ifndef Pi
+#define Pi 3.141592653589793
+#endif
+
+using namespace NCPA;
+using namespace std;
+
+NCPA::StreamingSynthesis::StreamingSynthesis(int nfft_, int nrcv_) {
+  if (nfft_ < 1 || nrcv_ < 1) {
+      throw invalid_argument("Streaming synthesis needs at least one time sample and one receiver.");
+  }
+  nfft  = nfft_;
+  nrcv  = nrcv_;
+  nbins = 0;
+
+  w_re = new double [ nfft ];
+  w_im = new double [ nfft ];
+  for (int m=0; m<nfft; m++) {
+      w_re[m] =  cos(2.0*Pi*m/nfft);
+      w_im[m] = -sin(2.0*Pi*m/nfft);
+  }
+  c_re = new double [ nrcv ];
+  c_im = new double [ nrcv ];
+  p_re = new double [ (size_t) nfft*nrcv ]();
+  p_im = new double [ (size_t) nfft*nrcv ]();
+}
+
+NCPA::StreamingSynthesis::~StreamingSynthesis() {
+  delete [] w_re;  delete [] w_im;
+  delete [] c_re;  delete [] c_im;
+  delete [] p_re;  delete [] p_im;
+}
+
+void NCPA::StreamingSynthesis::addBin(int k, const complex<double> *c) {
+  if (k < 0 || k >= nfft) {
+      throw out_of_range("Frequency bin beyond the FFT length.");
+  }
+  for (int r=0; r<nrcv; r++) {
+      c_re[r] = real(c[r]);
+      c_im[r] = imag(c[r]);
+  }
+
+  double * __restrict__ pr = p_re;
+  double * __restrict__ pi = p_im;
+  const double * __restrict__ cr = c_re;
+  const double * __restrict__ ci = c_im;
+  int m = 0;   // k*n mod nfft
+  for (int n=0; n<nfft; n++) {
+      double br = w_re[m], bi = w_im[m];
+      double * __restrict__ qr = pr + (size_t) n*nrcv;
+      double * __restrict__ qi = pi + (size_t) n*nrcv;
+      for (int r=0; r<nrcv; r++) {
+          qr[r] += cr[r]*br - ci[r]*bi;
+          qi[r] += cr[r]*bi + ci[r]*br;
+      }
+      m += k;
+      if (m >= nfft) { m -= nfft; }
+  }
+  nbins++;
+}
+
+void NCPA::StreamingSynthesis::getPulse(int r, complex<double> *pulse) {
+  for (int n=0; n<nfft; n++) {
+      pulse[n] = complex<double>(p_re[(size_t) n*nrcv + r], p_im[(size_t) n*nrcv + r]);
+  }
+}
+
+int NCPA::StreamingSynthesis::getNbins() {
+  return nbins;
+}
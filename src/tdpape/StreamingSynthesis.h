@@ -0,0 +1,47 @@
+#ifndef _StreamingSynthesis_H_
+#define _StreamingSynthesis_H_
+
+#include <complex>
+
+//
+// Time-domain synthesis of a grid of receivers, one frequency at a time.
+//
+// tdpape forms, for each receiver, the spectrum arg_vec[k] of the propagated
+// pulse and takes its FFT of length nfft,
+//   pulse[n] = sum_k arg_vec[k] exp(-2 pi i k n/nfft).
+// The transform is linear, so each frequency bin k can instead be added to
+// the waveforms of all receivers as soon as it is known, as arg_vec[k] times
+// the basis exp(-2 pi i k n/nfft). The basis is taken from a table of the
+// nfft roots of unity, computed once, so no error accumulates with n.
+//
+// Only the receiver waveforms are stored (nfft x nrcv), whatever the number
+// of frequencies, and the waveforms can be read at any time: before every
+// bin is in, they are the partial sum over the bins added so far.
+//
+// Waveforms are stored with the receivers innermost and real and imaginary
+// parts in separate arrays, so that adding a bin runs over the receivers
+// in the inner loop.
+//
+namespace NCPA {
+  class StreamingSynthesis {
+    public:
+      StreamingSynthesis(int nfft, int nrcv);
+      ~StreamingSynthesis();
+
+      // adds bin k, with value c[r] for receiver r = 0 ... nrcv-1
+      void addBin(int k, const std::complex<double> *c);
+
+      // the current waveform of receiver r (nfft values)
+      void getPulse(int r, std::complex<double> *pulse);
+
+      int  getNbins();   // bins added so far
+
+    private:
+      int     nfft, nrcv, nbins;
+      double  *w_re, *w_im;        // exp(-2 pi i m/nfft), m = 0 ... nfft-1
+      double  *c_re, *c_im;        // the bin being added, per receiver
+      double  *p_re, *p_im;        // index (n*nrcv + r)
+  }; // mandatory semicolon here
+}
+
+#endif
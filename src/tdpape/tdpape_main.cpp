@@ -10,7 +10,8 @@
 //#include <stdio.h>
 //#include <math.h>
 #include <complex>
-//#include <ctime>
+#include <ctime>
+#include <unistd.h>
 
 #include <gsl/gsl_interp.h>
 #include <gsl/gsl_spline.h>
@@ -18,6 +19,7 @@
 
 #include "anyoption.h"
 #include "ProcessOptionsTDPE.h"
+#include "StreamingSynthesis.h"
 
 #ifndef Pi
 #define Pi 3.141592653589793
@@ -52,6 +54,9 @@ bool compare_freq (string first, string second);
 
 complex<double> getInterp(string filename, double x);
 
+// the same interpolation at several ranges x (km), reading the file once
+vector< complex<double> > interpFile(string filename, const vector<double> &x);
+
 vector < complex<double> > interpDir(string pape_output_dir, string filepattern, double R);
 
 int pulse_prop_src2rcv_grid2(\
@@ -77,6 +82,17 @@ int pulse_prop_src2rcv_grid4(\
 					double f_center, \
 					string pape_out_dir, string filepattern, \
 					int src_flg, string srcfile, int pprop_src2rcv_flg);								
+
+// the output of pulse_prop_src2rcv_grid4 to round-off, but each frequency is added to the
+// waveforms as soon as its pape file appears in pape_out_dir
+int pulse_prop_src2rcv_stream(\
+          const char *filename,double max_cel, \
+          double R_start,double DR,double R_end, \
+					int NFFT, int n_freqs, double f_step, double *f_vec, \
+					double f_center, \
+					string pape_out_dir, string filepattern, \
+					int src_flg, string srcfile, int pprop_src2rcv_flg, \
+					int timeout_s, int partial_every);
 					
 void fft_pulse_prop(\
           double t0, int n_freqs, double df, double *f_vec, \
@@ -222,9 +238,21 @@ int main ( int argc, char **argv )  {
   
   vector<double> fv;
   double f_step;    // CHH 191029: fmax unused
-  fv = getFreq_vector(pape_output_dir, filepattern);
-  int Nfreq = fv.size();
-  f_step = fv[1]-fv[0];
+  int Nfreq;
+  if (oTDPE->getStream_flg()) {
+    // the directory may not be complete yet: the frequencies are given
+    // and laid out as in getFreq_vector
+    Nfreq  = oTDPE->getNfreq();
+    f_step = oTDPE->getF_max()/Nfreq;
+    for (int i=0; i<Nfreq; i++) {
+      fv.push_back(i*f_step);
+    }
+  }
+  else {
+    fv = getFreq_vector(pape_output_dir, filepattern);
+    Nfreq = fv.size();
+    f_step = fv[1]-fv[0];
+  }
 
   // print frequency vector
   if (0) {
@@ -243,11 +271,21 @@ int main ( int argc, char **argv )  {
   //			       src_flg, src_file, pprop_s2r_flg);
 
 	// This call uses NFFT as an argument			                    
-  pulse_prop_src2rcv_grid4( waveform_out_file.c_str(), max_cel, \
+  if (oTDPE->getStream_flg()) {
+    pulse_prop_src2rcv_stream( waveform_out_file.c_str(), max_cel, \
+								            R_start, DR, R_end, NFFT, Nfreq, \
+								            f_step, fv.data(), f_center, \
+				                    pape_output_dir, filepattern, \
+				                    src_flg, src_file, pprop_s2r_flg, \
+				                    oTDPE->getStream_timeout(), oTDPE->getStream_partial_every());
+  }
+  else {
+    pulse_prop_src2rcv_grid4( waveform_out_file.c_str(), max_cel, \
 								            R_start, DR, R_end, NFFT, Nfreq, \
 								            f_step, fv.data(), f_center, \
 				                    pape_output_dir, filepattern, \
 				                    src_flg, src_file, pprop_s2r_flg);				                    										          
+  }
   
   // (gnu)plot results if requested; calls a bash script
   // @todo get rid of this and its associated options
@@ -339,6 +377,20 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( " --nfft             Number of points used in the FFT computation. ");
   opt->addUsage( "                    Defaults to [4*f_max/f_step]." );	
   opt->addUsage( "" );
+  opt->addUsage( "STREAMING options: build the waveforms while pape is still running" );
+  opt->addUsage( " --stream           Flag to add each frequency to the waveforms as soon as its" );
+  opt->addUsage( "                    file appears in the pape output directory (e.g. from" );
+  opt->addUsage( "                    pape --batch_dir running at the same time), instead of" );
+  opt->addUsage( "                    waiting for all of them. Files named *.part are skipped." );
+  opt->addUsage( " --stream_nfreq     REQUIRED with --stream: number of frequencies N; the" );
+  opt->addUsage( "                    file <#n>_papeTL_<freq> is frequency n of N." );
+  opt->addUsage( " --stream_fmax      REQUIRED with --stream: frequency of file N [Hz]." );
+  opt->addUsage( " --stream_timeout_s Give up if no new file appears for this long and save" );
+  opt->addUsage( "                    the waveforms from the frequencies found [600]." );
+  opt->addUsage( " --stream_partial_every" );
+  opt->addUsage( "                    Save the partial waveforms in the output file every" );
+  opt->addUsage( "                    this many frequencies; 0 saves only the final ones [0]." );
+  opt->addUsage( "" );
   opt->addUsage( "SOURCE TYPE options: Use one of the following 4 options to specify the source:" );
   opt->addUsage( " --get_impulse_resp       Flag to use a (band-limited) delta function as source" );
   opt->addUsage( "                          and to output the impulse response." );
@@ -403,6 +455,7 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->setFlag( "get_impulse_resp" );
   opt->setFlag( "use_builtin_pulse" );
   opt->setFlag( "plot");
+  opt->setFlag( "stream" );
   
   
   opt->setOption( "maxrange_km" );
@@ -436,6 +489,10 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->setOption( "src_spectrum_file" );
   opt->setOption( "src_waveform_file" );
   opt->setOption( "nfft" );
+  opt->setOption( "stream_nfreq" );
+  opt->setOption( "stream_fmax" );
+  opt->setOption( "stream_timeout_s" );
+  opt->setOption( "stream_partial_every" );
 
   // Process the command-line arguments
   opt->processFile( "./tdpape.options" );
@@ -475,7 +532,13 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
 
 
 complex<double> getInterp(string filename, double x) {
+  return interpFile(filename, vector<double>(1, x))[0];
+}
+
+
+vector< complex<double> > interpFile(string filename, const vector<double> &x) {
   double dat1, dat2, dat3, xintrp, xintrp2;
+  vector< complex<double> > pp;
   vector <double> xx, p1, p2;
   gsl_interp_accel *acc_;
   gsl_spline *splin; 
@@ -512,12 +575,14 @@ complex<double> getInterp(string filename, double x) {
 	}
 	indata.close();
 
-	// abort if the the value to interpolate at is outside the available range
-	if (dat1<=x) {
-    std::ostringstream es;
-    es << "Error: cannot interpolate at requested range R = " << x 
-       << " km. Maximum range is Rmax = " << dat1 << " km.";
-    throw invalid_argument(es.str());
+	// abort if a value to interpolate at is outside the available range
+	for (unsigned int i=0; i<x.size(); i++) {
+	  if (dat1<=x[i]) {
+      std::ostringstream es;
+      es << "Error: cannot interpolate at requested range R = " << x[i] 
+         << " km. Maximum range is Rmax = " << dat1 << " km.";
+      throw invalid_argument(es.str());
+	  }
 	}
 
   // do interpolation
@@ -526,20 +591,23 @@ complex<double> getInterp(string filename, double x) {
   //printf("splin[%d]=%p\n", j, splin[j]);
   
   // interpolate the real part
+  vector<double> re(x.size());
   gsl_spline_init(splin, xx.data(), p1.data(), xx.size());
-  xintrp  = gsl_spline_eval(splin, x, acc_ );
+  for (unsigned int i=0; i<x.size(); i++) {
+    re[i] = gsl_spline_eval(splin, x[i], acc_ );
+  }
   
   // interpolate the imaginary part
+  gsl_interp_accel_reset(acc_);
   gsl_spline_init(splin, xx.data(), p2.data(), xx.size());
-  xintrp2 = gsl_spline_eval(splin, x, acc_ );
-  //cout << "x interp = " << xintrp << endl;
-  //cout << "x interp2 = " << xintrp2 << endl;
-       
-  complex<double> pp (xintrp, xintrp2);
-  //cout << " " << pp << endl; 
+  for (unsigned int i=0; i<x.size(); i++) {
+    xintrp  = re[i];
+    xintrp2 = gsl_spline_eval(splin, x[i], acc_ );
+    pp.push_back(complex<double>(xintrp, xintrp2));
+  }
   
-  delete acc_;
-  delete splin;
+  gsl_interp_accel_free(acc_);
+  gsl_spline_free(splin);
 
   return pp;
 }
@@ -1921,6 +1989,173 @@ int pulse_prop_src2rcv_grid4(\
 
 
 
+// writes the waveforms synthesized so far, in the format of pulse_prop_src2rcv_grid4
+void write_stream_waveforms(const char *filename, NCPA::StreamingSynthesis &synth, \
+          vector<double> &rr, vector<double> &t0, double fmx, int pprop_src2rcv_flg)
+{
+  int i;
+  FILE *f;
+  complex<double> *pulse_vec = new complex<double> [FFTN];
+
+  f = fopen(filename,"w");
+  if (f == NULL) {
+      delete [] pulse_vec;
+      throw invalid_argument(string("Could not open waveform output file ") + filename);
+  }
+  for (unsigned int r=0; r<rr.size(); r++) {
+      synth.getPulse(r, pulse_vec);
+      if (pprop_src2rcv_flg) {
+          for(i=0; i<FFTN; i++) {
+              fprintf(f,"%12.6f %15.6e %15.6e\n", 1.0*i/fmx+t0[r], 2.0*real(pulse_vec[i]), 2.0*imag(pulse_vec[i]));
+          }
+      }
+      else {
+          for(i=0;i<FFTN;i++){
+              fprintf(f,"%10.3f %12.6f %15.6e %15.6e\n", rr[r]/1000.0, 1.0*i/fmx, real(pulse_vec[i]), imag(pulse_vec[i]));
+          }
+          fprintf(f,"\n");
+      }
+  }
+  fclose(f);
+  delete [] pulse_vec;
+}
+
+
+// Streaming version of pulse_prop_src2rcv_grid4. Rather than waiting for all
+// single-frequency pape files, the directory is polled and every new file
+// (<#n>_papeTL_<freq>, skipping pape's unfinished *.part files) is read once,
+// interpolated at all receivers and added to their waveforms as the (#n-1)th
+// frequency bin, with the same source spectrum, reduced-time phase and taper
+// that fft_pulse_prop applies. The result is the FFT path's waveform to
+// round-off, but pape can still be running while it is built up. Only the
+// receiver waveforms are kept in memory. With partial_every > 0 the output
+// file is rewritten with the partial waveforms every partial_every frequencies.
+int pulse_prop_src2rcv_stream(\
+          const char *filename,double max_cel, \
+          double R_start,double DR,double R_end, \
+					int NFFT, int n_freqs, double f_step, double *f_vec, \
+					double f_center, \
+					string pape_out_dir, string filepattern, \
+					int src_flg, string srcfile, int pprop_src2rcv_flg, \
+					int timeout_s, int partial_every) 
+{
+  int i0, n, smooth_space, nadded;
+  double fmx;
+  complex<double> *dft_vec,*pulse_vec,*arg_vec;
+  complex<double> I (0.0, 1.0);
+  vector<double> rr, t0, rr_km;
+  vector<bool> added(n_freqs, false);
+  
+  if (NFFT<n_freqs) {
+    NFFT = 4*n_freqs;
+  }
+  if(FFTN < n_freqs){
+      throw invalid_argument("fft too short (i.e. FFTN < n_freqs), exiting.");
+  }
+
+  dft_vec   = new complex<double> [n_freqs];
+  pulse_vec = new complex<double> [FFTN];
+  arg_vec   = new complex<double> [FFTN];
+
+  fmx = ((double)FFTN)*f_step; // max frequency
+  
+  get_source_spectrum(n_freqs,  NFFT, f_step, f_vec,  f_center,
+		      dft_vec, pulse_vec, arg_vec, src_flg,  srcfile);
+  delete [] arg_vec;
+  delete [] pulse_vec;
+
+  // the receivers and their reduced-time origins
+  if (pprop_src2rcv_flg) {
+      cout << "Doing streaming pulse propagation source-to-receiver at one range: " 
+           << R_start/1000.0 << " km" << endl;
+      rr.push_back(R_start);
+      t0.push_back(R_start/max_cel);
+  }
+  else {
+      cout << "Doing streaming pulse propag source-to-receiver on grid ..." << endl;
+      for(n=0; n<=(int)(floor((R_end-R_start)/DR)); n++) {
+          rr.push_back(R_start + DR*n);
+          t0.push_back(rr.back()/max_cel);
+      }
+  }
+  for (unsigned int r=0; r<rr.size(); r++) {
+      rr_km.push_back(rr[r]/1000.0);
+  }
+
+  // left zero pad and right taper, as in fft_pulse_prop
+  for(i0=0;(fabs(i0*f_step-f_vec[0])>1.0e-10) & (i0*f_step<f_vec[0]); i0++);
+  smooth_space=(int)floor(0.1*n_freqs);
+
+  NCPA::StreamingSynthesis synth(FFTN, rr.size());
+  vector< complex<double> > PP, c(rr.size());
+  time_t last_new = time(NULL);
+  nadded = 0;
+  while (nadded < n_freqs) {
+      list<string> files;
+      list<string>::iterator it;
+      getFile_list(pape_out_dir, files, filepattern);
+      files.sort();
+      for (it=files.begin(); it!=files.end(); ++it) {
+          if ((*it).size() > 5 && (*it).compare((*it).size()-5, 5, ".part") == 0) {
+              continue;
+          }
+          int j = atoi((*it).c_str()) - 1;
+          if (j < 0 || j >= n_freqs) {
+              std::ostringstream es;
+              es << "File " << *it << " in " << pape_out_dir << " is not one of the "
+                 << n_freqs << " frequencies expected (see --stream_nfreq).";
+              throw invalid_argument(es.str());
+          }
+          if (added[j]) { continue; }
+
+          PP = interpFile(pape_out_dir + "/" + (*it), rr_km);
+          complex<double> w = dft_vec[j]*f_step*half_hann(n_freqs-smooth_space,n_freqs-1,i0+j);
+          for (unsigned int r=0; r<rr.size(); r++) {
+              c[r] = PP[r]*exp(-I*2.0*Pi*f_vec[j]*t0[r])*w;
+          }
+          if (i0+j < FFTN) {
+              synth.addBin(i0+j, c.data());
+          }
+          added[j] = true;
+          nadded++;
+          printf(" -> Added %s (%d of %d frequencies)\n", (*it).c_str(), nadded, n_freqs);
+
+          if (partial_every > 0 && nadded < n_freqs && nadded % partial_every == 0) {
+              write_stream_waveforms(filename, synth, rr, t0, fmx, pprop_src2rcv_flg);
+              printf(" -> Partial waveforms from %d of %d frequencies saved in %s\n", nadded, n_freqs, filename);
+          }
+          fflush(stdout);
+          last_new = time(NULL);
+      }
+
+      if (nadded < n_freqs) {
+          if (difftime(time(NULL), last_new) > timeout_s) {
+              printf(" -> No new pape files in %d s; stopping with %d of %d frequencies\n", timeout_s, nadded, n_freqs);
+              break;
+          }
+          sleep(1);
+      }
+  }
+
+  write_stream_waveforms(filename, synth, rr, t0, fmx, pprop_src2rcv_flg);
+  printf("f_step = %f   1/f_step = %f\n", f_step, 1.0/f_step);
+  printf("Time array length = %d; delta_t = %g s\n", FFTN, 1.0/fmx);
+  printf("Propagation results saved in file: %s\n", filename);
+  if (pprop_src2rcv_flg) {
+      printf("with columns: time (s) | Re(pulse) | Imag(pulse) |\n");
+  }
+  else {
+      printf("with columns: R (km) | time (s) | pulse(R,t) |\n");
+  }
+
+  delete [] dft_vec;
+
+  return (nadded < n_freqs) ? 1 : 0;
+}
+
+
+
+
 int load_source_pulse_td(string srcpulsetdfn, vector<double> &t, vector<double> &tdp ) {
   // load time domain source pulse: time (s) | amplitude
   cout << "Loading time domain source pulse from file " << srcpulsetdfn << endl;
@@ -53,6 +53,13 @@ NCPA::ProcessOptionsNRT::ProcessOptionsNRT(AnyOption *opt) {
   wftype     = "Nwave";
   wfAmpl     = 1000.0;  // Pa
   wfDuration = 0.5;     // seconds
+  
+  nfft              = 16384;
+  maxSavedWaveforms = 0;
+  streamWaveformsFile = "";
+  batchfile         = "";
+  batchOutfile      = "batch_waveforms.dat";
+  jobs              = 1;
 
   findEigenray = opt->getFlag( "findeigenray");
   shootRay     = opt->getFlag( "shootray" );
@@ -109,6 +116,43 @@ NCPA::ProcessOptionsNRT::ProcessOptionsNRT(AnyOption *opt) {
           << " sec" << endl;
   }
 
+  if (opt->getValue( "nfft" ) != NULL) {
+    nfft = atoi( opt->getValue( "nfft" ) );
+    // the saved waveforms are subsampled to 4096 points
+    if ( (nfft < 4096) || ((nfft & (nfft-1)) != 0) ) {
+      delete opt;
+      throw invalid_argument( "Option --nfft must be a power of 2 no less than 4096" );
+    }
+  }
+  
+  if (opt->getValue( "max_saved_waveforms" ) != NULL) {
+    maxSavedWaveforms = atoi( opt->getValue( "max_saved_waveforms" ) );
+    if (maxSavedWaveforms < 2) {
+      delete opt;
+      throw invalid_argument( "Option --max_saved_waveforms must be at least 2" );
+    }
+  }
+  
+  if (opt->getValue( "stream_waveforms" ) != NULL) {
+    streamWaveformsFile = opt->getValue( "stream_waveforms" );
+  }
+  
+  if (opt->getValue( "batchfile" ) != NULL) {
+    batchfile = opt->getValue( "batchfile" );
+  }
+  
+  if (opt->getValue( "batch_outfile" ) != NULL) {
+    batchOutfile = opt->getValue( "batch_outfile" );
+  }
+  
+  if (opt->getValue( "jobs" ) != NULL) {
+    jobs = atoi( opt->getValue( "jobs" ) );
+    if (jobs < 1) {
+      delete opt;
+      throw invalid_argument( "Option --jobs must be at least 1" );
+    }
+  }
+
   if (findEigenray || shootRay) {
 
     if ( opt->getValue( "atmosfile" ) != NULL ) {
@@ -350,6 +394,30 @@ double NCPA::ProcessOptionsNRT::getWfduration() {
   return wfDuration;
 }
 
+int NCPA::ProcessOptionsNRT::getNfft() {
+  return nfft;
+}
+
+int NCPA::ProcessOptionsNRT::getMaxSavedWaveforms() {
+  return maxSavedWaveforms;
+}
+
+std::string   NCPA::ProcessOptionsNRT::getStreamWaveformsFile() {
+  return streamWaveformsFile;
+}
+
+std::string   NCPA::ProcessOptionsNRT::getBatchfile() {
+  return batchfile;
+}
+
+std::string   NCPA::ProcessOptionsNRT::getBatchOutfile() {
+  return batchOutfile;
+}
+
+int NCPA::ProcessOptionsNRT::getJobs() {
+  return jobs;
+}
+
 
 
 
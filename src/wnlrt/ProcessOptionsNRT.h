@@ -62,6 +62,14 @@ namespace NCPA {
       double getWfampl();
       double getWfduration();
       
+      int    getNfft();
+      int    getMaxSavedWaveforms();
+      string getStreamWaveformsFile();
+      
+      string getBatchfile();
+      string getBatchOutfile();
+      int    getJobs();
+      
       bool getFindEigenray();
 	
     private:
@@ -96,6 +104,12 @@ namespace NCPA {
       double tol;
       double wfAmpl;
       double wfDuration;
+      int    nfft;                // number of waveform samples (power of 2)
+      int    maxSavedWaveforms;   // 0: one every ~0.5 km of the ray
+      string streamWaveformsFile; // "" : no streaming
+      string batchfile;           // list of source waveform cases; "" : single run
+      string batchOutfile;
+      int    jobs;                // number of processes for the batch cases
       
       
       bool findEigenray;
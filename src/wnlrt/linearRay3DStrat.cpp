@@ -12,162 +12,48 @@
 //----------------------------------------------------------------------------------------------
 // LINEAR RAY 3D PROPAGATION IN A STRATIFIED MEDIUM
 //----------------------------------------------------------------------------------------------
-linray linearRay3DStrat( double ds, double theta, double phi, double zs, double rr, double zr, profile prf )
+linray linearRay3DStrat( double ds, double theta, double phi, double zs, double rr, double zr, const profile &prf )
 {	
-    linray R;
-	  double zzprev, range, dz, dxds, dyds, dzds, wx, wy, cef, cc, Sx, Sy, Sz, om;
-    double dSzdSy, dzdSy, dxdSx, dxdSy, dydSx, dydSy, dSzdSx, dzdSx;
-    double d1ccep[2], d1wxep[2], d1wyep[2], A[4][14], ptAtm[3], ptAtmDer[3][2];
-    double *spl[3], *splrh;
-    vector< vector<double> > atm;
-    
-    if( theta <= 0.0)
-    {   cerr << "Error: The subroutine \"linearRay3DStrat\" cannot handle a ray with initial" << endl;
-        cerr << "       inclination angle of less than or equal to 0 deg." << endl;
-        exit(1);
-    }
-    
-    dz = prf.zz[1]-prf.zz[0];
-    deriv1EndPoints( dz, prf.cc, d1ccep );
-    deriv1EndPoints( dz, prf.wx, d1wxep );
-    deriv1EndPoints( dz, prf.wy, d1wyep );
-    
-    spl[0] = spline( prf.zz, prf.cc, d1ccep[0], d1ccep[1] );
-    spl[1] = spline( prf.zz, prf.wx, d1wxep[0], d1wxep[1] );
-    spl[2] = spline( prf.zz, prf.wy, d1wyep[0], d1wyep[1] );
-    splrh = spline( prf.zz, prf.rh, 1.0e50, 1.0e50 );
-    
-    //Putting the vectors of sound speed, etc into a single matrix
-	atm.push_back( prf.cc );	
-	atm.push_back( prf.wx );
-	atm.push_back( prf.wy ); 	
-
-  //Values at source location (xs = ys = 0; zs)
-  splint( prf.zz, atm, spl, zs, ptAtm );     //interpolating atmospheric profile
-  
-  cc = ptAtm[0];
-  wx = ptAtm[1];
-  wy = ptAtm[2];
-	cef = cc + wx*cos(theta)*cos(phi) + wy*cos(theta)*sin(phi);
-	Sx = cos(theta)*cos(phi)/cef;
-	Sy = cos(theta)*sin(phi)/cef;
-	Sz = sin(theta)/cef;
-	om = 1-wx*Sx-wy*Sy;
-  dSzdSx = -( wx*om/pow(cc,2) + Sx )/ Sz;
-	dzdSx = 0;
-	dSzdSy = -( wy*om/pow(cc,2) + Sy )/ Sz;
-	dzdSy = 0;
-	dxdSx = 0;
-	dxdSy = 0;
-	dydSx = 0;
-	dydSy = 0;
-	
-  R.cc.push_back( cc );
-  R.ss.push_back( 0 );
-  R.xx.push_back( 0 );
-  R.yy.push_back( 0 );
-  R.zz.push_back( zs );
-  R.rh.push_back( splint( prf.zz, prf.rh, splrh, zs ) );
-  R.om.push_back( om );
-  R.vr.push_back( sqrt(  ( pow(wx,2) + pow(wy,2) - pow(cc,2) )*pow(om,2) + 2*pow(cc,2)*om )/om );
-  R.ja.push_back( 0 );
-  R.tr.push_back( 0 );
-  R.tv =  1/sqrt( Sx*Sx + Sy*Sy );
-  R.th = theta*180/PI;
-  R.ph = phi*180/PI;
-    
-    
-    // Marching along the ray path and solving the system of ode using the 4th order Runge-Kutta routine
-    
-    splintDeriv( prf.zz, atm, spl, R.zz.back(), ptAtmDer );
-    
-    
-    
-    odesys ray;
-    ray.vars( ptAtm, ptAtmDer, Sx, Sy, Sz );
-    ray.rk4( ds, dzdSx, dzdSy, dSzdSx, dSzdSy, A[0] );
+    return linearRay3DStrat( ds, theta, phi, zs, rr, zr, atmosphereSpline( prf ) );
+}
 
-    zzprev = zs;
-    range = 0;
-    int k;
-    
-    while( !( R.zz.back() <= zr && zzprev > zr ) && range <= rr+10000  )
-    {   
-        for( k=1; k<4; k++)
-        {   
-            if(k==3) 
-            {   zs = R.zz.back()+A[2][2];
-                if( zs < prf.zz[0] || zs > prf.zz.back() ) break;
-                splint( prf.zz, atm, spl, zs, ptAtm );
-                splintDeriv( prf.zz, atm, spl, zs, ptAtmDer );
-                ray.vars( ptAtm, ptAtmDer, Sx, Sy, Sz+A[2][3] );
-                ray.rk4( ds, dzdSx+A[2][8], dzdSy+A[2][9], dSzdSx+A[2][10], dSzdSy+A[2][11], A[k] );
-            }
-            else
-            {   zs = R.zz.back()+A[k-1][2]/2;
-                if( zs < prf.zz[0] || zs > prf.zz.back() ) break;
-                splint( prf.zz, atm, spl, zs, ptAtm );
-                splintDeriv( prf.zz, atm, spl, zs, ptAtmDer );
-                ray.vars( ptAtm, ptAtmDer, Sx, Sy, Sz+A[k-1][3]/2 );
-                ray.rk4( ds, dzdSx+A[k-1][8]/2, dzdSy+A[k-1][9]/2, dSzdSx+A[k-1][10]/2, dSzdSy+A[k-1][11]/2, A[k] );
-            }
-        }
-        
-        if( zs < prf.zz[0] || zs > prf.zz.back() ) break;
-        zzprev = R.zz.back();
-        
-        Sz =         Sz + 1.0/6*( A[0][3]  +  2*(A[1][3]+A[2][3])  + A[3][3]  );
-        dxdSx =   dxdSx + 1.0/6*( A[0][4]  +  2*(A[1][4]+A[2][4])  + A[3][4]  );
-        dxdSy =   dxdSy + 1.0/6*( A[0][5]  +  2*(A[1][5]+A[2][5])  + A[3][5]  );
-        dydSx =   dydSx + 1.0/6*( A[0][6]  +  2*(A[1][6]+A[2][6])  + A[3][6]  );
-        dydSy =   dydSy + 1.0/6*( A[0][7]  +  2*(A[1][7]+A[2][7])  + A[3][7]  );
-        
-        dzdSx =   dzdSx + 1.0/6*( A[0][8]  +  2*(A[1][8]+A[2][8])  + A[3][8]  );
-        dzdSy =   dzdSy + 1.0/6*( A[0][9]  +  2*(A[1][9]+A[2][9])  + A[3][9]  );
-        dSzdSx = dSzdSx + 1.0/6*( A[0][10] + 2*(A[1][10]+A[2][10]) + A[3][10]  );
-        dSzdSy = dSzdSy + 1.0/6*( A[0][11] + 2*(A[1][11]+A[2][11]) + A[3][11]  );
-        
-        R.ss.push_back(  R.ss.back()+ds );
-        R.xx.push_back(  R.xx.back() + 1.0/6*(A[0][0] + 2*(A[1][0]+A[2][0]) + A[3][0])   );
-        R.yy.push_back(  R.yy.back() + 1.0/6*(A[0][1] + 2*(A[1][1]+A[2][1]) + A[3][1])   );
-        R.zz.push_back(  R.zz.back() + 1.0/6*(A[0][2] + 2*(A[1][2]+A[2][2]) + A[3][2])   );
-        
-        splint( prf.zz, atm, spl, R.zz.back(), ptAtm );
-        splintDeriv( prf.zz, atm, spl, R.zz.back(), ptAtmDer );
-        ray.vars( ptAtm, ptAtmDer, Sx, Sy, Sz );
-        ray.rk4( ds, dzdSx, dzdSy, dSzdSx, dSzdSy, A[0] );
-        
-        R.cc.push_back(  ptAtm[0] );
-        R.om.push_back( A[0][12] );
-        R.vr.push_back( A[0][13] );
-        R.tr.push_back( R.tr.back() + ds/A[0][13] );
-        R.rh.push_back( splint( prf.zz, prf.rh, splrh, R.zz.back() ) );
-        
-        dxds = A[0][0]/ds; 
-        dyds = A[0][1]/ds;
-        dzds = A[0][2]/ds;
-        R.ja.push_back( dxds*(dydSx*dzdSy-dydSy*dzdSx) + dxdSx*(dydSy*dzds-dyds*dzdSy) + dxdSy*(dyds*dzdSx-dydSx*dzds) ); // Jacobian
-        range = sqrt( pow( R.xx.back(),2 ) + pow( R.yy.back(), 2 ) ); 
-    }
+linray linearRay3DStrat( double ds, double theta, double phi, double zs, double xr, double yr, double zr, const profile &prf )
+{	
+    return linearRay3DStrat( ds, theta, phi, zs, xr, yr, zr, atmosphereSpline( prf ) );
+}
 
-    for( int i=0; i<3; i++ )
-        delete[] spl[i];
-    delete[] splrh;
+// The receiver enters only through its horizontal range, which bounds the march
+linray linearRay3DStrat( double ds, double theta, double phi, double zs, double xr, double yr, double zr, const StratifiedProfileSpline &atm )
+{	
+    return linearRay3DStrat( ds, theta, phi, zs, sqrt( xr*xr + yr*yr ), zr, atm );
+}
 
-    return R;
-}   
+// Sound speed and winds are splined with end point slopes from finite differences, the
+// density with natural end conditions, all on the altitude grid of the profile
+StratifiedProfileSpline atmosphereSpline( const profile &prf )
+{
+    StratifiedProfileSpline atm;
+    double dz, d1ep[2];
+    
+    dz = prf.zz[1]-prf.zz[0];
+    atm.init( prf.zz, 4 );
+    deriv1EndPoints( dz, prf.cc, d1ep );
+    atm.setQuantity( 0, prf.cc, d1ep[0], d1ep[1] );
+    deriv1EndPoints( dz, prf.wx, d1ep );
+    atm.setQuantity( 1, prf.wx, d1ep[0], d1ep[1] );
+    deriv1EndPoints( dz, prf.wy, d1ep );
+    atm.setQuantity( 2, prf.wy, d1ep[0], d1ep[1] );
+    atm.setQuantity( 3, prf.rh, 1.0e50, 1.0e50 );
+    return atm;
+}
 
-//----------------------------------------------------------------------------------------------
-// LINEAR RAY 3D PROPAGATION IN A STRATIFIED MEDIUM
-//----------------------------------------------------------------------------------------------
-linray linearRay3DStrat( double ds, double theta, double phi, double zs, double xr, double yr, double zr, profile prf )
+linray linearRay3DStrat( double ds, double theta, double phi, double zs, double rr, double zr, const StratifiedProfileSpline &atm )
 {	
     linray R;
-	  double zzprev, range, rr, dz, dxds, dyds, dzds, wx, wy, cef, cc, Sx, Sy, Sz, om;
+	  double zzprev, range, zmin, zmax, dxds, dyds, dzds, wx, wy, cef, cc, Sx, Sy, Sz, om;
     double dSzdSy, dzdSy, dxdSx, dxdSy, dydSx, dydSy, dSzdSx, dzdSx;
-    double d1ccep[2], d1wxep[2], d1wyep[2], A[4][14], ptAtm[3], ptAtmDer[3][2];
-    double *spl[3], *splrh;
-    vector< vector<double> > atm;
+    double A[4][14], ptAtm[4], ptAtmDer[4][2];   // c, wx, wy, rho and their z-derivatives
+    int hint = 0;
     
     if( theta <= 0.0)
     {   cerr << "Error: The subroutine \"linearRay3DStrat\" cannot handle a ray with initial" << endl;
@@ -175,23 +61,11 @@ linray linearRay3DStrat( double ds, double theta, double phi, double zs, double
         exit(1);
     }
     
-    dz = prf.zz[1]-prf.zz[0];
-    deriv1EndPoints( dz, prf.cc, d1ccep );
-    deriv1EndPoints( dz, prf.wx, d1wxep );
-    deriv1EndPoints( dz, prf.wy, d1wyep );
-    
-    spl[0] = spline( prf.zz, prf.cc, d1ccep[0], d1ccep[1] );
-    spl[1] = spline( prf.zz, prf.wx, d1wxep[0], d1wxep[1] );
-    spl[2] = spline( prf.zz, prf.wy, d1wyep[0], d1wyep[1] );
-    splrh = spline( prf.zz, prf.rh, 1.0e50, 1.0e50 );
-    
-    //Putting the vectors of sound speed, etc into a single matrix
-	atm.push_back( prf.cc );	
-	atm.push_back( prf.wx );
-	atm.push_back( prf.wy ); 	
+    zmin = atm.xmin();
+    zmax = atm.xmax();
 
   //Values at source location (xs = ys = 0; zs)
-  splint( prf.zz, atm, spl, zs, ptAtm );     //interpolating atmospheric profile
+  atm.evalDeriv( zs, hint, ptAtm, ptAtmDer );     //interpolating atmospheric profile
   
   cc = ptAtm[0];
   wx = ptAtm[1];
@@ -215,7 +89,7 @@ linray linearRay3DStrat( double ds, double theta, double phi, double zs, double
   R.xx.push_back( 0 );
   R.yy.push_back( 0 );
   R.zz.push_back( zs );
-  R.rh.push_back( splint( prf.zz, prf.rh, splrh, zs ) );
+  R.rh.push_back( ptAtm[3] );
   R.om.push_back( om );
   R.vr.push_back( sqrt(  ( pow(wx,2) + pow(wy,2) - pow(cc,2) )*pow(om,2) + 2*pow(cc,2)*om )/om );
   R.ja.push_back( 0 );
@@ -227,16 +101,12 @@ linray linearRay3DStrat( double ds, double theta, double phi, double zs, double
     
     // Marching along the ray path and solving the system of ode using the 4th order Runge-Kutta routine
     
-    splintDeriv( prf.zz, atm, spl, R.zz.back(), ptAtmDer );
-    
-    
-    
     odesys ray;
     ray.vars( ptAtm, ptAtmDer, Sx, Sy, Sz );
     ray.rk4( ds, dzdSx, dzdSy, dSzdSx, dSzdSy, A[0] );
 
     zzprev = zs;
-    range = rr = sqrt( xr*xr + yr*yr );
+    range = 0;
     int k;
     
     while( !( R.zz.back() <= zr && zzprev > zr ) && range <= rr+10000  )
@@ -245,23 +115,21 @@ linray linearRay3DStrat( double ds, double theta, double phi, double zs, double
         {   
             if(k==3) 
             {   zs = R.zz.back()+A[2][2];
-                if( zs < prf.zz[0] || zs > prf.zz.back() ) break;
-                splint( prf.zz, atm, spl, zs, ptAtm );
-                splintDeriv( prf.zz, atm, spl, zs, ptAtmDer );
+                if( zs < zmin || zs > zmax ) break;
+                atm.evalDeriv( zs, hint, ptAtm, ptAtmDer );
                 ray.vars( ptAtm, ptAtmDer, Sx, Sy, Sz+A[2][3] );
                 ray.rk4( ds, dzdSx+A[2][8], dzdSy+A[2][9], dSzdSx+A[2][10], dSzdSy+A[2][11], A[k] );
             }
             else
             {   zs = R.zz.back()+A[k-1][2]/2;
-                if( zs < prf.zz[0] || zs > prf.zz.back() ) break;
-                splint( prf.zz, atm, spl, zs, ptAtm );
-                splintDeriv( prf.zz, atm, spl, zs, ptAtmDer );
+                if( zs < zmin || zs > zmax ) break;
+                atm.evalDeriv( zs, hint, ptAtm, ptAtmDer );
                 ray.vars( ptAtm, ptAtmDer, Sx, Sy, Sz+A[k-1][3]/2 );
                 ray.rk4( ds, dzdSx+A[k-1][8]/2, dzdSy+A[k-1][9]/2, dSzdSx+A[k-1][10]/2, dSzdSy+A[k-1][11]/2, A[k] );
             }
         }
         
-        if( zs < prf.zz[0] || zs > prf.zz.back() ) break;
+        if( zs < zmin || zs > zmax ) break;
         zzprev = R.zz.back();
         
         Sz =         Sz + 1.0/6*( A[0][3]  +  2*(A[1][3]+A[2][3])  + A[3][3]  );
@@ -280,8 +148,7 @@ linray linearRay3DStrat( double ds, double theta, double phi, double zs, double
         R.yy.push_back(  R.yy.back() + 1.0/6*(A[0][1] + 2*(A[1][1]+A[2][1]) + A[3][1])   );
         R.zz.push_back(  R.zz.back() + 1.0/6*(A[0][2] + 2*(A[1][2]+A[2][2]) + A[3][2])   );
         
-        splint( prf.zz, atm, spl, R.zz.back(), ptAtm );
-        splintDeriv( prf.zz, atm, spl, R.zz.back(), ptAtmDer );
+        atm.evalDeriv( R.zz.back(), hint, ptAtm, ptAtmDer );
         ray.vars( ptAtm, ptAtmDer, Sx, Sy, Sz );
         ray.rk4( ds, dzdSx, dzdSy, dSzdSx, dSzdSy, A[0] );
         
@@ -289,7 +156,7 @@ linray linearRay3DStrat( double ds, double theta, double phi, double zs, double
         R.om.push_back( A[0][12] );
         R.vr.push_back( A[0][13] );
         R.tr.push_back( R.tr.back() + ds/A[0][13] );
-        R.rh.push_back( splint( prf.zz, prf.rh, splrh, R.zz.back() ) );
+        R.rh.push_back( ptAtm[3] );
         
         dxds = A[0][0]/ds; 
         dyds = A[0][1]/ds;
@@ -298,10 +165,6 @@ linray linearRay3DStrat( double ds, double theta, double phi, double zs, double
         range = sqrt( pow( R.xx.back(),2 ) + pow( R.yy.back(), 2 ) ); 
     }
 
-    for( int i=0; i<3; i++ )
-        delete[] spl[i];
-    delete[] splrh;
-
     return R;
 }   
 
@@ -604,7 +467,7 @@ profile profileReader(const char *filename)
 //----------------------------------------------------------------------------------------------
 // Numerical Derivative at the end points
 //----------------------------------------------------------------------------------------------
-void deriv1EndPoints( double dx, vector<double> yy, double *dydx )
+void deriv1EndPoints( double dx, const vector<double> &yy, double *dydx )
 {
     int N = yy.size();
     //dydx[0] = ( -11*yy[0] + 18*yy[1] - 9*yy[2] + 2*yy[3] )/(6*dx);
@@ -618,11 +481,11 @@ void deriv1EndPoints( double dx, vector<double> yy, double *dydx )
 // Spline Interpolation
 //----------------------------------------------------------------------------------------------
 
-double* spline( vector<double> x, vector<double> y, double y1p, double ynp )
+double* spline( const vector<double> &x, const vector<double> &y, double y1p, double ynp )
 {
     int N = x.size()-1;
     double h;
-    double alph[N+1], ell[N+1], zed[N+1], mu[N+1];
+    vector<double> alph(N+1), ell(N+1), zed(N+1), mu(N+1);   // long rays would overflow the stack
     double *coef = new double[N+1];
     
     h = x[1]-x[0];
@@ -663,7 +526,7 @@ double* spline( vector<double> x, vector<double> y, double y1p, double ynp )
     return coef;
 }
 
-double splint( vector<double> xx, vector<double> yy, double *coef, double x)
+double splint( const vector<double> &xx, const vector<double> &yy, double *coef, double x)
 {
     int k, klo, khi, n;
     double h, b, d;
@@ -696,7 +559,7 @@ double splint( vector<double> xx, vector<double> yy, double *coef, double x)
 }
 
 
-void splint( vector<double> xx, vector< vector<double> > yy, double **coef, double x, double *spl)
+void splint( const vector<double> &xx, const vector< vector<double> > &yy, double **coef, double x, double *spl)
 {
     int k, klo, khi, n, M;
     double h, b, d;
@@ -734,7 +597,7 @@ void splint( vector<double> xx, vector< vector<double> > yy, double **coef, doub
 
 
 
-void splintDeriv( vector<double> xx, vector< vector<double> > yy, double **coef, double x, double deriv[][2] )
+void splintDeriv( const vector<double> &xx, const vector< vector<double> > &yy, double **coef, double x, double deriv[][2] )
 {
     int k, klo, khi, M;
     double h, b, d;
@@ -770,10 +633,160 @@ void splintDeriv( vector<double> xx, vector< vector<double> > yy, double **coef,
     }
 }
 
+//----------------------------------------------------------------------------------------------
+// Spline of several quantities on a common abscissa
+//----------------------------------------------------------------------------------------------
+StratifiedProfileSpline::StratifiedProfileSpline()
+{   nn = 0;
+    mm = 0;
+}
+
+void StratifiedProfileSpline::init( const vector<double> &x, int nq )
+{
+    if( x.size() < 2 )
+    {   cerr << "Error: StratifiedProfileSpline needs at least two abscissa points." << endl;
+        exit(1);
+    }
+    for( unsigned int i=1; i<x.size(); i++ )
+    {   if( !( x[i] > x[i-1] ) )
+        {   cerr << "Error: StratifiedProfileSpline abscissa must be strictly increasing." << endl;
+            exit(1);
+        }
+    }
+    nn = x.size();
+    mm = nq;
+    xx = x;
+    cf.assign( 4*(nn-1)*mm, 0.0 );
+}
+
+// Same construction as spline() (end point slopes y1p, ynp; 1e50 or more for a natural end),
+// but without the assumption of an evenly spaced abscissa.  The polynomial coefficients
+// that splint() recomputes at every call are stored here instead.
+void StratifiedProfileSpline::setQuantity( int j, const vector<double> &y, double y1p, double ynp )
+{
+    int N = nn-1;
+    vector<double> h(N), alph(N+1), ell(N+1), zed(N+1), mu(N+1), c(N+1);
+    
+    if( j < 0 || j >= mm || (int)y.size() != nn )
+    {   cerr << "Error: Bad quantity passed to StratifiedProfileSpline::setQuantity." << endl;
+        exit(1);
+    }
+    
+    for( int i=0; i<N; i++ )
+        h[i] = xx[i+1]-xx[i];
+    
+    if( y1p>0.99e50 )
+    {   ell[0] = 1;
+        mu[0] = zed[0] = 0;
+    }
+    else
+    {   alph[0] = 3*( y[1]-y[0] )/h[0] - 3*y1p;
+        ell[0] = 2*h[0];
+        mu[0] = 0.5;
+        zed[0] = alph[0]/ell[0];
+    }
+    
+    for( int i=1; i<N; i++ )
+    {   alph[i] = 3/h[i]*( y[i+1]-y[i] ) - 3/h[i-1]*( y[i]-y[i-1] );
+        ell[i] = 2*( xx[i+1]-xx[i-1] ) - h[i-1]*mu[i-1];
+        mu[i] = h[i]/ell[i];
+        zed[i] = ( alph[i] - h[i-1]*zed[i-1] )/ell[i];
+    }
+    
+    if( ynp>0.99e50 )
+    {   ell[N] = 1;
+        zed[N] = 0;
+    }
+    else
+    {   alph[N] = 3*ynp - 3*( y[N]-y[N-1] )/h[N-1];
+        ell[N] = h[N-1]*( 2-mu[N-1] );
+        zed[N] = ( alph[N] - h[N-1]*zed[N-1] )/ell[N];
+    }
+    
+    c[N] = zed[N];
+    for( int i=N-1; i>=0; i-- )
+        c[i] = zed[i] - mu[i]*c[i+1];
+    
+    for( int i=0; i<N; i++ )
+    {   double *a = &cf[ 4*(i*mm+j) ];
+        a[0] = y[i];
+        a[1] = ( y[i+1]-y[i] )/h[i] - h[i]*( c[i+1] + 2*c[i] )/3;
+        a[2] = c[i];
+        a[3] = ( c[i+1]-c[i] )/( 3*h[i] );
+    }
+}
+
+// Returns the interval i with xx[i] <= x < xx[i+1] (the last interval for x = xx.back()).
+// Successive points along a ray are close together, so the hinted interval and its
+// neighbours are tried before bisecting.
+int StratifiedProfileSpline::bracket( double x, int &hint ) const
+{
+    int k, klo, khi;
+    
+    if( x < xx.front() || x > xx.back() )
+    {   cerr << "Error: StratifiedProfileSpline ... Interpolating point is outside of interval." << endl;
+        printf("x is %.2f while the interval is [%.2f, %.2f]\n", x, xx.front(), xx.back() );
+        exit(1);
+    }
+    
+    if( hint < 0 || hint > nn-2 ) hint = 0;
+    if( x >= xx[hint] )
+    {   if( hint == nn-2 || x < xx[hint+1] ) return hint;
+        if( hint+1 == nn-2 || x < xx[hint+2] ) return ++hint;
+    }
+    else if( x >= xx[hint-1] ) return --hint;
+    
+    klo = 0;
+    khi = nn-1;
+    while (khi-klo > 1) {
+        k=(khi+klo) >> 1;
+        if (xx[k] > x) khi=k;
+        else klo=k;
+    }
+    hint = klo;
+    return klo;
+}
+
+void StratifiedProfileSpline::eval( double x, int &hint, double *val ) const
+{
+    int i = bracket( x, hint );
+    double dx = x - xx[i];
+    const double *a = &cf[ 4*i*mm ];
+    
+    for( int j=0; j<mm; j++, a+=4 )
+        val[j] = a[0] + dx*( a[1] + dx*( a[2] + dx*a[3] ) );
+}
+
+void StratifiedProfileSpline::evalDeriv( double x, int &hint, double *val, double deriv[][2] ) const
+{
+    int i = bracket( x, hint );
+    double dx = x - xx[i];
+    const double *a = &cf[ 4*i*mm ];
+    
+    for( int j=0; j<mm; j++, a+=4 )
+    {   val[j] = a[0] + dx*( a[1] + dx*( a[2] + dx*a[3] ) );
+        deriv[j][0] = a[1] + dx*( 2*a[2] + 3*dx*a[3] );    //first derivative
+        deriv[j][1] = 2*a[2] + 6*dx*a[3];                  //second derivative
+    }
+}
+
+int StratifiedProfileSpline::quantities() const
+{   return mm;
+}
+
+double StratifiedProfileSpline::xmin() const
+{   return xx.front();
+}
+
+double StratifiedProfileSpline::xmax() const
+{   return xx.back();
+}
+
 // searching for an eigenray
-linray eigenray( double ds, double theta, double phi, double dth, double dph, double zs, double xr, double yr, double zr, double tol, profile prf )
+linray eigenray( double ds, double theta, double phi, double dth, double dph, double zs, double xr, double yr, double zr, double tol, const profile &prf )
 {
     linray eiray,ray;
+    StratifiedProfileSpline atm = atmosphereSpline( prf );   // shared by all trial rays
     double thMid, phMid, dist_sr, dist2, th[3], ph[3];
     int solfnd, repmx, rep;
 
@@ -796,7 +809,7 @@ linray eigenray( double ds, double theta, double phi, double dth, double dph, do
         {   for( int j=0; j<3; j++ )
             {   
                 //printf("%.3f %.3f\n", 180/PI*th[j], 180/PI*ph[i]) ;
-                ray = linearRay3DStrat( ds, th[j], ph[i], zs, xr, yr, zr, prf ); 
+                ray = linearRay3DStrat( ds, th[j], ph[i], zs, xr, yr, zr, atm ); 
                 dist2 = sqrt( pow(ray.xx.back()-xr,2) + pow(ray.yy.back()-yr,2) + pow(ray.zz.back()-zr,2) );
                 if (dist2 < dist_sr)
                 {   dist_sr = dist2;
@@ -18,15 +18,15 @@
 
 using namespace std;
 
-double* spline( vector<double>, vector<double>, double, double );
+double* spline( const vector<double>&, const vector<double>&, double, double );
 
-double splint( vector<double>, vector<double>, double*, double x);
+double splint( const vector<double>&, const vector<double>&, double*, double x);
 
-void splint( vector<double>, vector< vector<double> >, double**, double, double*);
+void splint( const vector<double>&, const vector< vector<double> >&, double**, double, double*);
 
-void splintDeriv( vector<double>, vector< vector<double> >, double**, double, double [][2] );
+void splintDeriv( const vector<double>&, const vector< vector<double> >&, double**, double, double [][2] );
 
-void deriv1EndPoints( double, vector<double>, double* );
+void deriv1EndPoints( double, const vector<double>&, double* );
 
 vector<double> deriv1( double, vector<double> );
 
@@ -42,6 +42,35 @@ struct profile
 {	vector<double> zz, cc, wx, wy, rh;
 };
 
+
+//----------------------------------------------------------------------------------------------
+// Cubic splines of several quantities tabulated on one common abscissa (the altitudes of a
+// profile, or the arc length along a ray).  The coefficients are computed once, and are
+// stored interval by interval so that all quantities and their derivatives are evaluated
+// after a single interval search.  The search starts from an interval hint owned by the
+// caller; evaluation does not modify the object, so one spline may be shared by any number
+// of rays, each with its own hint.
+//----------------------------------------------------------------------------------------------
+class StratifiedProfileSpline
+{
+    int nn, mm;             // number of abscissa points, number of quantities
+    vector<double> xx;
+    vector<double> cf;      // cf[4*(i*mm+j)+k] = k'th order coefficient of quantity j on interval i
+    
+public:
+    StratifiedProfileSpline();
+    void init( const vector<double>&, int );
+    void setQuantity( int, const vector<double>&, double, double );
+    int bracket( double, int& ) const;
+    void eval( double, int&, double* ) const;
+    void evalDeriv( double, int&, double*, double [][2] ) const;
+    int quantities() const;
+    double xmin() const;
+    double xmax() const;
+};
+
+StratifiedProfileSpline atmosphereSpline( const profile& );
+
 profile profileReader(const char *);
 
 profile profileReader2(const char *);
@@ -54,9 +83,13 @@ struct linray{
     // rsd = dist_sr; i.e. distance source receiver?
 };
 
-linray linearRay3DStrat( double, double, double, double, double, double, double, profile );
+linray linearRay3DStrat( double, double, double, double, double, double, double, const profile& );
+
+linray linearRay3DStrat( double, double, double, double, double, double, const profile& );
+
+linray linearRay3DStrat( double, double, double, double, double, double, double, const StratifiedProfileSpline& );
 
-linray linearRay3DStrat( double, double, double, double, double, double, profile );
+linray linearRay3DStrat( double, double, double, double, double, double, const StratifiedProfileSpline& );
 
 
 // DV
@@ -75,6 +108,6 @@ public:
     void rk4( double, double, double, double, double, double* );
 };
 
-linray eigenray( double, double, double, double, double, double, double, double, double, double, profile );
+linray eigenray( double, double, double, double, double, double, double, double, double, double, const profile& );
 
 #endif
@@ -15,6 +15,8 @@
 #include <gsl/gsl_interp.h>
 #include <gsl/gsl_spline.h>
 
+#include <algorithm>
+
 #include "linearRay3DStrat.h"
 #include "nonlinearRay.h"
 
@@ -25,22 +27,88 @@ const double STEP_MAX = 100.0;   //maximum step size allowed
 const int NUMPTS      = pow(2.0,12);  // number of poins in the time/frequency domains to save
 
 
+//----------------------------------------------------------------------------------------------
+// Saving the ray parameters and the (subsampled) waveform at one point of the march
+//----------------------------------------------------------------------------------------------
+static void streamStep( FILE *stream, double ss, double ps, double *uu, int skip, int npts )
+{
+  fprintf( stream, "%.5E", ss );
+  for( int i=0; i < npts; i++ )
+      fprintf( stream, "%15.5E", uu[i*skip]/ps );
+  fprintf( stream, "\n" );
+}
+
+static void storeStep( nonray &NR, raypathParams &RP, double sb, double ss, double *uu, int skip, FILE *stream )
+{
+  NR.xx.push_back( RP.xx );
+  NR.yy.push_back( RP.yy );
+  NR.zz.push_back( RP.zz );
+  NR.cc.push_back( RP.cc );
+  NR.tr.push_back( RP.tr );
+  NR.ps.push_back( RP.ps );
+  NR.sb.push_back( sb );
+  NR.ss.push_back( ss ); // DV
+  NR.uu.push_back( uu, skip ); // store entire waveform at this distance
+  if( stream != NULL ) streamStep( stream, ss, RP.ps, uu, skip, NR.tt.size() );
+}
+
+// keeping the saved points 0, 2, 4, ... 
+static void decimateSteps( vector<double> &v )
+{
+  unsigned int k = 0;
+  for( unsigned int i=0; i < v.size(); i+=2 )
+      v[k++] = v[i];
+  v.resize( k );
+}
+
+static void decimateSteps( nonray &NR )
+{
+  decimateSteps( NR.xx );
+  decimateSteps( NR.yy );
+  decimateSteps( NR.zz );
+  decimateSteps( NR.cc );
+  decimateSteps( NR.tr );
+  decimateSteps( NR.ps );
+  decimateSteps( NR.sb );
+  decimateSteps( NR.ss );
+  NR.uu.decimate();
+}
+
+
 //==============================================================================================
 //Main Function
 //==============================================================================================
-nonray nonlinearRay( int nn, double ssInit, attRed attRed, linray LR, waveform wf )
+//
+// maxsaves bounds the number of waveforms kept in NR.uu (0: enough for one
+// every ~0.5 km of the ray).  If streamfile is given, every saved waveform is
+// also written to it as soon as it is computed: the first line holds the
+// reduced times (after a leading 0), each following line the ray path length
+// and the pressure waveform [Pa] at that point.
+//
+nonray nonlinearRay( int nn, double ssInit, attRed attRed, linray LR, waveform wf, int maxsaves, const char *streamfile )
+{
+  raypathParams RP( LR ); // sets beta = 1+(GAMMA-1)/2 and the ray path splines
+  return nonlinearRay( nn, ssInit, attRed, LR, RP, wf, maxsaves, streamfile );
+}
+
+// Same, with the ray path parameters of LR already set up, so that several
+// waveforms can be propagated along one ray without re-splining it
+nonray nonlinearRay( int nn, double ssInit, attRed attRed, const linray &LR, const raypathParams &RP0, waveform wf, int maxsaves, const char *streamfile )
 {
   nonray NR;
-  int    skip, nsc;
-  double dop, scbt, ffmx, pmax, umax, ss, ds, ssMem, atfc, dzta;
-  double scbc, tt[nn], pp[nn], uu[nn], attn[nn/2+1], ff[nn/2+1];
-  vector<double> sc, uhold;
+  int    skip, nsc, saveEvery;
+  double dop, scbt, ffmx, pmax, umax, ss, ds, ssMem, atfc, dzta, dsnl, scnl;
+  double scbc;
+  vector<double> sc;
+  FILE *stream = NULL;
 
   //------------------------------------------------------------------------
   // Find caustics if they exist
   sc  = zeros( LR.ss, LR.ja );
   nsc = sc.size();
-  double ssup[nsc], sslo[nsc], slope[nsc];
+  nonrayWorkspace ws( nn, nsc );
+  double *tt = ws.tt, *pp = ws.pp, *uu = ws.uu, *attn = ws.attn, *ff = ws.ff;
+  double *ssup = ws.ssup, *sslo = ws.sslo, *slope = ws.slope;
   causticParams( sc, LR, ssup, sslo, slope ); // find J'=slope - at points where J->0
 
   //------------------------------------------------------------------------
@@ -80,7 +148,7 @@ nonray nonlinearRay( int nn, double ssInit, attRed attRed, linray LR, waveform w
   //printf("number of caustics=%d\n", nsc);
 
   // construct an instance RP of class raypathParams
-  raypathParams RP( LR ); // sets beta = 1+(GAMMA-1)/2, spline accelerators, copies LR.xx,yy, ... to RP
+  raypathParams RP( RP0 ); // copy of the prepared splines; RP keeps the state of this propagation
   RP.normalizingFactor( pmax, ssInit); // calls physicalParams(ssinit) and 
                                        // interpolates xx, om, vr... at ssInit; 
                                        // calculates initial normalizing factor NN
@@ -105,26 +173,32 @@ nonray nonlinearRay( int nn, double ssInit, attRed attRed, linray LR, waveform w
                                // (nn/2+1) positive frequencies 0:df:Nyquist
                                // cf and fltr are set here as part of spectralParams class data
   
-  // accumulate all inititial quantities in NR
-  NR.xx.push_back( RP.xx );
-  NR.yy.push_back( RP.yy );
-  NR.zz.push_back( RP.zz );
-  NR.cc.push_back( RP.cc );
-  NR.tr.push_back( RP.tr );
-  NR.ps.push_back( RP.ps );
-  NR.sb.push_back( scbt*1 ); // initial scaled beta i.e. beta tilde in eq 4 
-  NR.ss.push_back( ssInit ); // DV
-  
-  //cout << "RP.ps = " << RP.ps << endl;
-  
   // store every 'skip' point for a total of NUMPTS
   skip = nn/NUMPTS;
-  for(int i=0; i < nn; i+=skip) // store subsampled uu and tt in NR.uu, NR.tt
-  {	
-    uhold.push_back( uu[i] );
+  for(int i=0; i < nn; i+=skip) // store subsampled tt in NR.tt
     NR.tt.push_back( tt[i] );
+  
+  // one waveform every ~0.5 km (saveEvery meters), plus the first and the last
+  saveEvery = 500;
+  if( maxsaves <= 0 ) maxsaves = int( ( LR.ss.back()-ssInit )/saveEvery ) + 2;
+  if( maxsaves < 2 ) maxsaves = 2;
+  NR.uu.reserve( NR.tt.size(), maxsaves );
+  
+  if( streamfile != NULL )
+  {   stream = fopen( streamfile, "w" );
+      if( stream == NULL )
+      {   cerr << "Error: File " << streamfile << " could not be opened!" << endl;
+          exit(1);
+      }
+      fprintf( stream, "%.5E", 0.0 );
+      for( unsigned int i=0; i < NR.tt.size(); i++ )
+          fprintf( stream, "%15.5E", NR.tt[i] );
+      fprintf( stream, "\n" );
   }
-  NR.uu.push_back( uhold ); 
+  
+  // accumulate all inititial quantities in NR
+  // initial scaled beta i.e. beta tilde in eq 4 
+  storeStep( NR, RP, scbt*1, ssInit, uu, skip, stream );
   
 //------------------------------------------------------------------------
   //Propagate by 1 step, integrate using the first-order Euler method
@@ -173,20 +247,18 @@ nonray nonlinearRay( int nn, double ssInit, attRed attRed, linray LR, waveform w
    
   while( ss+ds <= LR.ss.back() )  {	
     // Saving/storing needed parameters every ~0.5 km of ray path		
+    // (all of them go to the stream; NR keeps every saveEvery meters)
     if( int(ss)%500 < int(ssMem)%500 )
     {	
-        NR.xx.push_back( RP.xx );
-        NR.yy.push_back( RP.yy );
-        NR.zz.push_back( RP.zz );
-        NR.cc.push_back( RP.cc );
-        NR.tr.push_back( RP.tr );
-        NR.ps.push_back( RP.ps );
-        NR.sb.push_back( scbt*umax ); // note scbt*umax
-        NR.ss.push_back( ss );        // DV
-        uhold.clear();
-        for(int i=0; i < nn; i+=skip) 
-            uhold.push_back( uu[i] );
-        NR.uu.push_back( uhold ); // store entire waveform at this distance
+      if( int(ss)%saveEvery < int(ssMem)%saveEvery )
+      {   if( NR.uu.full() )    // keep every other waveform and save half as often
+          {   decimateSteps( NR );
+              saveEvery = 2*saveEvery;
+          }
+          storeStep( NR, RP, scbt*umax, ss, uu, skip, stream ); // note scbt*umax
+      }
+      else if( stream != NULL )
+          streamStep( stream, ss, RP.ps, uu, skip, NR.tt.size() );
             
       if (save_U2) {
       cout << "in nonlinearRay() after integEulerMethod(): saving  U2\n";
@@ -203,7 +275,8 @@ nonray nonlinearRay( int nn, double ssInit, attRed attRed, linray LR, waveform w
     {	
         ds = 1.0/( 2.0*PI*ffmx * scbt * umax ); // variable ds size 
         if( ds > STEP_MAX )	ds = STEP_MAX;
-        SP.integLeapfrog( ds, scbt );  // U3 = U1 + i*ds*w_n*scbt*Usq - see eq after eq. 12 in GJI article
+        dsnl = ds;     // U3 = U1 + i*ds*w_n*scbt*Usq - see eq after eq. 12 in GJI article
+        scnl = scbt;   // (taken below, together with the attenuation)
     }
     else  // around caustic; we obtain a transformed Burger's equation free of singularity
     {			
@@ -215,7 +288,8 @@ nonray nonlinearRay( int nn, double ssInit, attRed attRed, linray LR, waveform w
         }
         scbc = RP.scaledBetaCaustic( slope[j] ); // beta_caustic = beta_scaled * sqrt(J/J'); here slope is |J'|
         ds = stepSizeCaustic( ffmx, scbc, umax, sc[j], ss, dzta );
-        SP.integLeapfrog( dzta, scbc ); // leapfrog the transformed Burger's eq. 
+        dsnl = dzta;   // leapfrog the transformed Burger's eq. 
+        scnl = scbc;
         
         // DV
         if ( (j+1)<sc.size() ) { // increment the zero-based caustic counter j 
@@ -234,7 +308,7 @@ nonray nonlinearRay( int nn, double ssInit, attRed attRed, linray LR, waveform w
     if( RP.zz < attRed.zzRed ) atfc = 1;
     else atfc = attRed.atfac;
     atmAttn( nn/2+1, RP.zz*1e-3, RP.rh, RP.cc, ff, attn );
-    SP.applyAttn( ds, atfc, dop, attn ); // Update U1,U2,U3, and apply fltr
+    SP.leapfrogAttn( dsnl, scnl, ds, atfc, dop, attn ); // leapfrog, then update U1,U2,U3, and apply fltr
     SP.FFT( uu, umax );  // obtain uu = ifft(U3) and Usq=fft(u^2); also umax is returned
 
     // Displaying status
@@ -256,26 +330,9 @@ nonray nonlinearRay( int nn, double ssInit, attRed attRed, linray LR, waveform w
     
     
   
-  NR.xx.push_back( RP.xx );
-  NR.yy.push_back( RP.yy );
-  NR.zz.push_back( RP.zz );
-  NR.cc.push_back( RP.cc );
-  NR.tr.push_back( RP.tr );
-  NR.ps.push_back( RP.ps );
-  NR.sb.push_back( scbt*umax );
-  NR.ss.push_back( ss ); // DV
-  
-  //printf("NR.xx.back = %g\n", NR.xx.back());
-  //printf("NR.ss.back = %g\n", NR.ss.back());
-  
-  
-  // store in NR the last waveform and its spectrum
-  uhold.clear();
-	for( int i=0; i < nn; i+=skip ) 
-	{	
-	  uhold.push_back( uu[i] );
-  }
-	NR.uu.push_back( uhold );  // store this last time step (uhold) into matrix NR.uu
+  // store in NR the last waveform (room for it is always left) and its spectrum
+  storeStep( NR, RP, scbt*umax, ss, uu, skip, stream );
+  if( stream != NULL ) fclose( stream );
 	
   for( int i=0; i<nn/2+1; i++ )
   {   
@@ -687,6 +744,91 @@ double stepSizeCaustic( double ffmx, double scbt, double umax, double sc, double
 
 
 
+// -------------------------------------------------------------------------------
+// Workspace of the nonlinear march
+// -------------------------------------------------------------------------------
+nonrayWorkspace::nonrayWorkspace( int N, int nsc )
+{
+  nn = N;
+  if( nsc < 1 ) nsc = 1;
+  tt    = (double *) fftw_malloc( nn*sizeof(double) );
+  pp    = (double *) fftw_malloc( nn*sizeof(double) );
+  uu    = (double *) fftw_malloc( nn*sizeof(double) );
+  attn  = (double *) fftw_malloc( (nn/2+1)*sizeof(double) );
+  ff    = (double *) fftw_malloc( (nn/2+1)*sizeof(double) );
+  ssup  = new double[nsc];
+  sslo  = new double[nsc];
+  slope = new double[nsc];
+  if( tt == NULL || pp == NULL || uu == NULL || attn == NULL || ff == NULL )
+  {   cerr << "Error: Could not allocate the waveform buffers for " << nn << " points." << endl;
+      exit(1);
+  }
+}
+
+nonrayWorkspace::~nonrayWorkspace()
+{   fftw_free( tt );
+    fftw_free( pp );
+    fftw_free( uu );
+    fftw_free( attn );
+    fftw_free( ff );
+    delete [] ssup;
+    delete [] sslo;
+    delete [] slope;
+}
+
+
+// -------------------------------------------------------------------------------
+// Waveform history
+// -------------------------------------------------------------------------------
+waveformHistory::waveformHistory()
+{   npts = cap = nrows = 0;
+}
+
+// room for rows waveforms of N samples, plus one for the final waveform
+void waveformHistory::reserve( int N, int rows )
+{
+    npts  = N;
+    cap   = rows;
+    nrows = 0;
+    data.assign( (size_t)( cap+1 )*npts, 0.0 );
+}
+
+bool waveformHistory::full() const
+{   return nrows >= cap;
+}
+
+void waveformHistory::push_back( const double *u, int skip )
+{
+    if( nrows > cap )
+    {   cerr << "Error: waveformHistory::push_back ... the history is full." << endl;
+        exit(1);
+    }
+    double *row = &data[ (size_t)nrows*npts ];
+    for( int i=0; i<npts; i++ )
+        row[i] = u[i*skip];
+    nrows++;
+}
+
+void waveformHistory::decimate()
+{
+    int k = 0;
+    for( int j=0; j<nrows; j+=2, k++ )
+    {   if( k != j )
+            copy( data.begin() + (size_t)j*npts, data.begin() + (size_t)(j+1)*npts,
+                  data.begin() + (size_t)k*npts );
+    }
+    nrows = k;
+}
+
+int waveformHistory::size() const
+{   return nrows;
+}
+
+const double* waveformHistory::operator[]( int j ) const
+{   return &data[ (size_t)j*npts ];
+}
+
+
 // -------------------------------------------------------------------------------
 // Declaration of the contructor and destructor for the class spectralParams
 // -------------------------------------------------------------------------------
@@ -694,28 +836,45 @@ double stepSizeCaustic( double ffmx, double scbt, double umax, double sc, double
 spectralParams::spectralParams( int N )
 {   
   nn = N;
-  usq     = new double[nn];
   cf      = new double[nn/2+1];
   fltr    = new double[nn/2+1];
   attnEf1 = new double[nn/2+1];
   attnEf2 = new double[nn/2+1];
-    
-	U1  = new fftw_complex[nn/2+1];
-	U2  = new fftw_complex[nn/2+1];
-	U3  = new fftw_complex[nn/2+1];
-	Usq = new fftw_complex[nn/2+1];
+  taper   = new double[nn/2+1];
+  
+  // buffers handed to FFTW are aligned so that the plans below can be
+  // re-executed on any of them
+  usq = (double *) fftw_malloc( nn*sizeof(double) );
+  ur  = (double *) fftw_malloc( nn*sizeof(double) );
+	U1  = (fftw_complex *) fftw_malloc( (nn/2+1)*sizeof(fftw_complex) );
+	U2  = (fftw_complex *) fftw_malloc( (nn/2+1)*sizeof(fftw_complex) );
+	U3  = (fftw_complex *) fftw_malloc( (nn/2+1)*sizeof(fftw_complex) );
+	Usq = (fftw_complex *) fftw_malloc( (nn/2+1)*sizeof(fftw_complex) );
+	
+	// Measuring overwrites the arrays, which hold no data yet.  The c2r
+	// transform destroys its input (U3); U3 is always rebuilt before the next use.
+	planFor = fftw_plan_dft_r2c_1d( nn, usq, Usq, FFTW_MEASURE );
+	planBac = fftw_plan_dft_c2r_1d( nn, U3, ur, FFTW_MEASURE );
+	
+	// high frequency taper applied with the attenuation at every step  // DV
+	for( int i=0; i< nn/2+1; i++ )
+	    taper[i] = sin(PI*(nn/2-i)/(nn));
 }
 
 spectralParams::~spectralParams()
-{   delete [] usq;
+{   fftw_destroy_plan( planFor );
+    fftw_destroy_plan( planBac );
     delete [] cf;
     delete [] fltr;
     delete [] attnEf1;
     delete [] attnEf2;
-    delete [] U1;
-    delete [] U2;
-    delete [] U3;
-    delete [] Usq;
+    delete [] taper;
+    fftw_free( usq );
+    fftw_free( ur );
+    fftw_free( U1 );
+    fftw_free( U2 );
+    fftw_free( U3 );
+    fftw_free( Usq );
 }
 
 
@@ -797,18 +956,14 @@ void spectralParams::frequency( double ffmx, double *ff )
 // -------------------------------------------------------------------------------
 void spectralParams::initFFT( double ps, double *pp, double *u )
 {
-  fftw_plan planFor, psq;
 	for(int i=0; i < nn; i++) 
 	{ 	
 	    u[i]   = pp[i]*ps;    // obtain initial u - see eq. 2 in GJI paper
-      usq[i] = pow(u[i],2);	// u^2
+	    ur[i]  = u[i];
+      usq[i] = u[i]*u[i];	  // u^2
 	}
-	planFor = fftw_plan_dft_r2c_1d(nn,u,U1,FFTW_ESTIMATE); // obtain U1; it's data in class spectralParams
-	fftw_execute(planFor);
-	psq = fftw_plan_dft_r2c_1d(nn,usq,Usq,FFTW_ESTIMATE);  // obtain Usq
-	fftw_execute(psq);
-  fftw_destroy_plan( planFor );
-  fftw_destroy_plan( psq );
+	fftw_execute_dft_r2c( planFor, ur, U1 );  // obtain U1; it's data in class spectralParams
+	fftw_execute_dft_r2c( planFor, usq, Usq ); // obtain Usq
 }
 
 
@@ -904,8 +1059,9 @@ void spectralParams::applyAttn( double ds, double atfc, double dop, double *attn
         attnEf2[i] = atfc * attn[i]*fltr[i]*dop;
         //U3[i][0] = U3[i][0]*exp(- (attnEf1[i] + attnEf2[i])*ds/2  );
         //U3[i][1] = U3[i][1]*exp(- (attnEf1[i] + attnEf2[i])*ds/2  );
-        U3[i][0] = U3[i][0]*exp(- (attnEf1[i] + attnEf2[i])*ds/2  )*sin(PI*(nn/2-i)/(nn)); // DV
-        U3[i][1] = U3[i][1]*exp(- (attnEf1[i] + attnEf2[i])*ds/2  )*sin(PI*(nn/2-i)/(nn)); // DV       
+        double fac = exp(- (attnEf1[i] + attnEf2[i])*ds/2  )*taper[i]; // DV
+        U3[i][0] = U3[i][0]*fac;
+        U3[i][1] = U3[i][1]*fac;
         U1[i][0] = U2[i][0];
         U1[i][1] = U2[i][1];
         U2[i][0] = U3[i][0];				
@@ -914,33 +1070,53 @@ void spectralParams::applyAttn( double ds, double atfc, double dop, double *attn
 }
 
 
+// -------------------------------------------------------------------------------
+// Leapfrog step and attenuation in a single pass over the spectrum
+// -------------------------------------------------------------------------------
+void spectralParams::leapfrogAttn( double dsnl, double scbt, double ds, double atfc, double dop, double *attn )
+{
+    // Same as integLeapfrog( dsnl, scbt ) followed by applyAttn( ds, atfc, dop, attn ).
+    // Usq and U1 are not changed in between, so the leapfrog may wait until the
+    // attenuation at the new point is known.
+    double a = 2*dsnl*scbt;
+    double b = ds/2;
+    for( int i=0; i< nn/2+1; i++ )
+    {   double fac, re, im;
+        attnEf1[i] = attnEf2[i];
+        attnEf2[i] = atfc * attn[i]*fltr[i]*dop;
+        fac = exp(- (attnEf1[i] + attnEf2[i])*b )*taper[i];
+        re = ( U1[i][0] - a*cf[i]*Usq[i][1] )*fac;
+        im = ( U1[i][1] + a*cf[i]*Usq[i][0] )*fac;
+        U1[i][0] = U2[i][0];
+        U1[i][1] = U2[i][1];
+        U2[i][0] = U3[i][0] = re;
+        U2[i][1] = U3[i][1] = im;
+    }
+}
+
+
 // -------------------------------------------------------------------------------
 // Fourier Transform
 // -------------------------------------------------------------------------------
 void spectralParams::FFT( double *u, double &umax )
 {   
     // obtain u from U3; set u^2 and U^2; update umax (passed by reference here)
-    fftw_plan planBac, planFor;
-    planBac = fftw_plan_dft_c2r_1d(nn,U3,u,FFTW_ESTIMATE); // obtain u from U3
-    fftw_execute( planBac );	
+    fftw_execute_dft_c2r( planBac, U3, ur ); // obtain u from U3 (U3 is overwritten)
 	
     umax = 0;
     for(int i=0; i < nn; i++) 
     { 	
-        u[i] = u[i]/nn;               // proper normalization for u from fft algorithm
-        usq[i] = pow(u[i],2);         // u^2
+        u[i] = ur[i]/nn;              // proper normalization for u from fft algorithm
+        usq[i] = u[i]*u[i];           // u^2
 		    if( u[i] > umax ) umax = u[i];
-        if( u[i] >= 5.0 )
-        {	cout << "\nError! Numerical instability is detected." << endl;
-            cout << "Please increase the frequency range.\n" << endl;
-            exit(1);
-        }
+    }
+    if( umax >= 5.0 )
+    {	cout << "\nError! Numerical instability is detected." << endl;
+        cout << "Please increase the frequency range.\n" << endl;
+        exit(1);
     }
     
-    planFor = fftw_plan_dft_r2c_1d(nn,usq,Usq,FFTW_ESTIMATE); // obtain Usq = fft(u^2)
-    fftw_execute( planFor );
-    fftw_destroy_plan( planBac );
-    fftw_destroy_plan( planFor );
+    fftw_execute_dft_r2c( planFor, usq, Usq ); // obtain Usq = fft(u^2)
 }
 
 
@@ -972,104 +1148,36 @@ void spectralParams::hilbert()
 // -----------------------------------------------------------------------------
 raypathParams::raypathParams( linray LR )
 {	
-
-  //printf("In raypathParams( linray LRinput )\n");
-
   beta = 1+(GAMMA-1)/2; // set beta
 
-  // do spline interpolation 
-  //gsl_interp_accel *acc_;
-  //gsl_spline *splin[9];
-  
-  acc_ = gsl_interp_accel_alloc();
-
-  for (int j=0; j<9; j++) {
-    splin[j] = gsl_spline_alloc(gsl_interp_cspline, LR.ss.size());
-    //printf("splin[%d]=%p\n", j, splin[j]);
-  }
-  
-  gsl_spline_init(splin[0], LR.ss.data(), LR.xx.data(), LR.ss.size());
-  gsl_spline_init(splin[1], LR.ss.data(), LR.yy.data(), LR.ss.size());
-  gsl_spline_init(splin[2], LR.ss.data(), LR.zz.data(), LR.ss.size());
-  gsl_spline_init(splin[3], LR.ss.data(), LR.cc.data(), LR.ss.size());
-  gsl_spline_init(splin[4], LR.ss.data(), LR.vr.data(), LR.ss.size());
-  gsl_spline_init(splin[5], LR.ss.data(), LR.om.data(), LR.ss.size());
-  gsl_spline_init(splin[6], LR.ss.data(), LR.rh.data(), LR.ss.size());
-  gsl_spline_init(splin[7], LR.ss.data(), LR.ja.data(), LR.ss.size());
-  gsl_spline_init(splin[8], LR.ss.data(), LR.tr.data(), LR.ss.size());
-
-  //for (int j=1; j<9; j++) {
-  //  gsl_spline_free(splin);
-  //}
-  //gsl_interp_accel_free(acc_);
-
-	nlp.push_back( LR.xx );
-	nlp.push_back( LR.yy );
-	nlp.push_back( LR.zz );
-	nlp.push_back( LR.cc );
-	nlp.push_back( LR.vr );
-	nlp.push_back( LR.om );
-	nlp.push_back( LR.rh );
-	nlp.push_back( LR.ja );
-  nlp.push_back( LR.tr );
-  
-  //printf("LR.xx.size=%d   last elem=%g\n", LR.xx.size(), LR.xx.back());
-  //exit(1);
-  //printf("At end of raypathParams( linray LRinput )\n");  
+  // natural cubic splines of the ray quantities over the arc length, computed once
+  hint = 0;
+  nlp.init( LR.ss, 9 );
+  nlp.setQuantity( 0, LR.xx, 1e50, 1e50 );
+  nlp.setQuantity( 1, LR.yy, 1e50, 1e50 );
+  nlp.setQuantity( 2, LR.zz, 1e50, 1e50 );
+  nlp.setQuantity( 3, LR.cc, 1e50, 1e50 );
+  nlp.setQuantity( 4, LR.vr, 1e50, 1e50 );
+  nlp.setQuantity( 5, LR.om, 1e50, 1e50 );
+  nlp.setQuantity( 6, LR.rh, 1e50, 1e50 );
+  nlp.setQuantity( 7, LR.ja, 1e50, 1e50 );
+  nlp.setQuantity( 8, LR.tr, 1e50, 1e50 );
 }
 
 
 // DV
 void raypathParams::physicalParams( double ss )
 {
-
-  //printf("In physicalParams( double ss ): ss=%g\n", ss);
-  //printf("beta=%g\n", beta);
-
-
-  // do spline interpolation 
-  //gsl_interp_accel *acc_;
-  //acc_ = gsl_interp_accel_alloc();
-  
-  //printf("acc_=%p\n", acc_);
-  //int j=0;
-  //printf("splin[%d]=%p\n", j, splin[j]);
-  //j=1;
-  //printf("splin[%d]=%p\n", j, splin[j]);
-  //j=2;
-  //printf("splin[%d]=%p\n", j, splin[j]);
-  //printf("In physicalParams( double ss ) - here 0\n");
-  
-  xx = gsl_spline_eval(splin[0], ss, acc_ ); // ray's x coord
-  yy = gsl_spline_eval(splin[1], ss, acc_ ); // y
-  zz = gsl_spline_eval(splin[2], ss, acc_ ); // z
-  cc = gsl_spline_eval(splin[3], ss, acc_ ); // c - sound speed
-  vr = gsl_spline_eval(splin[4], ss, acc_ ); // ray velocity 
-  om = gsl_spline_eval(splin[5], ss, acc_ ); // OMEGA = 1-grad(phi)*v_0 - Doppler effect from wind v_0
-  rh = gsl_spline_eval(splin[6], ss, acc_ ); // density
-  ja = gsl_spline_eval(splin[7], ss, acc_ ); // Jacobian
-  tr = gsl_spline_eval(splin[8], ss, acc_ ); // reduced time
-
-  //gsl_interp_accel_free(acc_);
-       
-  //printf("vr=%g\n", vr);
-  //int j=6;
-  //printf("LR.ss[0]=%g;   ss=%g\n", LR.ss[0], ss);
-  //printf("j=%d;  LR.ss[j]=%g; LR.xx[j]=%g; LR.zz[j]=%g \n", j, LR.ss[j], LR.xx[j], LR.zz[j]);
-  //printf("xx=%g;  yy=%g;  zz=%g\n", xx, yy, zz);
-  
-  
-  //double splint( vector<double> xx, vector<double> yy, double *coef, double x)
-  //double x = splint( LR.ss, LR.xx, spl[0], ss);
-  //printf("x=%g\n", x);
-  
-  //exit(1);
-
-  //printf("zz=%g\n", zz);
-  //printf("cc=%g\n", cc);
-  //printf("LR.ss[1]=%g\n", LR.ss[1]);
-  //printf("LR.vr[0]=%g\n", LR.vr[0]);
-  //printf("LR.vr[1]=%g\n", LR.vr[1]);
+  nlp.eval( ss, hint, ptNlp );  // one interval search for all nine quantities
+  xx = ptNlp[0]; // ray's x coord
+  yy = ptNlp[1]; // y
+  zz = ptNlp[2]; // z
+  cc = ptNlp[3]; // c - sound speed
+  vr = ptNlp[4]; // ray velocity 
+  om = ptNlp[5]; // OMEGA = 1-grad(phi)*v_0 - Doppler effect from wind v_0
+  rh = ptNlp[6]; // density
+  ja = ptNlp[7]; // Jacobian
+  tr = ptNlp[8]; // reduced time
 }
 
 
@@ -1079,97 +1187,38 @@ void raypathParams::physicalParams( double ss )
 // -------------------------------------------------------------------------------
 raypathParams::raypathParams( linray LRinput, int j )
 {	
-// routine that is called once to set the coefficients spl used subsequently by splint; 
+// routine that is called once to set the coefficients used subsequently by physicalParams
   double der1 = 1e50;
   //double der1 = 100.0; // DV
   beta = 1+(GAMMA-1)/2;
 	LR = LRinput;
+  hint = 0;
     
-  spl[0] = spline( LR.ss, LR.xx, der1, der1 );
-  spl[1] = spline( LR.ss, LR.yy, der1, der1 );
-  spl[2] = spline( LR.ss, LR.zz, der1, der1 );
-  spl[3] = spline( LR.ss, LR.cc, der1, der1 );
-  spl[4] = spline( LR.ss, LR.vr, der1, der1 );
-  spl[5] = spline( LR.ss, LR.om, der1, der1 );
-  spl[6] = spline( LR.ss, LR.rh, der1, der1 );
-  spl[7] = spline( LR.ss, LR.ja, der1, der1 );
-  spl[8] = spline( LR.ss, LR.tr, der1, der1 );
-    
-	nlp.push_back( LR.xx );
-	nlp.push_back( LR.yy );
-	nlp.push_back( LR.zz );
-	nlp.push_back( LR.cc );
-	nlp.push_back( LR.vr );
-	nlp.push_back( LR.om );
-	nlp.push_back( LR.rh );
-	nlp.push_back( LR.ja );
-  nlp.push_back( LR.tr );
+  nlp.init( LR.ss, 9 );
+  nlp.setQuantity( 0, LR.xx, der1, der1 );
+  nlp.setQuantity( 1, LR.yy, der1, der1 );
+  nlp.setQuantity( 2, LR.zz, der1, der1 );
+  nlp.setQuantity( 3, LR.cc, der1, der1 );
+  nlp.setQuantity( 4, LR.vr, der1, der1 );
+  nlp.setQuantity( 5, LR.om, der1, der1 );
+  nlp.setQuantity( 6, LR.rh, der1, der1 );
+  nlp.setQuantity( 7, LR.ja, der1, der1 );
+  nlp.setQuantity( 8, LR.tr, der1, der1 );
   
   printf("LR.xx.size=%lu   last elem=%g\n", LR.xx.size(), LR.xx.back());
-  
-
-  //exit(1);
 }
 
 
-
-
-// DV
 raypathParams::~raypathParams()
 {
-  //printf("At start of raypathParams destructor\n");
-  //    for( int i=0; i<9; i++ )
-  //        delete [] spl[i];
-
-  //printf("In raypathParams destructor 1 \n");       
-  for (int j=0; j<9; j++) {
-    gsl_spline_free(splin[j]);
-  }   
-  //printf("In raypathParams destructor 2\n");
-  gsl_interp_accel_free(acc_);     
-  //printf("At end of raypathParams destructor\n");
 }  
-  
-// Joel's old destructor
-//raypathParams::~raypathParams()
-//{
-//    for( int i=0; i<9; i++ )
-//        delete [] spl[i];
-//}
     
 void raypathParams::physicalParams( double ss, int j )
 {
-  splint( LR.ss, nlp, spl, ss, ptNlp );
-	xx = ptNlp[0];
-	yy = ptNlp[1];
-	zz = ptNlp[2];
-	cc = ptNlp[3];
-	vr = ptNlp[4];
-	om = ptNlp[5];
-	rh = ptNlp[6];
-	ja = ptNlp[7];
-  tr = ptNlp[8];
-  
-  //printf("vr=%g\n", vr);
-  //int j=6;
-  //printf("LR.ss[0]=%g;   ss=%g\n", LR.ss[0], ss);
-  //printf("j=%d;  LR.ss[j]=%g; LR.xx[j]=%g; LR.zz[j]=%g \n", j, LR.ss[j], LR.xx[j], LR.zz[j]);
-  //printf("xx=%g;  yy=%g;  zz=%g\n", xx, yy, zz);
-  
-  
-  //double splint( vector<double> xx, vector<double> yy, double *coef, double x)
-  //double x = splint( LR.ss, LR.xx, spl[0], ss);
-  //printf("x=%g\n", x);
-  
-  //exit(1);
-
-  //printf("zz=%g\n", zz);
-  //printf("cc=%g\n", cc);
-  //printf("LR.ss[1]=%g\n", LR.ss[1]);
-  //printf("LR.vr[0]=%g\n", LR.vr[0]);
-  //printf("LR.vr[1]=%g\n", LR.vr[1]);
+  physicalParams( ss );
 }
 
+
 double raypathParams::pressCorrection( double ssInit )
 {
     double p1k, pch, j1k;
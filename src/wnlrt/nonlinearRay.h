@@ -20,11 +20,30 @@
 
 using namespace std;
 
+// Waveforms saved along the ray, npts samples each, kept in one block that is
+// allocated up front.  When the block is full the caller drops every other
+// saved waveform (decimate) and saves half as often from then on, so that a
+// long ray with a fine step never outgrows the block.
+class waveformHistory
+{
+    int npts, cap, nrows;
+    vector<double> data;
+    
+public:
+    waveformHistory();
+    void reserve( int, int );
+    bool full() const;
+    void push_back( const double*, int );
+    void decimate();
+    int size() const;
+    const double* operator[]( int ) const;
+};
+
 struct nonray{
     //vector<double> xx, yy, zz, rh, ps, sb, tt, Ur, Ui, ff, cc, tr; // Joel
     vector<double> xx, yy, zz, rh, ps, sb, tt, Ur, Ui, ff, cc, tr, ss;  // DV
     // note: ps is the scaling factor for acoustic pressure: p = u/ps where p = acoustic pressure
-    vector< vector<double> > uu; // scaled acoustic pressure uu = pp*ps
+    waveformHistory uu; // scaled acoustic pressure uu = pp*ps
     // DV
     //vector< vector<double> > UUr; // real (spectrum)
     //vector< vector<double> > UUi; // imag (spectrum)
@@ -43,6 +62,24 @@ struct attRed{ // attenuation reduction by factor attfac above an altitude zzRed
     double zzRed, atfac;
 };
 
+// Heap storage for the arrays of the nonlinear march, sized from the number of
+// waveform samples nn (fine resolution would overflow the stack) and from the
+// number of caustics nsc (at least one entry, as causticParams always sets one).
+// The buffers are allocated with fftw_malloc for alignment.
+class nonrayWorkspace
+{
+    nonrayWorkspace( const nonrayWorkspace& );
+    nonrayWorkspace& operator=( const nonrayWorkspace& );
+    
+public:
+    nonrayWorkspace( int, int );
+    ~nonrayWorkspace();
+    int nn;
+    double *tt, *pp, *uu;           // nn samples
+    double *attn, *ff;              // nn/2+1 frequencies
+    double *ssup, *sslo, *slope;    // one per caustic
+};
+
 
 void savewf( const char*, waveform );
 
@@ -72,11 +109,14 @@ double stepSizeCaustic( double, double, double, double, double, double& );
 
 void atmAttn(int, double, double, double, double*, double* );
 
+// The FFTW plans are made once, in the constructor, on the aligned buffers
+// below and are re-executed at every step of the march.
 class spectralParams
 {
     int nn;
-    double *cf, *fltr, *attnEf1, *attnEf2, *usq;
+    double *cf, *fltr, *attnEf1, *attnEf2, *usq, *ur, *taper;
     fftw_complex *Usq;
+    fftw_plan planFor, planBac; // r2c of u^2 (or u) and c2r of U3
     
 public:
     spectralParams( int );
@@ -86,6 +126,7 @@ public:
     void integEulerMethod( double, double, double, double, double* );
     void integLeapfrog( double, double );
     void applyAttn( double, double, double, double* );
+    void leapfrogAttn( double, double, double, double, double, double* );
     void FFT( double*, double& );
     void hilbert();
     fftw_complex *U1, *U2, *U3;
@@ -108,8 +149,9 @@ public:
 class raypathParams
 {
     double beta, NN, vr, om, ja; // NN is the normalizing factor; set by method normalizingFactor()
-    double *spl[9], ptNlp[9];
-	  vector< vector<double> > nlp;
+    double ptNlp[9];
+	  StratifiedProfileSpline nlp; // x, y, z, c, vr, om, rho, jacobian, tr along the ray arc length
+	  int hint;                    // interval of the last evaluation
 	  linray LR;
     
 public:
@@ -123,11 +165,11 @@ public:
     void psDopScaBeta( double, double&, double&);
     double scaledBetaCaustic( double );
 	  double xx, yy, zz, cc, ps, tr, rh;
-	  gsl_interp_accel *acc_; // DV
-    gsl_spline *splin[9];   // DV
 };
 
-nonray nonlinearRay( int, double, attRed, linray, waveform );
+nonray nonlinearRay( int, double, attRed, linray, waveform, int = 0, const char* = NULL );
+
+nonray nonlinearRay( int, double, attRed, const linray&, const raypathParams&, waveform, int = 0, const char* = NULL );
 
 
 #endif
@@ -13,6 +13,7 @@
 // ./wnlrt --inclin 10 --azimuth 50 --eigenrayfile ToyAtmo_Eigenray-0.dat --shootray --atmosfile NCPA_canonical_profile_zuvwtdp.dat --src_z 0 --range 1000 --rcv_z 1
 
 #include <cstring>
+#include <sstream>
 #include <stdexcept>
 #include <gsl/gsl_interp.h>
 #include <gsl/gsl_spline.h>
@@ -21,6 +22,7 @@
 #include "nonlinearRay.h"
 #include "anyoption.h"
 #include "ProcessOptionsNRT.h"
+#include "TaskScheduler.h"
 
 using namespace NCPA;
 using namespace std;
@@ -30,6 +32,18 @@ void save2disk( const char *fn, double atfac, linray ER, nonray NR );
 
 void saveRay(linray);
 
+// one source waveform of a batch run
+struct batchCase {
+    string wftype;
+    double ampl, duration;
+};
+
+vector<batchCase> batchReader( const char *filename );
+
+waveform sourceWaveform( const string &wftype, int nn, double period, double duration, double &ampl );
+
+int runBatch( ProcessOptionsNRT *oNRT, int nn, double period, double ssInit, attRed attRed, linray &ER, raypathParams &RP );
+
 // Function to parse the options from the command line/config file
 AnyOption *parseInputOptions( int argc, char **argv );
 
@@ -75,7 +89,7 @@ int main(int argc,char **argv) {
     yield.push_back( 100e3 );
     
     double ssInit = 1000;  // reference (start) point on ray [meters]
-    int nn = pow(2.0,14);  // number of points in the waveform
+    int nn = oNRT->getNfft();  // number of points in the waveform [2^14]
     double period = 80.0;  // reduced time ranges over this period from -T/2 to T/2 
     attRed attRed;         // attenuation reduction factor structure
     attRed.zzRed = 90000;  // aplly attn. red. factor above this height
@@ -121,6 +135,17 @@ int main(int argc,char **argv) {
     raypathParams RP( ER );
     //double presCor = RP.pressCorrection( ssInit );  // CHH 191029: Unused
     
+    //----------------------------------------------------------
+    // Batch mode: many source waveforms along this one ray
+    if ( !oNRT->getBatchfile().empty() ) {
+      int status = runBatch( oNRT, nn, period, ssInit, attRed, ER, RP );
+      end = clock();
+      cout << "--> ...done. (Run time = " << (end-start)/CLOCKS_PER_SEC << " s.)" << endl << endl;
+      delete opt;
+      delete oNRT;
+      return status;
+    }
+    
     //----------------------------------------------------------
     //Generating model waveform
     waveform wf; // waveform with fields reduced time (tt) and pressure (pp)
@@ -147,16 +172,11 @@ int main(int argc,char **argv) {
     //cout << "(oNRT->getWftype()).compare() = " << (oNRT->getWftype()).compare("Nwave") << endl;
     
     // generate waveform with fields reduced time (tt) and pressure (pp)
-    if ( (oNRT->getWftype()).compare("Nwave")==0) {
-      //cout << "waveform type: " << oNRT->getWftype() <<  endl;
-      wf = generateNWave( nn, period, oNRT->getWfduration(), oNRT->getWfampl() ); 
-    } 
-    else if ( (oNRT->getWftype()).compare("pulse")==0 ) {
-      double ampl = oNRT->getWfampl();
+    double ampl = oNRT->getWfampl();
+    if ( (oNRT->getWftype()).compare("pulse")==0 ) {
       cout << "--> Initial amplitude = " << ampl << " Pa" << endl;
-      wf = generateWaveForm(nn, period, ampl );
-      //cout << "after generateWaveForm: ampl = " << ampl << endl;
-    }                                      
+    }
+    wf = sourceWaveform( oNRT->getWftype(), nn, period, oNRT->getWfduration(), ampl );
 
     string init_wavef = "initwf.dat"; 
     savewf( init_wavef.c_str(), wf );
@@ -170,7 +190,9 @@ int main(int argc,char **argv) {
     printf("--> Starting the nonlinear ray acoustic calculation\n");
         
     // main work is done here
-    nonray NR = nonlinearRay( nn, ssInit, attRed, ER, wf );
+    string streamfile = oNRT->getStreamWaveformsFile();
+    nonray NR = nonlinearRay( nn, ssInit, attRed, ER, wf, oNRT->getMaxSavedWaveforms(),
+                              streamfile.empty() ? NULL : streamfile.c_str() );
     
     //---------- end of Nonlinear ray calculation ---------------
     
@@ -275,6 +297,126 @@ void save2disk( const char *fn, double atfac, linray ER, nonray NR )
 
 
 
+//----------------------------------------------------------
+// Batch runs
+//----------------------------------------------------------
+
+// generate the source waveform: an N wave of half-duration 'duration' or a
+// smooth pulse; for the pulse ampl returns the actual peak amplitude
+waveform sourceWaveform( const string &wftype, int nn, double period, double duration, double &ampl )
+{
+    waveform wf;
+    if ( wftype.compare("Nwave")==0 ) {
+      wf = generateNWave( nn, period, duration, ampl );
+    }
+    else if ( wftype.compare("pulse")==0 ) {
+      wf = generateWaveForm( nn, period, ampl );
+    }
+    return wf;
+}
+
+// read the batch cases: one per line, "wftype amplitude [duration]";
+// blank lines and lines starting with # are skipped
+vector<batchCase> batchReader( const char *filename )
+{
+    vector<batchCase> cases;
+    ifstream indata;
+    string line;
+    
+    indata.open( filename );
+    if(!indata)
+    {
+      cerr << "Error: File " << filename << " could not be opened!" << endl;
+      exit(1);
+    }
+    
+    int lineno = 0;
+    while ( getline( indata, line ) ) 
+    {
+      lineno++;
+      size_t first = line.find_first_not_of( " \t\r" );
+      if ( first == string::npos || line[first] == '#' ) continue;
+      
+      istringstream is( line );
+      batchCase bc;
+      bc.duration = 0.5;
+      if ( !( is >> bc.wftype >> bc.ampl ) ) {
+        cerr << "Error: " << filename << ", line " << lineno 
+             << ": expected \"wftype amplitude [duration]\"" << endl;
+        exit(1);
+      }
+      is >> bc.duration;
+      if ( bc.wftype.compare("Nwave") && bc.wftype.compare("pulse") ) {
+        cerr << "Error: " << filename << ", line " << lineno 
+             << ": unknown waveform type " << bc.wftype << endl;
+        exit(1);
+      }
+      cases.push_back( bc );
+    }
+    indata.close();
+    return cases;
+}
+
+// Propagate every case of the batch file along the ray ER, whose path
+// parameters RP are set up once for all of them.  The cases are independent
+// and are spread over --jobs processes; the waveform at the end of the ray
+// for each case is written, in case order, to a single file.
+int runBatch( ProcessOptionsNRT *oNRT, int nn, double period, double ssInit, attRed attRed, linray &ER, raypathParams &RP )
+{
+    vector<batchCase> cases = batchReader( oNRT->getBatchfile().c_str() );
+    string outfile = oNRT->getBatchOutfile();
+    int ncases = cases.size();
+    
+    if ( ncases == 0 ) {
+      cerr << "Error: no cases found in " << oNRT->getBatchfile() << endl;
+      return 1;
+    }
+    printf("--> Batch run of %d source waveforms along one ray\n", ncases);
+    
+    try {
+      TaskScheduler sched( ncases, oNRT->getJobs(), outfile );
+      
+      // stronger waveforms take more, shorter, nonlinear steps 
+      for ( int ii = 0; ii < ncases; ii++ ) {
+        sched.setCost( ii, fabs( cases[ii].ampl ) );
+      }
+      
+      if ( sched.run() ) {
+        int ii;
+        while ( sched.next( &ii ) ) {
+          double ampl = cases[ii].ampl;
+          waveform wf = sourceWaveform( cases[ii].wftype, nn, period, cases[ii].duration, ampl );
+          
+          printf("--> Case %d: %s, amplitude %g Pa, duration %g s\n", ii, 
+                 cases[ii].wftype.c_str(), ampl, cases[ii].duration );
+          
+          // only the first and the last waveforms are needed here
+          nonray NR = nonlinearRay( nn, ssInit, attRed, ER, RP, wf, 2, NULL );
+          
+          FILE *fp = sched.output();
+          if ( fp != NULL ) {
+            int last = NR.uu.size()-1;
+            fprintf( fp, "# case %d: %s %g %g\n", ii, cases[ii].wftype.c_str(), ampl, cases[ii].duration );
+            for ( unsigned int i = 0; i < NR.tt.size(); i++ ) {
+              fprintf( fp, "%d %15.5E %15.5E %15.5E\n", ii, NR.tt[i], 
+                       NR.uu[0][i]/NR.ps[0], NR.uu[last][i]/NR.ps[last] );
+            }
+          }
+        }
+        sched.finish();
+      }
+    }
+    catch ( std::exception &e ) {
+      cerr << "Error: " << e.what() << endl;
+      return 1;
+    }
+    
+    printf("--> Saved the batch waveforms to %s\n", outfile.c_str());
+    printf("    with 4 columns: [case, reduced_time, source waveform, waveform at ray end]\n");
+    return 0;
+}
+
+
 // save contents of a ray
 void saveRay(linray R) {
 
@@ -366,6 +508,21 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( "                       Can be ""Nwave"" or ""pulse"" [Nwave]. " );
   opt->addUsage( " --ampl                Provide the initial pressure waveform amplitude. [1 Pa]" ); 
   opt->addUsage( " --duration            Provide the initial waveform duration [0.5 secs]" );
+  opt->addUsage( " --nfft                Number of points in the waveform; a power of 2" );
+  opt->addUsage( "                       no less than 4096 [16384]" );
+  opt->addUsage( " --max_saved_waveforms Maximum number of waveforms kept for" );
+  opt->addUsage( "                       pressure_wf_evolution.dat. When reached, every other" );
+  opt->addUsage( "                       one is dropped and they are saved half as often." );
+  opt->addUsage( "                       [one every ~0.5 km of the ray]" );
+  opt->addUsage( " --batchfile           Run a batch of source waveforms along the one ray." );
+  opt->addUsage( "                       Each line of the file holds a case:" );
+  opt->addUsage( "                       \"wftype amplitude [duration]\" (# starts a comment)." );
+  opt->addUsage( " --batch_outfile       Output of the batch run [batch_waveforms.dat]" );
+  opt->addUsage( " --jobs                Number of processes for the batch cases [1]" );
+  opt->addUsage( " --stream_waveforms    Write the waveform every ~0.5 km to this file as it" );
+  opt->addUsage( "                       is computed; one row per point: raypath_length," );
+  opt->addUsage( "                       pressure waveform [Pa]. The first row holds 0 and" );
+  opt->addUsage( "                       the reduced times." );
   opt->addUsage( "" );
   
   
@@ -385,10 +542,15 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->addUsage( "                       Stores waveform spectrum at the ray's end point " );
   opt->addUsage( "                       Contains 3 columns: [ frequency, real part, imag part ]" );
   opt->addUsage( "" );   
+  opt->addUsage( " batch_waveforms.dat  (with --batchfile, instead of the above)" );
+  opt->addUsage( "                       Source and end-of-ray waveforms of every case; " );
+  opt->addUsage( "                       4 columns: [ case, reduced_time, source, end of ray ]" );
+  opt->addUsage( "" );   
 
   opt->addUsage( "QUICK-START EXAMPLES:" );  
   opt->addUsage( "./wnlrt --eigenrayfile ToyAtmo_Eigenray-0.dat" );  
   opt->addUsage( "./wnlrt --eigenrayfile ToyAtmo_Eigenray-0.dat --waveform Nwave --ampl 500 --duration 0.5" ); 
+  opt->addUsage( "./wnlrt --eigenrayfile ToyAtmo_Eigenray-0.dat --batchfile cases.txt --jobs 4" ); 
   opt->addUsage( "" ); 
 
   // Set up the actual flags, etc.
@@ -416,6 +578,12 @@ AnyOption *parseInputOptions( int argc, char **argv ) {
   opt->setOption( "waveform" );
   opt->setOption( "ampl" );
   opt->setOption( "duration" );
+  opt->setOption( "nfft" );
+  opt->setOption( "max_saved_waveforms" );
+  opt->setOption( "stream_waveforms" );
+  opt->setOption( "batchfile" );
+  opt->setOption( "batch_outfile" );
+  opt->setOption( "jobs" );
 
   // Process the command-line arguments
   opt->processFile( "../samples/wnlrt.options" );
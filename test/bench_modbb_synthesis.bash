@@ -0,0 +1,18 @@
+#!/bin/bash
+
+# Time the modal sums of the ModBB and CModBB pulse synthesis (FFT excluded)
+# before and after packing the modes: the direct form recomputes the terms
+# at every range as the codes used to, the packed form computes them once.
+# 200 receivers 1 km apart from the sample dispersion file; CModBB reads it
+# rewritten with zero imaginary parts of the modes.
+cd ../samples
+awk '{printf "%s %s %s %s", $1, $2, $3, $4; for (i = 5; i <= NF; i += 4) printf " %s %s %s 0 %s 0", $i, $(i+1), $(i+2), $(i+3); printf "\n"}' disp_256freqs_0p5hz_NCPA_canonic.dat > bench_cdisp.dat
+for prog in ModBB CModBB ; do
+	disp=disp_256freqs_0p5hz_NCPA_canonic.dat
+	[ $prog = CModBB ] && disp=bench_cdisp.dat
+	for form in direct packed ; do
+		echo -n "$prog: "
+		../bin/$prog --pulse_prop_src2rcv_grid $disp --R_start_km 200 --DR_km 1 --R_end_km 399 --waveform_out_file bench_wvf_$form.dat --synthesis_form $form | grep "Modal sums"
+	done
+done
+rm -f bench_cdisp.dat bench_wvf_direct.dat bench_wvf_packed.dat source_spectrum.dat source_waveform.dat source_spectrum_input.dat source_waveform_input.dat
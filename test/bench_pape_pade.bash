@@ -0,0 +1,11 @@
+#!/bin/bash
+
+# Time per range step of the product- and sum-form Pade steps for n_pade = 4-8
+cd ../samples
+for n in 4 5 6 7 8 ; do
+	for form in product sum ; do
+		echo -n "n_pade $n: "
+		../bin/pape --ncpatoy --azimuth 90 --freq 0.1 --maxrange_km 100 --n_pade $n --pade_form $form | grep "per range step"
+	done
+done
+rm -f profile_int.dat attn.pe tloss_1d.pe
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Dispersion containers (--dispersion_container) against the ascii and
+# per-frequency binary outputs, on 16 frequencies
+cd ../samples
+common="--atmosfile NCPA_canonical_profile_zuvwtdp.dat --atmosfileorder zuvwtdp --skiplines 0 --azimuth 90 --f_step 0.015625 --f_max 0.25 --use_modess"
+rm -rf cont_* wvf_cont_* frame_cont_*
+
+# source-to-receiver data: ascii, container (serial and on 2 processes),
+# and the serial container run again, which must find nothing to do
+../bin/ModBB --out_disp_src2rcv_file cont_disp.dat $common
+../bin/ModBB --out_disp_src2rcv_file cont_serial.bin --dispersion_container $common
+../bin/ModBB --out_disp_src2rcv_file cont_jobs.bin --dispersion_container --jobs 2 $common
+cp cont_serial.bin cont_restart.bin
+../bin/ModBB --out_disp_src2rcv_file cont_restart.bin --dispersion_container $common
+for d in cont_disp.dat cont_serial.bin cont_jobs.bin ; do
+	../bin/ModBB --pulse_prop_src2rcv $d --range_R_km 240 --waveform_out_file wvf_$d
+done
+
+# full modes: per-frequency files and a container, through --pulse_prop_grid
+mkdir cont_bins
+../bin/ModBB --out_dispersion_files cont_bins/disprs $common
+../bin/ModBB --out_dispersion_files cont_full.bin --dispersion_container $common
+grid="--R_start_km 240 --width_km 2 --height_km 1 --max_celerity 300 --tmstep 30 --ntsteps 2"
+../bin/ModBB --pulse_prop_grid cont_bins $grid --frame_file_stub frame_cont_bins
+../bin/ModBB --pulse_prop_grid cont_full.bin $grid --frame_file_stub frame_cont_full
+
+mkdir -p ../test/results/ModBB_container
+mv cont_serial.bin cont_restart.bin wvf_cont_* frame_cont_* ../test/results/ModBB_container/
+rm -rf cont_* source_spectrum*.dat source_waveform*.dat
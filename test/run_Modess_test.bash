@@ -10,3 +10,10 @@ cd ../samples
 # tloss_1d.nm
 mkdir -p ../test/results/Modess/
 mv tloss_1d.nm ceff.nm tloss_1d.lossless.nm ../test/results/Modess/
+
+# the same (N by 2D) sweep serially and on 3 processes
+for jobs in 1 3 ; do
+	../bin/Modess --atmosfile NCPA_canonical_profile_zuvwtdp.dat --atmosfileorder zuvwtdp --freq 0.1 --Nby2Dprop --azimuth_start 0 --azimuth_end 90 --azimuth_step 15 --jobs $jobs
+	mkdir -p ../test/results/Modess/Nby2D_jobs$jobs/
+	mv Nby2D_tloss_1d.nm Nby2D_tloss_1d.lossless.nm ceff.nm ../test/results/Modess/Nby2D_jobs$jobs/
+done
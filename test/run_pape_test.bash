@@ -11,3 +11,27 @@ cd ../samples
 mkdir -p ../test/results/pape
 mv profile_int.dat attn.pe tloss_2d.pe tloss_1d.pe ../test/results/pape/
 
+# the sum-form Pade step should reproduce the product form
+../bin/pape  --ncpatoy --azimuth 90 --freq 0.1 --pade_form sum
+mkdir -p ../test/results/pape/sum
+mv profile_int.dat tloss_1d.pe ../test/results/pape/sum/
+rm -f attn.pe
+
+# the first 100 km of the 2D TL again, as a binary file
+../bin/pape  --ncpatoy --azimuth 90 --freq 0.1 --maxrange_km 100 --write_2D_TLoss --tloss2d_format binary
+mkdir -p ../test/results/pape/binary
+mv tloss_2d.bin ../test/results/pape/binary/
+rm -f profile_int.dat attn.pe tloss_1d.pe
+
+# two frequencies marched together, and one at a time
+../bin/pape  --ncpatoy --azimuth 90 --batch_freqs 0.05_0.1 --batch_dir ../test/results/pape/batch2
+../bin/pape  --ncpatoy --azimuth 90 --batch_freqs 0.05_0.1 --batch_width 1 --batch_dir ../test/results/pape/batch1
+rm -f profile_int.dat attn.pe
+
+# a starter cache filled by one run and read back by the next
+for run in cold warm ; do
+	../bin/pape  --ncpatoy --azimuth 90 --freq 0.1 --starter_cache ../test/results/pape/starters
+	mkdir -p ../test/results/pape/$run
+	mv tloss_1d.pe ../test/results/pape/$run/
+	rm -f profile_int.dat attn.pe
+done
@@ -0,0 +1,12 @@
+#!/bin/bash
+
+# A fan of rays 0.05 degrees apart in elevation and azimuth around a ray
+# launched across the wind, so that its Jacobian can be checked against
+# finite differences of the neighbouring raypaths
+cd ../samples
+../bin/raytrace.3d --azimuth 44.95 --dazimuth 0.05 --maxazimuth 45.05 --elev 29.95 --delev 0.05 --maxelev 30.07 --skips 1 --atmosfile NCPA_canonical_profile_zuvwtdp.dat --atmosfileorder zuvwtdp --maxraylength 400 --maxheight 140
+
+# compare the following files:
+# raypath_az0*.txt
+mkdir -p ../test/results/raytrace.3d.jacobian/
+mv raypath_az0*.txt ../test/results/raytrace.3d.jacobian/
@@ -0,0 +1,13 @@
+#!/bin/bash
+
+# Skip distances from a trace at 5x the default step, with ground contacts
+# located within the step, should match a reference at 1/10 of the default
+cd ../samples
+../bin/raytrace.3d --azimuth 90 --elev 1 --delev 1 --maxelev 45 --skips 3 --atmosfile NCPA_canonical_profile_zuvwtdp.dat --atmosfileorder zuvwtdp --maxraylength 1200 --maxheight 140 --geometry_only --stepsize 0.001 --arrivals_file arrivals.fine.3d.dat
+../bin/raytrace.3d --azimuth 90 --elev 1 --delev 1 --maxelev 45 --skips 3 --atmosfile NCPA_canonical_profile_zuvwtdp.dat --atmosfileorder zuvwtdp --maxraylength 1200 --maxheight 140 --geometry_only --stepsize 0.05 --arrivals_file arrivals.coarse.3d.dat
+
+# compare the following files:
+# arrivals.fine.3d.dat
+# arrivals.coarse.3d.dat
+mkdir -p ../test/results/raytrace.3d.skips/
+mv arrivals.fine.3d.dat arrivals.coarse.3d.dat ../test/results/raytrace.3d.skips/
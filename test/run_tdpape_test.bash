@@ -0,0 +1,18 @@
+#!/bin/bash
+
+# tdpape --stream building the waveforms while a multi-frequency pape run
+# fills the directory, then the usual tdpape on the finished directory;
+# 32 frequencies up to 0.25 Hz, 3 receivers
+cd ../samples
+rm -rf tdpape_stream_dir
+mkdir tdpape_stream_dir
+rcv="--R_start_km 50 --R_end_km 60 --DR_km 5 --max_celerity 300"
+../bin/tdpape --pulse_prop_src2rcv_grid tdpape_stream_dir $rcv --waveform_out_file wvf_stream.dat --stream --stream_nfreq 32 --stream_fmax 0.25 --stream_timeout_s 600 &
+stream_pid=$!
+../bin/pape  --ncpatoy --azimuth 90 --batch_fmax 0.25 --batch_nfreq 32 --maxrange_km 70 --batch_dir tdpape_stream_dir
+wait $stream_pid
+../bin/tdpape --pulse_prop_src2rcv_grid tdpape_stream_dir $rcv --waveform_out_file wvf_grid.dat
+
+mkdir -p ../test/results/tdpape
+mv wvf_stream.dat wvf_grid.dat ../test/results/tdpape/
+rm -rf tdpape_stream_dir profile_int.dat attn.pe source_spectrum*.dat source_waveform*.dat arg_vec.dat toyatm.dat